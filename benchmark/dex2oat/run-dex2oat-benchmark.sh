@@ -0,0 +1,64 @@
+#!/bin/bash
+#
+# Copyright (C) 2018 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Compiles a corpus of APKs with dex2oat and prints its timings and memory use. See info.txt.
+
+if [[ $# -lt 1 ]]; then
+  echo "Usage: $0 <corpus dir> [<repetitions>]" >&2
+  exit 1
+fi
+
+corpus=$1
+repetitions=${2:-1}
+DEX2OAT=${DEX2OAT:-dex2oat}
+FILTERS=${FILTERS:-verify quicken speed-profile speed}
+THREADS=${THREADS:-1 4}
+out_dir=$(mktemp -d)
+trap 'rm -rf "$out_dir"' EXIT
+
+echo "apk,compiler_filter,threads,metric,value"
+for apk in "$corpus"/*.apk; do
+  name=$(basename "$apk" .apk)
+  for filter in $FILTERS; do
+    profile_flags=()
+    if [[ $filter == speed-profile && -f ${apk%.apk}.prof ]]; then
+      profile_flags=(--profile-file="${apk%.apk}.prof")
+    fi
+    for threads in $THREADS; do
+      for (( i = 0; i < repetitions; ++i )); do
+        timings=$out_dir/timings.txt
+        rm -f "$timings"
+        if ! $DEX2OAT $DEX2OAT_FLAGS --dex-file="$apk" --oat-file="$out_dir/$name.odex" \
+            --compiler-filter="$filter" -j"$threads" "${profile_flags[@]}" \
+            --dump-timings-to="$timings" 2> "$out_dir/dex2oat.log"; then
+          echo "dex2oat failed for $apk with $filter and -j$threads:" >&2
+          cat "$out_dir/dex2oat.log" >&2
+          exit 1
+        fi
+        awk -v prefix="$name,$filter,$threads" '
+          $1 == "phase" {
+            name = $5
+            for (i = 6; i <= NF; ++i) { name = name " " $i }
+            gsub(",", ";", name)
+            print prefix ",phase:" $2 ":" name "," $3
+            next
+          }
+          $1 != "compiler_filter" && $1 != "threads" { print prefix "," $1 "," $2 }
+        ' "$timings"
+      done
+    done
+  done
+done
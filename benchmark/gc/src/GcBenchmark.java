@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+import java.util.LinkedHashMap;
+import java.util.Map;
+import java.util.WeakHashMap;
+
+public class GcBenchmark {
+    public void timeAllocateSmallObjects(int count) {
+        // Chains of up to 1024 nodes, dropped as a whole.
+        Node last = null;
+        for (int i = 0; i < count; ++i) {
+            last = ((i & 1023) == 0) ? new Node(null, null) : new Node(last, null);
+        }
+        result = last;
+    }
+
+    public void timeBinaryTrees(int count) {
+        for (int i = 0; i < count; ++i) {
+            result = Node.createTree(SHORT_LIVED_TREE_DEPTH);
+        }
+    }
+
+    public void timeLinkedCache(int count) {
+        LinkedCache cache = linkedCache;
+        for (int i = 0; i < count; ++i) {
+            Integer key = Integer.valueOf(nextKey++);
+            cache.put(key, new Node(null, null));
+            // Touch an older entry, which moves it to the most recently used end.
+            cache.get(Integer.valueOf(nextKey - (LINKED_CACHE_SIZE / 2)));
+        }
+    }
+
+    public void timeLargeArrays(int count) {
+        int[][] ring = largeArrays;
+        for (int i = 0; i < count; ++i) {
+            // Bigger than the large object threshold, so they go to the large object space.
+            ring[i & (ring.length - 1)] = new int[LARGE_ARRAY_LENGTH];
+        }
+    }
+
+    public void timeWeakHashMap(int count) {
+        WeakHashMap<Object, Object> map = weakMap;
+        Object[] strongKeys = weakMapStrongKeys;
+        for (int i = 0; i < count; ++i) {
+            Object key = new Object();
+            map.put(key, new Node(null, null));
+            // Keep one key in 16 reachable for a while, the others can be cleared at once.
+            if ((i & 15) == 0) {
+                strongKeys[(i >> 4) & (strongKeys.length - 1)] = key;
+            }
+        }
+    }
+
+    public void timeExplicitGc(int count) {
+        for (int i = 0; i < count; ++i) {
+            Runtime.getRuntime().gc();
+        }
+    }
+
+    static class Node {
+        Node left;
+        Node right;
+
+        Node(Node left, Node right) {
+            this.left = left;
+            this.right = right;
+        }
+
+        static Node createTree(int depth) {
+            return depth == 0 ? new Node(null, null)
+                              : new Node(createTree(depth - 1), createTree(depth - 1));
+        }
+    }
+
+    static class LinkedCache extends LinkedHashMap<Integer, Node> {
+        LinkedCache() {
+            super(LINKED_CACHE_SIZE, 0.75f, /* accessOrder */ true);
+        }
+
+        @Override
+        protected boolean removeEldestEntry(Map.Entry<Integer, Node> eldest) {
+            return size() > LINKED_CACHE_SIZE;
+        }
+    }
+
+    static final int SHORT_LIVED_TREE_DEPTH = 10;
+    static final int LONG_LIVED_TREE_DEPTH = 18;
+    static final int LINKED_CACHE_SIZE = 16 * 1024;
+    static final int LARGE_ARRAY_LENGTH = 64 * 1024;
+
+    // The live set, about 8MiB of tree nodes.
+    Node longLivedTree = Node.createTree(LONG_LIVED_TREE_DEPTH);
+    LinkedCache linkedCache = new LinkedCache();
+    int nextKey = 0;
+    int[][] largeArrays = new int[16][];
+    WeakHashMap<Object, Object> weakMap = new WeakHashMap<>();
+    Object[] weakMapStrongKeys = new Object[1024];
+    Object result;
+}
@@ -0,0 +1,70 @@
+#!/bin/bash
+#
+# Copyright (C) 2018 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Runs JitWarmupBenchmark once per JIT threshold and summarizes its warmup. See info.txt.
+
+if [[ $# -lt 1 ]]; then
+  echo "Usage: $0 <dex or jar with JitWarmupBenchmark> [<iterations> [<threshold>...]]" >&2
+  exit 1
+fi
+
+classpath=$1
+iterations=${2:-200}
+shift $(( $# < 2 ? $# : 2 ))
+thresholds=("$@")
+if [[ ${#thresholds[@]} -eq 0 ]]; then
+  thresholds=(0 100 1000 10000)
+fi
+ART=${ART:-art}
+out_dir=$(mktemp -d)
+
+echo "threshold first_ms steady_ms warm_iteration tier compilations compile_ms code_bytes"
+for threshold in "${thresholds[@]}"; do
+  iteration_log=$out_dir/iterations-$threshold.txt
+  event_log=$out_dir/jit-events-$threshold.txt
+  if ! $ART $ART_FLAGS -Xusejit:true -Xjitthreshold:$threshold -Xjiteventlog:$event_log \
+      -cp "$classpath" JitWarmupBenchmark "$iterations" > "$iteration_log"; then
+    echo "Run with -Xjitthreshold:$threshold failed, see $iteration_log" >&2
+    exit 1
+  fi
+  # The median latency of the last quarter is the steady state one.
+  read -r first steady warm < <(awk '
+    $1 == "iteration" { latency[n++] = $4 }
+    END {
+      start = int(n * 3 / 4)
+      m = 0
+      for (i = start; i < n; ++i) {
+        # Insertion sort, asort() is not in POSIX awk.
+        for (j = m++; j > 0 && tail[j - 1] > latency[i]; --j) { tail[j] = tail[j - 1] }
+        tail[j] = latency[i]
+      }
+      steady = tail[int((m - 1) / 2)]
+      warm = n - 1
+      for (i = 0; i < n; ++i) {
+        if (latency[i] <= steady * 1.1) { warm = i; break }
+      }
+      printf "%.3f %.3f %d\n", latency[0] / 1e6, steady / 1e6, warm
+    }' "$iteration_log")
+  awk -v prefix="$threshold $first $steady $warm" '
+    { if (!($3 in count)) { tiers++ } count[$3]++; time[$3] += $2; size[$3] += $4 }
+    END {
+      if (tiers == 0) { print prefix " none 0 0 0" }
+      for (tier in count) {
+        printf "%s %s %d %.3f %d\n", prefix, tier, count[tier], time[tier] / 1e6, size[tier]
+      }
+    }' "$event_log"
+done
+echo "Logs are in $out_dir" >&2
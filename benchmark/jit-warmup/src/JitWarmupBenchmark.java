@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.Random;
+
+public class JitWarmupBenchmark {
+    public static void main(String[] args) {
+        int iterations = (args.length > 0) ? Integer.parseInt(args[0]) : 200;
+        JitWarmupBenchmark benchmark = new JitWarmupBenchmark();
+        for (int i = 0; i < iterations; ++i) {
+            long start = System.nanoTime();
+            benchmark.runIteration();
+            long end = System.nanoTime();
+            // Same clock as the -Xjiteventlog start times.
+            System.out.println("iteration " + i + " " + start + " " + (end - start));
+        }
+        System.out.println("result " + benchmark.result);
+    }
+
+    public void runIteration() {
+        result += sort();
+        result += buildStrings();
+        result += countWords();
+        result += callShapes();
+    }
+
+    private int sort() {
+        int[] copy = Arrays.copyOf(values, values.length);
+        // An insertion sort of the blocks, then a merge, so that the loops are our own code.
+        for (int block = 0; block < copy.length; block += BLOCK) {
+            for (int i = block + 1; i < block + BLOCK; ++i) {
+                int value = copy[i];
+                int j = i - 1;
+                while (j >= block && copy[j] > value) {
+                    copy[j + 1] = copy[j];
+                    --j;
+                }
+                copy[j + 1] = value;
+            }
+        }
+        int[] merged = new int[copy.length];
+        int[] heads = new int[copy.length / BLOCK];
+        for (int k = 0; k < merged.length; ++k) {
+            int best = -1;
+            for (int b = 0; b < heads.length; ++b) {
+                if (heads[b] < BLOCK &&
+                    (best == -1 || copy[b * BLOCK + heads[b]] < copy[best * BLOCK + heads[best]])) {
+                    best = b;
+                }
+            }
+            merged[k] = copy[best * BLOCK + heads[best]];
+            ++heads[best];
+        }
+        return merged[merged.length / 2];
+    }
+
+    private int buildStrings() {
+        StringBuilder sb = new StringBuilder();
+        for (int i = 0; i < 500; ++i) {
+            sb.append("item").append(i).append(',');
+        }
+        return sb.toString().hashCode();
+    }
+
+    private int countWords() {
+        HashMap<String, Integer> counts = new HashMap<>();
+        for (String word : words) {
+            Integer count = counts.get(word);
+            counts.put(word, (count == null) ? 1 : count + 1);
+        }
+        return counts.size();
+    }
+
+    private int callShapes() {
+        double area = 0.0;
+        for (int i = 0; i < 10000; ++i) {
+            area += shapes[i & (shapes.length - 1)].area();
+        }
+        return (int) area;
+    }
+
+    abstract static class Shape {
+        abstract double area();
+    }
+
+    static class Square extends Shape {
+        final double side;
+        Square(double side) { this.side = side; }
+        double area() { return side * side; }
+    }
+
+    static class Circle extends Shape {
+        final double radius;
+        Circle(double radius) { this.radius = radius; }
+        double area() { return Math.PI * radius * radius; }
+    }
+
+    static final int BLOCK = 64;
+
+    final int[] values = new int[BLOCK * 32];
+    final String[] words = new String[4096];
+    final Shape[] shapes = new Shape[64];
+    long result;
+
+    JitWarmupBenchmark() {
+        Random random = new Random(42);
+        for (int i = 0; i < values.length; ++i) {
+            values[i] = random.nextInt();
+        }
+        for (int i = 0; i < words.length; ++i) {
+            words[i] = "w" + random.nextInt(512);
+        }
+        for (int i = 0; i < shapes.length; ++i) {
+            shapes[i] = ((i & 1) == 0) ? new Square(i) : new Circle(i);
+        }
+    }
+}
@@ -224,7 +224,10 @@ TEST_F(CmdlineParserTest, TestSimpleSuccesses) {
   EXPECT_SINGLE_PARSE_VALUE(MemoryKiB(1234*MB), "-Xms1234m", M::MemoryInitialSize);
   EXPECT_SINGLE_PARSE_VALUE(true, "-XX:EnableHSpaceCompactForOOM", M::EnableHSpaceCompactForOOM);
   EXPECT_SINGLE_PARSE_VALUE(false, "-XX:DisableHSpaceCompactForOOM", M::EnableHSpaceCompactForOOM);
+  EXPECT_SINGLE_PARSE_VALUE(true, "-XX:EnableRegionSpaceNuma", M::RegionSpaceNuma);
+  EXPECT_SINGLE_PARSE_VALUE(false, "-XX:DisableRegionSpaceNuma", M::RegionSpaceNuma);
   EXPECT_SINGLE_PARSE_VALUE(0.5, "-XX:HeapTargetUtilization=0.5", M::HeapTargetUtilization);
+  EXPECT_SINGLE_PARSE_VALUE(0.25, "-XX:GcCpuBudget=0.25", M::GcCpuBudget);
   EXPECT_SINGLE_PARSE_VALUE(5u, "-XX:ParallelGCThreads=5", M::ParallelGCThreads);
   EXPECT_SINGLE_PARSE_EXISTS("-Xno-dex-file-fallback", M::NoDexFileFallback);
 }  // TEST_F
@@ -239,6 +242,7 @@ TEST_F(CmdlineParserTest, TestSimpleFailures) {
   EXPECT_SINGLE_PARSE_FAIL("-Xms123", CmdlineResult::kFailure);       // memory value too small
   EXPECT_SINGLE_PARSE_FAIL("-XX:HeapTargetUtilization=0.0", CmdlineResult::kOutOfRange);  // toosmal
   EXPECT_SINGLE_PARSE_FAIL("-XX:HeapTargetUtilization=2.0", CmdlineResult::kOutOfRange);  // toolarg
+  EXPECT_SINGLE_PARSE_FAIL("-XX:GcCpuBudget=2.0", CmdlineResult::kOutOfRange);  // too large
   EXPECT_SINGLE_PARSE_FAIL("-XX:ParallelGCThreads=-5", CmdlineResult::kOutOfRange);  // too small
   EXPECT_SINGLE_PARSE_FAIL("-Xgc:blablabla", CmdlineResult::kUsage);  // not a valid suboption
 }  // TEST_F
@@ -476,6 +480,13 @@ TEST_F(CmdlineParserTest, TestJitOptions) {
   {
     EXPECT_SINGLE_PARSE_VALUE(12345u, "-Xjitthreshold:12345", M::JITCompileThreshold);
   }
+  {
+    EXPECT_SINGLE_PARSE_VALUE(true, "-Xjitperfmap:true", M::JITPerfMap);
+    EXPECT_SINGLE_PARSE_VALUE(false, "-Xjitperfmap:false", M::JITPerfMap);
+    EXPECT_SINGLE_PARSE_VALUE(true, "-Xjitdump:true", M::JITDump);
+    EXPECT_SINGLE_PARSE_VALUE_STR(
+        "/tmp/jit-events.txt", "-Xjiteventlog:/tmp/jit-events.txt", M::JITEventLog);
+  }
 }  // TEST_F
 
 /*
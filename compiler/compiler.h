@@ -17,6 +17,8 @@
 #ifndef ART_COMPILER_COMPILER_H_
 #define ART_COMPILER_COMPILER_H_
 
+#include <ostream>
+
 #include "base/mutex.h"
 #include "base/os.h"
 #include "dex/dex_file.h"
@@ -77,12 +79,16 @@ class Compiler {
   virtual bool JitCompile(Thread* self ATTRIBUTE_UNUSED,
                           jit::JitCodeCache* code_cache ATTRIBUTE_UNUSED,
                           ArtMethod* method ATTRIBUTE_UNUSED,
+                          bool baseline ATTRIBUTE_UNUSED,
                           bool osr ATTRIBUTE_UNUSED,
                           jit::JitLogger* jit_logger ATTRIBUTE_UNUSED)
       REQUIRES_SHARED(Locks::mutator_lock_) {
     return false;
   }
 
+  // Dump the per-pass and per-method compilation statistics, if they are collected.
+  virtual void DumpStats(std::ostream& os ATTRIBUTE_UNUSED) const {}
+
   virtual uintptr_t GetEntryPointOf(ArtMethod* method) const
      REQUIRES_SHARED(Locks::mutator_lock_) = 0;
 
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DEBUG_ELF_DEBUG_READER_H_
+#define ART_COMPILER_DEBUG_ELF_DEBUG_READER_H_
+
+#include <string.h>
+
+#include "base/array_ref.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "elf.h"
+
+namespace art {
+namespace debug {
+
+// Trivial ELF file reader, used to read back the in-memory debug ELF files created for JIT.
+// It understands only what we write ourselves: a section header table, .symtab/.strtab
+// and uncompressed .debug_frame.
+template <typename ElfTypes>
+class ElfDebugReader {
+ public:
+  typedef typename ElfTypes::Addr Elf_Addr;
+  typedef typename ElfTypes::Ehdr Elf_Ehdr;
+  typedef typename ElfTypes::Shdr Elf_Shdr;
+  typedef typename ElfTypes::Sym Elf_Sym;
+
+  // Call Frame Information.
+  struct CFI {
+    uint32_t length;  // Length excluding the size of this field.
+    int32_t cie_pointer;  // Offset of the CIE within the .debug_frame section.
+  };
+
+  // Frame Description Entry.
+  struct FDE : public CFI {
+    Elf_Addr sym_addr;
+    Elf_Addr sym_size;
+  };
+
+  explicit ElfDebugReader(ArrayRef<const uint8_t> file) : file_(file) {
+    header_ = Read<Elf_Ehdr>(0);
+    CHECK_EQ(memcmp(header_->e_ident, ELFMAG, SELFMAG), 0);
+    CHECK_EQ(header_->e_shentsize, sizeof(Elf_Shdr));
+    sections_ = ArrayRef<const Elf_Shdr>(Read<Elf_Shdr>(header_->e_shoff), header_->e_shnum);
+    CHECK_LT(header_->e_shstrndx, sections_.size());
+  }
+
+  // Returns the section with the given name, or null if there is no such section.
+  const Elf_Shdr* GetSection(const char* name) const {
+    const char* names = Read<char>(sections_[header_->e_shstrndx].sh_offset);
+    for (const Elf_Shdr& section : sections_) {
+      if (strcmp(names + section.sh_name, name) == 0) {
+        return &section;
+      }
+    }
+    return nullptr;
+  }
+
+  ArrayRef<const uint8_t> GetSectionData(const Elf_Shdr* section) const {
+    CHECK_LE(section->sh_offset + section->sh_size, file_.size());
+    return file_.SubArray(section->sh_offset, section->sh_size);
+  }
+
+  // Calls visit_sym(const Elf_Sym&, const char* name) for all function symbols.
+  template <typename VisitSym>
+  void VisitFunctionSymbols(VisitSym visit_sym) const {
+    const Elf_Shdr* symtab = GetSection(".symtab");
+    if (symtab == nullptr) {
+      return;
+    }
+    CHECK_EQ(symtab->sh_entsize, sizeof(Elf_Sym));
+    const char* strtab = Read<char>(sections_[symtab->sh_link].sh_offset);
+    const Elf_Sym* symbols = Read<Elf_Sym>(symtab->sh_offset);
+    for (size_t i = 0, count = symtab->sh_size / sizeof(Elf_Sym); i < count; ++i) {
+      if (symbols[i].getType() == STT_FUNC) {
+        visit_sym(symbols[i], strtab + symbols[i].st_name);
+      }
+    }
+  }
+
+  // Calls visit_fde(const FDE&, ArrayRef<const uint8_t> opcodes) for all entries of the
+  // .debug_frame section. The opcodes include any DW_CFA_nop padding.
+  template <typename VisitFDE>
+  void VisitDebugFrame(VisitFDE visit_fde) const {
+    const Elf_Shdr* debug_frame = GetSection(".debug_frame");
+    if (debug_frame == nullptr) {
+      return;
+    }
+    ArrayRef<const uint8_t> data = GetSectionData(debug_frame);
+    for (size_t offset = 0; offset < data.size();) {
+      const CFI* entry = reinterpret_cast<const CFI*>(data.data() + offset);
+      CHECK_NE(entry->length, 0xffffffffu) << "64-bit DWARF is not supported";
+      size_t size = sizeof(entry->length) + entry->length;
+      CHECK_LE(offset + size, data.size());
+      if (entry->cie_pointer != -1) {  // Skip CIEs, we write the same one for all methods.
+        const FDE* fde = static_cast<const FDE*>(entry);
+        // We never write augmentation data, so only its zero size precedes the opcodes.
+        const uint8_t* opcodes = reinterpret_cast<const uint8_t*>(fde + 1);
+        CHECK_EQ(*opcodes, 0u) << "Unexpected FDE augmentation data";
+        ++opcodes;
+        visit_fde(*fde, ArrayRef<const uint8_t>(opcodes, data.data() + offset + size - opcodes));
+      }
+      offset += size;
+    }
+  }
+
+ private:
+  template <typename T>
+  const T* Read(size_t offset) const {
+    CHECK_LE(offset + sizeof(T), file_.size());
+    return reinterpret_cast<const T*>(file_.data() + offset);
+  }
+
+  ArrayRef<const uint8_t> file_;
+  const Elf_Ehdr* header_;
+  ArrayRef<const Elf_Shdr> sections_;
+
+  DISALLOW_COPY_AND_ASSIGN(ElfDebugReader);
+};
+
+}  // namespace debug
+}  // namespace art
+
+#endif  // ART_COMPILER_DEBUG_ELF_DEBUG_READER_H_
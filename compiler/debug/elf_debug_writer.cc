@@ -20,12 +20,14 @@
 #include <unordered_map>
 
 #include "base/array_ref.h"
+#include "compiled_method.h"
 #include "debug/dwarf/dwarf_constants.h"
 #include "debug/elf_compilation_unit.h"
 #include "debug/elf_debug_frame_writer.h"
 #include "debug/elf_debug_info_writer.h"
 #include "debug/elf_debug_line_writer.h"
 #include "debug/elf_debug_loc_writer.h"
+#include "debug/elf_debug_reader.h"
 #include "debug/elf_gnu_debugdata_writer.h"
 #include "debug/elf_symtab_writer.h"
 #include "debug/method_debug_info.h"
@@ -199,6 +201,58 @@ std::vector<uint8_t> MakeElfFileForJIT(
   }
 }
 
+template <typename ElfTypes>
+static std::vector<uint8_t> PackElfFileForJITInternal(
+    InstructionSet isa,
+    const InstructionSetFeatures* features,
+    ArrayRef<const ArrayRef<const uint8_t>> elf_files) {
+  // Read back the symbols and CFI. The opcodes remain owned by the input files.
+  std::vector<MethodDebugInfo> method_infos;
+  method_infos.reserve(elf_files.size());
+  const uint64_t code_delta = CompiledMethod::CodeDelta(isa);
+  for (ArrayRef<const uint8_t> elf_file : elf_files) {
+    ElfDebugReader<ElfTypes> reader(elf_file);
+    DCHECK(reader.GetSection(".gnu_debugdata") == nullptr) << "Only single methods can be packed";
+    const size_t first_method = method_infos.size();
+    reader.VisitFunctionSymbols([&](const typename ElfTypes::Sym& sym, const char* name) {
+      MethodDebugInfo info = {};
+      info.custom_name = name;
+      info.isa = isa;
+      info.is_code_address_text_relative = false;
+      info.code_address = sym.st_value - code_delta;
+      info.code_size = sym.st_size;
+      method_infos.push_back(std::move(info));
+    });
+    reader.VisitDebugFrame([&](const typename ElfDebugReader<ElfTypes>::FDE& fde,
+                               ArrayRef<const uint8_t> opcodes) {
+      for (size_t i = first_method; i < method_infos.size(); ++i) {
+        if (method_infos[i].code_address == fde.sym_addr) {
+          method_infos[i].cfi = opcodes;
+          break;
+        }
+      }
+    });
+  }
+  if (method_infos.empty()) {
+    return std::vector<uint8_t>();
+  }
+  return MakeElfFileForJIT(isa,
+                           features,
+                           /* mini_debug_info */ true,
+                           ArrayRef<const MethodDebugInfo>(method_infos));
+}
+
+std::vector<uint8_t> PackElfFileForJIT(
+    InstructionSet isa,
+    const InstructionSetFeatures* features,
+    ArrayRef<const ArrayRef<const uint8_t>> elf_files) {
+  if (Is64BitInstructionSet(isa)) {
+    return PackElfFileForJITInternal<ElfTypes64>(isa, features, elf_files);
+  } else {
+    return PackElfFileForJITInternal<ElfTypes32>(isa, features, elf_files);
+  }
+}
+
 template <typename ElfTypes>
 static std::vector<uint8_t> WriteDebugElfFileForClassesInternal(
     InstructionSet isa,
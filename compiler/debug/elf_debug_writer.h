@@ -56,6 +56,13 @@ std::vector<uint8_t> MakeElfFileForJIT(
     bool mini_debug_info,
     ArrayRef<const MethodDebugInfo> method_infos);
 
+// Merges uncompressed mini-debug-info ELF files created by MakeElfFileForJIT, each describing
+// a single method, into one ELF file with compressed symbols and CFI.
+std::vector<uint8_t> PackElfFileForJIT(
+    InstructionSet isa,
+    const InstructionSetFeatures* features,
+    ArrayRef<const ArrayRef<const uint8_t>> elf_files);
+
 std::vector<uint8_t> WriteDebugElfFileForClasses(
     InstructionSet isa,
     const InstructionSetFeatures* features,
@@ -17,6 +17,8 @@
 #include "compiler_driver.h"
 
 #include <unistd.h>
+#include <algorithm>
+#include <limits>
 #include <unordered_set>
 #include <vector>
 
@@ -754,11 +756,19 @@ void CompilerDriver::CompileOne(Thread* self, ArtMethod* method, TimingLogger* t
   self->GetJniEnv()->DeleteGlobalRef(jclass_loader);
 }
 
+// Whether the phases that allocate objects must run single-threaded to produce deterministic
+// output. Only images capture the heap, whose layout follows the allocation order. Without
+// an image, the results of these phases do not depend on the order of the classes, and the
+// VerifierDeps strings are sorted after verification.
+static bool SerializeForDeterminism(const CompilerOptions& options) {
+  return options.IsForceDeterminism() && (options.IsBootImage() || options.IsAppImage());
+}
+
 void CompilerDriver::Resolve(jobject class_loader,
                              const std::vector<const DexFile*>& dex_files,
                              TimingLogger* timings) {
   // Resolution allocates classes and needs to run single-threaded to be deterministic.
-  bool force_determinism = GetCompilerOptions().IsForceDeterminism();
+  bool force_determinism = SerializeForDeterminism(GetCompilerOptions());
   ThreadPool* resolve_thread_pool = force_determinism
                                      ? single_thread_pool_.get()
                                      : parallel_thread_pool_.get();
@@ -1556,9 +1566,12 @@ class ParallelCompilationManager {
     CHECK_GT(work_units, 0U);
 
     index_.StoreRelaxed(begin);
+    std::vector<Task*> tasks;
+    tasks.reserve(work_units);
     for (size_t i = 0; i < work_units; ++i) {
-      thread_pool_->AddTask(self, new ForAllClosureLambda<Fn>(this, end, fn));
+      tasks.push_back(new ForAllClosureLambda<Fn>(this, end, fn));
     }
+    thread_pool_->AddTasks(self, ArrayRef<Task* const>(tasks));
     thread_pool_->StartWorkers(self);
 
     // Ensure we're suspended while we're blocked waiting for the other threads to finish (worker
@@ -2001,8 +2014,8 @@ void CompilerDriver::Verify(jobject jclass_loader,
     }
   }
 
-  // Verification updates VerifierDeps and needs to run single-threaded to be deterministic.
-  bool force_determinism = GetCompilerOptions().IsForceDeterminism();
+  // Verification allocates objects and needs to run single-threaded to be deterministic.
+  bool force_determinism = SerializeForDeterminism(GetCompilerOptions());
   ThreadPool* verify_thread_pool =
       force_determinism ? single_thread_pool_.get() : parallel_thread_pool_.get();
   size_t verify_thread_count = force_determinism ? 1U : parallel_thread_count_;
@@ -2025,6 +2038,8 @@ void CompilerDriver::Verify(jobject jclass_loader,
       verifier_deps->MergeWith(*thread_deps, dex_files_for_oat_file_);
       delete thread_deps;
     }
+    // Strings are added in the order the verifier threads happen to need them.
+    verifier_deps->SortExtraStrings();
     Thread::Current()->SetVerifierDeps(nullptr);
   }
 }
@@ -2683,6 +2698,83 @@ void CompilerDriver::InitializeClasses(jobject class_loader,
   }
 }
 
+// A range of methods of a class, in class data order, compiled by a single task.
+struct CompileWorkItem {
+  uint32_t class_def_index;
+  uint32_t begin_method;  // Position of the first method in the class data.
+  uint32_t end_method;    // Position after the last method.
+  size_t cost;
+};
+
+// Classes whose estimated cost is above this are split into several work items, so that one
+// huge class does not keep a single thread busy long after the others are done. The cost is
+// counted in code units of the methods that will be compiled.
+static constexpr size_t kMaxCompileWorkItemCost = 8192u;
+
+// Estimated cost of compiling a method: its code size if it is going to be compiled, and a
+// token cost for the methods that are only visited (abstract, native, or not hot enough
+// for a profile based filter).
+static size_t EstimateCompileCost(const CompilerDriver* driver,
+                                  const DexFile& dex_file,
+                                  const DexFile::CodeItem* code_item,
+                                  uint32_t method_idx) {
+  constexpr size_t kVisitCost = 1u;
+  if (code_item == nullptr ||
+      !driver->ShouldCompileBasedOnProfile(MethodReference(&dex_file, method_idx))) {
+    return kVisitCost;
+  }
+  return kVisitCost + CodeItemInstructionAccessor(dex_file, code_item).InsnsSizeInCodeUnits();
+}
+
+// Split the compilation of `dex_file` into work items of bounded cost. With more than one
+// thread, the items are sorted by decreasing cost: the thread pool hands them out in order,
+// so the expensive items start first and the cheap ones fill in the gaps at the end.
+static std::vector<CompileWorkItem> CreateCompileWorkItems(const CompilerDriver* driver,
+                                                           const DexFile& dex_file,
+                                                           size_t thread_count) {
+  std::vector<CompileWorkItem> work_items;
+  work_items.reserve(dex_file.NumClassDefs());
+  for (uint32_t class_def_index = 0; class_def_index != dex_file.NumClassDefs();
+       ++class_def_index) {
+    const uint8_t* class_data = dex_file.GetClassData(dex_file.GetClassDef(class_def_index));
+    CompileWorkItem item = { class_def_index, 0u, 0u, 0u };
+    if (class_data != nullptr && thread_count > 1u) {
+      ClassDataItemIterator it(dex_file, class_data);
+      it.SkipAllFields();
+      uint32_t position = 0u;
+      int64_t previous_method_idx = -1;
+      for (; it.HasNextMethod(); it.Next(), ++position) {
+        uint32_t method_idx = it.GetMemberIndex();
+        if (method_idx == previous_method_idx) {
+          // Duplicate encoded method, see CompileDexFile(). Keep it with its predecessor.
+          continue;
+        }
+        previous_method_idx = method_idx;
+        size_t cost = EstimateCompileCost(driver, dex_file, it.GetMethodCodeItem(), method_idx);
+        if (item.cost != 0u && item.cost + cost > kMaxCompileWorkItemCost) {
+          item.end_method = position;
+          work_items.push_back(item);
+          item = { class_def_index, position, 0u, 0u };
+        }
+        item.cost += cost;
+      }
+      item.end_method = position;
+    } else {
+      // Compile all the methods of the class in a single item.
+      item.end_method = std::numeric_limits<uint32_t>::max();
+    }
+    work_items.push_back(item);
+  }
+  if (thread_count > 1u) {
+    std::stable_sort(work_items.begin(),
+                     work_items.end(),
+                     [](const CompileWorkItem& lhs, const CompileWorkItem& rhs) {
+                       return lhs.cost > rhs.cost;
+                     });
+  }
+  return work_items;
+}
+
 template <typename CompileFn>
 static void CompileDexFile(CompilerDriver* driver,
                            jobject class_loader,
@@ -2700,9 +2792,13 @@ static void CompileDexFile(CompilerDriver* driver,
                                      &dex_file,
                                      dex_files,
                                      thread_pool);
+  const std::vector<CompileWorkItem> work_items =
+      CreateCompileWorkItems(driver, dex_file, thread_count);
 
-  auto compile = [&context, &compile_fn](size_t class_def_index) {
+  auto compile = [&context, &compile_fn, &work_items](size_t work_item_index) {
     ScopedTrace trace(__FUNCTION__);
+    const CompileWorkItem& work_item = work_items[work_item_index];
+    const uint32_t class_def_index = work_item.class_def_index;
     const DexFile& dex_file = *context.GetDexFile();
     const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
     ClassLinker* class_linker = context.GetClassLinker();
@@ -2752,9 +2848,16 @@ static void CompileDexFile(CompilerDriver* driver,
     bool compilation_enabled = driver->IsClassToCompile(
         dex_file.StringByTypeIdx(class_def.class_idx_));
 
+    // Move to the first method of the work item.
+    uint32_t position = 0u;
+    for (; position != work_item.begin_method; ++position) {
+      DCHECK(it.HasNextMethod());
+      it.Next();
+    }
+
     // Compile direct and virtual methods.
     int64_t previous_method_idx = -1;
-    while (it.HasNextMethod()) {
+    for (; it.HasNextMethod() && position != work_item.end_method; ++position) {
       uint32_t method_idx = it.GetMemberIndex();
       if (method_idx == previous_method_idx) {
         // smali can create dex files with two encoded_methods sharing the same method_idx
@@ -2777,9 +2880,9 @@ static void CompileDexFile(CompilerDriver* driver,
                  dex_cache);
       it.Next();
     }
-    DCHECK(!it.HasNext());
+    DCHECK(position == work_item.end_method || !it.HasNext());
   };
-  context.ForAllLambda(0, dex_file.NumClassDefs(), compile, thread_count);
+  context.ForAllLambda(0, work_items.size(), compile, thread_count);
 }
 
 void CompilerDriver::Compile(jobject class_loader,
@@ -2982,6 +3085,11 @@ std::string CompilerDriver::GetMemoryUsageString(bool extended) const {
   const gc::Heap* const heap = Runtime::Current()->GetHeap();
   const size_t java_alloc = heap->GetBytesAllocated();
   oss << "arena alloc=" << PrettySize(max_arena_alloc_) << " (" << max_arena_alloc_ << "B)";
+  if (extended) {
+    const ArenaPool* const arena_pool = Runtime::Current()->GetArenaPool();
+    oss << " arenas new=" << arena_pool->GetNumNewArenas()
+        << " reused=" << arena_pool->GetNumReusedArenas();
+  }
   oss << " java alloc=" << PrettySize(java_alloc) << " (" << java_alloc << "B)";
 #if defined(__BIONIC__) || defined(__GLIBC__)
   const struct mallinfo info = mallinfo();
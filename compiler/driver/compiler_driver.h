@@ -338,6 +338,11 @@ class CompilerDriver {
   // Get memory usage during compilation.
   std::string GetMemoryUsageString(bool extended) const;
 
+  // The peak arena memory use of a method compilation.
+  size_t GetMaxArenaAlloc() const {
+    return max_arena_alloc_;
+  }
+
   void SetHadHardVerifierFailure() {
     had_hard_verifier_failure_ = true;
   }
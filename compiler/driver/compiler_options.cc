@@ -37,6 +37,8 @@ CompilerOptions::CompilerOptions()
       tiny_method_threshold_(kDefaultTinyMethodThreshold),
       num_dex_methods_threshold_(kDefaultNumDexMethodsThreshold),
       inline_max_code_units_(kUnsetInlineMaxCodeUnits),
+      compile_time_budget_ms_(kNoCompileTimeBudget),
+      compile_memory_budget_kb_(kNoCompileMemoryBudget),
       no_inline_from_(nullptr),
       boot_image_(false),
       core_image_(false),
@@ -61,6 +63,7 @@ CompilerOptions::CompilerOptions()
       force_determinism_(false),
       deduplicate_code_(true),
       count_hotness_in_compiled_code_(false),
+      count_hotness_in_baseline_code_(true),
       register_allocation_strategy_(RegisterAllocator::kRegisterAllocatorDefault),
       passes_to_run_(nullptr) {
 }
@@ -102,8 +105,11 @@ bool CompilerOptions::ParseRegisterAllocationStrategy(const std::string& option,
     register_allocation_strategy_ = RegisterAllocator::Strategy::kRegisterAllocatorLinearScan;
   } else if (option == "graph-color") {
     register_allocation_strategy_ = RegisterAllocator::Strategy::kRegisterAllocatorGraphColor;
+  } else if (option == "adaptive") {
+    register_allocation_strategy_ = RegisterAllocator::Strategy::kRegisterAllocatorAdaptive;
   } else {
-    *error_msg = "Unrecognized register allocation strategy. Try linear-scan, or graph-color.";
+    *error_msg = "Unrecognized register allocation strategy. "
+                 "Try linear-scan, graph-color, or adaptive.";
     return false;
   }
   return true;
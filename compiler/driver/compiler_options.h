@@ -48,6 +48,8 @@ class CompilerOptions FINAL {
   static const bool kDefaultGenerateMiniDebugInfo = false;
   static const size_t kDefaultInlineMaxCodeUnits = 32;
   static constexpr size_t kUnsetInlineMaxCodeUnits = -1;
+  static constexpr size_t kNoCompileTimeBudget = 0;
+  static constexpr size_t kNoCompileMemoryBudget = 0;
 
   CompilerOptions();
   ~CompilerOptions();
@@ -131,6 +133,18 @@ class CompilerOptions FINAL {
     inline_max_code_units_ = units;
   }
 
+  // Time after which the compilation of a method only runs the passes needed for
+  // correctness, or kNoCompileTimeBudget.
+  size_t GetCompileTimeBudgetMs() const {
+    return compile_time_budget_ms_;
+  }
+
+  // Graph arena usage after which the compilation of a method only runs the passes
+  // needed for correctness, or kNoCompileMemoryBudget.
+  size_t GetCompileMemoryBudgetKb() const {
+    return compile_memory_budget_kb_;
+  }
+
   double GetTopKProfileThreshold() const {
     return top_k_profile_threshold_;
   }
@@ -278,6 +292,14 @@ class CompilerOptions FINAL {
     return count_hotness_in_compiled_code_;
   }
 
+  bool CountHotnessInBaselineCode() const {
+    return count_hotness_in_baseline_code_;
+  }
+
+  void SetCountHotnessInBaselineCode(bool value) {
+    count_hotness_in_baseline_code_ = value;
+  }
+
  private:
   bool ParseDumpInitFailures(const std::string& option, std::string* error_msg);
   void ParseDumpCfgPasses(const StringPiece& option, UsageFn Usage);
@@ -296,6 +318,8 @@ class CompilerOptions FINAL {
   size_t tiny_method_threshold_;
   size_t num_dex_methods_threshold_;
   size_t inline_max_code_units_;
+  size_t compile_time_budget_ms_;
+  size_t compile_memory_budget_kb_;
 
   // Dex files from which we should not inline code.
   // This is usually a very short list (i.e. a single dex file), so we
@@ -344,6 +368,10 @@ class CompilerOptions FINAL {
   // won't be atomic for performance reasons, so we accept races, just like in interpreter.
   bool count_hotness_in_compiled_code_;
 
+  // Whether baseline code increments the hotness count of ArtMethod, which is how hot baseline
+  // methods get found and recompiled. Not needed when baseline code is the final JIT tier.
+  bool count_hotness_in_baseline_code_;
+
   RegisterAllocator::Strategy register_allocation_strategy_;
 
   // If not null, specifies optimization passes which will be run instead of defaults.
@@ -52,6 +52,8 @@ inline bool ReadCompilerOptions(Base& map, CompilerOptions* options, std::string
   map.AssignIfExists(Base::TinyMethodMaxThreshold, &options->tiny_method_threshold_);
   map.AssignIfExists(Base::NumDexMethodsThreshold, &options->num_dex_methods_threshold_);
   map.AssignIfExists(Base::InlineMaxCodeUnitsThreshold, &options->inline_max_code_units_);
+  map.AssignIfExists(Base::CompileTimeBudgetMs, &options->compile_time_budget_ms_);
+  map.AssignIfExists(Base::CompileMemoryBudgetKb, &options->compile_memory_budget_kb_);
   map.AssignIfExists(Base::GenerateDebugInfo, &options->generate_debug_info_);
   map.AssignIfExists(Base::GenerateMiniDebugInfo, &options->generate_mini_debug_info_);
   map.AssignIfExists(Base::GenerateBuildID, &options->generate_build_id_);
@@ -71,7 +73,7 @@ inline bool ReadCompilerOptions(Base& map, CompilerOptions* options, std::string
     options->dump_cfg_append_ = true;
   }
   if (map.Exists(Base::RegisterAllocationStrategy)) {
-    if (!options->ParseRegisterAllocationStrategy(*map.Get(Base::DumpInitFailures), error_msg)) {
+    if (!options->ParseRegisterAllocationStrategy(*map.Get(Base::RegisterAllocationStrategy), error_msg)) {
       return false;
     }
   }
@@ -123,6 +125,12 @@ inline void AddCompilerOptionsArgumentParserOptions(Builder& b) {
       .Define("--inline-max-code-units=_")
           .template WithType<unsigned int>()
           .IntoKey(Map::InlineMaxCodeUnitsThreshold)
+      .Define("--compile-time-budget-ms=_")
+          .template WithType<unsigned int>()
+          .IntoKey(Map::CompileTimeBudgetMs)
+      .Define("--compile-memory-budget-kb=_")
+          .template WithType<unsigned int>()
+          .IntoKey(Map::CompileMemoryBudgetKb)
 
       .Define({"--generate-debug-info", "-g", "--no-generate-debug-info"})
           .WithValues({true, true, false})
@@ -61,11 +61,17 @@ extern "C" void jit_unload(void* handle) {
 }
 
 extern "C" bool jit_compile_method(
-    void* handle, ArtMethod* method, Thread* self, bool osr)
+    void* handle, ArtMethod* method, Thread* self, bool baseline, bool osr)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   auto* jit_compiler = reinterpret_cast<JitCompiler*>(handle);
   DCHECK(jit_compiler != nullptr);
-  return jit_compiler->CompileMethod(self, method, osr);
+  return jit_compiler->CompileMethod(self, method, baseline, osr);
+}
+
+extern "C" void jit_dump_stats(void* handle, std::ostream* os) {
+  auto* jit_compiler = reinterpret_cast<JitCompiler*>(handle);
+  DCHECK(jit_compiler != nullptr);
+  jit_compiler->GetCompilerDriver()->GetCompiler()->DumpStats(*os);
 }
 
 extern "C" void jit_types_loaded(void* handle, mirror::Class** types, size_t count)
@@ -103,6 +109,12 @@ JitCompiler::JitCompiler() {
   // Set debuggability based on the runtime value.
   compiler_options_->SetDebuggable(Runtime::Current()->IsJavaDebuggable());
 
+  // Baseline code only needs to count hotness if it is going to be recompiled.
+  jit::JitOptions* jit_options = Runtime::Current()->GetJITOptions();
+  if (jit_options != nullptr && jit_options->IsBaselineOnly()) {
+    compiler_options_->SetCountHotnessInBaselineCode(false);
+  }
+
   const InstructionSet instruction_set = kRuntimeISA;
   for (const StringPiece option : Runtime::Current()->GetCompilerOptions()) {
     VLOG(compiler) << "JIT compiler option " << option;
@@ -157,16 +169,22 @@ JitCompiler::JitCompiler() {
         << "Generating debug info only works with one compiler thread";
     jit_logger_.reset(new JitLogger());
     jit_logger_->OpenLog();
+  } else if (jit_options != nullptr &&
+             (jit_options->WritePerfMap() || jit_options->WriteJitDump())) {
+    // Only record symbols: the logger is cheap compared to the compilation it follows,
+    // and unlike debug info it does not require keeping all jitted code alive.
+    jit_logger_.reset(new JitLogger());
+    jit_logger_->OpenLog(jit_options->WritePerfMap(), jit_options->WriteJitDump());
   }
 }
 
 JitCompiler::~JitCompiler() {
-  if (compiler_options_->GetGenerateDebugInfo()) {
+  if (jit_logger_ != nullptr) {
     jit_logger_->CloseLog();
   }
 }
 
-bool JitCompiler::CompileMethod(Thread* self, ArtMethod* method, bool osr) {
+bool JitCompiler::CompileMethod(Thread* self, ArtMethod* method, bool baseline, bool osr) {
   SCOPED_TRACE << "JIT compiling " << method->PrettyMethod();
 
   DCHECK(!method->IsProxyMethod());
@@ -183,7 +201,7 @@ bool JitCompiler::CompileMethod(Thread* self, ArtMethod* method, bool osr) {
     TimingLogger::ScopedTiming t2("Compiling", &logger);
     JitCodeCache* const code_cache = runtime->GetJit()->GetCodeCache();
     success = compiler_driver_->GetCompiler()->JitCompile(
-        self, code_cache, method, osr, jit_logger_.get());
+        self, code_cache, method, baseline, osr, jit_logger_.get());
   }
 
   // Trim maps to reduce memory usage.
@@ -24,6 +24,7 @@
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
 #include "oat_file-inl.h"
+#include "thread-current-inl.h"
 
 namespace art {
 namespace jit {
@@ -34,6 +35,12 @@ static const char* kLogPrefix = "/data/misc/trace";
 static const char* kLogPrefix = "/tmp";
 #endif
 
+void JitLogger::WriteLog(const void* ptr, size_t code_size, ArtMethod* method) {
+  MutexLock mu(Thread::Current(), lock_);
+  WritePerfMapLog(ptr, code_size, method);
+  WriteJitDumpLog(ptr, code_size, method);
+}
+
 // File format of perf-PID.map:
 // +---------------------+
 // |ADDR SIZE symbolname1|
@@ -67,8 +74,6 @@ void JitLogger::WritePerfMapLog(const void* ptr, size_t code_size, ArtMethod* me
     if (!res) {
       LOG(WARNING) << "Failed to write jitted method info in log: write failure.";
     }
-  } else {
-    LOG(WARNING) << "Failed to write jitted method info in log: log file doesn't exist.";
   }
 }
 
@@ -39,6 +39,8 @@ namespace jit {
 //     Command line Example:
 //       $ perf record dalvikvm -Xcompiler-option --generate-debug-info -cp <classpath> Test
 //       $ perf report
+//     Or, without the cost of generating debug info and keeping all jitted code alive:
+//       $ perf record dalvikvm -Xjitperfmap:true -cp <classpath> Test
 //     NOTE:
 //       - Make sure that the perf-PID.map file is available for 'perf report' tool to access,
 //         so that jitted method can be displayed.
@@ -55,6 +57,8 @@ namespace jit {
 //       $ perf inject -i perf.data -o perf.data.jitted
 //       $ perf report -i perf.data.jitted
 //       $ perf annotate -i perf.data.jitted
+//     The file can also be written without debug info by passing -Xjitdump:true instead.
+//     The kLoad records carry timestamps, so code cache collection does not confuse perf.
 //     NOTE:
 //       REQUIREMENTS
 //       - The 'perf record -k mono' option requires 4.1 (or higher) Linux kernel.
@@ -87,19 +91,25 @@ namespace jit {
 //
 class JitLogger {
  public:
-    JitLogger() : code_index_(0), marker_address_(nullptr) {}
+    JitLogger() : lock_("JIT logger lock"), code_index_(0), marker_address_(nullptr) {}
 
     void OpenLog() {
-      OpenPerfMapLog();
-      OpenJitDumpLog();
+      OpenLog(/* perf_map */ true, /* jit_dump */ true);
     }
 
-    void WriteLog(const void* ptr, size_t code_size, ArtMethod* method)
-        REQUIRES_SHARED(Locks::mutator_lock_) {
-      WritePerfMapLog(ptr, code_size, method);
-      WriteJitDumpLog(ptr, code_size, method);
+    void OpenLog(bool perf_map, bool jit_dump) {
+      if (perf_map) {
+        OpenPerfMapLog();
+      }
+      if (jit_dump) {
+        OpenJitDumpLog();
+      }
     }
 
+    // Thread-safe, JIT threads may commit code concurrently.
+    void WriteLog(const void* ptr, size_t code_size, ArtMethod* method)
+        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!lock_);
+
     void CloseLog() {
       ClosePerfMapLog();
       CloseJitDumpLog();
@@ -123,6 +133,7 @@ class JitLogger {
     void WriteJitDumpHeader();
     void WriteJitDumpDebugInfo();
 
+    Mutex lock_;
     std::unique_ptr<File> perf_file_;
     std::unique_ptr<File> jit_dump_file_;
     uint64_t code_index_;
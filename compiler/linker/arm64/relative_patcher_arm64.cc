@@ -390,6 +390,19 @@ static void EmitGrayCheckAndFastPath(arm64::Arm64Assembler& assembler,
   // Note: The fake dependency is unnecessary for the slow path.
 }
 
+// Branch to `done` if the reference in `ref_reg` is null or already marked, i.e. the mark bit
+// in its lock word is set, which the introspection entrypoint would check first as well.
+// Clobbers IP1.
+static void EmitNullOrMarkedCheck(arm64::Arm64Assembler& assembler,
+                                  vixl::aarch64::Register ref_reg,
+                                  vixl::aarch64::Label* done) {
+  using namespace vixl::aarch64;  // NOLINT(build/namespaces)
+  DCHECK(!ref_reg.Is(ip1.W()));
+  __ Cbz(ref_reg, done);
+  __ Ldr(ip1.W(), MemOperand(ref_reg.X(), mirror::Object::MonitorOffset().Int32Value()));
+  __ Tbnz(ip1.W(), LockWord::kMarkBitStateShift, done);
+}
+
 // Load the read barrier introspection entrypoint in register `entrypoint`.
 static void LoadReadBarrierMarkIntrospectionEntrypoint(arm64::Arm64Assembler& assembler,
                                                        vixl::aarch64::Register entrypoint) {
@@ -436,11 +449,24 @@ void Arm64RelativePatcher::CompileBakerReadBarrierThunk(arm64::Arm64Assembler& a
       __ Bind(&slow_path);
       MemOperand ldr_address(lr, BAKER_MARK_INTROSPECTION_FIELD_LDR_OFFSET);
       __ Ldr(ip0.W(), ldr_address);         // Load the LDR (immediate) unsigned offset.
-      LoadReadBarrierMarkIntrospectionEntrypoint(assembler, ip1);
       __ Ubfx(ip0.W(), ip0.W(), 10, 12);    // Extract the offset.
       __ Ldr(ip0.W(), MemOperand(base_reg, ip0, LSL, 2));   // Load the reference.
+      vixl::aarch64::Label return_to_ldr;
+      if (!kPoisonHeapReferences) {
+        // If the reference is null or already marked, it does not need the entrypoint:
+        // return to the LDR instruction and let it reload the reference. Any value stored
+        // into the field in the meantime by a mutator is a to-space reference as well.
+        // With heap poisoning, leave all checks to the entrypoint.
+        EmitNullOrMarkedCheck(assembler, ip0.W(), &return_to_ldr);
+      }
+      LoadReadBarrierMarkIntrospectionEntrypoint(assembler, ip1);
       // Do not unpoison. With heap poisoning enabled, the entrypoint expects a poisoned reference.
       __ Br(ip1);                           // Jump to the entrypoint.
+      if (!kPoisonHeapReferences) {
+        __ Bind(&return_to_ldr);
+        __ Add(lr, lr, BAKER_MARK_INTROSPECTION_FIELD_LDR_OFFSET);
+        __ Br(lr);
+      }
       if (holder_reg.Is(base_reg)) {
         // Add null check slow path. The stack map is at the address pointed to by LR.
         __ Bind(&throw_npe);
@@ -981,6 +981,19 @@ void Arm64RelativePatcherTest::TestBakerField(uint32_t offset, uint32_t ref_reg)
           (base_reg << 5) |         // Xn = base_reg
           base_reg;                 // Xd = base_reg
       EXPECT_EQ(fake_dependency, GetOutputInsn(gray_check_offset + 12u));
+      if (!kPoisonHeapReferences) {
+        // Verify that the slow path checks the mark bit of the loaded reference.
+        const uint32_t check_mark_bit_without_offset =
+            0x37000000u | (LockWord::kMarkBitStateShift << 19) | /* ip1 */ 17;
+        bool found_mark_bit_check = false;
+        for (size_t i = gray_check_offset; i < thunk_offset + expected_thunk.size(); i += 4u) {
+          if ((GetOutputInsn(i) & 0xfff8001fu) == check_mark_bit_without_offset) {
+            found_mark_bit_check = true;
+            break;
+          }
+        }
+        EXPECT_TRUE(found_mark_bit_check);
+      }
       // Do not check the rest of the implementation.
 
       // The next thunk follows on the next aligned offset.
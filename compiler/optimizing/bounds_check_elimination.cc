@@ -550,7 +550,8 @@ class BCEVisitor : public HGraphVisitor {
     }
     // We should never deoptimize from an osr method, otherwise we might wrongly optimize
     // code dominated by the deoptimization.
-    if (!GetGraph()->IsCompilingOsr()) {
+    if (!GetGraph()->IsCompilingOsr() &&
+        !GetGraph()->IsSpeculationDisabled(DeoptimizationKind::kBlockBCE)) {
       AddComparesWithDeoptimization(block);
     }
   }
@@ -908,6 +909,7 @@ class BCEVisitor : public HGraphVisitor {
       bool needs_finite_test = false;
       bool needs_taken_test = false;
       if (DynamicBCESeemsProfitable(loop, bounds_check->GetBlock()) &&
+          !GetGraph()->IsSpeculationDisabled(DeoptimizationKind::kLoopBoundsBCE) &&
           induction_range_.CanGenerateRange(
               bounds_check, index, &needs_finite_test, &needs_taken_test) &&
           CanHandleInfiniteLoop(loop, index, needs_finite_test) &&
@@ -917,6 +919,10 @@ class BCEVisitor : public HGraphVisitor {
         TransformLoopForDynamicBCE(loop, bounds_check);
         return;
       }
+      // Try loop-based dynamic elimination of a masked index.
+      if (TryDynamicBCEForMaskedIndex(loop, bounds_check)) {
+        return;
+      }
       // Otherwise, prepare dominator-based dynamic elimination.
       if (first_index_bounds_check_map_.find(array_length->GetId()) ==
           first_index_bounds_check_map_.end()) {
@@ -928,6 +934,55 @@ class BCEVisitor : public HGraphVisitor {
     }
   }
 
+  void VisitNullCheck(HNullCheck* check) OVERRIDE {
+    // Try to replace a null check on a loop-invariant reference by a single
+    // deoptimization test in the loop preheader.
+    HLoopInformation* loop = check->GetBlock()->GetLoopInformation();
+    HInstruction* object = check->InputAt(0);
+    bool needs_taken_test = false;
+    if (loop != nullptr &&
+        !GetGraph()->IsSpeculationDisabled(DeoptimizationKind::kLoopNullBCE) &&
+        loop->IsDefinedOutOfTheLoop(object) &&
+        CanHoistCheckIntoPreHeader(loop, check, &needs_taken_test)) {
+      // Generate: if (object == null) deoptimize;
+      TransformLoopForDeoptimizationIfNeeded(loop, needs_taken_test);
+      HBasicBlock* block = GetPreHeader(loop, check);
+      HInstruction* cond =
+          new (GetGraph()->GetAllocator()) HEqual(object, GetGraph()->GetNullConstant());
+      InsertDeoptInLoop(loop, block, cond, DeoptimizationKind::kLoopNullBCE);
+      ReplaceInstruction(check, object);
+    }
+  }
+
+  void VisitCheckCast(HCheckCast* check) OVERRIDE {
+    // Try to replace an exact type check on a loop-invariant, non-null reference
+    // by a single deoptimization test in the loop preheader. Other type check
+    // kinds may call into the runtime, and a null reference would pass the cast
+    // but fail the instance-of test, so those are left alone.
+    HLoopInformation* loop = check->GetBlock()->GetLoopInformation();
+    HInstruction* object = check->InputAt(0);
+    HLoadClass* target_class = check->GetTargetClass();
+    bool needs_taken_test = false;
+    if (loop != nullptr &&
+        check->GetTypeCheckKind() == TypeCheckKind::kExactCheck &&
+        !GetGraph()->IsSpeculationDisabled(DeoptimizationKind::kLoopCheckCast) &&
+        (!check->MustDoNullCheck() || !object->CanBeNull()) &&
+        loop->IsDefinedOutOfTheLoop(object) &&
+        loop->IsDefinedOutOfTheLoop(target_class) &&
+        CanHoistCheckIntoPreHeader(loop, check, &needs_taken_test)) {
+      // Generate: if (!(object instanceof target_class)) deoptimize;
+      TransformLoopForDeoptimizationIfNeeded(loop, needs_taken_test);
+      HBasicBlock* block = GetPreHeader(loop, check);
+      HInstanceOf* instance_of = new (GetGraph()->GetAllocator()) HInstanceOf(
+          object, target_class, TypeCheckKind::kExactCheck, check->GetDexPc());
+      instance_of->ClearMustDoNullCheck();
+      block->InsertInstructionBefore(instance_of, block->GetLastInstruction());
+      HInstruction* cond = new (GetGraph()->GetAllocator()) HBooleanNot(instance_of);
+      InsertDeoptInLoop(loop, block, cond, DeoptimizationKind::kLoopCheckCast);
+      check->GetBlock()->RemoveInstruction(check);
+    }
+  }
+
   static bool HasSameInputAtBackEdges(HPhi* phi) {
     DCHECK(phi->IsLoopHeaderPhi());
     HConstInputsRef inputs = phi->GetInputs();
@@ -1119,27 +1174,114 @@ class BCEVisitor : public HGraphVisitor {
     FindAndHandlePartialArrayLength(div);
   }
 
+  // Handles a right shift by a constant of a value with a known non-negative
+  // value range, e.g. array[i >> 1] inside 'for (int i = 0; i < array.length; i++)'.
+  // Shifting a non-negative value right never increases it, so the shifted value
+  // stays within the lower bound shifted and the (unshifted) upper bound.
+  bool HandleShiftOfNonNegative(HBinaryOperation* instruction) {
+    DCHECK(instruction->IsShr() || instruction->IsUShr());
+    HInstruction* right = instruction->GetRight();
+    if (instruction->GetType() != DataType::Type::kInt32 || !right->IsIntConstant()) {
+      return false;
+    }
+    ValueRange* left_range = LookupValueRange(instruction->GetLeft(), instruction->GetBlock());
+    if (left_range == nullptr ||
+        !left_range->GetLower().IsConstant() ||
+        left_range->GetLower().GetConstant() < 0) {
+      return false;
+    }
+    int32_t distance = right->AsIntConstant()->GetValue() & kMaxIntShiftDistance;
+    ValueBound lower = ValueBound(nullptr, left_range->GetLower().GetConstant() >> distance);
+    ValueBound upper = left_range->GetUpper();
+    if (upper.IsConstant()) {
+      upper = ValueBound(nullptr, upper.GetConstant() >> distance);
+    }
+    ValueRange* range = new (&allocator_) ValueRange(&allocator_, lower, upper);
+    AssignRange(instruction->GetBlock(), instruction, range);
+    return true;
+  }
+
   void VisitShr(HShr* shr) OVERRIDE {
-    FindAndHandlePartialArrayLength(shr);
+    if (!HandleShiftOfNonNegative(shr)) {
+      FindAndHandlePartialArrayLength(shr);
+    }
   }
 
   void VisitUShr(HUShr* ushr) OVERRIDE {
-    FindAndHandlePartialArrayLength(ushr);
+    if (!HandleShiftOfNonNegative(ushr)) {
+      FindAndHandlePartialArrayLength(ushr);
+    }
+  }
+
+  // Returns true if `mask` has the form (array_length + c) with c < 0,
+  // i.e. array.length - 1 as typically used to mask hash table indices.
+  static bool IsArrayLengthMask(HInstruction* mask, /* out */ HInstruction** array_length,
+                                /* out */ int32_t* c) {
+    HInstruction* left;
+    int32_t right_const;
+    if (ValueBound::IsAddOrSubAConstant(mask, &left, &right_const) &&
+        left->IsArrayLength() &&
+        right_const < 0) {
+      *array_length = left;
+      *c = right_const;
+      return true;
+    }
+    return false;
   }
 
   void VisitAnd(HAnd* instruction) OVERRIDE {
+    HBasicBlock* block = instruction->GetBlock();
+    ValueRange* range = nullptr;
     if (instruction->GetRight()->IsIntConstant()) {
       int32_t constant = instruction->GetRight()->AsIntConstant()->GetValue();
       if (constant > 0) {
         // constant serves as a mask so any number masked with it
         // gets a [0, constant] value range.
-        ValueRange* range = new (&allocator_) ValueRange(
+        range = new (&allocator_) ValueRange(
             &allocator_,
             ValueBound(nullptr, 0),
             ValueBound(nullptr, constant));
-        AssignRange(instruction->GetBlock(), instruction, range);
       }
     }
+    if (instruction->GetType() != DataType::Type::kInt32) {
+      if (range != nullptr) {
+        AssignRange(block, instruction, range);
+      }
+      return;
+    }
+    // Any number masked with a non-negative value v gets a [0, v] value range.
+    // Try both operands, and keep the narrowest result.
+    for (HInstruction* operand : { instruction->GetLeft(), instruction->GetRight() }) {
+      if (operand->IsIntConstant()) {
+        continue;
+      }
+      ValueRange* operand_range = nullptr;
+      HInstruction* array_length = nullptr;
+      int32_t c = 0;
+      if (IsArrayLengthMask(operand, &array_length, &c)) {
+        // (array.length + c) is non-negative if array.length >= -c is already known,
+        // e.g. from an earlier constant index access or a preceding comparison.
+        ValueRange* length_range = LookupValueRange(array_length, block);
+        if (length_range != nullptr &&
+            length_range->GetLower().IsConstant() &&
+            length_range->GetLower().GetConstant() >= -c) {
+          operand_range = new (&allocator_) ValueRange(
+              &allocator_, ValueBound(nullptr, 0), ValueBound(array_length, c));
+        }
+      } else {
+        operand_range = LookupValueRange(operand, block);
+      }
+      if (operand_range != nullptr &&
+          operand_range->GetLower().IsConstant() &&
+          operand_range->GetLower().GetConstant() >= 0) {
+        ValueRange* masked_range = new (&allocator_) ValueRange(
+            &allocator_, ValueBound(nullptr, 0), operand_range->GetUpper());
+        range = (range == nullptr) ? masked_range : range->Narrow(masked_range);
+      }
+    }
+    if (range != nullptr) {
+      AssignRange(block, instruction, range);
+    }
   }
 
   void VisitRem(HRem* instruction) OVERRIDE {
@@ -1545,6 +1687,88 @@ class BCEVisitor : public HGraphVisitor {
     }
   }
 
+  /**
+   * Performs loop-based dynamic elimination on a bounds check with a masked index,
+   * such as array[hash & (array.length - 1)] in hash table or ring buffer kernels.
+   * Any such index is within bounds as soon as array.length >= 1, so a single
+   * deoptimization test on the loop-invariant array length in the loop preheader
+   * replaces the per-iteration bounds check:
+   *
+   *   if (array.length < 1) deoptimize;
+   *   for (...) {
+   *     array[hash & (array.length - 1)];  // no bounds check
+   *   }
+   */
+  bool TryDynamicBCEForMaskedIndex(HLoopInformation* loop, HBoundsCheck* bounds_check) {
+    HInstruction* index = bounds_check->InputAt(0);
+    HInstruction* length = bounds_check->InputAt(1);
+    if (!index->IsAnd() ||
+        index->GetType() != DataType::Type::kInt32 ||
+        !length->IsArrayLength() ||
+        !DynamicBCESeemsProfitable(loop, bounds_check->GetBlock()) ||
+        GetGraph()->IsSpeculationDisabled(DeoptimizationKind::kLoopBoundsBCE) ||
+        !loop->IsDefinedOutOfTheLoop(length)) {
+      return false;
+    }
+    HInstruction* array_length = nullptr;
+    int32_t c = 0;
+    HAnd* masked = index->AsAnd();
+    if (!(IsArrayLengthMask(masked->GetRight(), &array_length, &c) &&
+          ValueBound::Equal(array_length, length)) &&
+        !(IsArrayLengthMask(masked->GetLeft(), &array_length, &c) &&
+          ValueBound::Equal(array_length, length))) {
+      return false;
+    }
+    if (c == std::numeric_limits<int32_t>::min()) {
+      return false;
+    }
+    // Generate: if (array.length < -c) deoptimize;
+    HBasicBlock* block = GetPreHeader(loop, bounds_check);
+    HInstruction* cond = new (GetGraph()->GetAllocator())
+        HLessThan(length, GetGraph()->GetIntConstant(-c));
+    InsertDeoptInLoop(loop, block, cond);
+    ReplaceInstruction(bounds_check, index);
+    // Let subsequent masked accesses in dominated code reuse the test.
+    ValueRange* range = new (&allocator_) ValueRange(
+        &allocator_, ValueBound(nullptr, -c), ValueBound::Max());
+    AssignRange(bounds_check->GetBlock(), length, range);
+    return true;
+  }
+
+  /**
+   * Returns true if a check on loop-invariant operands that is executed in every
+   * iteration of the loop can be replaced by a deoptimization test in the preheader.
+   * A check in the loop header is executed as soon as the loop is reached. A check
+   * in the loop-body requires a taken-test, which is only available if the trip
+   * count can be derived from the induction variable that controls the loop.
+   */
+  bool CanHoistCheckIntoPreHeader(HLoopInformation* loop,
+                                  HInstruction* check,
+                                  /* out */ bool* needs_taken_test) {
+    if (loop->GetSuspendCheck() == nullptr ||
+        !DynamicBCESeemsProfitable(loop, check->GetBlock())) {
+      return false;
+    }
+    HBasicBlock* header = loop->GetHeader();
+    if (check->GetBlock() == header) {
+      *needs_taken_test = false;
+      return true;
+    }
+    HInstruction* control = header->GetLastInstruction();
+    if (control->IsIf() && control->InputAt(0)->IsCondition()) {
+      HCondition* condition = control->InputAt(0)->AsCondition();
+      bool needs_finite_test = false;
+      for (HInstruction* operand : { condition->GetLeft(), condition->GetRight() }) {
+        if (operand->IsPhi() && operand->GetBlock() == header &&
+            induction_range_.CanGenerateRange(
+                check, operand, &needs_finite_test, needs_taken_test)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
   /**
    * Returns true if heuristics indicate that dynamic bce may be profitable.
    */
@@ -1628,13 +1852,14 @@ class BCEVisitor : public HGraphVisitor {
       return true;
     } else if (check->IsNullCheck() && check->GetBlock()->GetLoopInformation() == loop) {
       HInstruction* array = check->InputAt(0);
-      if (loop->IsDefinedOutOfTheLoop(array)) {
+      if (loop->IsDefinedOutOfTheLoop(array) &&
+          !GetGraph()->IsSpeculationDisabled(DeoptimizationKind::kLoopNullBCE)) {
         // Generate: if (array == null) deoptimize;
         TransformLoopForDeoptimizationIfNeeded(loop, needs_taken_test);
         HBasicBlock* block = GetPreHeader(loop, check);
         HInstruction* cond =
             new (GetGraph()->GetAllocator()) HEqual(array, GetGraph()->GetNullConstant());
-        InsertDeoptInLoop(loop, block, cond, /* is_null_check */ true);
+        InsertDeoptInLoop(loop, block, cond, DeoptimizationKind::kLoopNullBCE);
         ReplaceInstruction(check, array);
         return true;
       }
@@ -1703,11 +1928,9 @@ class BCEVisitor : public HGraphVisitor {
   void InsertDeoptInLoop(HLoopInformation* loop,
                          HBasicBlock* block,
                          HInstruction* condition,
-                         bool is_null_check = false) {
+                         DeoptimizationKind kind = DeoptimizationKind::kLoopBoundsBCE) {
     HInstruction* suspend = loop->GetSuspendCheck();
     block->InsertInstructionBefore(condition, block->GetLastInstruction());
-    DeoptimizationKind kind =
-        is_null_check ? DeoptimizationKind::kLoopNullBCE : DeoptimizationKind::kLoopBoundsBCE;
     HDeoptimize* deoptimize = new (GetGraph()->GetAllocator()) HDeoptimize(
         GetGraph()->GetAllocator(), condition, kind, suspend->GetDexPc());
     block->InsertInstructionBefore(deoptimize, block->GetLastInstruction());
@@ -1939,7 +2162,9 @@ class BCEVisitor : public HGraphVisitor {
 };
 
 void BoundsCheckElimination::Run() {
-  if (!graph_->HasBoundsChecks()) {
+  // Besides bounds checks, null checks and type checks in loops are candidates
+  // for replacement by a deoptimization test in the loop preheader.
+  if (!graph_->HasBoundsChecks() && !graph_->HasLoops()) {
     return;
   }
 
@@ -16,6 +16,9 @@
 
 #include "cha_guard_optimization.h"
 
+#include "base/scoped_arena_allocator.h"
+#include "base/scoped_arena_containers.h"
+
 namespace art {
 
 // Note we can only do CHA guard elimination/motion in a single pass, since
@@ -34,9 +37,10 @@ class CHAGuardVisitor : HGraphVisitor {
  public:
   explicit CHAGuardVisitor(HGraph* graph)
       : HGraphVisitor(graph),
+        allocator_(graph->GetArenaStack()),
         block_has_cha_guard_(GetGraph()->GetBlocks().size(),
                              0,
-                             graph->GetAllocator()->Adapter(kArenaAllocCHA)),
+                             allocator_.Adapter(kArenaAllocCHA)),
         instruction_iterator_(nullptr) {
     number_of_guards_to_visit_ = GetGraph()->GetNumberOfCHAGuards();
     DCHECK_NE(number_of_guards_to_visit_, 0u);
@@ -57,10 +61,13 @@ class CHAGuardVisitor : HGraphVisitor {
   // Return true if `flag` is hoisted.
   bool HoistGuard(HShouldDeoptimizeFlag* flag, HInstruction* receiver);
 
+  // Pass-local data lives on the graph's arena stack and is released with the visitor.
+  ScopedArenaAllocator allocator_;
+
   // Record if each block has any CHA guard. It's updated during the
-  // reverse post order visit. Use int instead of bool since ArenaVector
+  // reverse post order visit. Use int instead of bool since ScopedArenaVector
   // does not support bool.
-  ArenaVector<int> block_has_cha_guard_;
+  ScopedArenaVector<int> block_has_cha_guard_;
 
   // The iterator that's being used for this visitor. Need it to manually
   // advance the iterator due to removing/moving more than one instruction.
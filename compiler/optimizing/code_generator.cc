@@ -40,6 +40,7 @@
 #include "code_generator_mips64.h"
 #endif
 
+#include "art_method-inl.h"
 #include "base/bit_utils.h"
 #include "base/bit_utils_iterator.h"
 #include "base/casts.h"
@@ -58,6 +59,7 @@
 #include "mirror/object_reference.h"
 #include "mirror/reference.h"
 #include "mirror/string.h"
+#include "optimizing/optimizing_compiler.h"
 #include "parallel_move_resolver.h"
 #include "scoped_thread_state_change-inl.h"
 #include "ssa_liveness_analysis.h"
@@ -70,6 +72,9 @@ namespace art {
 // If true, we record the static and direct invokes in the invoke infos.
 static constexpr bool kEnableDexLayoutOptimizations = false;
 
+// Rough number of bytes of code per HIR instruction, used to size the code buffer up front.
+static constexpr size_t kReservedCodeBytesPerInstruction = 8u;
+
 // Return whether a location is consistent with a type.
 static bool CheckType(DataType::Type type, Location location) {
   if (location.IsFpuRegister()
@@ -387,6 +392,11 @@ void CodeGenerator::Compile(CodeAllocator* allocator) {
   DCHECK(block_order_ != nullptr);
   Initialize();
 
+  // Emitting large methods would otherwise grow the code buffer several times, copying the
+  // code each time and leaving the old buffers behind in the arena.
+  size_t instruction_count = static_cast<size_t>(GetGraph()->GetCurrentInstructionId());
+  GetAssembler()->ReserveCodeSpace(instruction_count * kReservedCodeBytesPerInstruction);
+
   HGraphVisitor* instruction_visitor = GetInstructionVisitor();
   DCHECK_EQ(current_block_index_, 0u);
 
@@ -1169,6 +1179,28 @@ void CodeGenerator::AddSlowPath(SlowPathCode* slow_path) {
   code_generation_data_->AddSlowPath(slow_path);
 }
 
+// Returns the index which the runtime looks up in the dex cache of the caller to
+// find the method inlined in `environment`: the method's own index if it comes from
+// the caller's dex file, otherwise the index referenced by the invoke at the call site.
+static uint32_t GetInlinedMethodIndex(HEnvironment* environment) {
+  ArtMethod* method = environment->GetMethod();
+  HEnvironment* caller_environment = environment->GetParent();
+  if (environment->GetDexPc() == static_cast<uint32_t>(-1) ||
+      EncodeArtMethodInInlineInfo(method) ||
+      caller_environment->GetMethod() == nullptr) {
+    return dex::kDexNoIndex;
+  }
+  ScopedObjectAccess soa(Thread::Current());
+  ArtMethod* caller = caller_environment->GetMethod();
+  if (IsSameDexFile(*method->GetDexFile(), *caller->GetDexFile())) {
+    return method->GetDexMethodIndex();
+  }
+  CodeItemInstructionAccessor accessor(caller->DexInstructions());
+  const Instruction& instruction = accessor.InstructionAt(caller_environment->GetDexPc());
+  DCHECK(instruction.IsInvoke()) << instruction.Name();
+  return instruction.VRegB();
+}
+
 void CodeGenerator::EmitEnvironment(HEnvironment* environment, SlowPathCode* slow_path) {
   if (environment == nullptr) return;
 
@@ -1179,7 +1211,8 @@ void CodeGenerator::EmitEnvironment(HEnvironment* environment, SlowPathCode* slo
     stack_map_stream->BeginInlineInfoEntry(environment->GetMethod(),
                                            environment->GetDexPc(),
                                            environment->Size(),
-                                           &graph_->GetDexFile());
+                                           &graph_->GetDexFile(),
+                                           GetInlinedMethodIndex(environment));
   }
 
   // Walk over the environment, and record the location of dex registers.
@@ -258,6 +258,13 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
 
   const CompilerOptions& GetCompilerOptions() const { return compiler_options_; }
 
+  // Whether the generated code increments the hotness count of the method on
+  // method entry and on loop back edges.
+  bool ShouldCountHotness() const {
+    return compiler_options_.CountHotnessInCompiledCode() ||
+        (graph_->IsCompilingBaseline() && compiler_options_.CountHotnessInBaselineCode());
+  }
+
   // Saves the register in the stack. Returns the size taken on stack.
   virtual size_t SaveCoreRegister(size_t stack_index, uint32_t reg_id) = 0;
   // Restores the register from the stack. Returns the size taken on stack.
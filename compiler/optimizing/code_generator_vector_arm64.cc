@@ -889,6 +889,150 @@ void InstructionCodeGeneratorARM64::VisitVecUShr(HVecUShr* instruction) {
   }
 }
 
+void LocationsBuilderARM64::VisitVecCondition(HVecCondition* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetAllocator(), instruction);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecCondition(HVecCondition* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  VRegister lhs = VRegisterFrom(locations->InAt(0));
+  VRegister rhs = VRegisterFrom(locations->InAt(1));
+  VRegister dst = VRegisterFrom(locations->Out());
+  switch (instruction->GetPackedType()) {
+    case DataType::Type::kBool:
+    case DataType::Type::kUint8:
+    case DataType::Type::kInt8:
+      DCHECK_EQ(16u, instruction->GetVectorLength());
+      lhs = lhs.V16B();
+      rhs = rhs.V16B();
+      dst = dst.V16B();
+      break;
+    case DataType::Type::kUint16:
+    case DataType::Type::kInt16:
+      DCHECK_EQ(8u, instruction->GetVectorLength());
+      lhs = lhs.V8H();
+      rhs = rhs.V8H();
+      dst = dst.V8H();
+      break;
+    case DataType::Type::kInt32:
+      DCHECK_EQ(4u, instruction->GetVectorLength());
+      lhs = lhs.V4S();
+      rhs = rhs.V4S();
+      dst = dst.V4S();
+      break;
+    case DataType::Type::kInt64:
+      DCHECK_EQ(2u, instruction->GetVectorLength());
+      lhs = lhs.V2D();
+      rhs = rhs.V2D();
+      dst = dst.V2D();
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type";
+      UNREACHABLE();
+  }
+  // The "less" conditions are implemented by swapping the operands of the "greater" ones.
+  switch (instruction->GetCondition()) {
+    case kCondEQ:
+      __ Cmeq(dst, lhs, rhs);
+      break;
+    case kCondNE:
+      __ Cmeq(dst, lhs, rhs);
+      __ Not(dst.V16B(), dst.V16B());  // lanes do not matter
+      break;
+    case kCondLT:
+      __ Cmgt(dst, rhs, lhs);
+      break;
+    case kCondLE:
+      __ Cmge(dst, rhs, lhs);
+      break;
+    case kCondGT:
+      __ Cmgt(dst, lhs, rhs);
+      break;
+    case kCondGE:
+      __ Cmge(dst, lhs, rhs);
+      break;
+    case kCondB:
+      __ Cmhi(dst, rhs, lhs);
+      break;
+    case kCondBE:
+      __ Cmhs(dst, rhs, lhs);
+      break;
+    case kCondA:
+      __ Cmhi(dst, lhs, rhs);
+      break;
+    case kCondAE:
+      __ Cmhs(dst, lhs, rhs);
+      break;
+  }
+}
+
+void LocationsBuilderARM64::VisitVecSelect(HVecSelect* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
+  switch (instruction->GetPackedType()) {
+    case DataType::Type::kBool:
+    case DataType::Type::kUint8:
+    case DataType::Type::kInt8:
+    case DataType::Type::kUint16:
+    case DataType::Type::kInt16:
+    case DataType::Type::kInt32:
+    case DataType::Type::kInt64:
+    case DataType::Type::kFloat32:
+    case DataType::Type::kFloat64:
+      locations->SetInAt(0, Location::RequiresFpuRegister());
+      locations->SetInAt(1, Location::RequiresFpuRegister());
+      locations->SetInAt(2, Location::RequiresFpuRegister());
+      locations->SetOut(Location::SameAsFirstInput());
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type";
+      UNREACHABLE();
+  }
+}
+
+void InstructionCodeGeneratorARM64::VisitVecSelect(HVecSelect* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  VRegister mask = VRegisterFrom(locations->InAt(0));
+  VRegister true_value = VRegisterFrom(locations->InAt(1));
+  VRegister false_value = VRegisterFrom(locations->InAt(2));
+  DCHECK(locations->InAt(0).Equals(locations->Out()));
+  switch (instruction->GetPackedType()) {
+    case DataType::Type::kBool:
+    case DataType::Type::kUint8:
+    case DataType::Type::kInt8:
+    case DataType::Type::kUint16:
+    case DataType::Type::kInt16:
+    case DataType::Type::kInt32:
+    case DataType::Type::kInt64:
+    case DataType::Type::kFloat32:
+    case DataType::Type::kFloat64:
+      // Bitwise select into the mask register: mask = (mask & true) | (~mask & false).
+      __ Bsl(mask.V16B(), true_value.V16B(), false_value.V16B());  // lanes do not matter
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type";
+      UNREACHABLE();
+  }
+}
+
+void LocationsBuilderARM64::VisitVecAnyTrue(HVecAnyTrue* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+}
+
+void InstructionCodeGeneratorARM64::VisitVecAnyTrue(HVecAnyTrue* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  VRegister mask = VRegisterFrom(locations->InAt(0));
+  VRegister tmp = VRegisterFrom(locations->GetTemp(0));
+  Register dst = OutputRegister(instruction);
+  // Mask components are all ones or all zeros, so any component is set
+  // if and only if the maximum byte is set; lanes do not matter.
+  __ Umaxv(tmp.B(), mask.V16B());
+  __ Umov(dst, tmp.V16B(), 0);
+  __ And(dst, dst, 1);
+}
+
 void LocationsBuilderARM64::VisitVecSetScalars(HVecSetScalars* instruction) {
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
 
@@ -936,6 +936,209 @@ void InstructionCodeGeneratorX86_64::VisitVecUShr(HVecUShr* instruction) {
   }
 }
 
+// Emits dst = dst == src ? -1 : 0 for each component of the given packed type.
+static void EmitPackedEqual(X86_64Assembler* assembler,
+                            DataType::Type type,
+                            XmmRegister dst,
+                            XmmRegister src) {
+  switch (type) {
+    case DataType::Type::kBool:
+    case DataType::Type::kUint8:
+    case DataType::Type::kInt8:
+      assembler->pcmpeqb(dst, src);
+      break;
+    case DataType::Type::kUint16:
+    case DataType::Type::kInt16:
+      assembler->pcmpeqw(dst, src);
+      break;
+    case DataType::Type::kInt32:
+      assembler->pcmpeqd(dst, src);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type";
+      UNREACHABLE();
+  }
+}
+
+// Emits dst = dst > src ? -1 : 0 (signed) for each component of the given packed type.
+static void EmitPackedGreater(X86_64Assembler* assembler,
+                              DataType::Type type,
+                              XmmRegister dst,
+                              XmmRegister src) {
+  switch (type) {
+    case DataType::Type::kBool:
+    case DataType::Type::kUint8:
+    case DataType::Type::kInt8:
+      assembler->pcmpgtb(dst, src);
+      break;
+    case DataType::Type::kUint16:
+    case DataType::Type::kInt16:
+      assembler->pcmpgtw(dst, src);
+      break;
+    case DataType::Type::kInt32:
+      assembler->pcmpgtd(dst, src);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type";
+      UNREACHABLE();
+  }
+}
+
+// Emits dst = min(dst, src) or dst = max(dst, src) (unsigned) for each component.
+static void EmitPackedUnsignedMinMax(X86_64Assembler* assembler,
+                                     DataType::Type type,
+                                     XmmRegister dst,
+                                     XmmRegister src,
+                                     bool is_min) {
+  switch (type) {
+    case DataType::Type::kBool:
+    case DataType::Type::kUint8:
+    case DataType::Type::kInt8:
+      if (is_min) {
+        assembler->pminub(dst, src);
+      } else {
+        assembler->pmaxub(dst, src);
+      }
+      break;
+    case DataType::Type::kUint16:
+    case DataType::Type::kInt16:
+      if (is_min) {
+        assembler->pminuw(dst, src);
+      } else {
+        assembler->pmaxuw(dst, src);
+      }
+      break;
+    case DataType::Type::kInt32:
+      if (is_min) {
+        assembler->pminud(dst, src);
+      } else {
+        assembler->pmaxud(dst, src);
+      }
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type";
+      UNREACHABLE();
+  }
+}
+
+void LocationsBuilderX86_64::VisitVecCondition(HVecCondition* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetAllocator(), instruction);
+  instruction->GetLocations()->AddTemp(Location::RequiresFpuRegister());
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecCondition(HVecCondition* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  DCHECK(locations->InAt(0).Equals(locations->Out()));
+  XmmRegister src = locations->InAt(1).AsFpuRegister<XmmRegister>();
+  XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  XmmRegister tmp = locations->GetTemp(0).AsFpuRegister<XmmRegister>();
+  X86_64Assembler* assembler = down_cast<X86_64Assembler*>(GetAssembler());
+  DataType::Type type = instruction->GetPackedType();
+  DCHECK_EQ(16u, instruction->GetVectorNumberOfBytes());
+  // SSE only has packed "equal" and signed "greater", so the other conditions
+  // are obtained by swapping operands, negating the result, or, for unsigned
+  // comparisons, testing x >= y as max(x, y) == x and x <= y as min(x, y) == x.
+  bool negate = false;
+  switch (instruction->GetCondition()) {
+    case kCondNE:
+      negate = true;
+      FALLTHROUGH_INTENDED;
+    case kCondEQ:
+      EmitPackedEqual(assembler, type, dst, src);
+      break;
+    case kCondGE:
+      negate = true;
+      FALLTHROUGH_INTENDED;
+    case kCondLT:
+      __ movaps(tmp, src);
+      EmitPackedGreater(assembler, type, tmp, dst);
+      __ movaps(dst, tmp);
+      break;
+    case kCondLE:
+      negate = true;
+      FALLTHROUGH_INTENDED;
+    case kCondGT:
+      EmitPackedGreater(assembler, type, dst, src);
+      break;
+    case kCondB:
+      negate = true;
+      FALLTHROUGH_INTENDED;
+    case kCondAE:
+      __ movaps(tmp, dst);
+      EmitPackedUnsignedMinMax(assembler, type, tmp, src, /*is_min*/ false);
+      EmitPackedEqual(assembler, type, dst, tmp);
+      break;
+    case kCondA:
+      negate = true;
+      FALLTHROUGH_INTENDED;
+    case kCondBE:
+      __ movaps(tmp, dst);
+      EmitPackedUnsignedMinMax(assembler, type, tmp, src, /*is_min*/ true);
+      EmitPackedEqual(assembler, type, dst, tmp);
+      break;
+  }
+  if (negate) {
+    __ pcmpeqb(tmp, tmp);  // all ones
+    __ pxor(dst, tmp);
+  }
+}
+
+void LocationsBuilderX86_64::VisitVecSelect(HVecSelect* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
+  switch (instruction->GetPackedType()) {
+    case DataType::Type::kBool:
+    case DataType::Type::kUint8:
+    case DataType::Type::kInt8:
+    case DataType::Type::kUint16:
+    case DataType::Type::kInt16:
+    case DataType::Type::kInt32:
+    case DataType::Type::kInt64:
+    case DataType::Type::kFloat32:
+    case DataType::Type::kFloat64:
+      locations->SetInAt(0, Location::RequiresFpuRegister());
+      locations->SetInAt(1, Location::RequiresFpuRegister());
+      locations->SetInAt(2, Location::RequiresFpuRegister());
+      locations->SetOut(Location::SameAsFirstInput());
+      locations->AddTemp(Location::RequiresFpuRegister());
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type";
+      UNREACHABLE();
+  }
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecSelect(HVecSelect* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  DCHECK(locations->InAt(0).Equals(locations->Out()));
+  XmmRegister true_value = locations->InAt(1).AsFpuRegister<XmmRegister>();
+  XmmRegister false_value = locations->InAt(2).AsFpuRegister<XmmRegister>();
+  XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  XmmRegister tmp = locations->GetTemp(0).AsFpuRegister<XmmRegister>();
+  // dst = (mask & true_value) | (~mask & false_value); lanes do not matter.
+  __ movaps(tmp, dst);
+  __ pand(dst, true_value);
+  __ pandn(tmp, false_value);
+  __ por(dst, tmp);
+}
+
+void LocationsBuilderX86_64::VisitVecAnyTrue(HVecAnyTrue* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresRegister());
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecAnyTrue(HVecAnyTrue* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  XmmRegister mask = locations->InAt(0).AsFpuRegister<XmmRegister>();
+  CpuRegister dst = locations->Out().AsRegister<CpuRegister>();
+  // Gather the sign bits of all bytes into 16 bits, which are nonzero if and only
+  // if any mask component is set; lanes do not matter. Adding 0xffff carries into
+  // bit 16 exactly for a nonzero value, which avoids needing a byte register.
+  __ pmovmskb(dst, mask);
+  __ addl(dst, Immediate(0xffff));
+  __ shrl(dst, Immediate(16));
+}
+
 void LocationsBuilderX86_64::VisitVecSetScalars(HVecSetScalars* instruction) {
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
 
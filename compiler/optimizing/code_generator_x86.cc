@@ -1061,7 +1061,7 @@ void CodeGeneratorX86::GenerateFrameEntry() {
       IsLeafMethod() && !FrameNeedsStackCheck(GetFrameSize(), InstructionSet::kX86);
   DCHECK(GetCompilerOptions().GetImplicitStackOverflowChecks());
 
-  if (GetCompilerOptions().CountHotnessInCompiledCode()) {
+  if (ShouldCountHotness()) {
     __ addw(Address(kMethodRegisterArgument, ArtMethod::HotnessCountOffset().Int32Value()),
             Immediate(1));
   }
@@ -1366,14 +1366,16 @@ void InstructionCodeGeneratorX86::HandleGoto(HInstruction* got, HBasicBlock* suc
 
   HLoopInformation* info = block->GetLoopInformation();
   if (info != nullptr && info->IsBackEdge(*block) && info->HasSuspendCheck()) {
-    if (codegen_->GetCompilerOptions().CountHotnessInCompiledCode()) {
+    if (codegen_->ShouldCountHotness()) {
       __ pushl(EAX);
       __ movl(EAX, Address(ESP, kX86WordSize));
       __ addw(Address(EAX, ArtMethod::HotnessCountOffset().Int32Value()), Immediate(1));
       __ popl(EAX);
     }
-    GenerateSuspendCheck(info->GetSuspendCheck(), successor);
-    return;
+    if (!info->GetSuspendCheck()->IsNoOp()) {
+      GenerateSuspendCheck(info->GetSuspendCheck(), successor);
+      return;
+    }
   }
 
   if (block->IsEntryBlock() && (previous != nullptr) && previous->IsSuspendCheck()) {
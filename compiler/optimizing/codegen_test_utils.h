@@ -247,6 +247,9 @@ static void VerifyGeneratedCode(InstructionSet target_isa,
   CodeSimulatorContainer simulator(target_isa);
   if (simulator.CanSimulate()) {
     Expected result = SimulatorExecute<Expected>(simulator.Get(), f);
+    // The simulated instruction count gives a host-side estimate of the cost of the code.
+    VLOG(compiler) << "Executed " << simulator.Get()->GetInstructionCount()
+                   << " simulated " << target_isa << " instructions";
     if (has_result) {
       ASSERT_EQ(expected, result);
     }
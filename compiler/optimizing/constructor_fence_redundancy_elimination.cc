@@ -19,6 +19,7 @@
 #include "base/arena_allocator.h"
 #include "base/scoped_arena_allocator.h"
 #include "base/scoped_arena_containers.h"
+#include "escape.h"
 
 namespace art {
 
@@ -250,7 +251,67 @@ class CFREVisitor : public HGraphVisitor {
   DISALLOW_COPY_AND_ASSIGN(CFREVisitor);
 };
 
+// Returns true if `allocation` never becomes visible to another thread, in which case
+// none of the constructor fences guarding it are needed.
+//
+// LSE already removes the fences of the singletons it processes, but it only does so for
+// allocations with removable field accesses. This covers the remaining allocations, e.g.
+// those only used as a lock, compared against, or passed to side-effect free invokes.
+static bool IsThreadLocalAllocation(HInstruction* allocation) {
+  bool is_singleton = false;
+  bool is_singleton_and_not_returned = false;
+  bool is_singleton_and_not_deopt_visible = false;
+  CalculateEscape(allocation,
+                  /* no_escape */ nullptr,
+                  &is_singleton,
+                  &is_singleton_and_not_returned,
+                  &is_singleton_and_not_deopt_visible);
+  // A deoptimization resumes in the interpreter, which can publish the object without
+  // executing the fences we removed.
+  if (!is_singleton_and_not_returned || !is_singleton_and_not_deopt_visible) {
+    return false;
+  }
+  // Escape analysis does not consider a thrown object as escaping, but its handler
+  // is free to publish it.
+  for (const HUseListNode<HInstruction*>& use : allocation->GetUses()) {
+    if (use.GetUser()->IsThrow()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Removes all the constructor fences guarding allocations that do not escape
+// the current thread. Fences guarding several targets only lose those inputs.
+static void RemoveThreadLocalConstructorFences(HGraph* graph, OptimizingCompilerStats* stats) {
+  // The debugger can read the locals and publish the object at any point.
+  if (graph->IsDebuggable()) {
+    return;
+  }
+
+  ScopedArenaAllocator allocator(graph->GetArenaStack());
+  ScopedArenaVector<HInstruction*> allocations(allocator.Adapter(kArenaAllocCFRE));
+  for (HBasicBlock* block : graph->GetReversePostOrder()) {
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      HInstruction* instruction = it.Current();
+      if ((instruction->IsNewInstance() || instruction->IsNewArray()) &&
+          IsThreadLocalAllocation(instruction)) {
+        allocations.push_back(instruction);
+      }
+    }
+  }
+
+  // Fences are removed only after the walk above, as removing them would
+  // invalidate the instruction iterators.
+  for (HInstruction* allocation : allocations) {
+    size_t removed = HConstructorFence::RemoveConstructorFences(allocation);
+    MaybeRecordStat(stats, MethodCompilationStat::kConstructorFenceRemovedCFRE, removed);
+  }
+}
+
 void ConstructorFenceRedundancyElimination::Run() {
+  RemoveThreadLocalConstructorFences(graph_, stats_);
+
   CFREVisitor cfre_visitor(graph_, stats_);
 
   // Arbitrarily visit in reverse-post order.
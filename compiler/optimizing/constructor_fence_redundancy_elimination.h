@@ -44,6 +44,10 @@ namespace art {
  * - If we see an interesting publish, merge all instructions in CFS into a single CF(CFTargets).
  * - Repeat until the block is fully visited.
  * - At the end of the block, merge all instructions in CFS into a single CF(CFTargets).
+ *
+ * Before merging, every allocation R that never escapes the current thread (as determined
+ * by escape analysis over the whole method) is removed from all the CF that guard it,
+ * including the fences of inlined constructors. A CF left without inputs is removed.
  */
 class ConstructorFenceRedundancyElimination : public HOptimization {
  public:
@@ -527,6 +527,11 @@ class HGraphVisualizerPrinter : public HGraphDelegateVisitor {
     StartAttributeStream("kind") << deoptimize->GetKind();
   }
 
+  void VisitSuspendCheck(HSuspendCheck* suspend_check) OVERRIDE {
+    StartAttributeStream("is_no_op") << std::boolalpha
+        << suspend_check->IsNoOp() << std::noboolalpha;
+  }
+
   void VisitVecOperation(HVecOperation* vec_operation) OVERRIDE {
     StartAttributeStream("packed_type") << vec_operation->GetPackedType();
   }
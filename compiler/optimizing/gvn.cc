@@ -21,6 +21,7 @@
 #include "base/scoped_arena_allocator.h"
 #include "base/scoped_arena_containers.h"
 #include "base/utils.h"
+#include "load_store_analysis.h"
 #include "side_effects_analysis.h"
 
 namespace art {
@@ -133,6 +134,14 @@ class ValueSet : public ArenaObject<kArenaAllocGvn> {
     });
   }
 
+  // Removes all impure instructions in the set for which `cond` returns true.
+  template<typename Functor>
+  void KillWhich(Functor cond) {
+    DeleteAllImpureWhich([cond](Node* node) {
+      return cond(node->GetInstruction());
+    });
+  }
+
   void Clear() {
     num_entries_ = 0;
     for (size_t i = 0; i < num_buckets_; ++i) {
@@ -348,7 +357,9 @@ class GlobalValueNumberer : public ValueObject {
         side_effects_(side_effects),
         sets_(graph->GetBlocks().size(), nullptr, allocator_.Adapter(kArenaAllocGvn)),
         visited_blocks_(
-            &allocator_, graph->GetBlocks().size(), /* expandable */ false, kArenaAllocGvn) {
+            &allocator_, graph->GetBlocks().size(), /* expandable */ false, kArenaAllocGvn),
+        lsa_(graph),
+        heap_locations_(allocator_.Adapter(kArenaAllocGvn)) {
     visited_blocks_.ClearAllBits();
   }
 
@@ -359,6 +370,30 @@ class GlobalValueNumberer : public ValueObject {
   // successor blocks.
   void VisitBasicBlock(HBasicBlock* block);
 
+  // Runs the load/store analysis and records the heap location accessed by
+  // each field and array access, so that stores only kill the loads they may alias.
+  void CollectHeapLocations();
+
+  // Returns the heap location accessed by `instruction`, or kHeapLocationNotFound
+  // if it is not a field or array access or no aliasing information is available.
+  size_t GetHeapLocation(HInstruction* instruction) const {
+    return instruction->GetId() < static_cast<int>(heap_locations_.size())
+        ? heap_locations_[instruction->GetId()]
+        : HeapLocationCollector::kHeapLocationNotFound;
+  }
+
+  bool MayAlias(size_t location1, size_t location2) const {
+    return location1 == location2 ||
+           lsa_.GetHeapLocationCollector().MayAlias(location1, location2);
+  }
+
+  // Removes from `set` the values which may be changed by `instruction`.
+  void KillEffectsOf(ValueSet* set, HInstruction* instruction);
+
+  // Removes from `set` the values which may be changed by an iteration of
+  // the loop headed by `block`.
+  void KillLoopEffects(ValueSet* set, HBasicBlock* block);
+
   HGraph* graph_;
   ScopedArenaAllocator allocator_;
   const SideEffectsAnalysis& side_effects_;
@@ -394,11 +429,19 @@ class GlobalValueNumberer : public ValueObject {
   // visited/unvisited Boolean.
   ArenaBitVector visited_blocks_;
 
+  // Aliasing information between the heap locations of the graph.
+  LoadStoreAnalysis lsa_;
+
+  // Heap location accessed by each instruction, indexed by instruction id.
+  // Empty if the load/store analysis bailed out.
+  ScopedArenaVector<size_t> heap_locations_;
+
   DISALLOW_COPY_AND_ASSIGN(GlobalValueNumberer);
 };
 
 void GlobalValueNumberer::Run() {
   DCHECK(side_effects_.HasRun());
+  CollectHeapLocations();
   sets_[graph_->GetEntryBlock()->GetBlockId()] = new (&allocator_) ValueSet(&allocator_);
 
   // Use the reverse post order to ensure the non back-edge predecessors of a block are
@@ -408,6 +451,92 @@ void GlobalValueNumberer::Run() {
   }
 }
 
+void GlobalValueNumberer::CollectHeapLocations() {
+  lsa_.Run();
+  const HeapLocationCollector& collector = lsa_.GetHeapLocationCollector();
+  if (collector.GetNumberOfHeapLocations() == 0) {
+    // No stores, or the analysis bailed out. Fall back to side effects only.
+    return;
+  }
+  // The locations are computed before any instruction is replaced, as
+  // replacing the index of an array access would hide its location.
+  heap_locations_.resize(graph_->GetCurrentInstructionId(),
+                         HeapLocationCollector::kHeapLocationNotFound);
+  for (HBasicBlock* block : graph_->GetReversePostOrder()) {
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      HInstruction* instruction = it.Current();
+      heap_locations_[instruction->GetId()] = collector.GetHeapLocationIndexOf(instruction);
+    }
+  }
+}
+
+void GlobalValueNumberer::KillEffectsOf(ValueSet* set, HInstruction* instruction) {
+  SideEffects effects = instruction->GetSideEffects();
+  size_t store_location = effects.DoesAnyWrite()
+      ? GetHeapLocation(instruction)
+      : HeapLocationCollector::kHeapLocationNotFound;
+  if (store_location == HeapLocationCollector::kHeapLocationNotFound) {
+    set->Kill(effects);
+    return;
+  }
+  // A store with a known location only kills the loads it may alias, plus
+  // whatever depends on its other side effects (for example, triggering GC).
+  SideEffects other_effects = effects.Exclusion(SideEffects::AllWrites());
+  set->KillWhich([&](HInstruction* value) {
+    SideEffects value_effects = value->GetSideEffects();
+    if (!value_effects.MayDependOn(effects)) {
+      return false;
+    }
+    size_t load_location = GetHeapLocation(value);
+    return load_location == HeapLocationCollector::kHeapLocationNotFound ||
+           value_effects.MayDependOn(other_effects) ||
+           MayAlias(load_location, store_location);
+  });
+}
+
+void GlobalValueNumberer::KillLoopEffects(ValueSet* set, HBasicBlock* block) {
+  SideEffects loop_effects = side_effects_.GetLoopEffects(block);
+  if (heap_locations_.empty() || !loop_effects.DoesAnyWrite()) {
+    set->Kill(loop_effects);
+    return;
+  }
+  // Split the effects of the loop into the stores to known heap locations
+  // and everything else.
+  ScopedArenaVector<size_t> stores(allocator_.Adapter(kArenaAllocGvn));
+  SideEffects other_effects = SideEffects::None();
+  for (HBlocksInLoopIterator it(*block->GetLoopInformation()); !it.Done(); it.Advance()) {
+    for (HInstructionIterator inst_it(it.Current()->GetInstructions());
+         !inst_it.Done();
+         inst_it.Advance()) {
+      HInstruction* instruction = inst_it.Current();
+      SideEffects effects = instruction->GetSideEffects();
+      size_t location = effects.DoesAnyWrite()
+          ? GetHeapLocation(instruction)
+          : HeapLocationCollector::kHeapLocationNotFound;
+      if (location == HeapLocationCollector::kHeapLocationNotFound) {
+        other_effects = other_effects.Union(effects);
+      } else {
+        stores.push_back(location);
+        other_effects = other_effects.Union(effects.Exclusion(SideEffects::AllWrites()));
+      }
+    }
+  }
+  set->KillWhich([&](HInstruction* value) {
+    SideEffects value_effects = value->GetSideEffects();
+    if (!value_effects.MayDependOn(loop_effects)) {
+      return false;
+    }
+    size_t load_location = GetHeapLocation(value);
+    if (load_location == HeapLocationCollector::kHeapLocationNotFound ||
+        value_effects.MayDependOn(other_effects)) {
+      return true;
+    }
+    return std::any_of(stores.begin(), stores.end(), [&](size_t store_location) {
+      return MayAlias(load_location, store_location);
+    });
+  });
+}
+
 void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
   ValueSet* set = nullptr;
 
@@ -457,7 +586,7 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
         } else {
           DCHECK(!block->GetLoopInformation()->IsIrreducible());
           DCHECK_EQ(block->GetDominator(), block->GetLoopInformation()->GetPreHeader());
-          set->Kill(side_effects_.GetLoopEffects(block));
+          KillLoopEffects(set, block);
         }
       } else if (predecessors.size() > 1) {
         for (HBasicBlock* predecessor : predecessors) {
@@ -493,11 +622,11 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
         current->ReplaceWith(existing);
         current->GetBlock()->RemoveInstruction(current);
       } else {
-        set->Kill(current->GetSideEffects());
+        KillEffectsOf(set, current);
         set->Add(current);
       }
     } else {
-      set->Kill(current->GetSideEffects());
+      KillEffectsOf(set, current);
     }
     current = next;
   }
@@ -15,6 +15,9 @@
  */
 
 #include "induction_var_analysis.h"
+
+#include <algorithm>
+
 #include "induction_var_range.h"
 
 namespace art {
@@ -25,9 +28,7 @@ namespace art {
  * a chain of dependences (mutual independent items may occur in arbitrary order). For proper
  * classification, the lexicographically first loop-phi is rotated to the front.
  */
-static void RotateEntryPhiFirst(HLoopInformation* loop,
-                                ArenaVector<HInstruction*>* scc,
-                                ArenaVector<HInstruction*>* new_scc) {
+static void RotateEntryPhiFirst(HLoopInformation* loop, ArenaVector<HInstruction*>* scc) {
   // Find very first loop-phi.
   const HInstructionList& phis = loop->GetHeader()->GetPhis();
   HInstruction* phi = nullptr;
@@ -41,15 +42,10 @@ static void RotateEntryPhiFirst(HLoopInformation* loop,
     }
   }
 
-  // If found, bring that loop-phi to front.
+  // If found, bring that loop-phi to front. Rotate in place rather than through a
+  // temporary vector, which would stay on the graph's arena for the whole compilation.
   if (phi != nullptr) {
-    new_scc->clear();
-    for (size_t i = 0; i < size; i++) {
-      new_scc->push_back((*scc)[phi_pos]);
-      if (++phi_pos >= size) phi_pos = 0;
-    }
-    DCHECK_EQ(size, new_scc->size());
-    scc->swap(*new_scc);
+    std::rotate(scc->begin(), scc->begin() + phi_pos, scc->end());
   }
 }
 
@@ -395,9 +391,7 @@ void HInductionVarAnalysis::ClassifyNonTrivial(HLoopInformation* loop) {
 
   // Rotate proper loop-phi to front.
   if (size > 1) {
-    ArenaVector<HInstruction*> other(
-        graph_->GetAllocator()->Adapter(kArenaAllocInductionVarAnalysis));
-    RotateEntryPhiFirst(loop, &scc_, &other);
+    RotateEntryPhiFirst(loop, &scc_);
   }
 
   // Analyze from loop-phi onwards.
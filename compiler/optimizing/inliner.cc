@@ -18,6 +18,7 @@
 
 #include "art_method-inl.h"
 #include "base/enums.h"
+#include "base/stl_util.h"
 #include "builder.h"
 #include "class_linker.h"
 #include "constant_folding.h"
@@ -39,6 +40,7 @@
 #include "optimizing_compiler.h"
 #include "reference_type_propagation.h"
 #include "register_allocator_linear_scan.h"
+#include "runtime_callbacks.h"
 #include "scoped_thread_state_change-inl.h"
 #include "sharpening.h"
 #include "ssa_builder.h"
@@ -66,6 +68,10 @@ static constexpr size_t kMaximumNumberOfRecursiveCalls = 4;
 // Controls the use of inline caches in AOT mode.
 static constexpr bool kUseAOTInlineCaches = true;
 
+// A receiver of a megamorphic call is worth inlining if it was seen for at least one in
+// this many calls.
+static constexpr size_t kMegamorphicDominantReceiverRatio = 4;
+
 // We check for line numbers to make sure the DepthString implementation
 // aligns the output nicely.
 #define LOG_INTERNAL(msg) \
@@ -371,6 +377,10 @@ ArtMethod* HInliner::TryCHADevirtualization(ArtMethod* resolved_method) {
     // We do not support HDeoptimize in OSR methods.
     return nullptr;
   }
+  if (outermost_graph_->IsSpeculationDisabled(DeoptimizationKind::kCHA)) {
+    // The CHA guards of previous compilations kept deoptimizing.
+    return nullptr;
+  }
   PointerSize pointer_size = caller_compilation_unit_.GetClassLinker()->GetImagePointerSize();
   ArtMethod* single_impl = resolved_method->GetSingleImplementation(pointer_size);
   if (single_impl == nullptr) {
@@ -560,7 +570,12 @@ bool HInliner::UseOnlyPolymorphicInliningWithNoDeopt() {
   //
   // For OSR:
   //     We may come from the interpreter and it may have seen different receiver types.
-  return Runtime::Current()->IsAotCompiler() || outermost_graph_->IsCompilingOsr();
+  //
+  // For JIT code that kept deoptimizing on inline cache type guards:
+  //     The receiver types seen so far do not predict the future ones.
+  return Runtime::Current()->IsAotCompiler() ||
+      outermost_graph_->IsCompilingOsr() ||
+      outermost_graph_->IsSpeculationDisabled(DeoptimizationKind::kJitInlineCache);
 }
 bool HInliner::TryInlineFromInlineCache(const DexFile& caller_dex_file,
                                         HInvoke* invoke_instruction,
@@ -572,9 +587,12 @@ bool HInliner::TryInlineFromInlineCache(const DexFile& caller_dex_file,
 
   StackHandleScope<1> hs(Thread::Current());
   Handle<mirror::ObjectArray<mirror::Class>> inline_cache;
+  // Receiver frequencies, only known under JIT.
+  uint16_t counts[InlineCache::kIndividualCacheSize] = {};
+  uint16_t megamorphic_count = 0u;
   InlineCacheType inline_cache_type = Runtime::Current()->IsAotCompiler()
       ? GetInlineCacheAOT(caller_dex_file, invoke_instruction, &hs, &inline_cache)
-      : GetInlineCacheJIT(invoke_instruction, &hs, &inline_cache);
+      : GetInlineCacheJIT(invoke_instruction, &hs, &inline_cache, counts, &megamorphic_count);
 
   switch (inline_cache_type) {
     case kInlineCacheNoData: {
@@ -608,6 +626,11 @@ bool HInliner::TryInlineFromInlineCache(const DexFile& caller_dex_file,
     }
 
     case kInlineCacheMegamorphic: {
+      if (TryInlineMegamorphicCall(
+              invoke_instruction, resolved_method, inline_cache, counts, megamorphic_count)) {
+        MaybeRecordStat(stats_, MethodCompilationStat::kMegamorphicCall);
+        return true;
+      }
       LOG_FAIL_NO_STAT()
           << "Interface or virtual call to "
           << caller_dex_file.PrettyMethod(invoke_instruction->GetDexMethodIndex())
@@ -630,7 +653,9 @@ bool HInliner::TryInlineFromInlineCache(const DexFile& caller_dex_file,
 HInliner::InlineCacheType HInliner::GetInlineCacheJIT(
     HInvoke* invoke_instruction,
     StackHandleScope<1>* hs,
-    /*out*/Handle<mirror::ObjectArray<mirror::Class>>* inline_cache)
+    /*out*/Handle<mirror::ObjectArray<mirror::Class>>* inline_cache,
+    /*out*/uint16_t* counts,
+    /*out*/uint16_t* megamorphic_count)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   DCHECK(Runtime::Current()->UseJitCompilation());
 
@@ -651,7 +676,20 @@ HInliner::InlineCacheType HInliner::GetInlineCacheJIT(
   } else {
     Runtime::Current()->GetJit()->GetCodeCache()->CopyInlineCacheInto(
         *profiling_info->GetInlineCache(invoke_instruction->GetDexPc()),
-        *inline_cache);
+        *inline_cache,
+        counts,
+        megamorphic_count);
+    // Sort the receivers by decreasing frequency, so that the most frequent type guards come
+    // first. Insertion sort, the cache is tiny.
+    mirror::ObjectArray<mirror::Class>* classes = inline_cache->Get();
+    for (size_t i = 1; i < InlineCache::kIndividualCacheSize && classes->Get(i) != nullptr; ++i) {
+      for (size_t j = i; j > 0 && counts[j - 1] < counts[j]; --j) {
+        std::swap(counts[j - 1], counts[j]);
+        ObjPtr<mirror::Class> tmp = classes->Get(j - 1);
+        classes->Set(j - 1, classes->Get(j));
+        classes->Set(j, tmp);
+      }
+    }
     return GetInlineCacheType(*inline_cache);
   }
 }
@@ -869,6 +907,52 @@ bool HInliner::TryInlineMonomorphicCall(HInvoke* invoke_instruction,
   return true;
 }
 
+HInvokeStaticOrDirect* HInliner::BuildCHADirectCall(HInvoke* invoke_instruction,
+                                                   ArtMethod* method) {
+  DCHECK(invoke_instruction->IsInvokeVirtual() || invoke_instruction->IsInvokeInterface());
+  if (method->IsDefault() && !method->IsCopied()) {
+    // Keep the call dispatched through the receiver's class rather than calling
+    // an original default method, which is not in any vtable, directly.
+    return nullptr;
+  }
+  if (method->IsNative() || graph_->IsDebuggable()) {
+    return nullptr;
+  }
+  // CHA devirtualization is JIT only, so the target can always be embedded.
+  DCHECK(Runtime::Current()->UseJitCompilation());
+  HInvokeStaticOrDirect::DispatchInfo dispatch_info = {
+      HInvokeStaticOrDirect::MethodLoadKind::kDirectAddress,
+      HInvokeStaticOrDirect::CodePtrLocation::kCallArtMethod,
+      reinterpret_cast<uintptr_t>(method)
+  };
+  HInvokeStaticOrDirect* direct_call = new (graph_->GetAllocator()) HInvokeStaticOrDirect(
+      graph_->GetAllocator(),
+      invoke_instruction->GetNumberOfArguments(),
+      invoke_instruction->GetType(),
+      invoke_instruction->GetDexPc(),
+      invoke_instruction->GetDexMethodIndex(),
+      method,
+      dispatch_info,
+      kDirect,
+      MethodReference(method->GetDexFile(), method->GetDexMethodIndex()),
+      HInvokeStaticOrDirect::ClinitCheckRequirement::kNone);
+  HInvokeStaticOrDirect::DispatchInfo supported_dispatch_info =
+      codegen_->GetSupportedInvokeStaticOrDirectDispatch(dispatch_info, direct_call);
+  if (supported_dispatch_info.method_load_kind != dispatch_info.method_load_kind ||
+      supported_dispatch_info.code_ptr_location != dispatch_info.code_ptr_location) {
+    return nullptr;
+  }
+  HInputsRef inputs = invoke_instruction->GetInputs();
+  for (size_t index = 0; index != inputs.size(); ++index) {
+    direct_call->SetArgumentAt(index, inputs[index]);
+  }
+  direct_call->CopyEnvironmentFrom(invoke_instruction->GetEnvironment());
+  if (invoke_instruction->GetType() == DataType::Type::kReference) {
+    direct_call->SetReferenceTypeInfo(invoke_instruction->GetReferenceTypeInfo());
+  }
+  return direct_call;
+}
+
 void HInliner::AddCHAGuard(HInstruction* invoke_instruction,
                            uint32_t dex_pc,
                            HInstruction* cursor,
@@ -978,6 +1062,68 @@ bool HInliner::TryInlinePolymorphicCall(HInvoke* invoke_instruction,
     return true;
   }
 
+  if (!TryInlinePolymorphicTargets(invoke_instruction,
+                                   resolved_method,
+                                   classes,
+                                   /* allow_deoptimization */ true)) {
+    return false;
+  }
+
+  MaybeRecordStat(stats_, MethodCompilationStat::kInlinedPolymorphicCall);
+  return true;
+}
+
+bool HInliner::TryInlineMegamorphicCall(HInvoke* invoke_instruction,
+                                        ArtMethod* resolved_method,
+                                        Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                        const uint16_t* counts,
+                                        uint16_t megamorphic_count) {
+  DCHECK(invoke_instruction->IsInvokeVirtual() || invoke_instruction->IsInvokeInterface())
+      << invoke_instruction->DebugName();
+  if (classes.Get() == nullptr) {
+    return false;
+  }
+
+  size_t total_count = megamorphic_count;
+  for (size_t i = 0; i < InlineCache::kIndividualCacheSize; ++i) {
+    total_count += counts[i];
+  }
+  if (total_count == 0u) {
+    // No frequencies, e.g. the inline cache comes from an AOT profile.
+    return false;
+  }
+
+  // The classes are sorted by decreasing frequency. Keep the dominant ones only.
+  size_t number_of_dominant_receivers = 0;
+  while (number_of_dominant_receivers < InlineCache::kIndividualCacheSize &&
+         classes->Get(number_of_dominant_receivers) != nullptr &&
+         counts[number_of_dominant_receivers] * kMegamorphicDominantReceiverRatio >=
+             total_count) {
+    ++number_of_dominant_receivers;
+  }
+  if (number_of_dominant_receivers == 0u) {
+    return false;
+  }
+  for (size_t i = number_of_dominant_receivers; i < InlineCache::kIndividualCacheSize; ++i) {
+    classes->Set(i, nullptr);
+  }
+
+  // Other receivers are expected, never deoptimize.
+  if (!TryInlinePolymorphicTargets(invoke_instruction,
+                                   resolved_method,
+                                   classes,
+                                   /* allow_deoptimization */ false)) {
+    return false;
+  }
+
+  MaybeRecordStat(stats_, MethodCompilationStat::kInlinedMegamorphicCall);
+  return true;
+}
+
+bool HInliner::TryInlinePolymorphicTargets(HInvoke* invoke_instruction,
+                                           ArtMethod* resolved_method,
+                                           Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                           bool allow_deoptimization) {
   ClassLinker* class_linker = caller_compilation_unit_.GetClassLinker();
   PointerSize pointer_size = class_linker->GetImagePointerSize();
 
@@ -1021,7 +1167,8 @@ bool HInliner::TryInlinePolymorphicCall(HInvoke* invoke_instruction,
 
       // If we have inlined all targets before, and this receiver is the last seen,
       // we deoptimize instead of keeping the original invoke instruction.
-      bool deoptimize = !UseOnlyPolymorphicInliningWithNoDeopt() &&
+      bool deoptimize = allow_deoptimization &&
+          !UseOnlyPolymorphicInliningWithNoDeopt() &&
           all_targets_inlined &&
           (i != InlineCache::kIndividualCacheSize - 1) &&
           (classes->Get(i + 1) == nullptr);
@@ -1055,8 +1202,6 @@ bool HInliner::TryInlinePolymorphicCall(HInvoke* invoke_instruction,
     return false;
   }
 
-  MaybeRecordStat(stats_, MethodCompilationStat::kInlinedPolymorphicCall);
-
   // Run type propagation to get the guards typed.
   ReferenceTypePropagation rtp_fixup(graph_,
                                      outer_compilation_unit_.GetClassLoader(),
@@ -1234,7 +1379,8 @@ bool HInliner::TryInlinePolymorphicCallToSameTarget(
   bb_cursor->InsertInstructionAfter(class_table_get, receiver_class);
   bb_cursor->InsertInstructionAfter(compare, class_table_get);
 
-  if (outermost_graph_->IsCompilingOsr()) {
+  if (outermost_graph_->IsCompilingOsr() ||
+      outermost_graph_->IsSpeculationDisabled(DeoptimizationKind::kJitSameTarget)) {
     CreateDiamondPatternForPolymorphicInline(compare, return_replacement, invoke_instruction);
   } else {
     HDeoptimize* deoptimize = new (graph_->GetAllocator()) HDeoptimize(
@@ -1315,7 +1461,18 @@ bool HInliner::TryInlineAndReplace(HInvoke* invoke_instruction,
       // invoke_instruction is intrinsified and stays.
     }
   } else if (!TryBuildAndInline(invoke_instruction, method, receiver_type, &return_replacement)) {
-    if (invoke_instruction->IsInvokeInterface()) {
+    HInvokeStaticOrDirect* direct_call = cha_devirtualize
+        ? BuildCHADirectCall(invoke_instruction, method)
+        : nullptr;
+    if (direct_call != nullptr) {
+      // The CHA guard added below protects the direct call, like it would
+      // protect the inlined body.
+      invoke_instruction->GetBlock()->InsertInstructionBefore(direct_call, invoke_instruction);
+      return_replacement = direct_call;
+      // invoke_instruction is replaced with direct_call.
+      should_remove_invoke_instruction = true;
+      MaybeRecordStat(stats_, MethodCompilationStat::kCHADirectCall);
+    } else if (invoke_instruction->IsInvokeInterface()) {
       DCHECK(!method->IsProxyMethod());
       // Turn an invoke-interface into an invoke-virtual. An invoke-virtual is always
       // better than an invoke-interface because:
@@ -1414,6 +1571,13 @@ bool HInliner::TryBuildAndInline(HInvoke* invoke_instruction,
     return false;
   }
 
+  if (!Runtime::Current()->GetRuntimeCallbacks()->IsMethodSafeToJit(method)) {
+    // The method has breakpoints, see openjdkjvmti::DeoptManager.
+    LOG_FAIL_NO_STAT()
+        << "Method " << method->PrettyMethod() << " is not inlined because it is being debugged";
+    return false;
+  }
+
   if (CountRecursiveCallsOf(method) > kMaximumNumberOfRecursiveCalls) {
     LOG_FAIL(stats_, MethodCompilationStat::kNotInlinedRecursiveBudget)
         << "Method "
@@ -1430,6 +1594,7 @@ bool HInliner::TryBuildAndInline(HInvoke* invoke_instruction,
       LOG_SUCCESS() << "Successfully replaced pattern of invoke "
                     << method->PrettyMethod();
       MaybeRecordStat(stats_, MethodCompilationStat::kReplacedInvokeWithSimplePattern);
+      outermost_graph_->AddInlinedMethod(method);
       return true;
     }
     LOG_FAIL(stats_, MethodCompilationStat::kNotInlinedWont)
@@ -1499,6 +1664,7 @@ bool HInliner::TryBuildAndInline(HInvoke* invoke_instruction,
 
   LOG_SUCCESS() << method->PrettyMethod();
   MaybeRecordStat(stats_, MethodCompilationStat::kInlinedInvoke);
+  outermost_graph_->AddInlinedMethod(method);
   return true;
 }
 
@@ -1755,8 +1921,11 @@ bool HInliner::TryBuildAndInlineHelper(HInvoke* invoke_instruction,
       invoke_type,
       graph_->IsDebuggable(),
       /* osr */ false,
+      /* baseline */ false,
       caller_instruction_counter);
   callee_graph->SetArtMethod(resolved_method);
+  // The inlined code deoptimizes the outermost method, whose speculations are the ones to avoid.
+  callee_graph->SetDisabledSpeculations(outermost_graph_->GetDisabledSpeculations());
 
   // When they are needed, allocate `inline_stats_` on the Arena instead
   // of on the stack, as Clang might produce a stack frame too large
@@ -1886,6 +2055,22 @@ bool HInliner::TryBuildAndInlineHelper(HInvoke* invoke_instruction,
     return false;
   }
 
+  // In AOT, a method inlined from another dex file is found at runtime by
+  // resolving the call site in the caller's dex cache (see `GetInlinedMethodIndex`
+  // in code_generator.cc), so the call site must resolve to the inlined method.
+  const DexFile& caller_dex_file = *caller_compilation_unit_.GetDexFile();
+  bool is_aot_cross_dex_file = Runtime::Current()->IsAotCompiler() &&
+      !IsSameDexFile(caller_dex_file, callee_dex_file);
+  bool can_encode_in_stack_maps =
+      CanEncodeInlinedMethodInStackMap(caller_dex_file, resolved_method, compiler_driver_) &&
+      (!is_aot_cross_dex_file ||
+       (invoke_instruction->GetResolvedMethod() == resolved_method &&
+        invoke_instruction->GetInvokeType() != kSuper));
+  // Methods from the boot image cannot use .bss entries or other linker patches
+  // of the oat file being compiled, which only cover its own dex files.
+  bool is_boot_image_callee = is_aot_cross_dex_file &&
+      !ContainsElement(compiler_driver_->GetDexFilesForOatFile(), &callee_dex_file);
+
   size_t number_of_instructions = 0;
   // Skip the entry block, it does not contain instructions that prevent inlining.
   for (HBasicBlock* block : callee_graph->GetReversePostOrderSkipEntryBlock()) {
@@ -1929,9 +2114,7 @@ bool HInliner::TryBuildAndInlineHelper(HInvoke* invoke_instruction,
         return false;
       }
 
-      if (current->NeedsEnvironment() &&
-          !CanEncodeInlinedMethodInStackMap(*caller_compilation_unit_.GetDexFile(),
-                                            resolved_method)) {
+      if (current->NeedsEnvironment() && !can_encode_in_stack_maps) {
         LOG_FAIL(stats_, MethodCompilationStat::kNotInlinedStackMaps)
             << "Method " << callee_dex_file.PrettyMethod(method_index)
             << " could not be inlined because " << current->DebugName()
@@ -1940,6 +2123,16 @@ bool HInliner::TryBuildAndInlineHelper(HInvoke* invoke_instruction,
         return false;
       }
 
+      if (is_boot_image_callee && (current->IsLoadClass() ||
+                                   current->IsLoadString() ||
+                                   current->IsInvokeStaticOrDirect())) {
+        LOG_FAIL(stats_, MethodCompilationStat::kNotInlinedDexCache)
+            << "Method " << callee_dex_file.PrettyMethod(method_index)
+            << " could not be inlined because " << current->DebugName()
+            << " is in the boot image and needs a reference from the oat file";
+        return false;
+      }
+
       if (!same_dex_file && current->NeedsDexCacheOfDeclaringClass()) {
         LOG_FAIL(stats_, MethodCompilationStat::kNotInlinedDexCache)
             << "Method " << callee_dex_file.PrettyMethod(method_index)
@@ -131,11 +131,15 @@ class HInliner : public HOptimization {
 
   // Try getting the inline cache from JIT code cache.
   // Return true if the inline cache was successfully allocated and the
-  // invoke info was found in the profile info.
+  // invoke info was found in the profile info. The classes of the inline cache are
+  // sorted by decreasing frequency, `counts` receives how many times each was seen and
+  // `megamorphic_count` how many receivers did not fit in the cache.
   InlineCacheType GetInlineCacheJIT(
       HInvoke* invoke_instruction,
       StackHandleScope<1>* hs,
-      /*out*/Handle<mirror::ObjectArray<mirror::Class>>* inline_cache)
+      /*out*/Handle<mirror::ObjectArray<mirror::Class>>* inline_cache,
+      /*out*/uint16_t* counts,
+      /*out*/uint16_t* megamorphic_count)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Try getting the inline cache from AOT offline profile.
@@ -176,6 +180,25 @@ class HInliner : public HOptimization {
                                 Handle<mirror::ObjectArray<mirror::Class>> classes)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Try to inline the targets of the given receiver `classes`, each behind a type guard.
+  // If `allow_deoptimization` and all the targets got inlined, the last guard deoptimizes,
+  // otherwise the original invoke stays as the fallback. Returns whether a target got inlined.
+  bool TryInlinePolymorphicTargets(HInvoke* invoke_instruction,
+                                   ArtMethod* resolved_method,
+                                   Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                   bool allow_deoptimization)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Try to inline the dominant receivers of a megamorphic call, that is the ones seen for at
+  // least one in `kMegamorphicDominantReceiverRatio` calls. The other receivers go through
+  // the original virtual or interface call.
+  bool TryInlineMegamorphicCall(HInvoke* invoke_instruction,
+                                ArtMethod* resolved_method,
+                                Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                const uint16_t* counts,
+                                uint16_t megamorphic_count)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
   bool TryInlinePolymorphicCallToSameTarget(HInvoke* invoke_instruction,
                                             ArtMethod* resolved_method,
                                             Handle<mirror::ObjectArray<mirror::Class>> classes)
@@ -190,6 +213,12 @@ class HInliner : public HOptimization {
   ArtMethod* TryCHADevirtualization(ArtMethod* resolved_method)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Build a direct call to `method` replacing the virtual or interface call
+  // `invoke_instruction`, which CHA devirtualized but which could not be inlined.
+  // Returns null if `method` cannot be called directly.
+  HInvokeStaticOrDirect* BuildCHADirectCall(HInvoke* invoke_instruction, ArtMethod* method)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Add a CHA guard for a CHA-based devirtualized call. A CHA guard checks a
   // should_deoptimize flag and if it's true, does deoptimization.
   void AddCHAGuard(HInstruction* invoke_instruction,
@@ -20,6 +20,7 @@
 #include "base/arena_bit_vector.h"
 #include "base/bit_vector-inl.h"
 #include "block_builder.h"
+#include "cha.h"
 #include "class_linker.h"
 #include "data_type-inl.h"
 #include "dex/bytecode_utils.h"
@@ -1581,6 +1582,15 @@ void HInstructionBuilder::BuildStaticFieldAccess(const Instruction& instruction,
 
   DataType::Type field_type = GetFieldAccessType(*dex_file_, field_index);
 
+  if (!is_put) {
+    HConstant* value = TryFoldFinalStaticField(resolved_field, field_type, dex_pc);
+    if (value != nullptr) {
+      MaybeRecordStat(compilation_stats_, MethodCompilationStat::kFoldedFinalStaticField);
+      UpdateLocal(source_or_dest_reg, value);
+      return;
+    }
+  }
+
   Handle<mirror::Class> klass = handles_->NewHandle(resolved_field->GetDeclaringClass());
   HLoadClass* constant = BuildLoadClass(klass->GetDexTypeIndex(),
                                         klass->GetDexFile(),
@@ -1632,6 +1642,89 @@ void HInstructionBuilder::BuildStaticFieldAccess(const Instruction& instruction,
   }
 }
 
+// Returns whether a method of the declaring class of the static field `field`, other
+// than its class initializer, stores to it. The verifier accepts such stores to final
+// fields, and the JIT would not see them.
+static bool IsStoredOutsideClassInitializer(ArtField* field)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  ObjPtr<mirror::Class> klass = field->GetDeclaringClass();
+  const DexFile& dex_file = *klass->GetDexCache()->GetDexFile();
+  const DexFile::FieldId& field_id = dex_file.GetFieldId(field->GetDexFieldIndex());
+  PointerSize pointer_size = Runtime::Current()->GetClassLinker()->GetImagePointerSize();
+  for (ArtMethod& method : klass->GetDeclaredMethods(pointer_size)) {
+    if (method.IsClassInitializer() || method.IsNative() || method.IsAbstract()) {
+      continue;
+    }
+    for (const DexInstructionPcPair& pair : method.DexInstructions()) {
+      if (pair->Opcode() < Instruction::SPUT || pair->Opcode() > Instruction::SPUT_SHORT) {
+        continue;
+      }
+      // Compare the name and type only, as the field may be referenced through a subclass.
+      const DexFile::FieldId& stored_id = dex_file.GetFieldId(pair->VRegB_21c());
+      if (stored_id.name_idx_ == field_id.name_idx_ && stored_id.type_idx_ == field_id.type_idx_) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+HConstant* HInstructionBuilder::TryFoldFinalStaticField(ArtField* field,
+                                                        DataType::Type field_type,
+                                                        uint32_t dex_pc) {
+  // Only the JIT knows which classes are initialized when the code runs. Debuggers
+  // may change the value of any field.
+  if (!Runtime::Current()->UseJitCompilation() || graph_->IsDebuggable()) {
+    return nullptr;
+  }
+  // Arrays and other objects referenced by final fields are mutable, so only primitive
+  // values are folded.
+  if (!field->IsFinal() || field->IsVolatile() || field_type == DataType::Type::kReference) {
+    return nullptr;
+  }
+  ObjPtr<mirror::Class> klass = field->GetDeclaringClass();
+  if (!klass->IsInitialized() ||
+      Runtime::Current()->GetClassLinker()->GetClassHierarchyAnalysis()->IsFinalFieldModified(
+          field) ||
+      IsStoredOutsideClassInitializer(field)) {
+    return nullptr;
+  }
+
+  HConstant* value = nullptr;
+  switch (field_type) {
+    case DataType::Type::kBool:
+      value = graph_->GetIntConstant(field->GetBoolean(klass), dex_pc);
+      break;
+    case DataType::Type::kInt8:
+      value = graph_->GetIntConstant(field->GetByte(klass), dex_pc);
+      break;
+    case DataType::Type::kUint16:
+      value = graph_->GetIntConstant(field->GetChar(klass), dex_pc);
+      break;
+    case DataType::Type::kInt16:
+      value = graph_->GetIntConstant(field->GetShort(klass), dex_pc);
+      break;
+    case DataType::Type::kInt32:
+      value = graph_->GetIntConstant(field->GetInt(klass), dex_pc);
+      break;
+    case DataType::Type::kInt64:
+      value = graph_->GetLongConstant(field->GetLong(klass), dex_pc);
+      break;
+    case DataType::Type::kFloat32:
+      value = graph_->GetFloatConstant(field->GetFloat(klass), dex_pc);
+      break;
+    case DataType::Type::kFloat64:
+      value = graph_->GetDoubleConstant(field->GetDouble(klass), dex_pc);
+      break;
+    default:
+      LOG(FATAL) << "Unexpected field type " << field_type;
+      UNREACHABLE();
+  }
+  // The compiled code must be invalidated if the field is changed through JNI.
+  graph_->AddFinalFieldDependency(field);
+  return value;
+}
+
 void HInstructionBuilder::BuildCheckedDivRem(uint16_t out_vreg,
                                              uint16_t first_vreg,
                                              int64_t second_vreg_or_constant,
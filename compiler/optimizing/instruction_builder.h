@@ -156,6 +156,10 @@ class HInstructionBuilder : public ValueObject {
                                         DataType::Type field_type);
   // Builds a static field access node.
   void BuildStaticFieldAccess(const Instruction& instruction, uint32_t dex_pc, bool is_put);
+  // Returns the constant value of the static final field `field` if the JIT can fold
+  // reads of it, null otherwise.
+  HConstant* TryFoldFinalStaticField(ArtField* field, DataType::Type field_type, uint32_t dex_pc)
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
   void BuildArrayAccess(const Instruction& instruction,
                         uint32_t dex_pc,
@@ -16,6 +16,7 @@
 
 #include "instruction_simplifier.h"
 
+#include "art_field-inl.h"
 #include "art_method-inl.h"
 #include "class_linker-inl.h"
 #include "data_type-inl.h"
@@ -71,6 +72,7 @@ class InstructionSimplifierVisitor : public HGraphDelegateVisitor {
   void VisitEqual(HEqual* equal) OVERRIDE;
   void VisitNotEqual(HNotEqual* equal) OVERRIDE;
   void VisitBooleanNot(HBooleanNot* bool_not) OVERRIDE;
+  void VisitInstanceFieldGet(HInstanceFieldGet* instruction) OVERRIDE;
   void VisitInstanceFieldSet(HInstanceFieldSet* equal) OVERRIDE;
   void VisitStaticFieldSet(HStaticFieldSet* equal) OVERRIDE;
   void VisitArraySet(HArraySet* equal) OVERRIDE;
@@ -695,6 +697,34 @@ void InstructionSimplifierVisitor::VisitInstanceOf(HInstanceOf* instruction) {
   }
 }
 
+// Returns whether `instruction` reads the `value` field of a java.lang.Integer.
+static bool IsIntegerValueFieldGet(HInstanceFieldGet* instruction) {
+  ArtField* field = instruction->GetFieldInfo().GetField();
+  if (field == nullptr || instruction->GetFieldType() != DataType::Type::kInt32) {
+    return false;
+  }
+  ScopedObjectAccess soa(Thread::Current());
+  return field->GetDeclaringClass()->DescriptorEquals("Ljava/lang/Integer;") &&
+      strcmp(field->GetName(), "value") == 0;
+}
+
+void InstructionSimplifierVisitor::VisitInstanceFieldGet(HInstanceFieldGet* instruction) {
+  // Replace Integer.valueOf(x).value, usually an inlined intValue(), with x. The field is final,
+  // so the box always holds the int it was created with. This leaves the box without uses if
+  // it does not escape, and dead code elimination then removes the allocation.
+  HInstruction* object = instruction->InputAt(0);
+  if (object->IsNullCheck()) {
+    object = object->InputAt(0);
+  }
+  if (object->IsInvokeStaticOrDirect() &&
+      object->AsInvoke()->GetIntrinsic() == Intrinsics::kIntegerValueOf &&
+      IsIntegerValueFieldGet(instruction)) {
+    instruction->ReplaceWith(object->InputAt(0));
+    instruction->GetBlock()->RemoveInstruction(instruction);
+    RecordSimplification();
+  }
+}
+
 void InstructionSimplifierVisitor::VisitInstanceFieldSet(HInstanceFieldSet* instruction) {
   if ((instruction->GetValue()->GetType() == DataType::Type::kReference)
       && CanEnsureNotNullAt(instruction->GetValue(), instruction)) {
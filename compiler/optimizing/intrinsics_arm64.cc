@@ -1286,6 +1286,82 @@ void IntrinsicCodeGeneratorARM64::VisitUnsafeCASObject(HInvoke* invoke) {
   GenCas(invoke, DataType::Type::kReference, codegen_);
 }
 
+static void CreateIntIntIntIntToInt(ArenaAllocator* allocator, HInvoke* invoke, bool is_add) {
+  LocationSummary* locations =
+      new (allocator) LocationSummary(invoke, LocationSummary::kNoCall, kIntrinsified);
+  locations->SetInAt(0, Location::NoLocation());        // Unused receiver.
+  locations->SetInAt(1, Location::RequiresRegister());
+  locations->SetInAt(2, Location::RequiresRegister());
+  locations->SetInAt(3, Location::RequiresRegister());
+  // The output receives the old value before the exclusive store, which may fail and
+  // require another iteration with the inputs intact.
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+  if (is_add) {
+    // Temporary register for the new value.
+    locations->AddTemp(Location::RequiresRegister());
+  }
+}
+
+static void GenUnsafeGetAndUpdate(HInvoke* invoke,
+                                  DataType::Type type,
+                                  bool is_add,
+                                  CodeGeneratorARM64* codegen) {
+  MacroAssembler* masm = codegen->GetVIXLAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  Register out = RegisterFrom(locations->Out(), type);             // Old value.
+  Register base = WRegisterFrom(locations->InAt(1));               // Object pointer.
+  Register offset = XRegisterFrom(locations->InAt(2));             // Long offset.
+  Register arg = RegisterFrom(locations->InAt(3), type);           // Delta or new value.
+
+  UseScratchRegisterScope temps(masm);
+  Register tmp_ptr = temps.AcquireX();                             // Pointer to actual memory.
+  Register status = temps.AcquireW();                              // Exclusive store status.
+
+  __ Add(tmp_ptr, base.X(), Operand(offset));
+
+  // do {
+  //   out = [tmp_ptr];
+  // } while (failure([tmp_ptr] <- (is_add ? out + arg : arg)));
+  vixl::aarch64::Label loop_head;
+  __ Bind(&loop_head);
+  __ Ldaxr(out, MemOperand(tmp_ptr));
+  if (is_add) {
+    Register new_value = RegisterFrom(locations->GetTemp(0), type);
+    __ Add(new_value, out, arg);
+    __ Stlxr(status, new_value, MemOperand(tmp_ptr));
+  } else {
+    __ Stlxr(status, arg, MemOperand(tmp_ptr));
+  }
+  __ Cbnz(status, &loop_head);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitUnsafeGetAndAddInt(HInvoke* invoke) {
+  CreateIntIntIntIntToInt(allocator_, invoke, /* is_add */ true);
+}
+void IntrinsicLocationsBuilderARM64::VisitUnsafeGetAndAddLong(HInvoke* invoke) {
+  CreateIntIntIntIntToInt(allocator_, invoke, /* is_add */ true);
+}
+void IntrinsicLocationsBuilderARM64::VisitUnsafeGetAndSetInt(HInvoke* invoke) {
+  CreateIntIntIntIntToInt(allocator_, invoke, /* is_add */ false);
+}
+void IntrinsicLocationsBuilderARM64::VisitUnsafeGetAndSetLong(HInvoke* invoke) {
+  CreateIntIntIntIntToInt(allocator_, invoke, /* is_add */ false);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitUnsafeGetAndAddInt(HInvoke* invoke) {
+  GenUnsafeGetAndUpdate(invoke, DataType::Type::kInt32, /* is_add */ true, codegen_);
+}
+void IntrinsicCodeGeneratorARM64::VisitUnsafeGetAndAddLong(HInvoke* invoke) {
+  GenUnsafeGetAndUpdate(invoke, DataType::Type::kInt64, /* is_add */ true, codegen_);
+}
+void IntrinsicCodeGeneratorARM64::VisitUnsafeGetAndSetInt(HInvoke* invoke) {
+  GenUnsafeGetAndUpdate(invoke, DataType::Type::kInt32, /* is_add */ false, codegen_);
+}
+void IntrinsicCodeGeneratorARM64::VisitUnsafeGetAndSetLong(HInvoke* invoke) {
+  GenUnsafeGetAndUpdate(invoke, DataType::Type::kInt64, /* is_add */ false, codegen_);
+}
+
 void IntrinsicLocationsBuilderARM64::VisitStringCompareTo(HInvoke* invoke) {
   LocationSummary* locations =
       new (allocator_) LocationSummary(invoke,
@@ -2361,17 +2437,26 @@ void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
                               dst_curr_addr,
                               src_stop_addr);
 
-  // Iterate over the arrays and do a raw copy of the chars.
+  // Iterate over the arrays and do a raw copy of the chars, four at a time with 64-bit
+  // accesses while at least four are left, then one at a time. The arrays are different, so
+  // the regions cannot overlap.
   const int32_t char_size = DataType::Size(DataType::Type::kUint16);
   UseScratchRegisterScope temps(masm);
-  Register tmp = temps.AcquireW();
-  vixl::aarch64::Label loop, done;
+  Register tmp = temps.AcquireX();
+  vixl::aarch64::Label loop, remainder, done;
   __ Bind(&loop);
+  __ Sub(tmp, src_stop_addr, src_curr_addr);
+  __ Cmp(tmp, 4 * char_size);
+  __ B(&remainder, lt);
+  __ Ldr(tmp, MemOperand(src_curr_addr, 4 * char_size, PostIndex));
+  __ Str(tmp, MemOperand(dst_curr_addr, 4 * char_size, PostIndex));
+  __ B(&loop);
+  __ Bind(&remainder);
   __ Cmp(src_curr_addr, src_stop_addr);
   __ B(&done, eq);
-  __ Ldrh(tmp, MemOperand(src_curr_addr, char_size, PostIndex));
-  __ Strh(tmp, MemOperand(dst_curr_addr, char_size, PostIndex));
-  __ B(&loop);
+  __ Ldrh(tmp.W(), MemOperand(src_curr_addr, char_size, PostIndex));
+  __ Strh(tmp.W(), MemOperand(dst_curr_addr, char_size, PostIndex));
+  __ B(&remainder);
   __ Bind(&done);
 
   __ Bind(slow_path->GetExitLabel());
@@ -3045,6 +3130,193 @@ void IntrinsicCodeGeneratorARM64::VisitThreadInterrupted(HInvoke* invoke) {
   __ Bind(&done);
 }
 
+void IntrinsicLocationsBuilderARM64::VisitStringHashCode(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke, LocationSummary::kCallOnSlowPath, kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetOut(Location::RequiresRegister());
+}
+
+void IntrinsicCodeGeneratorARM64::VisitStringHashCode(HInvoke* invoke) {
+  MacroAssembler* masm = GetVIXLAssembler();
+  Register str = InputRegisterAt(invoke, 0);
+  Register out = OutputRegister(invoke);
+
+  // Note that the null check must have been done earlier.
+  DCHECK(!invoke->CanDoImplicitNullCheckOn(invoke->InputAt(0)));
+
+  // Return the cached hash code. If it is not computed yet, call String.hashCode().
+  SlowPathCodeARM64* slow_path = new (codegen_->GetScopedAllocator()) IntrinsicSlowPathARM64(invoke);
+  codegen_->AddSlowPath(slow_path);
+  __ Ldr(out, HeapOperand(str, mirror::String::HashCodeOffset().Int32Value()));
+  __ Cbz(out, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
+void IntrinsicLocationsBuilderARM64::VisitArraysEqualsByte(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke, LocationSummary::kNoCall, kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  // The remaining length, the two data pointers, and a register for the 16 byte loads.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  // The output is the fourth register for the 16 byte loads.
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitArraysEqualsByte(HInvoke* invoke) {
+  MacroAssembler* masm = GetVIXLAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  Register array1 = InputRegisterAt(invoke, 0);
+  Register array2 = InputRegisterAt(invoke, 1);
+  Register out = XRegisterFrom(locations->Out());
+  Register length = WRegisterFrom(locations->GetTemp(0));
+  Register ptr1 = XRegisterFrom(locations->GetTemp(1));
+  Register ptr2 = XRegisterFrom(locations->GetTemp(2));
+  Register temp = XRegisterFrom(locations->GetTemp(3));
+
+  UseScratchRegisterScope scratch_scope(masm);
+  Register temp1 = scratch_scope.AcquireX();
+  Register temp2 = scratch_scope.AcquireX();
+
+  vixl::aarch64::Label loop;
+  vixl::aarch64::Label tail;
+  vixl::aarch64::Label byte_loop;
+  vixl::aarch64::Label return_true;
+  vixl::aarch64::Label return_false;
+  vixl::aarch64::Label end;
+
+  const int32_t length_offset = mirror::Array::LengthOffset().Int32Value();
+  const int32_t data_offset = mirror::Array::DataOffset(sizeof(int8_t)).Int32Value();
+
+  // Same reference (including both null), return true.
+  __ Cmp(array1, array2);
+  __ B(&return_true, eq);
+  // Only one null, return false.
+  if (invoke->InputAt(0)->CanBeNull()) {
+    __ Cbz(array1, &return_false);
+  }
+  if (invoke->InputAt(1)->CanBeNull()) {
+    __ Cbz(array2, &return_false);
+  }
+
+  // Different lengths, return false.
+  __ Ldr(length, HeapOperand(array1, length_offset));
+  __ Ldr(temp1.W(), HeapOperand(array2, length_offset));
+  __ Cmp(length, temp1.W());
+  __ B(&return_false, ne);
+
+  __ Add(ptr1, array1.X(), data_offset);
+  __ Add(ptr2, array2.X(), data_offset);
+
+  // Compare 16 bytes at a time. The loads are not aligned, and we never read past
+  // the end of the data.
+  __ Subs(length, length, 16);
+  __ B(&tail, lt);
+  __ Bind(&loop);
+  __ Ldp(temp, temp1, MemOperand(ptr1, 16, PostIndex));
+  __ Ldp(temp2, out, MemOperand(ptr2, 16, PostIndex));
+  __ Cmp(temp, temp2);
+  __ Ccmp(temp1, out, NoFlag, eq);
+  __ B(&return_false, ne);
+  __ Subs(length, length, 16);
+  __ B(&loop, ge);
+
+  // Compare the remaining 0 to 15 bytes: 8 bytes at once if possible, then one at a time.
+  __ Bind(&tail);
+  __ Adds(length, length, 16);
+  __ B(&return_true, eq);
+  __ Cmp(length, 8);
+  __ B(&byte_loop, lt);
+  __ Ldr(temp, MemOperand(ptr1, 8, PostIndex));
+  __ Ldr(temp2, MemOperand(ptr2, 8, PostIndex));
+  __ Cmp(temp, temp2);
+  __ B(&return_false, ne);
+  __ Subs(length, length, 8);
+  __ B(&return_true, eq);
+  __ Bind(&byte_loop);
+  __ Ldrb(temp.W(), MemOperand(ptr1, 1, PostIndex));
+  __ Ldrb(temp2.W(), MemOperand(ptr2, 1, PostIndex));
+  __ Cmp(temp.W(), temp2.W());
+  __ B(&return_false, ne);
+  __ Subs(length, length, 1);
+  __ B(&byte_loop, ne);
+
+  __ Bind(&return_true);
+  __ Mov(out, 1);
+  __ B(&end);
+
+  __ Bind(&return_false);
+  __ Mov(out, 0);
+  __ Bind(&end);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitArraysFillByte(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke,
+                                       invoke->InputAt(0)->CanBeNull()
+                                           ? LocationSummary::kCallOnSlowPath
+                                           : LocationSummary::kNoCall,
+                                       kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+}
+
+void IntrinsicCodeGeneratorARM64::VisitArraysFillByte(HInvoke* invoke) {
+  MacroAssembler* masm = GetVIXLAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  Register array = InputRegisterAt(invoke, 0);
+  Register value = InputRegisterAt(invoke, 1);
+  Register length = WRegisterFrom(locations->GetTemp(0));
+  Register ptr = XRegisterFrom(locations->GetTemp(1));
+  FPRegister vector = VRegisterFrom(locations->GetTemp(2));
+
+  vixl::aarch64::Label loop;
+  vixl::aarch64::Label tail;
+  vixl::aarch64::Label byte_loop;
+  vixl::aarch64::Label end;
+
+  // Let Arrays.fill() throw the NullPointerException.
+  SlowPathCodeARM64* slow_path = nullptr;
+  if (invoke->InputAt(0)->CanBeNull()) {
+    slow_path = new (codegen_->GetScopedAllocator()) IntrinsicSlowPathARM64(invoke);
+    codegen_->AddSlowPath(slow_path);
+    __ Cbz(array, slow_path->GetEntryLabel());
+  }
+
+  __ Ldr(length, HeapOperand(array, mirror::Array::LengthOffset().Int32Value()));
+  __ Add(ptr, array.X(), mirror::Array::DataOffset(sizeof(int8_t)).Int32Value());
+  __ Dup(vector.V16B(), value);
+
+  // Store 16 bytes at a time, then the remaining 0 to 15 bytes one at a time.
+  __ Subs(length, length, 16);
+  __ B(&tail, lt);
+  __ Bind(&loop);
+  __ Str(vector.Q(), MemOperand(ptr, 16, PostIndex));
+  __ Subs(length, length, 16);
+  __ B(&loop, ge);
+  __ Bind(&tail);
+  __ Adds(length, length, 16);
+  __ B(&end, eq);
+  __ Bind(&byte_loop);
+  __ Strb(value, MemOperand(ptr, 1, PostIndex));
+  __ Subs(length, length, 1);
+  __ B(&byte_loop, ne);
+  __ Bind(&end);
+
+  if (slow_path != nullptr) {
+    __ Bind(slow_path->GetExitLabel());
+  }
+}
+
 void IntrinsicLocationsBuilderARM64::VisitReachabilityFence(HInvoke* invoke) {
   LocationSummary* locations =
       new (allocator_) LocationSummary(invoke, LocationSummary::kNoCall, kIntrinsified);
@@ -3054,6 +3326,7 @@ void IntrinsicLocationsBuilderARM64::VisitReachabilityFence(HInvoke* invoke) {
 void IntrinsicCodeGeneratorARM64::VisitReachabilityFence(HInvoke* invoke ATTRIBUTE_UNUSED) { }
 
 UNIMPLEMENTED_INTRINSIC(ARM64, ReferenceGetReferent)
+UNIMPLEMENTED_INTRINSIC(ARM64, ArraysHashCodeByte)
 
 UNIMPLEMENTED_INTRINSIC(ARM64, StringStringIndexOf);
 UNIMPLEMENTED_INTRINSIC(ARM64, StringStringIndexOfAfter);
@@ -3065,10 +3338,6 @@ UNIMPLEMENTED_INTRINSIC(ARM64, StringBuilderLength);
 UNIMPLEMENTED_INTRINSIC(ARM64, StringBuilderToString);
 
 // 1.8.
-UNIMPLEMENTED_INTRINSIC(ARM64, UnsafeGetAndAddInt)
-UNIMPLEMENTED_INTRINSIC(ARM64, UnsafeGetAndAddLong)
-UNIMPLEMENTED_INTRINSIC(ARM64, UnsafeGetAndSetInt)
-UNIMPLEMENTED_INTRINSIC(ARM64, UnsafeGetAndSetLong)
 UNIMPLEMENTED_INTRINSIC(ARM64, UnsafeGetAndSetObject)
 
 UNREACHABLE_INTRINSICS(ARM64)
@@ -2631,6 +2631,10 @@ void IntrinsicLocationsBuilderMIPS64::VisitReachabilityFence(HInvoke* invoke) {
 void IntrinsicCodeGeneratorMIPS64::VisitReachabilityFence(HInvoke* invoke ATTRIBUTE_UNUSED) { }
 
 UNIMPLEMENTED_INTRINSIC(MIPS64, ReferenceGetReferent)
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysEqualsByte)
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysFillByte)
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysHashCodeByte)
+UNIMPLEMENTED_INTRINSIC(MIPS64, StringHashCode)
 UNIMPLEMENTED_INTRINSIC(MIPS64, SystemArrayCopy)
 
 UNIMPLEMENTED_INTRINSIC(MIPS64, StringStringIndexOf);
@@ -3035,6 +3035,190 @@ void IntrinsicCodeGeneratorX86_64::VisitThreadInterrupted(HInvoke* invoke) {
   __ Bind(&done);
 }
 
+void IntrinsicLocationsBuilderX86_64::VisitStringHashCode(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke, LocationSummary::kCallOnSlowPath, kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetOut(Location::RequiresRegister());
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitStringHashCode(HInvoke* invoke) {
+  X86_64Assembler* assembler = GetAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  CpuRegister str = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+
+  // Note that the null check must have been done earlier.
+  DCHECK(!invoke->CanDoImplicitNullCheckOn(invoke->InputAt(0)));
+
+  // Return the cached hash code. If it is not computed yet, call String.hashCode().
+  SlowPathCode* slow_path = new (codegen_->GetScopedAllocator()) IntrinsicSlowPathX86_64(invoke);
+  codegen_->AddSlowPath(slow_path);
+  __ movl(out, Address(str, mirror::String::HashCodeOffset().Int32Value()));
+  __ testl(out, out);
+  __ j(kEqual, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitArraysEqualsByte(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke, LocationSummary::kNoCall, kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  // The remaining length, the two data pointers, and the two vectors being compared.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitArraysEqualsByte(HInvoke* invoke) {
+  X86_64Assembler* assembler = GetAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  CpuRegister array1 = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister array2 = locations->InAt(1).AsRegister<CpuRegister>();
+  CpuRegister length = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister ptr1 = locations->GetTemp(1).AsRegister<CpuRegister>();
+  CpuRegister ptr2 = locations->GetTemp(2).AsRegister<CpuRegister>();
+  XmmRegister vector1 = locations->GetTemp(3).AsFpuRegister<XmmRegister>();
+  XmmRegister vector2 = locations->GetTemp(4).AsFpuRegister<XmmRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+
+  NearLabel loop, tail, byte_loop, end, return_true, return_false;
+
+  const int32_t length_offset = mirror::Array::LengthOffset().Int32Value();
+  const int32_t data_offset = mirror::Array::DataOffset(sizeof(int8_t)).Int32Value();
+
+  // Same reference (including both null), return true.
+  __ cmpl(array1, array2);
+  __ j(kEqual, &return_true);
+  // Only one null, return false.
+  if (invoke->InputAt(0)->CanBeNull()) {
+    __ testl(array1, array1);
+    __ j(kEqual, &return_false);
+  }
+  if (invoke->InputAt(1)->CanBeNull()) {
+    __ testl(array2, array2);
+    __ j(kEqual, &return_false);
+  }
+
+  // Different lengths, return false.
+  __ movl(length, Address(array1, length_offset));
+  __ cmpl(length, Address(array2, length_offset));
+  __ j(kNotEqual, &return_false);
+
+  __ leaq(ptr1, Address(array1, data_offset));
+  __ leaq(ptr2, Address(array2, data_offset));
+
+  // Compare 16 bytes at a time with unaligned loads, never reading past the end of the data.
+  __ subl(length, Immediate(16));
+  __ j(kLess, &tail);
+  __ Bind(&loop);
+  __ movdqu(vector1, Address(ptr1, 0));
+  __ movdqu(vector2, Address(ptr2, 0));
+  __ pcmpeqb(vector1, vector2);
+  __ pmovmskb(out, vector1);
+  __ cmpl(out, Immediate(0xffff));
+  __ j(kNotEqual, &return_false);
+  __ addq(ptr1, Immediate(16));
+  __ addq(ptr2, Immediate(16));
+  __ subl(length, Immediate(16));
+  __ j(kGreaterEqual, &loop);
+
+  // Compare the remaining 0 to 15 bytes one at a time.
+  __ Bind(&tail);
+  __ addl(length, Immediate(16));
+  __ j(kEqual, &return_true);
+  __ Bind(&byte_loop);
+  __ movzxb(out, Address(ptr1, 0));
+  __ movzxb(CpuRegister(TMP), Address(ptr2, 0));
+  __ cmpl(out, CpuRegister(TMP));
+  __ j(kNotEqual, &return_false);
+  __ addq(ptr1, Immediate(1));
+  __ addq(ptr2, Immediate(1));
+  __ subl(length, Immediate(1));
+  __ j(kNotEqual, &byte_loop);
+
+  __ Bind(&return_true);
+  __ movl(out, Immediate(1));
+  __ jmp(&end);
+
+  __ Bind(&return_false);
+  __ xorl(out, out);
+  __ Bind(&end);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitArraysFillByte(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke,
+                                       invoke->InputAt(0)->CanBeNull()
+                                           ? LocationSummary::kCallOnSlowPath
+                                           : LocationSummary::kNoCall,
+                                       kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitArraysFillByte(HInvoke* invoke) {
+  X86_64Assembler* assembler = GetAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  CpuRegister array = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister value = locations->InAt(1).AsRegister<CpuRegister>();
+  CpuRegister length = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister ptr = locations->GetTemp(1).AsRegister<CpuRegister>();
+  XmmRegister vector = locations->GetTemp(2).AsFpuRegister<XmmRegister>();
+
+  NearLabel loop, tail, byte_loop, end;
+
+  // Let Arrays.fill() throw the NullPointerException.
+  SlowPathCode* slow_path = nullptr;
+  if (invoke->InputAt(0)->CanBeNull()) {
+    slow_path = new (codegen_->GetScopedAllocator()) IntrinsicSlowPathX86_64(invoke);
+    codegen_->AddSlowPath(slow_path);
+    __ testl(array, array);
+    __ j(kEqual, slow_path->GetEntryLabel());
+  }
+
+  __ movl(length, Address(array, mirror::Array::LengthOffset().Int32Value()));
+  __ leaq(ptr, Address(array, mirror::Array::DataOffset(sizeof(int8_t)).Int32Value()));
+
+  // Broadcast the low byte of `value` to all 16 lanes of `vector`.
+  __ movd(vector, value, /* is64bit */ false);
+  __ punpcklbw(vector, vector);
+  __ punpcklwd(vector, vector);
+  __ pshufd(vector, vector, Immediate(0));
+
+  // Store 16 bytes at a time, then the remaining 0 to 15 bytes one at a time.
+  __ subl(length, Immediate(16));
+  __ j(kLess, &tail);
+  __ Bind(&loop);
+  __ movdqu(Address(ptr, 0), vector);
+  __ addq(ptr, Immediate(16));
+  __ subl(length, Immediate(16));
+  __ j(kGreaterEqual, &loop);
+  __ Bind(&tail);
+  __ addl(length, Immediate(16));
+  __ j(kEqual, &end);
+  __ Bind(&byte_loop);
+  __ movb(Address(ptr, 0), value);
+  __ addq(ptr, Immediate(1));
+  __ subl(length, Immediate(1));
+  __ j(kNotEqual, &byte_loop);
+  __ Bind(&end);
+
+  if (slow_path != nullptr) {
+    __ Bind(slow_path->GetExitLabel());
+  }
+}
+
 void IntrinsicLocationsBuilderX86_64::VisitReachabilityFence(HInvoke* invoke) {
   LocationSummary* locations =
       new (allocator_) LocationSummary(invoke, LocationSummary::kNoCall, kIntrinsified);
@@ -3044,6 +3228,7 @@ void IntrinsicLocationsBuilderX86_64::VisitReachabilityFence(HInvoke* invoke) {
 void IntrinsicCodeGeneratorX86_64::VisitReachabilityFence(HInvoke* invoke ATTRIBUTE_UNUSED) { }
 
 UNIMPLEMENTED_INTRINSIC(X86_64, ReferenceGetReferent)
+UNIMPLEMENTED_INTRINSIC(X86_64, ArraysHashCodeByte)
 UNIMPLEMENTED_INTRINSIC(X86_64, FloatIsInfinite)
 UNIMPLEMENTED_INTRINSIC(X86_64, DoubleIsInfinite)
 
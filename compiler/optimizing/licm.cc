@@ -16,6 +16,11 @@
 
 #include "licm.h"
 
+#include <algorithm>
+
+#include "base/scoped_arena_allocator.h"
+#include "base/scoped_arena_containers.h"
+#include "load_store_analysis.h"
 #include "side_effects_analysis.h"
 
 namespace art {
@@ -78,18 +83,123 @@ static void UpdateLoopPhisIn(HEnvironment* environment, HLoopInformation* info)
   }
 }
 
+/**
+ * Collects in `stores` the heap locations stored to in the loop described by `info`,
+ * and returns the side effects of the loop other than these stores.
+ */
+static SideEffects CollectLoopStores(HLoopInformation* info,
+                                     const ScopedArenaVector<size_t>& heap_locations,
+                                     ScopedArenaVector<size_t>* stores) {
+  SideEffects other_effects = SideEffects::None();
+  for (HBlocksInLoopIterator it_loop(*info); !it_loop.Done(); it_loop.Advance()) {
+    for (HInstructionIterator inst_it(it_loop.Current()->GetInstructions());
+         !inst_it.Done();
+         inst_it.Advance()) {
+      HInstruction* instruction = inst_it.Current();
+      SideEffects effects = instruction->GetSideEffects();
+      size_t location = (effects.DoesAnyWrite() &&
+                         static_cast<size_t>(instruction->GetId()) < heap_locations.size())
+          ? heap_locations[instruction->GetId()]
+          : HeapLocationCollector::kHeapLocationNotFound;
+      if (location == HeapLocationCollector::kHeapLocationNotFound) {
+        other_effects = other_effects.Union(effects);
+      } else {
+        stores->push_back(location);
+        other_effects = other_effects.Union(effects.Exclusion(SideEffects::AllWrites()));
+      }
+    }
+  }
+  return other_effects;
+}
+
+/**
+ * Returns whether `null_check` has a user in the loop which could be hoisted if
+ * it used the checked reference directly.
+ */
+template <typename MayBeChangedInLoop>
+static bool HasUserHoistableWithout(HInstruction* null_check,
+                                    MayBeChangedInLoop may_be_changed_in_loop) {
+  HLoopInformation* info = null_check->GetBlock()->GetLoopInformation();
+  for (const HUseListNode<HInstruction*>& use : null_check->GetUses()) {
+    HInstruction* user = use.GetUser();
+    if (!user->IsInLoop() ||
+        !user->GetBlock()->GetLoopInformation()->IsIn(*info) ||
+        !user->CanBeMoved() ||
+        user->CanThrow() ||
+        user->NeedsEnvironment()) {
+      continue;
+    }
+    bool inputs_are_invariant = true;
+    for (HInstruction* input : user->GetInputs()) {
+      if (input != null_check && !info->IsDefinedOutOfTheLoop(input)) {
+        inputs_are_invariant = false;
+        break;
+      }
+    }
+    if (inputs_are_invariant && !may_be_changed_in_loop(user)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Returns whether null checks of loop invariant references in the loop described
+ * by `info` can be replaced by a deoptimization in its pre header.
+ */
+static bool CanSpeculateNullChecks(HGraph* graph, HLoopInformation* info) {
+  // We should never deoptimize from an osr method, otherwise we might wrongly optimize
+  // code dominated by the deoptimization.
+  if (graph->IsCompilingOsr()) {
+    return false;
+  }
+  // The previously compiled code kept deoptimizing on such speculations.
+  if (graph->IsSpeculationDisabled(DeoptimizationKind::kLoopNullLICM)) {
+    return false;
+  }
+  // A try boundary pre header is hard to handle.
+  if (info->GetPreHeader()->GetLastInstruction()->IsTryBoundary()) {
+    return false;
+  }
+  // The deoptimization needs the environment at the entry of the loop.
+  HSuspendCheck* suspend = info->GetSuspendCheck();
+  return suspend != nullptr && suspend->HasEnvironment();
+}
+
 void LICM::Run() {
   DCHECK(side_effects_.HasRun());
 
   // Only used during debug.
+  ScopedArenaAllocator allocator(graph_->GetArenaStack());
   ArenaBitVector* visited = nullptr;
   if (kIsDebugBuild) {
-    visited = new (graph_->GetAllocator()) ArenaBitVector(graph_->GetAllocator(),
-                                                          graph_->GetBlocks().size(),
-                                                          false,
-                                                          kArenaAllocLICM);
+    visited = new (&allocator) ArenaBitVector(&allocator,
+                                              graph_->GetBlocks().size(),
+                                              false,
+                                              kArenaAllocLICM);
   }
 
+  // Record the heap location accessed by each instruction, so that loads can
+  // be hoisted out of loops which only store to other locations. Empty if the
+  // load/store analysis bailed out.
+  LoadStoreAnalysis lsa(graph_);
+  lsa.Run();
+  const HeapLocationCollector& heap_location_collector = lsa.GetHeapLocationCollector();
+  ScopedArenaVector<size_t> heap_locations(allocator.Adapter(kArenaAllocLICM));
+  if (heap_location_collector.GetNumberOfHeapLocations() != 0) {
+    heap_locations.resize(graph_->GetCurrentInstructionId(),
+                          HeapLocationCollector::kHeapLocationNotFound);
+    for (HBasicBlock* block : graph_->GetReversePostOrder()) {
+      for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+        HInstruction* instruction = it.Current();
+        heap_locations[instruction->GetId()] =
+            heap_location_collector.GetHeapLocationIndexOf(instruction);
+      }
+    }
+  }
+  ScopedArenaVector<size_t> loop_stores(allocator.Adapter(kArenaAllocLICM));
+  ScopedArenaVector<HInstruction*> non_null_references(allocator.Adapter(kArenaAllocLICM));
+
   // Post order visit to visit inner loops before outer loops.
   for (HBasicBlock* block : graph_->GetPostOrder()) {
     if (!block->IsLoopHeader()) {
@@ -101,6 +211,34 @@ void LICM::Run() {
     SideEffects loop_effects = side_effects_.GetLoopEffects(block);
     HBasicBlock* pre_header = loop_info->GetPreHeader();
 
+    // Split the effects of the loop into the stores to known heap locations and
+    // everything else, so that loads of other locations can still be hoisted.
+    SideEffects loop_other_effects = loop_effects;
+    loop_stores.clear();
+    if (!heap_locations.empty() && loop_effects.DoesAnyWrite()) {
+      loop_other_effects = CollectLoopStores(loop_info, heap_locations, &loop_stores);
+    }
+    auto may_be_changed_in_loop = [&](HInstruction* instruction) {
+      SideEffects effects = instruction->GetSideEffects();
+      if (!effects.MayDependOn(loop_effects)) {
+        return false;
+      }
+      if (effects.MayDependOn(loop_other_effects) ||
+          static_cast<size_t>(instruction->GetId()) >= heap_locations.size()) {
+        return true;
+      }
+      size_t location = heap_locations[instruction->GetId()];
+      return location == HeapLocationCollector::kHeapLocationNotFound ||
+          std::any_of(loop_stores.begin(), loop_stores.end(), [&](size_t store) {
+            return store == location || heap_location_collector.MayAlias(store, location);
+          });
+    };
+
+    // References which are known to be non null in the loop thanks to a
+    // deoptimization in the pre header.
+    const bool can_speculate_null_checks = CanSpeculateNullChecks(graph_, loop_info);
+    non_null_references.clear();
+
     for (HBlocksInLoopIterator it_loop(*loop_info); !it_loop.Done(); it_loop.Advance()) {
       HBasicBlock* inner = it_loop.Current();
       DCHECK(inner->IsInLoop());
@@ -139,14 +277,26 @@ void LICM::Run() {
                 // in the loop header so far have been hoisted out, we can hoist
                 // the clinit check out also.
                 can_move = true;
-              } else if (!instruction->GetSideEffects().MayDependOn(loop_effects)) {
+              } else if (!may_be_changed_in_loop(instruction)) {
                 can_move = true;
               }
             }
-          } else if (!instruction->GetSideEffects().MayDependOn(loop_effects)) {
+          } else if (!may_be_changed_in_loop(instruction)) {
             can_move = true;
           }
         }
+        if (!can_move &&
+            can_speculate_null_checks &&
+            instruction->IsNullCheck() &&
+            loop_info->IsDefinedOutOfTheLoop(instruction->InputAt(0)) &&
+            loop_info->DominatesAllBackEdges(inner) &&
+            HasUserHoistableWithout(instruction, may_be_changed_in_loop)) {
+          // The null check cannot be hoisted as it is not the first visible instruction,
+          // but it is executed in every iteration and only stands in the way of hoisting
+          // a load: check the reference once before the loop and deoptimize if it is null.
+          SpeculateNullCheck(instruction->AsNullCheck(), loop_info, &non_null_references);
+          continue;
+        }
         if (can_move) {
           // We need to update the environment if the instruction has a loop header
           // phi in it.
@@ -169,4 +319,28 @@ void LICM::Run() {
   }
 }
 
+void LICM::SpeculateNullCheck(HNullCheck* null_check,
+                              HLoopInformation* loop_info,
+                              ScopedArenaVector<HInstruction*>* non_null_references) {
+  HInstruction* reference = null_check->InputAt(0);
+  if (std::find(non_null_references->begin(), non_null_references->end(), reference) ==
+      non_null_references->end()) {
+    // Generate: if (reference == null) deoptimize;
+    HBasicBlock* pre_header = loop_info->GetPreHeader();
+    HSuspendCheck* suspend = loop_info->GetSuspendCheck();
+    HInstruction* condition =
+        new (graph_->GetAllocator()) HEqual(reference, graph_->GetNullConstant());
+    pre_header->InsertInstructionBefore(condition, pre_header->GetLastInstruction());
+    HDeoptimize* deoptimize = new (graph_->GetAllocator()) HDeoptimize(
+        graph_->GetAllocator(), condition, DeoptimizationKind::kLoopNullLICM, suspend->GetDexPc());
+    pre_header->InsertInstructionBefore(deoptimize, pre_header->GetLastInstruction());
+    deoptimize->CopyEnvironmentFromWithLoopPhiAdjustment(suspend->GetEnvironment(),
+                                                         loop_info->GetHeader());
+    non_null_references->push_back(reference);
+  }
+  null_check->ReplaceWith(reference);
+  null_check->GetBlock()->RemoveInstruction(null_check);
+  MaybeRecordStat(stats_, MethodCompilationStat::kLoopInvariantNullCheckSpeculated);
+}
+
 }  // namespace art
@@ -17,6 +17,7 @@
 #ifndef ART_COMPILER_OPTIMIZING_LICM_H_
 #define ART_COMPILER_OPTIMIZING_LICM_H_
 
+#include "base/scoped_arena_containers.h"
 #include "nodes.h"
 #include "optimization.h"
 
@@ -38,6 +39,12 @@ class LICM : public HOptimization {
   static constexpr const char* kLoopInvariantCodeMotionPassName = "licm";
 
  private:
+  // Replaces `null_check` of a loop invariant reference with a deoptimization in
+  // the pre header of the loop, unless the reference is in `non_null_references`.
+  void SpeculateNullCheck(HNullCheck* null_check,
+                          HLoopInformation* loop_info,
+                          ScopedArenaVector<HInstruction*>* non_null_references);
+
   const SideEffectsAnalysis& side_effects_;
 
   DISALLOW_COPY_AND_ASSIGN(LICM);
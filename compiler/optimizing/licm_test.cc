@@ -175,6 +175,111 @@ TEST_F(LICMTest, NoFieldHoisting) {
   EXPECT_EQ(set_field->GetBlock(), loop_body_);
 }
 
+TEST_F(LICMTest, FieldHoistingWithUnrelatedStore) {
+  BuildLoop();
+
+  // Populate the loop with instructions: set/get different fields with same types.
+  HInstruction* get_field = new (GetAllocator()) HInstanceFieldGet(parameter_,
+                                                                   nullptr,
+                                                                   DataType::Type::kInt64,
+                                                                   MemberOffset(10),
+                                                                   false,
+                                                                   kUnknownFieldIndex,
+                                                                   kUnknownClassDefIndex,
+                                                                   graph_->GetDexFile(),
+                                                                   0);
+  loop_body_->InsertInstructionBefore(get_field, loop_body_->GetLastInstruction());
+  HInstruction* set_field = new (GetAllocator()) HInstanceFieldSet(parameter_,
+                                                                   get_field,
+                                                                   nullptr,
+                                                                   DataType::Type::kInt64,
+                                                                   MemberOffset(20),
+                                                                   false,
+                                                                   kUnknownFieldIndex,
+                                                                   kUnknownClassDefIndex,
+                                                                   graph_->GetDexFile(),
+                                                                   0);
+  loop_body_->InsertInstructionBefore(set_field, loop_body_->GetLastInstruction());
+
+  EXPECT_EQ(get_field->GetBlock(), loop_body_);
+  EXPECT_EQ(set_field->GetBlock(), loop_body_);
+  PerformLICM();
+  EXPECT_EQ(get_field->GetBlock(), loop_preheader_);
+  EXPECT_EQ(set_field->GetBlock(), loop_body_);
+}
+
+TEST_F(LICMTest, NullCheckSpeculation) {
+  BuildLoop();
+
+  // The loop needs a suspend check with an environment to deoptimize.
+  HSuspendCheck* suspend_check = new (GetAllocator()) HSuspendCheck();
+  loop_header_->InsertInstructionBefore(suspend_check, loop_header_->GetFirstInstruction());
+  suspend_check->SetRawEnvironment(new (GetAllocator()) HEnvironment(
+      GetAllocator(), 0, graph_->GetArtMethod(), 0, suspend_check));
+
+  // Populate the loop with instructions: a store, which prevents hoisting the null
+  // check, followed by a null checked get of another field.
+  HInstruction* set_field = new (GetAllocator()) HInstanceFieldSet(
+      parameter_, int_constant_, nullptr, DataType::Type::kInt32, MemberOffset(20),
+      false, kUnknownFieldIndex, kUnknownClassDefIndex, graph_->GetDexFile(), 0);
+  loop_body_->InsertInstructionBefore(set_field, loop_body_->GetLastInstruction());
+  HInstruction* null_check = new (GetAllocator()) HNullCheck(parameter_, 0);
+  loop_body_->InsertInstructionBefore(null_check, loop_body_->GetLastInstruction());
+  HInstruction* get_field = new (GetAllocator()) HInstanceFieldGet(null_check,
+                                                                   nullptr,
+                                                                   DataType::Type::kInt32,
+                                                                   MemberOffset(10),
+                                                                   false,
+                                                                   kUnknownFieldIndex,
+                                                                   kUnknownClassDefIndex,
+                                                                   graph_->GetDexFile(),
+                                                                   0);
+  loop_body_->InsertInstructionBefore(get_field, loop_body_->GetLastInstruction());
+
+  PerformLICM();
+  EXPECT_TRUE(null_check->GetBlock() == nullptr);
+  EXPECT_EQ(get_field->InputAt(0), parameter_);
+  EXPECT_EQ(get_field->GetBlock(), loop_preheader_);
+  EXPECT_EQ(set_field->GetBlock(), loop_body_);
+  HInstruction* deoptimize = get_field->GetPrevious();
+  ASSERT_TRUE(deoptimize->IsDeoptimize());
+  EXPECT_EQ(deoptimize->GetBlock(), loop_preheader_);
+  EXPECT_TRUE(deoptimize->HasEnvironment());
+}
+
+TEST_F(LICMTest, NoNullCheckSpeculationWhenDisabled) {
+  BuildLoop();
+  graph_->SetDisabledSpeculations(1u << static_cast<uint32_t>(DeoptimizationKind::kLoopNullLICM));
+
+  HSuspendCheck* suspend_check = new (GetAllocator()) HSuspendCheck();
+  loop_header_->InsertInstructionBefore(suspend_check, loop_header_->GetFirstInstruction());
+  suspend_check->SetRawEnvironment(new (GetAllocator()) HEnvironment(
+      GetAllocator(), 0, graph_->GetArtMethod(), 0, suspend_check));
+
+  // Same loop as above, but the previously compiled code kept deoptimizing.
+  HInstruction* set_field = new (GetAllocator()) HInstanceFieldSet(
+      parameter_, int_constant_, nullptr, DataType::Type::kInt32, MemberOffset(20),
+      false, kUnknownFieldIndex, kUnknownClassDefIndex, graph_->GetDexFile(), 0);
+  loop_body_->InsertInstructionBefore(set_field, loop_body_->GetLastInstruction());
+  HInstruction* null_check = new (GetAllocator()) HNullCheck(parameter_, 0);
+  loop_body_->InsertInstructionBefore(null_check, loop_body_->GetLastInstruction());
+  HInstruction* get_field = new (GetAllocator()) HInstanceFieldGet(null_check,
+                                                                   nullptr,
+                                                                   DataType::Type::kInt32,
+                                                                   MemberOffset(10),
+                                                                   false,
+                                                                   kUnknownFieldIndex,
+                                                                   kUnknownClassDefIndex,
+                                                                   graph_->GetDexFile(),
+                                                                   0);
+  loop_body_->InsertInstructionBefore(get_field, loop_body_->GetLastInstruction());
+
+  PerformLICM();
+  EXPECT_EQ(null_check->GetBlock(), loop_body_);
+  EXPECT_EQ(get_field->GetBlock(), loop_body_);
+  EXPECT_EQ(set_field->GetBlock(), loop_body_);
+}
+
 TEST_F(LICMTest, ArrayHoisting) {
   BuildLoop();
 
@@ -54,6 +54,31 @@ static void AddToListForLinearization(ScopedArenaVector<HBasicBlock*>* worklist,
   worklist->insert(insert_pos.base(), block);
 }
 
+// Helper method to decide whether a block is unlikely to execute. We do not profile
+// branches, so, like code sinking, we use paths that can only end in a throw, as
+// well as catch blocks, as an indicator of uncommon code. Successors are visited
+// first in post order, except for back edges which are conservatively not cold.
+static bool IsColdBlock(HBasicBlock* block, const ScopedArenaVector<bool>& is_cold) {
+  if (block->IsCatchBlock()) {
+    return true;
+  }
+  if (block->IsExitBlock() || block->GetSuccessors().empty()) {
+    return false;
+  }
+  for (HBasicBlock* successor : block->GetSuccessors()) {
+    if (successor->IsExitBlock()) {
+      // Any predecessor of the exit that does not return, throws an exception.
+      HInstruction* last = block->GetLastInstruction();
+      if (last->IsReturn() || last->IsReturnVoid()) {
+        return false;
+      }
+    } else if (!is_cold[successor->GetBlockId()]) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // Helper method to validate linear order.
 static bool IsLinearOrderWellFormed(const HGraph* graph, ArrayRef<HBasicBlock*> linear_order) {
   for (HBasicBlock* header : graph->GetBlocks()) {
@@ -87,14 +112,24 @@ void LinearizeGraphInternal(const HGraph* graph, ArrayRef<HBasicBlock*> linear_o
   DCHECK_EQ(linear_order.size(), graph->GetReversePostOrder().size());
   // Create a reverse post ordering with the following properties:
   // - Blocks in a loop are consecutive,
-  // - Back-edge is the last block before loop exits.
+  // - Back-edge is the last block before loop exits,
+  // - Cold blocks outside loops are after all other blocks.
   //
+  // (0): Find the cold blocks, so that they do not break up the hot fall-through
+  //      chains and are moved out of the instruction cache lines of hot code.
+  //      Cold blocks in loops are left in place to keep loops contiguous.
+  ScopedArenaAllocator allocator(graph->GetArenaStack());
+  ScopedArenaVector<bool> is_cold(graph->GetBlocks().size(),
+                                  false,
+                                  allocator.Adapter(kArenaAllocLinearOrder));
+  for (HBasicBlock* block : graph->GetPostOrder()) {
+    is_cold[block->GetBlockId()] = IsColdBlock(block, is_cold);
+  }
   // (1): Record the number of forward predecessors for each block. This is to
   //      ensure the resulting order is reverse post order. We could use the
   //      current reverse post order in the graph, but it would require making
   //      order queries to a GrowableArray, which is not the best data structure
   //      for it.
-  ScopedArenaAllocator allocator(graph->GetArenaStack());
   ScopedArenaVector<uint32_t> forward_predecessors(graph->GetBlocks().size(),
                                                    allocator.Adapter(kArenaAllocLinearOrder));
   for (HBasicBlock* block : graph->GetReversePostOrder()) {
@@ -108,7 +143,9 @@ void LinearizeGraphInternal(const HGraph* graph, ArrayRef<HBasicBlock*> linear_o
   //      iterate over the successors. When all non-back edge predecessors of a
   //      successor block are visited, the successor block is added in the worklist
   //      following an order that satisfies the requirements to build our linear graph.
+  //      Cold blocks outside loops are held back until nothing else is left.
   ScopedArenaVector<HBasicBlock*> worklist(allocator.Adapter(kArenaAllocLinearOrder));
+  ScopedArenaVector<HBasicBlock*> cold_worklist(allocator.Adapter(kArenaAllocLinearOrder));
   worklist.push_back(graph->GetEntryBlock());
   size_t num_added = 0u;
   do {
@@ -120,10 +157,19 @@ void LinearizeGraphInternal(const HGraph* graph, ArrayRef<HBasicBlock*> linear_o
       int block_id = successor->GetBlockId();
       size_t number_of_remaining_predecessors = forward_predecessors[block_id];
       if (number_of_remaining_predecessors == 1) {
-        AddToListForLinearization(&worklist, successor);
+        if (is_cold[block_id] && successor->GetLoopInformation() == nullptr) {
+          cold_worklist.push_back(successor);
+        } else {
+          AddToListForLinearization(&worklist, successor);
+        }
       }
       forward_predecessors[block_id] = number_of_remaining_predecessors - 1;
     }
+    if (worklist.empty()) {
+      // Lay out the cold blocks in the order in which they became ready.
+      worklist.insert(worklist.end(), cold_worklist.rbegin(), cold_worklist.rend());
+      cold_worklist.clear();
+    }
   } while (!worklist.empty());
   DCHECK_EQ(num_added, linear_order.size());
 
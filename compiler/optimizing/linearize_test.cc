@@ -25,6 +25,7 @@
 #include "dex/dex_instruction.h"
 #include "driver/compiler_options.h"
 #include "graph_visualizer.h"
+#include "linear_order.h"
 #include "nodes.h"
 #include "optimizing_unit_test.h"
 #include "pretty_printer.h"
@@ -246,4 +247,54 @@ TEST_F(LinearizeTest, CFG7) {
   TestCode(data, blocks);
 }
 
+TEST_F(LinearizeTest, ColdBlockIsLast) {
+  // Structure of this graph, where Block2 throws
+  //            Block0
+  //              |
+  //            Block1
+  //            /    \
+  //       Block3   Block2
+  //            \    /
+  //            Block4
+  //
+  HGraph* graph = CreateGraph();
+  HBasicBlock* entry = new (GetAllocator()) HBasicBlock(graph);
+  HBasicBlock* test = new (GetAllocator()) HBasicBlock(graph);
+  HBasicBlock* cold = new (GetAllocator()) HBasicBlock(graph);
+  HBasicBlock* hot = new (GetAllocator()) HBasicBlock(graph);
+  HBasicBlock* exit = new (GetAllocator()) HBasicBlock(graph);
+  for (HBasicBlock* block : {entry, test, cold, hot, exit}) {
+    graph->AddBlock(block);
+  }
+  graph->SetEntryBlock(entry);
+  graph->SetExitBlock(exit);
+  entry->AddSuccessor(test);
+  // Without cold block placement, the throwing successor would be laid out first.
+  test->AddSuccessor(hot);
+  test->AddSuccessor(cold);
+  cold->AddSuccessor(exit);
+  hot->AddSuccessor(exit);
+
+  HInstruction* condition = new (GetAllocator()) HParameterValue(
+      graph->GetDexFile(), dex::TypeIndex(0), 0, DataType::Type::kBool);
+  HInstruction* exception = new (GetAllocator()) HParameterValue(
+      graph->GetDexFile(), dex::TypeIndex(1), 1, DataType::Type::kReference);
+  entry->AddInstruction(condition);
+  entry->AddInstruction(exception);
+  entry->AddInstruction(new (GetAllocator()) HGoto());
+  test->AddInstruction(new (GetAllocator()) HIf(condition));
+  cold->AddInstruction(new (GetAllocator()) HThrow(exception, 0));
+  hot->AddInstruction(new (GetAllocator()) HReturnVoid());
+  exit->AddInstruction(new (GetAllocator()) HExit());
+  graph->BuildDominatorTree();
+
+  ArenaVector<HBasicBlock*> linear_order(GetAllocator()->Adapter(kArenaAllocLinearOrder));
+  LinearizeGraph(graph, &linear_order);
+  const uint32_t blocks[] = {0, 1, 3, 2, 4};
+  ASSERT_EQ(arraysize(blocks), linear_order.size());
+  for (size_t i = 0; i < arraysize(blocks); ++i) {
+    ASSERT_EQ(blocks[i], linear_order[i]->GetBlockId());
+  }
+}
+
 }  // namespace art
@@ -256,6 +256,31 @@ class HeapLocationCollector : public HGraphVisitor {
                                  HeapLocation::kDeclaringClassDefIndexForArrays);
   }
 
+  // Returns the heap location accessed by a field or array access, or
+  // kHeapLocationNotFound for any other instruction.
+  size_t GetHeapLocationIndexOf(HInstruction* instruction) const {
+    if (instruction->IsInstanceFieldGet()) {
+      return GetFieldHeapLocation(instruction->InputAt(0),
+                                  &instruction->AsInstanceFieldGet()->GetFieldInfo());
+    } else if (instruction->IsInstanceFieldSet()) {
+      return GetFieldHeapLocation(instruction->InputAt(0),
+                                  &instruction->AsInstanceFieldSet()->GetFieldInfo());
+    } else if (instruction->IsStaticFieldGet()) {
+      return GetFieldHeapLocation(instruction->InputAt(0),
+                                  &instruction->AsStaticFieldGet()->GetFieldInfo());
+    } else if (instruction->IsStaticFieldSet()) {
+      return GetFieldHeapLocation(instruction->InputAt(0),
+                                  &instruction->AsStaticFieldSet()->GetFieldInfo());
+    } else if (instruction->IsArrayGet() || instruction->IsArraySet()) {
+      return GetArrayHeapLocation(instruction->InputAt(0), instruction->InputAt(1));
+    } else if (instruction->IsVecLoad() || instruction->IsVecStore()) {
+      return GetArrayHeapLocation(instruction->InputAt(0),
+                                  instruction->InputAt(1),
+                                  instruction->AsVecMemoryOperation()->GetVectorLength());
+    }
+    return kHeapLocationNotFound;
+  }
+
   bool HasHeapStores() const {
     return has_heap_stores_;
   }
@@ -58,6 +58,10 @@
  *   need to participate in merging heap values. Allocation of a singleton
  *   can be eliminated if that singleton is not used and does not persist
  *   at method return/deoptimization.
+ * - When the predecessors of a block hold different values for a field of a
+ *   removable singleton, a phi merging those values becomes the heap value.
+ *   This is a form of scalar replacement: the singleton's fields live in SSA
+ *   values across branches and the allocation can still be eliminated.
  * - For newly instantiated instances, their heap values are initialized to
  *   language defined default values.
  * - Some instructions such as invokes are treated as loading and invalidating
@@ -104,7 +108,8 @@ class LSEVisitor : public HGraphDelegateVisitor {
         removed_loads_(allocator_.Adapter(kArenaAllocLSE)),
         substitute_instructions_for_loads_(allocator_.Adapter(kArenaAllocLSE)),
         possibly_removed_stores_(allocator_.Adapter(kArenaAllocLSE)),
-        singleton_new_instances_(allocator_.Adapter(kArenaAllocLSE)) {
+        singleton_new_instances_(allocator_.Adapter(kArenaAllocLSE)),
+        added_phis_(allocator_.Adapter(kArenaAllocLSE)) {
   }
 
   void VisitBasicBlock(HBasicBlock* block) OVERRIDE {
@@ -244,6 +249,17 @@ class LSEVisitor : public HGraphDelegateVisitor {
       store->GetBlock()->RemoveInstruction(store);
     }
 
+    // Remove the phis that ended up not replacing any load. Phis may use the
+    // phis added before them, so visit them in reverse order.
+    for (auto it = added_phis_.rbegin(); it != added_phis_.rend(); ++it) {
+      HPhi* phi = *it;
+      if (!phi->HasUses()) {
+        phi->GetBlock()->RemovePhi(phi);
+      } else {
+        MaybeRecordStat(stats_, MethodCompilationStat::kPhiAddedLSE);
+      }
+    }
+
     // Eliminate singleton-classified instructions:
     //   * - Constructor fences (they never escape this thread).
     //   * - Allocations (if they are unused).
@@ -456,17 +472,26 @@ class LSEVisitor : public HGraphDelegateVisitor {
         DCHECK(!from_all_predecessors);
         DCHECK(singleton_ref != nullptr);
       }
+      HPhi* merged_phi = nullptr;
       if (from_all_predecessors) {
         if (ref_info->IsSingletonAndRemovable() &&
             block->IsSingleReturnOrReturnVoidAllowingPhis()) {
           // Values in the singleton are not needed anymore.
-        } else if (!IsStore(merged_value)) {
-          // We don't track merged value as a store anymore. We have to
-          // hold the stores in predecessors live here.
-          for (HBasicBlock* predecessor : predecessors) {
-            ScopedArenaVector<HInstruction*>& pred_values =
-                heap_values_for_[predecessor->GetBlockId()];
-            KeepIfIsStore(pred_values[i]);
+        } else {
+          if (predecessors.size() > 1 && merged_store_value == kUnknownHeapValue) {
+            merged_phi = TryMergingIntoPhi(block, i);
+          }
+          if (merged_phi != nullptr) {
+            // The loads after the merge use the phi instead of the stores in
+            // the predecessors, so those stores do not need to be kept.
+          } else if (!IsStore(merged_value)) {
+            // We don't track merged value as a store anymore. We have to
+            // hold the stores in predecessors live here.
+            for (HBasicBlock* predecessor : predecessors) {
+              ScopedArenaVector<HInstruction*>& pred_values =
+                  heap_values_for_[predecessor->GetBlockId()];
+              KeepIfIsStore(pred_values[i]);
+            }
           }
         }
       } else {
@@ -493,6 +518,8 @@ class LSEVisitor : public HGraphDelegateVisitor {
                merged_value->GetBlock()->Dominates(block));
         if (merged_value != kUnknownHeapValue) {
           heap_values[i] = merged_value;
+        } else if (merged_phi != nullptr) {
+          heap_values[i] = merged_phi;
         } else {
           // Stores in different predecessors may be storing the same value.
           heap_values[i] = merged_store_value;
@@ -501,6 +528,63 @@ class LSEVisitor : public HGraphDelegateVisitor {
     }
   }
 
+  // Try to merge the conflicting values that the predecessors of `block` hold for the
+  // location at `loc_index` into a new phi. This is only done for the fields of a
+  // removable singleton: the phi replaces the loads after the merge, so that the
+  // stores in the predecessors, and eventually the allocation itself, can be
+  // removed. Returns null if the values cannot be merged.
+  //
+  // The location must not be killed by loop side effects, so that it is never
+  // read from memory after its stores have been removed. For the same reason,
+  // graphs with irreducible loops are not handled.
+  HPhi* TryMergingIntoPhi(HBasicBlock* block, size_t loc_index) {
+    HeapLocation* location = heap_location_collector_.GetHeapLocation(loc_index);
+    ReferenceInfo* ref_info = location->GetReferenceInfo();
+    if (!ref_info->IsSingletonAndRemovable() ||
+        location->IsArray() ||
+        location->IsValueKilledByLoopSideEffects() ||
+        GetGraph()->HasIrreducibleLoops()) {
+      return nullptr;
+    }
+    HInstruction* ref = ref_info->GetReference();
+    DataType::Type type = DataType::Type::kVoid;
+    for (HBasicBlock* predecessor : block->GetPredecessors()) {
+      if (!ref->GetBlock()->Dominates(predecessor)) {
+        return nullptr;
+      }
+      HInstruction* value =
+          GetRealHeapValue(heap_values_for_[predecessor->GetBlockId()][loc_index]);
+      if (value == kUnknownHeapValue) {
+        return nullptr;
+      }
+      if (value == kDefaultHeapValue) {
+        continue;
+      }
+      DataType::Type value_type = HPhi::ToPhiType(value->GetType());
+      if (type == DataType::Type::kVoid) {
+        type = value_type;
+      } else if (type != value_type) {
+        return nullptr;
+      }
+    }
+    // Reference phis would need a reference type info.
+    // TODO: merge reference values too.
+    if (type == DataType::Type::kVoid || type == DataType::Type::kReference) {
+      return nullptr;
+    }
+
+    ArenaAllocator* allocator = GetGraph()->GetAllocator();
+    HPhi* phi = new (allocator) HPhi(allocator, kNoRegNumber, 0, type);
+    for (HBasicBlock* predecessor : block->GetPredecessors()) {
+      HInstruction* value =
+          GetRealHeapValue(heap_values_for_[predecessor->GetBlockId()][loc_index]);
+      phi->AddInput(value == kDefaultHeapValue ? GetDefaultValue(type) : value);
+    }
+    block->AddPhi(phi);
+    added_phis_.push_back(phi);
+    return phi;
+  }
+
   // `instruction` is being removed. Try to see if the null check on it
   // can be removed. This can happen if the same value is set in two branches
   // but not in dominators. Such as:
@@ -945,6 +1029,9 @@ class LSEVisitor : public HGraphDelegateVisitor {
 
   ScopedArenaVector<HInstruction*> singleton_new_instances_;
 
+  // Phis merging the values of removable singletons' fields.
+  ScopedArenaVector<HPhi*> added_phis_;
+
   DISALLOW_COPY_AND_ASSIGN(LSEVisitor);
 };
 
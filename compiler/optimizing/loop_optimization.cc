@@ -24,9 +24,11 @@
 #include "arch/x86/instruction_set_features_x86.h"
 #include "arch/x86_64/instruction_set_features_x86_64.h"
 #include "driver/compiler_driver.h"
+#include "driver/compiler_options.h"
 #include "linear_order.h"
 #include "mirror/array-inl.h"
 #include "mirror/string.h"
+#include "superblock_cloner.h"
 
 namespace art {
 
@@ -36,10 +38,129 @@ static constexpr bool kEnableVectorization = true;
 // No loop unrolling factor (just one copy of the loop-body).
 static constexpr uint32_t kNoUnrollingFactor = 1;
 
+// Maximum number of basic blocks of a loop to be peeled or unrolled as a scalar loop.
+static constexpr size_t kScalarHeuristicMaxBodySizeBlocks = 8;
+
+// Maximum number of instructions, including phis, of a loop to be peeled or unrolled as
+// a scalar loop.
+static constexpr size_t kScalarHeuristicMaxBodySizeInstr = 40;
+
+// Number of instructions that scalar loop peeling and unrolling may add to a method
+// compiled for speed.
+static constexpr uint32_t kScalarCodeGrowthBudget = 120;
+
+// Maximum number of instructions executed by all iterations of an inner loop without a suspend
+// check, i.e. the trip count times the number of instructions of the loop.
+static constexpr int64_t kMaxInstructionsWithoutSuspendCheck = 1024;
+
 //
 // Static helpers.
 //
 
+// Returns the number of instructions that scalar loop peeling and unrolling may add to a
+// method. Filters that favor space get no code growth at all. Filters that only compile the
+// methods found hot in a profile get twice the budget, as the growth goes where it pays off.
+static uint32_t GetScalarCodeGrowthBudget(CompilerDriver* compiler_driver) {
+  if (compiler_driver == nullptr) {
+    return 0;
+  }
+  CompilerFilter::Filter filter = compiler_driver->GetCompilerOptions().GetCompilerFilter();
+  if (!CompilerFilter::IsAsGoodAs(filter, CompilerFilter::kSpeedProfile)) {
+    return 0;
+  }
+  return CompilerFilter::DependsOnProfile(filter)
+      ? 2 * kScalarCodeGrowthBudget
+      : kScalarCodeGrowthBudget;
+}
+
+// Returns whether the loop has an exit controlled by a condition defined outside of the loop.
+static bool HasLoopInvariantExit(HLoopInformation* loop_info) {
+  for (HBlocksInLoopIterator it(*loop_info); !it.Done(); it.Advance()) {
+    HBasicBlock* block = it.Current();
+    HInstruction* last = block->GetLastInstruction();
+    if (!last->IsIf()) {
+      continue;
+    }
+    HInstruction* condition = last->InputAt(0);
+    if (condition->IsConstant() || loop_info->Contains(*condition->GetBlock())) {
+      continue;
+    }
+    for (HBasicBlock* successor : block->GetSuccessors()) {
+      if (!loop_info->Contains(*successor)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Returns whether the header is the only block of the loop that exits it.
+static bool IsHeaderTheOnlyExit(HLoopInformation* loop_info) {
+  HBasicBlock* header = loop_info->GetHeader();
+  for (HBlocksInLoopIterator it(*loop_info); !it.Done(); it.Advance()) {
+    HBasicBlock* block = it.Current();
+    for (HBasicBlock* successor : block->GetSuccessors()) {
+      if (!loop_info->Contains(*successor) && block != header) {
+        return false;
+      }
+    }
+  }
+  return header->GetLastInstruction()->IsIf();
+}
+
+// Returns whether the loop contains instructions whose cost dominates the iteration,
+// which makes scalar peeling and unrolling not worth the code growth.
+static bool HasInstructionsPreventingScalarOpts(HLoopInformation* loop_info) {
+  for (HBlocksInLoopIterator it(*loop_info); !it.Done(); it.Advance()) {
+    HBasicBlock* block = it.Current();
+    for (HInstructionIterator it2(block->GetInstructions()); !it2.Done(); it2.Advance()) {
+      HInstruction* instruction = it2.Current();
+      if (instruction->IsInvoke() ||
+          instruction->IsNewInstance() ||
+          instruction->IsNewArray() ||
+          instruction->IsMonitorOperation() ||
+          instruction->IsThrow()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Uses `hif`, evaluated at the end of its block, to statically evaluate the other uses of its
+// condition: in the blocks dominated by the true successor the condition is known to be true,
+// and in the ones dominated by the false successor it is known to be false.
+//     if (cond) {               if (cond) {
+//       if (cond) {}              if (1) {}
+//     } else {        =======>  } else {
+//       if (cond) {}              if (0) {}
+//     }                         }
+static void TryToEvaluateIfCondition(HIf* hif, HGraph* graph) {
+  HInstruction* cond = hif->InputAt(0);
+  if (cond->IsConstant()) {
+    return;
+  }
+  HBasicBlock* true_succ = hif->IfTrueSuccessor();
+  HBasicBlock* false_succ = hif->IfFalseSuccessor();
+  // With a critical edge the successor could also be reached the other way.
+  if (true_succ->GetPredecessors().size() != 1 || false_succ->GetPredecessors().size() != 1) {
+    return;
+  }
+  const HUseList<HInstruction*>& uses = cond->GetUses();
+  for (auto it = uses.begin(), end = uses.end(); it != end; /* ++it below */) {
+    HInstruction* user = it->GetUser();
+    size_t index = it->GetIndex();
+    HBasicBlock* user_block = user->GetBlock();
+    // Increment `it` now because `*it` may disappear thanks to user->ReplaceInput().
+    ++it;
+    if (true_succ->Dominates(user_block)) {
+      user->ReplaceInput(graph->GetIntConstant(1), index);
+    } else if (false_succ->Dominates(user_block)) {
+      user->ReplaceInput(graph->GetIntConstant(0), index);
+    }
+  }
+}
+
 // Base alignment for arrays/strings guaranteed by the Android runtime.
 static uint32_t BaseAlignment() {
   return kObjectAlignment;
@@ -420,6 +541,7 @@ HLoopOptimization::HLoopOptimization(HGraph* graph,
       iset_(nullptr),
       reductions_(nullptr),
       simplified_(false),
+      scalar_code_budget_(0),
       vector_length_(0),
       vector_refs_(nullptr),
       vector_static_peeling_factor_(0),
@@ -432,7 +554,8 @@ HLoopOptimization::HLoopOptimization(HGraph* graph,
       vector_preheader_(nullptr),
       vector_header_(nullptr),
       vector_body_(nullptr),
-      vector_index_(nullptr) {
+      vector_index_(nullptr),
+      vector_overlapping_epilogue_(false) {
 }
 
 void HLoopOptimization::Run() {
@@ -442,6 +565,8 @@ void HLoopOptimization::Run() {
     return;
   }
 
+  scalar_code_budget_ = GetScalarCodeGrowthBudget(compiler_driver_);
+
   // Phase-local allocator.
   ScopedArenaAllocator allocator(graph_->GetArenaStack());
   loop_allocator_ = &allocator;
@@ -644,6 +769,44 @@ void HLoopOptimization::SimplifyBlocks(LoopNode* node) {
 }
 
 bool HLoopOptimization::OptimizeInnerLoop(LoopNode* node) {
+  TryRemovingSuspendCheck(node);
+  return TryOptimizeInnerLoopFinite(node) ||
+         TryVectorizeSearchLoop(node) ||
+         TryPeelingAndUnrolling(node);
+}
+
+void HLoopOptimization::TryRemovingSuspendCheck(LoopNode* node) {
+  HLoopInformation* loop_info = node->loop_info;
+  HSuspendCheck* suspend_check = loop_info->GetSuspendCheck();
+  // OSR enters compiled code at the loop suspend checks.
+  if (suspend_check == nullptr || suspend_check->IsNoOp() || graph_->IsCompilingOsr()) {
+    return;
+  }
+  // An inner loop with a small constant trip count runs for a bounded time, and the suspend
+  // checks of the enclosing code still bound the time between suspend points. Calls and
+  // allocations are excluded, as their cost is not bounded by the instruction count.
+  int64_t trip_count = 0;
+  if (!induction_range_.IsFinite(loop_info, &trip_count) ||
+      trip_count <= 0 ||
+      trip_count > kMaxInstructionsWithoutSuspendCheck ||
+      HasInstructionsPreventingScalarOpts(loop_info)) {
+    return;
+  }
+  int64_t number_of_instructions = 0;
+  for (HBlocksInLoopIterator it(*loop_info); !it.Done(); it.Advance()) {
+    for (HInstructionIterator it2(it.Current()->GetInstructions()); !it2.Done(); it2.Advance()) {
+      ++number_of_instructions;
+    }
+  }
+  if (trip_count * number_of_instructions > kMaxInstructionsWithoutSuspendCheck) {
+    return;
+  }
+  // Keep the suspend check for the environment of the loop, but do not generate code for it.
+  suspend_check->SetIsNoOp(true);
+  MaybeRecordStat(stats_, MethodCompilationStat::kLoopSuspendCheckRemoved);
+}
+
+bool HLoopOptimization::TryOptimizeInnerLoopFinite(LoopNode* node) {
   HBasicBlock* header = node->loop_info->GetHeader();
   HBasicBlock* preheader = node->loop_info->GetPreHeader();
   // Ensure loop header logic is finite.
@@ -713,6 +876,280 @@ bool HLoopOptimization::OptimizeInnerLoop(LoopNode* node) {
   return false;
 }
 
+bool HLoopOptimization::TryVectorizeSearchLoop(LoopNode* node) {
+  HLoopInformation* loop_info = node->loop_info;
+  HBasicBlock* header = loop_info->GetHeader();
+  HBasicBlock* preheader = loop_info->GetPreHeader();
+  if (!kEnableVectorization) {
+    return false;
+  }
+  // Ensure loop header logic is finite. Due to the early exit, the trip
+  // count is just an upper bound on the number of iterations.
+  int64_t trip_count = 0;
+  if (!induction_range_.IsFinite(loop_info, &trip_count)) {
+    return false;
+  }
+  // Ensure the loop consists of a header, a search block, and a latch:
+  //   header: if (i >= n) goto exit1
+  //   search: if (cond(a[i])) goto exit2
+  //   latch:  i++
+  if (loop_info->GetBlocks().NumSetBits() != 3 ||
+      loop_info->NumberOfBackEdges() != 1 ||
+      header->GetSuccessors().size() != 2) {
+    return false;
+  }
+  HBasicBlock* latch = loop_info->GetBackEdges()[0];
+  if (latch == header || latch->GetPredecessors().size() != 1) {
+    return false;
+  }
+  HBasicBlock* search = latch->GetSinglePredecessor();
+  if (search == header ||
+      search->GetPredecessors().size() != 1 ||
+      search->GetSinglePredecessor() != header ||
+      !search->GetPhis().IsEmpty()) {
+    return false;
+  }
+  HIf* search_if = search->GetLastInstruction()->AsIf();
+  if (search_if == nullptr) {
+    return false;
+  }
+  bool exit_on_true = !loop_info->Contains(*search_if->IfTrueSuccessor());
+  if (exit_on_true == !loop_info->Contains(*search_if->IfFalseSuccessor())) {
+    return false;
+  }
+  // Ensure a simple loop header, with a unit stride main induction and no reductions.
+  HPhi* main_phi = nullptr;
+  HInstruction* offset = nullptr;
+  if (!TrySetSimpleLoopHeader(header, &main_phi) ||
+      !reductions_->empty() ||
+      main_phi->GetType() != DataType::Type::kInt32 ||
+      !induction_range_.IsUnitStride(main_phi, main_phi, graph_, &offset)) {
+    return false;
+  }
+  // Ensure that apart from the main induction, the loop has no side effects and
+  // cannot throw, so that skipping iterations that do not exit early is unobservable.
+  for (HInstructionIterator it(latch->GetInstructions()); !it.Done(); it.Advance()) {
+    HInstruction* instruction = it.Current();
+    if (!instruction->IsGoto() && iset_->find(instruction) == iset_->end()) {
+      return false;
+    }
+  }
+  for (HInstructionIterator it(search->GetInstructions()); !it.Done(); it.Advance()) {
+    HInstruction* instruction = it.Current();
+    if (instruction != search_if &&
+        iset_->find(instruction) == iset_->end() &&
+        (instruction->GetSideEffects().DoesAnyWrite() ||
+         instruction->CanThrow() ||
+         instruction->NeedsEnvironment())) {
+      return false;
+    }
+  }
+  // Ensure the early exit is taken on a comparison of a loop variant integral value with
+  // a value of the same type (or a constant in its range), so that the vector condition
+  // on components of that type is exact.
+  HInstruction* condition = search_if->InputAt(0);
+  if (!condition->IsCondition() || condition->GetBlock() != search) {
+    return false;
+  }
+  HInstruction* opa = condition->InputAt(0);
+  HInstruction* opb = condition->InputAt(1);
+  HInstruction* variant = loop_info->IsDefinedOutOfTheLoop(opa) ? opb : opa;
+  if (loop_info->IsDefinedOutOfTheLoop(variant)) {
+    return false;  // loop invariant exit, left to peeling
+  }
+  DataType::Type type = variant->GetType();
+  if (!DataType::IsIntegralType(type)) {
+    return false;
+  }
+  for (HInstruction* operand : condition->GetInputs()) {
+    int64_t value = 0;
+    if (operand->GetType() != type &&
+        !(IsInt64AndGet(operand, &value) &&
+          DataType::MinValueOfIntegralType(type) <= value &&
+          value <= DataType::MaxValueOfIntegralType(type))) {
+      return false;
+    }
+  }
+  IfCondition cond = exit_on_true
+      ? condition->AsCondition()->GetCondition()
+      : condition->AsCondition()->GetOppositeCondition();
+  if (DataType::IsUnsignedType(type)) {
+    switch (cond) {
+      case kCondLT: cond = kCondB; break;
+      case kCondLE: cond = kCondBE; break;
+      case kCondGT: cond = kCondA; break;
+      case kCondGE: cond = kCondAE; break;
+      default: break;
+    }
+  }
+  // Ensure the operands of the condition vectorize and that there are
+  // vector conditions for the type.
+  vector_length_ = 0;
+  vector_refs_->clear();
+  vector_static_peeling_factor_ = 0;
+  vector_dynamic_peeling_candidate_ = nullptr;
+  vector_runtime_test_a_ =
+  vector_runtime_test_b_ = nullptr;
+  uint64_t restrictions = kNone;
+  if (!TrySetVectorType(type, &restrictions) ||
+      HasVectorRestrictions(restrictions, kNoSelect) ||
+      !VectorizeUse(node, opa, /*generate_code*/ false, type, restrictions) ||
+      !VectorizeUse(node, opb, /*generate_code*/ false, type, restrictions)) {
+    return false;
+  }
+  // Does vectorization seem profitable?
+  if (trip_count != 0 && trip_count < 2 * static_cast<int64_t>(vector_length_)) {
+    return false;
+  }
+
+  // Generate loop control:
+  // stc = <trip-count>;
+  // vtc = stc - stc % vl;
+  DataType::Type induc_type = main_phi->GetType();
+  HInstruction* stc = induction_range_.GenerateTripCount(loop_info, graph_, preheader);
+  HInstruction* rem = Insert(
+      preheader, new (global_allocator_) HAnd(induc_type,
+                                              stc,
+                                              graph_->GetConstant(induc_type, vector_length_ - 1)));
+  HInstruction* vtc = Insert(preheader, new (global_allocator_) HSub(induc_type, stc, rem));
+
+  // Generate vector loop, which stops at the first vector in which any component
+  // may take the early exit, followed by the original loop as scalar finishing
+  // sequence, which finds the exact exit or does the remainder iterations:
+  // for (j = 0; j < vtc; j += vl)
+  //    if (any(<vectorized-condition>)) break;
+  // for (i = lo + j; i < n; i++)
+  //    <loop-body>
+  vector_preheader_ = graph_->TransformLoopForEarlyExitVectorization(header);
+  vector_header_ = vector_preheader_->GetSingleSuccessor();
+  vector_body_ = vector_header_->GetSuccessors()[1];
+  HBasicBlock* vector_latch = vector_body_->GetSuccessors()[1];
+  HPhi* phi = new (global_allocator_) HPhi(global_allocator_,
+                                           kNoRegNumber,
+                                           0,
+                                           HPhi::ToPhiType(induc_type));
+  HInstruction* vector_cond = new (global_allocator_) HAboveOrEqual(phi, vtc);
+  vector_header_->AddPhi(phi);
+  vector_header_->AddInstruction(vector_cond);
+  vector_header_->AddInstruction(new (global_allocator_) HIf(vector_cond));
+  HIf* vector_exit = new (global_allocator_) HIf(graph_->GetIntConstant(0));  // set below
+  vector_body_->AddInstruction(vector_exit);
+  vector_mode_ = kVector;
+  vector_index_ = phi;
+  vector_map_->clear();
+  vector_permanent_map_->clear();
+  bool vectorized_condition =
+      VectorizeUse(node, opa, /*generate_code*/ true, type, restrictions) &&
+      VectorizeUse(node, opb, /*generate_code*/ true, type, restrictions);
+  DCHECK(vectorized_condition);
+  // Generate body from the instruction map, but in original program order.
+  for (HInstructionIterator it(search->GetInstructions()); !it.Done(); it.Advance()) {
+    auto i = vector_map_->find(it.Current());
+    if (i != vector_map_->end() && !i->second->IsInBlock()) {
+      Insert(vector_body_, i->second);
+    }
+  }
+  HInstruction* mask = Insert(vector_body_, new (global_allocator_) HVecCondition(
+      global_allocator_,
+      vector_map_->Get(opa),
+      vector_map_->Get(opb),
+      cond,
+      type,
+      vector_length_,
+      condition->GetDexPc()));
+  HInstruction* any = Insert(vector_body_, new (global_allocator_) HVecAnyTrue(
+      global_allocator_, mask, type, vector_length_, condition->GetDexPc()));
+  vector_exit->ReplaceInput(any, 0);
+  HInstruction* next = Insert(vector_latch, new (global_allocator_) HAdd(
+      induc_type, phi, graph_->GetConstant(induc_type, vector_length_)));
+  phi->AddInput(graph_->GetConstant(induc_type, 0));
+  phi->AddInput(next);
+  // Restart the original loop where the vector loop stopped.
+  HInstruction* restart = Insert(loop_info->GetPreHeader(), new (global_allocator_) HAdd(
+      induc_type, main_phi->InputAt(0), phi));
+  main_phi->ReplaceInput(restart, 0);
+
+  graph_->SetHasSIMD(true);  // flag SIMD usage
+  MaybeRecordStat(stats_, MethodCompilationStat::kLoopVectorizedEarlyExit);
+  return true;
+}
+
+//
+// Scalar loop peeling and unrolling.
+//
+
+bool HLoopOptimization::TryPeelingAndUnrolling(LoopNode* node) {
+  HLoopInformation* loop_info = node->loop_info;
+  if (scalar_code_budget_ == 0 ||
+      loop_info->GetBlocks().NumSetBits() > kScalarHeuristicMaxBodySizeBlocks ||
+      HasInstructionsPreventingScalarOpts(loop_info)) {
+    return false;
+  }
+  return TryPeelingForLoopInvariantExitsElimination(node) ||
+         TryUnrollingForBranchPenaltyReduction(node);
+}
+
+bool HLoopOptimization::TryChargeScalarCodeGrowth(const PeelUnrollHelper& helper) {
+  if (!helper.IsLoopClonable()) {
+    return false;
+  }
+  size_t number_of_instructions = helper.GetNumberOfInstructions();
+  if (number_of_instructions > kScalarHeuristicMaxBodySizeInstr ||
+      number_of_instructions > scalar_code_budget_) {
+    return false;
+  }
+  scalar_code_budget_ -= number_of_instructions;
+  return true;
+}
+
+bool HLoopOptimization::TryPeelingForLoopInvariantExitsElimination(LoopNode* node) {
+  HLoopInformation* loop_info = node->loop_info;
+  if (!HasLoopInvariantExit(loop_info)) {
+    return false;
+  }
+  PeelUnrollHelper helper(loop_info);
+  if (!TryChargeScalarCodeGrowth(helper)) {
+    return false;
+  }
+  helper.DoPeeling();
+  // The loop invariant exit conditions are evaluated in the peeled iteration, so their value
+  // is statically known in the loop. The checks become constant and the now unreachable exits
+  // are removed by dead code elimination.
+  for (auto entry : *helper.GetInstructionMap()) {
+    HInstruction* copy = entry.second;
+    if (copy->IsIf()) {
+      TryToEvaluateIfCondition(copy->AsIf(), graph_);
+    }
+  }
+  MaybeRecordStat(stats_, MethodCompilationStat::kLoopPeeled);
+  return true;
+}
+
+bool HLoopOptimization::TryUnrollingForBranchPenaltyReduction(LoopNode* node) {
+  HLoopInformation* loop_info = node->loop_info;
+  // Only unroll loops with a known even trip count: then the exit check in the copy of the
+  // header never succeeds and can be removed.
+  // TODO: Unroll loops with unknown trip count.
+  int64_t trip_count = 0;
+  if (!induction_range_.IsFinite(loop_info, &trip_count) ||
+      trip_count < 2 ||
+      (trip_count % 2) != 0 ||
+      !IsHeaderTheOnlyExit(loop_info)) {
+    return false;
+  }
+  PeelUnrollHelper helper(loop_info);
+  if (!TryChargeScalarCodeGrowth(helper)) {
+    return false;
+  }
+  HBasicBlock* header = helper.DoUnrolling();
+  // Remove the redundant exit check of the copy of the header.
+  HIf* copy_hif = helper.GetBasicBlockMap()->Get(header)->GetLastInstruction()->AsIf();
+  int32_t constant = loop_info->Contains(*copy_hif->IfTrueSuccessor()) ? 1 : 0;
+  copy_hif->ReplaceInput(graph_->GetIntConstant(constant), 0u);
+  MaybeRecordStat(stats_, MethodCompilationStat::kLoopUnrolled);
+  return true;
+}
+
 //
 // Loop vectorization. The implementation is based on the book by Aart J.C. Bik:
 // "The Software Vectorization Handbook. Applying Multimedia Extensions for Maximum Performance."
@@ -903,6 +1340,7 @@ void HLoopOptimization::Vectorize(LoopNode* node,
   // i = 0;
   HInstruction* stc = induction_range_.GenerateTripCount(node->loop_info, graph_, preheader);
   HInstruction* vtc = stc;
+  HInstruction* rem = nullptr;
   if (needs_cleanup) {
     DCHECK(IsPowerOfTwo(chunk));
     HInstruction* diff = stc;
@@ -913,7 +1351,7 @@ void HLoopOptimization::Vectorize(LoopNode* node,
       }
       diff = Insert(preheader, new (global_allocator_) HSub(induc_type, stc, ptc));
     }
-    HInstruction* rem = Insert(
+    rem = Insert(
         preheader, new (global_allocator_) HAnd(induc_type,
                                                 diff,
                                                 graph_->GetConstant(induc_type, chunk - 1)));
@@ -964,6 +1402,58 @@ void HLoopOptimization::Vectorize(LoopNode* node,
                   unroll);
   HLoopInformation* vloop = vector_header_->GetLoopInformation();
 
+  // Generate overlapping vector epilogue, if possible, which does the remainder
+  // iterations with vector operations whose last one ends exactly at the trip
+  // count, thus redoing up to vl - 1 iterations of the vector loop. It is only
+  // taken when the vector loop ran (always for a known trip count) and when the
+  // runtime test, if needed, succeeds; otherwise the scalar cleanup loop runs:
+  // elo = stc - ((rem + vl - 1) & -vl);
+  // elo = vtc != 0 && a != b ? elo : vtc;
+  // ehi = vtc != 0 && a != b ? stc : vtc;
+  // for (i = elo; i < ehi; i += vl)
+  //    <vectorized-loop-body>
+  HInstruction* epilogue_test_a = nullptr;
+  HInstruction* epilogue_test_b = nullptr;
+  if (needs_cleanup && CanUseOverlappingEpilogue(&epilogue_test_a, &epilogue_test_b)) {
+    DCHECK(ptc == nullptr);
+    DCHECK(rem != nullptr);
+    HInstruction* vl = graph_->GetConstant(induc_type, vector_length_);
+    HInstruction* round = Insert(preheader, new (global_allocator_) HAdd(
+        induc_type, rem, graph_->GetConstant(induc_type, vector_length_ - 1)));
+    round = Insert(preheader, new (global_allocator_) HAnd(
+        induc_type, round, graph_->GetConstant(induc_type, -static_cast<int64_t>(vector_length_))));
+    HInstruction* elo = Insert(preheader, new (global_allocator_) HSub(induc_type, stc, round));
+    HInstruction* ehi = stc;
+    HInstruction* guards[] = { nullptr, nullptr };
+    if (trip_count == 0) {
+      guards[0] = Insert(
+          preheader, new (global_allocator_) HNotEqual(vtc, graph_->GetConstant(induc_type, 0)));
+    }
+    if (epilogue_test_a != nullptr) {
+      guards[1] = Insert(
+          preheader, new (global_allocator_) HNotEqual(epilogue_test_a, epilogue_test_b));
+    }
+    for (HInstruction* guard : guards) {
+      if (guard != nullptr) {
+        elo = Insert(preheader, new (global_allocator_) HSelect(guard, elo, vtc, kNoDexPc));
+        ehi = Insert(preheader, new (global_allocator_) HSelect(guard, ehi, vtc, kNoDexPc));
+      }
+    }
+    vector_mode_ = kVector;
+    vector_overlapping_epilogue_ = true;
+    GenerateNewLoop(node,
+                    block,
+                    graph_->TransformLoopForVectorization(vector_header_, vector_body_, exit),
+                    elo,
+                    ehi,
+                    vl,
+                    kNoUnrollingFactor);
+    vector_overlapping_epilogue_ = false;
+    // The scalar cleanup loop is only needed when the epilogue may be skipped.
+    needs_cleanup = guards[0] != nullptr || guards[1] != nullptr;
+    MaybeRecordStat(stats_, MethodCompilationStat::kLoopVectorizedWithEpilogue);
+  }
+
   // Generate cleanup loop, if needed:
   // for ( ; i < stc; i += 1)
   //    <loop-body>
@@ -1297,6 +1787,62 @@ bool HLoopOptimization::VectorizeUse(LoopNode* node,
         return true;
       }
     }
+  } else if (instruction->IsSelect()) {
+    // Deal with vector restrictions.
+    if (HasVectorRestrictions(restrictions, kNoSelect) || !DataType::IsIntegralType(type)) {
+      return false;
+    }
+    // Accept an if-converted SELECT(a CMP b, x, y) on a comparison of integral operands
+    // that is used by this select only, for vectorizable operands a, b, x, y.
+    HSelect* select = instruction->AsSelect();
+    HInstruction* condition = select->GetCondition();
+    if (!condition->IsCondition() ||
+        node->loop_info->IsDefinedOutOfTheLoop(condition) ||
+        !condition->HasOnlyOneNonEnvironmentUse()) {
+      return false;
+    }
+    HInstruction* opa = condition->InputAt(0);
+    HInstruction* opb = condition->InputAt(1);
+    if (!DataType::IsIntegralType(opa->GetType()) || !DataType::IsIntegralType(opb->GetType())) {
+      return false;
+    }
+    // The comparison must see the exact values, so operands that are wider than
+    // the packed type must be same-extension narrower operands. Comparing zero
+    // extended operands requires an unsigned comparison.
+    HInstruction* r = opa;
+    HInstruction* s = opb;
+    bool is_unsigned = false;
+    if (DataType::Size(DataType::Kind(opa->GetType())) > DataType::Size(type) &&
+        !IsNarrowerOperands(opa, opb, type, &r, &s, &is_unsigned)) {
+      return false;
+    }
+    IfCondition cond = condition->AsCondition()->GetCondition();
+    if (is_unsigned) {
+      switch (cond) {
+        case kCondLT: cond = kCondB; break;
+        case kCondLE: cond = kCondBE; break;
+        case kCondGT: cond = kCondA; break;
+        case kCondGE: cond = kCondAE; break;
+        default: break;
+      }
+    }
+    DCHECK(r != nullptr);
+    DCHECK(s != nullptr);
+    if (generate_code && vector_mode_ != kVector) {  // de-idiom
+      r = opa;
+      s = opb;
+    }
+    if (VectorizeUse(node, r, generate_code, type, restrictions) &&
+        VectorizeUse(node, s, generate_code, type, restrictions) &&
+        VectorizeUse(node, select->GetTrueValue(), generate_code, type, restrictions) &&
+        VectorizeUse(node, select->GetFalseValue(), generate_code, type, restrictions)) {
+      if (generate_code) {
+        GenerateVecSelect(
+            instruction, vector_map_->Get(r), vector_map_->Get(s), cond, type, is_unsigned);
+      }
+      return true;
+    }
+    return false;
   } else if (instruction->IsInvokeStaticOrDirect()) {
     // Accept particular intrinsics.
     HInvokeStaticOrDirect* invoke = instruction->AsInvokeStaticOrDirect();
@@ -1396,14 +1942,14 @@ bool HLoopOptimization::TrySetVectorType(DataType::Type type, uint64_t* restrict
         case DataType::Type::kBool:
         case DataType::Type::kUint8:
         case DataType::Type::kInt8:
-          *restrictions |= kNoDiv | kNoReduction;
+          *restrictions |= kNoDiv | kNoReduction | kNoSelect;
           return TrySetVectorLength(8);
         case DataType::Type::kUint16:
         case DataType::Type::kInt16:
-          *restrictions |= kNoDiv | kNoStringCharAt | kNoReduction;
+          *restrictions |= kNoDiv | kNoStringCharAt | kNoReduction | kNoSelect;
           return TrySetVectorLength(4);
         case DataType::Type::kInt32:
-          *restrictions |= kNoDiv | kNoWideSAD;
+          *restrictions |= kNoDiv | kNoWideSAD | kNoSelect;
           return TrySetVectorLength(2);
         default:
           break;
@@ -1456,7 +2002,8 @@ bool HLoopOptimization::TrySetVectorType(DataType::Type type, uint64_t* restrict
             *restrictions |= kNoDiv | kNoSAD;
             return TrySetVectorLength(4);
           case DataType::Type::kInt64:
-            *restrictions |= kNoMul | kNoDiv | kNoShr | kNoAbs | kNoMinMax | kNoSAD;
+            // select: no pcmpgtq before SSE4.2
+            *restrictions |= kNoMul | kNoDiv | kNoShr | kNoAbs | kNoMinMax | kNoSAD | kNoSelect;
             return TrySetVectorLength(2);
           case DataType::Type::kFloat32:
             *restrictions |= kNoMinMax | kNoReduction;  // minmax: -0.0 vs +0.0
@@ -1475,17 +2022,17 @@ bool HLoopOptimization::TrySetVectorType(DataType::Type type, uint64_t* restrict
           case DataType::Type::kBool:
           case DataType::Type::kUint8:
           case DataType::Type::kInt8:
-            *restrictions |= kNoDiv;
+            *restrictions |= kNoDiv | kNoSelect;
             return TrySetVectorLength(16);
           case DataType::Type::kUint16:
           case DataType::Type::kInt16:
-            *restrictions |= kNoDiv | kNoStringCharAt;
+            *restrictions |= kNoDiv | kNoStringCharAt | kNoSelect;
             return TrySetVectorLength(8);
           case DataType::Type::kInt32:
-            *restrictions |= kNoDiv;
+            *restrictions |= kNoDiv | kNoSelect;
             return TrySetVectorLength(4);
           case DataType::Type::kInt64:
-            *restrictions |= kNoDiv;
+            *restrictions |= kNoDiv | kNoSelect;
             return TrySetVectorLength(2);
           case DataType::Type::kFloat32:
             *restrictions |= kNoMinMax | kNoReduction;  // min/max(x, NaN)
@@ -1504,17 +2051,17 @@ bool HLoopOptimization::TrySetVectorType(DataType::Type type, uint64_t* restrict
           case DataType::Type::kBool:
           case DataType::Type::kUint8:
           case DataType::Type::kInt8:
-            *restrictions |= kNoDiv;
+            *restrictions |= kNoDiv | kNoSelect;
             return TrySetVectorLength(16);
           case DataType::Type::kUint16:
           case DataType::Type::kInt16:
-            *restrictions |= kNoDiv | kNoStringCharAt;
+            *restrictions |= kNoDiv | kNoStringCharAt | kNoSelect;
             return TrySetVectorLength(8);
           case DataType::Type::kInt32:
-            *restrictions |= kNoDiv;
+            *restrictions |= kNoDiv | kNoSelect;
             return TrySetVectorLength(4);
           case DataType::Type::kInt64:
-            *restrictions |= kNoDiv;
+            *restrictions |= kNoDiv | kNoSelect;
             return TrySetVectorLength(2);
           case DataType::Type::kFloat32:
             *restrictions |= kNoMinMax | kNoReduction;  // min/max(x, NaN)
@@ -1613,8 +2160,12 @@ void HLoopOptimization::GenerateVecMem(HInstruction* org,
                                                 is_string_char_at,
                                                 dex_pc);
     }
-    // Known (forced/adjusted/original) alignment?
-    if (vector_dynamic_peeling_candidate_ != nullptr) {
+    // Known (forced/adjusted/original) alignment? The overlapping epilogue starts at
+    // an arbitrary index, so it keeps the natural alignment set at construction.
+    if (vector_overlapping_epilogue_) {
+      DCHECK(vector_dynamic_peeling_candidate_ == nullptr);
+      DCHECK_EQ(vector_static_peeling_factor_, 0u);
+    } else if (vector_dynamic_peeling_candidate_ != nullptr) {
       if (vector_dynamic_peeling_candidate_->offset == offset &&  // TODO: diffs too?
           DataType::Size(vector_dynamic_peeling_candidate_->type) == DataType::Size(type) &&
           vector_dynamic_peeling_candidate_->is_string_char_at == is_string_char_at) {
@@ -1895,6 +2446,42 @@ void HLoopOptimization::GenerateVecOp(HInstruction* org,
   vector_map_->Put(org, vector);
 }
 
+void HLoopOptimization::GenerateVecSelect(HInstruction* org,
+                                          HInstruction* opa,
+                                          HInstruction* opb,
+                                          IfCondition condition,
+                                          DataType::Type type,
+                                          bool is_unsigned) {
+  uint32_t dex_pc = org->GetDexPc();
+  HSelect* select = org->AsSelect();
+  HInstruction* org_condition = select->GetCondition();
+  HInstruction* true_value = vector_map_->Get(select->GetTrueValue());
+  HInstruction* false_value = vector_map_->Get(select->GetFalseValue());
+  HInstruction* mask = nullptr;
+  HInstruction* vector = nullptr;
+  if (vector_mode_ == kVector) {
+    mask = new (global_allocator_) HVecCondition(global_allocator_,
+                                                 opa,
+                                                 opb,
+                                                 condition,
+                                                 HVecOperation::ToProperType(type, is_unsigned),
+                                                 vector_length_,
+                                                 dex_pc);
+    vector = new (global_allocator_) HVecSelect(
+        global_allocator_, mask, true_value, false_value, type, vector_length_, dex_pc);
+  } else {
+    // In scalar code, clone the comparison on the new operands.
+    DCHECK(vector_mode_ == kSequential);
+    mask = org_condition->Clone(global_allocator_);
+    mask->SetRawInputAt(0, opa);
+    mask->SetRawInputAt(1, opb);
+    vector = new (global_allocator_) HSelect(mask, true_value, false_value, dex_pc);
+  }
+  // Both are inserted into the new loop-body in original program order.
+  vector_map_->Put(org_condition, mask);
+  vector_map_->Put(org, vector);
+}
+
 #undef GENERATE_VEC
 
 //
@@ -2118,6 +2705,44 @@ uint32_t HLoopOptimization::MaxNumberPeeled() {
   return vector_static_peeling_factor_;  // known exactly
 }
 
+bool HLoopOptimization::CanUseOverlappingEpilogue(/*out*/ HInstruction** test_a,
+                                                  /*out*/ HInstruction** test_b) {
+  *test_a = nullptr;
+  *test_b = nullptr;
+  // Redoing iterations must not change any result, which rules out reductions,
+  // as well as alignment peeling, which relies on the vector loop starting at
+  // the peeled index.
+  if (!reductions_->empty() || MaxNumberPeeled() != 0) {
+    return false;
+  }
+  // A redone iteration reads its operands again, which must not have been changed
+  // by the vector loop, so no written array can be read. Differently typed arrays
+  // cannot be aliased, and two same-typed references to different arrays are
+  // accepted only under a single a != b runtime test, since they may still be
+  // the same array at runtime.
+  for (const ArrayReference& def : *vector_refs_) {
+    if (!def.lhs) {
+      continue;
+    }
+    for (const ArrayReference& use : *vector_refs_) {
+      if (use.lhs ||
+          HVecOperation::ToSignedType(use.type) != HVecOperation::ToSignedType(def.type)) {
+        continue;
+      }
+      if (use.base == def.base) {
+        return false;  // a[i] = .. a[i] ..
+      } else if (*test_a == nullptr) {
+        *test_a = def.base;
+        *test_b = use.base;
+      } else if ((*test_a != def.base || *test_b != use.base) &&
+                 (*test_a != use.base || *test_b != def.base)) {
+        return false;  // second test would be needed
+      }
+    }
+  }
+  return true;
+}
+
 bool HLoopOptimization::IsVectorizationProfitable(int64_t trip_count) {
   // Current heuristic: non-empty body with sufficient number of iterations (if known).
   // TODO: refine by looking at e.g. operation count, alignment, etc.
@@ -26,6 +26,7 @@
 namespace art {
 
 class CompilerDriver;
+class PeelUnrollHelper;
 
 /**
  * Loop optimizations. Builds a loop hierarchy and applies optimizations to
@@ -80,6 +81,7 @@ class HLoopOptimization : public HOptimization {
     kNoReduction     = 1 << 10,  // no reduction
     kNoSAD           = 1 << 11,  // no sum of absolute differences (SAD)
     kNoWideSAD       = 1 << 12,  // no sum of absolute differences (SAD) with operand widening
+    kNoSelect        = 1 << 13,  // no if-converted select (vector condition and select)
   };
 
   /*
@@ -135,9 +137,40 @@ class HLoopOptimization : public HOptimization {
   void SimplifyBlocks(LoopNode* node);
 
   // Performs optimizations specific to inner loop (empty loop removal,
-  // unrolling, vectorization). Returns true if anything changed.
+  // unrolling, vectorization, scalar peeling). Returns true if anything changed.
   bool OptimizeInnerLoop(LoopNode* node);
 
+  // Makes the suspend check of an inner loop a no-op if all its iterations execute a small number
+  // of instructions, without calls or allocations.
+  void TryRemovingSuspendCheck(LoopNode* node);
+
+  // Performs optimizations specific to inner loop with finite header logic (empty loop removal,
+  // unrolling, vectorization). Returns true if anything changed.
+  bool TryOptimizeInnerLoopFinite(LoopNode* node);
+
+  // Performs early-exit vectorization of an inner search loop with finite header logic,
+  // whose body only tests the condition of a second exit. Returns true on success.
+  bool TryVectorizeSearchLoop(LoopNode* node);
+
+  //
+  // Scalar loop peeling and unrolling.
+  //
+
+  // Tries to peel or unroll a loop which has not been vectorized. Returns true on success.
+  bool TryPeelingAndUnrolling(LoopNode* node);
+
+  // Returns whether the loop of the helper can be cloned within the code size limits and,
+  // if so, takes its size out of the budget.
+  bool TryChargeScalarCodeGrowth(const PeelUnrollHelper& helper);
+
+  // Peels the first iteration of a loop which has exits controlled by loop invariant
+  // conditions; these checks are then statically evaluated in the loop.
+  bool TryPeelingForLoopInvariantExitsElimination(LoopNode* node);
+
+  // Unrolls by a factor of 2 a loop with a known even trip count, removing every second
+  // exit check.
+  bool TryUnrollingForBranchPenaltyReduction(LoopNode* node);
+
   //
   // Vectorization analysis and synthesis.
   //
@@ -175,6 +208,12 @@ class HLoopOptimization : public HOptimization {
                      HInstruction* opb,
                      DataType::Type type,
                      bool is_unsigned = false);
+  void GenerateVecSelect(HInstruction* org,
+                         HInstruction* opa,
+                         HInstruction* opb,
+                         IfCondition condition,
+                         DataType::Type type,
+                         bool is_unsigned);
 
   // Vectorization idioms.
   bool VectorizeHalvingAddIdiom(LoopNode* node,
@@ -198,6 +237,10 @@ class HLoopOptimization : public HOptimization {
   uint32_t MaxNumberPeeled();
   bool IsVectorizationProfitable(int64_t trip_count);
   uint32_t GetUnrollingFactor(HBasicBlock* block, int64_t trip_count);
+  // Returns true if the remainder iterations of the vector loop may instead be done by an
+  // overlapping vector epilogue, which re-executes some iterations of the vector loop. If
+  // that is only correct for distinct arrays, the bases to test are returned in test_a/b.
+  bool CanUseOverlappingEpilogue(/*out*/ HInstruction** test_a, /*out*/ HInstruction** test_b);
 
   //
   // Helpers.
@@ -259,6 +302,9 @@ class HLoopOptimization : public HOptimization {
   // Flag that tracks if any simplifications have occurred.
   bool simplified_;
 
+  // Number of instructions that scalar loop peeling and unrolling may still add to the graph.
+  uint32_t scalar_code_budget_;
+
   // Number of "lanes" for selected packed type.
   uint32_t vector_length_;
 
@@ -290,6 +336,7 @@ class HLoopOptimization : public HOptimization {
   HBasicBlock* vector_header_;  // header of the new loop
   HBasicBlock* vector_body_;  // body of the new loop
   HInstruction* vector_index_;  // normalized index of the new loop
+  bool vector_overlapping_epilogue_;  // generating the overlapping epilogue
 
   friend class LoopOptimizationTest;
 
@@ -1121,6 +1121,21 @@ void HEnvironment::RemoveAsUserOfInput(size_t index) const {
   user->FixUpUserRecordsAfterEnvUseRemoval(before_env_use_node);
 }
 
+void HEnvironment::ReplaceInput(HInstruction* replacement, size_t index) {
+  const HUserRecord<HEnvironment*>& env_use = vregs_[index];
+  HInstruction* orig_instr = env_use.GetInstruction();
+  DCHECK(orig_instr != replacement);
+  HUseList<HEnvironment*>::iterator before_use_node = env_use.GetBeforeUseNode();
+  // Note: fixup_end remains valid across splice_after().
+  auto fixup_end = replacement->env_uses_.empty() ? replacement->env_uses_.begin()
+                                                  : ++replacement->env_uses_.begin();
+  replacement->env_uses_.splice_after(replacement->env_uses_.before_begin(),
+                                      env_use.GetInstruction()->env_uses_,
+                                      before_use_node);
+  replacement->FixUpUserRecordsAfterEnvUseInsertion(fixup_end);
+  orig_instr->FixUpUserRecordsAfterEnvUseRemoval(before_use_node);
+}
+
 HInstruction* HInstruction::GetNextDisregardingMoves() const {
   HInstruction* next = GetNext();
   while (next != nullptr && next->IsParallelMove()) {
@@ -2410,6 +2425,9 @@ HInstruction* HGraph::InlineInto(HGraph* outer_graph, HInvoke* invoke) {
   if (HasSIMD()) {
     outer_graph->SetHasSIMD(true);
   }
+  for (ArtField* field : GetFinalFieldDependencies()) {
+    outer_graph->AddFinalFieldDependency(field);
+  }
 
   HInstruction* return_value = nullptr;
   if (GetBlocks().size() == 3) {
@@ -2738,6 +2756,100 @@ HBasicBlock* HGraph::TransformLoopForVectorization(HBasicBlock* header,
   return new_pre_header;
 }
 
+HBasicBlock* HGraph::TransformLoopForEarlyExitVectorization(HBasicBlock* header) {
+  DCHECK(header->IsLoopHeader());
+  HLoopInformation* loop = header->GetLoopInformation();
+  HBasicBlock* old_pre_header = loop->GetPreHeader();
+
+  // Add new blocks. The exits of the new loop need extra blocks to avoid critical edges.
+  HBasicBlock* new_pre_header = new (allocator_) HBasicBlock(this, header->GetDexPc());
+  HBasicBlock* new_header = new (allocator_) HBasicBlock(this, header->GetDexPc());
+  HBasicBlock* new_body = new (allocator_) HBasicBlock(this, header->GetDexPc());
+  HBasicBlock* new_latch = new (allocator_) HBasicBlock(this, header->GetDexPc());
+  HBasicBlock* header_exit = new (allocator_) HBasicBlock(this, header->GetDexPc());
+  HBasicBlock* body_exit = new (allocator_) HBasicBlock(this, header->GetDexPc());
+  HBasicBlock* scalar_pre_header = new (allocator_) HBasicBlock(this, header->GetDexPc());
+  AddBlock(new_pre_header);
+  AddBlock(new_header);
+  AddBlock(new_body);
+  AddBlock(new_latch);
+  AddBlock(header_exit);
+  AddBlock(body_exit);
+  AddBlock(scalar_pre_header);
+
+  // Set up control flow.
+  header->ReplacePredecessor(old_pre_header, scalar_pre_header);
+  old_pre_header->AddSuccessor(new_pre_header);
+  new_pre_header->AddSuccessor(new_header);
+  new_header->AddSuccessor(header_exit);  // True successor
+  new_header->AddSuccessor(new_body);  // False successor
+  new_body->AddSuccessor(body_exit);  // True successor
+  new_body->AddSuccessor(new_latch);  // False successor
+  new_latch->AddSuccessor(new_header);
+  header_exit->AddSuccessor(scalar_pre_header);
+  body_exit->AddSuccessor(scalar_pre_header);
+
+  // Set up dominators.
+  old_pre_header->ReplaceDominatedBlock(header, new_pre_header);
+  new_pre_header->SetDominator(old_pre_header);
+  new_pre_header->dominated_blocks_.push_back(new_header);
+  new_header->SetDominator(new_pre_header);
+  new_header->dominated_blocks_.push_back(new_body);
+  new_body->SetDominator(new_header);
+  new_header->dominated_blocks_.push_back(header_exit);
+  header_exit->SetDominator(new_header);
+  new_header->dominated_blocks_.push_back(scalar_pre_header);
+  scalar_pre_header->SetDominator(new_header);
+  new_body->dominated_blocks_.push_back(body_exit);
+  body_exit->SetDominator(new_body);
+  new_body->dominated_blocks_.push_back(new_latch);
+  new_latch->SetDominator(new_body);
+  scalar_pre_header->dominated_blocks_.push_back(header);
+  header->SetDominator(scalar_pre_header);
+
+  // Fix reverse post order.
+  size_t index_of_header = IndexOfElement(reverse_post_order_, header);
+  MakeRoomFor(&reverse_post_order_, 7, index_of_header - 1);
+  reverse_post_order_[index_of_header++] = new_pre_header;
+  reverse_post_order_[index_of_header++] = new_header;
+  reverse_post_order_[index_of_header++] = new_body;
+  reverse_post_order_[index_of_header++] = new_latch;
+  reverse_post_order_[index_of_header++] = body_exit;
+  reverse_post_order_[index_of_header++] = header_exit;
+  reverse_post_order_[index_of_header++] = scalar_pre_header;
+
+  // Add gotos and suspend check (client must add conditionals in header and body).
+  new_pre_header->AddInstruction(new (allocator_) HGoto());
+  HSuspendCheck* suspend_check = new (allocator_) HSuspendCheck(header->GetDexPc());
+  new_header->AddInstruction(suspend_check);
+  new_latch->AddInstruction(new (allocator_) HGoto());
+  header_exit->AddInstruction(new (allocator_) HGoto());
+  body_exit->AddInstruction(new (allocator_) HGoto());
+  scalar_pre_header->AddInstruction(new (allocator_) HGoto());
+  suspend_check->CopyEnvironmentFromWithLoopPhiAdjustment(
+      loop->GetSuspendCheck()->GetEnvironment(), header);
+
+  // Update loop information.
+  UpdateLoopAndTryInformationOfNewBlock(
+      new_pre_header, old_pre_header, /* replace_if_back_edge */ false);
+  UpdateLoopAndTryInformationOfNewBlock(
+      header_exit, old_pre_header, /* replace_if_back_edge */ false);
+  UpdateLoopAndTryInformationOfNewBlock(
+      body_exit, old_pre_header, /* replace_if_back_edge */ false);
+  UpdateLoopAndTryInformationOfNewBlock(
+      scalar_pre_header, old_pre_header, /* replace_if_back_edge */ false);
+  new_header->AddBackEdge(new_latch);
+  new_header->GetLoopInformation()->SetSuspendCheck(suspend_check);
+  new_header->GetLoopInformation()->Populate();
+  HLoopInformationOutwardIterator it(*new_header);
+  for (it.Advance(); !it.Done(); it.Advance()) {
+    it.Current()->Add(new_header);
+    it.Current()->Add(new_body);
+    it.Current()->Add(new_latch);
+  }
+  return new_pre_header;
+}
+
 static void CheckAgainstUpperBound(ReferenceTypeInfo rti, ReferenceTypeInfo upper_bound_rti)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   if (rti.IsValid()) {
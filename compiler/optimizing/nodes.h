@@ -315,6 +315,7 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
          InvokeType invoke_type = kInvalidInvokeType,
          bool debuggable = false,
          bool osr = false,
+         bool baseline = false,
          int start_instruction_id = 0)
       : allocator_(allocator),
         arena_stack_(arena_stack),
@@ -349,7 +350,11 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
         art_method_(nullptr),
         inexact_object_rti_(ReferenceTypeInfo::CreateInvalid()),
         osr_(osr),
-        cha_single_implementation_list_(allocator->Adapter(kArenaAllocCHA)) {
+        baseline_(baseline),
+        disabled_speculations_(0u),
+        cha_single_implementation_list_(allocator->Adapter(kArenaAllocCHA)),
+        final_field_dependencies_(allocator->Adapter(kArenaAllocCHA)),
+        inlined_methods_(allocator->Adapter(kArenaAllocCHA)) {
     blocks_.reserve(kDefaultNumberOfBlocks);
   }
 
@@ -412,6 +417,11 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
                                              HBasicBlock* body,
                                              HBasicBlock* exit);
 
+  // Adds a new loop with an exit in its header and an exit in its body directly
+  // before the loop with the given header. Both exits meet in the new preheader
+  // of the given loop. Returns the preheader of the new loop.
+  HBasicBlock* TransformLoopForEarlyExitVectorization(HBasicBlock* header);
+
   // Removes `block` from the graph. Assumes `block` has been disconnected from
   // other blocks and has no instructions or phis.
   void DeleteDeadEmptyBlock(HBasicBlock* block);
@@ -573,6 +583,17 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
 
   bool IsCompilingOsr() const { return osr_; }
 
+  bool IsCompilingBaseline() const { return baseline_; }
+
+  uint32_t GetDisabledSpeculations() const { return disabled_speculations_; }
+
+  void SetDisabledSpeculations(uint32_t mask) { disabled_speculations_ = mask; }
+
+  // Whether the compiled code should not speculate in a way that may deoptimize with `kind`.
+  bool IsSpeculationDisabled(DeoptimizationKind kind) const {
+    return (disabled_speculations_ & (1u << static_cast<uint32_t>(kind))) != 0u;
+  }
+
   ArenaSet<ArtMethod*>& GetCHASingleImplementationList() {
     return cha_single_implementation_list_;
   }
@@ -581,6 +602,22 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
     cha_single_implementation_list_.insert(method);
   }
 
+  const ArenaSet<ArtField*>& GetFinalFieldDependencies() const {
+    return final_field_dependencies_;
+  }
+
+  void AddFinalFieldDependency(ArtField* field) {
+    final_field_dependencies_.insert(field);
+  }
+
+  const ArenaSet<ArtMethod*>& GetInlinedMethods() const {
+    return inlined_methods_;
+  }
+
+  void AddInlinedMethod(ArtMethod* method) {
+    inlined_methods_.insert(method);
+  }
+
   bool HasShouldDeoptimizeFlag() const {
     return number_of_cha_guards_ != 0;
   }
@@ -751,9 +788,25 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
   // compiled code entries which the interpreter can directly jump to.
   const bool osr_;
 
+  // Whether we are compiling baseline code for the JIT: only the passes needed for
+  // correctness are run and the code counts its hotness so that it can be recompiled
+  // with all optimizations once it gets hot.
+  const bool baseline_;
+
+  // Bit mask, indexed by DeoptimizationKind, of the speculations that deoptimized the
+  // previously JIT compiled code of the outermost method too often to be emitted again.
+  uint32_t disabled_speculations_;
+
   // List of methods that are assumed to have single implementation.
   ArenaSet<ArtMethod*> cha_single_implementation_list_;
 
+  // Static final fields whose value has been folded into the code by the JIT.
+  ArenaSet<ArtField*> final_field_dependencies_;
+
+  // Methods inlined into the code, at any depth, so that the JIT code cache can tell which
+  // code to drop when one of them gets deoptimized.
+  ArenaSet<ArtMethod*> inlined_methods_;
+
   friend class SsaBuilder;           // For caching constants.
   friend class SsaLivenessAnalysis;  // For the linear order.
   friend class HInliner;             // For the reverse post order.
@@ -1440,6 +1493,9 @@ class HLoopInformationOutwardIterator : public ValueObject {
   M(VecShl, VecBinaryOperation)                                         \
   M(VecShr, VecBinaryOperation)                                         \
   M(VecUShr, VecBinaryOperation)                                        \
+  M(VecCondition, VecBinaryOperation)                                   \
+  M(VecSelect, VecOperation)                                            \
+  M(VecAnyTrue, VecUnaryOperation)                                      \
   M(VecSetScalars, VecOperation)                                        \
   M(VecMultiplyAccumulate, VecOperation)                                \
   M(VecSADAccumulate, VecOperation)                                     \
@@ -1906,6 +1962,11 @@ class HEnvironment : public ArenaObject<kArenaAllocEnvironment> {
 
   void RemoveAsUserOfInput(size_t index) const;
 
+  // Replaces the input at the position 'index' with the replacement; the replacement and old
+  // input instructions' env_uses_ lists are adjusted. The function works similar to
+  // HInstruction::ReplaceInput.
+  void ReplaceInput(HInstruction* replacement, size_t index);
+
   size_t Size() const { return vregs_.size(); }
 
   HEnvironment* GetParent() const { return parent_; }
@@ -4541,7 +4602,9 @@ class HInvokeStaticOrDirect FINAL : public HInvoke {
   }
 
   bool CanBeNull() const OVERRIDE {
-    return GetPackedField<ReturnTypeField>() == DataType::Type::kReference && !IsStringInit();
+    return GetPackedField<ReturnTypeField>() == DataType::Type::kReference &&
+        !IsStringInit() &&
+        GetIntrinsic() != Intrinsics::kIntegerValueOf;
   }
 
   // Get the index of the special input, if any.
@@ -5967,6 +6030,7 @@ class HSuspendCheck FINAL : public HTemplateInstruction<0> {
   explicit HSuspendCheck(uint32_t dex_pc = kNoDexPc)
       : HTemplateInstruction(kSuspendCheck, SideEffects::CanTriggerGC(), dex_pc),
         slow_path_(nullptr) {
+    SetPackedFlag<kFlagIsNoOp>(false);
   }
 
   bool IsClonable() const OVERRIDE { return true; }
@@ -5978,12 +6042,22 @@ class HSuspendCheck FINAL : public HTemplateInstruction<0> {
   void SetSlowPath(SlowPathCode* slow_path) { slow_path_ = slow_path; }
   SlowPathCode* GetSlowPath() const { return slow_path_; }
 
+  // A loop suspend check that is a no-op generates no code on the back edges. It is kept in the
+  // loop header to provide the loop's environment, e.g. for deoptimization.
+  void SetIsNoOp(bool is_no_op) { SetPackedFlag<kFlagIsNoOp>(is_no_op); }
+  bool IsNoOp() const { return GetPackedFlag<kFlagIsNoOp>(); }
+
   DECLARE_INSTRUCTION(SuspendCheck);
 
  protected:
   DEFAULT_COPY_CONSTRUCTOR(SuspendCheck);
 
  private:
+  static constexpr size_t kFlagIsNoOp = kNumberOfGenericPackedBits;
+  static constexpr size_t kNumberOfSuspendCheckPackedBits = kFlagIsNoOp + 1;
+  static_assert(kNumberOfSuspendCheckPackedBits <= kMaxNumberOfPackedBits,
+                "Too many packed fields.");
+
   // Only used for code generation, in order to share the same slow path between back edges
   // of a same loop.
   SlowPathCode* slow_path_;
@@ -169,7 +169,8 @@ class HVecOperation : public HVariableInputSizeInstruction {
   // TODO: This method is needed until we introduce SIMD as proper type.
   static bool ReturnsSIMDValue(HInstruction* instruction) {
     if (instruction->IsVecOperation()) {
-      return !instruction->IsVecExtractScalar();  // only scalar returning vec op
+      // Only scalar returning vec ops.
+      return !instruction->IsVecExtractScalar() && !instruction->IsVecAnyTrue();
     } else if (instruction->IsPhi()) {
       // Vectorizer only uses Phis in reductions, so checking for a 2-way phi
       // with a direct vector operand as second argument suffices.
@@ -847,6 +848,52 @@ class HVecUShr FINAL : public HVecBinaryOperation {
   DEFAULT_COPY_CONSTRUCTOR(VecUShr);
 };
 
+// Compares every component in the two vectors, yielding a mask with all bits set in
+// the components where the condition holds and all bits cleared in the others,
+// viz. [ x1, .. , xn ] < [ y1, .. , yn ] = [ x1 < y1 ? -1 : 0, .. , xn < yn ? -1 : 0 ].
+// Unsigned comparisons are expressed by the condition (kCondB etc.).
+class HVecCondition FINAL : public HVecBinaryOperation {
+ public:
+  HVecCondition(ArenaAllocator* allocator,
+                HInstruction* left,
+                HInstruction* right,
+                IfCondition condition,
+                DataType::Type packed_type,
+                size_t vector_length,
+                uint32_t dex_pc)
+      : HVecBinaryOperation(
+            kVecCondition, allocator, left, right, packed_type, vector_length, dex_pc) {
+    DCHECK(HasConsistentPackedTypes(left, packed_type));
+    DCHECK(HasConsistentPackedTypes(right, packed_type));
+    DCHECK(DataType::IsIntegralType(packed_type)) << packed_type;
+    SetPackedField<ConditionField>(condition);
+  }
+
+  IfCondition GetCondition() const { return GetPackedField<ConditionField>(); }
+
+  bool CanBeMoved() const OVERRIDE { return true; }
+
+  bool InstructionDataEquals(const HInstruction* other) const OVERRIDE {
+    DCHECK(other->IsVecCondition());
+    const HVecCondition* o = other->AsVecCondition();
+    return HVecOperation::InstructionDataEquals(o) && GetCondition() == o->GetCondition();
+  }
+
+  DECLARE_INSTRUCTION(VecCondition);
+
+ protected:
+  DEFAULT_COPY_CONSTRUCTOR(VecCondition);
+
+ private:
+  // Additional packed bits.
+  static constexpr size_t kFieldCondition = HVecOperation::kNumberOfVectorOpPackedBits;
+  static constexpr size_t kFieldConditionSize =
+      MinimumBitsToStore(static_cast<size_t>(kCondLast));
+  static constexpr size_t kNumberOfConditionPackedBits = kFieldCondition + kFieldConditionSize;
+  static_assert(kNumberOfConditionPackedBits <= kMaxNumberOfPackedBits, "Too many packed fields.");
+  using ConditionField = BitField<IfCondition, kFieldCondition, kFieldConditionSize>;
+};
+
 //
 // Definitions of concrete miscellaneous vector operations in HIR.
 //
@@ -885,6 +932,74 @@ class HVecSetScalars FINAL : public HVecOperation {
   DEFAULT_COPY_CONSTRUCTOR(VecSetScalars);
 };
 
+// Selects every component from the first or the second vector under control of a mask
+// computed by HVecCondition, viz.
+// select([ m1, .. , mn ], [ x1, .. , xn ], [ y1, .. , yn ]) = [ m1 ? x1 : y1, .. , mn ? xn : yn ].
+// This is the vector counterpart of HSelect for if-converted loop bodies.
+class HVecSelect FINAL : public HVecOperation {
+ public:
+  HVecSelect(ArenaAllocator* allocator,
+             HInstruction* mask,
+             HInstruction* true_value,
+             HInstruction* false_value,
+             DataType::Type packed_type,
+             size_t vector_length,
+             uint32_t dex_pc)
+      : HVecOperation(kVecSelect,
+                      allocator,
+                      packed_type,
+                      SideEffects::None(),
+                      /* number_of_inputs */ 3,
+                      vector_length,
+                      dex_pc) {
+    DCHECK(mask->IsVecCondition());
+    DCHECK_EQ(DataType::Size(mask->AsVecOperation()->GetPackedType()),
+              DataType::Size(packed_type));
+    DCHECK(HasConsistentPackedTypes(true_value, packed_type));
+    DCHECK(HasConsistentPackedTypes(false_value, packed_type));
+    SetRawInputAt(0, mask);
+    SetRawInputAt(1, true_value);
+    SetRawInputAt(2, false_value);
+  }
+
+  HInstruction* GetMask() const { return InputAt(0); }
+  HInstruction* GetTrueValue() const { return InputAt(1); }
+  HInstruction* GetFalseValue() const { return InputAt(2); }
+
+  bool CanBeMoved() const OVERRIDE { return true; }
+
+  DECLARE_INSTRUCTION(VecSelect);
+
+ protected:
+  DEFAULT_COPY_CONSTRUCTOR(VecSelect);
+};
+
+// Tests whether any component of a mask computed by HVecCondition is set,
+// viz. any-true[ m1, .. , mn ] = m1 || .. || mn, yielding a scalar boolean.
+// This allows leaving a vector loop early under a lane-wise condition.
+class HVecAnyTrue FINAL : public HVecUnaryOperation {
+ public:
+  HVecAnyTrue(ArenaAllocator* allocator,
+              HInstruction* mask,
+              DataType::Type packed_type,
+              size_t vector_length,
+              uint32_t dex_pc)
+      : HVecUnaryOperation(kVecAnyTrue, allocator, mask, packed_type, vector_length, dex_pc) {
+    DCHECK(mask->IsVecCondition());
+    DCHECK(HasConsistentPackedTypes(mask, packed_type));
+  }
+
+  // Yields a scalar boolean.
+  DataType::Type GetType() const OVERRIDE {
+    return DataType::Type::kBool;
+  }
+
+  DECLARE_INSTRUCTION(VecAnyTrue);
+
+ protected:
+  DEFAULT_COPY_CONSTRUCTOR(VecAnyTrue);
+};
+
 // Multiplies every component in the two vectors, adds the result vector to the accumulator vector,
 // viz. [ a1, .. , an ] + [ x1, .. , xn ] * [ y1, .. , yn ] = [ a1 + x1 * y1, .. , an + xn * yn ].
 class HVecMultiplyAccumulate FINAL : public HVecOperation {
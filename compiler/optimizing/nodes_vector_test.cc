@@ -413,4 +413,55 @@ TEST_F(NodesVectorTest, VectorKindMattersOnReduce) {
   EXPECT_FALSE(v1->Equals(v3));
 }
 
+TEST_F(NodesVectorTest, VectorConditionMattersOnCondition) {
+  HVecOperation* v0 = new (GetAllocator())
+      HVecReplicateScalar(GetAllocator(), int32_parameter_, DataType::Type::kInt32, 4, kNoDexPc);
+
+  HVecCondition* v1 = new (GetAllocator()) HVecCondition(
+      GetAllocator(), v0, v0, kCondLT, DataType::Type::kInt32, 4, kNoDexPc);
+  HVecCondition* v2 = new (GetAllocator()) HVecCondition(
+      GetAllocator(), v0, v0, kCondB, DataType::Type::kInt32, 4, kNoDexPc);
+  HVecCondition* v3 = new (GetAllocator()) HVecCondition(
+      GetAllocator(), v0, v0, kCondLT, DataType::Type::kInt32, 2, kNoDexPc);
+  HVecSelect* v4 = new (GetAllocator()) HVecSelect(
+      GetAllocator(), v1, v0, v0, DataType::Type::kInt32, 4, kNoDexPc);
+  HVecSelect* v5 = new (GetAllocator()) HVecSelect(
+      GetAllocator(), v2, v0, v0, DataType::Type::kInt32, 4, kNoDexPc);
+
+  EXPECT_TRUE(v1->CanBeMoved());
+  EXPECT_TRUE(v2->CanBeMoved());
+  EXPECT_TRUE(v3->CanBeMoved());
+  EXPECT_TRUE(v4->CanBeMoved());
+
+  EXPECT_EQ(kCondLT, v1->GetCondition());
+  EXPECT_EQ(kCondB, v2->GetCondition());
+  EXPECT_EQ(kCondLT, v3->GetCondition());
+  EXPECT_EQ(v1, v4->GetMask());
+  EXPECT_EQ(v0, v4->GetTrueValue());
+  EXPECT_EQ(v0, v4->GetFalseValue());
+
+  EXPECT_TRUE(v1->Equals(v1));
+  EXPECT_TRUE(v4->Equals(v4));
+
+  EXPECT_FALSE(v1->Equals(v2));  // different conditions
+  EXPECT_FALSE(v1->Equals(v3));  // different vector lengths
+  EXPECT_FALSE(v4->Equals(v5));  // different masks
+}
+
+TEST_F(NodesVectorTest, VectorAnyTrueYieldsScalar) {
+  HVecOperation* v0 = new (GetAllocator())
+      HVecReplicateScalar(GetAllocator(), int8_parameter_, DataType::Type::kInt8, 16, kNoDexPc);
+  HVecCondition* v1 = new (GetAllocator()) HVecCondition(
+      GetAllocator(), v0, v0, kCondEQ, DataType::Type::kInt8, 16, kNoDexPc);
+  HVecAnyTrue* v2 = new (GetAllocator()) HVecAnyTrue(
+      GetAllocator(), v1, DataType::Type::kInt8, 16, kNoDexPc);
+
+  EXPECT_EQ(DataType::Type::kBool, v2->GetType());
+  EXPECT_EQ(DataType::Type::kInt8, v2->GetPackedType());
+  EXPECT_EQ(v1, v2->GetInput());
+  EXPECT_TRUE(HVecOperation::ReturnsSIMDValue(v1));
+  EXPECT_FALSE(HVecOperation::ReturnsSIMDValue(v2));
+  EXPECT_FALSE(v2->CanBeMoved());
+}
+
 }  // namespace art
@@ -281,8 +281,11 @@ ArenaVector<HOptimization*> ConstructOptimizations(
         opt = new (allocator) ConstructorFenceRedundancyElimination(graph, stats, name);
         break;
       case OptimizationPass::kScheduling:
-        opt = new (allocator) HInstructionScheduling(
-            graph, driver->GetInstructionSet(), codegen, name);
+        opt = new (allocator) HInstructionScheduling(graph,
+                                                     driver->GetInstructionSet(),
+                                                     codegen,
+                                                     name,
+                                                     driver->GetInstructionSetFeatures());
         break;
       //
       // Arch-specific passes.
@@ -25,10 +25,13 @@
 #include "art_method-inl.h"
 #include "base/arena_allocator.h"
 #include "base/arena_containers.h"
+#include "base/array_ref.h"
 #include "base/dumpable.h"
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "base/scoped_arena_allocator.h"
+#include "base/stl_util.h"
+#include "base/time_utils.h"
 #include "base/timing_logger.h"
 #include "builder.h"
 #include "code_generator.h"
@@ -42,6 +45,7 @@
 #include "driver/compiler_driver-inl.h"
 #include "driver/compiler_options.h"
 #include "driver/dex_compilation_unit.h"
+#include "gc/heap.h"
 #include "graph_checker.h"
 #include "graph_visualizer.h"
 #include "inliner.h"
@@ -49,6 +53,7 @@
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
 #include "jit/jit_logger.h"
+#include "jit/profiling_info.h"
 #include "jni/quick/jni_compiler.h"
 #include "linker/linker_patch.h"
 #include "nodes.h"
@@ -75,21 +80,25 @@ static constexpr const char* kPassNameSeparator = "$";
 class CodeVectorAllocator FINAL : public CodeAllocator {
  public:
   explicit CodeVectorAllocator(ArenaAllocator* allocator)
-      : memory_(allocator->Adapter(kArenaAllocCodeBuffer)),
+      : allocator_(allocator),
+        memory_(nullptr),
         size_(0) {}
 
   virtual uint8_t* Allocate(size_t size) {
+    // Arena memory is zeroed already, so skip the value-initialization of a vector.
+    DCHECK(memory_ == nullptr);
     size_ = size;
-    memory_.resize(size);
-    return &memory_[0];
+    memory_ = allocator_->AllocArray<uint8_t>(size, kArenaAllocCodeBuffer);
+    return memory_;
   }
 
   size_t GetSize() const { return size_; }
-  const ArenaVector<uint8_t>& GetMemory() const { return memory_; }
-  uint8_t* GetData() { return memory_.data(); }
+  ArrayRef<const uint8_t> GetMemory() const { return ArrayRef<const uint8_t>(memory_, size_); }
+  uint8_t* GetData() { return memory_; }
 
  private:
-  ArenaVector<uint8_t> memory_;
+  ArenaAllocator* const allocator_;
+  uint8_t* memory_;
   size_t size_;
 
   DISALLOW_COPY_AND_ASSIGN(CodeVectorAllocator);
@@ -109,8 +118,10 @@ class PassObserver : public ValueObject {
                CodeGenerator* codegen,
                std::ostream* visualizer_output,
                CompilerDriver* compiler_driver,
-               Mutex& dump_mutex)
+               Mutex& dump_mutex,
+               OptimizingCompilerStats* stats)
       : graph_(graph),
+        stats_(stats),
         cached_method_name_(),
         timing_logger_enabled_(compiler_driver->GetCompilerOptions().GetDumpTimings()),
         timing_logger_(timing_logger_enabled_ ? GetMethodName() : "", true, true),
@@ -120,7 +131,23 @@ class PassObserver : public ValueObject {
         visualizer_enabled_(!compiler_driver->GetCompilerOptions().GetDumpCfgFileName().empty()),
         visualizer_(&visualizer_oss_, graph, *codegen),
         visualizer_dump_mutex_(dump_mutex),
-        graph_in_bad_state_(false) {
+        graph_in_bad_state_(false),
+        compile_time_deadline_ns_(0u),
+        compile_memory_budget_bytes_(0u),
+        over_compile_budget_(false),
+        method_start_ns_(NanoTime()),
+        pass_start_ns_(0u),
+        pass_start_bytes_(0u),
+        pass_start_scoped_bytes_(0u) {
+    const CompilerOptions& compiler_options = compiler_driver->GetCompilerOptions();
+    size_t budget_ms = compiler_options.GetCompileTimeBudgetMs();
+    if (budget_ms != CompilerOptions::kNoCompileTimeBudget) {
+      compile_time_deadline_ns_ = method_start_ns_ + MsToNs(budget_ms);
+    }
+    size_t budget_kb = compiler_options.GetCompileMemoryBudgetKb();
+    if (budget_kb != CompilerOptions::kNoCompileMemoryBudget) {
+      compile_memory_budget_bytes_ = budget_kb * KB;
+    }
     if (timing_logger_enabled_ || visualizer_enabled_) {
       if (!IsVerboseMethod(compiler_driver, GetMethodName())) {
         timing_logger_enabled_ = visualizer_enabled_ = false;
@@ -133,6 +160,11 @@ class PassObserver : public ValueObject {
   }
 
   ~PassObserver() {
+    if (stats_ != nullptr) {
+      stats_->RecordMethod(GetMethodName(),
+                           NanoTime() - method_start_ns_,
+                           graph_->GetAllocator()->BytesUsed());
+    }
     if (timing_logger_enabled_) {
       LOG(INFO) << "TIMINGS " << GetMethodName();
       LOG(INFO) << Dumpable<TimingLogger>(timing_logger_);
@@ -149,6 +181,27 @@ class PassObserver : public ValueObject {
 
   void SetGraphInBadState() { graph_in_bad_state_ = true; }
 
+  // Returns whether compiling the method has taken longer than --compile-time-budget-ms,
+  // or its graph has used more arena memory than --compile-memory-budget-kb. Once it has,
+  // the remaining optional passes are skipped and the register allocator falls back to
+  // linear scan.
+  bool IsOverCompileBudget() {
+    if (over_compile_budget_) {
+      return true;
+    }
+    if (compile_time_deadline_ns_ != 0u && NanoTime() > compile_time_deadline_ns_) {
+      VLOG(compiler) << "Compile time budget exceeded for " << GetMethodName();
+      MaybeRecordStat(stats_, MethodCompilationStat::kCompileTimeBudgetExceeded);
+      over_compile_budget_ = true;
+    } else if (compile_memory_budget_bytes_ != 0u &&
+               graph_->GetAllocator()->BytesUsed() > compile_memory_budget_bytes_) {
+      VLOG(compiler) << "Compile memory budget exceeded for " << GetMethodName();
+      MaybeRecordStat(stats_, MethodCompilationStat::kCompileMemoryBudgetExceeded);
+      over_compile_budget_ = true;
+    }
+    return over_compile_budget_;
+  }
+
   const char* GetMethodName() {
     // PrettyMethod() is expensive, so we delay calling it until we actually have to.
     if (cached_method_name_.empty()) {
@@ -168,6 +221,11 @@ class PassObserver : public ValueObject {
     if (timing_logger_enabled_) {
       timing_logger_.StartTiming(pass_name);
     }
+    if (stats_ != nullptr) {
+      pass_start_ns_ = NanoTime();
+      pass_start_bytes_ = graph_->GetAllocator()->BytesUsed();
+      pass_start_scoped_bytes_ = graph_->GetArenaStack()->BytesReserved();
+    }
   }
 
   void FlushVisualizer() REQUIRES(!visualizer_dump_mutex_) {
@@ -183,6 +241,12 @@ class PassObserver : public ValueObject {
     if (timing_logger_enabled_) {
       timing_logger_.EndTiming();
     }
+    if (stats_ != nullptr) {
+      stats_->RecordPass(pass_name,
+                         NanoTime() - pass_start_ns_,
+                         graph_->GetAllocator()->BytesUsed() - pass_start_bytes_,
+                         graph_->GetArenaStack()->BytesReserved() - pass_start_scoped_bytes_);
+    }
     if (visualizer_enabled_) {
       visualizer_.DumpGraph(pass_name, /* is_after_pass */ true, graph_in_bad_state_);
       FlushVisualizer();
@@ -218,6 +282,7 @@ class PassObserver : public ValueObject {
   }
 
   HGraph* const graph_;
+  OptimizingCompilerStats* const stats_;
 
   std::string cached_method_name_;
 
@@ -236,6 +301,18 @@ class PassObserver : public ValueObject {
   // expected to validate.
   bool graph_in_bad_state_;
 
+  // When the compile time budget runs out, or 0 if there is no budget.
+  uint64_t compile_time_deadline_ns_;
+  // Graph arena usage above which the method is over budget, or 0 if there is no budget.
+  size_t compile_memory_budget_bytes_;
+  bool over_compile_budget_;
+
+  // Used to report per-method and per-pass time and memory to `stats_`.
+  uint64_t method_start_ns_;
+  uint64_t pass_start_ns_;
+  size_t pass_start_bytes_;
+  size_t pass_start_scoped_bytes_;
+
   friend PassScope;
 
   DISALLOW_COPY_AND_ASSIGN(PassObserver);
@@ -258,6 +335,28 @@ class PassScope : public ValueObject {
   PassObserver* const pass_observer_;
 };
 
+// Returns whether the code generators rely on `pass` having run, in which case
+// it runs even when the compile budget is exceeded. These passes do not depend
+// on any analysis, so they can run after any of the optional passes were skipped.
+static bool IsPassRequiredForCodegen(OptimizationPass pass) {
+  switch (pass) {
+    // The passes of the baseline pipeline.
+    case OptimizationPass::kIntrinsicsRecognizer:
+    case OptimizationPass::kSharpening:
+    case OptimizationPass::kInstructionSimplifier:
+    // The fixups that create the base of PC-relative accesses.
+#ifdef ART_ENABLE_CODEGEN_mips
+    case OptimizationPass::kPcRelativeFixupsMips:
+#endif
+#ifdef ART_ENABLE_CODEGEN_x86
+    case OptimizationPass::kPcRelativeFixupsX86:
+#endif
+      return true;
+    default:
+      return false;
+  }
+}
+
 class OptimizingCompiler FINAL : public Compiler {
  public:
   explicit OptimizingCompiler(CompilerDriver* driver);
@@ -292,11 +391,14 @@ class OptimizingCompiler FINAL : public Compiler {
   bool JitCompile(Thread* self,
                   jit::JitCodeCache* code_cache,
                   ArtMethod* method,
+                  bool baseline,
                   bool osr,
                   jit::JitLogger* jit_logger)
       OVERRIDE
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  void DumpStats(std::ostream& os) const OVERRIDE;
+
  private:
   void RunOptimizations(HGraph* graph,
                         CodeGenerator* codegen,
@@ -319,6 +421,11 @@ class OptimizingCompiler FINAL : public Compiler {
     DCHECK_EQ(length, optimizations.size());
     // Run the optimization passes one by one.
     for (size_t i = 0; i < length; ++i) {
+      if (pass_observer->IsOverCompileBudget() &&
+          !IsPassRequiredForCodegen(definitions[i].first)) {
+        VLOG(compiler) << "Skipping pass: " << optimizations[i]->GetPassName();
+        continue;
+      }
       PassScope scope(optimizations[i]->GetPassName(), pass_observer);
       optimizations[i]->Run();
     }
@@ -354,12 +461,14 @@ class OptimizingCompiler FINAL : public Compiler {
   // 1) Builds the graph. Returns null if it failed to build it.
   // 2) Transforms the graph to SSA. Returns null if it failed.
   // 3) Runs optimizations on the graph, including register allocator.
+  //    Only the passes needed for correctness are run for `baseline`.
   // 4) Generates code with the `code_allocator` provided.
   CodeGenerator* TryCompile(ArenaAllocator* allocator,
                             ArenaStack* arena_stack,
                             CodeVectorAllocator* code_allocator,
                             const DexCompilationUnit& dex_compilation_unit,
                             ArtMethod* method,
+                            bool baseline,
                             bool osr,
                             VariableSizedHandleScope* handles) const;
 
@@ -424,6 +533,12 @@ OptimizingCompiler::~OptimizingCompiler() {
   }
 }
 
+void OptimizingCompiler::DumpStats(std::ostream& os) const {
+  if (compilation_stats_.get() != nullptr) {
+    compilation_stats_->DumpPassesAndMethods(os);
+  }
+}
+
 bool OptimizingCompiler::CanCompileMethod(uint32_t method_idx ATTRIBUTE_UNUSED,
                                           const DexFile& dex_file ATTRIBUTE_UNUSED) const {
   return true;
@@ -555,6 +670,9 @@ void OptimizingCompiler::RunArchOptimizations(HGraph* graph,
       OptimizationDef x86_64_optimizations[] = {
         OptDef(OptimizationPass::kSideEffectsAnalysis),
         OptDef(OptimizationPass::kGlobalValueNumbering, "GVN$after_arch"),
+        // Scheduling must precede memory operand generation, which places
+        // array lengths right before their bounds checks.
+        OptDef(OptimizationPass::kScheduling),
         OptDef(OptimizationPass::kX86MemoryOperandGeneration)
       };
       RunOptimizations(graph,
@@ -630,6 +748,26 @@ void OptimizingCompiler::RunOptimizations(HGraph* graph,
     return;
   }
 
+  if (graph->IsCompilingBaseline()) {
+    // Baseline code is meant to be replaced soon by optimized code, favor compile time.
+    // The arch optimizations include the fixups some code generators rely on.
+    OptimizationDef baseline_optimizations[] = {
+      OptDef(OptimizationPass::kIntrinsicsRecognizer),
+      OptDef(OptimizationPass::kSharpening),
+      // The code generator has a few assumptions that only the instruction
+      // simplifier can satisfy.
+      OptDef(OptimizationPass::kInstructionSimplifier, "instruction_simplifier$baseline")
+    };
+    RunOptimizations(graph,
+                     codegen,
+                     dex_compilation_unit,
+                     pass_observer,
+                     handles,
+                     baseline_optimizations);
+    RunArchOptimizations(graph, codegen, dex_compilation_unit, pass_observer, handles);
+    return;
+  }
+
   OptimizationDef optimizations1[] = {
     OptDef(OptimizationPass::kIntrinsicsRecognizer),
     OptDef(OptimizationPass::kSharpening),
@@ -739,6 +877,7 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
                                               CodeVectorAllocator* code_allocator,
                                               const DexCompilationUnit& dex_compilation_unit,
                                               ArtMethod* method,
+                                              bool baseline,
                                               bool osr,
                                               VariableSizedHandleScope* handles) const {
   MaybeRecordStat(compilation_stats_.get(), MethodCompilationStat::kAttemptBytecodeCompilation);
@@ -784,7 +923,8 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
       compiler_driver->GetInstructionSet(),
       kInvalidInvokeType,
       compiler_driver->GetCompilerOptions().GetDebuggable(),
-      osr);
+      osr,
+      baseline);
 
   ArrayRef<const uint8_t> interpreter_metadata;
   // For AOT compilation, we may not get a method, for example if its class is erroneous.
@@ -794,6 +934,12 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
     graph->SetArtMethod(method);
     ScopedObjectAccess soa(Thread::Current());
     interpreter_metadata = method->GetQuickenedInfo();
+    if (!Runtime::Current()->IsAotCompiler()) {
+      ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+      if (info != nullptr) {
+        graph->SetDisabledSpeculations(info->GetDisabledSpeculations());
+      }
+    }
   }
 
   std::unique_ptr<CodeGenerator> codegen(
@@ -813,7 +959,8 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
                              codegen.get(),
                              visualizer_output_.get(),
                              compiler_driver,
-                             dump_mutex_);
+                             dump_mutex_,
+                             compilation_stats_.get());
 
   {
     VLOG(compiler) << "Building " << pass_observer.GetMethodName();
@@ -866,6 +1013,9 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
 
   RegisterAllocator::Strategy regalloc_strategy =
     compiler_options.GetRegisterAllocationStrategy();
+  if (pass_observer.IsOverCompileBudget()) {
+    regalloc_strategy = RegisterAllocator::kRegisterAllocatorLinearScan;
+  }
   AllocateRegisters(graph,
                     codegen.get(),
                     &pass_observer,
@@ -931,7 +1081,8 @@ CodeGenerator* OptimizingCompiler::TryCompileIntrinsic(
                              codegen.get(),
                              visualizer_output_.get(),
                              compiler_driver,
-                             dump_mutex_);
+                             dump_mutex_,
+                             compilation_stats_.get());
 
   {
     VLOG(compiler) << "Building intrinsic graph " << pass_observer.GetMethodName();
@@ -1042,6 +1193,7 @@ CompiledMethod* OptimizingCompiler::Compile(const DexFile::CodeItem* code_item,
                        &code_allocator,
                        dex_compilation_unit,
                        method,
+                       /* baseline */ false,
                        /* osr */ false,
                        &handles));
       }
@@ -1168,23 +1320,32 @@ bool EncodeArtMethodInInlineInfo(ArtMethod* method ATTRIBUTE_UNUSED) {
   return Runtime::Current() == nullptr || !Runtime::Current()->IsAotCompiler();
 }
 
-bool CanEncodeInlinedMethodInStackMap(const DexFile& caller_dex_file, ArtMethod* callee) {
+bool CanEncodeInlinedMethodInStackMap(const DexFile& caller_dex_file,
+                                      ArtMethod* callee,
+                                      const CompilerDriver* compiler_driver) {
   if (!Runtime::Current()->IsAotCompiler()) {
     // JIT can always encode methods in stack maps.
     return true;
   }
-  if (IsSameDexFile(caller_dex_file, *callee->GetDexFile())) {
+  const DexFile& callee_dex_file = *callee->GetDexFile();
+  if (IsSameDexFile(caller_dex_file, callee_dex_file)) {
     return true;
   }
-  // TODO(ngeoffray): Support more AOT cases for inlining:
-  // - methods in multidex
-  // - methods in boot image for on-device non-PIC compilation.
-  return false;
+  // Methods from other dex files are encoded with the index of the call site, which the
+  // runtime resolves in the caller's dex cache. This finds the same method as long as the
+  // callee comes from a dex file of the oat file being compiled, or from the boot image
+  // the oat file is compiled against.
+  if (ContainsElement(compiler_driver->GetDexFilesForOatFile(), &callee_dex_file)) {
+    return true;
+  }
+  return !compiler_driver->GetCompilerOptions().IsBootImage() &&
+      Runtime::Current()->GetHeap()->ObjectIsInBootImageSpace(callee->GetDeclaringClass());
 }
 
 bool OptimizingCompiler::JitCompile(Thread* self,
                                     jit::JitCodeCache* code_cache,
                                     ArtMethod* method,
+                                    bool baseline,
                                     bool osr,
                                     jit::JitLogger* jit_logger) {
   StackHandleScope<3> hs(self);
@@ -1208,6 +1369,10 @@ bool OptimizingCompiler::JitCompile(Thread* self,
     ScopedNullHandle<mirror::ObjectArray<mirror::Object>> roots;
     ArenaSet<ArtMethod*, std::less<ArtMethod*>> cha_single_implementation_list(
         allocator.Adapter(kArenaAllocCHA));
+    ArenaSet<ArtField*, std::less<ArtField*>> final_field_dependencies(
+        allocator.Adapter(kArenaAllocCHA));
+    ArenaSet<ArtMethod*, std::less<ArtMethod*>> inlined_methods(
+        allocator.Adapter(kArenaAllocCHA));
     const void* code = code_cache->CommitCode(
         self,
         method,
@@ -1223,7 +1388,9 @@ bool OptimizingCompiler::JitCompile(Thread* self,
         osr,
         roots,
         /* has_should_deoptimize_flag */ false,
-        cha_single_implementation_list);
+        cha_single_implementation_list,
+        final_field_dependencies,
+        inlined_methods);
     if (code == nullptr) {
       return false;
     }
@@ -1276,6 +1443,11 @@ bool OptimizingCompiler::JitCompile(Thread* self,
         /* verified_method */ nullptr,
         dex_cache);
 
+    // Baseline code is compiled with OSR entries at its loop headers, so that a method stuck
+    // in an interpreted loop can jump into its baseline code, without a separate OSR
+    // compilation. The baseline pipeline does not run the optimizations that OSR restricts.
+    const bool with_osr_entries = osr || baseline;
+
     // Go to native so that we don't block GC during compilation.
     ScopedThreadSuspension sts(self, kNative);
     codegen.reset(
@@ -1284,7 +1456,8 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                    &code_allocator,
                    dex_compilation_unit,
                    method,
-                   osr,
+                   baseline,
+                   with_osr_entries,
                    &handles));
     if (codegen.get() == nullptr) {
       return false;
@@ -1344,7 +1517,9 @@ bool OptimizingCompiler::JitCompile(Thread* self,
       osr,
       roots,
       codegen->GetGraph()->HasShouldDeoptimizeFlag(),
-      codegen->GetGraph()->GetCHASingleImplementationList());
+      codegen->GetGraph()->GetCHASingleImplementationList(),
+      codegen->GetGraph()->GetFinalFieldDependencies(),
+      codegen->GetGraph()->GetInlinedMethods());
 
   if (code == nullptr) {
     MaybeRecordStat(compilation_stats_.get(), MethodCompilationStat::kJitOutOfMemoryForCommit);
@@ -1411,7 +1586,12 @@ void OptimizingCompiler::GenerateJitDebugInfo(ArtMethod* method, debug::MethodDe
       mini_debug_info,
       ArrayRef<const debug::MethodDebugInfo>(&info, 1));
   MutexLock mu(Thread::Current(), *Locks::native_debug_interface_lock_);
-  AddNativeDebugInfoForJit(reinterpret_cast<const void*>(info.code_address), elf_file);
+  // Mini debug info of recently compiled methods is periodically merged and compressed.
+  AddNativeDebugInfoForJit(reinterpret_cast<const void*>(info.code_address),
+                           elf_file,
+                           mini_debug_info ? &debug::PackElfFileForJIT : nullptr,
+                           GetCompilerDriver()->GetInstructionSet(),
+                           GetCompilerDriver()->GetInstructionSetFeatures());
 
   VLOG(jit)
       << "JIT mini-debug-info added for " << ArtMethod::PrettyMethod(method)
@@ -35,7 +35,9 @@ Compiler* CreateOptimizingCompiler(CompilerDriver* driver);
 bool IsCompilingWithCoreImage();
 
 bool EncodeArtMethodInInlineInfo(ArtMethod* method);
-bool CanEncodeInlinedMethodInStackMap(const DexFile& caller_dex_file, ArtMethod* callee)
+bool CanEncodeInlinedMethodInStackMap(const DexFile& caller_dex_file,
+                                      ArtMethod* callee,
+                                      const CompilerDriver* compiler_driver)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
 }  // namespace art
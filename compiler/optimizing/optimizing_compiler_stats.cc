@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "optimizing_compiler_stats.h"
+
+#include <algorithm>
+
+#include "base/time_utils.h"
+#include "base/utils.h"
+#include "thread-current-inl.h"
+
+namespace art {
+
+void OptimizingCompilerStats::RecordPass(const char* pass_name,
+                                         uint64_t duration_ns,
+                                         size_t bytes,
+                                         size_t scoped_bytes) {
+  MutexLock mu(Thread::Current(), lock_);
+  PassStats& stats = pass_stats_[pass_name];
+  ++stats.runs;
+  stats.total_ns += duration_ns;
+  stats.max_ns = std::max(stats.max_ns, duration_ns);
+  stats.total_bytes += bytes;
+  stats.total_scoped_bytes += scoped_bytes;
+}
+
+void OptimizingCompilerStats::RecordMethod(const std::string& method_name,
+                                           uint64_t duration_ns,
+                                           size_t bytes) {
+  MutexLock mu(Thread::Current(), lock_);
+  if (slowest_methods_.size() == kNumberOfSlowestMethods &&
+      slowest_methods_.back().duration_ns >= duration_ns) {
+    return;
+  }
+  if (slowest_methods_.size() == kNumberOfSlowestMethods) {
+    slowest_methods_.pop_back();
+  }
+  MethodStats stats = { method_name, duration_ns, bytes };
+  auto it = std::upper_bound(slowest_methods_.begin(),
+                             slowest_methods_.end(),
+                             stats,
+                             [](const MethodStats& lhs, const MethodStats& rhs) {
+                               return lhs.duration_ns > rhs.duration_ns;
+                             });
+  slowest_methods_.insert(it, stats);
+}
+
+void OptimizingCompilerStats::DumpPassesAndMethods(std::ostream& os) {
+  MutexLock mu(Thread::Current(), lock_);
+  if (pass_stats_.empty()) {
+    return;
+  }
+  os << "Optimizing compiler passes:\n";
+  for (const auto& entry : pass_stats_) {
+    const PassStats& stats = entry.second;
+    os << "  " << entry.first << ": runs=" << stats.runs
+       << " total=" << PrettyDuration(stats.total_ns)
+       << " max=" << PrettyDuration(stats.max_ns)
+       << " arena=" << PrettySize(stats.total_bytes)
+       << " scoped=" << PrettySize(stats.total_scoped_bytes) << "\n";
+  }
+  os << "Slowest compiled methods:\n";
+  for (const MethodStats& stats : slowest_methods_) {
+    os << "  " << stats.name << ": " << PrettyDuration(stats.duration_ns)
+       << " arena=" << PrettySize(stats.bytes) << "\n";
+  }
+}
+
+}  // namespace art
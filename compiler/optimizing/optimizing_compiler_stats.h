@@ -19,12 +19,16 @@
 
 #include <atomic>
 #include <iomanip>
+#include <map>
+#include <ostream>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include "base/atomic.h"
 #include "base/globals.h"
 #include "base/logging.h"  // For VLOG_IS_ON.
+#include "base/mutex.h"
 
 namespace art {
 
@@ -35,6 +39,7 @@ enum class MethodCompilationStat {
   kCompiledIntrinsic,
   kCompiledBytecode,
   kCHAInline,
+  kCHADirectCall,
   kInlinedInvoke,
   kReplacedInvokeWithSimplePattern,
   kInstructionSimplifications,
@@ -42,6 +47,7 @@ enum class MethodCompilationStat {
   kUnresolvedMethod,
   kUnresolvedField,
   kUnresolvedFieldNotAFastAccess,
+  kFoldedFinalStaticField,
   kRemovedCheckedCast,
   kRemovedDeadInstruction,
   kRemovedNullCheck,
@@ -61,14 +67,21 @@ enum class MethodCompilationStat {
   kNotCompiledVerifyAtRuntime,
   kInlinedMonomorphicCall,
   kInlinedPolymorphicCall,
+  kInlinedMegamorphicCall,
   kMonomorphicCall,
   kPolymorphicCall,
   kMegamorphicCall,
   kBooleanSimplified,
   kIntrinsicRecognized,
   kLoopInvariantMoved,
+  kLoopInvariantNullCheckSpeculated,
   kLoopVectorized,
   kLoopVectorizedIdiom,
+  kLoopVectorizedWithEpilogue,
+  kLoopVectorizedEarlyExit,
+  kLoopPeeled,
+  kLoopUnrolled,
+  kLoopSuspendCheckRemoved,
   kSelectGenerated,
   kRemovedInstanceOf,
   kInlinedInvokeVirtualOrInterface,
@@ -99,14 +112,17 @@ enum class MethodCompilationStat {
   kConstructorFenceRemovedLSE,
   kConstructorFenceRemovedPFRA,
   kConstructorFenceRemovedCFRE,
+  kPhiAddedLSE,
   kJitOutOfMemoryForCommit,
+  kCompileTimeBudgetExceeded,
+  kCompileMemoryBudgetExceeded,
   kLastStat
 };
 std::ostream& operator<<(std::ostream& os, const MethodCompilationStat& rhs);
 
 class OptimizingCompilerStats {
  public:
-  OptimizingCompilerStats() {
+  OptimizingCompilerStats() : lock_("Optimizing compiler stats lock") {
     // The std::atomic<> default constructor leaves values uninitialized, so initialize them now.
     Reset();
   }
@@ -173,9 +189,45 @@ class OptimizingCompilerStats {
     }
   }
 
+  // Record that one run of the pass `pass_name` took `duration_ns`, grew the graph's arena
+  // by `bytes` and grew the memory reserved by the graph's arena stack by `scoped_bytes`.
+  void RecordPass(const char* pass_name,
+                  uint64_t duration_ns,
+                  size_t bytes,
+                  size_t scoped_bytes) REQUIRES(!lock_);
+
+  // Record that compiling `method_name` took `duration_ns` and `bytes` of graph arena.
+  // Only the kNumberOfSlowestMethods slowest methods are kept.
+  void RecordMethod(const std::string& method_name, uint64_t duration_ns, size_t bytes)
+      REQUIRES(!lock_);
+
+  // Dump the time and memory spent in each pass, and the slowest methods.
+  void DumpPassesAndMethods(std::ostream& os) REQUIRES(!lock_);
+
  private:
+  static constexpr size_t kNumberOfSlowestMethods = 10;
+
+  struct PassStats {
+    uint64_t runs = 0u;
+    uint64_t total_ns = 0u;
+    uint64_t max_ns = 0u;
+    uint64_t total_bytes = 0u;
+    uint64_t total_scoped_bytes = 0u;
+  };
+
+  struct MethodStats {
+    std::string name;
+    uint64_t duration_ns;
+    size_t bytes;
+  };
+
   std::atomic<uint32_t> compile_stats_[static_cast<size_t>(MethodCompilationStat::kLastStat)];
 
+  Mutex lock_;
+  std::map<std::string, PassStats> pass_stats_ GUARDED_BY(lock_);
+  // Sorted by decreasing duration.
+  std::vector<MethodStats> slowest_methods_ GUARDED_BY(lock_);
+
   DISALLOW_COPY_AND_ASSIGN(OptimizingCompilerStats);
 };
 
@@ -29,6 +29,14 @@
 
 namespace art {
 
+// The adaptive strategy uses graph coloring for methods with at least this many SSA values.
+// Smaller methods rarely run out of registers, so linear scan allocates them as well.
+static constexpr size_t kGraphColorMinSsaValues = 64;
+
+// The interference graph grows quadratically with the number of live values, so the adaptive
+// strategy falls back to linear scan above this many SSA values to bound compile time.
+static constexpr size_t kGraphColorMaxSsaValues = 4096;
+
 RegisterAllocator::RegisterAllocator(ScopedArenaAllocator* allocator,
                                      CodeGenerator* codegen,
                                      const SsaLivenessAnalysis& liveness)
@@ -40,7 +48,7 @@ std::unique_ptr<RegisterAllocator> RegisterAllocator::Create(ScopedArenaAllocato
                                                              CodeGenerator* codegen,
                                                              const SsaLivenessAnalysis& analysis,
                                                              Strategy strategy) {
-  switch (strategy) {
+  switch (SelectStrategy(codegen->GetGraph(), analysis, strategy)) {
     case kRegisterAllocatorLinearScan:
       return std::unique_ptr<RegisterAllocator>(
           new (allocator) RegisterAllocatorLinearScan(allocator, codegen, analysis));
@@ -53,6 +61,23 @@ std::unique_ptr<RegisterAllocator> RegisterAllocator::Create(ScopedArenaAllocato
   }
 }
 
+RegisterAllocator::Strategy RegisterAllocator::SelectStrategy(const HGraph* graph,
+                                                             const SsaLivenessAnalysis& analysis,
+                                                             Strategy strategy) {
+  if (strategy != kRegisterAllocatorAdaptive) {
+    return strategy;
+  }
+  size_t number_of_ssa_values = analysis.GetNumberOfSsaValues();
+  // Baseline code is meant to be compiled quickly, and spills outside loops are cheap.
+  if (graph->IsCompilingBaseline() ||
+      !graph->HasLoops() ||
+      number_of_ssa_values < kGraphColorMinSsaValues ||
+      number_of_ssa_values > kGraphColorMaxSsaValues) {
+    return kRegisterAllocatorLinearScan;
+  }
+  return kRegisterAllocatorGraphColor;
+}
+
 RegisterAllocator::~RegisterAllocator() {
   if (kIsDebugBuild) {
     // Poison live interval pointers with "Error: BAD 71ve1nt3rval."
@@ -40,16 +40,25 @@ class RegisterAllocator : public DeletableArenaObject<kArenaAllocRegisterAllocat
  public:
   enum Strategy {
     kRegisterAllocatorLinearScan,
-    kRegisterAllocatorGraphColor
+    kRegisterAllocatorGraphColor,
+    // Graph coloring for large methods with loops, where it spills less than linear
+    // scan, and linear scan everywhere else, where it compiles faster.
+    kRegisterAllocatorAdaptive
   };
 
-  static constexpr Strategy kRegisterAllocatorDefault = kRegisterAllocatorLinearScan;
+  static constexpr Strategy kRegisterAllocatorDefault = kRegisterAllocatorAdaptive;
 
   static std::unique_ptr<RegisterAllocator> Create(ScopedArenaAllocator* allocator,
                                                    CodeGenerator* codegen,
                                                    const SsaLivenessAnalysis& analysis,
                                                    Strategy strategy = kRegisterAllocatorDefault);
 
+  // Resolve kRegisterAllocatorAdaptive into the strategy to use for `graph`, whose
+  // liveness is `analysis`. Other strategies are returned unchanged.
+  static Strategy SelectStrategy(const HGraph* graph,
+                                 const SsaLivenessAnalysis& analysis,
+                                 Strategy strategy);
+
   virtual ~RegisterAllocator();
 
   // Main entry point for the register allocator. Given the liveness analysis,
@@ -48,6 +48,10 @@ static constexpr size_t kSingleJumpBlockWeightMultiplier = 2;
 // be executed on every path through the method.
 static constexpr size_t kDominatesExitBlockWeightMultiplier = 2;
 
+// Constants are never stored to a spill slot: a spilled constant is reloaded as an immediate
+// at its uses. This makes it cheaper to spill than other values with the same uses.
+static constexpr size_t kRematerializableSpillWeightDivisor = 2;
+
 enum class CoalesceKind {
   kAdjacentSibling,       // Prevents moves at interval split points.
   kFixedOutputSibling,    // Prevents moves from a fixed output location.
@@ -72,11 +76,20 @@ static size_t LoopDepthAt(HBasicBlock* block) {
   return depth;
 }
 
+// Returns whether `block` is only executed when an exception is thrown. Such blocks
+// are laid out after all the others, and moves in them are rarely executed, even in loops.
+static bool IsColdBlock(HBasicBlock* block) {
+  return block->IsCatchBlock() || block->GetLastInstruction()->IsThrow();
+}
+
 // Return the runtime cost of inserting a move instruction at the specified location.
 static size_t CostForMoveAt(size_t position, const SsaLivenessAnalysis& liveness) {
   HBasicBlock* block = liveness.GetBlockFromPosition(position / 2);
   DCHECK(block != nullptr);
   size_t cost = 1;
+  if (IsColdBlock(block)) {
+    return cost;
+  }
   if (block->IsSingleJump()) {
     cost *= kSingleJumpBlockWeightMultiplier;
   }
@@ -191,6 +204,10 @@ static float ComputeSpillWeight(LiveInterval* interval, const SsaLivenessAnalysi
     }
   }
 
+  if (interval->GetDefinedBy() != nullptr && interval->GetDefinedBy()->IsConstant()) {
+    use_weight /= kRematerializableSpillWeightDivisor;
+  }
+
   // We divide by the length of the interval because we want to prioritize
   // short intervals; we do not benefit much if we split them further.
   return static_cast<float>(use_weight) / static_cast<float>(length);
@@ -410,10 +427,10 @@ class InterferenceNode : public ArenaObject<kArenaAllocRegisterAllocator> {
 // short intervals. That way, if we fail to color a node, it either won't require a
 // register, or it will be a long interval that can be split in order to make the
 // interference graph sparser.
-// To improve code quality, we prioritize intervals used frequently in deeply nested loops.
+// To improve code quality, we prioritize intervals used frequently in deeply nested loops,
+// and deprioritize constants, which can be rematerialized.
 // (This metric is secondary to the forward progress requirements above.)
 // TODO: May also want to consider:
-// - Constants (since they can be rematerialized)
 // - Allocated spill slots
 static bool HasGreaterNodePriority(const InterferenceNode* lhs,
                                    const InterferenceNode* rhs) {
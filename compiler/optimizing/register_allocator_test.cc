@@ -77,6 +77,9 @@ TEST_F(RegisterAllocatorTest, test_name##_LinearScan) {\
 }\
 TEST_F(RegisterAllocatorTest, test_name##_GraphColor) {\
   test_name(Strategy::kRegisterAllocatorGraphColor);\
+}\
+TEST_F(RegisterAllocatorTest, test_name##_Adaptive) {\
+  test_name(Strategy::kRegisterAllocatorAdaptive);\
 }
 
 bool RegisterAllocatorTest::Check(const std::vector<uint16_t>& data, Strategy strategy) {
@@ -235,6 +238,36 @@ void RegisterAllocatorTest::Loop1(Strategy strategy) {
 
 TEST_ALL_STRATEGIES(Loop1);
 
+// The adaptive strategy keeps linear scan for small methods, even with loops,
+// and explicitly requested strategies are never overridden.
+TEST_F(RegisterAllocatorTest, SelectStrategy) {
+  const std::vector<uint16_t> data = TWO_REGISTERS_CODE_ITEM(
+    Instruction::CONST_4 | 0 | 0,
+    Instruction::IF_EQ, 4,
+    Instruction::CONST_4 | 4 << 12 | 0,
+    Instruction::GOTO | 0xFD00,
+    Instruction::CONST_4 | 5 << 12 | 1 << 8,
+    Instruction::RETURN | 1 << 8);
+
+  HGraph* graph = CreateCFG(data);
+  ASSERT_TRUE(graph->HasLoops());
+  std::unique_ptr<const X86InstructionSetFeatures> features_x86(
+      X86InstructionSetFeatures::FromCppDefines());
+  x86::CodeGeneratorX86 codegen(graph, *features_x86.get(), CompilerOptions());
+  SsaLivenessAnalysis liveness(graph, &codegen, GetScopedAllocator());
+  liveness.Analyze();
+
+  EXPECT_EQ(Strategy::kRegisterAllocatorLinearScan,
+            RegisterAllocator::SelectStrategy(
+                graph, liveness, Strategy::kRegisterAllocatorAdaptive));
+  EXPECT_EQ(Strategy::kRegisterAllocatorLinearScan,
+            RegisterAllocator::SelectStrategy(
+                graph, liveness, Strategy::kRegisterAllocatorLinearScan));
+  EXPECT_EQ(Strategy::kRegisterAllocatorGraphColor,
+            RegisterAllocator::SelectStrategy(
+                graph, liveness, Strategy::kRegisterAllocatorGraphColor));
+}
+
 void RegisterAllocatorTest::Loop2(Strategy strategy) {
   /*
    * Test the following snippet:
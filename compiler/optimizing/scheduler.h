@@ -503,10 +503,12 @@ class HInstructionScheduling : public HOptimization {
   HInstructionScheduling(HGraph* graph,
                          InstructionSet instruction_set,
                          CodeGenerator* cg = nullptr,
-                         const char* name = kInstructionSchedulingPassName)
+                         const char* name = kInstructionSchedulingPassName,
+                         const InstructionSetFeatures* isa_features = nullptr)
       : HOptimization(graph, name),
         codegen_(cg),
-        instruction_set_(instruction_set) {}
+        instruction_set_(instruction_set),
+        isa_features_(isa_features) {}
 
   void Run() {
     Run(/*only_optimize_loop_blocks*/ true, /*schedule_randomly*/ false);
@@ -518,6 +520,8 @@ class HInstructionScheduling : public HOptimization {
  private:
   CodeGenerator* const codegen_;
   const InstructionSet instruction_set_;
+  // Used to select the latency model of the target CPU. May be null.
+  const InstructionSetFeatures* const isa_features_;
   DISALLOW_COPY_AND_ASSIGN(HInstructionScheduling);
 };
 
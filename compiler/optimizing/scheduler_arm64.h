@@ -17,49 +17,142 @@
 #ifndef ART_COMPILER_OPTIMIZING_SCHEDULER_ARM64_H_
 #define ART_COMPILER_OPTIMIZING_SCHEDULER_ARM64_H_
 
+#include "arch/arm64/instruction_set_features_arm64.h"
 #include "scheduler.h"
 
 namespace art {
 namespace arm64 {
 
-static constexpr uint32_t kArm64MemoryLoadLatency = 5;
-static constexpr uint32_t kArm64MemoryStoreLatency = 3;
-
-static constexpr uint32_t kArm64CallInternalLatency = 10;
-static constexpr uint32_t kArm64CallLatency = 5;
-
-// AArch64 instruction latency.
-// We currently assume that all arm64 CPUs share the same instruction latency list.
-static constexpr uint32_t kArm64IntegerOpLatency = 2;
-static constexpr uint32_t kArm64FloatingPointOpLatency = 5;
-
-
-static constexpr uint32_t kArm64DataProcWithShifterOpLatency = 3;
-static constexpr uint32_t kArm64DivDoubleLatency = 30;
-static constexpr uint32_t kArm64DivFloatLatency = 15;
-static constexpr uint32_t kArm64DivIntegerLatency = 5;
-static constexpr uint32_t kArm64LoadStringInternalLatency = 7;
-static constexpr uint32_t kArm64MulFloatingPointLatency = 6;
-static constexpr uint32_t kArm64MulIntegerLatency = 6;
-static constexpr uint32_t kArm64TypeConversionFloatingPointIntegerLatency = 5;
-static constexpr uint32_t kArm64BranchLatency = kArm64IntegerOpLatency;
-
-static constexpr uint32_t kArm64SIMDFloatingPointOpLatency = 10;
-static constexpr uint32_t kArm64SIMDIntegerOpLatency = 6;
-static constexpr uint32_t kArm64SIMDMemoryLoadLatency = 10;
-static constexpr uint32_t kArm64SIMDMemoryStoreLatency = 6;
-static constexpr uint32_t kArm64SIMDMulFloatingPointLatency = 12;
-static constexpr uint32_t kArm64SIMDMulIntegerLatency = 12;
-static constexpr uint32_t kArm64SIMDReplicateOpLatency = 16;
-static constexpr uint32_t kArm64SIMDDivDoubleLatency = 60;
-static constexpr uint32_t kArm64SIMDDivFloatLatency = 30;
-static constexpr uint32_t kArm64SIMDTypeConversionInt2FPLatency = 10;
+// Latencies of AArch64 instructions, in cycles, as modeled by the scheduler.
+struct Arm64Latencies {
+  uint32_t memory_load;
+  uint32_t memory_store;
+  uint32_t call_internal;
+  uint32_t call;
+  uint32_t integer_op;
+  uint32_t floating_point_op;
+  uint32_t data_proc_with_shifter_op;
+  uint32_t div_double;
+  uint32_t div_float;
+  uint32_t div_integer;
+  uint32_t load_string_internal;
+  uint32_t mul_floating_point;
+  uint32_t mul_integer;
+  uint32_t type_conversion_floating_point_integer;
+  uint32_t branch;
+  uint32_t simd_floating_point_op;
+  uint32_t simd_integer_op;
+  uint32_t simd_memory_load;
+  uint32_t simd_memory_store;
+  uint32_t simd_mul_floating_point;
+  uint32_t simd_mul_integer;
+  uint32_t simd_replicate_op;
+  uint32_t simd_div_double;
+  uint32_t simd_div_float;
+  uint32_t simd_type_conversion_int_to_fp;
+};
+
+// The latencies used when the pipeline of the CPU is unknown. This is a single list for
+// all arm64 CPUs, so it errs on the side of long latencies.
+static constexpr Arm64Latencies kArm64GenericLatencies = {
+  5,   // memory_load
+  3,   // memory_store
+  10,  // call_internal
+  5,   // call
+  2,   // integer_op
+  5,   // floating_point_op
+  3,   // data_proc_with_shifter_op
+  30,  // div_double
+  15,  // div_float
+  5,   // div_integer
+  7,   // load_string_internal
+  6,   // mul_floating_point
+  6,   // mul_integer
+  5,   // type_conversion_floating_point_integer
+  2,   // branch
+  10,  // simd_floating_point_op
+  6,   // simd_integer_op
+  10,  // simd_memory_load
+  6,   // simd_memory_store
+  12,  // simd_mul_floating_point
+  12,  // simd_mul_integer
+  16,  // simd_replicate_op
+  60,  // simd_div_double
+  30,  // simd_div_float
+  10,  // simd_type_conversion_int_to_fp
+};
+
+// In-order cores like Cortex-A53 and Cortex-A55 stall on every use of a result that is not
+// ready, so this model stresses the long latencies of loads and floating point operations.
+static constexpr Arm64Latencies kArm64InOrderLatencies = {
+  6,   // memory_load
+  3,   // memory_store
+  10,  // call_internal
+  5,   // call
+  2,   // integer_op
+  6,   // floating_point_op
+  4,   // data_proc_with_shifter_op
+  44,  // div_double
+  26,  // div_float
+  12,  // div_integer
+  7,   // load_string_internal
+  8,   // mul_floating_point
+  6,   // mul_integer
+  8,   // type_conversion_floating_point_integer
+  2,   // branch
+  8,   // simd_floating_point_op
+  4,   // simd_integer_op
+  8,   // simd_memory_load
+  4,   // simd_memory_store
+  8,   // simd_mul_floating_point
+  8,   // simd_mul_integer
+  16,  // simd_replicate_op
+  88,  // simd_div_double
+  52,  // simd_div_float
+  8,   // simd_type_conversion_int_to_fp
+};
+
+// Out-of-order cores like Cortex-A76 hide most latencies themselves, so this model only
+// separates long latency instructions from their uses, to keep register pressure low.
+static constexpr Arm64Latencies kArm64OutOfOrderLatencies = {
+  4,   // memory_load
+  1,   // memory_store
+  10,  // call_internal
+  5,   // call
+  1,   // integer_op
+  3,   // floating_point_op
+  2,   // data_proc_with_shifter_op
+  15,  // div_double
+  10,  // div_float
+  12,  // div_integer
+  7,   // load_string_internal
+  3,   // mul_floating_point
+  3,   // mul_integer
+  3,   // type_conversion_floating_point_integer
+  1,   // branch
+  3,   // simd_floating_point_op
+  2,   // simd_integer_op
+  6,   // simd_memory_load
+  2,   // simd_memory_store
+  4,   // simd_mul_floating_point
+  4,   // simd_mul_integer
+  8,   // simd_replicate_op
+  30,  // simd_div_double
+  20,  // simd_div_float
+  4,   // simd_type_conversion_int_to_fp
+};
 
 class SchedulingLatencyVisitorARM64 : public SchedulingLatencyVisitor {
  public:
+  explicit SchedulingLatencyVisitorARM64(const Arm64Latencies& latencies = kArm64GenericLatencies)
+      : latencies_(latencies) {}
+
+  // Returns the latency model for the CPU described by `features`, which may be null.
+  static const Arm64Latencies& GetLatencies(const Arm64InstructionSetFeatures* features);
+
   // Default visitor for instructions not handled specifically below.
   void VisitInstruction(HInstruction* ATTRIBUTE_UNUSED) {
-    last_visited_latency_ = kArm64IntegerOpLatency;
+    last_visited_latency_ = latencies_.integer_op;
   }
 
 // We add a second unused parameter to be able to use this macro like the others
@@ -103,6 +196,8 @@ class SchedulingLatencyVisitorARM64 : public SchedulingLatencyVisitor {
   M(VecShl               , unused)                   \
   M(VecShr               , unused)                   \
   M(VecUShr              , unused)                   \
+  M(VecCondition         , unused)                   \
+  M(VecSelect            , unused)                   \
   M(VecSetScalars        , unused)                   \
   M(VecMultiplyAccumulate, unused)                   \
   M(VecLoad              , unused)                   \
@@ -127,12 +222,17 @@ class SchedulingLatencyVisitorARM64 : public SchedulingLatencyVisitor {
  private:
   void HandleSimpleArithmeticSIMD(HVecOperation *instr);
   void HandleVecAddress(HVecMemoryOperation* instruction, size_t size);
+
+  const Arm64Latencies& latencies_;
 };
 
 class HSchedulerARM64 : public HScheduler {
  public:
-  HSchedulerARM64(ScopedArenaAllocator* allocator, SchedulingNodeSelector* selector)
-      : HScheduler(allocator, &arm64_latency_visitor_, selector) {}
+  HSchedulerARM64(ScopedArenaAllocator* allocator,
+                  SchedulingNodeSelector* selector,
+                  const Arm64InstructionSetFeatures* features = nullptr)
+      : HScheduler(allocator, &arm64_latency_visitor_, selector),
+        arm64_latency_visitor_(SchedulingLatencyVisitorARM64::GetLatencies(features)) {}
   ~HSchedulerARM64() OVERRIDE {}
 
   bool IsSchedulable(const HInstruction* instruction) const OVERRIDE {
@@ -34,6 +34,10 @@
 #include "scheduler_arm.h"
 #endif
 
+#ifdef ART_ENABLE_CODEGEN_x86_64
+#include "scheduler_x86_64.h"
+#endif
+
 namespace art {
 
 // Return all combinations of ISA and code generator that are executable on
@@ -363,6 +367,47 @@ TEST_F(SchedulerTest, ArrayAccessAliasingARM64) {
 }
 #endif
 
+#if defined(ART_ENABLE_CODEGEN_arm64)
+TEST_F(SchedulerTest, LatencyModelsARM64) {
+  std::string error_msg;
+  std::unique_ptr<const Arm64InstructionSetFeatures> in_order(
+      Arm64InstructionSetFeatures::FromVariant("cortex-a55", &error_msg));
+  std::unique_ptr<const Arm64InstructionSetFeatures> out_of_order(
+      Arm64InstructionSetFeatures::FromVariant("cortex-a76", &error_msg));
+  std::unique_ptr<const Arm64InstructionSetFeatures> generic(
+      Arm64InstructionSetFeatures::FromVariant("generic", &error_msg));
+  ASSERT_TRUE(in_order != nullptr && out_of_order != nullptr && generic != nullptr) << error_msg;
+  using Visitor = arm64::SchedulingLatencyVisitorARM64;
+  EXPECT_EQ(arm64::kArm64InOrderLatencies.memory_load,
+            Visitor::GetLatencies(in_order.get()).memory_load);
+  EXPECT_EQ(arm64::kArm64OutOfOrderLatencies.memory_load,
+            Visitor::GetLatencies(out_of_order.get()).memory_load);
+  EXPECT_EQ(arm64::kArm64GenericLatencies.memory_load,
+            Visitor::GetLatencies(generic.get()).memory_load);
+  EXPECT_EQ(arm64::kArm64GenericLatencies.memory_load,
+            Visitor::GetLatencies(nullptr).memory_load);
+
+  // Exercise the scheduler with a model other than the generic one.
+  CriticalPathSchedulingNodeSelector critical_path_selector;
+  arm64::HSchedulerARM64 scheduler(GetScopedAllocator(), &critical_path_selector, in_order.get());
+  TestBuildDependencyGraphAndSchedule(&scheduler);
+}
+#endif
+
+#if defined(ART_ENABLE_CODEGEN_x86_64)
+TEST_F(SchedulerTest, DependencyGraphAndSchedulerX86_64) {
+  CriticalPathSchedulingNodeSelector critical_path_selector;
+  x86_64::HSchedulerX86_64 scheduler(GetScopedAllocator(), &critical_path_selector);
+  TestBuildDependencyGraphAndSchedule(&scheduler);
+}
+
+TEST_F(SchedulerTest, ArrayAccessAliasingX86_64) {
+  CriticalPathSchedulingNodeSelector critical_path_selector;
+  x86_64::HSchedulerX86_64 scheduler(GetScopedAllocator(), &critical_path_selector);
+  TestDependencyGraphOnAliasingArrayAccesses(&scheduler);
+}
+#endif
+
 #if defined(ART_ENABLE_CODEGEN_arm)
 TEST_F(SchedulerTest, DependencyGraphAndSchedulerARM) {
   CriticalPathSchedulingNodeSelector critical_path_selector;
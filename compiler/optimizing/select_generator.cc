@@ -16,12 +16,23 @@
 
 #include "select_generator.h"
 
+#include <algorithm>
+
+#include "base/scoped_arena_allocator.h"
+#include "base/scoped_arena_containers.h"
 #include "reference_type_propagation.h"
 
 namespace art {
 
 static constexpr size_t kMaxInstructionsInBranch = 1u;
 
+// Branches consisting only of cheap instructions (see `IsCheapInstruction`)
+// may be longer, as speculatively executing them costs less than a mispredict.
+static constexpr size_t kMaxCheapInstructionsInBranch = 3u;
+
+// Maximum number of Phis, and therefore Selects, generated for one diamond.
+static constexpr size_t kMaxSelectsPerDiamond = 2u;
+
 HSelectGenerator::HSelectGenerator(HGraph* graph,
                                    VariableSizedHandleScope* handles,
                                    OptimizingCompilerStats* stats,
@@ -30,9 +41,19 @@ HSelectGenerator::HSelectGenerator(HGraph* graph,
       handle_scope_(handles) {
 }
 
+// Returns true if `instruction` is cheap to execute unconditionally, i.e. it
+// neither reads memory nor is a slow arithmetic operation.
+static bool IsCheapInstruction(HInstruction* instruction) {
+  return !instruction->GetSideEffects().HasDependencies() &&
+      !instruction->CanThrow() &&
+      !instruction->IsDiv() &&
+      !instruction->IsRem();
+}
+
 // Returns true if `block` has only one predecessor, ends with a Goto
 // or a Return and contains at most `kMaxInstructionsInBranch` other
-// movable instruction with no side-effects.
+// movable instruction with no side-effects, or at most
+// `kMaxCheapInstructionsInBranch` cheap ones.
 static bool IsSimpleBlock(HBasicBlock* block) {
   if (block->GetPredecessors().size() != 1u) {
     return false;
@@ -40,15 +61,18 @@ static bool IsSimpleBlock(HBasicBlock* block) {
   DCHECK(block->GetPhis().IsEmpty());
 
   size_t num_instructions = 0u;
+  bool all_cheap = true;
   for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
     HInstruction* instruction = it.Current();
     if (instruction->IsControlFlow()) {
-      if (num_instructions > kMaxInstructionsInBranch) {
+      if (num_instructions > kMaxInstructionsInBranch &&
+          (!all_cheap || num_instructions > kMaxCheapInstructionsInBranch)) {
         return false;
       }
       return instruction->IsGoto() || instruction->IsReturn();
     } else if (instruction->CanBeMoved() && !instruction->HasSideEffects()) {
       num_instructions++;
+      all_cheap = all_cheap && IsCheapInstruction(instruction);
     } else {
       return false;
     }
@@ -64,31 +88,56 @@ static bool BlocksMergeTogether(HBasicBlock* block1, HBasicBlock* block2) {
   return block1->GetSingleSuccessor() == block2->GetSingleSuccessor();
 }
 
-// Returns nullptr if `block` has either no phis or there is more than one phi
-// with different inputs at `index1` and `index2`. Otherwise returns that phi.
-static HPhi* GetSingleChangedPhi(HBasicBlock* block, size_t index1, size_t index2) {
+// Collects the phis of `block` with different inputs at `index1` and `index2`
+// into `phis`. Returns false if there are more than `kMaxSelectsPerDiamond`
+// such phis.
+static bool GetChangedPhis(HBasicBlock* block,
+                           size_t index1,
+                           size_t index2,
+                           ScopedArenaVector<HPhi*>* phis) {
   DCHECK_NE(index1, index2);
+  DCHECK(phis->empty());
 
-  HPhi* select_phi = nullptr;
   for (HInstructionIterator it(block->GetPhis()); !it.Done(); it.Advance()) {
     HPhi* phi = it.Current()->AsPhi();
     if (phi->InputAt(index1) != phi->InputAt(index2)) {
-      if (select_phi == nullptr) {
-        // First phi with different inputs for the two indices found.
-        select_phi = phi;
-      } else {
-        // More than one phis has different inputs for the two indices.
-        return nullptr;
+      if (phis->size() == kMaxSelectsPerDiamond) {
+        return false;
       }
+      phis->push_back(phi);
     }
   }
-  return select_phi;
+  return true;
+}
+
+// Moves the non-control-flow instructions of `branch` in front of `if_instruction`.
+// If possible, they are placed before the condition so that it stays next to its
+// user and can still be emitted at use site.
+static void MoveBranchInstructions(HBasicBlock* branch, HIf* if_instruction) {
+  HInstruction* cursor = if_instruction;
+  HInstruction* condition = if_instruction->InputAt(0);
+  if (condition->GetNext() == if_instruction) {
+    cursor = condition;
+    for (HInstructionIterator it(branch->GetInstructions()); !it.Done(); it.Advance()) {
+      for (HInstruction* input : it.Current()->GetInputs()) {
+        if (input == condition) {
+          cursor = if_instruction;
+        }
+      }
+    }
+  }
+  while (!branch->IsSingleGoto() && !branch->IsSingleReturn()) {
+    branch->GetFirstInstruction()->MoveBefore(cursor);
+  }
 }
 
 void HSelectGenerator::Run() {
-  // Iterate in post order in the unlikely case that removing one occurrence of
-  // the selection pattern empties a branch block of another occurrence.
-  // Otherwise the order does not matter.
+  ScopedArenaAllocator allocator(graph_->GetArenaStack());
+  ScopedArenaVector<HPhi*> phis(allocator.Adapter(kArenaAllocOptimization));
+
+  // Iterate in post order so that inner diamonds are simplified first and
+  // their resulting Selects become part of simple branches of outer ones,
+  // which lets chains of conditional expressions turn into chains of Selects.
   for (HBasicBlock* block : graph_->GetPostOrder()) {
     if (!block->EndsWithIf()) continue;
 
@@ -104,63 +153,60 @@ void HSelectGenerator::Run() {
     }
     HBasicBlock* merge_block = true_block->GetSingleSuccessor();
 
-    // If the branches are not empty, move instructions in front of the If.
-    // TODO(dbrazdil): This puts an instruction between If and its condition.
-    //                 Implement moving of conditions to first users if possible.
-    if (!true_block->IsSingleGoto() && !true_block->IsSingleReturn()) {
-      true_block->GetFirstInstruction()->MoveBefore(if_instruction);
-    }
-    if (!false_block->IsSingleGoto() && !false_block->IsSingleReturn()) {
-      false_block->GetFirstInstruction()->MoveBefore(if_instruction);
-    }
-    DCHECK(true_block->IsSingleGoto() || true_block->IsSingleReturn());
-    DCHECK(false_block->IsSingleGoto() || false_block->IsSingleReturn());
-
     // Find the resulting true/false values.
     size_t predecessor_index_true = merge_block->GetPredecessorIndexOf(true_block);
     size_t predecessor_index_false = merge_block->GetPredecessorIndexOf(false_block);
     DCHECK_NE(predecessor_index_true, predecessor_index_false);
 
-    bool both_successors_return = true_block->IsSingleReturn() && false_block->IsSingleReturn();
-    HPhi* phi = GetSingleChangedPhi(merge_block, predecessor_index_true, predecessor_index_false);
-
-    HInstruction* true_value = nullptr;
-    HInstruction* false_value = nullptr;
-    if (both_successors_return) {
-      true_value = true_block->GetFirstInstruction()->InputAt(0);
-      false_value = false_block->GetFirstInstruction()->InputAt(0);
-    } else if (phi != nullptr) {
-      true_value = phi->InputAt(predecessor_index_true);
-      false_value = phi->InputAt(predecessor_index_false);
-    } else {
+    bool both_successors_return = true_block->GetLastInstruction()->IsReturn() &&
+        false_block->GetLastInstruction()->IsReturn();
+    phis.clear();
+    if (!both_successors_return &&
+        (!GetChangedPhis(merge_block, predecessor_index_true, predecessor_index_false, &phis) ||
+         phis.empty())) {
       continue;
     }
-    DCHECK(both_successors_return || phi != nullptr);
 
-    // Create the Select instruction and insert it in front of the If.
-    HSelect* select = new (graph_->GetAllocator()) HSelect(if_instruction->InputAt(0),
-                                                           true_value,
-                                                           false_value,
-                                                           if_instruction->GetDexPc());
+    // If the branches are not empty, move instructions in front of the If.
+    MoveBranchInstructions(true_block, if_instruction);
+    MoveBranchInstructions(false_block, if_instruction);
+    DCHECK(true_block->IsSingleGoto() || true_block->IsSingleReturn());
+    DCHECK(false_block->IsSingleGoto() || false_block->IsSingleReturn());
+
     if (both_successors_return) {
+      HInstruction* true_value = true_block->GetFirstInstruction()->InputAt(0);
+      HInstruction* false_value = false_block->GetFirstInstruction()->InputAt(0);
+      // Create the Select instruction and insert it in front of the If.
+      HSelect* select = new (graph_->GetAllocator()) HSelect(if_instruction->InputAt(0),
+                                                             true_value,
+                                                             false_value,
+                                                             if_instruction->GetDexPc());
       if (true_value->GetType() == DataType::Type::kReference) {
         DCHECK(false_value->GetType() == DataType::Type::kReference);
         ReferenceTypePropagation::FixUpInstructionType(select, handle_scope_);
       }
-    } else if (phi->GetType() == DataType::Type::kReference) {
-      select->SetReferenceTypeInfo(phi->GetReferenceTypeInfo());
-    }
-    block->InsertInstructionBefore(select, if_instruction);
-
-    // Remove the true branch which removes the corresponding Phi
-    // input if needed. If left only with the false branch, the Phi is
-    // automatically removed.
-    if (both_successors_return) {
+      block->InsertInstructionBefore(select, if_instruction);
       false_block->GetFirstInstruction()->ReplaceInput(select, 0);
     } else {
-      phi->ReplaceInput(select, predecessor_index_false);
+      for (HPhi* phi : phis) {
+        // Create the Select instruction and insert it in front of the If.
+        HInstruction* true_value = phi->InputAt(predecessor_index_true);
+        HInstruction* false_value = phi->InputAt(predecessor_index_false);
+        HSelect* select = new (graph_->GetAllocator()) HSelect(if_instruction->InputAt(0),
+                                                               true_value,
+                                                               false_value,
+                                                               if_instruction->GetDexPc());
+        if (phi->GetType() == DataType::Type::kReference) {
+          select->SetReferenceTypeInfo(phi->GetReferenceTypeInfo());
+        }
+        block->InsertInstructionBefore(select, if_instruction);
+        phi->ReplaceInput(select, predecessor_index_false);
+      }
     }
 
+    // Remove the true branch which removes the corresponding Phi
+    // inputs if needed. If left only with the false branch, the Phis are
+    // automatically removed.
     bool only_two_predecessors = (merge_block->GetPredecessors().size() == 2u);
     true_block->DisconnectAndDelete();
 
@@ -168,12 +214,16 @@ void HSelectGenerator::Run() {
     DCHECK_EQ(block->GetSingleSuccessor(), false_block);
     block->MergeWith(false_block);
     if (!both_successors_return && only_two_predecessors) {
-      DCHECK_EQ(only_two_predecessors, phi->GetBlock() == nullptr);
+      DCHECK(std::all_of(phis.begin(), phis.end(), [](HPhi* phi) {
+        return phi->GetBlock() == nullptr;
+      }));
       DCHECK_EQ(block->GetSingleSuccessor(), merge_block);
       block->MergeWith(merge_block);
     }
 
-    MaybeRecordStat(stats_, MethodCompilationStat::kSelectGenerated);
+    MaybeRecordStat(stats_,
+                    MethodCompilationStat::kSelectGenerated,
+                    both_successors_return ? 1u : phis.size());
 
     // No need to update dominance information, as we are simplifying
     // a simple diamond shape, where the join block is merged with the
@@ -34,7 +34,12 @@
  *     return FalseValue   return TrueValue
  *
  * The pattern will be simplified if `true_branch` and `false_branch` each
- * contain at most one instruction without any side effects.
+ * contain at most one instruction without any side effects, or a few cheap
+ * ones which neither read memory nor can throw. At most two Phis may have
+ * different inputs, each of them is replaced by its own Select.
+ *
+ * Diamonds are processed inner first, so nested conditional expressions such
+ * as min/max/clamp idioms turn into chains of Selects.
  *
  * Blocks are merged into one and Select replaces the If and the Phi.
  *
@@ -111,11 +111,14 @@ void StackMapStream::AddInvoke(InvokeType invoke_type, uint32_t dex_method_index
 void StackMapStream::BeginInlineInfoEntry(ArtMethod* method,
                                           uint32_t dex_pc,
                                           uint32_t num_dex_registers,
-                                          const DexFile* outer_dex_file) {
+                                          const DexFile* outer_dex_file,
+                                          uint32_t method_index) {
   DCHECK(!in_inline_frame_);
   in_inline_frame_ = true;
   if (EncodeArtMethodInInlineInfo(method)) {
     current_inline_info_.method = method;
+  } else if (method_index != dex::kDexNoIndex) {
+    current_inline_info_.method_index = method_index;
   } else {
     if (dex_pc != static_cast<uint32_t>(-1) && kIsDebugBuild) {
       ScopedObjectAccess soa(Thread::Current());
@@ -154,13 +157,23 @@ CodeOffset StackMapStream::ComputeMaxNativePcCodeOffset() const {
   return max_native_pc_offset;
 }
 
+size_t StackMapStream::ComputeNumSortedStackMaps() const {
+  size_t num_sorted = std::min<size_t>(stack_maps_.size(), 1u);
+  while (num_sorted != stack_maps_.size() &&
+         stack_maps_[num_sorted - 1u].native_pc_code_offset <=
+             stack_maps_[num_sorted].native_pc_code_offset) {
+    ++num_sorted;
+  }
+  return num_sorted;
+}
+
 size_t StackMapStream::PrepareForFillIn() {
   CodeInfoEncoding encoding;
   encoding.dex_register_map.num_entries = 0;  // TODO: Remove this field.
   encoding.dex_register_map.num_bytes = ComputeDexRegisterMapsSize();
   encoding.location_catalog.num_entries = location_catalog_entries_.size();
   encoding.location_catalog.num_bytes = ComputeDexRegisterLocationCatalogSize();
-  encoding.inline_info.num_entries = inline_infos_.size();
+  encoding.inline_info.num_entries = PrepareInlineInfos();
   // Must be done before calling ComputeInlineInfoEncoding since ComputeInlineInfoEncoding requires
   // dex_method_index_idx to be filled in.
   PrepareMethodIndices();
@@ -173,6 +186,7 @@ size_t StackMapStream::PrepareForFillIn() {
   encoding.register_mask.encoding.num_bits = MinimumBitsToStore(register_mask_max_);
   encoding.register_mask.num_entries = PrepareRegisterMasks();
   encoding.stack_map.num_entries = stack_maps_.size();
+  encoding.num_sorted_stack_maps = ComputeNumSortedStackMaps();
   encoding.stack_map.encoding.SetFromSizes(
       // The stack map contains compressed native PC offsets.
       max_native_pc_offset.CompressedValue(),
@@ -252,26 +266,21 @@ void StackMapStream::ComputeInlineInfoEncoding(InlineInfoEncoding* encoding,
   uint32_t dex_pc_max = dex::kDexNoIndex;
   uint32_t extra_data_max = 0;
 
-  uint32_t inline_info_index = 0;
-  for (const StackMapEntry& entry : stack_maps_) {
-    for (size_t j = 0; j < entry.inlining_depth; ++j) {
-      InlineInfoEntry inline_entry = inline_infos_[inline_info_index++];
-      if (inline_entry.method == nullptr) {
-        method_index_max = std::max(method_index_max, inline_entry.dex_method_index_idx);
-        extra_data_max = std::max(extra_data_max, 1u);
-      } else {
-        method_index_max = std::max(
-            method_index_max, High32Bits(reinterpret_cast<uintptr_t>(inline_entry.method)));
-        extra_data_max = std::max(
-            extra_data_max, Low32Bits(reinterpret_cast<uintptr_t>(inline_entry.method)));
-      }
-      if (inline_entry.dex_pc != dex::kDexNoIndex &&
-          (dex_pc_max == dex::kDexNoIndex || dex_pc_max < inline_entry.dex_pc)) {
-        dex_pc_max = inline_entry.dex_pc;
-      }
+  for (const InlineInfoEntry& inline_entry : inline_infos_) {
+    if (inline_entry.method == nullptr) {
+      method_index_max = std::max(method_index_max, inline_entry.dex_method_index_idx);
+      extra_data_max = std::max(extra_data_max, 1u);
+    } else {
+      method_index_max = std::max(
+          method_index_max, High32Bits(reinterpret_cast<uintptr_t>(inline_entry.method)));
+      extra_data_max = std::max(
+          extra_data_max, Low32Bits(reinterpret_cast<uintptr_t>(inline_entry.method)));
+    }
+    if (inline_entry.dex_pc != dex::kDexNoIndex &&
+        (dex_pc_max == dex::kDexNoIndex || dex_pc_max < inline_entry.dex_pc)) {
+      dex_pc_max = inline_entry.dex_pc;
     }
   }
-  DCHECK_EQ(inline_info_index, inline_infos_.size());
 
   encoding->SetFromSizes(method_index_max, dex_pc_max, extra_data_max, dex_register_maps_bytes);
 }
@@ -381,11 +390,15 @@ void StackMapStream::FillInCodeInfo(MemoryRegion region) {
 
     // Set the inlining info.
     if (entry.inlining_depth != 0) {
-      InlineInfo inline_info = code_info.GetInlineInfo(next_inline_info_index, encoding);
+      InlineInfo inline_info = code_info.GetInlineInfo(entry.inline_infos_start_index, encoding);
 
       // Fill in the index.
-      stack_map.SetInlineInfoIndex(encoding.stack_map.encoding, next_inline_info_index);
-      DCHECK_EQ(next_inline_info_index, entry.inline_infos_start_index);
+      stack_map.SetInlineInfoIndex(encoding.stack_map.encoding, entry.inline_infos_start_index);
+      if (entry.inline_infos_start_index != next_inline_info_index) {
+        // Shares the inline info of an earlier stack map, which has already been written.
+        DCHECK_LT(entry.inline_infos_start_index, next_inline_info_index);
+        continue;
+      }
       next_inline_info_index += entry.inlining_depth;
 
       inline_info.SetDepth(encoding.inline_info.encoding, entry.inlining_depth);
@@ -585,6 +598,73 @@ void StackMapStream::PrepareMethodIndices() {
   method_indices_.resize(dedupe.size());
 }
 
+size_t StackMapStream::PrepareInlineInfos() {
+  if (number_of_stack_maps_with_inline_info_ <= 1u) {
+    return inline_infos_.size();
+  }
+  ScopedArenaVector<InlineInfoEntry> unique_inline_infos(
+      allocator_->Adapter(kArenaAllocStackMapStream));
+  unique_inline_infos.reserve(inline_infos_.size());
+  // Chains are keyed by a hash of their depth and innermost frame; collisions are resolved by
+  // comparing the whole chain against each candidate (start index, depth) in
+  // `unique_inline_infos`.
+  using Candidates = ScopedArenaVector<std::pair<size_t, size_t>>;
+  ScopedArenaSafeMap<uint32_t, Candidates> hash_to_candidates(
+      std::less<uint32_t>(), allocator_->Adapter(kArenaAllocStackMapStream));
+  for (StackMapEntry& stack_map : stack_maps_) {
+    const size_t depth = stack_map.inlining_depth;
+    if (depth == 0u) {
+      continue;
+    }
+    const size_t start = stack_map.inline_infos_start_index;
+    DCHECK_LE(start + depth, inline_infos_.size());
+    const InlineInfoEntry& innermost = inline_infos_[start + depth - 1u];
+    const uint32_t hash = static_cast<uint32_t>(depth) * 31u +
+        innermost.dex_pc * 17u +
+        static_cast<uint32_t>(innermost.dex_register_map_index);
+    auto it = hash_to_candidates.find(hash);
+    if (it == hash_to_candidates.end()) {
+      it = hash_to_candidates.Put(
+          hash, Candidates(allocator_->Adapter(kArenaAllocStackMapStream)));
+    }
+    size_t unique_start = unique_inline_infos.size();
+    for (const std::pair<size_t, size_t>& candidate : it->second) {
+      if (candidate.second == depth &&
+          InlineInfoChainEquals(
+              unique_inline_infos, candidate.first, inline_infos_, start, depth)) {
+        unique_start = candidate.first;
+        break;
+      }
+    }
+    if (unique_start == unique_inline_infos.size()) {
+      unique_inline_infos.insert(unique_inline_infos.end(),
+                                 inline_infos_.begin() + start,
+                                 inline_infos_.begin() + start + depth);
+      it->second.push_back(std::make_pair(unique_start, depth));
+    }
+    stack_map.inline_infos_start_index = unique_start;
+  }
+  inline_infos_.swap(unique_inline_infos);
+  return inline_infos_.size();
+}
+
+bool StackMapStream::InlineInfoChainEquals(const ScopedArenaVector<InlineInfoEntry>& a,
+                                           size_t a_start,
+                                           const ScopedArenaVector<InlineInfoEntry>& b,
+                                           size_t b_start,
+                                           size_t depth) {
+  for (size_t d = 0; d < depth; ++d) {
+    const InlineInfoEntry& a_entry = a[a_start + d];
+    const InlineInfoEntry& b_entry = b[b_start + d];
+    if (a_entry.dex_pc != b_entry.dex_pc ||
+        a_entry.method != b_entry.method ||
+        a_entry.method_index != b_entry.method_index ||
+        a_entry.dex_register_map_index != b_entry.dex_register_map_index) {
+      return false;
+    }
+  }
+  return true;
+}
 
 size_t StackMapStream::PrepareStackMasks(size_t entry_size_in_bits) {
   // Preallocate memory since we do not want it to move (the dedup map will point into it).
@@ -145,10 +145,14 @@ class StackMapStream : public ValueObject {
 
   void AddInvoke(InvokeType type, uint32_t dex_method_index);
 
+  // When not encoding the ArtMethod, `method_index` is the index the runtime looks
+  // up in the dex cache of the caller to find `method`. If it is dex::kDexNoIndex,
+  // the method must come from `outer_dex_file` and its own index is used.
   void BeginInlineInfoEntry(ArtMethod* method,
                             uint32_t dex_pc,
                             uint32_t num_dex_registers,
-                            const DexFile* outer_dex_file = nullptr);
+                            const DexFile* outer_dex_file = nullptr,
+                            uint32_t method_index = dex::kDexNoIndex);
   void EndInlineInfoEntry();
 
   size_t GetNumberOfStackMaps() const {
@@ -179,6 +183,9 @@ class StackMapStream : public ValueObject {
                                  size_t dex_register_maps_bytes);
 
   CodeOffset ComputeMaxNativePcCodeOffset() const;
+  // Number of leading stack maps whose native pc offsets do not decrease, which
+  // CodeInfo::GetStackMapForNativePcOffset() binary searches.
+  size_t ComputeNumSortedStackMaps() const;
 
   // Returns the number of unique stack masks.
   size_t PrepareStackMasks(size_t entry_size_in_bits);
@@ -189,6 +196,19 @@ class StackMapStream : public ValueObject {
   // Prepare and deduplicate method indices.
   void PrepareMethodIndices();
 
+  // Deduplicate the inline info chains of stack maps that describe the same inlined frames
+  // (e.g. an implicit null check and the call it guards). Returns the number of inline info
+  // entries left.
+  size_t PrepareInlineInfos();
+
+  // Return true if the inline info chains of length `depth` starting at `a_start` in `a` and
+  // at `b_start` in `b` are equal.
+  static bool InlineInfoChainEquals(const ScopedArenaVector<InlineInfoEntry>& a,
+                                    size_t a_start,
+                                    const ScopedArenaVector<InlineInfoEntry>& b,
+                                    size_t b_start,
+                                    size_t depth);
+
   // Deduplicate entry if possible and return the corresponding index into dex_register_entries_
   // array. If entry is not a duplicate, a new entry is added to dex_register_entries_.
   size_t AddDexRegisterMapEntry(const DexRegisterMapEntry& entry);
@@ -977,6 +977,112 @@ TEST(StackMapTest, TestDeduplicateStackMask) {
             stack_map2.GetStackMaskIndex(encoding.stack_map.encoding));
 }
 
+TEST(StackMapTest, TestNativePcOffsetLookup) {
+  ArenaPool pool;
+  ArenaStack arena_stack(&pool);
+  ScopedArenaAllocator allocator(&arena_stack);
+  StackMapStream stream(&allocator, kRuntimeISA);
+
+  ArenaBitVector sp_mask(&allocator, 0, true);
+  // Safepoints in code order, two of them at the same native pc...
+  const uint32_t kSafepointPcs[] = { 8, 16, 16, 32, 48, 64, 96 };
+  for (size_t i = 0; i != arraysize(kSafepointPcs); ++i) {
+    stream.BeginStackMapEntry(i, kSafepointPcs[i], 0x3, &sp_mask, 0, 0);
+    stream.EndStackMapEntry();
+  }
+  // ... then catch stack maps, which are not sorted with the others.
+  stream.BeginStackMapEntry(100, 40, 0x3, &sp_mask, 0, 0);
+  stream.EndStackMapEntry();
+  stream.BeginStackMapEntry(101, 24, 0x3, &sp_mask, 0, 0);
+  stream.EndStackMapEntry();
+  stream.BeginStackMapEntry(102, 64, 0x3, &sp_mask, 0, 0);
+  stream.EndStackMapEntry();
+
+  size_t size = stream.PrepareForFillIn();
+  void* memory = allocator.Alloc(size, kArenaAllocMisc);
+  MemoryRegion region(memory, size);
+  stream.FillInCodeInfo(region);
+
+  CodeInfo code_info(region);
+  CodeInfoEncoding encoding = code_info.ExtractEncoding();
+  ASSERT_EQ(10u, code_info.GetNumberOfStackMaps(encoding));
+  ASSERT_EQ(arraysize(kSafepointPcs), encoding.num_sorted_stack_maps);
+  const StackMapEncoding& stack_map_encoding = encoding.stack_map.encoding;
+
+  // The first stack map with a native pc is found, as with a linear search.
+  for (size_t i = 0; i != arraysize(kSafepointPcs); ++i) {
+    StackMap stack_map = code_info.GetStackMapForNativePcOffset(kSafepointPcs[i], encoding);
+    ASSERT_TRUE(stack_map.IsValid());
+    EXPECT_EQ(kSafepointPcs[i] == 16u ? 1u : i, stack_map.GetDexPc(stack_map_encoding));
+  }
+  StackMap catch_stack_map = code_info.GetStackMapForNativePcOffset(40, encoding);
+  EXPECT_EQ(100u, catch_stack_map.GetDexPc(stack_map_encoding));
+  catch_stack_map = code_info.GetStackMapForNativePcOffset(24, encoding);
+  EXPECT_EQ(101u, catch_stack_map.GetDexPc(stack_map_encoding));
+  EXPECT_FALSE(code_info.GetStackMapForNativePcOffset(4, encoding).IsValid());
+  EXPECT_FALSE(code_info.GetStackMapForNativePcOffset(56, encoding).IsValid());
+  EXPECT_FALSE(code_info.GetStackMapForNativePcOffset(128, encoding).IsValid());
+}
+
+TEST(StackMapTest, TestDeduplicateInlineInfo) {
+  ArenaPool pool;
+  ArenaStack arena_stack(&pool);
+  ScopedArenaAllocator allocator(&arena_stack);
+  StackMapStream stream(&allocator, kRuntimeISA);
+  ArtMethod art_method;
+
+  ArenaBitVector sp_mask(&allocator, 0, true);
+  sp_mask.SetBit(1);
+  // Two stack maps with the same inlined frames, e.g. an implicit null check and a call.
+  for (uint32_t native_pc : { 4u, 8u }) {
+    stream.BeginStackMapEntry(0, native_pc, 0x3, &sp_mask, 1, 2);
+    stream.AddDexRegisterEntry(Kind::kInStack, 0);
+    stream.BeginInlineInfoEntry(&art_method, 2, 1);
+    stream.AddDexRegisterEntry(Kind::kInStack, 8);
+    stream.EndInlineInfoEntry();
+    stream.BeginInlineInfoEntry(&art_method, 3, 0);
+    stream.EndInlineInfoEntry();
+    stream.EndStackMapEntry();
+  }
+  // A stack map with a different innermost frame.
+  stream.BeginStackMapEntry(0, 12, 0x3, &sp_mask, 1, 2);
+  stream.AddDexRegisterEntry(Kind::kInStack, 0);
+  stream.BeginInlineInfoEntry(&art_method, 2, 1);
+  stream.AddDexRegisterEntry(Kind::kInStack, 8);
+  stream.EndInlineInfoEntry();
+  stream.BeginInlineInfoEntry(&art_method, 4, 0);
+  stream.EndInlineInfoEntry();
+  stream.EndStackMapEntry();
+
+  size_t size = stream.PrepareForFillIn();
+  void* memory = allocator.Alloc(size, kArenaAllocMisc);
+  MemoryRegion region(memory, size);
+  stream.FillInCodeInfo(region);
+
+  CodeInfo code_info(region);
+  CodeInfoEncoding encoding = code_info.ExtractEncoding();
+  ASSERT_EQ(3u, code_info.GetNumberOfStackMaps(encoding));
+  // The first two stack maps share their inline info entries.
+  ASSERT_EQ(4u, encoding.inline_info.num_entries);
+
+  StackMap stack_map1 = code_info.GetStackMapForNativePcOffset(4, encoding);
+  StackMap stack_map2 = code_info.GetStackMapForNativePcOffset(8, encoding);
+  StackMap stack_map3 = code_info.GetStackMapForNativePcOffset(12, encoding);
+  EXPECT_EQ(stack_map1.GetInlineInfoIndex(encoding.stack_map.encoding),
+            stack_map2.GetInlineInfoIndex(encoding.stack_map.encoding));
+  EXPECT_NE(stack_map1.GetInlineInfoIndex(encoding.stack_map.encoding),
+            stack_map3.GetInlineInfoIndex(encoding.stack_map.encoding));
+
+  InlineInfo inline_info2 = code_info.GetInlineInfoOf(stack_map2, encoding);
+  ASSERT_EQ(2u, inline_info2.GetDepth(encoding.inline_info.encoding));
+  EXPECT_EQ(2u, inline_info2.GetDexPcAtDepth(encoding.inline_info.encoding, 0));
+  EXPECT_EQ(3u, inline_info2.GetDexPcAtDepth(encoding.inline_info.encoding, 1));
+  InlineInfo inline_info3 = code_info.GetInlineInfoOf(stack_map3, encoding);
+  ASSERT_EQ(2u, inline_info3.GetDepth(encoding.inline_info.encoding));
+  EXPECT_EQ(2u, inline_info3.GetDexPcAtDepth(encoding.inline_info.encoding, 0));
+  EXPECT_EQ(4u, inline_info3.GetDexPcAtDepth(encoding.inline_info.encoding, 1));
+}
+
 TEST(StackMapTest, TestInvokeInfo) {
   ArenaPool pool;
   ArenaStack arena_stack(&pool);
@@ -397,7 +397,7 @@ void SuperblockCloner::ResolvePhi(HPhi* phi) {
 // Main algorithm methods.
 //
 
-void SuperblockCloner::SearchForSubgraphExits(ArenaVector<HBasicBlock*>* exits) {
+void SuperblockCloner::SearchForSubgraphExits(ArenaVector<HBasicBlock*>* exits) const {
   DCHECK(exits->empty());
   for (uint32_t block_id : orig_bb_set_.Indexes()) {
     HBasicBlock* block = GetBlockById(block_id);
@@ -503,6 +503,106 @@ void SuperblockCloner::ResolveDataFlow() {
   }
 }
 
+//
+// Helpers for live-outs processing.
+//
+
+bool SuperblockCloner::CollectLiveOutsAndCheckClonable(HInstructionMap* live_outs) const {
+  DCHECK(live_outs->empty());
+  for (uint32_t idx : orig_bb_set_.Indexes()) {
+    HBasicBlock* block = GetBlockById(idx);
+
+    for (HInstructionIterator it(block->GetPhis()); !it.Done(); it.Advance()) {
+      HInstruction* instr = it.Current();
+      DCHECK(instr->IsClonable());
+      if (IsUsedOutsideRegion(instr, orig_bb_set_)) {
+        live_outs->FindOrAdd(instr, instr);
+      }
+    }
+
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      HInstruction* instr = it.Current();
+      if (!instr->IsClonable()) {
+        return false;
+      }
+      if (IsUsedOutsideRegion(instr, orig_bb_set_)) {
+        // Users such as HNewInstance and HCheckCast require their class input to be the
+        // HLoadClass or HClinitCheck itself; it cannot be replaced with a phi.
+        if (instr->IsLoadClass() || instr->IsClinitCheck()) {
+          return false;
+        }
+        live_outs->FindOrAdd(instr, instr);
+      }
+    }
+  }
+  return true;
+}
+
+void SuperblockCloner::ConstructSubgraphClosedSSA() {
+  if (live_outs_.empty()) {
+    return;
+  }
+
+  ArenaVector<HBasicBlock*> exits(arena_->Adapter(kArenaAllocSuperblockCloner));
+  SearchForSubgraphExits(&exits);
+  DCHECK_EQ(exits.size(), 1u);
+  HBasicBlock* exit_block = exits[0];
+  // There should be no critical edges.
+  DCHECK_EQ(exit_block->GetPredecessors().size(), 1u);
+  DCHECK(exit_block->GetPhis().IsEmpty());
+
+  // For each live-out value insert a phi into the subgraph exit and replace all the value's uses
+  // outside of the subgraph with this phi. The phi has the original value as its only input;
+  // FixSubgraphClosedSSAAfterCloning adds the copy of the value as the second input.
+  for (auto live_out_it = live_outs_.begin(); live_out_it != live_outs_.end(); ++live_out_it) {
+    HInstruction* value = live_out_it->first;
+    HPhi* phi = new (arena_) HPhi(arena_, kNoRegNumber, 0, value->GetType());
+
+    if (value->GetType() == DataType::Type::kReference) {
+      phi->SetReferenceTypeInfo(value->GetReferenceTypeInfo());
+    }
+
+    exit_block->AddPhi(phi);
+    live_out_it->second = phi;
+
+    const HUseList<HInstruction*>& uses = value->GetUses();
+    for (auto it = uses.begin(), end = uses.end(); it != end; /* ++it below */) {
+      HInstruction* user = it->GetUser();
+      size_t index = it->GetIndex();
+      // Increment `it` now because `*it` may disappear thanks to user->ReplaceInput().
+      ++it;
+      if (!IsInOrigBBSet(user->GetBlock())) {
+        user->ReplaceInput(phi, index);
+      }
+    }
+
+    const HUseList<HEnvironment*>& env_uses = value->GetEnvUses();
+    for (auto it = env_uses.begin(), e = env_uses.end(); it != e; /* ++it below */) {
+      HEnvironment* env = it->GetUser();
+      size_t index = it->GetIndex();
+      // Increment `it` now because `*it` may disappear thanks to env->ReplaceInput().
+      ++it;
+      if (!IsInOrigBBSet(env->GetHolder()->GetBlock())) {
+        env->ReplaceInput(phi, index);
+      }
+    }
+
+    phi->AddInput(value);
+  }
+}
+
+void SuperblockCloner::FixSubgraphClosedSSAAfterCloning() {
+  for (auto it : live_outs_) {
+    DCHECK(it.first != it.second);
+    HInstruction* orig_value = it.first;
+    HPhi* phi = it.second->AsPhi();
+    HInstruction* copy_value = GetInstrCopy(orig_value);
+    // Copy edges are inserted after the original ones so we can just add new input to the phi.
+    phi->AddInput(copy_value);
+    DCHECK_EQ(phi->InputCount(), phi->GetBlock()->GetPredecessors().size());
+  }
+}
+
 //
 // Debug and logging methods.
 //
@@ -558,6 +658,8 @@ SuperblockCloner::SuperblockCloner(HGraph* graph,
     remap_incoming_(nullptr),
     bb_map_(bb_map),
     hir_map_(hir_map),
+    live_outs_(std::less<HInstruction*>(),
+               graph->GetAllocator()->Adapter(kArenaAllocSuperblockCloner)),
     outer_loop_(nullptr),
     outer_loop_bb_set_(arena_, orig_bb_set->GetSizeOf(), true, kArenaAllocSuperblockCloner) {
   orig_bb_set_.Copy(orig_bb_set);
@@ -577,31 +679,43 @@ bool SuperblockCloner::IsSubgraphClonable() const {
     return false;
   }
 
-  // Check that there are no instructions defined in the subgraph and used outside.
-  // TODO: Improve this by accepting graph with such uses but only one exit.
-  for (uint32_t idx : orig_bb_set_.Indexes()) {
-    HBasicBlock* block = GetBlockById(idx);
+  HInstructionMap live_outs(
+      std::less<HInstruction*>(), graph_->GetAllocator()->Adapter(kArenaAllocSuperblockCloner));
 
-    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
-      HInstruction* instr = it.Current();
-      if (!instr->IsClonable() ||
-          IsUsedOutsideRegion(instr, orig_bb_set_)) {
-        return false;
-      }
-    }
+  if (!CollectLiveOutsAndCheckClonable(&live_outs)) {
+    return false;
+  }
 
-    for (HInstructionIterator it(block->GetPhis()); !it.Done(); it.Advance()) {
-      HInstruction* instr = it.Current();
-      if (!instr->IsClonable() ||
-          IsUsedOutsideRegion(instr, orig_bb_set_)) {
-        return false;
-      }
-    }
+  ArenaVector<HBasicBlock*> exits(arena_->Adapter(kArenaAllocSuperblockCloner));
+  SearchForSubgraphExits(&exits);
+
+  // The only loops with live-outs which are currently supported are loops with a single exit
+  // which has no other predecessors.
+  // TODO: Support multiple exits with live-outs.
+  if (!live_outs.empty() &&
+      (exits.size() != 1 ||
+       exits[0]->GetPredecessors().size() != 1 ||
+       !exits[0]->GetPhis().IsEmpty())) {
+    return false;
   }
 
   return true;
 }
 
+size_t SuperblockCloner::GetNumberOfInstructions() const {
+  size_t number_of_instructions = 0;
+  for (uint32_t idx : orig_bb_set_.Indexes()) {
+    HBasicBlock* block = GetBlockById(idx);
+    for (HInstructionIterator it(block->GetPhis()); !it.Done(); it.Advance()) {
+      ++number_of_instructions;
+    }
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      ++number_of_instructions;
+    }
+  }
+  return number_of_instructions;
+}
+
 void SuperblockCloner::Run() {
   DCHECK(bb_map_ != nullptr);
   DCHECK(hir_map_ != nullptr);
@@ -610,8 +724,13 @@ void SuperblockCloner::Run() {
          remap_incoming_ != nullptr);
   DCHECK(IsSubgraphClonable());
 
+  // Collect the values which are used outside of the subgraph.
+  bool is_clonable = CollectLiveOutsAndCheckClonable(&live_outs_);
+  DCHECK(is_clonable);
   // Find an area in the graph for which control flow information should be adjusted.
   FindAndSetLocalAreaForAdjustments();
+  // Make the live-outs go through phis in the subgraph exit.
+  ConstructSubgraphClosedSSA();
   // Clone the basic blocks from the orig_bb_set_; data flow is invalid after the call and is to be
   // adjusted.
   CloneBasicBlocks();
@@ -622,6 +741,8 @@ void SuperblockCloner::Run() {
   AdjustControlFlowInfo();
   // Fix data flow of the graph.
   ResolveDataFlow();
+  // Merge the live-outs of the original and copy parts of the subgraph.
+  FixSubgraphClosedSSAAfterCloning();
 }
 
 void SuperblockCloner::CleanUp() {
@@ -701,4 +822,82 @@ void SuperblockCloner::CloneBasicBlocks() {
   }
 }
 
+//
+// Loop peeling/unrolling.
+//
+
+void CollectRemappingInfoForPeelUnroll(bool to_unroll,
+                                       HLoopInformation* loop_info,
+                                       HEdgeSet* remap_orig_internal,
+                                       HEdgeSet* remap_copy_internal,
+                                       HEdgeSet* remap_incoming) {
+  DCHECK(loop_info != nullptr);
+  HBasicBlock* loop_header = loop_info->GetHeader();
+  // Set up remap_orig_internal and remap_copy_internal edges sets: for unrolling the original
+  // back edges go to the copy header and the copy back edges go to the original header; for
+  // peeling only the latter happens.
+  for (HBasicBlock* back_edge_block : loop_info->GetBackEdges()) {
+    HEdge e = HEdge(back_edge_block, loop_header);
+    if (to_unroll) {
+      remap_orig_internal->Insert(e);
+    }
+    remap_copy_internal->Insert(e);
+  }
+
+  // Set up remap_incoming edges set: for peeling the loop is entered through the copy.
+  if (!to_unroll) {
+    remap_incoming->Insert(HEdge(loop_info->GetPreHeader(), loop_header));
+  }
+}
+
+PeelUnrollHelper::PeelUnrollHelper(HLoopInformation* info)
+    : loop_info_(info),
+      bb_map_(std::less<HBasicBlock*>(),
+              info->GetHeader()->GetGraph()->GetAllocator()->Adapter(kArenaAllocSuperblockCloner)),
+      hir_map_(std::less<HInstruction*>(),
+               info->GetHeader()->GetGraph()->GetAllocator()->Adapter(kArenaAllocSuperblockCloner)),
+      cloner_(info->GetHeader()->GetGraph(), &info->GetBlocks(), &bb_map_, &hir_map_) {
+  // For now do peeling/unrolling only for natural loops.
+  DCHECK(!info->IsIrreducible());
+}
+
+HBasicBlock* PeelUnrollHelper::DoPeelUnrollImpl(bool to_unroll) {
+  // For now do peeling/unrolling only for natural loops.
+  DCHECK(!loop_info_->IsIrreducible());
+
+  HBasicBlock* loop_header = loop_info_->GetHeader();
+  // Check that loop info is up-to-date.
+  DCHECK(loop_info_ == loop_header->GetLoopInformation());
+  HGraph* graph = loop_header->GetGraph();
+  ArenaAllocator* arena = graph->GetAllocator();
+
+  HEdgeSet remap_orig_internal(arena->Adapter(kArenaAllocSuperblockCloner));
+  HEdgeSet remap_copy_internal(arena->Adapter(kArenaAllocSuperblockCloner));
+  HEdgeSet remap_incoming(arena->Adapter(kArenaAllocSuperblockCloner));
+
+  CollectRemappingInfoForPeelUnroll(to_unroll,
+                                    loop_info_,
+                                    &remap_orig_internal,
+                                    &remap_copy_internal,
+                                    &remap_incoming);
+
+  cloner_.SetSuccessorRemappingInfo(&remap_orig_internal, &remap_copy_internal, &remap_incoming);
+  cloner_.Run();
+  cloner_.CleanUp();
+
+  // Check that loop info is preserved.
+  DCHECK(loop_info_ == loop_header->GetLoopInformation());
+
+  // The copy of the header is not a loop header: only the original one keeps a suspend check,
+  // which code generation expects to be the single suspend check of the loop.
+  HSuspendCheck* suspend_check = loop_info_->GetSuspendCheck();
+  if (suspend_check != nullptr) {
+    HInstruction* copy_suspend_check = cloner_.GetInstrCopy(suspend_check);
+    copy_suspend_check->GetBlock()->RemoveInstruction(copy_suspend_check);
+    hir_map_.erase(suspend_check);
+  }
+
+  return loop_header;
+}
+
 }  // namespace art
@@ -130,6 +130,11 @@ inline bool IsEdgeValid(HEdge edge, HGraph* graph) {
 // 4. Fix/resolve data flow.
 // 5. Do cleanups (DCE, critical edges splitting, etc).
 //
+// Values defined in the subgraph and used outside of it (live-outs) are supported only when the
+// subgraph has a single exit: before the cloning the subgraph is brought into closed SSA form by
+// inserting a phi for each live-out into the exit block; the copy of the value is then added
+// as the second input of that phi.
+//
 class SuperblockCloner : public ValueObject {
  public:
   // TODO: Investigate optimal types for the containers.
@@ -152,6 +157,9 @@ class SuperblockCloner : public ValueObject {
   // TODO: Start from small range of graph patterns then extend it.
   bool IsSubgraphClonable() const;
 
+  // Returns the number of instructions, including phis, in the subgraph.
+  size_t GetNumberOfInstructions() const;
+
   // Runs the copy algorithm according to the description.
   void Run();
 
@@ -204,7 +212,21 @@ class SuperblockCloner : public ValueObject {
 
  private:
   // Fills the 'exits' vector with the subgraph exits.
-  void SearchForSubgraphExits(ArenaVector<HBasicBlock*>* exits);
+  void SearchForSubgraphExits(ArenaVector<HBasicBlock*>* exits) const;
+
+  // Checks that all the instructions of the subgraph can be cloned and records in 'live_outs'
+  // the ones which are used outside of the subgraph, mapped to themselves. Returns whether
+  // the subgraph can be cloned.
+  bool CollectLiveOutsAndCheckClonable(HInstructionMap* live_outs) const;
+
+  // Inserts a phi into the subgraph exit block for each live-out value, replaces the uses of the
+  // value outside of the subgraph with the phi and updates the live_outs_ map entry to
+  // (value, phi).
+  void ConstructSubgraphClosedSSA();
+
+  // Adds the copy of each live-out value as an input of its phi in the exit block, merging
+  // the data flow from the original and copy parts of the subgraph.
+  void FixSubgraphClosedSSAAfterCloning();
 
   // Finds and records information about the area in the graph for which control-flow (back edges,
   // loops, dominators) needs to be adjusted.
@@ -295,6 +317,8 @@ class SuperblockCloner : public ValueObject {
   HBasicBlockMap* bb_map_;
   // Correspondence map for instructions: (original HInstruction, copy HInstruction).
   HInstructionMap* hir_map_;
+  // Values defined in the subgraph and used outside of it: (original value, phi in the exit).
+  HInstructionMap live_outs_;
   // Area in the graph for which control-flow (back edges, loops, dominators) needs to be adjusted.
   HLoopInformation* outer_loop_;
   HBasicBlockSet outer_loop_bb_set_;
@@ -304,6 +328,49 @@ class SuperblockCloner : public ValueObject {
   DISALLOW_COPY_AND_ASSIGN(SuperblockCloner);
 };
 
+// Helper class to perform loop peeling/unrolling with the SuperblockCloner.
+//
+// Only natural loops are supported. The correspondence maps between the original and copied
+// basic blocks/instructions are available after the transformation.
+class PeelUnrollHelper : public ValueObject {
+ public:
+  explicit PeelUnrollHelper(HLoopInformation* info);
+
+  // Returns whether the loop can be peeled/unrolled.
+  bool IsLoopClonable() const { return cloner_.IsSubgraphClonable(); }
+
+  // Returns the number of instructions which peeling or unrolling the loop would add.
+  size_t GetNumberOfInstructions() const { return cloner_.GetNumberOfInstructions(); }
+
+  // Peels the first iteration of the loop. Returns the header of the loop.
+  HBasicBlock* DoPeeling() { return DoPeelUnrollImpl(/* to_unroll */ false); }
+
+  // Unrolls the loop by a factor of 2: the loop body is followed by its copy before the
+  // back edge is taken. The exit check of the copy is left as is. Returns the header of the loop.
+  HBasicBlock* DoUnrolling() { return DoPeelUnrollImpl(/* to_unroll */ true); }
+
+  const SuperblockCloner::HBasicBlockMap* GetBasicBlockMap() const { return &bb_map_; }
+  const SuperblockCloner::HInstructionMap* GetInstructionMap() const { return &hir_map_; }
+
+ private:
+  HBasicBlock* DoPeelUnrollImpl(bool to_unroll);
+
+  HLoopInformation* const loop_info_;
+  SuperblockCloner::HBasicBlockMap bb_map_;
+  SuperblockCloner::HInstructionMap hir_map_;
+  SuperblockCloner cloner_;
+
+  DISALLOW_COPY_AND_ASSIGN(PeelUnrollHelper);
+};
+
+// Fills the edge sets for the successors remapping of loop peeling or, if 'to_unroll',
+// unrolling.
+void CollectRemappingInfoForPeelUnroll(bool to_unroll,
+                                       HLoopInformation* loop_info,
+                                       SuperblockCloner::HEdgeSet* remap_orig_internal,
+                                       SuperblockCloner::HEdgeSet* remap_copy_internal,
+                                       SuperblockCloner::HEdgeSet* remap_incoming);
+
 }  // namespace art
 
 namespace std {
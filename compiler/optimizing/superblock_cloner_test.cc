@@ -303,4 +303,105 @@ TEST_F(SuperblockClonerTest, AdjustControlFlowInfo) {
   EXPECT_TRUE(loop_info->IsBackEdge(*loop_body));
 }
 
+// Tests IsSubgraphClonable, Run and CleanUp for loop peeling.
+TEST_F(SuperblockClonerTest, LoopPeeling) {
+  HBasicBlock* header = nullptr;
+  HBasicBlock* loop_body = nullptr;
+
+  CreateBasicLoopControlFlow(&header, &loop_body);
+  CreateBasicLoopDataFlow(header, loop_body);
+  graph_->BuildDominatorTree();
+  ASSERT_TRUE(CheckGraph());
+
+  HLoopInformation* loop_info = header->GetLoopInformation();
+  PeelUnrollHelper helper(loop_info);
+  EXPECT_TRUE(helper.IsLoopClonable());
+  HBasicBlock* new_header = helper.DoPeeling();
+  const HBasicBlockMap* bb_map = helper.GetBasicBlockMap();
+
+  EXPECT_TRUE(CheckGraph());
+
+  // Check loop body successors.
+  EXPECT_EQ(loop_body->GetSingleSuccessor(), header);
+  EXPECT_EQ(bb_map->Get(loop_body)->GetSingleSuccessor(), header);
+
+  // Check loop structure: the peeled iteration is not part of the loop.
+  EXPECT_EQ(header, new_header);
+  EXPECT_EQ(loop_info, header->GetLoopInformation());
+  EXPECT_EQ(loop_info->GetBackEdges().size(), 1u);
+  EXPECT_EQ(loop_info->GetBackEdges()[0], loop_body);
+  EXPECT_FALSE(loop_info->Contains(*bb_map->Get(header)));
+  EXPECT_FALSE(loop_info->Contains(*bb_map->Get(loop_body)));
+  EXPECT_TRUE(bb_map->Get(header)->Dominates(header));
+}
+
+// Tests IsSubgraphClonable, Run and CleanUp for loop unrolling.
+TEST_F(SuperblockClonerTest, LoopUnrolling) {
+  HBasicBlock* header = nullptr;
+  HBasicBlock* loop_body = nullptr;
+
+  CreateBasicLoopControlFlow(&header, &loop_body);
+  CreateBasicLoopDataFlow(header, loop_body);
+  graph_->BuildDominatorTree();
+  ASSERT_TRUE(CheckGraph());
+
+  HLoopInformation* loop_info = header->GetLoopInformation();
+  PeelUnrollHelper helper(loop_info);
+  EXPECT_TRUE(helper.IsLoopClonable());
+  HBasicBlock* new_header = helper.DoUnrolling();
+  const HBasicBlockMap* bb_map = helper.GetBasicBlockMap();
+
+  EXPECT_TRUE(CheckGraph());
+
+  // Check loop body successors.
+  EXPECT_EQ(loop_body->GetSingleSuccessor(), bb_map->Get(header));
+  EXPECT_EQ(bb_map->Get(loop_body)->GetSingleSuccessor(), header);
+
+  // Check loop structure: the copy is part of the loop and takes the back edge.
+  EXPECT_EQ(header, new_header);
+  EXPECT_EQ(loop_info, header->GetLoopInformation());
+  EXPECT_EQ(loop_info->GetBackEdges().size(), 1u);
+  EXPECT_EQ(loop_info->GetBackEdges()[0], bb_map->Get(loop_body));
+  EXPECT_TRUE(loop_info->Contains(*bb_map->Get(header)));
+  EXPECT_TRUE(loop_info->Contains(*bb_map->Get(loop_body)));
+
+  // Only the original header keeps a suspend check.
+  EXPECT_EQ(loop_info->GetSuspendCheck()->GetBlock(), header);
+  for (HInstructionIterator it(bb_map->Get(header)->GetInstructions()); !it.Done(); it.Advance()) {
+    EXPECT_FALSE(it.Current()->IsSuspendCheck());
+  }
+}
+
+// Tests loop peeling of a loop whose induction variable is used after the loop.
+TEST_F(SuperblockClonerTest, LoopPeelingLiveOut) {
+  HBasicBlock* header = nullptr;
+  HBasicBlock* loop_body = nullptr;
+
+  CreateBasicLoopControlFlow(&header, &loop_body);
+  CreateBasicLoopDataFlow(header, loop_body);
+  HBasicBlock* loop_exit = header->GetSuccessors()[0];
+  HPhi* phi = header->GetFirstPhi()->AsPhi();
+  HInstruction* add = new (GetAllocator()) HAdd(DataType::Type::kInt32,
+                                                phi,
+                                                graph_->GetIntConstant(1));
+  loop_exit->InsertInstructionBefore(add, loop_exit->GetLastInstruction());
+  graph_->BuildDominatorTree();
+  ASSERT_TRUE(CheckGraph());
+
+  HLoopInformation* loop_info = header->GetLoopInformation();
+  PeelUnrollHelper helper(loop_info);
+  EXPECT_TRUE(helper.IsLoopClonable());
+  helper.DoPeeling();
+
+  EXPECT_TRUE(CheckGraph());
+
+  // The use after the loop sees the value from either the peeled iteration or the loop.
+  HInstruction* live_out = add->InputAt(0);
+  ASSERT_TRUE(live_out->IsPhi());
+  EXPECT_EQ(live_out->GetBlock(), loop_exit);
+  EXPECT_EQ(live_out->InputCount(), 2u);
+  EXPECT_EQ(loop_exit->GetPredecessors().size(), 2u);
+  EXPECT_TRUE(live_out->InputAt(0) == phi || live_out->InputAt(1) == phi);
+}
+
 }  // namespace art
@@ -163,6 +163,9 @@ class ArmVIXLAssembler FINAL : public Assembler {
   ArmVIXLMacroAssembler* GetVIXLAssembler() { return &vixl_masm_; }
   void FinalizeCode() OVERRIDE;
 
+  // The code is emitted into the VIXL buffer, not the AssemblerBuffer.
+  void ReserveCodeSpace(size_t capacity ATTRIBUTE_UNUSED) OVERRIDE {}
+
   // Size of generated code.
   size_t CodeSize() const OVERRIDE;
   const uint8_t* CodeBufferBaseAddress() const OVERRIDE;
@@ -72,6 +72,9 @@ class Arm64Assembler FINAL : public Assembler {
   // Finalize the code.
   void FinalizeCode() OVERRIDE;
 
+  // The code is emitted into the VIXL buffer, not the AssemblerBuffer.
+  void ReserveCodeSpace(size_t capacity ATTRIBUTE_UNUSED) OVERRIDE {}
+
   // Size of generated code.
   size_t CodeSize() const OVERRIDE;
   const uint8_t* CodeBufferBaseAddress() const OVERRIDE;
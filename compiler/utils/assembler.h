@@ -114,6 +114,13 @@ class AssemblerBuffer {
     *reinterpret_cast<T*>(contents_ + position) = value;
   }
 
+  // Grow the buffer ahead of time so that it can hold at least `capacity` bytes.
+  void Reserve(size_t capacity) {
+    if (capacity > Capacity()) {
+      ExtendCapacity(capacity);
+    }
+  }
+
   void Resize(size_t new_size) {
     if (new_size > Capacity()) {
       ExtendCapacity(new_size);
@@ -374,6 +381,10 @@ class Assembler : public DeletableArenaObject<kArenaAllocAssembler> {
   // avoided.
   virtual size_t CodePosition() { return CodeSize(); }
 
+  // Make room for about `capacity` bytes of code ahead of time, so that emitting them does
+  // not repeatedly reallocate and copy the code buffer. This is only a hint.
+  virtual void ReserveCodeSpace(size_t capacity) { buffer_.Reserve(capacity); }
+
   // Copy instructions out of assembly buffer into the given region of memory
   virtual void FinalizeInstructions(const MemoryRegion& region) {
     buffer_.FinalizeInstructions(region);
@@ -776,6 +776,10 @@ TEST_F(AssemblerX86Test, PCmpeqQ) {
   DriverStr(RepeatFF(&x86::X86Assembler::pcmpeqq, "pcmpeqq %{reg2}, %{reg1}"), "cmpeqq");
 }
 
+TEST_F(AssemblerX86Test, PMovmskb) {
+  DriverStr(RepeatRF(&x86::X86Assembler::pmovmskb, "pmovmskb %{reg2}, %{reg1}"), "pmovmskb");
+}
+
 TEST_F(AssemblerX86Test, PCmpgtB) {
   DriverStr(RepeatFF(&x86::X86Assembler::pcmpgtb, "pcmpgtb %{reg2}, %{reg1}"), "cmpgtb");
 }
@@ -17,6 +17,8 @@
 // Test is in compiler, as it uses compiler related code.
 #include "verifier/verifier_deps.h"
 
+#include <algorithm>
+
 #include "art_method-inl.h"
 #include "class_linker.h"
 #include "common_compiler_test.h"
@@ -481,6 +483,27 @@ TEST_F(VerifierDepsTest, StringToId) {
   ASSERT_NE(id_Main1, id_Lorem1);
 }
 
+TEST_F(VerifierDepsTest, SortExtraStrings) {
+  ASSERT_TRUE(TestAssignabilityRecording(/* dst */ "Ljava/util/TimeZone;",
+                                         /* src */ "Ljava/util/SimpleTimeZone;",
+                                         /* is_strict */ true,
+                                         /* is_assignable */ true));
+  ScopedObjectAccess soa(Thread::Current());
+  const uint32_t num_ids_in_dex = primary_dex_file_->NumStringIds();
+  dex::StringIndex id_z = verifier_deps_->GetIdFromString(*primary_dex_file_, "Lz ipsum");
+  dex::StringIndex id_a = verifier_deps_->GetIdFromString(*primary_dex_file_, "La ipsum");
+  ASSERT_GE(id_z.index_, num_ids_in_dex);
+  ASSERT_GT(id_a.index_, id_z.index_);
+
+  verifier_deps_->SortExtraStrings();
+  const std::vector<std::string>& strings =
+      verifier_deps_->GetDexFileDeps(*primary_dex_file_)->strings_;
+  ASSERT_TRUE(std::is_sorted(strings.begin(), strings.end()));
+  ASSERT_LT(verifier_deps_->GetIdFromString(*primary_dex_file_, "La ipsum").index_,
+            verifier_deps_->GetIdFromString(*primary_dex_file_, "Lz ipsum").index_);
+  ASSERT_TRUE(HasAssignable("Ljava/util/TimeZone;", "Ljava/util/SimpleTimeZone;", true));
+}
+
 TEST_F(VerifierDepsTest, Assignable_BothInBoot) {
   ASSERT_TRUE(TestAssignabilityRecording(/* dst */ "Ljava/util/TimeZone;",
                                          /* src */ "Ljava/util/SimpleTimeZone;",
@@ -14,12 +14,20 @@
  * limitations under the License.
  */
 
+#include <errno.h>
 #include <signal.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <algorithm>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "jni.h"
 #include "nativehelper/JniInvocation.h"
@@ -103,6 +111,148 @@ static int InvokeMain(JNIEnv* env, char** argv) {
   return env->ExceptionCheck() ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
+// Calls the instance method `name` of dalvik.system.ZygoteHooks on `hooks`, or the static
+// method of that name if the class has no such instance method. Returns false and describes
+// the exception on failure.
+static bool CallZygoteHook(JNIEnv* env,
+                           jclass hooks_class,
+                           jobject hooks,
+                           const char* name,
+                           const char* signature,
+                           ...) {
+  va_list args;
+  va_start(args, signature);
+  jmethodID method = (hooks != nullptr) ? env->GetMethodID(hooks_class, name, signature) : nullptr;
+  if (method != nullptr) {
+    env->CallVoidMethodV(hooks, method, args);
+  } else {
+    env->ExceptionClear();
+    method = env->GetStaticMethodID(hooks_class, name, signature);
+    if (method != nullptr) {
+      env->CallStaticVoidMethodV(hooks_class, method, args);
+    }
+  }
+  va_end(args);
+  if (method == nullptr || env->ExceptionCheck()) {
+    fprintf(stderr, "Failed to call dalvik.system.ZygoteHooks.%s\n", name);
+    env->ExceptionDescribe();
+    return false;
+  }
+  return true;
+}
+
+// Reads one request from `fd`: the class name and the arguments for its main(), each
+// terminated by a NUL, followed by an empty string. Returns false on a malformed request.
+static bool ReadPreforkRequest(int fd, std::vector<std::string>* request) {
+  std::string arg;
+  char c;
+  while (true) {
+    ssize_t rc = TEMP_FAILURE_RETRY(read(fd, &c, 1));
+    if (rc != 1) {
+      return false;
+    }
+    if (c != '\0') {
+      arg.push_back(c);
+    } else if (arg.empty()) {
+      return !request->empty();
+    } else {
+      request->push_back(arg);
+      arg.clear();
+    }
+  }
+}
+
+// Runs a pre-fork server on the unix socket `socket_path`. The runtime, started with -Xzygote,
+// is warmed up once and every connection forks a worker that shares its pages copy-on-write.
+// A worker runs the requested main() with the connection as its stdin, stdout and stderr, and
+// exits when main() returns. The server never returns unless it fails.
+static int RunPreforkServer(JNIEnv* env, const char* socket_path) {
+  ScopedLocalRef<jclass> hooks_class(env, env->FindClass("dalvik/system/ZygoteHooks"));
+  if (hooks_class.get() == nullptr) {
+    fprintf(stderr, "Unable to locate class dalvik.system.ZygoteHooks\n");
+    env->ExceptionDescribe();
+    return EXIT_FAILURE;
+  }
+  // Older versions of ZygoteHooks keep the pre-fork state in an instance.
+  ScopedLocalRef<jobject> hooks(env, nullptr);
+  jmethodID constructor = env->GetMethodID(hooks_class.get(), "<init>", "()V");
+  if (constructor != nullptr) {
+    hooks.reset(env->NewObject(hooks_class.get(), constructor));
+  }
+  env->ExceptionClear();
+
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "Socket path too long: %s\n", socket_path);
+    return EXIT_FAILURE;
+  }
+  strcpy(addr.sun_path, socket_path);
+  int server_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  unlink(socket_path);
+  if (server_fd < 0 ||
+      bind(server_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      listen(server_fd, SOMAXCONN) != 0) {
+    fprintf(stderr, "Unable to listen on %s: %s\n", socket_path, strerror(errno));
+    return EXIT_FAILURE;
+  }
+
+  while (true) {
+    // Reap the workers that exited since the last request.
+    while (waitpid(-1, nullptr, WNOHANG) > 0) {
+    }
+    int fd = TEMP_FAILURE_RETRY(accept4(server_fd, nullptr, nullptr, SOCK_CLOEXEC));
+    if (fd < 0) {
+      fprintf(stderr, "Failed to accept on %s: %s\n", socket_path, strerror(errno));
+      return EXIT_FAILURE;
+    }
+    std::vector<std::string> request;
+    if (!ReadPreforkRequest(fd, &request)) {
+      fprintf(stderr, "Ignoring malformed request\n");
+      close(fd);
+      continue;
+    }
+
+    if (!CallZygoteHook(env, hooks_class.get(), hooks.get(), "preFork", "()V")) {
+      return EXIT_FAILURE;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(server_fd);
+      if (dup2(fd, STDIN_FILENO) < 0 ||
+          dup2(fd, STDOUT_FILENO) < 0 ||
+          dup2(fd, STDERR_FILENO) < 0) {
+        _exit(EXIT_FAILURE);
+      }
+      close(fd);
+      if (!CallZygoteHook(env,
+                          hooks_class.get(),
+                          hooks.get(),
+                          "postForkChild",
+                          "(IZZLjava/lang/String;)V",
+                          /* runtime_flags */ 0,
+                          /* is_system_server */ JNI_FALSE,
+                          /* is_zygote */ JNI_FALSE,
+                          /* instruction_set */ nullptr)) {
+        return EXIT_FAILURE;
+      }
+      std::vector<char*> argv;
+      for (std::string& arg : request) {
+        argv.push_back(&arg[0]);
+      }
+      argv.push_back(nullptr);
+      return InvokeMain(env, argv.data());
+    }
+    close(fd);
+    if (pid < 0) {
+      fprintf(stderr, "Failed to fork: %s\n", strerror(errno));
+    }
+    if (!CallZygoteHook(env, hooks_class.get(), hooks.get(), "postForkCommon", "()V")) {
+      return EXIT_FAILURE;
+    }
+  }
+}
+
 // Parse arguments.  Most of it just gets passed through to the runtime.
 // The JNI spec defines a handful of standard arguments.
 static int dalvikvm(int argc, char** argv) {
@@ -126,6 +276,7 @@ static int dalvikvm(int argc, char** argv) {
   // [Do we need to catch & handle "-jar" here?]
   bool need_extra = false;
   const char* lib = nullptr;
+  const char* prefork_socket = nullptr;
   const char* what = nullptr;
   int curr_opt, arg_idx;
   for (curr_opt = arg_idx = 0; arg_idx < argc; arg_idx++) {
@@ -136,6 +287,10 @@ static int dalvikvm(int argc, char** argv) {
       lib = argv[arg_idx] + strlen("-XXlib:");
       continue;
     }
+    if (strncmp(argv[arg_idx], "-XXprefork-server:", strlen("-XXprefork-server:")) == 0) {
+      prefork_socket = argv[arg_idx] + strlen("-XXprefork-server:");
+      continue;
+    }
 
     options[curr_opt++].optionString = argv[arg_idx];
 
@@ -152,6 +307,11 @@ static int dalvikvm(int argc, char** argv) {
     return EXIT_FAILURE;
   }
 
+  // A pre-fork server runs as a zygote. Reuse the slot of the -XXprefork-server: option.
+  if (prefork_socket != nullptr) {
+    options[curr_opt++].optionString = const_cast<char*>("-Xzygote");
+  }
+
   if (curr_opt > option_count) {
     fprintf(stderr, "curr_opt(%d) > option_count(%d)\n", curr_opt, option_count);
     abort();
@@ -179,15 +339,22 @@ static int dalvikvm(int argc, char** argv) {
     return EXIT_FAILURE;
   }
 
-  // Make sure they provided a class name. We do this after
-  // JNI_CreateJavaVM so that things like "-help" have the opportunity
-  // to emit a usage statement.
-  if (arg_idx == argc) {
-    fprintf(stderr, "Class name required\n");
-    return EXIT_FAILURE;
-  }
+  int rc;
+  if (prefork_socket != nullptr) {
+    // Workers name their main class in each request. Any class name on the command line is
+    // ignored.
+    rc = RunPreforkServer(env, prefork_socket);
+  } else {
+    // Make sure they provided a class name. We do this after
+    // JNI_CreateJavaVM so that things like "-help" have the opportunity
+    // to emit a usage statement.
+    if (arg_idx == argc) {
+      fprintf(stderr, "Class name required\n");
+      return EXIT_FAILURE;
+    }
 
-  int rc = InvokeMain(env, &argv[arg_idx]);
+    rc = InvokeMain(env, &argv[arg_idx]);
+  }
 
 #if defined(NDEBUG)
   // The DestroyJavaVM call will detach this thread for us. In debug builds, we don't want to
@@ -17,6 +17,7 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include "base/memory_tool.h"
 
@@ -35,6 +36,9 @@
 #include <sys/utsname.h>
 #endif
 
+#include <zlib.h>
+
+#include "android-base/file.h"
 #include "android-base/stringprintf.h"
 #include "android-base/strings.h"
 
@@ -65,6 +69,7 @@
 #include "dexlayout.h"
 #include "dex/descriptors_names.h"
 #include "dex/dex_file-inl.h"
+#include "dex/dex_file_verifier.h"
 #include "dex/quick_compiler_callbacks.h"
 #include "dex/verification_results.h"
 #include "dex2oat_options.h"
@@ -348,8 +353,26 @@ NO_RETURN static void Usage(const char* fmt, ...) {
              CompilerOptions::kDefaultInlineMaxCodeUnits);
   UsageError("      Default: %d", CompilerOptions::kDefaultInlineMaxCodeUnits);
   UsageError("");
+  UsageError("  --compile-time-budget-ms=<milliseconds>: once the compilation of a method has");
+  UsageError("      taken this long, skip its remaining optional optimizations and use the");
+  UsageError("      linear scan register allocator. Zero means no budget.");
+  UsageError("      Example: --compile-time-budget-ms=50");
+  UsageError("      Default: 0");
+  UsageError("");
+  UsageError("  --compile-memory-budget-kb=<kilobytes>: once the compilation of a method has");
+  UsageError("      used this much arena memory for its graph, skip its remaining optional");
+  UsageError("      optimizations and use the linear scan register allocator. Zero means no");
+  UsageError("      budget.");
+  UsageError("      Example: --compile-memory-budget-kb=16384");
+  UsageError("      Default: 0");
+  UsageError("");
   UsageError("  --dump-timings: display a breakdown of where time was spent");
   UsageError("");
+  UsageError("  --dump-timings-to=<file-name>: write the time of each phase, the peak memory");
+  UsageError("      use and the compilation settings to a file, one value per line, for");
+  UsageError("      benchmarks.");
+  UsageError("      Example: --dump-timings-to=/tmp/dex2oat-timings.txt");
+  UsageError("");
   UsageError("  -g");
   UsageError("  --generate-debug-info: Generate debug information for native debugging,");
   UsageError("      such as stack unwinding information, ELF symbols and DWARF sections.");
@@ -389,6 +412,11 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("  --swap-fd=<file-descriptor>: specifies a file to use for swap (by descriptor).");
   UsageError("      Example: --swap-fd=10");
   UsageError("");
+  UsageError("  --swap-dir=<directory>: specifies a directory in which to create a swap file if");
+  UsageError("      the input is above the swap thresholds. Ignored if --swap-file or --swap-fd");
+  UsageError("      is given.");
+  UsageError("      Example: --swap-dir=/data/tmp");
+  UsageError("");
   UsageError("  --swap-dex-size-threshold=<size>: specifies the minimum total dex file size in");
   UsageError("      bytes to allow the use of swap.");
   UsageError("      Example: --swap-dex-size-threshold=1000000");
@@ -399,6 +427,11 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("      Example: --swap-dex-count-threshold=10");
   UsageError("      Default: %zu", kDefaultMinDexFilesForSwap);
   UsageError("");
+  UsageError("  --swap-available-memory-threshold-mb=<size>: decide whether to use swap by the");
+  UsageError("      memory available on the host rather than by the dex thresholds above: use");
+  UsageError("      swap if less than <size> megabytes are available.");
+  UsageError("      Example: --swap-available-memory-threshold-mb=2048");
+  UsageError("");
   UsageError("  --very-large-app-threshold=<size>: specifies the minimum total dex file size in");
   UsageError("      bytes to consider the input \"very large\" and reduce compilation done.");
   UsageError("      Example: --very-large-app-threshold=100000000");
@@ -613,6 +646,7 @@ class Dex2Oat FINAL {
       image_file_location_oat_checksum_(0),
       image_file_location_oat_data_begin_(0),
       image_patch_delta_(0),
+      classpath_checksum_(0u),
       key_value_store_(nullptr),
       verification_results_(nullptr),
       runtime_(nullptr),
@@ -1222,8 +1256,10 @@ class Dex2Oat FINAL {
     AssignIfExists(args, M::RuntimeOptions, &runtime_args_);
     AssignIfExists(args, M::SwapFile, &swap_file_name_);
     AssignIfExists(args, M::SwapFileFd, &swap_fd_);
+    AssignIfExists(args, M::SwapDir, &swap_dir_);
     AssignIfExists(args, M::SwapDexSizeThreshold, &min_dex_file_cumulative_size_for_swap_);
     AssignIfExists(args, M::SwapDexCountThreshold, &min_dex_files_for_swap_);
+    AssignIfExists(args, M::SwapAvailableMemoryThresholdMB, &swap_available_memory_threshold_mb_);
     AssignIfExists(args, M::VeryLargeAppThreshold, &very_large_threshold_);
     AssignIfExists(args, M::AppImageFile, &app_image_file_name_);
     AssignIfExists(args, M::AppImageFileFd, &app_image_fd_);
@@ -1232,6 +1268,7 @@ class Dex2Oat FINAL {
     AssignIfExists(args, M::DirtyImageObjects, &dirty_image_objects_filename_);
     AssignIfExists(args, M::ImageFormat, &image_storage_mode_);
     AssignIfExists(args, M::CompilationReason, &compilation_reason_);
+    AssignIfExists(args, M::DumpTimingsTo, &dump_timings_to_);
 
     AssignIfExists(args, M::Backend, &compiler_kind_);
     parser_options->requested_specific_compiler = args.Exists(M::Backend);
@@ -1626,6 +1663,8 @@ class Dex2Oat FINAL {
         // Do not abort if we couldn't open files from the classpath. They might be
         // apks without dex files and right now are opening flow will fail them.
         LOG(WARNING) << "Failed to open classpath dex files";
+      } else {
+        classpath_checksum_ = ComputeClasspathChecksum();
       }
 
       // Store the class loader context in the oat header.
@@ -1679,6 +1718,29 @@ class Dex2Oat FINAL {
 
     dex_files_ = MakeNonOwningPointerVector(opened_dex_files_);
 
+    if (input_vdex_file_ != nullptr && !InputVdexMatchesDexFiles()) {
+      // The vdex was created for other dex files, for instance a previous version of the app.
+      // Its verifier deps do not hold for the new dex files: the deps only record resolutions
+      // outside of the compiled dex files, so even the unchanged dex files need to be verified
+      // again. Note that the dex files come from the vdex if it has a dex section.
+      DCHECK(!input_vdex_file_->HasDexSection());
+      LOG(WARNING) << "Input vdex does not match the dex files, ignoring its verifier deps";
+      input_vdex_file_.reset();
+      // The dex files were opened without verification, trusting the vdex.
+      for (const DexFile* dex_file : dex_files_) {
+        std::string error_msg;
+        if (!DexFileVerifier::Verify(dex_file,
+                                     dex_file->Begin(),
+                                     dex_file->Size(),
+                                     dex_file->GetLocation().c_str(),
+                                     /* verify_checksum */ true,
+                                     &error_msg)) {
+          LOG(ERROR) << "Failed to verify " << dex_file->GetLocation() << ": " << error_msg;
+          return dex2oat::ReturnCode::kOther;
+        }
+      }
+    }
+
     // If we need to downgrade the compiler-filter for size reasons.
     if (!IsBootImage() && IsVeryLarge(dex_files_)) {
       // Disable app image to make sure dex2oat unloading is enabled.
@@ -1720,6 +1782,13 @@ class Dex2Oat FINAL {
       } else {
         LOG(INFO) << "Large app, accepted running with swap.";
       }
+    } else if (!swap_dir_.empty() && UseSwap(IsBootImage(), dex_files_)) {
+      // Only create a swap file in the swap directory now that we know we need it, so that
+      // callers can pass --swap-dir unconditionally.
+      if (!CreateSwapFileInDir()) {
+        return false;
+      }
+      LOG(INFO) << "Large app, accepted running with swap.";
     }
     // Note that dex2oat won't close the swap_fd_. The compiler driver's swap space will do that.
     if (IsBootImage()) {
@@ -1895,6 +1964,14 @@ class Dex2Oat FINAL {
     if (!DoEagerUnquickeningOfVdex() && input_vdex_file_ != nullptr) {
       callbacks_->SetVerifierDeps(
           new verifier::VerifierDeps(dex_files_, input_vdex_file_->GetVerifierDepsData()));
+      if (classpath_checksum_ != 0u &&
+          input_vdex_file_->GetVerifierDepsHeader().GetClasspathChecksum() == classpath_checksum_) {
+        // The dex files are the same as the ones the deps were recorded for (checked by
+        // InputVdexMatchesDexFiles()), and so are the class paths they resolve against.
+        // Resolution gives the same results, so skip looking up every dependency again.
+        VLOG(compiler) << "Class paths unchanged, reusing verifier deps without validation";
+        callbacks_->GetVerifierDeps()->SetKnownValid();
+      }
 
       // TODO: we unquicken unconditionally, as we don't know
       // if the boot image has changed. How exactly we'll know is under
@@ -2089,7 +2166,7 @@ class Dex2Oat FINAL {
         }
 
         // VDEX finalized, seek back to the beginning and write checksums and the header.
-        if (!oat_writers_[i]->WriteChecksumsAndVdexHeader(vdex_out.get())) {
+        if (!oat_writers_[i]->WriteChecksumsAndVdexHeader(vdex_out.get(), classpath_checksum_)) {
           LOG(ERROR) << "Failed to write vdex header into VDEX " << vdex_file->GetPath();
           return false;
         }
@@ -2290,6 +2367,34 @@ class Dex2Oat FINAL {
         (kIsDebugBuild && timings_->GetTotalNs() > MsToNs(1000))) {
       LOG(INFO) << Dumpable<TimingLogger>(*timings_);
     }
+    if (!dump_timings_to_.empty()) {
+      DumpTimingsToFile();
+    }
+  }
+
+  // Write "<key> <value>" lines, then the phases as printed by
+  // TimingLogger::DumpMachineReadable().
+  void DumpTimingsToFile() {
+    std::ostringstream oss;
+    oss << "compiler_filter "
+        << CompilerFilter::NameOfFilter(compiler_options_->GetCompilerFilter()) << "\n"
+        << "threads " << thread_count_ << "\n"
+        << "wall_ns " << (NanoTime() - start_ns_) << "\n"
+        << "cpu_ns " << (ProcessCpuNanoTime() - start_cputime_ns_) << "\n";
+    if (driver_ != nullptr) {
+      oss << "arena_peak_bytes " << driver_->GetMaxArenaAlloc() << "\n";
+    }
+    if (Runtime::Current() != nullptr) {
+      oss << "java_bytes " << Runtime::Current()->GetHeap()->GetBytesAllocated() << "\n";
+    }
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+      oss << "peak_rss_kb " << usage.ru_maxrss << "\n";
+    }
+    timings_->DumpMachineReadable(oss);
+    if (!android::base::WriteStringToFile(oss.str(), dump_timings_to_)) {
+      PLOG(WARNING) << "Could not write the timings to " << dump_timings_to_;
+    }
   }
 
   bool IsImage() const {
@@ -2328,6 +2433,38 @@ class Dex2Oat FINAL {
     return DoProfileGuidedOptimizations();
   }
 
+  // Return whether the input vdex was created for the dex files being compiled.
+  bool InputVdexMatchesDexFiles() const {
+    DCHECK(input_vdex_file_ != nullptr);
+    const uint32_t number_of_dex_files =
+        input_vdex_file_->GetVerifierDepsHeader().GetNumberOfDexFiles();
+    if (number_of_dex_files != dex_files_.size()) {
+      return false;
+    }
+    for (uint32_t i = 0; i != number_of_dex_files; ++i) {
+      if (input_vdex_file_->GetLocationChecksum(i) != dex_files_[i]->GetLocationChecksum()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Return a checksum of everything the verifier deps of an app resolve against: the boot class
+  // path and the class loader context, both including their dex checksums.
+  uint32_t ComputeClasspathChecksum() const {
+    DCHECK(!IsBootImage());
+    std::string summary;
+    for (const DexFile* dex_file : runtime_->GetClassLinker()->GetBootClassPath()) {
+      summary += dex_file->GetLocation();
+      summary += '*';
+      summary += std::to_string(dex_file->GetLocationChecksum());
+      summary += ':';
+    }
+    summary += class_loader_context_->EncodeContextForOatFile(classpath_dir_);
+    uint32_t checksum = adler32(0L, Z_NULL, 0);
+    return adler32(checksum, reinterpret_cast<const uint8_t*>(summary.data()), summary.size());
+  }
+
   bool MayInvalidateVdexMetadata() const {
     // DexLayout can invalidate the vdex metadata if changing the class def order is enabled, so
     // we need to unquicken the vdex file eagerly, before passing it to dexlayout.
@@ -2374,6 +2511,14 @@ class Dex2Oat FINAL {
       // Don't use swap, we know generation should succeed, and we don't want to slow it down.
       return false;
     }
+    if (swap_available_memory_threshold_mb_ != 0u) {
+      uint64_t available_memory = GetAvailableMemory();
+      if (available_memory != 0u) {
+        VLOG(compiler) << "Available memory: " << available_memory / MB << "MB";
+        return available_memory < swap_available_memory_threshold_mb_ * static_cast<uint64_t>(MB);
+      }
+      // Fall back to the dex thresholds if we cannot tell.
+    }
     if (dex_files.size() < min_dex_files_for_swap_) {
       // If there are less dex files than the threshold, assume it's gonna be fine.
       return false;
@@ -2385,6 +2530,33 @@ class Dex2Oat FINAL {
     return dex_files_size >= min_dex_file_cumulative_size_for_swap_;
   }
 
+  // Returns the MemAvailable estimate of the kernel in bytes, or 0 if it is not known.
+  static uint64_t GetAvailableMemory() {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    while (std::getline(meminfo, line)) {
+      uint64_t kb;
+      if (sscanf(line.c_str(), "MemAvailable: %" SCNu64 " kB", &kb) == 1) {
+        return kb * KB;
+      }
+    }
+    return 0u;
+  }
+
+  // Create an unlinked temporary file in swap_dir_ and use it as the swap file.
+  bool CreateSwapFileInDir() {
+    DCHECK_EQ(swap_fd_, -1);
+    std::string swap_file_template = swap_dir_ + "/dex2oat.swap.XXXXXX";
+    int fd = mkstemp(&swap_file_template[0]);
+    if (fd == -1) {
+      PLOG(ERROR) << "Failed to create swap file in " << swap_dir_;
+      return false;
+    }
+    unlink(swap_file_template.c_str());
+    swap_fd_ = fd;
+    return true;
+  }
+
   bool IsVeryLarge(std::vector<const DexFile*>& dex_files) {
     size_t dex_files_size = 0;
     for (const auto* dex_file : dex_files) {
@@ -2862,6 +3034,9 @@ class Dex2Oat FINAL {
   uint32_t image_file_location_oat_checksum_;
   uintptr_t image_file_location_oat_data_begin_;
   int32_t image_patch_delta_;
+  // Checksum of the boot class path and class path the verifier deps are recorded against,
+  // or 0 if it could not be computed. See ComputeClasspathChecksum().
+  uint32_t classpath_checksum_;
   std::unique_ptr<SafeMap<std::string, std::string> > key_value_store_;
 
   std::unique_ptr<VerificationResults> verification_results_;
@@ -2939,9 +3114,12 @@ class Dex2Oat FINAL {
 
   bool avoid_storing_invocation_;
   std::string swap_file_name_;
+  std::string swap_dir_;
   int swap_fd_;
   size_t min_dex_files_for_swap_ = kDefaultMinDexFilesForSwap;
   size_t min_dex_file_cumulative_size_for_swap_ = kDefaultMinDexFileCumulativeSizeForSwap;
+  // If not 0, the decision to use swap is made by the available memory.
+  unsigned int swap_available_memory_threshold_mb_ = 0u;
   size_t very_large_threshold_ = std::numeric_limits<size_t>::max();
   std::string app_image_file_name_;
   int app_image_fd_;
@@ -2970,6 +3148,7 @@ class Dex2Oat FINAL {
 
   // The reason for invoking the compiler.
   std::string compilation_reason_;
+  std::string dump_timings_to_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(Dex2Oat);
 };
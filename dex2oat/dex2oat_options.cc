@@ -147,12 +147,18 @@ static void AddSwapMappings(Builder& builder) {
       .Define("--swap-fd=_")
           .WithType<int>()
           .IntoKey(M::SwapFileFd)
+      .Define("--swap-dir=_")
+          .WithType<std::string>()
+          .IntoKey(M::SwapDir)
       .Define("--swap-dex-size-threshold=_")
           .WithType<unsigned int>()
           .IntoKey(M::SwapDexSizeThreshold)
       .Define("--swap-dex-count-threshold=_")
           .WithType<unsigned int>()
-          .IntoKey(M::SwapDexCountThreshold);
+          .IntoKey(M::SwapDexCountThreshold)
+      .Define("--swap-available-memory-threshold-mb=_")
+          .WithType<unsigned int>()
+          .IntoKey(M::SwapAvailableMemoryThresholdMB);
 }
 
 static void AddCompilerMappings(Builder& builder) {
@@ -258,7 +264,10 @@ static Parser CreateArgumentParser() {
           .IntoKey(M::RuntimeOptions)
       .Define("--compilation-reason=_")
           .WithType<std::string>()
-          .IntoKey(M::CompilationReason);
+          .IntoKey(M::CompilationReason)
+      .Define("--dump-timings-to=_")
+          .WithType<std::string>()
+          .IntoKey(M::DumpTimingsTo);
 
   AddCompilerOptionsArgumentParserOptions<Dex2oatArgumentMap>(*parser_builder);
 
@@ -22,8 +22,10 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
+#include <android-base/strings.h>
 
 #include "common_runtime_test.h"
 
@@ -378,6 +380,44 @@ TEST_F(Dex2oatSwapTest, DoUseSwapSingleSmall) {
           { "--swap-dex-size-threshold=0", "--swap-dex-count-threshold=0" });
 }
 
+TEST_F(Dex2oatSwapTest, SwapByAvailableMemory) {
+  // More memory than any host has: swap even though the dex thresholds are not met.
+  RunTest(false /* use_fd */,
+          true /* expect_use */,
+          { "--swap-available-memory-threshold-mb=1000000000" });
+  // Less memory than any host has: no swap even though the dex thresholds are met.
+  RunTest(false /* use_fd */,
+          false /* expect_use */,
+          { "--swap-available-memory-threshold-mb=1",
+            "--swap-dex-size-threshold=0",
+            "--swap-dex-count-threshold=0" });
+}
+
+TEST_F(Dex2oatSwapTest, SwapDir) {
+  std::string dex_location = GetScratchDir() + "/Dex2OatSwapTest.jar";
+  std::string odex_location = GetOdexDir() + "/Dex2OatSwapTest.odex";
+  Copy(GetTestDexFileName(), dex_location);
+
+  // Below the thresholds, no swap file is created.
+  GenerateOdexForTest(dex_location,
+                      odex_location,
+                      CompilerFilter::kSpeed,
+                      { "--swap-dir=" + GetOdexDir() });
+  CheckValidity();
+  ASSERT_TRUE(success_);
+  CheckResult(false /* expect_use */);
+
+  GenerateOdexForTest(dex_location,
+                      odex_location,
+                      CompilerFilter::kSpeed,
+                      { "--swap-dir=" + GetOdexDir(),
+                        "--swap-dex-size-threshold=0",
+                        "--swap-dex-count-threshold=0" });
+  CheckValidity();
+  ASSERT_TRUE(success_);
+  CheckResult(true /* expect_use */);
+}
+
 class Dex2oatSwapUseTest : public Dex2oatSwapTest {
  protected:
   void CheckHostResult(bool expect_use) OVERRIDE {
@@ -1822,6 +1862,29 @@ TEST_F(Dex2oatTest, VerifyCompilationReason) {
   ASSERT_STREQ("install", odex_file->GetCompilationReason());
 }
 
+TEST_F(Dex2oatTest, DumpTimingsTo) {
+  std::string dex_location = GetScratchDir() + "/Dex2OatDumpTimingsTo.jar";
+  std::string odex_location = GetOdexDir() + "/Dex2OatDumpTimingsTo.odex";
+  std::string timings_location = GetOdexDir() + "/Dex2OatDumpTimingsTo.txt";
+  Copy(GetDexSrc1(), dex_location);
+
+  GenerateOdexForTest(dex_location,
+                      odex_location,
+                      CompilerFilter::kSpeed,
+                      { "-j2", "--dump-timings-to=" + timings_location });
+  std::string timings;
+  ASSERT_TRUE(android::base::ReadFileToString(timings_location, &timings));
+  std::vector<std::string> lines = android::base::Split(timings, "\n");
+  ASSERT_GE(lines.size(), 2u) << timings;
+  EXPECT_EQ("compiler_filter speed", lines[0]);
+  EXPECT_EQ("threads 2", lines[1]);
+  for (const char* key :
+       { "wall_ns ", "cpu_ns ", "arena_peak_bytes ", "peak_rss_kb ", "phase 0 " }) {
+    EXPECT_NE(std::string::npos, timings.find(std::string("\n") + key)) << key << timings;
+  }
+  unlink(timings_location.c_str());
+}
+
 TEST_F(Dex2oatTest, VerifyNoCompilationReason) {
   std::string dex_location = GetScratchDir() + "/Dex2OatNoCompilationReason.jar";
   std::string odex_location = GetOdexDir() + "/Dex2OatNoCompilationReason.odex";
@@ -1937,6 +2000,90 @@ TEST_F(Dex2oatTest, DontExtract) {
   EXPECT_TRUE(found_fast_verify) << "Expected to find " << kFastVerifyString << "\n" << output_;
 }
 
+// Test that an input vdex created for other dex files is not used for their verifier deps.
+TEST_F(Dex2oatTest, InputVdexOfOtherDexFiles) {
+  std::string old_dex_location = GetScratchDir() + "/Old.jar";
+  std::string new_dex_location = GetScratchDir() + "/New.jar";
+  std::string old_odex_location = GetOdexDir() + "/Old.odex";
+  std::string new_odex_location = GetOdexDir() + "/New.odex";
+  std::string old_vdex_location = GetOdexDir() + "/Old.vdex";
+  std::string new_vdex_location = GetOdexDir() + "/New.vdex";
+  Copy(GetTestDexFileName("Main"), old_dex_location);
+  Copy(GetTestDexFileName("Nested"), new_dex_location);
+
+  std::unique_ptr<File> old_vdex_file(OS::CreateEmptyFile(old_vdex_location.c_str()));
+  std::unique_ptr<File> new_vdex_file(OS::CreateEmptyFile(new_vdex_location.c_str()));
+  ASSERT_TRUE(old_vdex_file != nullptr) << old_vdex_location;
+  ASSERT_TRUE(new_vdex_file != nullptr) << new_vdex_location;
+  {
+    std::string input_vdex = "--input-vdex-fd=-1";
+    std::string output_vdex = StringPrintf("--output-vdex-fd=%d", old_vdex_file->Fd());
+    GenerateOdexForTest(old_dex_location,
+                        old_odex_location,
+                        CompilerFilter::kVerify,
+                        { input_vdex, output_vdex, "--copy-dex-files=false" },
+                        /* expect_success */ true,
+                        /* use_fd */ true);
+    EXPECT_GT(old_vdex_file->GetLength(), 0u);
+  }
+  {
+    std::string input_vdex = StringPrintf("--input-vdex-fd=%d", old_vdex_file->Fd());
+    std::string output_vdex = StringPrintf("--output-vdex-fd=%d", new_vdex_file->Fd());
+    GenerateOdexForTest(new_dex_location,
+                        new_odex_location,
+                        CompilerFilter::kVerify,
+                        { input_vdex, output_vdex, "--copy-dex-files=false" },
+                        /* expect_success */ true,
+                        /* use_fd */ true);
+    EXPECT_NE(output_.find("Input vdex does not match the dex files"), std::string::npos)
+        << output_;
+  }
+  ASSERT_EQ(old_vdex_file->FlushCloseOrErase(), 0) << "Could not flush and close vdex file";
+  ASSERT_EQ(new_vdex_file->FlushCloseOrErase(), 0) << "Could not flush and close vdex file";
+}
+
+// Test that the vdex records a checksum of the class paths its verifier deps resolve against.
+TEST_F(Dex2oatTest, VdexClasspathChecksum) {
+  std::string dex_location = GetScratchDir() + "/Main.jar";
+  std::string odex_location = GetOdexDir() + "/Main.odex";
+  Copy(GetTestDexFileName("Main"), dex_location);
+
+  uint32_t checksum = 0u;
+  auto get_checksum = [&](const OatFile& oat_file) {
+    ASSERT_TRUE(oat_file.GetVdexFile() != nullptr);
+    checksum = oat_file.GetVdexFile()->GetVerifierDepsHeader().GetClasspathChecksum();
+  };
+  GenerateOdexForTest(dex_location,
+                      odex_location,
+                      CompilerFilter::kVerify,
+                      { },
+                      /* expect_success */ true,
+                      /* use_fd */ false,
+                      get_checksum);
+  const uint32_t first_checksum = checksum;
+  EXPECT_NE(first_checksum, 0u);
+
+  // Compiling against the same class paths gives the same checksum.
+  GenerateOdexForTest(dex_location,
+                      odex_location,
+                      CompilerFilter::kVerify,
+                      { },
+                      /* expect_success */ true,
+                      /* use_fd */ false,
+                      get_checksum);
+  EXPECT_EQ(first_checksum, checksum);
+
+  // Compiling against another class path gives a different checksum.
+  GenerateOdexForTest(dex_location,
+                      odex_location,
+                      CompilerFilter::kVerify,
+                      { "--class-loader-context=PCL[" + GetTestDexFileName("Nested") + "]" },
+                      /* expect_success */ true,
+                      /* use_fd */ false,
+                      get_checksum);
+  EXPECT_NE(first_checksum, checksum);
+}
+
 // Test that dex files with quickened opcodes aren't dequickened.
 TEST_F(Dex2oatTest, QuickenedInput) {
   std::string error_msg;
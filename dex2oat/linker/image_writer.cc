@@ -72,6 +72,7 @@
 #include "oat_file_manager.h"
 #include "runtime.h"
 #include "scoped_thread_state_change-inl.h"
+#include "thread_pool.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
 #include "well_known_classes.h"
 
@@ -2157,12 +2158,70 @@ void ImageWriter::CopyAndFixupNativeData(size_t oat_index) {
   }
 }
 
+class ImageWriter::CopyAndFixupObjectsTask FINAL : public Task {
+ public:
+  CopyAndFixupObjectsTask(ImageWriter* image_writer,
+                          const std::vector<Object*>* objects,
+                          size_t begin,
+                          size_t end)
+      : image_writer_(image_writer), objects_(objects), begin_(begin), end_(end) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
+    for (size_t i = begin_; i != end_; ++i) {
+      image_writer_->CopyAndFixupObject((*objects_)[i]);
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ImageWriter* const image_writer_;
+  const std::vector<Object*>* const objects_;
+  const size_t begin_;
+  const size_t end_;
+};
+
 void ImageWriter::CopyAndFixupObjects() {
-  auto visitor = [&](Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
-    DCHECK(obj != nullptr);
-    CopyAndFixupObject(obj);
-  };
-  Runtime::Current()->GetHeap()->VisitObjects(visitor);
+  Thread* const self = Thread::Current();
+  const size_t thread_count = compiler_driver_.GetThreadCount();
+  if (thread_count <= 1u) {
+    auto visitor = [&](Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
+      DCHECK(obj != nullptr);
+      CopyAndFixupObject(obj);
+    };
+    Runtime::Current()->GetHeap()->VisitObjects(visitor);
+  } else {
+    // Each object is copied to its own slot in the image and only reads the shared relocation
+    // data, so the objects can be copied and fixed up in parallel. Nothing moves objects while
+    // the image is being written, so the list stays valid while we do not hold the mutator lock.
+    std::vector<Object*> objects;
+    auto visitor = [&](Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
+      DCHECK(obj != nullptr);
+      if (!IsInBootImage(obj)) {
+        objects.push_back(obj);
+      }
+    };
+    Runtime::Current()->GetHeap()->VisitObjects(visitor);
+
+    ScopedThreadSuspension sts(self, kNative);
+    // The current thread participates in the work, so create one fewer worker.
+    ThreadPool thread_pool("Image writer thread pool", thread_count - 1u);
+    // Use several tasks per thread to even out the uneven object sizes.
+    static constexpr size_t kTasksPerThread = 4u;
+    const size_t num_tasks = thread_count * kTasksPerThread;
+    const size_t objects_per_task = RoundUp(objects.size(), num_tasks) / num_tasks;
+    for (size_t begin = 0; begin < objects.size(); begin += objects_per_task) {
+      size_t end = std::min(begin + objects_per_task, objects.size());
+      thread_pool.AddTask(self, new CopyAndFixupObjectsTask(this, &objects, begin, end));
+    }
+    thread_pool.StartWorkers(self);
+    thread_pool.Wait(self, /* do_work */ true, /* may_hold_locks */ false);
+    thread_pool.StopWorkers(self);
+  }
   // Fix up the object previously had hash codes.
   for (const auto& hash_pair : saved_hashcode_map_) {
     Object* obj = hash_pair.first;
@@ -2217,7 +2276,8 @@ void ImageWriter::CopyAndFixupObject(Object* obj) {
   DCHECK_LT(offset, image_info.image_end_);
   const auto* src = reinterpret_cast<const uint8_t*>(obj);
 
-  image_info.image_bitmap_->Set(dst);  // Mark the obj as live.
+  // Mark the obj as live. Objects may be copied in parallel and share bitmap words.
+  image_info.image_bitmap_->AtomicTestAndSet(dst);
 
   const size_t n = obj->SizeOf();
   DCHECK_LE(offset + n, image_info.image_->Size());
@@ -2392,9 +2452,9 @@ void ImageWriter::FixupObject(Object* orig, Object* copy) {
     // Is this a native pointer array?
     auto it = pointer_arrays_.find(down_cast<mirror::PointerArray*>(orig));
     if (it != pointer_arrays_.end()) {
-      // Should only need to fixup every pointer array exactly once.
+      // Every pointer array is fixed up exactly once. Do not erase it from the map, as other
+      // objects may be looked up concurrently.
       FixupPointerArray(copy, down_cast<mirror::PointerArray*>(orig), klass, it->second);
-      pointer_arrays_.erase(it);
       return;
     }
   }
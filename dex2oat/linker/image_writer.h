@@ -644,6 +644,7 @@ class ImageWriter FINAL {
   const std::unordered_set<std::string>* dirty_image_objects_;
 
   class ComputeLazyFieldsForClassesVisitor;
+  class CopyAndFixupObjectsTask;
   class FixupClassVisitor;
   class FixupRootVisitor;
   class FixupVisitor;
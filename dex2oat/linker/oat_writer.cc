@@ -4082,7 +4082,8 @@ bool OatWriter::WriteDexLayoutSections(
   return true;
 }
 
-bool OatWriter::WriteChecksumsAndVdexHeader(OutputStream* vdex_out) {
+bool OatWriter::WriteChecksumsAndVdexHeader(OutputStream* vdex_out,
+                                            uint32_t classpath_checksum) {
   // Write checksums
   off_t checksums_offset = sizeof(VdexFile::VerifierDepsHeader);
   off_t actual_offset = vdex_out->Seek(checksums_offset, kSeekSet);
@@ -4135,7 +4136,7 @@ bool OatWriter::WriteChecksumsAndVdexHeader(OutputStream* vdex_out) {
   size_t verifier_deps_section_size = vdex_quickening_info_offset_ - vdex_verifier_deps_offset_;
 
   VdexFile::VerifierDepsHeader deps_header(
-      oat_dex_files_.size(), verifier_deps_section_size, has_dex_section);
+      oat_dex_files_.size(), verifier_deps_section_size, has_dex_section, classpath_checksum);
   if (!vdex_out->WriteFully(&deps_header, sizeof(VdexFile::VerifierDepsHeader))) {
     PLOG(ERROR) << "Failed to write vdex header. File: " << vdex_out->GetLocation();
     return false;
@@ -4386,7 +4387,7 @@ const uint8_t* OatWriter::LookupBootImageInternTableSlot(const DexFile& dex_file
                                  utf8_data,
                                  ComputeUtf16HashFromModifiedUtf8(utf8_data, utf16_length));
   const InternTable* intern_table = Runtime::Current()->GetClassLinker()->intern_table_;
-  for (const InternTable::Table::UnorderedSet& table : intern_table->strong_interns_.tables_) {
+  for (const InternTable::UnorderedSet& table : intern_table->image_tables_) {
     auto it = table.Find(string);
     if (it != table.end()) {
       return reinterpret_cast<const uint8_t*>(std::addressof(*it));
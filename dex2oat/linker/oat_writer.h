@@ -181,7 +181,9 @@ class OatWriter {
                             /*out*/ std::vector<std::unique_ptr<const DexFile>>* opened_dex_files);
   bool WriteQuickeningInfo(OutputStream* vdex_out);
   bool WriteVerifierDeps(OutputStream* vdex_out, verifier::VerifierDeps* verifier_deps);
-  bool WriteChecksumsAndVdexHeader(OutputStream* vdex_out);
+  // `classpath_checksum` identifies the class paths the verifier deps hold for, see
+  // VdexFile::VerifierDepsHeader::GetClasspathChecksum().
+  bool WriteChecksumsAndVdexHeader(OutputStream* vdex_out, uint32_t classpath_checksum = 0u);
   // Initialize the writer with the given parameters.
   void Initialize(const CompilerDriver* compiler,
                   ImageWriter* image_writer,
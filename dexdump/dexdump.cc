@@ -37,8 +37,13 @@
 #include <inttypes.h>
 #include <stdio.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include "android-base/file.h"
@@ -61,9 +66,10 @@ namespace art {
 struct Options gOptions;
 
 /*
- * Output file. Defaults to stdout.
+ * Output file. Defaults to stdout. Thread-local so that the workers of
+ * the parallel class mode can each format into a private buffer.
  */
-FILE* gOutFile = stdout;
+thread_local FILE* gOutFile = stdout;
 
 /*
  * Data types that match the definitions in the VM specification.
@@ -1409,6 +1415,146 @@ static void dumpCfg(const DexFile* dex_file, int idx) {
   }
 }
 
+/*
+ * Dumps a string as a quoted JSON string.
+ */
+static void dumpJsonString(const char* p) {
+  fputc('"', gOutFile);
+  for (; *p != '\0'; p++) {
+    const unsigned char c = *p;
+    if (c == '"' || c == '\\') {
+      fputc('\\', gOutFile);
+      fputc(c, gOutFile);
+    } else if (c < 0x20) {
+      fprintf(gOutFile, "\\u%04x", c);
+    } else {
+      fputc(c, gOutFile);
+    }
+  }  // for
+  fputc('"', gOutFile);
+}
+
+/*
+ * Dumps a field as a JSON object. "*pFirst" tracks whether a separator is needed.
+ */
+static void dumpJsonField(const DexFile* pDexFile, u4 idx, u4 flags, bool* pFirst) {
+  // Bail for anything private if export only requested.
+  if (gOptions.exportsOnly && (flags & (kAccPublic | kAccProtected)) == 0) {
+    return;
+  }
+
+  const DexFile::FieldId& pFieldId = pDexFile->GetFieldId(idx);
+  fputs(*pFirst ? "{\"name\":" : ",{\"name\":", gOutFile);
+  *pFirst = false;
+  dumpJsonString(pDexFile->StringDataByIdx(pFieldId.name_idx_));
+  fputs(",\"type\":", gOutFile);
+  dumpJsonString(pDexFile->StringByTypeIdx(pFieldId.type_idx_));
+  fprintf(gOutFile, ",\"access\":%u}", flags);
+}
+
+/*
+ * Dumps a method as a JSON object. The bytecodes are only included
+ * when disassembly was requested.
+ */
+static void dumpJsonMethod(const DexFile* pDexFile, u4 idx, u4 flags,
+                           const DexFile::CodeItem* pCode, bool* pFirst) {
+  // Bail for anything private if export only requested.
+  if (gOptions.exportsOnly && (flags & (kAccPublic | kAccProtected)) == 0) {
+    return;
+  }
+
+  const DexFile::MethodId& pMethodId = pDexFile->GetMethodId(idx);
+  fputs(*pFirst ? "{\"name\":" : ",{\"name\":", gOutFile);
+  *pFirst = false;
+  dumpJsonString(pDexFile->StringDataByIdx(pMethodId.name_idx_));
+  fputs(",\"type\":", gOutFile);
+  dumpJsonString(pDexFile->GetMethodSignature(pMethodId).ToString().c_str());
+  fprintf(gOutFile, ",\"access\":%u", flags);
+  if (pCode != nullptr) {
+    CodeItemDataAccessor accessor(*pDexFile, pCode);
+    fprintf(gOutFile, ",\"insns_size\":%u", accessor.InsnsSizeInCodeUnits());
+    if (gOptions.disassemble) {
+      fputs(",\"insns\":[", gOutFile);
+      for (const DexInstructionPcPair& pair : accessor) {
+        std::string insn = android::base::StringPrintf(
+            "%04x: %s", pair.DexPc(), pair->DumpString(pDexFile).c_str());
+        if (pair.DexPc() != 0) {
+          fputc(',', gOutFile);
+        }
+        dumpJsonString(insn.c_str());
+      }  // for
+      fputc(']', gOutFile);
+    }
+  }
+  fputc('}', gOutFile);
+}
+
+/*
+ * Dumps the class as a single line JSON object, which keeps the output
+ * compact and easy to process with line-oriented tools.
+ */
+static void dumpJsonClass(const DexFile* pDexFile, int idx) {
+  const DexFile::ClassDef& pClassDef = pDexFile->GetClassDef(idx);
+  fprintf(gOutFile, "{\"index\":%d,\"class\":", idx);
+  dumpJsonString(pDexFile->StringByTypeIdx(pClassDef.class_idx_));
+  fprintf(gOutFile, ",\"access\":%u", pClassDef.access_flags_);
+  if (pClassDef.superclass_idx_.IsValid()) {
+    fputs(",\"superclass\":", gOutFile);
+    dumpJsonString(pDexFile->StringByTypeIdx(pClassDef.superclass_idx_));
+  }
+  if (pClassDef.source_file_idx_.IsValid()) {
+    fputs(",\"source_file\":", gOutFile);
+    dumpJsonString(pDexFile->StringDataByIdx(pClassDef.source_file_idx_));
+  }
+
+  // Interfaces.
+  fputs(",\"interfaces\":[", gOutFile);
+  const DexFile::TypeList* pInterfaces = pDexFile->GetInterfacesList(pClassDef);
+  if (pInterfaces != nullptr) {
+    for (u4 i = 0; i < pInterfaces->Size(); i++) {
+      if (i != 0) {
+        fputc(',', gOutFile);
+      }
+      dumpJsonString(pDexFile->StringByTypeIdx(pInterfaces->GetTypeItem(i).type_idx_));
+    }  // for
+  }
+  fputc(']', gOutFile);
+
+  // Fields and methods.
+  const u1* pEncodedData = pDexFile->GetClassData(pClassDef);
+  if (pEncodedData == nullptr) {
+    fputs(",\"static_fields\":[],\"instance_fields\":[]"
+          ",\"direct_methods\":[],\"virtual_methods\":[]}\n", gOutFile);
+    return;
+  }
+  ClassDataItemIterator pClassData(*pDexFile, pEncodedData);
+  bool first = true;
+  fputs(",\"static_fields\":[", gOutFile);
+  for (; pClassData.HasNextStaticField(); pClassData.Next()) {
+    dumpJsonField(pDexFile, pClassData.GetMemberIndex(), pClassData.GetRawMemberAccessFlags(),
+                  &first);
+  }  // for
+  first = true;
+  fputs("],\"instance_fields\":[", gOutFile);
+  for (; pClassData.HasNextInstanceField(); pClassData.Next()) {
+    dumpJsonField(pDexFile, pClassData.GetMemberIndex(), pClassData.GetRawMemberAccessFlags(),
+                  &first);
+  }  // for
+  first = true;
+  fputs("],\"direct_methods\":[", gOutFile);
+  for (; pClassData.HasNextDirectMethod(); pClassData.Next()) {
+    dumpJsonMethod(pDexFile, pClassData.GetMemberIndex(), pClassData.GetRawMemberAccessFlags(),
+                   pClassData.GetMethodCodeItem(), &first);
+  }  // for
+  first = true;
+  fputs("],\"virtual_methods\":[", gOutFile);
+  for (; pClassData.HasNextVirtualMethod(); pClassData.Next()) {
+    dumpJsonMethod(pDexFile, pClassData.GetMemberIndex(), pClassData.GetRawMemberAccessFlags(),
+                   pClassData.GetMethodCodeItem(), &first);
+  }  // for
+  fputs("]}\n", gOutFile);
+}
+
 /*
  * Dumps the class.
  *
@@ -1425,6 +1571,11 @@ static void dumpClass(const DexFile* pDexFile, int idx, char** pLastPackage) {
     return;
   }
 
+  if (gOptions.outputFormat == OUTPUT_JSON) {
+    dumpJsonClass(pDexFile, idx);
+    return;
+  }
+
   if (gOptions.showSectionHeaders) {
     dumpClassDef(pDexFile, idx);
   }
@@ -1821,6 +1972,68 @@ static void dumpCallSite(const DexFile* pDexFile, u4 idx) {
   }
 }
 
+/*
+ * Number of classes formatted by one worker before its output is handed
+ * back to the main thread.
+ */
+static const u4 kClassesPerChunk = 64;
+
+/*
+ * Dumps all classes using gOptions.numThreads workers. Each worker formats
+ * chunks of consecutive classes into a private memory stream, and the main
+ * thread writes the chunks out in class order, so the output is identical
+ * to the sequential one. Not used for the XML layout, which carries the
+ * current package from one class to the next.
+ */
+static void dumpClassesParallel(const DexFile* pDexFile) {
+  struct Chunk {
+    char* data = nullptr;
+    size_t size = 0;
+    bool done = false;
+  };
+  const u4 classDefsSize = pDexFile->GetHeader().class_defs_size_;
+  const u4 numChunks = (classDefsSize + kClassesPerChunk - 1) / kClassesPerChunk;
+  std::vector<Chunk> chunks(numChunks);
+  std::mutex lock;
+  std::condition_variable chunkDone;
+  std::atomic<u4> nextChunk(0);
+  auto worker = [&]() {
+    for (u4 i = nextChunk.fetch_add(1); i < numChunks; i = nextChunk.fetch_add(1)) {
+      char* data = nullptr;
+      size_t size = 0;
+      gOutFile = open_memstream(&data, &size);
+      CHECK(gOutFile != nullptr) << "open_memstream failed";
+      char* package = nullptr;  // Only used by the XML layout.
+      const u4 end = std::min(classDefsSize, (i + 1) * kClassesPerChunk);
+      for (u4 idx = i * kClassesPerChunk; idx < end; idx++) {
+        dumpClass(pDexFile, idx, &package);
+      }  // for
+      fclose(gOutFile);
+      std::lock_guard<std::mutex> mu(lock);
+      chunks[i].data = data;
+      chunks[i].size = size;
+      chunks[i].done = true;
+      chunkDone.notify_all();
+    }  // for
+  };
+  std::vector<std::thread> threads;
+  const u4 numThreads = std::min(numChunks, static_cast<u4>(gOptions.numThreads));
+  for (u4 i = 0; i < numThreads; i++) {
+    threads.emplace_back(worker);
+  }  // for
+  for (u4 i = 0; i < numChunks; i++) {
+    {
+      std::unique_lock<std::mutex> mu(lock);
+      chunkDone.wait(mu, [&]() { return chunks[i].done; });
+    }
+    fwrite(chunks[i].data, 1, chunks[i].size, gOutFile);
+    free(chunks[i].data);
+  }  // for
+  for (std::thread& thread : threads) {
+    thread.join();
+  }  // for
+}
+
 /*
  * Dumps the requested sections of the file.
  */
@@ -1847,20 +2060,27 @@ static void processDexFile(const char* fileName,
 
   // Iterate over all classes.
   char* package = nullptr;
-  const u4 classDefsSize = pDexFile->GetHeader().class_defs_size_;
-  for (u4 i = 0; i < classDefsSize; i++) {
-    dumpClass(pDexFile, i, &package);
-  }  // for
+  if (gOptions.numThreads > 1 && gOptions.outputFormat != OUTPUT_XML) {
+    dumpClassesParallel(pDexFile);
+  } else {
+    const u4 classDefsSize = pDexFile->GetHeader().class_defs_size_;
+    for (u4 i = 0; i < classDefsSize; i++) {
+      dumpClass(pDexFile, i, &package);
+    }  // for
+  }
 
-  // Iterate over all method handles.
-  for (u4 i = 0; i < pDexFile->NumMethodHandles(); ++i) {
-    dumpMethodHandle(pDexFile, i);
-  }  // for
+  // The JSON layout only describes classes.
+  if (gOptions.outputFormat != OUTPUT_JSON) {
+    // Iterate over all method handles.
+    for (u4 i = 0; i < pDexFile->NumMethodHandles(); ++i) {
+      dumpMethodHandle(pDexFile, i);
+    }  // for
 
-  // Iterate over all call site ids.
-  for (u4 i = 0; i < pDexFile->NumCallSiteIds(); ++i) {
-    dumpCallSite(pDexFile, i);
-  }  // for
+    // Iterate over all call site ids.
+    for (u4 i = 0; i < pDexFile->NumCallSiteIds(); ++i) {
+      dumpCallSite(pDexFile, i);
+    }  // for
+  }
 
   // Free the last package allocated.
   if (package != nullptr) {
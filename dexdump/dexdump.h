@@ -34,6 +34,7 @@ namespace art {
 enum OutputFormat {
   OUTPUT_PLAIN = 0,  // default
   OUTPUT_XML,        // XML-style
+  OUTPUT_JSON,       // one JSON object per class
 };
 
 /* Command-line options. */
@@ -50,11 +51,12 @@ struct Options {
   bool verbose;
   OutputFormat outputFormat;
   const char* outputFileName;
+  int numThreads;
 };
 
 /* Prototypes. */
 extern struct Options gOptions;
-extern FILE* gOutFile;
+extern thread_local FILE* gOutFile;
 int processFile(const char* fileName);
 
 }  // namespace art
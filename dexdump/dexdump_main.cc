@@ -25,6 +25,7 @@
 #include "dexdump.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -40,7 +41,7 @@ static const char* gProgName = "dexdump";
 static void usage(void) {
   LOG(ERROR) << "Copyright (C) 2007 The Android Open Source Project\n";
   LOG(ERROR) << gProgName << ": [-a] [-c] [-d] [-e] [-f] [-h] [-i] [-j] [-l layout] [-o outfile]"
-                  " dexfile...\n";
+                  " [-t threads] dexfile...\n";
   LOG(ERROR) << " -a : display annotations";
   LOG(ERROR) << " -c : verify checksum and exit";
   LOG(ERROR) << " -d : disassemble code sections";
@@ -50,8 +51,9 @@ static void usage(void) {
   LOG(ERROR) << " -h : display file header details";
   LOG(ERROR) << " -i : ignore checksum failures";
   LOG(ERROR) << " -j : disable dex file verification";
-  LOG(ERROR) << " -l : output layout, either 'plain' or 'xml'";
+  LOG(ERROR) << " -l : output layout, either 'plain', 'xml' or 'json'";
   LOG(ERROR) << " -o : output file name (defaults to stdout)";
+  LOG(ERROR) << " -t : number of threads formatting classes (not used for 'xml')";
 }
 
 /*
@@ -65,7 +67,7 @@ int dexdumpDriver(int argc, char** argv) {
 
   // Parse all arguments.
   while (1) {
-    const int ic = getopt(argc, argv, "acdefghijl:o:");
+    const int ic = getopt(argc, argv, "acdefghijl:o:t:");
     if (ic < 0) {
       break;  // done
     }
@@ -103,6 +105,9 @@ int dexdumpDriver(int argc, char** argv) {
         } else if (strcmp(optarg, "xml") == 0) {
           gOptions.outputFormat = OUTPUT_XML;
           gOptions.verbose = false;
+        } else if (strcmp(optarg, "json") == 0) {
+          gOptions.outputFormat = OUTPUT_JSON;
+          gOptions.verbose = false;
         } else {
           wantUsage = true;
         }
@@ -110,6 +115,12 @@ int dexdumpDriver(int argc, char** argv) {
       case 'o':  // output file
         gOptions.outputFileName = optarg;
         break;
+      case 't':  // number of threads
+        gOptions.numThreads = atoi(optarg);
+        if (gOptions.numThreads < 1) {
+          wantUsage = true;
+        }
+        break;
       default:
         wantUsage = true;
         break;
@@ -125,6 +136,12 @@ int dexdumpDriver(int argc, char** argv) {
     LOG(ERROR) << "Can't specify both -c and -i";
     wantUsage = true;
   }
+  if (gOptions.outputFormat == OUTPUT_JSON &&
+      (gOptions.showAnnotations || gOptions.showCfg ||
+       gOptions.showFileHeaders || gOptions.showSectionHeaders)) {
+    LOG(ERROR) << "Can't specify -a, -f, -g or -h with -l json";
+    wantUsage = true;
+  }
   if (wantUsage) {
     usage();
     return 2;
@@ -21,6 +21,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "android-base/file.h"
+
 #include "arch/instruction_set.h"
 #include "base/os.h"
 #include "base/utils.h"
@@ -78,4 +80,31 @@ TEST_F(DexDumpTest, XMLOutput) {
     dex_file_}, &error_msg)) << error_msg;
 }
 
+TEST_F(DexDumpTest, JSONOutput) {
+  std::string error_msg;
+  ASSERT_TRUE(Exec({"-d", "-l", "json", "-o", "/dev/null",
+    dex_file_}, &error_msg)) << error_msg;
+}
+
+TEST_F(DexDumpTest, BadJSONFlagCombination) {
+  std::string error_msg;
+  ASSERT_FALSE(Exec({"-l", "json", "-h", dex_file_}, &error_msg)) << error_msg;
+}
+
+TEST_F(DexDumpTest, ParallelOutputMatchesSequential) {
+  ScratchFile sequential;
+  ScratchFile parallel;
+  std::string error_msg;
+  ASSERT_TRUE(Exec({"-d", "-h", "-o", sequential.GetFilename(),
+    dex_file_}, &error_msg)) << error_msg;
+  ASSERT_TRUE(Exec({"-d", "-h", "-t", "4", "-o", parallel.GetFilename(),
+    dex_file_}, &error_msg)) << error_msg;
+  std::string expected;
+  std::string actual;
+  ASSERT_TRUE(android::base::ReadFileToString(sequential.GetFilename(), &expected));
+  ASSERT_TRUE(android::base::ReadFileToString(parallel.GetFilename(), &actual));
+  ASSERT_FALSE(expected.empty());
+  EXPECT_EQ(expected, actual);
+}
+
 }  // namespace art
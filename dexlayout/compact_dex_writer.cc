@@ -331,6 +331,16 @@ void CompactDexWriter::WriteStringData(Stream* stream, dex_ir::StringData* strin
   stream->Skip(1);
 }
 
+void CompactDexWriter::WriteTypeList(Stream* stream, dex_ir::TypeList* type_list) {
+  // Type lists only hold type indexes, so identical bytes mean the same list in every dex file
+  // that refers to them, and they can be shared across the dex files of the container.
+  ScopedDataSectionItem data_item(stream,
+                                  type_list,
+                                  SectionAlignment(DexFile::kDexTypeTypeList),
+                                  data_item_dedupe_);
+  DexWriter::WriteTypeList(stream, type_list);
+}
+
 bool CompactDexWriter::CanGenerateCompactDex(std::string* error_msg) {
   dex_ir::Collections& collections = header_->GetCollections();
   static constexpr InvokeType invoke_types[] = {
@@ -153,6 +153,8 @@ class CompactDexWriter : public DexWriter {
 
   void WriteStringData(Stream* stream, dex_ir::StringData* string_data) OVERRIDE;
 
+  void WriteTypeList(Stream* stream, dex_ir::TypeList* type_list) OVERRIDE;
+
   void WriteDebugInfoItem(Stream* stream, dex_ir::DebugInfoItem* debug_info) OVERRIDE;
 
   void SortDebugInfosByMethodIndex();
@@ -278,19 +278,23 @@ void DexWriter::WriteTypeIds(Stream* stream) {
   }
 }
 
-void DexWriter::WriteTypeLists(Stream* stream) {
+void DexWriter::WriteTypeList(Stream* stream, dex_ir::TypeList* type_list) {
   uint32_t size[1];
   uint16_t list[1];
+  stream->AlignTo(SectionAlignment(DexFile::kDexTypeTypeList));
+  size[0] = type_list->GetTypeList()->size();
+  ProcessOffset(stream, type_list);
+  stream->Write(size, sizeof(uint32_t));
+  for (const dex_ir::TypeId* type_id : *type_list->GetTypeList()) {
+    list[0] = type_id->GetIndex();
+    stream->Write(list, sizeof(uint16_t));
+  }
+}
+
+void DexWriter::WriteTypeLists(Stream* stream) {
   const uint32_t start = stream->Tell();
   for (std::unique_ptr<dex_ir::TypeList>& type_list : header_->GetCollections().TypeLists()) {
-    stream->AlignTo(SectionAlignment(DexFile::kDexTypeTypeList));
-    size[0] = type_list->GetTypeList()->size();
-    ProcessOffset(stream, type_list.get());
-    stream->Write(size, sizeof(uint32_t));
-    for (const dex_ir::TypeId* type_id : *type_list->GetTypeList()) {
-      list[0] = type_id->GetIndex();
-      stream->Write(list, sizeof(uint16_t));
-    }
+    WriteTypeList(stream, type_list.get());
   }
   if (compute_offsets_ && start != stream->Tell()) {
     header_->GetCollections().SetTypeListsOffset(start);
@@ -266,6 +266,7 @@ class DexWriter {
   virtual void WriteCodeItem(Stream* stream, dex_ir::CodeItem* item, bool reserve_only);
   virtual void WriteDebugInfoItem(Stream* stream, dex_ir::DebugInfoItem* debug_info);
   virtual void WriteStringData(Stream* stream, dex_ir::StringData* string_data);
+  virtual void WriteTypeList(Stream* stream, dex_ir::TypeList* type_list);
 
   // Process an offset, if compute_offset is set, write into the dex ir item, otherwise read the
   // existing offset and use that for writing.
@@ -29,6 +29,7 @@
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <unordered_set>
 #include <vector>
 
 #include "android-base/stringprintf.h"
@@ -1560,6 +1561,35 @@ void DexLayout::DumpDexFile() {
   }
 }
 
+// Moves the items returned by `get_item` for `class_defs` to the front of `items`, in that order,
+// and keeps the remaining items in their original order after them. Items may be shared by several
+// class defs, or may not belong to any.
+template <typename T, typename GetItem>
+static void MoveClassDefItemsToFront(const std::vector<dex_ir::ClassDef*>& class_defs,
+                                     std::vector<std::unique_ptr<T>>* items,
+                                     GetItem get_item) {
+  std::vector<T*> new_order;
+  std::unordered_set<T*> visited;
+  for (dex_ir::ClassDef* class_def : class_defs) {
+    T* item = get_item(class_def);
+    if (item != nullptr && visited.insert(item).second) {
+      new_order.push_back(item);
+    }
+  }
+  for (const std::unique_ptr<T>& item : *items) {
+    if (visited.find(item.get()) == visited.end()) {
+      new_order.push_back(item.get());
+    }
+  }
+  CHECK_EQ(new_order.size(), items->size());
+  for (size_t i = 0; i < new_order.size(); ++i) {
+    // Overwrite the existing vector with the new ordering, note that the sets of objects are
+    // equivalent, but the order changes. This is why this is not a memory leak.
+    (*items)[i].release();
+    (*items)[i].reset(new_order[i]);
+  }
+}
+
 void DexLayout::LayoutClassDefsAndClassData(const DexFile* dex_file) {
   std::vector<dex_ir::ClassDef*> new_class_def_order;
   for (std::unique_ptr<dex_ir::ClassDef>& class_def : header_->GetCollections().ClassDefs()) {
@@ -1592,6 +1622,24 @@ void DexLayout::LayoutClassDefsAndClassData(const DexFile* dex_file) {
   }
   CHECK_EQ(class_data_index, class_datas.size());
 
+  // Static values are read when a class is initialized, and the annotations directory is used
+  // for reflection and inner class lookups. Cluster those of the profile classes next to each
+  // other, the others stay in their original order.
+  std::vector<dex_ir::ClassDef*> profile_class_defs;
+  for (dex_ir::ClassDef* class_def : new_class_def_order) {
+    dex::TypeIndex type_idx(class_def->ClassType()->GetIndex());
+    if (!info_->ContainsClass(*dex_file, type_idx)) {
+      break;
+    }
+    profile_class_defs.push_back(class_def);
+  }
+  MoveClassDefItemsToFront(profile_class_defs,
+                           &header_->GetCollections().EncodedArrayItems(),
+                           [](dex_ir::ClassDef* class_def) { return class_def->StaticValues(); });
+  MoveClassDefItemsToFront(profile_class_defs,
+                           &header_->GetCollections().AnnotationsDirectoryItems(),
+                           [](dex_ir::ClassDef* class_def) { return class_def->Annotations(); });
+
   if (DexLayout::kChangeClassDefOrder) {
     // This currently produces dex files that violate the spec since the super class class_def is
     // supposed to occur before any subclasses.
@@ -166,7 +166,8 @@ class DexLayout {
   void LayoutStringData(const DexFile* dex_file);
 
   // Creates a new layout for the dex file based on profile info.
-  // Currently reorders ClassDefs, ClassDataItems, and CodeItems.
+  // Currently reorders ClassDefs, ClassDataItems, static values, annotations directories,
+  // string data, and CodeItems.
   void LayoutOutputFile(const DexFile* dex_file);
   bool OutputDexFile(const DexFile* input_dex_file,
                      bool compute_offsets,
@@ -16,10 +16,13 @@
 
 #include <string>
 
+#include <unistd.h>
+
 #include "base/logging.h"  // For InitLogging.
 #include "base/mutex.h"
 #include "base/os.h"
 #include "base/utils.h"
+#include "android-base/file.h"
 #include "android-base/stringprintf.h"
 #include "android-base/strings.h"
 #include "base/file_utils.h"
@@ -30,6 +33,7 @@
 #include "oat_file_assistant.h"
 #include "runtime.h"
 #include "thread-inl.h"
+#include "thread_pool.h"
 
 namespace art {
 
@@ -110,6 +114,18 @@ NO_RETURN static void Usage(const char *fmt, ...) {
   UsageError("  --downgrade: optional, if the purpose of dexopt is to downgrade the dex file");
   UsageError("       By default, dexopt considers upgrade case.");
   UsageError("");
+  UsageError("  --dex-files-manifest=<filename>: analyze all the dex files listed in the given");
+  UsageError("       file instead of --dex-file, setting up the runtime only once. Each line");
+  UsageError("       holds a dex file, optionally followed by a space and its class loader");
+  UsageError("       context. Lines without a context use --class-loader-context, if any.");
+  UsageError("       Cannot be used with --oat-fd, --vdex-fd, or --zip-fd.");
+  UsageError("");
+  UsageError("  --decisions-file=<filename>: required with --dex-files-manifest, the file to");
+  UsageError("       write the results to, one '<return code> <dex file>' line per manifest line.");
+  UsageError("");
+  UsageError("  -j<number>: optional, the number of threads used with --dex-files-manifest.");
+  UsageError("       Defaults to the number of CPUs.");
+  UsageError("");
   UsageError("Return code:");
   UsageError("  To make it easier to integrate with the internal tools this command will make");
   UsageError("    available its result (dexoptNeeded) as the exit/return code. i.e. it will not");
@@ -127,6 +143,8 @@ NO_RETURN static void Usage(const char *fmt, ...) {
   UsageError("        kErrorInvalidArguments = 101");
   UsageError("        kErrorCannotCreateRuntime = 102");
   UsageError("        kErrorUnknownDexOptNeeded = 103");
+  UsageError("  In --dex-files-manifest mode the return codes above are written to the");
+  UsageError("    --decisions-file and the command returns 0 unless it fails altogether.");
   UsageError("");
 
   exit(kErrorInvalidArguments);
@@ -136,7 +154,8 @@ class DexoptAnalyzer FINAL {
  public:
   DexoptAnalyzer() :
       assume_profile_changed_(false),
-      downgrade_(false) {}
+      downgrade_(false),
+      thread_count_(sysconf(_SC_NPROCESSORS_CONF)) {}
 
   void ParseArgs(int argc, char **argv) {
     original_argc = argc;
@@ -194,16 +213,37 @@ class DexoptAnalyzer FINAL {
             Usage("Invalid --zip-fd %d", zip_fd_);
           }
       } else if (option.starts_with("--class-loader-context=")) {
-        std::string context_str = option.substr(strlen("--class-loader-context=")).ToString();
-        class_loader_context_ = ClassLoaderContext::Create(context_str);
+        class_loader_context_spec_ = option.substr(strlen("--class-loader-context=")).ToString();
+        class_loader_context_ = ClassLoaderContext::Create(class_loader_context_spec_);
         if (class_loader_context_ == nullptr) {
-          Usage("Invalid --class-loader-context '%s'", context_str.c_str());
+          Usage("Invalid --class-loader-context '%s'", class_loader_context_spec_.c_str());
+        }
+      } else if (option.starts_with("--dex-files-manifest=")) {
+        dex_files_manifest_ = option.substr(strlen("--dex-files-manifest=")).ToString();
+      } else if (option.starts_with("--decisions-file=")) {
+        decisions_file_ = option.substr(strlen("--decisions-file=")).ToString();
+      } else if (option.starts_with("-j")) {
+        thread_count_ = std::stoi(option.substr(strlen("-j")).ToString(), nullptr, 0);
+        if (thread_count_ <= 0) {
+          Usage("Invalid -j %d", thread_count_);
         }
       } else {
         Usage("Unknown argument '%s'", option.data());
       }
     }
 
+    if (!dex_files_manifest_.empty()) {
+      if (!dex_file_.empty()) {
+        Usage("--dex-file and --dex-files-manifest are mutually exclusive");
+      }
+      if (oat_fd_ >= 0 || vdex_fd_ >= 0 || zip_fd_ >= 0) {
+        Usage("--dex-files-manifest cannot be used with file descriptors");
+      }
+      if (decisions_file_.empty()) {
+        Usage("--dex-files-manifest requires --decisions-file");
+      }
+    }
+
     if (image_.empty()) {
       // If we don't receive the image, try to use the default one.
       // Tests may specify a different image (e.g. core image).
@@ -252,14 +292,26 @@ class DexoptAnalyzer FINAL {
     }
     std::unique_ptr<Runtime> runtime(Runtime::Current());
 
+    if (!dex_files_manifest_.empty()) {
+      return GetDexOptNeededForManifest();
+    }
+    return GetDexOptNeeded(dex_file_, class_loader_context_.get(), vdex_fd_, oat_fd_, zip_fd_);
+  }
+
+ private:
+  int GetDexOptNeeded(const std::string& dex_file,
+                      ClassLoaderContext* class_loader_context,
+                      int vdex_fd,
+                      int oat_fd,
+                      int zip_fd) {
     std::unique_ptr<OatFileAssistant> oat_file_assistant;
-    oat_file_assistant = std::make_unique<OatFileAssistant>(dex_file_.c_str(),
+    oat_file_assistant = std::make_unique<OatFileAssistant>(dex_file.c_str(),
                                                             isa_,
                                                             false /*load_executable*/,
                                                             false /*only_load_system_executable*/,
-                                                            vdex_fd_,
-                                                            oat_fd_,
-                                                            zip_fd_);
+                                                            vdex_fd,
+                                                            oat_fd,
+                                                            zip_fd);
     // Always treat elements of the bootclasspath as up-to-date.
     // TODO(calin): this check should be in OatFileAssistant.
     if (oat_file_assistant->IsInBootClassPath()) {
@@ -267,7 +319,7 @@ class DexoptAnalyzer FINAL {
     }
 
     int dexoptNeeded = oat_file_assistant->GetDexOptNeeded(
-        compiler_filter_, assume_profile_changed_, downgrade_, class_loader_context_.get());
+        compiler_filter_, assume_profile_changed_, downgrade_, class_loader_context);
 
     // Convert OatFileAssitant codes to dexoptanalyzer codes.
     switch (dexoptNeeded) {
@@ -286,10 +338,88 @@ class DexoptAnalyzer FINAL {
     }
   }
 
- private:
+  // Analyzes one line of the manifest. The class loader context is opened relative to the dex
+  // file, so each task creates its own one rather than sharing class_loader_context_.
+  class AnalyzeTask FINAL : public Task {
+   public:
+    AnalyzeTask(DexoptAnalyzer* analyzer, const std::string& line, int* result)
+        : analyzer_(analyzer), line_(line), result_(result) {}
+
+    void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE {
+      size_t separator = line_.find(' ');
+      const std::string& context_spec = (separator == std::string::npos)
+          ? analyzer_->class_loader_context_spec_
+          : line_.substr(separator + 1);
+      std::unique_ptr<ClassLoaderContext> context;
+      if (!context_spec.empty()) {
+        context = ClassLoaderContext::Create(context_spec);
+        if (context == nullptr) {
+          LOG(ERROR) << "Invalid class loader context '" << context_spec << "'";
+          *result_ = kErrorInvalidArguments;
+          return;
+        }
+      }
+      *result_ = analyzer_->GetDexOptNeeded(line_.substr(0, separator),
+                                            context.get(),
+                                            /*vdex_fd*/ -1,
+                                            /*oat_fd*/ -1,
+                                            /*zip_fd*/ -1);
+    }
+
+   private:
+    DexoptAnalyzer* const analyzer_;
+    const std::string line_;
+    int* const result_;
+  };
+
+  int GetDexOptNeededForManifest() {
+    std::string manifest;
+    if (!android::base::ReadFileToString(dex_files_manifest_, &manifest)) {
+      PLOG(ERROR) << "Failed to read " << dex_files_manifest_;
+      return kErrorInvalidArguments;
+    }
+    std::vector<std::string> lines;
+    for (const std::string& line : android::base::Split(manifest, "\n")) {
+      if (!line.empty()) {
+        lines.push_back(line);
+      }
+    }
+
+    std::vector<int> results(lines.size(), kErrorUnknownDexOptNeeded);
+    std::vector<std::unique_ptr<AnalyzeTask>> tasks;
+    tasks.reserve(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+      tasks.push_back(std::make_unique<AnalyzeTask>(this, lines[i], &results[i]));
+    }
+
+    Thread* self = Thread::Current();
+    {
+      // The current thread works too, see Wait() below.
+      ThreadPool thread_pool("dexoptanalyzer thread pool",
+                             std::min<size_t>(thread_count_ - 1, lines.size()));
+      for (const std::unique_ptr<AnalyzeTask>& task : tasks) {
+        thread_pool.AddTask(self, task.get());
+      }
+      thread_pool.StartWorkers(self);
+      thread_pool.Wait(self, /*do_work*/ true, /*may_hold_locks*/ false);
+    }
+
+    std::string decisions;
+    for (size_t i = 0; i < lines.size(); ++i) {
+      size_t separator = lines[i].find(' ');
+      decisions += std::to_string(results[i]) + " " + lines[i].substr(0, separator) + "\n";
+    }
+    if (!android::base::WriteStringToFile(decisions, decisions_file_)) {
+      PLOG(ERROR) << "Failed to write " << decisions_file_;
+      return kErrorInvalidArguments;
+    }
+    return kNoDexOptNeeded;
+  }
+
   std::string dex_file_;
   InstructionSet isa_;
   CompilerFilter::Filter compiler_filter_;
+  std::string class_loader_context_spec_;
   std::unique_ptr<ClassLoaderContext> class_loader_context_;
   bool assume_profile_changed_;
   bool downgrade_;
@@ -298,6 +428,10 @@ class DexoptAnalyzer FINAL {
   int vdex_fd_ = -1;
   // File descriptor corresponding to apk, dex_file, or zip.
   int zip_fd_ = -1;
+  // Batched mode, see --dex-files-manifest.
+  std::string dex_files_manifest_;
+  std::string decisions_file_;
+  int thread_count_;
 };
 
 static int dexoptAnalyze(int argc, char** argv) {
@@ -16,6 +16,8 @@
 
 #include <gtest/gtest.h>
 
+#include "android-base/file.h"
+#include "android-base/strings.h"
 #include "arch/instruction_set.h"
 #include "compiler_filter.h"
 #include "dexopt_test.h"
@@ -319,4 +321,45 @@ TEST_F(DexoptAnalyzerTest, ShortDexLocation) {
   Verify(dex_location, CompilerFilter::kSpeed);
 }
 
+// Case: Several dex files analyzed in one invocation give the same results as one at a time.
+TEST_F(DexoptAnalyzerTest, DexFilesManifest) {
+  std::string no_oat_location = GetScratchDir() + "/ManifestNoOat.jar";
+  std::string up_to_date_location = GetScratchDir() + "/ManifestUpToDate.jar";
+  Copy(GetDexSrc1(), no_oat_location);
+  Copy(GetDexSrc1(), up_to_date_location);
+  GenerateOatForTest(up_to_date_location.c_str(), CompilerFilter::kSpeed);
+  std::vector<std::string> dex_locations = { no_oat_location, up_to_date_location, "/xx" };
+
+  std::string manifest = GetScratchDir() + "/manifest.txt";
+  std::string decisions_file = GetScratchDir() + "/decisions.txt";
+  ASSERT_TRUE(android::base::WriteStringToFile(
+      android::base::Join(dex_locations, '\n') + "\n", manifest));
+
+  std::vector<std::string> argv_str;
+  argv_str.push_back(GetDexoptAnalyzerCmd());
+  argv_str.push_back("--dex-files-manifest=" + manifest);
+  argv_str.push_back("--decisions-file=" + decisions_file);
+  argv_str.push_back("-j2");
+  argv_str.push_back("--isa=" + std::string(GetInstructionSetString(kRuntimeISA)));
+  argv_str.push_back("--compiler-filter=" + CompilerFilter::NameOfFilter(CompilerFilter::kSpeed));
+  argv_str.push_back("--image=" + GetImageLocation());
+  argv_str.push_back("--android-data=" + android_data_);
+  std::string error;
+  ASSERT_EQ(0, ExecAndReturnCode(argv_str, &error)) << error;
+
+  std::string decisions;
+  ASSERT_TRUE(android::base::ReadFileToString(decisions_file, &decisions));
+  std::vector<std::string> lines = android::base::Split(decisions, "\n");
+  ASSERT_EQ(dex_locations.size() + 1u, lines.size());  // Trailing newline.
+  for (size_t i = 0; i < dex_locations.size(); ++i) {
+    std::vector<std::string> fields = android::base::Split(lines[i], " ");
+    ASSERT_EQ(2u, fields.size()) << lines[i];
+    EXPECT_EQ(dex_locations[i], fields[1]);
+    OatFileAssistant oat_file_assistant(
+        dex_locations[i].c_str(), kRuntimeISA, /*load_executable*/ false);
+    EXPECT_EQ(oat_file_assistant.GetDexOptNeeded(CompilerFilter::kSpeed),
+              DexoptanalyzerToOatFileAssistant(std::stoi(fields[0])));
+  }
+}
+
 }  // namespace art
@@ -37,6 +37,7 @@
 
 #include <android-base/endian.h>
 #include <android-base/logging.h>
+#include <android-base/macros.h>
 #include <android-base/parseint.h>
 #include <android-base/stringprintf.h>
 
@@ -247,29 +248,51 @@ class ScopedEventFdLock {
 };
 
 IOResult FdForwardTransport::WriteFullyWithoutChecks(const void* data, size_t ndata) {
+  iovec iov = { const_cast<void*>(data), ndata };
+  return WriteFullyWithoutChecks(&iov, 1);
+}
+
+IOResult FdForwardTransport::WriteFullyWithoutChecks(iovec* iov, size_t iovcnt) {
   ScopedEventFdLock sefdl(write_lock_fd_);
-  const uint8_t* bdata = static_cast<const uint8_t*>(data);
-  size_t nbytes = 0;
-  while (nbytes < ndata) {
-    int res = TEMP_FAILURE_RETRY(write(write_fd_, bdata + nbytes, ndata - nbytes));
+  // Skip empty buffers up front so that a zero-length write really means EOF.
+  while (iovcnt != 0 && iov->iov_len == 0) {
+    ++iov;
+    --iovcnt;
+  }
+  while (iovcnt != 0) {
+    ssize_t res = TEMP_FAILURE_RETRY(writev(write_fd_, iov, iovcnt));
     if (res < 0) {
-      DT_IO_ERROR("Failed write()");
+      DT_IO_ERROR("Failed writev()");
       return IOResult::kError;
     } else if (res == 0) {
       return IOResult::kEOF;
-    } else {
-      nbytes += res;
+    }
+    // Advance past what was written, which may end in the middle of a buffer.
+    size_t nbytes = static_cast<size_t>(res);
+    while (iovcnt != 0 && nbytes >= iov->iov_len) {
+      nbytes -= iov->iov_len;
+      ++iov;
+      --iovcnt;
+    }
+    if (iovcnt != 0) {
+      iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + nbytes;
+      iov->iov_len -= nbytes;
     }
   }
   return IOResult::kOk;
 }
 
 IOResult FdForwardTransport::WriteFully(const void* data, size_t ndata) {
+  iovec iov = { const_cast<void*>(data), ndata };
+  return WriteFully(&iov, 1);
+}
+
+IOResult FdForwardTransport::WriteFully(iovec* iov, size_t iovcnt) {
   std::lock_guard<std::mutex> lk(state_mutex_);
   if (state_ != TransportState::kOpen) {
     return IOResult::kInterrupt;
   }
-  return WriteFullyWithoutChecks(data, ndata);
+  return WriteFullyWithoutChecks(iov, iovcnt);
 }
 
 static void SendAcceptMessage(int fd) {
@@ -570,25 +593,33 @@ jdwpTransportError FdForwardTransport::ReadPacket(jdwpPacket* pkt) {
   }
 }
 
-// A class that writes a packet to the transport.
+// A class that writes a packet to the transport. Only the header is serialized, the payload is
+// handed to writev() directly so it is sent along with the header without being copied.
 class PacketWriter {
  public:
   PacketWriter(FdForwardTransport* transport, const jdwpPacket* pkt)
       : transport_(transport), pkt_(pkt), data_() {}
 
   bool WriteFully() {
+    data_.reserve(11);
     PushInt32(pkt_->type.cmd.len);
     PushInt32(pkt_->type.cmd.id);
     PushByte(pkt_->type.cmd.flags);
+    iovec iov[2];
     if ((pkt_->type.reply.flags & JDWPTRANSPORT_FLAGS_REPLY) == JDWPTRANSPORT_FLAGS_REPLY) {
       PushInt16(pkt_->type.reply.errorCode);
-      PushData(pkt_->type.reply.data, pkt_->type.reply.len - 11);
+      iov[1].iov_base = pkt_->type.reply.data;
+      iov[1].iov_len = pkt_->type.reply.len - 11;
     } else {
       PushByte(pkt_->type.cmd.cmdSet);
       PushByte(pkt_->type.cmd.cmd);
-      PushData(pkt_->type.cmd.data, pkt_->type.cmd.len - 11);
+      iov[1].iov_base = pkt_->type.cmd.data;
+      iov[1].iov_len = pkt_->type.cmd.len - 11;
     }
-    IOResult res = transport_->WriteFully(data_.data(), data_.size());
+    DCHECK_EQ(data_.size(), 11u);
+    iov[0].iov_base = data_.data();
+    iov[0].iov_len = data_.size();
+    IOResult res = transport_->WriteFully(iov, arraysize(iov));
     return res == IOResult::kOk;
   }
 
@@ -43,6 +43,7 @@
 
 #include <arpa/inet.h>
 #include <sys/eventfd.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <poll.h>
 
@@ -111,6 +112,9 @@ class FdForwardTransport : public jdwpTransportEnv {
 
   IOResult WriteFully(const void* data, size_t ndata);  // REQUIRES(!state_mutex_);
   IOResult WriteFullyWithoutChecks(const void* data, size_t ndata);  // REQUIRES(state_mutex_);
+  // Gathering versions of the above. The iovecs are updated as the data is written.
+  IOResult WriteFully(iovec* iov, size_t iovcnt);  // REQUIRES(!state_mutex_);
+  IOResult WriteFullyWithoutChecks(iovec* iov, size_t iovcnt);  // REQUIRES(state_mutex_);
   IOResult ReadFully(void* data, size_t ndata);  // REQUIRES(!state_mutex_);
   IOResult ReadUpToMax(void* data, size_t ndata, /*out*/size_t* amount_read);
       // REQUIRES(state_mutex_);
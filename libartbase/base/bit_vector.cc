@@ -63,6 +63,22 @@ BitVector::~BitVector() {
   allocator_->Free(storage_);
 }
 
+// Count the bits set in the first `num_words` words of `storage`. Pairs of words go through one
+// 64-bit popcount, which halves the popcounts on 64-bit targets. The loop has no early exit, so
+// the compiler can also vectorize it.
+static uint32_t CountSetBits(const uint32_t* storage, uint32_t num_words) {
+  uint32_t count = 0u;
+  uint32_t word = 0u;
+  for (; word + 1u < num_words; word += 2u) {
+    uint64_t pair = storage[word] | (static_cast<uint64_t>(storage[word + 1u]) << 32);
+    count += POPCOUNT(pair);
+  }
+  if (word != num_words) {
+    count += POPCOUNT(storage[word]);
+  }
+  return count;
+}
+
 bool BitVector::SameBitsSet(const BitVector *src) const {
   int our_highest = GetHighestBitSet();
   int src_highest = src->GetHighestBitSet();
@@ -158,15 +174,18 @@ bool BitVector::Union(const BitVector* src) {
     DCHECK_LT(static_cast<uint32_t> (highest_bit), storage_size_ * kWordBits);
   }
 
+  // Store unconditionally and accumulate the changed bits, a loop without branches that the
+  // compiler can vectorize.
+  uint32_t* storage = storage_;
+  const uint32_t* src_storage = src->GetRawStorage();
+  uint32_t changed_bits = 0u;
   for (uint32_t idx = 0; idx < src_size; idx++) {
-    uint32_t existing = storage_[idx];
-    uint32_t update = existing | src->GetRawStorageWord(idx);
-    if (existing != update) {
-      changed = true;
-      storage_[idx] = update;
-    }
+    uint32_t existing = storage[idx];
+    uint32_t update = existing | src_storage[idx];
+    changed_bits |= existing ^ update;
+    storage[idx] = update;
   }
-  return changed;
+  return changed || changed_bits != 0u;
 }
 
 bool BitVector::UnionIfNotIn(const BitVector* union_with, const BitVector* not_in) {
@@ -192,26 +211,26 @@ bool BitVector::UnionIfNotIn(const BitVector* union_with, const BitVector* not_i
 
   uint32_t not_in_size = not_in->GetStorageSize();
 
+  // Branch free, as in Union().
+  uint32_t* storage = storage_;
+  const uint32_t* union_with_storage = union_with->GetRawStorage();
+  const uint32_t* not_in_storage = not_in->GetRawStorage();
+  uint32_t changed_bits = 0u;
   uint32_t idx = 0;
-  for (; idx < std::min(not_in_size, union_with_size); idx++) {
-    uint32_t existing = storage_[idx];
-    uint32_t update = existing |
-        (union_with->GetRawStorageWord(idx) & ~not_in->GetRawStorageWord(idx));
-    if (existing != update) {
-      changed = true;
-      storage_[idx] = update;
-    }
+  for (const uint32_t end = std::min(not_in_size, union_with_size); idx < end; idx++) {
+    uint32_t existing = storage[idx];
+    uint32_t update = existing | (union_with_storage[idx] & ~not_in_storage[idx]);
+    changed_bits |= existing ^ update;
+    storage[idx] = update;
   }
 
   for (; idx < union_with_size; idx++) {
-    uint32_t existing = storage_[idx];
-    uint32_t update = existing | union_with->GetRawStorageWord(idx);
-    if (existing != update) {
-      changed = true;
-      storage_[idx] = update;
-    }
+    uint32_t existing = storage[idx];
+    uint32_t update = existing | union_with_storage[idx];
+    changed_bits |= existing ^ update;
+    storage[idx] = update;
   }
-  return changed;
+  return changed || changed_bits != 0u;
 }
 
 void BitVector::Subtract(const BitVector *src) {
@@ -230,11 +249,7 @@ void BitVector::Subtract(const BitVector *src) {
 }
 
 uint32_t BitVector::NumSetBits() const {
-  uint32_t count = 0;
-  for (uint32_t word = 0; word < storage_size_; word++) {
-    count += POPCOUNT(storage_[word]);
-  }
-  return count;
+  return CountSetBits(storage_, storage_size_);
 }
 
 uint32_t BitVector::NumSetBits(uint32_t end) const {
@@ -316,10 +331,7 @@ uint32_t BitVector::NumSetBits(const uint32_t* storage, uint32_t end) {
   uint32_t word_end = WordIndex(end);
   uint32_t partial_word_bits = end & 0x1f;
 
-  uint32_t count = 0u;
-  for (uint32_t word = 0u; word < word_end; word++) {
-    count += POPCOUNT(storage[word]);
-  }
+  uint32_t count = CountSetBits(storage, word_end);
   if (partial_word_bits != 0u) {
     count += POPCOUNT(storage[word_end] & ~(0xffffffffu << partial_word_bits));
   }
@@ -0,0 +1,477 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_LIBARTBASE_BASE_GROUP_HASH_SET_H_
+#define ART_LIBARTBASE_BASE_GROUP_HASH_SET_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <android-base/logging.h>
+
+#include "bit_utils.h"
+#include "globals.h"
+#include "hash_set.h"
+#include "macros.h"
+
+namespace art {
+
+// Hash set with the interface of HashSet, and the same EmptyFn, HashFn, Pred and Alloc template
+// arguments, that probes groups of slots at a time.
+//
+// Next to the elements, each slot has a control byte that holds either kEmptyCtrl or 7 bits of
+// the element's hash. A lookup loads the control bytes of 8 consecutive slots as one 64-bit word
+// and finds the slots whose hash bits match with a few word operations (SWAR), so it compares
+// against an element only for about one in 128 of the other slots it probes. Probing is linear
+// and erasing shifts elements back like HashSet::Erase(), so there are no tombstones. The control
+// bytes of the first slots are mirrored after the last slot, so that a group never wraps around.
+//
+// Slots are kept constructed and free slots are in the EmptyFn empty state, as in HashSet. Only
+// the control bytes are looked at to tell free slots apart, so elements are not required to be
+// distinguishable from the empty state for lookups, but inserting an empty element is not allowed.
+template <class T, class EmptyFn = DefaultEmptyFn<T>, class HashFn = std::hash<T>,
+    class Pred = std::equal_to<T>, class Alloc = std::allocator<T>>
+class GroupHashSet {
+  template <class Elem, class HashSetType>
+  class BaseIterator : std::iterator<std::forward_iterator_tag, Elem> {
+   public:
+    BaseIterator(const BaseIterator&) = default;
+    BaseIterator(BaseIterator&&) = default;
+    BaseIterator(HashSetType* hash_set, size_t index) : index_(index), hash_set_(hash_set) {
+    }
+    BaseIterator& operator=(const BaseIterator&) = default;
+    BaseIterator& operator=(BaseIterator&&) = default;
+
+    bool operator==(const BaseIterator& other) const {
+      return hash_set_ == other.hash_set_ && this->index_ == other.index_;
+    }
+
+    bool operator!=(const BaseIterator& other) const {
+      return !(*this == other);
+    }
+
+    BaseIterator operator++() {  // Value after modification.
+      this->index_ = hash_set_->NextNonEmptySlot(this->index_);
+      return *this;
+    }
+
+    BaseIterator operator++(int) {
+      BaseIterator temp = *this;
+      this->index_ = hash_set_->NextNonEmptySlot(this->index_);
+      return temp;
+    }
+
+    Elem& operator*() const {
+      DCHECK(!hash_set_->IsFreeSlot(this->index_));
+      return hash_set_->data_[this->index_];
+    }
+
+    Elem* operator->() const {
+      return &**this;
+    }
+
+   private:
+    size_t index_;
+    HashSetType* hash_set_;
+
+    friend class GroupHashSet;
+  };
+
+ public:
+  using value_type = T;
+  using allocator_type = Alloc;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = BaseIterator<T, GroupHashSet>;
+  using const_iterator = BaseIterator<const T, const GroupHashSet>;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+
+  // Number of slots whose control bytes are matched at once.
+  static constexpr size_t kGroupSize = 8u;
+  // Must be a power of two, at least kGroupSize.
+  static constexpr size_t kMinBuckets = 16u;
+
+  GroupHashSet() : GroupHashSet(Alloc()) {}
+
+  explicit GroupHashSet(const Alloc& alloc) noexcept
+      : allocfn_(alloc),
+        ctrl_allocfn_(alloc),
+        num_elements_(0u),
+        num_buckets_(0u),
+        elements_until_expand_(0u),
+        data_(nullptr),
+        ctrl_(nullptr) {
+  }
+
+  GroupHashSet(GroupHashSet&& other) noexcept : GroupHashSet(other.allocfn_) {
+    swap(other);
+  }
+
+  GroupHashSet& operator=(GroupHashSet&& other) noexcept {
+    GroupHashSet(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  ~GroupHashSet() {
+    DeallocateStorage();
+  }
+
+  void Clear() {
+    DeallocateStorage();
+    num_elements_ = 0u;
+    elements_until_expand_ = 0u;
+  }
+
+  iterator begin() {
+    return iterator(this, FirstNonEmptySlot());
+  }
+
+  iterator end() {
+    return iterator(this, NumBuckets());
+  }
+
+  const_iterator begin() const {
+    return const_iterator(this, FirstNonEmptySlot());
+  }
+
+  const_iterator end() const {
+    return const_iterator(this, NumBuckets());
+  }
+
+  bool Empty() const {
+    return Size() == 0u;
+  }
+
+  size_t Size() const {
+    return num_elements_;
+  }
+
+  size_t NumBuckets() const {
+    return num_buckets_;
+  }
+
+  // The hash set expands when Size() reaches ElementsUntilExpand().
+  size_t ElementsUntilExpand() const {
+    return elements_until_expand_;
+  }
+
+  // Calculate the current load factor and return it.
+  double CalculateLoadFactor() const {
+    return static_cast<double>(Size()) / static_cast<double>(NumBuckets());
+  }
+
+  // Find an element, returns end() if not found. Allows custom key (K) types, as HashSet::Find().
+  template <typename K>
+  iterator Find(const K& key) {
+    return FindWithHash(key, hashfn_(key));
+  }
+
+  template <typename K>
+  const_iterator Find(const K& key) const {
+    return FindWithHash(key, hashfn_(key));
+  }
+
+  template <typename K>
+  iterator FindWithHash(const K& key, size_t hash) {
+    return iterator(this, FindIndex(key, hash));
+  }
+
+  template <typename K>
+  const_iterator FindWithHash(const K& key, size_t hash) const {
+    return const_iterator(this, FindIndex(key, hash));
+  }
+
+  // Insert an element, allows duplicates.
+  template <typename U, typename = typename std::enable_if<std::is_convertible<U, T>::value>::type>
+  void Insert(U&& element) {
+    InsertWithHash(std::forward<U>(element), hashfn_(element));
+  }
+
+  template <typename U, typename = typename std::enable_if<std::is_convertible<U, T>::value>::type>
+  void InsertWithHash(U&& element, size_t hash) {
+    DCHECK_EQ(hash, hashfn_(element));
+    DCHECK(!emptyfn_.IsEmpty(element));
+    if (num_elements_ >= elements_until_expand_) {
+      Resize(std::max(kMinBuckets, 2u * NumBuckets()));
+    }
+    const size_t mixed = MixHash(hash);
+    const size_t index = FirstEmptySlot(mixed & BucketMask());
+    data_[index] = std::forward<U>(element);
+    SetCtrl(index, HashBits(mixed));
+    ++num_elements_;
+  }
+
+  // Erase the element at `it` and return an iterator to the next element. Like HashSet::Erase(),
+  // the following elements of the probe sequence that would become unreachable are shifted back,
+  // so no tombstones are needed.
+  iterator Erase(iterator it) {
+    size_t empty_index = it.index_;
+    DCHECK(!IsFreeSlot(empty_index));
+    size_t next_index = empty_index;
+    bool filled = false;  // True if we filled the empty index.
+    while (true) {
+      next_index = (next_index + 1u) & BucketMask();
+      if (IsFreeSlot(next_index)) {
+        emptyfn_.MakeEmpty(data_[empty_index]);
+        SetCtrl(empty_index, kEmptyCtrl);
+        break;
+      }
+      // The element at next_index can move to empty_index unless its ideal index lies in
+      // (empty_index, next_index], with wrap around.
+      const size_t ideal_index = MixHash(hashfn_(data_[next_index])) & BucketMask();
+      const size_t distance_to_next = (next_index - empty_index) & BucketMask();
+      const size_t distance_to_ideal = (ideal_index - empty_index) & BucketMask();
+      if (distance_to_ideal == 0u || distance_to_ideal > distance_to_next) {
+        data_[empty_index] = std::move(data_[next_index]);
+        SetCtrl(empty_index, ctrl_[next_index]);
+        filled = true;
+        empty_index = next_index;
+      }
+    }
+    --num_elements_;
+    // If we didn't fill the slot then we need go to the next non free slot.
+    if (!filled) {
+      ++it;
+    }
+    return it;
+  }
+
+  // Reserve enough room to insert until Size() == num_elements without requiring to grow the hash
+  // set. No-op if the hash set is already large enough to do this.
+  void Reserve(size_t num_elements) {
+    size_t num_buckets = kMinBuckets;
+    while (MaxElementsFor(num_buckets) <= num_elements) {
+      num_buckets *= 2u;
+    }
+    if (num_buckets > NumBuckets()) {
+      Resize(num_buckets);
+    }
+  }
+
+  void swap(GroupHashSet& other) {
+    // Use argument-dependent lookup with fall-back to std::swap() for function objects.
+    using std::swap;
+    swap(allocfn_, other.allocfn_);
+    swap(ctrl_allocfn_, other.ctrl_allocfn_);
+    swap(hashfn_, other.hashfn_);
+    swap(emptyfn_, other.emptyfn_);
+    swap(pred_, other.pred_);
+    std::swap(num_elements_, other.num_elements_);
+    std::swap(num_buckets_, other.num_buckets_);
+    std::swap(elements_until_expand_, other.elements_until_expand_);
+    std::swap(data_, other.data_);
+    std::swap(ctrl_, other.ctrl_);
+  }
+
+  allocator_type get_allocator() const {
+    return allocfn_;
+  }
+
+ private:
+  using CtrlAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<uint8_t>;
+
+  // The control byte of a free slot. Full slots hold 7 bits of the hash, so their top bit is 0.
+  static constexpr uint8_t kEmptyCtrl = 0x80u;
+  static constexpr uint64_t kLowBits = UINT64_C(0x0101010101010101);
+  static constexpr uint64_t kHighBits = kLowBits << 7;
+
+  // Byte i of the group is the control byte of slot `index + i`.
+  static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Groups assume little endian");
+
+  static uint64_t LoadGroup(const uint8_t* ctrl) {
+    uint64_t group;
+    memcpy(&group, ctrl, sizeof(group));
+    return group;
+  }
+
+  // Return the top bit of each byte of `group` that equals `hash_bits`. A byte right above a
+  // matching one may be reported too, which the comparison of the elements filters out.
+  static uint64_t MatchHashBits(uint64_t group, uint8_t hash_bits) {
+    const uint64_t x = group ^ (kLowBits * hash_bits);
+    return (x - kLowBits) & ~x & kHighBits;
+  }
+
+  // Return the top bit of each byte of `group` that is kEmptyCtrl.
+  static uint64_t MatchEmpty(uint64_t group) {
+    return group & kHighBits;
+  }
+
+  static size_t SlotInGroup(uint64_t match) {
+    return CTZ(match) / kBitsPerByte;
+  }
+
+  // HashFn results are not required to be well distributed, e.g. aligned pointers. The low bits
+  // of the mixed hash pick the ideal slot, and the top 7 bits are kept in the control byte.
+  static size_t MixHash(size_t hash) {
+    uint64_t mixed = static_cast<uint64_t>(hash) * UINT64_C(0x9e3779b97f4a7c15);
+    return static_cast<size_t>(mixed ^ (mixed >> 32));
+  }
+
+  static uint8_t HashBits(size_t mixed) {
+    return static_cast<uint8_t>(mixed >> (BitSizeOf<size_t>() - 7u));
+  }
+
+  // Limit the load to 7/8, linear probing of whole groups keeps probe sequences short.
+  static size_t MaxElementsFor(size_t num_buckets) {
+    return num_buckets - num_buckets / 8u;
+  }
+
+  size_t BucketMask() const {
+    return num_buckets_ - 1u;
+  }
+
+  bool IsFreeSlot(size_t index) const {
+    DCHECK_LT(index, NumBuckets());
+    return ctrl_[index] == kEmptyCtrl;
+  }
+
+  void SetCtrl(size_t index, uint8_t ctrl) {
+    ctrl_[index] = ctrl;
+    if (index < kGroupSize - 1u) {
+      ctrl_[num_buckets_ + index] = ctrl;
+    }
+  }
+
+  size_t FirstNonEmptySlot() const {
+    return (num_buckets_ == 0u || !IsFreeSlot(0u)) ? 0u : NextNonEmptySlot(0u);
+  }
+
+  size_t NextNonEmptySlot(size_t index) const {
+    DCHECK_LT(index, NumBuckets());
+    do {
+      ++index;
+    } while (index < num_buckets_ && IsFreeSlot(index));
+    return index;
+  }
+
+  // Find the slot of an element, or return NumBuckets() if not found.
+  template <typename K>
+  size_t FindIndex(const K& key, size_t hash) const {
+    if (UNLIKELY(num_buckets_ == 0u)) {
+      return 0u;
+    }
+    DCHECK_EQ(hashfn_(key), hash);
+    const size_t mixed = MixHash(hash);
+    const uint8_t hash_bits = HashBits(mixed);
+    size_t index = mixed & BucketMask();
+    while (true) {
+      const uint64_t group = LoadGroup(ctrl_ + index);
+      for (uint64_t match = MatchHashBits(group, hash_bits); match != 0u; match &= match - 1u) {
+        const size_t slot = (index + SlotInGroup(match)) & BucketMask();
+        if (pred_(data_[slot], key)) {
+          return slot;
+        }
+      }
+      // The element would be before the first free slot of its probe sequence.
+      if (MatchEmpty(group) != 0u) {
+        return num_buckets_;
+      }
+      index = (index + kGroupSize) & BucketMask();
+    }
+  }
+
+  size_t FirstEmptySlot(size_t index) const {
+    while (true) {
+      const uint64_t empty = MatchEmpty(LoadGroup(ctrl_ + index));
+      if (empty != 0u) {
+        return (index + SlotInGroup(empty)) & BucketMask();
+      }
+      index = (index + kGroupSize) & BucketMask();
+    }
+  }
+
+  void AllocateStorage(size_t num_buckets) {
+    DCHECK(IsPowerOfTwo(num_buckets));
+    DCHECK_GE(num_buckets, kGroupSize);
+    num_buckets_ = num_buckets;
+    data_ = allocfn_.allocate(num_buckets_);
+    for (size_t i = 0; i < num_buckets_; ++i) {
+      allocfn_.construct(allocfn_.address(data_[i]));
+      emptyfn_.MakeEmpty(data_[i]);
+    }
+    ctrl_ = ctrl_allocfn_.allocate(num_buckets_ + kGroupSize - 1u);
+    memset(ctrl_, kEmptyCtrl, num_buckets_ + kGroupSize - 1u);
+  }
+
+  void DeallocateStorage() {
+    if (data_ != nullptr) {
+      for (size_t i = 0; i < num_buckets_; ++i) {
+        allocfn_.destroy(allocfn_.address(data_[i]));
+      }
+      allocfn_.deallocate(data_, num_buckets_);
+      ctrl_allocfn_.deallocate(ctrl_, num_buckets_ + kGroupSize - 1u);
+    }
+    data_ = nullptr;
+    ctrl_ = nullptr;
+    num_buckets_ = 0u;
+  }
+
+  void Resize(size_t new_num_buckets) {
+    DCHECK_LT(Size(), MaxElementsFor(new_num_buckets));
+    T* const old_data = data_;
+    uint8_t* const old_ctrl = ctrl_;
+    const size_t old_num_buckets = num_buckets_;
+    AllocateStorage(new_num_buckets);
+    for (size_t i = 0; i < old_num_buckets; ++i) {
+      T& element = old_data[i];
+      if (old_ctrl[i] != kEmptyCtrl) {
+        const size_t mixed = MixHash(hashfn_(element));
+        const size_t index = FirstEmptySlot(mixed & BucketMask());
+        data_[index] = std::move(element);
+        SetCtrl(index, HashBits(mixed));
+      }
+      allocfn_.destroy(allocfn_.address(element));
+    }
+    if (old_data != nullptr) {
+      allocfn_.deallocate(old_data, old_num_buckets);
+      ctrl_allocfn_.deallocate(old_ctrl, old_num_buckets + kGroupSize - 1u);
+    }
+    elements_until_expand_ = MaxElementsFor(num_buckets_);
+  }
+
+  Alloc allocfn_;  // Allocator function.
+  CtrlAlloc ctrl_allocfn_;  // Allocator function for the control bytes.
+  HashFn hashfn_;  // Hashing function.
+  EmptyFn emptyfn_;  // IsEmpty/SetEmpty function.
+  Pred pred_;  // Equals function.
+  size_t num_elements_;  // Number of inserted elements.
+  size_t num_buckets_;  // Number of hash table buckets, a power of two.
+  size_t elements_until_expand_;  // Maximum number of elements until we expand the table.
+  T* data_;  // Backing storage.
+  uint8_t* ctrl_;  // Control bytes, num_buckets_ + kGroupSize - 1 of them.
+
+  DISALLOW_COPY_AND_ASSIGN(GroupHashSet);
+};
+
+template <class T, class EmptyFn, class HashFn, class Pred, class Alloc>
+void swap(GroupHashSet<T, EmptyFn, HashFn, Pred, Alloc>& lhs,
+          GroupHashSet<T, EmptyFn, HashFn, Pred, Alloc>& rhs) {
+  lhs.swap(rhs);
+}
+
+}  // namespace art
+
+#endif  // ART_LIBARTBASE_BASE_GROUP_HASH_SET_H_
@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "group_hash_set.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "hash_map.h"
+
+namespace art {
+
+struct IsEmptyFnString {
+  void MakeEmpty(std::string& item) const {
+    item.clear();
+  }
+  bool IsEmpty(const std::string& item) const {
+    return item.empty();
+  }
+};
+
+class GroupHashSetTest : public testing::Test {
+ public:
+  GroupHashSetTest() : seed_(97421), unique_number_(0) {
+  }
+  std::string RandomString(size_t len) {
+    std::ostringstream oss;
+    for (size_t i = 0; i < len; ++i) {
+      oss << static_cast<char>('A' + PRand() % 64);
+    }
+    oss << " " << unique_number_++;
+    return oss.str();
+  }
+  void SetSeed(size_t seed) {
+    seed_ = seed;
+  }
+  size_t PRand() {  // Pseudo random.
+    seed_ = seed_ * 1103515245 + 12345;
+    return seed_;
+  }
+
+ private:
+  size_t seed_;
+  size_t unique_number_;
+};
+
+TEST_F(GroupHashSetTest, TestSmoke) {
+  GroupHashSet<std::string, IsEmptyFnString> hash_set;
+  const std::string test_string = "hello world 1234";
+  ASSERT_TRUE(hash_set.Empty());
+  ASSERT_EQ(hash_set.Size(), 0U);
+  ASSERT_TRUE(hash_set.Find(test_string) == hash_set.end());
+  hash_set.Insert(test_string);
+  auto it = hash_set.Find(test_string);
+  ASSERT_EQ(*it, test_string);
+  auto after_it = hash_set.Erase(it);
+  ASSERT_TRUE(after_it == hash_set.end());
+  ASSERT_TRUE(hash_set.Empty());
+  ASSERT_EQ(hash_set.Size(), 0U);
+  it = hash_set.Find(test_string);
+  ASSERT_TRUE(it == hash_set.end());
+}
+
+TEST_F(GroupHashSetTest, TestInsertAndErase) {
+  GroupHashSet<std::string, IsEmptyFnString> hash_set;
+  static constexpr size_t count = 1000;
+  std::vector<std::string> strings;
+  for (size_t i = 0; i < count; ++i) {
+    strings.push_back(RandomString(10));
+    hash_set.Insert(strings[i]);
+    auto it = hash_set.Find(strings[i]);
+    ASSERT_TRUE(it != hash_set.end());
+    ASSERT_EQ(*it, strings[i]);
+  }
+  ASSERT_EQ(strings.size(), hash_set.Size());
+  for (size_t i = 1; i < count; i += 2) {
+    auto it = hash_set.Find(strings[i]);
+    ASSERT_TRUE(it != hash_set.end());
+    ASSERT_EQ(*it, strings[i]);
+    hash_set.Erase(it);
+  }
+  for (size_t i = 1; i < count; i += 2) {
+    ASSERT_TRUE(hash_set.Find(strings[i]) == hash_set.end());
+  }
+  for (size_t i = 0; i < count; i += 2) {
+    auto it = hash_set.Find(strings[i]);
+    ASSERT_TRUE(it != hash_set.end());
+    ASSERT_EQ(*it, strings[i]);
+  }
+}
+
+TEST_F(GroupHashSetTest, TestIterator) {
+  GroupHashSet<std::string, IsEmptyFnString> hash_set;
+  ASSERT_TRUE(hash_set.begin() == hash_set.end());
+  static constexpr size_t count = 1000;
+  std::vector<std::string> strings;
+  for (size_t i = 0; i < count; ++i) {
+    strings.push_back(RandomString(10));
+    hash_set.Insert(strings[i]);
+  }
+  // Make sure we visit each string exactly once.
+  std::map<std::string, size_t> found_count;
+  for (const std::string& s : hash_set) {
+    ++found_count[s];
+  }
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(found_count[strings[i]], 1U);
+  }
+  found_count.clear();
+  // Remove all the elements with iterator erase.
+  for (auto it = hash_set.begin(); it != hash_set.end();) {
+    ++found_count[*it];
+    it = hash_set.Erase(it);
+  }
+  ASSERT_TRUE(hash_set.Empty());
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(found_count[strings[i]], 1U);
+  }
+}
+
+TEST_F(GroupHashSetTest, TestSwap) {
+  GroupHashSet<std::string, IsEmptyFnString> hash_seta, hash_setb;
+  std::vector<std::string> strings;
+  static constexpr size_t count = 1000;
+  for (size_t i = 0; i < count; ++i) {
+    strings.push_back(RandomString(10));
+    hash_seta.Insert(strings[i]);
+  }
+  std::swap(hash_seta, hash_setb);
+  ASSERT_TRUE(hash_seta.Empty());
+  ASSERT_EQ(count, hash_setb.Size());
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_TRUE(hash_setb.Find(strings[i]) != hash_setb.end());
+  }
+}
+
+// Aligned pointers and other weak hashes collide in their low bits.
+struct WeakHash {
+  size_t operator()(size_t value) const {
+    return value << 12;
+  }
+};
+
+TEST_F(GroupHashSetTest, TestStress) {
+  GroupHashSet<size_t, DefaultEmptyFn<size_t>, WeakHash> hash_set;
+  std::unordered_multiset<size_t> std_set;
+  static constexpr size_t value_count = 2000;
+  static constexpr size_t operations = 100000;
+  static constexpr size_t target_size = 5000;
+  const size_t seed = time(nullptr);
+  SetSeed(seed);
+  LOG(INFO) << "Starting stress test with seed " << seed;
+  for (size_t i = 0; i < operations; ++i) {
+    ASSERT_EQ(hash_set.Size(), std_set.size());
+    size_t delta = std::abs(static_cast<ssize_t>(target_size) -
+                            static_cast<ssize_t>(hash_set.Size()));
+    size_t n = PRand();
+    if (n % target_size == 0) {
+      hash_set.Clear();
+      std_set.clear();
+      ASSERT_TRUE(hash_set.Empty());
+    } else if (n % target_size < delta) {
+      // Skew towards adding elements until we are at the desired size.
+      const size_t value = 1u + PRand() % value_count;
+      hash_set.Insert(value);
+      std_set.insert(value);
+      ASSERT_EQ(*hash_set.Find(value), value);
+    } else {
+      const size_t value = 1u + PRand() % value_count;
+      auto it = hash_set.Find(value);
+      auto std_it = std_set.find(value);
+      ASSERT_EQ(it == hash_set.end(), std_it == std_set.end());
+      if (it != hash_set.end()) {
+        ASSERT_EQ(*it, value);
+        hash_set.Erase(it);
+        std_set.erase(std_it);
+      }
+    }
+  }
+  size_t visited = 0u;
+  for (size_t value : hash_set) {
+    ASSERT_NE(std_set.end(), std_set.find(value));
+    ++visited;
+  }
+  ASSERT_EQ(std_set.size(), visited);
+}
+
+struct IsEmptyStringPair {
+  void MakeEmpty(std::pair<std::string, int>& pair) const {
+    pair.first.clear();
+  }
+  bool IsEmpty(const std::pair<std::string, int>& pair) const {
+    return pair.first.empty();
+  }
+};
+
+TEST_F(GroupHashSetTest, TestGroupHashMap) {
+  GroupHashMap<std::string, int, IsEmptyStringPair> hash_map;
+  hash_map.Insert(std::make_pair(std::string("abcd"), 123));
+  hash_map.Insert(std::make_pair(std::string("abcd"), 124));
+  hash_map.Insert(std::make_pair(std::string("bags"), 444));
+  auto it = hash_map.Find(std::string("abcd"));
+  ASSERT_EQ(it->second, 123);
+  hash_map.Erase(it);
+  it = hash_map.Find(std::string("abcd"));
+  ASSERT_EQ(it->second, 124);
+  ASSERT_EQ(hash_map.Find(std::string("bags"))->second, 444);
+}
+
+struct StringHashEquals {
+  size_t operator()(const std::string& item) const {
+    return std::hash<std::string>()(item);
+  }
+  size_t operator()(const char* item) const {
+    return std::hash<std::string>()(item);
+  }
+  bool operator()(const std::string& a, const std::string& b) const {
+    return a == b;
+  }
+  bool operator()(const std::string& a, const char* b) const {
+    return a == b;
+  }
+};
+
+TEST_F(GroupHashSetTest, TestLookupByAlternateKeyType) {
+  GroupHashSet<std::string, IsEmptyFnString, StringHashEquals, StringHashEquals>
+      hash_set;
+  hash_set.Insert(std::string("abcd"));
+  hash_set.Insert(std::string("ef"));
+  ASSERT_EQ(hash_set.end(), hash_set.Find("abc"));
+  ASSERT_NE(hash_set.end(), hash_set.Find("abcd"));
+  ASSERT_NE(hash_set.end(), hash_set.Find("ef"));
+}
+
+TEST_F(GroupHashSetTest, TestReserve) {
+  GroupHashSet<std::string, IsEmptyFnString> hash_set;
+  std::vector<size_t> sizes = {1, 10, 25, 55, 128, 1024, 4096};
+  for (size_t size : sizes) {
+    hash_set.Reserve(size);
+    const size_t buckets_before = hash_set.NumBuckets();
+    // Check that we expanded enough.
+    CHECK_GE(hash_set.ElementsUntilExpand(), size);
+    // Try inserting elements until we are at our reserve size and ensure the hash set did not
+    // expand.
+    while (hash_set.Size() < size) {
+      hash_set.Insert(std::to_string(hash_set.Size()));
+    }
+    CHECK_EQ(hash_set.NumBuckets(), buckets_before);
+  }
+  EXPECT_LE(hash_set.CalculateLoadFactor(), 0.875);
+}
+
+}  // namespace art
@@ -19,6 +19,7 @@
 
 #include <utility>
 
+#include "group_hash_set.h"
 #include "hash_set.h"
 
 namespace art {
@@ -69,6 +70,28 @@ class HashMap : public HashSet<std::pair<Key, Value>,
       : Base(alloc) { }
 };
 
+// HashMap on top of GroupHashSet.
+template <class Key, class Value, class EmptyFn,
+    class HashFn = std::hash<Key>, class Pred = std::equal_to<Key>,
+    class Alloc = std::allocator<std::pair<Key, Value>>>
+class GroupHashMap : public GroupHashSet<std::pair<Key, Value>,
+                                         EmptyFn,
+                                         HashMapWrapper<HashFn>,
+                                         HashMapWrapper<Pred>,
+                                         Alloc> {
+ private:
+  using Base = GroupHashSet<std::pair<Key, Value>,
+                            EmptyFn,
+                            HashMapWrapper<HashFn>,
+                            HashMapWrapper<Pred>,
+                            Alloc>;
+
+ public:
+  GroupHashMap() : Base() { }
+  explicit GroupHashMap(const Alloc& alloc)
+      : Base(alloc) { }
+};
+
 }  // namespace art
 
 #endif  // ART_LIBARTBASE_BASE_HASH_MAP_H_
@@ -77,6 +77,11 @@ template <class Value> class Histogram {
     return sum_ * kAdjust;
   }
 
+  // Percentile() of values added with AdjustAndAddValue(), in the original unit.
+  double AdjustedPercentile(double per, const CumulativeData& data) const {
+    return Percentile(per, data) * kAdjust;
+  }
+
   Value Min() const {
     return min_value_added_;
   }
@@ -16,6 +16,8 @@
 
 #include "utf.h"
 
+#include <string.h>
+
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
@@ -28,6 +30,30 @@ namespace art {
 using android::base::StringAppendF;
 using android::base::StringPrintf;
 
+// The ASCII fast paths below test eight bytes, or four UTF-16 chars, at a time in a word read
+// with memcpy(), which compiles to a single unaligned load. Copying the bytes of such a run
+// is left to simple loops that the compiler vectorizes.
+static constexpr size_t kAsciiRunBytes = sizeof(uint64_t);
+static constexpr size_t kAsciiRunChars = sizeof(uint64_t) / sizeof(uint16_t);
+
+// Returns whether the kAsciiRunBytes bytes at `utf8` are all ASCII.
+static inline bool IsAsciiRun(const char* utf8) {
+  uint64_t word;
+  memcpy(&word, utf8, sizeof(word));
+  return (word & UINT64_C(0x8080808080808080)) == 0u;
+}
+
+// Returns whether the kAsciiRunChars chars at `utf16` are all in [1, 0x7f], which are encoded as
+// one byte each in modified UTF-8.
+static inline bool IsAsciiRun(const uint16_t* utf16) {
+  uint64_t word;
+  memcpy(&word, utf16, sizeof(word));
+  constexpr uint64_t kLowBits = UINT64_C(0x0001000100010001);
+  constexpr uint64_t kHighBits = UINT64_C(0x8000800080008000);
+  const bool has_zero = ((word - kLowBits) & ~word & kHighBits) != 0u;
+  return (word & UINT64_C(0xff80ff80ff80ff80)) == 0u && !has_zero;
+}
+
 // This is used only from debugger and test code.
 size_t CountModifiedUtf8Chars(const char* utf8) {
   return CountModifiedUtf8Chars(utf8, strlen(utf8));
@@ -53,6 +79,13 @@ size_t CountModifiedUtf8Chars(const char* utf8, size_t byte_count) {
   size_t len = 0;
   const char* end = utf8 + byte_count;
   for (; utf8 < end; ++utf8) {
+    while (static_cast<size_t>(end - utf8) >= kAsciiRunBytes && IsAsciiRun(utf8)) {
+      utf8 += kAsciiRunBytes;
+      len += kAsciiRunBytes;
+    }
+    if (utf8 == end) {
+      break;
+    }
     int ic = *utf8;
     len++;
     if (LIKELY((ic & 0x80) == 0)) {
@@ -109,8 +142,17 @@ void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_data_out, size_t out_chars,
     return;
   }
 
-  // String contains non-ASCII characters.
+  // String contains non-ASCII characters. Each ASCII byte still converts to one char, so copy
+  // runs of them directly.
   for (const char *p = in_start; p < in_end;) {
+    if (static_cast<size_t>(in_end - p) >= kAsciiRunBytes && IsAsciiRun(p)) {
+      for (size_t i = 0; i != kAsciiRunBytes; ++i) {
+        out_p[i] = static_cast<uint8_t>(p[i]);
+      }
+      out_p += kAsciiRunBytes;
+      p += kAsciiRunBytes;
+      continue;
+    }
     const uint32_t ch = GetUtf16FromUtf8(&p);
     const uint16_t leading = GetLeadingUtf16Char(ch);
     const uint16_t trailing = GetTrailingUtf16Char(ch);
@@ -135,6 +177,15 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
 
   // String contains non-ASCII characters.
   while (char_count--) {
+    if (char_count + 1u >= kAsciiRunChars && IsAsciiRun(utf16_in)) {
+      for (size_t i = 0; i != kAsciiRunChars; ++i) {
+        utf8_out[i] = static_cast<char>(utf16_in[i]);
+      }
+      utf8_out += kAsciiRunChars;
+      utf16_in += kAsciiRunChars;
+      char_count -= kAsciiRunChars - 1u;
+      continue;
+    }
     const uint16_t ch = *utf16_in++;
     if (ch > 0 && ch <= 0x7f) {
       *utf8_out++ = ch;
@@ -178,6 +229,16 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
 int32_t ComputeUtf16HashFromModifiedUtf8(const char* utf8, size_t utf16_length) {
   uint32_t hash = 0;
   while (utf16_length != 0u) {
+    // ASCII bytes are one char each, hash them four at a time (see ComputeUtf16Hash()). Every
+    // char takes at least one byte, so the word read stays within the string.
+    if (utf16_length >= kAsciiRunBytes && IsAsciiRun(utf8)) {
+      for (size_t i = 0; i != kAsciiRunBytes; i += 4u) {
+        hash = HashUtf16Quad(hash, utf8[i], utf8[i + 1], utf8[i + 2], utf8[i + 3]);
+      }
+      utf8 += kAsciiRunBytes;
+      utf16_length -= kAsciiRunBytes;
+      continue;
+    }
     const uint32_t pair = GetUtf16FromUtf8(&utf8);
     const uint16_t first = GetLeadingUtf16Char(pair);
     hash = hash * 31 + first;
@@ -194,6 +255,12 @@ int32_t ComputeUtf16HashFromModifiedUtf8(const char* utf8, size_t utf16_length)
 
 uint32_t ComputeModifiedUtf8Hash(const char* chars) {
   uint32_t hash = 0;
+  // Hash four chars per step while none of them is the terminator. Only the first char of
+  // each step is known to be readable, so test them one by one.
+  while (chars[0] != '\0' && chars[1] != '\0' && chars[2] != '\0' && chars[3] != '\0') {
+    hash = HashUtf16Quad(hash, chars[0], chars[1], chars[2], chars[3]);
+    chars += 4;
+  }
   while (*chars != '\0') {
     hash = hash * 31 + *chars++;
   }
@@ -240,6 +307,11 @@ size_t CountUtf8Bytes(const uint16_t* chars, size_t char_count) {
   size_t result = 0;
   const uint16_t *end = chars + char_count;
   while (chars < end) {
+    if (static_cast<size_t>(end - chars) >= kAsciiRunChars && IsAsciiRun(chars)) {
+      chars += kAsciiRunChars;
+      result += kAsciiRunChars;
+      continue;
+    }
     const uint16_t ch = *chars++;
     if (LIKELY(ch != 0 && ch < 0x80)) {
       result++;
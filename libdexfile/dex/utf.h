@@ -73,12 +73,25 @@ int CompareModifiedUtf8ToUtf16AsCodePointValues(const char* utf8, const uint16_t
 void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
                                 const uint16_t* utf16_in, size_t char_count);
 
+// Hash four chars in one step of the java.lang.String hashCode() algorithm. The result is the
+// same as hashing them one by one, but the multiplications do not depend on each other.
+inline uint32_t HashUtf16Quad(uint32_t hash, uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) {
+  return hash * (31u * 31u * 31u * 31u) +
+         c0 * (31u * 31u * 31u) +
+         c1 * (31u * 31u) +
+         c2 * 31u +
+         c3;
+}
+
 /*
  * The java.lang.String hashCode() algorithm.
  */
 template<typename MemoryType>
 int32_t ComputeUtf16Hash(const MemoryType* chars, size_t char_count) {
   uint32_t hash = 0;
+  for (; char_count >= 4u; char_count -= 4u, chars += 4) {
+    hash = HashUtf16Quad(hash, chars[0], chars[1], chars[2], chars[3]);
+  }
   while (char_count--) {
     hash = hash * 31 + *chars++;
   }
@@ -378,4 +378,64 @@ TEST_F(UtfTest, ExhaustiveBidirectionalCodePointCheck) {
   }
 }
 
+static uint32_t ComputeHash_reference(const char* chars) {
+  uint32_t hash = 0;
+  while (*chars != '\0') {
+    hash = hash * 31 + *chars++;
+  }
+  return hash;
+}
+
+static int32_t ComputeUtf16Hash_reference(const uint16_t* chars, size_t char_count) {
+  uint32_t hash = 0;
+  while (char_count--) {
+    hash = hash * 31 + *chars++;
+  }
+  return static_cast<int32_t>(hash);
+}
+
+// Check the conversions and hashes of ASCII strings long enough for the word-at-a-time fast
+// paths, with one non-ASCII character or surrogate pair at each position.
+TEST_F(UtfTest, AsciiRunsWithOneNonAsciiChar) {
+  static constexpr size_t kLength = 21;
+  static const uint32_t kCodePoints[] = {
+      0x00, 0x41, 0x7f, 0x80, 0x7ff, 0x800, 0xd800, 0xdc00, 0xffff, 0x10000, 0x10ffff };
+  for (uint32_t code_point : kCodePoints) {
+    for (size_t pos = 0; pos != kLength; ++pos) {
+      std::vector<uint16_t> chars;
+      for (size_t i = 0; i != kLength; ++i) {
+        if (i != pos) {
+          chars.push_back('a' + (i % 26));
+        } else if (code_point <= 0xffff) {
+          chars.push_back(code_point);
+        } else {
+          uint16_t first, second;
+          codePointToSurrogatePair(code_point, first, second);
+          chars.push_back(first);
+          chars.push_back(second);
+        }
+      }
+      const size_t char_count = chars.size();
+      const size_t byte_count = CountUtf8Bytes(chars.data(), char_count);
+      EXPECT_EQ(CountUtf8Bytes_reference(chars.data(), char_count), byte_count);
+
+      std::vector<char> bytes(byte_count + 1u, '\0');
+      std::vector<char> bytes_reference(byte_count + 1u, '\0');
+      ConvertUtf16ToModifiedUtf8(bytes.data(), byte_count, chars.data(), char_count);
+      ConvertUtf16ToModifiedUtf8_reference(bytes_reference.data(), chars.data(), char_count);
+      EXPECT_EQ(bytes_reference, bytes);
+
+      EXPECT_EQ(char_count, CountModifiedUtf8Chars(bytes.data(), byte_count));
+      std::vector<uint16_t> out(char_count);
+      ConvertModifiedUtf8ToUtf16(out.data(), char_count, bytes.data(), byte_count);
+      EXPECT_EQ(chars, out);
+
+      EXPECT_EQ(ComputeHash_reference(bytes.data()), ComputeModifiedUtf8Hash(bytes.data()));
+      const int32_t utf16_hash = ComputeUtf16Hash_reference(chars.data(), char_count);
+      EXPECT_EQ(utf16_hash, ComputeUtf16Hash(chars.data(), char_count));
+      EXPECT_EQ(utf16_hash, ComputeUtf16HashFromModifiedUtf8(bytes.data(), char_count));
+    }
+  }
+}
+
 }  // namespace art
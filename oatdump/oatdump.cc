@@ -17,11 +17,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -352,7 +357,8 @@ class OatDumperOptions {
                    const char* export_dex_location,
                    const char* app_image,
                    const char* app_oat,
-                   uint32_t addr2instr)
+                   uint32_t addr2instr,
+                   size_t jobs)
     : dump_vmap_(dump_vmap),
       dump_code_info_stack_maps_(dump_code_info_stack_maps),
       disassemble_code_(disassemble_code),
@@ -366,6 +372,7 @@ class OatDumperOptions {
       app_image_(app_image),
       app_oat_(app_oat),
       addr2instr_(addr2instr),
+      jobs_(jobs),
       class_loader_(nullptr) {}
 
   const bool dump_vmap_;
@@ -381,6 +388,8 @@ class OatDumperOptions {
   const char* const app_image_;
   const char* const app_oat_;
   uint32_t addr2instr_;
+  // Number of threads used to dump methods. Only the runtime-free oat dump is parallel.
+  const size_t jobs_;
   Handle<mirror::ClassLoader>* class_loader_;
 };
 
@@ -392,21 +401,27 @@ class OatDumper {
       options_(options),
       resolved_addr2instr_(0),
       instruction_set_(oat_file_.GetOatHeader().GetInstructionSet()),
-      disassembler_(Disassembler::Create(instruction_set_,
-                                         new DisassemblerOptions(
-                                             options_.absolute_addresses_,
-                                             oat_file.Begin(),
-                                             oat_file.End(),
-                                             true /* can_read_literals_ */,
-                                             Is64BitInstructionSet(instruction_set_)
-                                                 ? &Thread::DumpThreadOffset<PointerSize::k64>
-                                                 : &Thread::DumpThreadOffset<PointerSize::k32>))) {
+      parent_(nullptr),
+      disassembler_(CreateDisassembler()),
+      stats_(own_stats_) {
     CHECK(options_.class_loader_ != nullptr);
     CHECK(options_.class_filter_ != nullptr);
     CHECK(options_.method_filter_ != nullptr);
     AddAllOffsets();
   }
 
+  // Creates a dumper for a worker thread of `parent`. It shares the offsets and the statistics
+  // of `parent` but has its own disassembler, as disassemblers are not thread-safe.
+  explicit OatDumper(OatDumper* parent)
+    : oat_file_(parent->oat_file_),
+      oat_dex_files_(parent->oat_dex_files_),
+      options_(parent->options_),
+      resolved_addr2instr_(parent->resolved_addr2instr_),
+      instruction_set_(parent->instruction_set_),
+      parent_(parent),
+      disassembler_(CreateDisassembler()),
+      stats_(parent->stats_) {}
+
   ~OatDumper() {
     delete disassembler_;
   }
@@ -650,8 +665,9 @@ class OatDumper {
     }
     uintptr_t begin_offset = reinterpret_cast<uintptr_t>(oat_data) -
                              reinterpret_cast<uintptr_t>(oat_file_.Begin());
-    auto it = offsets_.upper_bound(begin_offset);
-    CHECK(it != offsets_.end());
+    const std::set<uintptr_t>& offsets = (parent_ != nullptr) ? parent_->offsets_ : offsets_;
+    auto it = offsets.upper_bound(begin_offset);
+    CHECK(it != offsets.end());
     uintptr_t end_offset = *it;
     return end_offset - begin_offset;
   }
@@ -766,18 +782,22 @@ class OatDumper {
     // Since code has deduplication, seen tracks already seen pointers to avoid double counting
     // deduplicated code and tables.
     std::unordered_set<const void*> seen;
+    // Guards `bits` and `seen`, which are shared by the worker threads of a parallel dump.
+    std::mutex lock;
 
     // Returns true if it was newly added.
     bool AddBitsIfUnique(ByteKind kind, int64_t count, const void* address) {
+      std::lock_guard<std::mutex> mu(lock);
       if (seen.insert(address).second == true) {
         // True means the address was not already in the set.
-        AddBits(kind, count);
+        bits[kind] += count;
         return true;
       }
       return false;
     }
 
     void AddBits(ByteKind kind, int64_t count) {
+      std::lock_guard<std::mutex> mu(lock);
       bits[kind] += count;
     }
 
@@ -1092,35 +1112,26 @@ class OatDumper {
                          table_offset + table_size - 1);
     }
 
-    VariableIndentationOutputStream vios(&os);
-    ScopedIndentation indent1(&vios);
-    for (size_t class_def_index = 0;
-         class_def_index < dex_file->NumClassDefs();
-         class_def_index++) {
-      const DexFile::ClassDef& class_def = dex_file->GetClassDef(class_def_index);
-      const char* descriptor = dex_file->GetClassDescriptor(class_def);
-
-      // TODO: Support regex
-      if (DescriptorToDot(descriptor).find(options_.class_filter_) == std::string::npos) {
-        continue;
-      }
-
-      uint32_t oat_class_offset = oat_dex_file.GetOatClassOffset(class_def_index);
-      const OatFile::OatClass oat_class = oat_dex_file.GetOatClass(class_def_index);
-      os << StringPrintf("%zd: %s (offset=0x%08x) (type_idx=%d)",
-                         class_def_index, descriptor, oat_class_offset, class_def.class_idx_.index_)
-         << " (" << oat_class.GetStatus() << ")"
-         << " (" << oat_class.GetType() << ")\n";
-      // TODO: include bitmap here if type is kOatClassSomeCompiled?
-      if (options_.list_classes_) {
-        continue;
-      }
-      if (!DumpOatClass(&vios, oat_class, *dex_file, class_def, &stop_analysis)) {
+    // The verifier needs the runtime and --addr2instr stops at the first matching method, so
+    // only the runtime-free full dump is done in parallel.
+    if (options_.jobs_ > 1 && Runtime::Current() == nullptr && resolved_addr2instr_ == 0) {
+      if (!DumpOatClassDefsParallel(os, oat_dex_file, *dex_file)) {
         success = false;
       }
-      if (stop_analysis) {
-        os << std::flush;
-        return success;
+    } else {
+      VariableIndentationOutputStream vios(&os);
+      ScopedIndentation indent1(&vios);
+      for (size_t class_def_index = 0;
+           class_def_index < dex_file->NumClassDefs();
+           class_def_index++) {
+        if (!DumpOatClassDef(os, &vios, oat_dex_file, *dex_file, class_def_index,
+                             &stop_analysis)) {
+          success = false;
+        }
+        if (stop_analysis) {
+          os << std::flush;
+          return success;
+        }
       }
     }
     os << "\n";
@@ -1128,6 +1139,92 @@ class OatDumper {
     return success;
   }
 
+  bool DumpOatClassDef(std::ostream& os,
+                       VariableIndentationOutputStream* vios,
+                       const OatFile::OatDexFile& oat_dex_file,
+                       const DexFile& dex_file,
+                       size_t class_def_index,
+                       bool* stop_analysis) {
+    const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
+    const char* descriptor = dex_file.GetClassDescriptor(class_def);
+
+    // TODO: Support regex
+    if (DescriptorToDot(descriptor).find(options_.class_filter_) == std::string::npos) {
+      return true;
+    }
+
+    uint32_t oat_class_offset = oat_dex_file.GetOatClassOffset(class_def_index);
+    const OatFile::OatClass oat_class = oat_dex_file.GetOatClass(class_def_index);
+    os << StringPrintf("%zd: %s (offset=0x%08x) (type_idx=%d)",
+                       class_def_index, descriptor, oat_class_offset, class_def.class_idx_.index_)
+       << " (" << oat_class.GetStatus() << ")"
+       << " (" << oat_class.GetType() << ")\n";
+    // TODO: include bitmap here if type is kOatClassSomeCompiled?
+    if (options_.list_classes_) {
+      return true;
+    }
+    return DumpOatClass(vios, oat_class, dex_file, class_def, stop_analysis);
+  }
+
+  static constexpr size_t kClassDefsPerChunk = 16;
+
+  // Dumps the classes of `dex_file` on `options_.jobs_` worker threads. The class defs are split
+  // into chunks of kClassDefsPerChunk, each dumped to its own buffer, and the buffers are written
+  // to `os` in class def order as they complete, so the output matches the serial dump.
+  bool DumpOatClassDefsParallel(std::ostream& os,
+                                const OatFile::OatDexFile& oat_dex_file,
+                                const DexFile& dex_file) {
+    const size_t num_class_defs = dex_file.NumClassDefs();
+    const size_t num_chunks = RoundUp(num_class_defs, kClassDefsPerChunk) / kClassDefsPerChunk;
+    std::vector<std::ostringstream> chunks(num_chunks);
+    std::vector<uint8_t> chunk_done(num_chunks, 0u);
+    std::vector<uint8_t> chunk_success(num_chunks, 1u);
+    std::mutex lock;
+    std::condition_variable chunk_done_cond;
+    std::atomic<size_t> next_chunk(0u);
+    auto dump_chunks = [&]() {
+      OatDumper worker(this);
+      for (size_t i = next_chunk.fetch_add(1u); i < num_chunks; i = next_chunk.fetch_add(1u)) {
+        VariableIndentationOutputStream vios(&chunks[i]);
+        ScopedIndentation indent1(&vios);
+        bool stop_analysis = false;
+        const size_t end = std::min(num_class_defs, (i + 1u) * kClassDefsPerChunk);
+        for (size_t class_def_index = i * kClassDefsPerChunk; class_def_index < end;
+             ++class_def_index) {
+          if (!worker.DumpOatClassDef(chunks[i], &vios, oat_dex_file, dex_file, class_def_index,
+                                      &stop_analysis)) {
+            chunk_success[i] = 0u;
+          }
+        }
+        std::lock_guard<std::mutex> mu(lock);
+        chunk_done[i] = 1u;
+        chunk_done_cond.notify_all();
+      }
+    };
+    // The worker threads are not attached to the runtime; there is none in this mode.
+    std::vector<std::thread> threads;
+    const size_t num_threads = std::min(num_chunks, options_.jobs_);
+    for (size_t i = 0; i < num_threads; ++i) {
+      threads.emplace_back(dump_chunks);
+    }
+    bool success = true;
+    for (size_t i = 0; i < num_chunks; ++i) {
+      {
+        std::unique_lock<std::mutex> mu(lock);
+        chunk_done_cond.wait(mu, [&]() { return chunk_done[i] != 0u; });
+      }
+      os << chunks[i].str();
+      chunks[i].str("");  // Release the buffer.
+      if (chunk_success[i] == 0u) {
+        success = false;
+      }
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    return success;
+  }
+
   // Backwards compatible Dex file export. If dex_file is nullptr (valid Vdex file not present) the
   // Dex resource is extracted from the oat_dex_file and its checksum is repaired since it's not
   // unquickened. Otherwise the dex_file has been fully unquickened and is expected to verify the
@@ -1961,14 +2058,30 @@ class OatDumper {
     os << std::dec;
   }
 
+  Disassembler* CreateDisassembler() {
+    return Disassembler::Create(instruction_set_,
+                                new DisassemblerOptions(
+                                    options_.absolute_addresses_,
+                                    oat_file_.Begin(),
+                                    oat_file_.End(),
+                                    true /* can_read_literals_ */,
+                                    Is64BitInstructionSet(instruction_set_)
+                                        ? &Thread::DumpThreadOffset<PointerSize::k64>
+                                        : &Thread::DumpThreadOffset<PointerSize::k32>));
+  }
+
   const OatFile& oat_file_;
   const std::vector<const OatFile::OatDexFile*> oat_dex_files_;
   const OatDumperOptions& options_;
   uint32_t resolved_addr2instr_;
   const InstructionSet instruction_set_;
+  // The dumper that created this one for a worker thread, or null.
+  OatDumper* const parent_;
   std::set<uintptr_t> offsets_;
   Disassembler* disassembler_;
-  Stats stats_;
+  Stats own_stats_;
+  // Refers to `own_stats_`, or to the statistics of `parent_` for worker dumpers.
+  Stats& stats_;
 };
 
 class ImageDumper {
@@ -3072,6 +3185,86 @@ static int DumpOatWithRuntime(Runtime* runtime,
   return (success) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
+// Dumps the header of an image file and the statistics of its live bitmap. This reads the file
+// directly, without loading it into a runtime, so it is fast even for large boot images.
+static int DumpImageSummary(const char* image_filename, std::ostream* os) {
+  std::unique_ptr<File> file(OS::OpenFileForReading(image_filename));
+  if (file == nullptr) {
+    LOG(ERROR) << "Failed to open image file '" << image_filename << "'";
+    return EXIT_FAILURE;
+  }
+  ImageHeader image_header;
+  if (!file->ReadFully(&image_header, sizeof(image_header)) || !image_header.IsValid()) {
+    LOG(ERROR) << "Invalid image header in '" << image_filename << "'";
+    return EXIT_FAILURE;
+  }
+
+  *os << "MAGIC: " << image_header.GetMagic() << "\n\n";
+  *os << "IMAGE FILE: " << image_filename << "\n\n";
+  *os << "IMAGE BEGIN: " << reinterpret_cast<void*>(image_header.GetImageBegin()) << "\n\n";
+  *os << "IMAGE SIZE: " << image_header.GetImageSize() << "\n\n";
+  *os << "STORAGE MODE: " << image_header.GetStorageMode() << "\n\n";
+  for (size_t i = 0; i < ImageHeader::kSectionCount; ++i) {
+    auto section = static_cast<ImageHeader::ImageSections>(i);
+    *os << "IMAGE SECTION " << section << ": " << image_header.GetImageSection(section) << "\n\n";
+  }
+  *os << "OAT CHECKSUM: " << StringPrintf("0x%08x\n\n", image_header.GetOatChecksum());
+  *os << "OAT FILE BEGIN:" << reinterpret_cast<void*>(image_header.GetOatFileBegin()) << "\n\n";
+  *os << "OAT FILE END:" << reinterpret_cast<void*>(image_header.GetOatFileEnd()) << "\n\n";
+  *os << "PATCH DELTA:" << image_header.GetPatchDelta() << "\n\n";
+  *os << "COMPILE PIC: " << (image_header.CompilePic() ? "yes" : "no") << "\n\n";
+
+  // The bitmap is stored uncompressed in the first aligned page after the stored data, with one
+  // bit per kObjectAlignment bytes of the image, see ImageSpace::Init().
+  const ImageSection& bitmap_section = image_header.GetImageBitmapSection();
+  const size_t bitmap_offset = RoundUp(sizeof(ImageHeader) + image_header.GetDataSize(),
+                                       kPageSize);
+  if (bitmap_section.Size() == 0u ||
+      bitmap_offset + bitmap_section.Size() > static_cast<uint64_t>(file->GetLength())) {
+    LOG(ERROR) << "Image bitmap not found in '" << image_filename << "'";
+    return EXIT_FAILURE;
+  }
+  std::string error_msg;
+  std::unique_ptr<MemMap> bitmap_map(MemMap::MapFile(bitmap_section.Size(),
+                                                     PROT_READ,
+                                                     MAP_PRIVATE,
+                                                     file->Fd(),
+                                                     bitmap_offset,
+                                                     /*low_4gb*/false,
+                                                     image_filename,
+                                                     &error_msg));
+  if (bitmap_map == nullptr) {
+    LOG(ERROR) << "Failed to map image bitmap: " << error_msg;
+    return EXIT_FAILURE;
+  }
+  // Each page of the image is covered by kBitmapBytesPerPage bytes of the bitmap.
+  constexpr size_t kBitmapBytesPerPage = kPageSize / kObjectAlignment / kBitsPerByte;
+  const uint8_t* bitmap = bitmap_map->Begin();
+  size_t num_objects = 0u;
+  size_t num_object_pages = 0u;
+  size_t max_objects_per_page = 0u;
+  for (size_t page_begin = 0u; page_begin < bitmap_section.Size();
+       page_begin += kBitmapBytesPerPage) {
+    const size_t page_end = std::min<size_t>(page_begin + kBitmapBytesPerPage,
+                                             bitmap_section.Size());
+    size_t page_objects = 0u;
+    for (size_t i = page_begin; i != page_end; ++i) {
+      page_objects += POPCOUNT(bitmap[i]);
+    }
+    num_objects += page_objects;
+    num_object_pages += (page_objects != 0u) ? 1u : 0u;
+    max_objects_per_page = std::max(max_objects_per_page, page_objects);
+  }
+  const size_t object_bytes = image_header.GetObjectsSection().Size();
+  *os << "OBJECTS: " << num_objects << "\n\n";
+  *os << "OBJECT PAGES: " << num_object_pages << "\n\n";
+  *os << "MAX OBJECTS PER PAGE: " << max_objects_per_page << "\n\n";
+  *os << "AVERAGE OBJECT SIZE: " << ((num_objects != 0u) ? object_bytes / num_objects : 0u)
+      << "\n\n";
+  *os << std::flush;
+  return EXIT_SUCCESS;
+}
+
 static int DumpOatWithoutRuntime(OatFile* oat_file, OatDumperOptions* options, std::ostream* os) {
   CHECK(oat_file != nullptr && options != nullptr);
   // No image = no class loader.
@@ -3641,6 +3834,13 @@ struct OatdumpArgs : public CmdlineArgs {
         *error_msg = "Address conversion failed";
         return kParseError;
       }
+    } else if (option.starts_with("--image-summary=")) {
+      image_summary_ = option.substr(strlen("--image-summary=")).data();
+    } else if (option.starts_with("-j")) {
+      if (!ParseUint(option.substr(strlen("-j")).data(), &jobs_) || jobs_ == 0u) {
+        *error_msg = "Invalid number of jobs";
+        return kParseError;
+      }
     } else if (option.starts_with("--app-image=")) {
       app_image_ = option.substr(strlen("--app-image=")).data();
     } else if (option.starts_with("--app-oat=")) {
@@ -3669,7 +3869,12 @@ struct OatdumpArgs : public CmdlineArgs {
     }
 
     // Perform our own checks.
-    if (image_location_ == nullptr && oat_filename_ == nullptr) {
+    if (image_summary_ != nullptr) {
+      if (image_location_ != nullptr || oat_filename_ != nullptr) {
+        *error_msg = "--image-summary cannot be used with --image or --oat-file";
+        return kParseError;
+      }
+    } else if (image_location_ == nullptr && oat_filename_ == nullptr) {
       *error_msg = "Either --image or --oat-file must be specified";
       return kParseError;
     } else if (image_location_ != nullptr && oat_filename_ != nullptr) {
@@ -3695,6 +3900,11 @@ struct OatdumpArgs : public CmdlineArgs {
         "  --image=<file.art>: specifies an input image location.\n"
         "      Example: --image=/system/framework/boot.art\n"
         "\n"
+        "  --image-summary=<file.art>: dumps the header and object bitmap statistics of\n"
+        "      an image file without starting a runtime. Takes the path of the image file\n"
+        "      itself, including the instruction set directory.\n"
+        "      Example: --image-summary=/system/framework/arm64/boot.art\n"
+        "\n"
         "  --app-image=<file.art>: specifies an input app image. Must also have a specified\n"
         " boot image (with --image) and app oat file (with --app-oat).\n"
         "      Example: --app-image=app.art\n"
@@ -3742,6 +3952,10 @@ struct OatdumpArgs : public CmdlineArgs {
         "  --export-dex-to=<directory>: may be used to export oat embedded dex files.\n"
         "      Example: --export-dex-to=/data/local/tmp\n"
         "\n"
+        "  -j<number>: number of threads used to dump the methods of an oat file. Only\n"
+        "      used when dumping an oat file without a boot image and without --addr2instr.\n"
+        "      Example: -j8\n"
+        "\n"
         "  --addr2instr=<address>: output matching method disassembled code from relative\n"
         "                          address (e.g. PC from crash dump)\n"
         "      Example: --addr2instr=0x00001a3b\n"
@@ -3778,9 +3992,11 @@ struct OatdumpArgs : public CmdlineArgs {
   bool dump_header_only_ = false;
   bool imt_stat_dump_ = false;
   uint32_t addr2instr_ = 0;
+  uint32_t jobs_ = 1;
   const char* export_dex_location_ = nullptr;
   const char* app_image_ = nullptr;
   const char* app_oat_ = nullptr;
+  const char* image_summary_ = nullptr;
 };
 
 struct OatdumpMain : public CmdlineMain<OatdumpArgs> {
@@ -3803,21 +4019,25 @@ struct OatdumpMain : public CmdlineMain<OatdumpArgs> {
         args_->export_dex_location_,
         args_->app_image_,
         args_->app_oat_,
-        args_->addr2instr_));
+        args_->addr2instr_,
+        args_->jobs_));
 
     return (args_->boot_image_location_ != nullptr ||
             args_->image_location_ != nullptr ||
             !args_->imt_dump_.empty()) &&
-          !args_->symbolize_;
+          !args_->symbolize_ &&
+          args_->image_summary_ == nullptr;
   }
 
   virtual bool ExecuteWithoutRuntime() OVERRIDE {
     CHECK(args_ != nullptr);
-    CHECK(args_->oat_filename_ != nullptr);
+    CHECK(args_->oat_filename_ != nullptr || args_->image_summary_ != nullptr);
 
     MemMap::Init();
 
-    if (args_->symbolize_) {
+    if (args_->image_summary_ != nullptr) {
+      return DumpImageSummary(args_->image_summary_, args_->os_) == EXIT_SUCCESS;
+    } else if (args_->symbolize_) {
       // ELF has special kind of section called SHT_NOBITS which allows us to create
       // sections which exist but their data is omitted from the ELF file to save space.
       // This is what "strip --only-keep-debug" does when it creates separate ELF file
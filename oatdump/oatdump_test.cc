@@ -71,6 +71,11 @@ TEST_F(OatDumpTest, TestSymbolizeStatic) {
   ASSERT_TRUE(Exec(kStatic, kModeSymbolize, {}, kListOnly, &error_msg)) << error_msg;
 }
 
+TEST_F(OatDumpTest, TestParallelDump) {
+  std::string error_msg;
+  ASSERT_TRUE(Exec(kDynamic, kModeOat, {"-j4"}, kListAndCode, &error_msg)) << error_msg;
+}
+
 TEST_F(OatDumpTest, TestExportDex) {
   // Test is failing on target, b/77469384.
   TEST_DISABLED_FOR_TARGET();
@@ -29,6 +29,7 @@
  * questions.
  */
 
+#include <algorithm>
 #include <functional>
 
 #include "deopt_manager.h"
@@ -37,10 +38,12 @@
 #include "art_method-inl.h"
 #include "base/enums.h"
 #include "base/mutex-inl.h"
+#include "class_linker.h"
 #include "dex/dex_file_annotations.h"
 #include "dex/modifiers.h"
 #include "events-inl.h"
 #include "jit/jit.h"
+#include "jit/jit_code_cache.h"
 #include "jni_internal.h"
 #include "mirror/class-inl.h"
 #include "mirror/object_array-inl.h"
@@ -85,6 +88,7 @@ DeoptManager::DeoptManager()
     performing_deoptimization_(false),
     global_deopt_count_(0),
     deopter_count_(0),
+    entry_exit_stubs_count_(0),
     breakpoint_status_lock_("JVMTI_BreakpointStatusLock",
                             static_cast<art::LockLevel>(art::LockLevel::kAbortLock + 1)),
     inspection_callback_(this),
@@ -150,6 +154,7 @@ void DeoptManager::FinishSetup() {
 }
 
 bool DeoptManager::MethodHasBreakpoints(art::ArtMethod* method) {
+  method = method->GetCanonicalMethod();
   art::MutexLock lk(art::Thread::Current(), breakpoint_status_lock_);
   return MethodHasBreakpointsLocked(method);
 }
@@ -173,6 +178,35 @@ void DeoptManager::AddDeoptimizeAllMethods() {
   AddDeoptimizeAllMethodsLocked(self);
 }
 
+void DeoptManager::RemoveMethodEntryExitStubs() {
+  art::Thread* self = art::Thread::Current();
+  art::ScopedThreadSuspension sts(self, art::kSuspended);
+  deoptimization_status_lock_.ExclusiveLock(self);
+  DCHECK_GT(entry_exit_stubs_count_, 0u) << "Removing entry/exit stubs that were never added";
+  entry_exit_stubs_count_--;
+  if (entry_exit_stubs_count_ == 0) {
+    ScopedDeoptimizationContext sdc(self, this);
+    art::Runtime::Current()->GetInstrumentation()->DisableMethodTracing(
+        kEntryExitStubsInstrumentationKey);
+  } else {
+    WaitForDeoptimizationToFinish(self);
+  }
+}
+
+void DeoptManager::AddMethodEntryExitStubs() {
+  art::Thread* self = art::Thread::Current();
+  art::ScopedThreadSuspension sts(self, art::kSuspended);
+  deoptimization_status_lock_.ExclusiveLock(self);
+  entry_exit_stubs_count_++;
+  if (entry_exit_stubs_count_ == 1) {
+    ScopedDeoptimizationContext sdc(self, this);
+    art::Runtime::Current()->GetInstrumentation()->EnableMethodTracing(
+        kEntryExitStubsInstrumentationKey, /* needs_interpreter */ false);
+  } else {
+    WaitForDeoptimizationToFinish(self);
+  }
+}
+
 void DeoptManager::AddMethodBreakpoint(art::ArtMethod* method) {
   DCHECK(method->IsInvokable());
   DCHECK(!method->IsProxyMethod()) << method->PrettyMethod();
@@ -180,7 +214,6 @@ void DeoptManager::AddMethodBreakpoint(art::ArtMethod* method) {
 
   art::Thread* self = art::Thread::Current();
   method = method->GetCanonicalMethod();
-  bool is_default = method->IsDefault();
 
   art::ScopedThreadSuspension sts(self, art::kSuspended);
   deoptimization_status_lock_.ExclusiveLock(self);
@@ -206,8 +239,6 @@ void DeoptManager::AddMethodBreakpoint(art::ArtMethod* method) {
     // We are already interpreting everything so no need to do anything.
     deoptimization_status_lock_.ExclusiveUnlock(self);
     return;
-  } else if (is_default) {
-    AddDeoptimizeAllMethodsLocked(self);
   } else {
     PerformLimitedDeoptimization(self, method);
   }
@@ -220,7 +251,6 @@ void DeoptManager::RemoveMethodBreakpoint(art::ArtMethod* method) {
 
   art::Thread* self = art::Thread::Current();
   method = method->GetCanonicalMethod();
-  bool is_default = method->IsDefault();
 
   art::ScopedThreadSuspension sts(self, art::kSuspended);
   // Ideally we should do a ScopedSuspendAll right here to get the full mutator_lock_ that we might
@@ -243,11 +273,7 @@ void DeoptManager::RemoveMethodBreakpoint(art::ArtMethod* method) {
     deoptimization_status_lock_.ExclusiveUnlock(self);
     return;
   } else if (is_last_breakpoint) {
-    if (UNLIKELY(is_default)) {
-      RemoveDeoptimizeAllMethodsLocked(self);
-    } else {
-      PerformLimitedUndeoptimization(self, method);
-    }
+    PerformLimitedUndeoptimization(self, method);
   } else {
     // Another thread might be deoptimizing the very methods we just removed breakpoints from. Wait
     // for any deopts to finish before moving on.
@@ -322,14 +348,78 @@ void DeoptManager::RemoveDeoptimizeAllMethodsLocked(art::Thread* self) {
   }
 }
 
+class CollectCopiedMethodsVisitor : public art::ClassVisitor {
+ public:
+  CollectCopiedMethodsVisitor(art::ArtMethod* method, std::vector<art::ArtMethod*>* methods)
+      : method_(method), methods_(methods) {}
+
+  bool operator()(art::ObjPtr<art::mirror::Class> klass) OVERRIDE
+      REQUIRES_SHARED(art::Locks::mutator_lock_) {
+    for (art::ArtMethod& m : klass->GetCopiedMethods(art::kRuntimePointerSize)) {
+      if (m.IsInvokable() && m.GetCanonicalMethod() == method_) {
+        methods_->push_back(&m);
+      }
+    }
+    return true;
+  }
+
+ private:
+  art::ArtMethod* const method_;
+  std::vector<art::ArtMethod*>* const methods_;
+};
+
+void DeoptManager::CollectMethodsToDeoptimize(art::ArtMethod* method,
+                                              std::vector<art::ArtMethod*>* methods) {
+  methods->push_back(method);
+  if (method->IsDefault()) {
+    // Classes get their own copies of the default methods they don't override. Copies made after
+    // this are not deoptimized, but they don't get compiled either, see IsMethodSafeToJit().
+    CollectCopiedMethodsVisitor visitor(method, methods);
+    art::Runtime::Current()->GetClassLinker()->VisitClasses(&visitor);
+  }
+  art::jit::Jit* jit = art::Runtime::Current()->GetJit();
+  if (jit != nullptr) {
+    // The breakpoints would be missed in code that inlined the methods. Debuggable code does not
+    // inline, but this keeps breakpoints working with any JIT code.
+    size_t num_methods = methods->size();
+    for (size_t i = 0; i != num_methods; ++i) {
+      jit->GetCodeCache()->GetInliners((*methods)[i], methods);
+    }
+  }
+  std::sort(methods->begin(), methods->end());
+  methods->erase(std::unique(methods->begin(), methods->end()), methods->end());
+}
+
 void DeoptManager::PerformLimitedDeoptimization(art::Thread* self, art::ArtMethod* method) {
   ScopedDeoptimizationContext sdc(self, this);
-  art::Runtime::Current()->GetInstrumentation()->Deoptimize(method);
+  std::vector<art::ArtMethod*> methods;
+  CollectMethodsToDeoptimize(method, &methods);
+  art::instrumentation::Instrumentation* instrumentation =
+      art::Runtime::Current()->GetInstrumentation();
+  for (art::ArtMethod* m : methods) {
+    // Methods may be needed by several methods with breakpoints.
+    if (limited_deopt_counts_[m]++ == 0u) {
+      instrumentation->Deoptimize(m);
+    }
+  }
+  breakpoint_deopts_[method] = std::move(methods);
 }
 
 void DeoptManager::PerformLimitedUndeoptimization(art::Thread* self, art::ArtMethod* method) {
   ScopedDeoptimizationContext sdc(self, this);
-  art::Runtime::Current()->GetInstrumentation()->Undeoptimize(method);
+  auto it = breakpoint_deopts_.find(method);
+  DCHECK(it != breakpoint_deopts_.end()) << method->PrettyMethod() << " was not deoptimized";
+  art::instrumentation::Instrumentation* instrumentation =
+      art::Runtime::Current()->GetInstrumentation();
+  for (art::ArtMethod* m : it->second) {
+    auto count = limited_deopt_counts_.find(m);
+    DCHECK(count != limited_deopt_counts_.end());
+    if (--count->second == 0u) {
+      limited_deopt_counts_.erase(count);
+      instrumentation->Undeoptimize(m);
+    }
+  }
+  breakpoint_deopts_.erase(it);
 }
 
 void DeoptManager::PerformGlobalDeoptimization(art::Thread* self) {
@@ -34,6 +34,7 @@
 
 #include <atomic>
 #include <unordered_map>
+#include <vector>
 
 #include "jni.h"
 #include "jvmti.h"
@@ -83,8 +84,10 @@ class DeoptManager {
                                                 !art::Roles::uninterruptible_);
   void AddDeoptimizationRequester() REQUIRES(!deoptimization_status_lock_,
                                              !art::Roles::uninterruptible_);
+  // Also true for the copies of a default method with breakpoints.
   bool MethodHasBreakpoints(art::ArtMethod* method)
-      REQUIRES(!deoptimization_status_lock_);
+      REQUIRES(!deoptimization_status_lock_)
+      REQUIRES_SHARED(art::Locks::mutator_lock_);
 
   void RemoveMethodBreakpoint(art::ArtMethod* method)
       REQUIRES(!deoptimization_status_lock_, !art::Roles::uninterruptible_)
@@ -102,6 +105,16 @@ class DeoptManager {
       REQUIRES(!deoptimization_status_lock_, !art::Roles::uninterruptible_)
       REQUIRES_SHARED(art::Locks::mutator_lock_);
 
+  // Install the instrumentation entry and exit stubs for method entry and exit events that don't
+  // need everything deoptimized, see Instrumentation::MethodEntryExitNeedsInterpreter().
+  void AddMethodEntryExitStubs()
+      REQUIRES(!deoptimization_status_lock_, !art::Roles::uninterruptible_)
+      REQUIRES_SHARED(art::Locks::mutator_lock_);
+
+  void RemoveMethodEntryExitStubs()
+      REQUIRES(!deoptimization_status_lock_, !art::Roles::uninterruptible_)
+      REQUIRES_SHARED(art::Locks::mutator_lock_);
+
   void DeoptimizeThread(art::Thread* target) REQUIRES_SHARED(art::Locks::mutator_lock_);
   void DeoptimizeAllThreads() REQUIRES_SHARED(art::Locks::mutator_lock_);
 
@@ -148,15 +161,24 @@ class DeoptManager {
       RELEASE(deoptimization_status_lock_)
       REQUIRES(!art::Roles::uninterruptible_, !art::Locks::mutator_lock_);
 
+  // Deoptimize `method`, which got its first breakpoint, and the methods that the breakpoints
+  // could be missed in, see CollectMethodsToDeoptimize().
   void PerformLimitedDeoptimization(art::Thread* self, art::ArtMethod* method)
       RELEASE(deoptimization_status_lock_)
       REQUIRES(!art::Roles::uninterruptible_, !art::Locks::mutator_lock_);
 
+  // Undo PerformLimitedDeoptimization() once `method` has no breakpoints left.
   void PerformLimitedUndeoptimization(art::Thread* self, art::ArtMethod* method)
       RELEASE(deoptimization_status_lock_)
       REQUIRES(!art::Roles::uninterruptible_, !art::Locks::mutator_lock_);
 
+  // Collect `method`, the copies of it in the classes that implement it if it is a default
+  // method, and the methods whose JIT code inlined any of these.
+  void CollectMethodsToDeoptimize(art::ArtMethod* method, std::vector<art::ArtMethod*>* methods)
+      REQUIRES(art::Locks::mutator_lock_);
+
   static constexpr const char* kDeoptManagerInstrumentationKey = "JVMTI_DeoptManager";
+  static constexpr const char* kEntryExitStubsInstrumentationKey = "JVMTI_EntryExitStubs";
 
   art::Mutex deoptimization_status_lock_ ACQUIRED_BEFORE(art::Locks::classlinker_classes_lock_);
   art::ConditionVariable deoptimization_condition_ GUARDED_BY(deoptimization_status_lock_);
@@ -168,6 +190,14 @@ class DeoptManager {
   // Number of users of deoptimization there currently are.
   uint32_t deopter_count_ GUARDED_BY(deoptimization_status_lock_);
 
+  // Number of times we have gotten requests to install the entry and exit stubs.
+  uint32_t entry_exit_stubs_count_ GUARDED_BY(deoptimization_status_lock_);
+
+  // The methods deoptimized for the breakpoints of each method, and how many of the methods with
+  // breakpoints need each of them. Only accessed while performing deoptimization.
+  std::unordered_map<art::ArtMethod*, std::vector<art::ArtMethod*>> breakpoint_deopts_;
+  std::unordered_map<art::ArtMethod*, uint32_t> limited_deopt_counts_;
+
   // A mutex that just protects the breakpoint-status map. This mutex should always be at the
   // bottom of the lock hierarchy. Nothing more should be locked if we hold this.
   art::Mutex breakpoint_status_lock_ ACQUIRED_BEFORE(art::Locks::abort_lock_);
@@ -120,7 +120,8 @@ class ScopedEventDispatchEnvironment FINAL : public art::ValueObject {
   fn(GarbageCollectionFinish, ArtJvmtiEvent::kGarbageCollectionFinish)               \
   fn(ObjectFree,              ArtJvmtiEvent::kObjectFree)                            \
   fn(VMObjectAlloc,           ArtJvmtiEvent::kVmObjectAlloc)                         \
-  fn(DdmPublishChunk,         ArtJvmtiEvent::kDdmPublishChunk)
+  fn(DdmPublishChunk,         ArtJvmtiEvent::kDdmPublishChunk)                       \
+  fn(SampledObjectAlloc,      ArtJvmtiEvent::kSampledObjectAlloc)
 
 template <ArtJvmtiEvent kEvent>
 struct EventFnType {
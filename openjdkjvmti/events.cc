@@ -77,6 +77,9 @@ jvmtiError ArtJvmtiEventCallbacks::Set(jint index, jvmtiExtensionEvent cb) {
     case static_cast<jint>(ArtJvmtiEvent::kDdmPublishChunk):
       DdmPublishChunk = reinterpret_cast<ArtJvmtiEventDdmPublishChunk>(cb);
       return OK;
+    case static_cast<jint>(ArtJvmtiEvent::kSampledObjectAlloc):
+      SampledObjectAlloc = reinterpret_cast<ArtJvmtiEventSampledObjectAlloc>(cb);
+      return OK;
     default:
       return ERR(ILLEGAL_ARGUMENT);
   }
@@ -92,6 +95,7 @@ bool IsExtensionEvent(jint e) {
 bool IsExtensionEvent(ArtJvmtiEvent e) {
   switch (e) {
     case ArtJvmtiEvent::kDdmPublishChunk:
+    case ArtJvmtiEvent::kSampledObjectAlloc:
       return true;
     default:
       return false;
@@ -292,31 +296,48 @@ class JvmtiAllocationListener : public art::gc::AllocationListener {
     DCHECK_EQ(self, art::Thread::Current());
 
     if (handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kVmObjectAlloc)) {
-      art::StackHandleScope<1> hs(self);
-      auto h = hs.NewHandleWrapper(obj);
-      // jvmtiEventVMObjectAlloc parameters:
-      //      jvmtiEnv *jvmti_env,
-      //      JNIEnv* jni_env,
-      //      jthread thread,
-      //      jobject object,
-      //      jclass object_klass,
-      //      jlong size
-      art::JNIEnvExt* jni_env = self->GetJniEnv();
-      ScopedLocalRef<jobject> object(
-          jni_env, jni_env->AddLocalReference<jobject>(*obj));
-      ScopedLocalRef<jclass> klass(
-          jni_env, jni_env->AddLocalReference<jclass>(obj->Ptr()->GetClass()));
-
-      RunEventCallback<ArtJvmtiEvent::kVmObjectAlloc>(handler_,
-                                                      self,
-                                                      jni_env,
-                                                      object.get(),
-                                                      klass.get(),
-                                                      static_cast<jlong>(byte_count));
+      DispatchAllocationEvent<ArtJvmtiEvent::kVmObjectAlloc>(self, obj, byte_count);
+    }
+  }
+
+  void ObjectSampled(art::Thread* self, art::ObjPtr<art::mirror::Object>* obj, size_t byte_count)
+      OVERRIDE REQUIRES_SHARED(art::Locks::mutator_lock_) {
+    DCHECK_EQ(self, art::Thread::Current());
+
+    if (handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kSampledObjectAlloc)) {
+      DispatchAllocationEvent<ArtJvmtiEvent::kSampledObjectAlloc>(self, obj, byte_count);
     }
   }
 
  private:
+  template <ArtJvmtiEvent kEvent>
+  void DispatchAllocationEvent(art::Thread* self,
+                               art::ObjPtr<art::mirror::Object>* obj,
+                               size_t byte_count)
+      REQUIRES_SHARED(art::Locks::mutator_lock_) {
+    art::StackHandleScope<1> hs(self);
+    auto h = hs.NewHandleWrapper(obj);
+    // jvmtiEventVMObjectAlloc parameters:
+    //      jvmtiEnv *jvmti_env,
+    //      JNIEnv* jni_env,
+    //      jthread thread,
+    //      jobject object,
+    //      jclass object_klass,
+    //      jlong size
+    art::JNIEnvExt* jni_env = self->GetJniEnv();
+    ScopedLocalRef<jobject> object(
+        jni_env, jni_env->AddLocalReference<jobject>(*obj));
+    ScopedLocalRef<jclass> klass(
+        jni_env, jni_env->AddLocalReference<jclass>(obj->Ptr()->GetClass()));
+
+    RunEventCallback<kEvent>(handler_,
+                             self,
+                             jni_env,
+                             object.get(),
+                             klass.get(),
+                             static_cast<jlong>(byte_count));
+  }
+
   EventHandler* handler_;
 };
 
@@ -886,11 +907,13 @@ static bool EventNeedsFullDeopt(ArtJvmtiEvent event) {
     case ArtJvmtiEvent::kBreakpoint:
     case ArtJvmtiEvent::kException:
       return false;
+    case ArtJvmtiEvent::kMethodEntry:
+    case ArtJvmtiEvent::kMethodExit:
+      // Otherwise the entry and exit stubs report them from compiled code.
+      return art::Runtime::Current()->GetInstrumentation()->MethodEntryExitNeedsInterpreter();
     // TODO We should support more of these or at least do something to make them discriminate by
     // thread.
-    case ArtJvmtiEvent::kMethodEntry:
     case ArtJvmtiEvent::kExceptionCatch:
-    case ArtJvmtiEvent::kMethodExit:
     case ArtJvmtiEvent::kFieldModification:
     case ArtJvmtiEvent::kFieldAccess:
     case ArtJvmtiEvent::kSingleStep:
@@ -906,6 +929,8 @@ void EventHandler::SetupTraceListener(JvmtiMethodTraceListener* listener,
                                       ArtJvmtiEvent event,
                                       bool enable) {
   bool needs_full_deopt = EventNeedsFullDeopt(event);
+  bool needs_entry_exit_stubs = !needs_full_deopt &&
+      (event == ArtJvmtiEvent::kMethodEntry || event == ArtJvmtiEvent::kMethodExit);
   // Make sure we can deopt.
   {
     art::ScopedObjectAccess soa(art::Thread::Current());
@@ -914,10 +939,14 @@ void EventHandler::SetupTraceListener(JvmtiMethodTraceListener* listener,
       deopt_manager->AddDeoptimizationRequester();
       if (needs_full_deopt) {
         deopt_manager->AddDeoptimizeAllMethods();
+      } else if (needs_entry_exit_stubs) {
+        deopt_manager->AddMethodEntryExitStubs();
       }
     } else {
       if (needs_full_deopt) {
         deopt_manager->RemoveDeoptimizeAllMethods();
+      } else if (needs_entry_exit_stubs) {
+        deopt_manager->RemoveMethodEntryExitStubs();
       }
       deopt_manager->RemoveDeoptimizationRequester();
     }
@@ -1008,7 +1037,13 @@ void EventHandler::HandleEventType(ArtJvmtiEvent event, bool enable) {
       SetupDdmTracking(ddm_listener_.get(), enable);
       return;
     case ArtJvmtiEvent::kVmObjectAlloc:
-      SetupObjectAllocationTracking(alloc_listener_.get(), enable);
+    case ArtJvmtiEvent::kSampledObjectAlloc:
+      // Both events are delivered by the same allocation listener.
+      if (!IsEventEnabledAnywhere(event == ArtJvmtiEvent::kVmObjectAlloc
+                                      ? ArtJvmtiEvent::kSampledObjectAlloc
+                                      : ArtJvmtiEvent::kVmObjectAlloc)) {
+        SetupObjectAllocationTracking(alloc_listener_.get(), enable);
+      }
       return;
 
     case ArtJvmtiEvent::kGarbageCollectionStart:
@@ -1099,6 +1134,7 @@ static bool HasAssociatedCapability(ArtJvmTiEnv* env,
       return caps.can_generate_single_step_events == 1;
 
     case ArtJvmtiEvent::kVmObjectAlloc:
+    case ArtJvmtiEvent::kSampledObjectAlloc:
       return caps.can_generate_vm_object_alloc_events == 1;
 
     default:
@@ -73,7 +73,8 @@ enum class ArtJvmtiEvent : jint {
     kVmObjectAlloc = JVMTI_EVENT_VM_OBJECT_ALLOC,
     kClassFileLoadHookRetransformable = JVMTI_MAX_EVENT_TYPE_VAL + 1,
     kDdmPublishChunk = JVMTI_MAX_EVENT_TYPE_VAL + 2,
-    kMaxEventTypeVal = kDdmPublishChunk,
+    kSampledObjectAlloc = JVMTI_MAX_EVENT_TYPE_VAL + 3,
+    kMaxEventTypeVal = kSampledObjectAlloc,
 };
 
 using ArtJvmtiEventDdmPublishChunk = void (*)(jvmtiEnv *jvmti_env,
@@ -82,8 +83,16 @@ using ArtJvmtiEventDdmPublishChunk = void (*)(jvmtiEnv *jvmti_env,
                                               jint data_len,
                                               const jbyte* data);
 
+// Same as jvmtiEventVMObjectAlloc, called for the allocations picked by heap sampling.
+using ArtJvmtiEventSampledObjectAlloc = void (*)(jvmtiEnv* jvmti_env,
+                                                 JNIEnv* jni_env,
+                                                 jthread thread,
+                                                 jobject object,
+                                                 jclass object_klass,
+                                                 jlong size);
+
 struct ArtJvmtiEventCallbacks : jvmtiEventCallbacks {
-  ArtJvmtiEventCallbacks() : DdmPublishChunk(nullptr) {
+  ArtJvmtiEventCallbacks() : DdmPublishChunk(nullptr), SampledObjectAlloc(nullptr) {
     memset(this, 0, sizeof(jvmtiEventCallbacks));
   }
 
@@ -94,6 +103,7 @@ struct ArtJvmtiEventCallbacks : jvmtiEventCallbacks {
   jvmtiError Set(jint index, jvmtiExtensionEvent cb);
 
   ArtJvmtiEventDdmPublishChunk DdmPublishChunk;
+  ArtJvmtiEventSampledObjectAlloc SampledObjectAlloc;
 };
 
 bool IsExtensionEvent(jint e);
@@ -29,6 +29,12 @@
  * questions.
  */
 
+#include <list>
+#include <map>
+#include <string>
+#include <tuple>
+
+#include "base/globals.h"
 #include "base/leb128.h"
 #include "fixed_up_dex_file.h"
 #include "dex/dex_file-inl.h"
@@ -41,6 +47,7 @@
 #include "dex_to_dex_decompiler.h"
 #include "dexlayout.h"
 #include "oat_file.h"
+#include "thread-current-inl.h"
 #include "vdex_file.h"
 
 namespace openjdkjvmti {
@@ -175,4 +182,80 @@ std::unique_ptr<FixedUpDexFile> FixedUpDexFile::Create(const art::DexFile& origi
   return ret;
 }
 
+namespace {
+
+// The data of recent FixedUpDexFiles. The least recently used entries are evicted once the data
+// takes more than kMaxCachedBytes.
+class FixedUpDataCache {
+ public:
+  using Data = std::shared_ptr<const std::vector<unsigned char>>;
+
+  FixedUpDataCache() : lock_("JVMTI fixed up dex data cache lock"), cached_bytes_(0u) {}
+
+  Data Get(const art::DexFile& original, const char* descriptor) REQUIRES(!lock_) {
+    // Standard dex files are copied whole, so all their classes share one entry.
+    Key key(&original,
+            original.GetHeader().checksum_,
+            original.IsCompactDexFile() ? descriptor : "");
+    art::Thread* self = art::Thread::Current();
+    {
+      art::MutexLock mu(self, lock_);
+      auto it = index_.find(key);
+      if (it != index_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->second;
+      }
+    }
+
+    // Don't hold the lock while converting, which may take tens of milliseconds.
+    std::unique_ptr<FixedUpDexFile> fixed_dex_file(FixedUpDexFile::Create(original, descriptor));
+    if (fixed_dex_file == nullptr) {
+      return nullptr;
+    }
+    Data data = std::make_shared<const std::vector<unsigned char>>(
+        fixed_dex_file->Begin(), fixed_dex_file->Begin() + fixed_dex_file->Size());
+    if (data->size() > kMaxCachedBytes) {
+      return data;
+    }
+
+    art::MutexLock mu(self, lock_);
+    if (index_.find(key) != index_.end()) {
+      // Another thread added it in the meantime.
+      return data;
+    }
+    lru_.emplace_front(key, data);
+    index_.emplace(key, lru_.begin());
+    cached_bytes_ += data->size();
+    while (cached_bytes_ > kMaxCachedBytes) {
+      cached_bytes_ -= lru_.back().second->size();
+      index_.erase(lru_.back().first);
+      lru_.pop_back();
+    }
+    return data;
+  }
+
+ private:
+  static constexpr size_t kMaxCachedBytes = 16 * art::MB;
+
+  // The dex file, its checksum in case another dex file is loaded at the same address later, and
+  // the class descriptor.
+  using Key = std::tuple<const art::DexFile*, uint32_t, std::string>;
+  using Entries = std::list<std::pair<Key, Data>>;
+
+  art::Mutex lock_;
+  // Most recently used first.
+  Entries lru_ GUARDED_BY(lock_);
+  std::map<Key, Entries::iterator> index_ GUARDED_BY(lock_);
+  size_t cached_bytes_ GUARDED_BY(lock_);
+};
+
+}  // namespace
+
+std::shared_ptr<const std::vector<unsigned char>> FixedUpDexFile::GetData(
+    const art::DexFile& original, const char* descriptor) {
+  // Never destroyed, as it may be used until the runtime goes away.
+  static FixedUpDataCache* cache = new FixedUpDataCache();
+  return cache->Get(original, descriptor);
+}
+
 }  // namespace openjdkjvmti
@@ -52,6 +52,12 @@ class FixedUpDexFile {
   static std::unique_ptr<FixedUpDexFile> Create(const art::DexFile& original,
                                                 const char* descriptor);
 
+  // Return the data of the FixedUpDexFile that Create() makes for `original` and `descriptor`, or
+  // null if that fails. Recent results are cached, so that transforming the same classes again
+  // does not convert and unquicken their dex file again.
+  static std::shared_ptr<const std::vector<unsigned char>> GetData(const art::DexFile& original,
+                                                                   const char* descriptor);
+
   const art::DexFile& GetDexFile() {
     return *dex_file_;
   }
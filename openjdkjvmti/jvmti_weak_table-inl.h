@@ -34,7 +34,8 @@
 
 #include "jvmti_weak_table.h"
 
-#include <limits>
+#include <algorithm>
+#include <vector>
 
 #include <android-base/logging.h>
 
@@ -105,12 +106,12 @@ bool JvmtiWeakTable<T>::RemoveLocked(art::mirror::Object* obj, T* tag) {
 
 template <typename T>
 bool JvmtiWeakTable<T>::RemoveLocked(art::Thread* self, art::mirror::Object* obj, T* tag) {
-  auto it = tagged_objects_.find(art::GcRoot<art::mirror::Object>(obj));
+  auto it = tagged_objects_.Find(obj);
   if (it != tagged_objects_.end()) {
     if (tag != nullptr) {
-      *tag = it->second;
+      *tag = it->tag;
     }
-    tagged_objects_.erase(it);
+    tagged_objects_.Erase(it);
     return true;
   }
 
@@ -150,9 +151,9 @@ bool JvmtiWeakTable<T>::SetLocked(art::mirror::Object* obj, T new_tag) {
 
 template <typename T>
 bool JvmtiWeakTable<T>::SetLocked(art::Thread* self, art::mirror::Object* obj, T new_tag) {
-  auto it = tagged_objects_.find(art::GcRoot<art::mirror::Object>(obj));
+  auto it = tagged_objects_.Find(obj);
   if (it != tagged_objects_.end()) {
-    it->second = new_tag;
+    it->tag = new_tag;
     return true;
   }
 
@@ -170,8 +171,7 @@ bool JvmtiWeakTable<T>::SetLocked(art::Thread* self, art::mirror::Object* obj, T
   }
 
   // New element.
-  auto insert_it = tagged_objects_.emplace(art::GcRoot<art::mirror::Object>(obj), new_tag);
-  DCHECK(insert_it.second);
+  tagged_objects_.Insert(TagEntry(obj, new_tag));
   return false;
 }
 
@@ -210,38 +210,35 @@ void JvmtiWeakTable<T>::SweepImpl(art::IsMarkedVisitor* visitor) {
 template <typename T>
 template <typename Updater, typename JvmtiWeakTable<T>::TableUpdateNullTarget kTargetNull>
 ALWAYS_INLINE inline void JvmtiWeakTable<T>::UpdateTableWith(Updater& updater) {
-  // We optimistically hope that elements will still be well-distributed when re-inserting them.
-  // So play with the map mechanics, and postpone rehashing. This avoids the need of a side
-  // vector and two passes.
-  float original_max_load_factor = tagged_objects_.max_load_factor();
-  tagged_objects_.max_load_factor(std::numeric_limits<float>::max());
-  // For checking that a max load-factor actually does what we expect.
-  size_t original_bucket_count = tagged_objects_.bucket_count();
-
+  // Erasing shifts later entries of the probe sequence back instead of leaving tombstones, so
+  // lookups stay short after a sweep. An entry shifted back over the end of the table may be
+  // visited again, which is harmless as the updaters return unmoved objects as they are. Moved
+  // entries are only reinserted after the scan, as they could land in either part of the table.
+  std::vector<TagEntry> moved;
   for (auto it = tagged_objects_.begin(); it != tagged_objects_.end();) {
-    DCHECK(!it->first.IsNull());
-    art::mirror::Object* original_obj = it->first.template Read<art::kWithoutReadBarrier>();
-    art::mirror::Object* target_obj = updater(it->first, original_obj);
+    DCHECK(!it->root.IsNull());
+    art::mirror::Object* original_obj = it->root.template Read<art::kWithoutReadBarrier>();
+    art::mirror::Object* target_obj = updater(it->root, original_obj);
     if (original_obj != target_obj) {
       if (kTargetNull == kIgnoreNull && target_obj == nullptr) {
         // Ignore null target, don't do anything.
       } else {
-        T tag = it->second;
-        it = tagged_objects_.erase(it);
+        T tag = it->tag;
+        it = tagged_objects_.Erase(it);
         if (target_obj != nullptr) {
-          tagged_objects_.emplace(art::GcRoot<art::mirror::Object>(target_obj), tag);
-          DCHECK_EQ(original_bucket_count, tagged_objects_.bucket_count());
+          moved.push_back(TagEntry(target_obj, tag));
         } else if (kTargetNull == kCallHandleNull) {
           HandleNullSweep(tag);
         }
         continue;  // Iterator was implicitly updated by erase.
       }
     }
-    it++;
+    ++it;
   }
 
-  tagged_objects_.max_load_factor(original_max_load_factor);
-  // TODO: consider rehash here.
+  for (TagEntry& entry : moved) {
+    tagged_objects_.Insert(entry);
+  }
 }
 
 template <typename T>
@@ -336,8 +333,8 @@ jvmtiError JvmtiWeakTable<T>::GetTaggedObjects(jvmtiEnv* jvmti_env,
   size_t initial_object_size;
   size_t initial_tag_size;
   if (tag_count == 0) {
-    initial_object_size = (object_result_ptr != nullptr) ? tagged_objects_.size() : 0;
-    initial_tag_size = (tag_result_ptr != nullptr) ? tagged_objects_.size() : 0;
+    initial_object_size = (object_result_ptr != nullptr) ? tagged_objects_.Size() : 0;
+    initial_tag_size = (tag_result_ptr != nullptr) ? tagged_objects_.Size() : 0;
   } else {
     initial_object_size = initial_tag_size = kDefaultSize;
   }
@@ -346,30 +343,24 @@ jvmtiError JvmtiWeakTable<T>::GetTaggedObjects(jvmtiEnv* jvmti_env,
                                                                          initial_object_size);
   ReleasableContainer<T, JvmtiAllocator<T>> selected_tags(allocator, initial_tag_size);
 
-  size_t count = 0;
-  for (auto& pair : tagged_objects_) {
-    bool select;
-    if (tag_count > 0) {
-      select = false;
-      for (size_t i = 0; i != static_cast<size_t>(tag_count); ++i) {
-        if (tags[i] == pair.second) {
-          select = true;
-          break;
-        }
-      }
-    } else {
-      select = true;
-    }
+  // Look up the tags of all entries in a sorted copy, instead of comparing each entry with each
+  // requested tag.
+  std::vector<T> sorted_tags(tags, tags + tag_count);
+  std::sort(sorted_tags.begin(), sorted_tags.end());
 
+  size_t count = 0;
+  for (TagEntry& entry : tagged_objects_) {
+    bool select =
+        tag_count == 0 || std::binary_search(sorted_tags.begin(), sorted_tags.end(), entry.tag);
     if (select) {
-      art::mirror::Object* obj = pair.first.template Read<art::kWithReadBarrier>();
+      art::mirror::Object* obj = entry.root.template Read<art::kWithReadBarrier>();
       if (obj != nullptr) {
         count++;
         if (object_result_ptr != nullptr) {
           selected_objects.Pushback(jni_env->AddLocalReference<jobject>(obj));
         }
         if (tag_result_ptr != nullptr) {
-          selected_tags.Pushback(pair.second);
+          selected_tags.Pushback(entry.tag);
         }
       }
     }
@@ -391,9 +382,9 @@ art::mirror::Object* JvmtiWeakTable<T>::Find(T tag) {
   art::MutexLock mu(self, allow_disallow_lock_);
   Wait(self);
 
-  for (auto& pair : tagged_objects_) {
-    if (tag == pair.second) {
-      art::mirror::Object* obj = pair.first.template Read<art::kWithReadBarrier>();
+  for (TagEntry& entry : tagged_objects_) {
+    if (tag == entry.tag) {
+      art::mirror::Object* obj = entry.root.template Read<art::kWithReadBarrier>();
       if (obj != nullptr) {
         return obj;
       }
@@ -32,8 +32,7 @@
 #ifndef ART_OPENJDKJVMTI_JVMTI_WEAK_TABLE_H_
 #define ART_OPENJDKJVMTI_JVMTI_WEAK_TABLE_H_
 
-#include <unordered_map>
-
+#include "base/hash_set.h"
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "gc/system_weak.h"
@@ -144,9 +143,9 @@ class JvmtiWeakTable : public art::gc::SystemWeakHolder {
   bool GetTagLocked(art::Thread* self, art::mirror::Object* obj, /* out */ T* result)
       REQUIRES_SHARED(art::Locks::mutator_lock_)
       REQUIRES(allow_disallow_lock_) {
-    auto it = tagged_objects_.find(art::GcRoot<art::mirror::Object>(obj));
+    auto it = tagged_objects_.Find(obj);
     if (it != tagged_objects_.end()) {
-      *result = it->second;
+      *result = it->tag;
       return true;
     }
 
@@ -195,27 +194,48 @@ class JvmtiWeakTable : public art::gc::SystemWeakHolder {
   template <typename Storage, class Allocator = JvmtiAllocator<T>>
   struct ReleasableContainer;
 
+  // The entries are stored inline in an open addressed table, so that lookups and sweeping
+  // don't chase a list node per tagged object. An entry with a null root is an empty slot.
+  struct TagEntry {
+    TagEntry() : root(), tag() {}
+    TagEntry(art::mirror::Object* obj, T t) REQUIRES_SHARED(art::Locks::mutator_lock_)
+        : root(obj), tag(t) {}
+
+    art::GcRoot<art::mirror::Object> root;
+    T tag;
+  };
+
+  struct TagEntryEmptyFn {
+    void MakeEmpty(TagEntry& item) const {
+      item.root = art::GcRoot<art::mirror::Object>();
+    }
+    bool IsEmpty(const TagEntry& item) const {
+      return item.root.IsNull();
+    }
+  };
+
   struct HashGcRoot {
-    size_t operator()(const art::GcRoot<art::mirror::Object>& r) const
-        REQUIRES_SHARED(art::Locks::mutator_lock_) {
-      return reinterpret_cast<uintptr_t>(r.Read<art::kWithoutReadBarrier>());
+    // Objects are aligned, so drop the bits that are always zero.
+    size_t operator()(art::mirror::Object* obj) const {
+      return reinterpret_cast<uintptr_t>(obj) >> art::kObjectAlignmentShift;
+    }
+    size_t operator()(const TagEntry& entry) const NO_THREAD_SAFETY_ANALYSIS {
+      return (*this)(entry.root.template Read<art::kWithoutReadBarrier>());
     }
   };
 
   struct EqGcRoot {
-    bool operator()(const art::GcRoot<art::mirror::Object>& r1,
-                    const art::GcRoot<art::mirror::Object>& r2) const
-        REQUIRES_SHARED(art::Locks::mutator_lock_) {
-      return r1.Read<art::kWithoutReadBarrier>() == r2.Read<art::kWithoutReadBarrier>();
+    bool operator()(const TagEntry& entry, art::mirror::Object* obj) const
+        NO_THREAD_SAFETY_ANALYSIS {
+      return entry.root.template Read<art::kWithoutReadBarrier>() == obj;
+    }
+    bool operator()(const TagEntry& e1, const TagEntry& e2) const NO_THREAD_SAFETY_ANALYSIS {
+      return (*this)(e1, e2.root.template Read<art::kWithoutReadBarrier>());
     }
   };
 
-  using TagAllocator = JvmtiAllocator<std::pair<const art::GcRoot<art::mirror::Object>, T>>;
-  std::unordered_map<art::GcRoot<art::mirror::Object>,
-                     T,
-                     HashGcRoot,
-                     EqGcRoot,
-                     TagAllocator> tagged_objects_
+  using TagAllocator = JvmtiAllocator<TagEntry>;
+  art::HashSet<TagEntry, TagEntryEmptyFn, HashGcRoot, EqGcRoot, TagAllocator> tagged_objects_
       GUARDED_BY(allow_disallow_lock_)
       GUARDED_BY(art::Locks::mutator_lock_);
   // To avoid repeatedly scanning the whole table, remember if we did that since the last sweep.
@@ -54,13 +54,13 @@ void ArtClassDefinition::InitializeMemory() const {
   CHECK_EQ(temp_mmap_->GetProtect(), PROT_READ | PROT_WRITE);
 
   std::string desc = std::string("L") + name_ + ";";
-  std::unique_ptr<FixedUpDexFile>
-      fixed_dex_file(FixedUpDexFile::Create(*initial_dex_file_unquickened_, desc.c_str()));
-  CHECK(fixed_dex_file.get() != nullptr);
-  CHECK_LE(fixed_dex_file->Size(), temp_mmap_->Size());
+  std::shared_ptr<const std::vector<unsigned char>> fixed_data(
+      FixedUpDexFile::GetData(*initial_dex_file_unquickened_, desc.c_str()));
+  CHECK(fixed_data != nullptr);
+  CHECK_LE(fixed_data->size(), temp_mmap_->Size());
   CHECK_EQ(temp_mmap_->Size(), dex_data_mmap_->Size());
   // Copy the data to the temp mmap.
-  memcpy(temp_mmap_->Begin(), fixed_dex_file->Begin(), fixed_dex_file->Size());
+  memcpy(temp_mmap_->Begin(), fixed_data->data(), fixed_data->size());
 
   // Move the mmap atomically.
   art::MemMap* source = temp_mmap_.release();
@@ -133,9 +133,10 @@ static void DequickenDexFile(const art::DexFile* dex_file,
                              const char* descriptor,
                              /*out*/std::vector<unsigned char>* dex_data)
     REQUIRES_SHARED(art::Locks::mutator_lock_) {
-  std::unique_ptr<FixedUpDexFile> fixed_dex_file(FixedUpDexFile::Create(*dex_file, descriptor));
-  dex_data->resize(fixed_dex_file->Size());
-  memcpy(dex_data->data(), fixed_dex_file->Begin(), fixed_dex_file->Size());
+  std::shared_ptr<const std::vector<unsigned char>> fixed_data(
+      FixedUpDexFile::GetData(*dex_file, descriptor));
+  CHECK(fixed_data != nullptr);
+  *dex_data = *fixed_data;
 }
 
 // Gets the data surrounding the given class.
@@ -32,10 +32,13 @@
 #include "ti_dump.h"
 
 #include <limits>
+#include <sstream>
 
 #include "art_jvmti.h"
 #include "base/mutex.h"
 #include "events-inl.h"
+#include "jit/jit.h"
+#include "lock_contention_profiler.h"
 #include "runtime_callbacks.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
@@ -70,4 +73,47 @@ void DumpUtil::Unregister() {
   art::Runtime::Current()->GetRuntimeCallbacks()->RemoveRuntimeSigQuitCallback(&gDumpCallback);
 }
 
+jvmtiError DumpUtil::GetJitCompilerStats(jvmtiEnv* env, char** stats_out) {
+  if (stats_out == nullptr) {
+    return ERR(NULL_POINTER);
+  }
+  art::jit::Jit* jit = art::Runtime::Current()->GetJit();
+  if (jit == nullptr) {
+    return ERR(NOT_AVAILABLE);
+  }
+  std::ostringstream oss;
+  jit->DumpCompilerStats(oss);
+  jvmtiError error;
+  JvmtiUniquePtr<char[]> stats = CopyString(env, oss.str().c_str(), &error);
+  if (stats == nullptr) {
+    return error;
+  }
+  *stats_out = stats.release();
+  return ERR(NONE);
+}
+
+jvmtiError DumpUtil::SetLockContentionProfiling(jvmtiEnv* env ATTRIBUTE_UNUSED,
+                                                jboolean enabled) {
+  art::LockContentionProfiler::SetEnabled(enabled == JNI_TRUE);
+  return ERR(NONE);
+}
+
+jvmtiError DumpUtil::GetLockContentionProfile(jvmtiEnv* env, jboolean reset, char** profile_out) {
+  if (profile_out == nullptr) {
+    return ERR(NULL_POINTER);
+  }
+  std::ostringstream oss;
+  art::LockContentionProfiler::Dump(oss);
+  if (reset == JNI_TRUE) {
+    art::LockContentionProfiler::Reset();
+  }
+  jvmtiError error;
+  JvmtiUniquePtr<char[]> profile = CopyString(env, oss.str().c_str(), &error);
+  if (profile == nullptr) {
+    return error;
+  }
+  *profile_out = profile.release();
+  return ERR(NONE);
+}
+
 }  // namespace openjdkjvmti
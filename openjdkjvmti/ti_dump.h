@@ -43,6 +43,16 @@ class DumpUtil {
  public:
   static void Register(EventHandler* event_handler);
   static void Unregister();
+
+  // Extension that returns the JIT compiler's per-pass and per-method statistics as a
+  // string. They are only collected when the runtime is started with
+  // `-Xcompiler-option --dump-stats`.
+  static jvmtiError GetJitCompilerStats(jvmtiEnv* env, char** stats_out);
+
+  // Extensions that turn the runtime's lock contention profiler on or off, and return its wait
+  // time histograms as a string, optionally resetting them.
+  static jvmtiError SetLockContentionProfiling(jvmtiEnv* env, jboolean enabled);
+  static jvmtiError GetLockContentionProfile(jvmtiEnv* env, jboolean reset, char** profile_out);
 };
 
 }  // namespace openjdkjvmti
@@ -38,6 +38,7 @@
 #include "ti_allocator.h"
 #include "ti_class.h"
 #include "ti_ddms.h"
+#include "ti_dump.h"
 #include "ti_heap.h"
 #include "thread-inl.h"
 
@@ -169,6 +170,22 @@ jvmtiError ExtensionUtil::GetExtensionFunctions(jvmtiEnv* env,
     return error;
   }
 
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(HeapExtensions::SetHeapSamplingInterval),
+      "com.android.art.heap.set_heap_sampling_interval",
+      "Set the mean number of bytes allocated between two allocations reported to the"
+      " com.android.art.heap.sampled_object_alloc event. The sample points are randomized around"
+      " that mean. An interval of 0 samples every allocation, which is also the default. The"
+      " interval is global to the runtime. Requires the can_generate_vm_object_alloc_events"
+      " capability.",
+      {
+          { "sampling_interval", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false},
+      },
+      { ERR(MUST_POSSESS_CAPABILITY), ERR(ILLEGAL_ARGUMENT) });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
   error = add_extension(
       reinterpret_cast<jvmtiExtensionFunction>(HeapExtensions::IterateThroughHeapExt),
       "com.android.art.heap.iterate_through_heap_ext",
@@ -191,6 +208,32 @@ jvmtiError ExtensionUtil::GetExtensionFunctions(jvmtiEnv* env,
     return error;
   }
 
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(HeapExtensions::IterateThroughHeapParallel),
+      "com.android.art.heap.iterate_through_heap_parallel",
+      "Iterate through a heap from thread_count threads, including the calling one. This is"
+      " equivalent to the standard IterateThroughHeap function, except that the callbacks are"
+      " called concurrently from several threads, in no particular order, and must be thread"
+      " safe. All other threads stay suspended for the duration of the iteration. Returning"
+      " JVMTI_VISIT_ABORT stops the iteration once the other threads have finished their current"
+      " objects.",
+      {
+          { "heap_filter", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false},
+          { "klass", JVMTI_KIND_IN, JVMTI_TYPE_JCLASS, true},
+          { "callbacks", JVMTI_KIND_IN_PTR, JVMTI_TYPE_CVOID, false},
+          { "user_data", JVMTI_KIND_IN_PTR, JVMTI_TYPE_CVOID, true},
+          { "thread_count", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false},
+      },
+      {
+          ERR(MUST_POSSESS_CAPABILITY),
+          ERR(INVALID_CLASS),
+          ERR(NULL_POINTER),
+          ERR(ILLEGAL_ARGUMENT),
+      });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
   error = add_extension(
       reinterpret_cast<jvmtiExtensionFunction>(AllocUtil::GetGlobalJvmtiAllocationState),
       "com.android.art.alloc.get_global_jvmti_allocation_state",
@@ -206,6 +249,53 @@ jvmtiError ExtensionUtil::GetExtensionFunctions(jvmtiEnv* env,
     return error;
   }
 
+  // JIT compiler statistics extension
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(DumpUtil::GetJitCompilerStats),
+      "com.android.art.jit.get_compiler_stats",
+      "Returns the time and arena memory spent by the JIT compiler in each optimization pass,"
+      " and the slowest methods it compiled, as human readable text. The statistics are only"
+      " collected when the runtime is started with '-Xcompiler-option --dump-stats', otherwise"
+      " the returned string is empty. The stats_out string must be deallocated by the caller.",
+      {
+          { "stats_out", JVMTI_KIND_ALLOC_BUF, JVMTI_TYPE_CCHAR, false },
+      },
+      { ERR(NULL_POINTER), ERR(NOT_AVAILABLE), ERR(OUT_OF_MEMORY) });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
+  // Lock contention profiler extensions
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(DumpUtil::SetLockContentionProfiling),
+      "com.android.art.misc.set_lock_contention_profiling",
+      "Turns the lock contention profiler on or off. While on, it records how long threads block"
+      " on contended monitors, per contending method and dex pc, and on the runtime's internal"
+      " mutexes, per mutex name. It can also be turned on with -XX:LockContentionProfiling:true.",
+      {
+          { "enabled", JVMTI_KIND_IN, JVMTI_TYPE_JBOOLEAN, false },
+      },
+      { });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(DumpUtil::GetLockContentionProfile),
+      "com.android.art.misc.get_lock_contention_profile",
+      "Returns the wait time histograms of the lock contention profiler as human readable text,"
+      " sites with the longest total wait first, with a sample of the owner's stack for monitors."
+      " The profile is also part of the SIGQUIT dump. If reset is true, the recorded waits are"
+      " cleared afterwards. The profile_out string must be deallocated by the caller.",
+      {
+          { "reset", JVMTI_KIND_IN, JVMTI_TYPE_JBOOLEAN, false },
+          { "profile_out", JVMTI_KIND_ALLOC_BUF, JVMTI_TYPE_CCHAR, false },
+      },
+      { ERR(NULL_POINTER), ERR(OUT_OF_MEMORY) });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
   // DDMS extension
   error = add_extension(
       reinterpret_cast<jvmtiExtensionFunction>(DDMSUtil::HandleChunk),
@@ -357,6 +447,25 @@ jvmtiError ExtensionUtil::GetExtensionEvents(jvmtiEnv* env,
   if (error != OK) {
     return error;
   }
+  error = add_extension(
+      ArtJvmtiEvent::kSampledObjectAlloc,
+      "com.android.art.heap.sampled_object_alloc",
+      "Called for allocations picked by heap sampling, see"
+      " com.android.art.heap.set_heap_sampling_interval. The parameters are the same as for the"
+      " VMObjectAlloc event. Unlike VMObjectAlloc it covers every allocation and not just the ones"
+      " that cannot be detected by bytecode instrumentation, which makes it suitable for building"
+      " heap profiles with a low overhead. Requires the can_generate_vm_object_alloc_events"
+      " capability.",
+      {
+        { "jni_env", JVMTI_KIND_IN_PTR, JVMTI_TYPE_JNIENV, false },
+        { "thread", JVMTI_KIND_IN, JVMTI_TYPE_JTHREAD, false },
+        { "object", JVMTI_KIND_IN, JVMTI_TYPE_JOBJECT, false },
+        { "klass", JVMTI_KIND_IN, JVMTI_TYPE_JCLASS, false },
+        { "size", JVMTI_KIND_IN, JVMTI_TYPE_JLONG, false },
+      });
+  if (error != OK) {
+    return error;
+  }
 
   // Copy into output buffer.
 
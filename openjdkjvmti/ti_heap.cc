@@ -16,8 +16,13 @@
 
 #include "ti_heap.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "art_field-inl.h"
 #include "art_jvmti.h"
+#include "base/atomic.h"
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "class_linker.h"
@@ -39,6 +44,7 @@
 #include "stack.h"
 #include "thread-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 
 namespace openjdkjvmti {
 
@@ -59,6 +65,9 @@ using IndexCachingTable = JvmtiWeakTable<IndexCache>;
 
 static IndexCachingTable gIndexCachingTable;
 
+// The number of objects each task of IterateThroughHeapParallel reports.
+static constexpr size_t kObjectsPerHeapIterationTask = 1024;
+
 // Report the contents of a string, if a callback is set.
 jint ReportString(art::ObjPtr<art::mirror::Object> obj,
                   jvmtiEnv* env,
@@ -653,6 +662,79 @@ void HeapUtil::Unregister() {
   art::Runtime::Current()->RemoveSystemWeakHolder(&gIndexCachingTable);
 }
 
+static jint ReportToHeapIterationCallback(art::mirror::Object* obj ATTRIBUTE_UNUSED,
+                                          const jvmtiHeapCallbacks* cb_callbacks,
+                                          jlong class_tag,
+                                          jlong size,
+                                          jlong* tag,
+                                          jint length,
+                                          void* cb_user_data) {
+  return cb_callbacks->heap_iteration_callback(class_tag, size, tag, length, cb_user_data);
+}
+
+// Report `obj` to the heap iteration callbacks, with `fn` calling the heap_iteration_callback.
+// Returns true if a callback asked to abort the iteration.
+template <typename T>
+static bool ReportHeapIterationObject(T fn,
+                                      art::mirror::Object* obj,
+                                      jvmtiEnv* env,
+                                      ObjectTagTable* tag_table,
+                                      const HeapFilter& heap_filter,
+                                      art::ObjPtr<art::mirror::Class> filter_klass,
+                                      const jvmtiHeapCallbacks* callbacks,
+                                      const void* user_data)
+    REQUIRES_SHARED(art::Locks::mutator_lock_) {
+  art::ScopedAssertNoThreadSuspension no_suspension("IterateThroughHeapCallback");
+
+  jlong tag = 0;
+  tag_table->GetTag(obj, &tag);
+
+  jlong class_tag = 0;
+  art::ObjPtr<art::mirror::Class> klass = obj->GetClass();
+  tag_table->GetTag(klass.Ptr(), &class_tag);
+  // For simplicity, even if we find a tag = 0, assume 0 = not tagged.
+
+  if (!heap_filter.ShouldReportByHeapFilter(tag, class_tag)) {
+    return false;
+  }
+
+  if (filter_klass != nullptr) {
+    if (filter_klass != klass) {
+      return false;
+    }
+  }
+
+  jlong size = obj->SizeOf();
+
+  jint length = -1;
+  if (obj->IsArrayInstance()) {
+    length = obj->AsArray()->GetLength();
+  }
+
+  jlong saved_tag = tag;
+  jint ret = fn(obj, callbacks, class_tag, size, &tag, length, const_cast<void*>(user_data));
+
+  if (tag != saved_tag) {
+    tag_table->Set(obj, tag);
+  }
+
+  if ((ret & JVMTI_VISIT_ABORT) != 0) {
+    return true;
+  }
+
+  jint string_ret = ReportString(obj, env, tag_table, callbacks, user_data);
+  if ((string_ret & JVMTI_VISIT_ABORT) != 0) {
+    return true;
+  }
+
+  jint array_ret = ReportPrimitiveArray(obj, env, tag_table, callbacks, user_data);
+  if ((array_ret & JVMTI_VISIT_ABORT) != 0) {
+    return true;
+  }
+
+  return ReportPrimitiveField::Report(obj, tag_table, callbacks, user_data);
+}
+
 template <typename T>
 static jvmtiError DoIterateThroughHeap(T fn,
                                        jvmtiEnv* env,
@@ -676,56 +758,8 @@ static jvmtiError DoIterateThroughHeap(T fn,
     if (stop_reports) {
       return;
     }
-
-    art::ScopedAssertNoThreadSuspension no_suspension("IterateThroughHeapCallback");
-
-    jlong tag = 0;
-    tag_table->GetTag(obj, &tag);
-
-    jlong class_tag = 0;
-    art::ObjPtr<art::mirror::Class> klass = obj->GetClass();
-    tag_table->GetTag(klass.Ptr(), &class_tag);
-    // For simplicity, even if we find a tag = 0, assume 0 = not tagged.
-
-    if (!heap_filter.ShouldReportByHeapFilter(tag, class_tag)) {
-      return;
-    }
-
-    if (filter_klass != nullptr) {
-      if (filter_klass != klass) {
-        return;
-      }
-    }
-
-    jlong size = obj->SizeOf();
-
-    jint length = -1;
-    if (obj->IsArrayInstance()) {
-      length = obj->AsArray()->GetLength();
-    }
-
-    jlong saved_tag = tag;
-    jint ret = fn(obj, callbacks, class_tag, size, &tag, length, const_cast<void*>(user_data));
-
-    if (tag != saved_tag) {
-      tag_table->Set(obj, tag);
-    }
-
-    stop_reports = (ret & JVMTI_VISIT_ABORT) != 0;
-
-    if (!stop_reports) {
-      jint string_ret = ReportString(obj, env, tag_table, callbacks, user_data);
-      stop_reports = (string_ret & JVMTI_VISIT_ABORT) != 0;
-    }
-
-    if (!stop_reports) {
-      jint array_ret = ReportPrimitiveArray(obj, env, tag_table, callbacks, user_data);
-      stop_reports = (array_ret & JVMTI_VISIT_ABORT) != 0;
-    }
-
-    if (!stop_reports) {
-      stop_reports = ReportPrimitiveField::Report(obj, tag_table, callbacks, user_data);
-    }
+    stop_reports = ReportHeapIterationObject(
+        fn, obj, env, tag_table, heap_filter, filter_klass, callbacks, user_data);
   };
   art::Runtime::Current()->GetHeap()->VisitObjects(visitor);
 
@@ -737,21 +771,7 @@ jvmtiError HeapUtil::IterateThroughHeap(jvmtiEnv* env,
                                         jclass klass,
                                         const jvmtiHeapCallbacks* callbacks,
                                         const void* user_data) {
-  auto JvmtiIterateHeap = [](art::mirror::Object* obj ATTRIBUTE_UNUSED,
-                             const jvmtiHeapCallbacks* cb_callbacks,
-                             jlong class_tag,
-                             jlong size,
-                             jlong* tag,
-                             jint length,
-                             void* cb_user_data)
-      REQUIRES_SHARED(art::Locks::mutator_lock_) {
-    return cb_callbacks->heap_iteration_callback(class_tag,
-                                                 size,
-                                                 tag,
-                                                 length,
-                                                 cb_user_data);
-  };
-  return DoIterateThroughHeap(JvmtiIterateHeap,
+  return DoIterateThroughHeap(ReportToHeapIterationCallback,
                               env,
                               ArtJvmTiEnv::AsArtJvmTiEnv(env)->object_tag_table.get(),
                               heap_filter,
@@ -1487,6 +1507,19 @@ jvmtiError HeapExtensions::GetHeapName(jvmtiEnv* env, jint heap_id, char** heap_
   }
 }
 
+jvmtiError HeapExtensions::SetHeapSamplingInterval(jvmtiEnv* env, jint sampling_interval, ...) {
+  if (ArtJvmTiEnv::AsArtJvmTiEnv(env)->capabilities.can_generate_vm_object_alloc_events != 1) {
+    return ERR(MUST_POSSESS_CAPABILITY);
+  }
+  if (sampling_interval < 0) {
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+  // The interval is shared by all environments and the allocation tracker.
+  art::Runtime::Current()->GetHeap()->SetAllocationSamplingInterval(
+      static_cast<size_t>(sampling_interval));
+  return ERR(NONE);
+}
+
 jvmtiError HeapExtensions::IterateThroughHeapExt(jvmtiEnv* env,
                                                  jint heap_filter,
                                                  jclass klass,
@@ -1519,4 +1552,145 @@ jvmtiError HeapExtensions::IterateThroughHeapExt(jvmtiEnv* env,
                               user_data);
 }
 
+namespace {
+
+// Reports a slice of the objects collected by IterateThroughHeapParallel.
+class HeapIterationTask FINAL : public art::SelfDeletingTask {
+ public:
+  HeapIterationTask(art::mirror::Object* const* begin,
+                    art::mirror::Object* const* end,
+                    jvmtiEnv* env,
+                    ObjectTagTable* tag_table,
+                    const HeapFilter* heap_filter,
+                    art::mirror::Class* filter_klass,
+                    const jvmtiHeapCallbacks* callbacks,
+                    const void* user_data,
+                    art::Atomic<bool>* stop_reports)
+      : begin_(begin),
+        end_(end),
+        env_(env),
+        tag_table_(tag_table),
+        heap_filter_(heap_filter),
+        filter_klass_(filter_klass),
+        callbacks_(callbacks),
+        user_data_(user_data),
+        stop_reports_(stop_reports) {}
+
+  // The thread that suspended all others holds the mutator lock exclusively, so the workers can
+  // read the heap without it, as the parallel GC tasks do.
+  void Run(art::Thread* self ATTRIBUTE_UNUSED) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    for (art::mirror::Object* const* it = begin_; it != end_; ++it) {
+      if (stop_reports_->LoadRelaxed()) {
+        return;
+      }
+      if (ReportHeapIterationObject(ReportToHeapIterationCallback,
+                                    *it,
+                                    env_,
+                                    tag_table_,
+                                    *heap_filter_,
+                                    filter_klass_,
+                                    callbacks_,
+                                    user_data_)) {
+        stop_reports_->StoreRelaxed(true);
+      }
+    }
+  }
+
+ private:
+  art::mirror::Object* const* const begin_;
+  art::mirror::Object* const* const end_;
+  jvmtiEnv* const env_;
+  ObjectTagTable* const tag_table_;
+  const HeapFilter* const heap_filter_;
+  // Not an ObjPtr, which is only valid on the thread that created it.
+  art::mirror::Class* const filter_klass_;
+  const jvmtiHeapCallbacks* const callbacks_;
+  const void* const user_data_;
+  art::Atomic<bool>* const stop_reports_;
+};
+
+}  // namespace
+
+jvmtiError HeapExtensions::IterateThroughHeapParallel(jvmtiEnv* env,
+                                                      jint heap_filter_int,
+                                                      jclass klass,
+                                                      const jvmtiHeapCallbacks* callbacks,
+                                                      const void* user_data,
+                                                      jint thread_count) {
+  if (ArtJvmTiEnv::AsArtJvmTiEnv(env)->capabilities.can_tag_objects != 1) {
+    return ERR(MUST_POSSESS_CAPABILITY);
+  }
+  if (callbacks == nullptr) {
+    return ERR(NULL_POINTER);
+  }
+  if (thread_count < 1) {
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+
+  art::Thread* self = art::Thread::Current();
+  ObjectTagTable* tag_table = ArtJvmTiEnv::AsArtJvmTiEnv(env)->object_tag_table.get();
+  const HeapFilter heap_filter(heap_filter_int);
+
+  // The calling thread works too. Create the workers before suspending all threads, as attaching
+  // them needs the thread list.
+  std::unique_ptr<art::ThreadPool> thread_pool;
+  if (thread_count > 1) {
+    thread_pool.reset(new art::ThreadPool("JVMTI heap iteration thread pool",
+                                          static_cast<size_t>(thread_count) - 1u));
+  }
+
+  art::gc::Heap* heap = art::Runtime::Current()->GetHeap();
+  if (heap->IsGcConcurrentAndMoving()) {
+    // Need to take a heap dump while GC isn't running. See the
+    // comment in Heap::VisitObjects().
+    heap->IncrementDisableMovingGC(self);
+  }
+  {
+    art::ScopedObjectAccess soa(self);      // Now we know we have the shared lock.
+    art::ScopedThreadSuspension sts(self, art::kWaitingForVisitObjects);
+    art::ScopedSuspendAll ssa("IterateThroughHeapParallel");
+
+    art::mirror::Class* filter_klass = klass == nullptr
+        ? nullptr
+        : art::ObjPtr<art::mirror::Class>::DownCast(self->DecodeJObject(klass)).Ptr();
+
+    // Walking the spaces is cheap next to the callbacks, so collect the objects of all spaces
+    // first and split them into slices of the same size, whichever space they are in.
+    std::vector<art::mirror::Object*> objects;
+    heap->VisitObjectsPaused([&objects](art::mirror::Object* obj) {
+      objects.push_back(obj);
+    });
+
+    art::Atomic<bool> stop_reports(false);
+    for (size_t begin = 0; begin < objects.size(); begin += kObjectsPerHeapIterationTask) {
+      size_t end = std::min(begin + kObjectsPerHeapIterationTask, objects.size());
+      HeapIterationTask* task = new HeapIterationTask(objects.data() + begin,
+                                                      objects.data() + end,
+                                                      env,
+                                                      tag_table,
+                                                      &heap_filter,
+                                                      filter_klass,
+                                                      callbacks,
+                                                      user_data,
+                                                      &stop_reports);
+      if (thread_pool != nullptr) {
+        thread_pool->AddTask(self, task);
+      } else {
+        task->Run(self);
+        task->Finalize();
+      }
+    }
+    if (thread_pool != nullptr) {
+      thread_pool->StartWorkers(self);
+      thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+      thread_pool->StopWorkers(self);
+    }
+  }
+  if (heap->IsGcConcurrentAndMoving()) {
+    heap->DecrementDisableMovingGC(self);
+  }
+
+  return ERR(NONE);
+}
+
 }  // namespace openjdkjvmti
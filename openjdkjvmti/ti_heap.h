@@ -60,12 +60,20 @@ class HeapExtensions {
  public:
   static jvmtiError JNICALL GetObjectHeapId(jvmtiEnv* env, jlong tag, jint* heap_id, ...);
   static jvmtiError JNICALL GetHeapName(jvmtiEnv* env, jint heap_id, char** heap_name, ...);
+  static jvmtiError JNICALL SetHeapSamplingInterval(jvmtiEnv* env, jint sampling_interval, ...);
 
   static jvmtiError JNICALL IterateThroughHeapExt(jvmtiEnv* env,
                                                   jint heap_filter,
                                                   jclass klass,
                                                   const jvmtiHeapCallbacks* callbacks,
                                                   const void* user_data);
+
+  static jvmtiError JNICALL IterateThroughHeapParallel(jvmtiEnv* env,
+                                                       jint heap_filter,
+                                                       jclass klass,
+                                                       const jvmtiHeapCallbacks* callbacks,
+                                                       const void* user_data,
+                                                       jint thread_count);
 };
 
 }  // namespace openjdkjvmti
@@ -31,7 +31,9 @@
 
 #include "ti_redefine.h"
 
+#include <deque>
 #include <limits>
+#include <unordered_map>
 
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
@@ -67,6 +69,7 @@
 #include "non_debuggable_classes.h"
 #include "object_lock.h"
 #include "runtime.h"
+#include "thread_list.h"
 #include "ti_breakpoint.h"
 #include "ti_class_loader.h"
 #include "transform.h"
@@ -137,56 +140,54 @@ class ObsoleteMap {
   art::ObjPtr<art::mirror::DexCache> original_dex_cache_;
 };
 
+// Where the obsolete versions of the methods of one of the redefined classes go.
+struct ObsoleteMethodsTarget {
+  ObsoleteMap* obsolete_map;
+  // The linear allocator we should use to make new methods.
+  art::LinearAlloc* allocator;
+};
+
+using ObsoletedMethods = std::unordered_map<art::ArtMethod*, ObsoleteMethodsTarget>;
+
 // This visitor walks thread stacks and allocates and sets up the obsolete methods. It also does
 // some basic sanity checks that the obsolete method is sane.
 class ObsoleteMethodStackVisitor : public art::StackVisitor {
  protected:
-  ObsoleteMethodStackVisitor(
-      art::Thread* thread,
-      art::LinearAlloc* allocator,
-      const std::unordered_set<art::ArtMethod*>& obsoleted_methods,
-      ObsoleteMap* obsolete_maps)
+  ObsoleteMethodStackVisitor(art::Thread* thread, const ObsoletedMethods& obsoleted_methods)
         : StackVisitor(thread,
                        /*context*/nullptr,
                        StackVisitor::StackWalkKind::kIncludeInlinedFrames),
-          allocator_(allocator),
-          obsoleted_methods_(obsoleted_methods),
-          obsolete_maps_(obsolete_maps) { }
+          obsoleted_methods_(obsoleted_methods) { }
 
   ~ObsoleteMethodStackVisitor() OVERRIDE {}
 
  public:
-  // Returns true if we successfully installed obsolete methods on this thread, filling
-  // obsolete_maps_ with the translations if needed. Returns false and fills error_msg if we fail.
-  // The stack is cleaned up when we fail.
-  static void UpdateObsoleteFrames(
-      art::Thread* thread,
-      art::LinearAlloc* allocator,
-      const std::unordered_set<art::ArtMethod*>& obsoleted_methods,
-      ObsoleteMap* obsolete_maps)
+  // Installs obsolete methods on this thread, filling the obsolete maps of the classes with the
+  // translations if needed.
+  static void UpdateObsoleteFrames(art::Thread* thread, const ObsoletedMethods& obsoleted_methods)
         REQUIRES(art::Locks::mutator_lock_) {
-    ObsoleteMethodStackVisitor visitor(thread,
-                                       allocator,
-                                       obsoleted_methods,
-                                       obsolete_maps);
+    ObsoleteMethodStackVisitor visitor(thread, obsoleted_methods);
     visitor.WalkStack();
   }
 
   bool VisitFrame() OVERRIDE REQUIRES(art::Locks::mutator_lock_) {
     art::ScopedAssertNoThreadSuspension snts("Fixing up the stack for obsolete methods.");
     art::ArtMethod* old_method = GetMethod();
-    if (obsoleted_methods_.find(old_method) != obsoleted_methods_.end()) {
+    auto target = obsoleted_methods_.find(old_method);
+    if (target != obsoleted_methods_.end()) {
       // We cannot ensure that the right dex file is used in inlined frames so we don't support
       // redefining them.
       DCHECK(!IsInInlinedFrame()) << "Inlined frames are not supported when using redefinition";
-      art::ArtMethod* new_obsolete_method = obsolete_maps_->FindObsoleteVersion(old_method);
+      ObsoleteMap* obsolete_map = target->second.obsolete_map;
+      art::ArtMethod* new_obsolete_method = obsolete_map->FindObsoleteVersion(old_method);
       if (new_obsolete_method == nullptr) {
         // Create a new Obsolete Method and put it in the list.
         art::Runtime* runtime = art::Runtime::Current();
         art::ClassLinker* cl = runtime->GetClassLinker();
         auto ptr_size = cl->GetImagePointerSize();
         const size_t method_size = art::ArtMethod::Size(ptr_size);
-        auto* method_storage = allocator_->Alloc(art::Thread::Current(), method_size);
+        auto* method_storage = target->second.allocator->Alloc(art::Thread::Current(),
+                                                                method_size);
         CHECK(method_storage != nullptr) << "Unable to allocate storage for obsolete version of '"
                                          << old_method->PrettyMethod() << "'";
         new_obsolete_method = new (method_storage) art::ArtMethod();
@@ -195,7 +196,7 @@ class ObsoleteMethodStackVisitor : public art::StackVisitor {
         new_obsolete_method->SetIsObsolete();
         new_obsolete_method->SetDontCompile();
         cl->SetEntryPointsForObsoleteMethod(new_obsolete_method);
-        obsolete_maps_->RecordObsolete(old_method, new_obsolete_method);
+        obsolete_map->RecordObsolete(old_method, new_obsolete_method);
         // Update JIT Data structures to point to the new method.
         art::jit::Jit* jit = art::Runtime::Current()->GetJit();
         if (jit != nullptr) {
@@ -211,14 +212,11 @@ class ObsoleteMethodStackVisitor : public art::StackVisitor {
   }
 
  private:
-  // The linear allocator we should use to make new methods.
-  art::LinearAlloc* allocator_;
-  // The set of all methods which could be obsoleted.
-  const std::unordered_set<art::ArtMethod*>& obsoleted_methods_;
-  // A map from the original to the newly allocated obsolete method for frames on this thread. The
-  // values in this map are added to the obsolete_methods_ (and obsolete_dex_caches_) fields of
-  // the redefined classes ClassExt as it is filled.
-  ObsoleteMap* obsolete_maps_;
+  // The methods of all redefined classes which could be obsoleted. The obsolete map of each class
+  // maps the original to the newly allocated obsolete method for frames on this thread. Its values
+  // are added to the obsolete_methods_ (and obsolete_dex_caches_) fields of the redefined classes
+  // ClassExt as it is filled.
+  const ObsoletedMethods& obsoleted_methods_;
 };
 
 jvmtiError Redefiner::IsModifiableClass(jvmtiEnv* env ATTRIBUTE_UNUSED,
@@ -546,33 +544,31 @@ art::mirror::Object* Redefiner::ClassRedefinition::AllocateOrGetOriginalDexFile(
 }
 
 struct CallbackCtx {
-  ObsoleteMap* obsolete_map;
-  art::LinearAlloc* allocator;
-  std::unordered_set<art::ArtMethod*> obsolete_methods;
-
-  explicit CallbackCtx(ObsoleteMap* map, art::LinearAlloc* alloc)
-      : obsolete_map(map), allocator(alloc) {}
+  // One per redefined class. A deque so that obsolete_methods can point into it.
+  std::deque<ObsoleteMap> obsolete_maps;
+  ObsoletedMethods obsolete_methods;
 };
 
 void DoAllocateObsoleteMethodsCallback(art::Thread* t, void* vdata) NO_THREAD_SAFETY_ANALYSIS {
   CallbackCtx* data = reinterpret_cast<CallbackCtx*>(vdata);
-  ObsoleteMethodStackVisitor::UpdateObsoleteFrames(t,
-                                                   data->allocator,
-                                                   data->obsolete_methods,
-                                                   data->obsolete_map);
+  ObsoleteMethodStackVisitor::UpdateObsoleteFrames(t, data->obsolete_methods);
 }
 
-// This creates any ArtMethod* structures needed for obsolete methods and ensures that the stack is
-// updated so they will be run.
-// TODO Rewrite so we can do this only once regardless of how many redefinitions there are.
-void Redefiner::ClassRedefinition::FindAndAllocateObsoleteMethods(art::mirror::Class* art_klass) {
-  art::ScopedAssertNoThreadSuspension ns("No thread suspension during thread stack walking");
+// This adds the methods of the class, which may become obsolete, to ctx. The ArtMethod* structures
+// needed for obsolete methods are only created when the stacks are walked.
+void Redefiner::ClassRedefinition::AddObsoleteMethodCandidates(art::mirror::Class* art_klass,
+                                                               CallbackCtx* ctx) {
   art::mirror::ClassExt* ext = art_klass->GetExtData();
   CHECK(ext->GetObsoleteMethods() != nullptr);
   art::ClassLinker* linker = driver_->runtime_->GetClassLinker();
   // This holds pointers to the obsolete methods map fields which are updated as needed.
-  ObsoleteMap map(ext->GetObsoleteMethods(), ext->GetObsoleteDexCaches(), art_klass->GetDexCache());
-  CallbackCtx ctx(&map, linker->GetAllocatorForClassLoader(art_klass->GetClassLoader()));
+  ctx->obsolete_maps.emplace_back(ext->GetObsoleteMethods(),
+                                  ext->GetObsoleteDexCaches(),
+                                  art_klass->GetDexCache());
+  ObsoleteMethodsTarget target = {
+      &ctx->obsolete_maps.back(),
+      linker->GetAllocatorForClassLoader(art_klass->GetClassLoader())
+  };
   // Add all the declared methods to the map
   for (auto& m : art_klass->GetDeclaredMethods(art::kRuntimePointerSize)) {
     if (m.IsIntrinsic()) {
@@ -587,12 +583,7 @@ void Redefiner::ClassRedefinition::FindAndAllocateObsoleteMethods(art::mirror::C
     // from (for example about stack-frame size). Furthermore we would be unable to get some useful
     // error checking from the interpreter which ensure we don't try to start executing obsolete
     // methods.
-    ctx.obsolete_methods.insert(&m);
-  }
-  {
-    art::MutexLock mu(driver_->self_, *art::Locks::thread_list_lock_);
-    art::ThreadList* list = art::Runtime::Current()->GetThreadList();
-    list->ForEach(DoAllocateObsoleteMethodsCallback, static_cast<void*>(&ctx));
+    ctx->obsolete_methods.emplace(&m, target);
   }
 }
 
@@ -1255,6 +1246,19 @@ void Redefiner::UnregisterAllBreakpoints() {
   }
 }
 
+// This creates any ArtMethod* structures needed for obsolete methods and ensures that the stack is
+// updated so they will be run. The stacks are walked once for all the redefined classes.
+void Redefiner::FindAndAllocateAllObsoleteMethods(RedefinitionDataHolder& holder) {
+  art::ScopedAssertNoThreadSuspension ns("No thread suspension during thread stack walking");
+  CallbackCtx ctx;
+  for (RedefinitionDataIter data = holder.begin(); data != holder.end(); ++data) {
+    data.GetRedefinition().AddObsoleteMethodCandidates(data.GetMirrorClass(), &ctx);
+  }
+  art::MutexLock mu(self_, *art::Locks::thread_list_lock_);
+  art::ThreadList* list = art::Runtime::Current()->GetThreadList();
+  list->ForEach(DoAllocateObsoleteMethodsCallback, static_cast<void*>(&ctx));
+}
+
 bool Redefiner::CheckAllRedefinitionAreValid() {
   for (Redefiner::ClassRedefinition& redef : redefinitions_) {
     if (!redef.CheckRedefinitionIsValid()) {
@@ -1370,18 +1374,20 @@ jvmtiError Redefiner::Run() {
   // TODO This isn't right. We need to change state without any chance of suspend ideally!
   art::ScopedThreadSuspension sts(self_, art::ThreadState::kNative);
   art::ScopedSuspendAll ssa("Final installation of redefined Classes!", /*long_suspend*/true);
+  // Obsolete methods are copied from the original methods, so allocate them all before updating
+  // any class.
+  FindAndAllocateAllObsoleteMethods(holder);
   for (RedefinitionDataIter data = holder.begin(); data != holder.end(); ++data) {
     art::ScopedAssertNoThreadSuspension nts("Updating runtime objects for redefinition");
     ClassRedefinition& redef = data.GetRedefinition();
     if (data.GetSourceClassLoader() != nullptr) {
       ClassLoaderHelper::UpdateJavaDexFile(data.GetJavaDexFile(), data.GetNewDexFileCookie());
     }
-    art::mirror::Class* klass = data.GetMirrorClass();
-    // TODO Rewrite so we don't do a stack walk for each and every class.
-    redef.FindAndAllocateObsoleteMethods(klass);
-    redef.UpdateClass(klass, data.GetNewDexCache(), data.GetOriginalDexFile());
+    redef.UpdateClass(data.GetMirrorClass(), data.GetNewDexCache(), data.GetOriginalDexFile());
   }
   RestoreObsoleteMethodMapsIfUnneeded(holder);
+  // Invoke targets cached by the interpreter may refer to the old methods.
+  runtime_->GetThreadList()->ClearInterpreterCaches();
   // TODO We should check for if any of the redefined methods are intrinsic methods here and, if any
   // are, force a full-world deoptimization before finishing redefinition. If we don't do this then
   // methods that have been jitted prior to the current redefinition being applied might continue
@@ -67,6 +67,7 @@ namespace openjdkjvmti {
 
 class RedefinitionDataHolder;
 class RedefinitionDataIter;
+struct CallbackCtx;
 
 // Class that can redefine a single class's methods.
 class Redefiner {
@@ -152,7 +153,7 @@ class Redefiner {
         /*out*/RedefinitionDataIter* cur_data)
           REQUIRES_SHARED(art::Locks::mutator_lock_);
 
-    void FindAndAllocateObsoleteMethods(art::mirror::Class* art_klass)
+    void AddObsoleteMethodCandidates(art::mirror::Class* art_klass, CallbackCtx* ctx)
         REQUIRES(art::Locks::mutator_lock_);
 
     // Checks that the dex file contains only the single expected class and that the top-level class
@@ -251,6 +252,9 @@ class Redefiner {
       REQUIRES_SHARED(art::Locks::mutator_lock_);
   void ReleaseAllDexFiles() REQUIRES_SHARED(art::Locks::mutator_lock_);
   void UnregisterAllBreakpoints() REQUIRES_SHARED(art::Locks::mutator_lock_);
+  // Walks all thread stacks once to install the obsolete methods of all redefined classes.
+  void FindAndAllocateAllObsoleteMethods(RedefinitionDataHolder& holder)
+      REQUIRES(art::Locks::mutator_lock_);
   // Restores the old obsolete methods maps if it turns out they weren't needed (ie there were no
   // new obsolete methods).
   void RestoreObsoleteMethodMapsIfUnneeded(RedefinitionDataHolder& holder)
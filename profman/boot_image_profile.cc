@@ -15,7 +15,7 @@
  */
 
 #include <memory>
-#include <set>
+#include <vector>
 
 #include "boot_image_profile.h"
 #include "dex/dex_file-inl.h"
@@ -27,19 +27,52 @@ namespace art {
 
 using Hotness = ProfileCompilationInfo::MethodHotness;
 
-void GenerateBootImageProfile(
+BootImageProfileGenerator::BootImageProfileGenerator(
     const std::vector<std::unique_ptr<const DexFile>>& dex_files,
-    const std::vector<std::unique_ptr<const ProfileCompilationInfo>>& profiles,
     const BootImageOptions& options,
     bool verbose,
-    ProfileCompilationInfo* out_profile) {
-  for (const std::unique_ptr<const ProfileCompilationInfo>& profile : profiles) {
-    // Avoid merging classes since we may want to only add classes that fit a certain criteria.
-    // If we merged the classes, every single class in each profile would be in the out_profile,
-    // but we want to only included classes that are in at least a few profiles.
-    out_profile->MergeWith(*profile, /*merge_classes*/ false);
+    ProfileCompilationInfo* out_profile)
+    : dex_files_(dex_files),
+      options_(options),
+      verbose_(verbose),
+      out_profile_(out_profile) {
+  for (const std::unique_ptr<const DexFile>& dex_file : dex_files_) {
+    method_counters_.emplace_back(dex_file->NumMethodIds(), 0u);
+    class_counters_.emplace_back(dex_file->NumTypeIds(), 0u);
   }
+}
+
+void BootImageProfileGenerator::AddProfile(const ProfileCompilationInfo& profile) {
+  // Avoid merging classes since we may want to only add classes that fit a certain criteria.
+  // If we merged the classes, every single class in each profile would be in the out_profile,
+  // but we want to only included classes that are in at least a few profiles.
+  out_profile_->MergeWith(profile, /*merge_classes*/ false);
+
+  for (size_t dex_index = 0; dex_index < dex_files_.size(); ++dex_index) {
+    const DexFile* dex_file = dex_files_[dex_index].get();
+    std::vector<uint32_t>& method_counters = method_counters_[dex_index];
+    std::vector<uint32_t>& class_counters = class_counters_[dex_index];
+    // Inferred classes are classes inferred from method samples of this profile.
+    std::vector<bool> inferred_classes(dex_file->NumTypeIds(), false);
+    for (size_t i = 0; i < dex_file->NumMethodIds(); ++i) {
+      MethodReference ref(dex_file, i);
+      Hotness hotness = profile.GetMethodHotness(ref);
+      if (hotness.IsInProfile()) {
+        ++method_counters[i];
+        out_profile_->AddMethodHotness(ref, hotness);
+        inferred_classes[ref.GetMethodId().class_idx_.index_] = true;
+      }
+    }
+    for (size_t i = 0; i < dex_file->NumClassDefs(); ++i) {
+      const dex::TypeIndex type_index = dex_file->GetClassDef(i).class_idx_;
+      if (inferred_classes[type_index.index_] || profile.ContainsClass(*dex_file, type_index)) {
+        ++class_counters[type_index.index_];
+      }
+    }
+  }
+}
 
+void BootImageProfileGenerator::Finish() {
   // Image classes that were added because they are commonly used.
   size_t class_count = 0;
   // Image classes that were only added because they were clean.
@@ -49,34 +82,24 @@ void GenerateBootImageProfile(
   // Total dirty classes.
   size_t dirty_count = 0;
 
-  for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
-    // Inferred classes are classes inferred from method samples.
-    std::set<std::pair<const ProfileCompilationInfo*, dex::TypeIndex>> inferred_classes;
+  for (size_t dex_index = 0; dex_index < dex_files_.size(); ++dex_index) {
+    const DexFile* dex_file = dex_files_[dex_index].get();
+    const std::vector<uint32_t>& method_counters = method_counters_[dex_index];
+    const std::vector<uint32_t>& class_counters = class_counters_[dex_index];
     for (size_t i = 0; i < dex_file->NumMethodIds(); ++i) {
-      MethodReference ref(dex_file.get(), i);
-      // This counter is how many profiles contain the method as sampled or hot.
-      size_t counter = 0;
-      for (const std::unique_ptr<const ProfileCompilationInfo>& profile : profiles) {
-        Hotness hotness = profile->GetMethodHotness(ref);
-        if (hotness.IsInProfile()) {
-          ++counter;
-          out_profile->AddMethodHotness(ref, hotness);
-          inferred_classes.emplace(profile.get(), ref.GetMethodId().class_idx_);
-        }
-      }
       // If the counter is greater or equal to the compile threshold, mark the method as hot.
       // Note that all hot methods are also marked as hot in the out profile during the merging
       // process.
-      if (counter >= options.compiled_method_threshold) {
+      if (method_counters[i] >= options_.compiled_method_threshold) {
         Hotness hotness;
         hotness.AddFlag(Hotness::kFlagHot);
-        out_profile->AddMethodHotness(ref, hotness);
+        out_profile_->AddMethodHotness(MethodReference(dex_file, i), hotness);
       }
     }
     // Walk all of the classes and add them to the profile if they meet the requirements.
     for (size_t i = 0; i < dex_file->NumClassDefs(); ++i) {
       const DexFile::ClassDef& class_def = dex_file->GetClassDef(i);
-      TypeReference ref(dex_file.get(), class_def.class_idx_);
+      TypeReference ref(dex_file, class_def.class_idx_);
       bool is_clean = true;
       const uint8_t* class_data = dex_file->GetClassData(class_def);
       if (class_data != nullptr) {
@@ -108,31 +131,37 @@ void GenerateBootImageProfile(
       }
       ++(is_clean ? clean_count : dirty_count);
       // This counter is how many profiles contain the class.
-      size_t counter = 0;
-      for (const std::unique_ptr<const ProfileCompilationInfo>& profile : profiles) {
-        auto it = inferred_classes.find(std::make_pair(profile.get(), ref.TypeIndex()));
-        if (it != inferred_classes.end() ||
-            profile->ContainsClass(*ref.dex_file, ref.TypeIndex())) {
-          ++counter;
-        }
-      }
+      const uint32_t counter = class_counters[ref.TypeIndex().index_];
       if (counter == 0) {
         continue;
       }
-      if (counter >= options.image_class_theshold) {
+      if (counter >= options_.image_class_theshold) {
         ++class_count;
-        out_profile->AddClassForDex(ref);
-      } else if (is_clean && counter >= options.image_class_clean_theshold) {
+        out_profile_->AddClassForDex(ref);
+      } else if (is_clean && counter >= options_.image_class_clean_theshold) {
         ++clean_class_count;
-        out_profile->AddClassForDex(ref);
+        out_profile_->AddClassForDex(ref);
       }
     }
   }
-  if (verbose) {
+  if (verbose_) {
     LOG(INFO) << "Image classes " << class_count + clean_class_count
               << " added because clean " << clean_class_count
               << " total clean " << clean_count << " total dirty " << dirty_count;
   }
 }
 
+void GenerateBootImageProfile(
+    const std::vector<std::unique_ptr<const DexFile>>& dex_files,
+    const std::vector<std::unique_ptr<const ProfileCompilationInfo>>& profiles,
+    const BootImageOptions& options,
+    bool verbose,
+    ProfileCompilationInfo* out_profile) {
+  BootImageProfileGenerator generator(dex_files, options, verbose, out_profile);
+  for (const std::unique_ptr<const ProfileCompilationInfo>& profile : profiles) {
+    generator.AddProfile(*profile);
+  }
+  generator.Finish();
+}
+
 }  // namespace art
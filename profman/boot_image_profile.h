@@ -42,6 +42,37 @@ struct BootImageOptions {
   uint32_t compiled_method_threshold = std::numeric_limits<uint32_t>::max();
 };
 
+// Incrementally merges profiles to generate a boot profile. Only per dex file counters are kept
+// for the profiles added so far, so profiles can be loaded, added and released one at a time,
+// which bounds memory use when aggregating a large number of profiles.
+class BootImageProfileGenerator {
+ public:
+  BootImageProfileGenerator(const std::vector<std::unique_ptr<const DexFile>>& dex_files,
+                            const BootImageOptions& options,
+                            bool verbose,
+                            ProfileCompilationInfo* out_profile);
+
+  // Merge the methods of `profile` into the out profile and count the methods and classes it
+  // contains. The profile is not referenced after the call returns.
+  void AddProfile(const ProfileCompilationInfo& profile);
+
+  // Add the classes and methods which meet the options to the out profile. Must be called
+  // once, after all the profiles have been added.
+  void Finish();
+
+ private:
+  const std::vector<std::unique_ptr<const DexFile>>& dex_files_;
+  const BootImageOptions& options_;
+  const bool verbose_;
+  ProfileCompilationInfo* const out_profile_;
+
+  // For each dex file, how many profiles contain the method as sampled or hot.
+  std::vector<std::vector<uint32_t>> method_counters_;
+  // For each dex file, how many profiles contain the class, either directly or inferred from
+  // one of its methods.
+  std::vector<std::vector<uint32_t>> class_counters_;
+};
+
 // Merge a bunch of profiles together to generate a boot profile. Classes and methods are added
 // to the out_profile if they meet the options.
 void GenerateBootImageProfile(
@@ -1091,32 +1091,28 @@ class ProfMan FINAL {
       PLOG(ERROR) << "Expected dex files for creating boot profile";
       return -2;
     }
-    // Open the input profiles.
-    std::vector<std::unique_ptr<const ProfileCompilationInfo>> profiles;
-    if (!profile_files_fd_.empty()) {
-      for (int profile_file_fd : profile_files_fd_) {
-        std::unique_ptr<const ProfileCompilationInfo> profile(LoadProfile("", profile_file_fd));
-        if (profile == nullptr) {
-          return -3;
-        }
-        profiles.emplace_back(std::move(profile));
+    // Load the input profiles one at a time and release each of them once its counts have been
+    // added, so that memory use does not grow with the number of profiles.
+    ProfileCompilationInfo out_profile;
+    BootImageProfileGenerator generator(dex_files,
+                                        boot_image_options_,
+                                        VLOG_IS_ON(profiler),
+                                        &out_profile);
+    for (int profile_file_fd : profile_files_fd_) {
+      std::unique_ptr<const ProfileCompilationInfo> profile(LoadProfile("", profile_file_fd));
+      if (profile == nullptr) {
+        return -3;
       }
+      generator.AddProfile(*profile);
     }
-    if (!profile_files_.empty()) {
-      for (const std::string& profile_file : profile_files_) {
-        std::unique_ptr<const ProfileCompilationInfo> profile(LoadProfile(profile_file, kInvalidFd));
-        if (profile == nullptr) {
-          return -4;
-        }
-        profiles.emplace_back(std::move(profile));
+    for (const std::string& profile_file : profile_files_) {
+      std::unique_ptr<const ProfileCompilationInfo> profile(LoadProfile(profile_file, kInvalidFd));
+      if (profile == nullptr) {
+        return -4;
       }
+      generator.AddProfile(*profile);
     }
-    ProfileCompilationInfo out_profile;
-    GenerateBootImageProfile(dex_files,
-                             profiles,
-                             boot_image_options_,
-                             VLOG_IS_ON(profiler),
-                             &out_profile);
+    generator.Finish();
     out_profile.Save(reference_fd);
     close(reference_fd);
     return 0;
@@ -54,6 +54,7 @@ Arm64FeaturesUniquePtr Arm64InstructionSetFeatures::FromVariant(
         "cortex-a35",
         "cortex-a55",
         "cortex-a75",
+        "cortex-a76",
         "exynos-m1",
         "exynos-m2",
         "exynos-m3",
@@ -72,8 +73,35 @@ Arm64FeaturesUniquePtr Arm64InstructionSetFeatures::FromVariant(
   // The variants that need a fix for 843419 are the same that need a fix for 835769.
   bool needs_a53_843419_fix = needs_a53_835769_fix;
 
+  static const char* arm64_in_order_variants[] = {
+      "cortex-a35",
+      "cortex-a53",
+      "cortex-a55",
+  };
+  static const char* arm64_out_of_order_variants[] = {
+      "cortex-a57",
+      "cortex-a72",
+      "cortex-a73",
+      "cortex-a75",
+      "cortex-a76",
+      "exynos-m1",
+      "exynos-m2",
+      "exynos-m3",
+      "denver64",
+      "kryo",
+      "kryo300"
+  };
+  Pipeline pipeline = Pipeline::kUnknown;
+  if (FindVariantInArray(arm64_in_order_variants, arraysize(arm64_in_order_variants), variant)) {
+    pipeline = Pipeline::kInOrder;
+  } else if (FindVariantInArray(arm64_out_of_order_variants,
+                                arraysize(arm64_out_of_order_variants),
+                                variant)) {
+    pipeline = Pipeline::kOutOfOrder;
+  }
+
   return Arm64FeaturesUniquePtr(
-      new Arm64InstructionSetFeatures(needs_a53_835769_fix, needs_a53_843419_fix));
+      new Arm64InstructionSetFeatures(needs_a53_835769_fix, needs_a53_843419_fix, pipeline));
 }
 
 Arm64FeaturesUniquePtr Arm64InstructionSetFeatures::FromBitmap(uint32_t bitmap) {
@@ -140,7 +168,7 @@ Arm64InstructionSetFeatures::AddFeaturesFromSplitString(
     }
   }
   return std::unique_ptr<const InstructionSetFeatures>(
-      new Arm64InstructionSetFeatures(is_a53, is_a53));
+      new Arm64InstructionSetFeatures(is_a53, is_a53, pipeline_));
 }
 
 }  // namespace art
@@ -27,6 +27,13 @@ using Arm64FeaturesUniquePtr = std::unique_ptr<const Arm64InstructionSetFeatures
 // Instruction set features relevant to the ARM64 architecture.
 class Arm64InstructionSetFeatures FINAL : public InstructionSetFeatures {
  public:
+  // The kind of pipeline of the CPU variant, used to tune instruction scheduling.
+  enum class Pipeline {
+    kUnknown,     // Generic variants, or big.LITTLE pairs of in-order and out-of-order cores.
+    kInOrder,     // For example Cortex-A53 and Cortex-A55.
+    kOutOfOrder,  // For example Cortex-A57 and Cortex-A76.
+  };
+
   // Process a CPU variant string like "krait" or "cortex-a15" and create InstructionSetFeatures.
   static Arm64FeaturesUniquePtr FromVariant(const std::string& variant, std::string* error_msg);
 
@@ -68,6 +75,12 @@ class Arm64InstructionSetFeatures FINAL : public InstructionSetFeatures {
       return fix_cortex_a53_843419_;
   }
 
+  // This is a tuning hint rather than a feature: it is not part of Equals() or AsBitmap(),
+  // and features created from a bitmap or from the build or the running CPU report kUnknown.
+  Pipeline GetPipeline() const {
+    return pipeline_;
+  }
+
   virtual ~Arm64InstructionSetFeatures() {}
 
  protected:
@@ -77,10 +90,13 @@ class Arm64InstructionSetFeatures FINAL : public InstructionSetFeatures {
                                  std::string* error_msg) const OVERRIDE;
 
  private:
-  Arm64InstructionSetFeatures(bool needs_a53_835769_fix, bool needs_a53_843419_fix)
+  Arm64InstructionSetFeatures(bool needs_a53_835769_fix,
+                              bool needs_a53_843419_fix,
+                              Pipeline pipeline = Pipeline::kUnknown)
       : InstructionSetFeatures(),
         fix_cortex_a53_835769_(needs_a53_835769_fix),
-        fix_cortex_a53_843419_(needs_a53_843419_fix) {
+        fix_cortex_a53_843419_(needs_a53_843419_fix),
+        pipeline_(pipeline) {
   }
 
   // Bitmap positions for encoding features as a bitmap.
@@ -90,6 +106,7 @@ class Arm64InstructionSetFeatures FINAL : public InstructionSetFeatures {
 
   const bool fix_cortex_a53_835769_;
   const bool fix_cortex_a53_843419_;
+  const Pipeline pipeline_;
 
   DISALLOW_COPY_AND_ASSIGN(Arm64InstructionSetFeatures);
 };
@@ -86,4 +86,35 @@ TEST(Arm64InstructionSetFeaturesTest, Arm64Features) {
   EXPECT_EQ(cortex_a75_features->AsBitmap(), 0U);
 }
 
+TEST(Arm64InstructionSetFeaturesTest, Arm64Pipeline) {
+  using Pipeline = Arm64InstructionSetFeatures::Pipeline;
+  std::string error_msg;
+  Arm64FeaturesUniquePtr default_features(
+      Arm64InstructionSetFeatures::FromVariant("default", &error_msg));
+  ASSERT_TRUE(default_features.get() != nullptr) << error_msg;
+  EXPECT_EQ(Pipeline::kUnknown, default_features->GetPipeline());
+
+  Arm64FeaturesUniquePtr cortex_a55_features(
+      Arm64InstructionSetFeatures::FromVariant("cortex-a55", &error_msg));
+  ASSERT_TRUE(cortex_a55_features.get() != nullptr) << error_msg;
+  EXPECT_EQ(Pipeline::kInOrder, cortex_a55_features->GetPipeline());
+
+  Arm64FeaturesUniquePtr cortex_a76_features(
+      Arm64InstructionSetFeatures::FromVariant("cortex-a76", &error_msg));
+  ASSERT_TRUE(cortex_a76_features.get() != nullptr) << error_msg;
+  EXPECT_EQ(Pipeline::kOutOfOrder, cortex_a76_features->GetPipeline());
+  // The pipeline only tunes code generation and does not make features different.
+  EXPECT_TRUE(cortex_a76_features->Equals(cortex_a55_features.get()));
+  std::unique_ptr<const InstructionSetFeatures> from_string(
+      cortex_a76_features->AddFeaturesFromString("-a53", &error_msg));
+  ASSERT_TRUE(from_string.get() != nullptr) << error_msg;
+  EXPECT_EQ(Pipeline::kOutOfOrder,
+            from_string->AsArm64InstructionSetFeatures()->GetPipeline());
+
+  Arm64FeaturesUniquePtr big_little_features(
+      Arm64InstructionSetFeatures::FromVariant("cortex-a53.a57", &error_msg));
+  ASSERT_TRUE(big_little_features.get() != nullptr) << error_msg;
+  EXPECT_EQ(Pipeline::kUnknown, big_little_features->GetPipeline());
+}
+
 }  // namespace art
@@ -271,6 +271,11 @@ uint32_t ArtMethod::FindDexMethodIndexInOtherDexFile(const DexFile& other_dexfil
 
 uint32_t ArtMethod::FindCatchBlock(Handle<mirror::Class> exception_type,
                                    uint32_t dex_pc, bool* has_no_move_exception) {
+  CodeItemDataAccessor accessor(DexInstructionData());
+  CatchHandlerIterator it(accessor, dex_pc);
+  if (!it.HasNext()) {
+    return dex::kDexNoIndex;  // Not in a try block, no need to set aside the exception.
+  }
   // Set aside the exception while we resolve its type.
   Thread* self = Thread::Current();
   StackHandleScope<1> hs(self);
@@ -279,8 +284,7 @@ uint32_t ArtMethod::FindCatchBlock(Handle<mirror::Class> exception_type,
   // Default to handler not found.
   uint32_t found_dex_pc = dex::kDexNoIndex;
   // Iterate over the catch handlers associated with dex_pc.
-  CodeItemDataAccessor accessor(DexInstructionData());
-  for (CatchHandlerIterator it(accessor, dex_pc); it.HasNext(); it.Next()) {
+  for (; it.HasNext(); it.Next()) {
     dex::TypeIndex iter_type_idx = it.GetHandlerTypeIndex();
     // Catch all case
     if (!iter_type_idx.IsValid()) {
@@ -16,6 +16,7 @@
 
 #include "arena_allocator-inl.h"
 
+#include <pthread.h>
 #include <sys/mman.h>
 
 #include <algorithm>
@@ -281,8 +282,6 @@ void Arena::Reset() {
 
 ArenaPool::ArenaPool(bool use_malloc, bool low_4gb, const char* name)
     : use_malloc_(use_malloc),
-      lock_("Arena pool lock", kArenaPoolLock),
-      free_arenas_(nullptr),
       low_4gb_(low_4gb),
       name_(name) {
   if (low_4gb) {
@@ -298,31 +297,64 @@ ArenaPool::~ArenaPool() {
 }
 
 void ArenaPool::ReclaimMemory() {
-  while (free_arenas_ != nullptr) {
-    Arena* arena = free_arenas_;
-    free_arenas_ = free_arenas_->next_;
-    delete arena;
+  for (Shard& shard : shards_) {
+    while (shard.free_arenas != nullptr) {
+      Arena* arena = shard.free_arenas;
+      shard.free_arenas = shard.free_arenas->next_;
+      delete arena;
+    }
   }
 }
 
 void ArenaPool::LockReclaimMemory() {
-  MutexLock lock(Thread::Current(), lock_);
-  ReclaimMemory();
+  Thread* self = Thread::Current();
+  for (Shard& shard : shards_) {
+    Arena* arenas;
+    {
+      MutexLock lock(self, shard.lock);
+      arenas = shard.free_arenas;
+      shard.free_arenas = nullptr;
+    }
+    while (arenas != nullptr) {
+      Arena* arena = arenas;
+      arenas = arenas->next_;
+      delete arena;
+    }
+  }
+}
+
+size_t ArenaPool::CurrentShardIndex() {
+  // Thread ids of pthreads are addresses, mix their bits.
+  uint64_t id = static_cast<uint64_t>(pthread_self());
+  return static_cast<size_t>((id * UINT64_C(0x9e3779b97f4a7c15)) >> 32) % kNumShards;
+}
+
+Arena* ArenaPool::TakeFreeArena(Shard* shard, size_t size) {
+  MutexLock lock(Thread::Current(), shard->lock);
+  // Most arenas have the default size, so the first fitting arena is usually the first one.
+  for (Arena** link = &shard->free_arenas; *link != nullptr; link = &(*link)->next_) {
+    Arena* arena = *link;
+    if (LIKELY(arena->Size() >= size)) {
+      *link = arena->next_;
+      arena->next_ = nullptr;
+      return arena;
+    }
+  }
+  return nullptr;
 }
 
 Arena* ArenaPool::AllocArena(size_t size) {
-  Thread* self = Thread::Current();
+  const size_t shard_index = CurrentShardIndex();
   Arena* ret = nullptr;
-  {
-    MutexLock lock(self, lock_);
-    if (free_arenas_ != nullptr && LIKELY(free_arenas_->Size() >= size)) {
-      ret = free_arenas_;
-      free_arenas_ = free_arenas_->next_;
-    }
+  for (size_t i = 0; i != kNumShards && ret == nullptr; ++i) {
+    ret = TakeFreeArena(&shards_[(shard_index + i) % kNumShards], size);
   }
   if (ret == nullptr) {
     ret = use_malloc_ ? static_cast<Arena*>(new MallocArena(size)) :
         new MemMapArena(size, low_4gb_, name_);
+    num_new_arenas_.FetchAndAddRelaxed(1u);
+  } else {
+    num_reused_arenas_.FetchAndAddRelaxed(1u);
   }
   ret->Reset();
   return ret;
@@ -332,18 +364,39 @@ void ArenaPool::TrimMaps() {
   if (!use_malloc_) {
     ScopedTrace trace(__PRETTY_FUNCTION__);
     // Doesn't work for malloc.
-    MutexLock lock(Thread::Current(), lock_);
-    for (Arena* arena = free_arenas_; arena != nullptr; arena = arena->next_) {
-      arena->Release();
+    Thread* self = Thread::Current();
+    for (Shard& shard : shards_) {
+      // Take the arenas out so that the madvise() calls don't hold up allocating threads. Other
+      // shards can serve them meanwhile.
+      Arena* arenas;
+      {
+        MutexLock lock(self, shard.lock);
+        arenas = shard.free_arenas;
+        shard.free_arenas = nullptr;
+      }
+      if (arenas == nullptr) {
+        continue;
+      }
+      Arena* last = arenas;
+      for (Arena* arena = arenas; arena != nullptr; arena = arena->next_) {
+        arena->Release();
+        last = arena;
+      }
+      MutexLock lock(self, shard.lock);
+      last->next_ = shard.free_arenas;
+      shard.free_arenas = arenas;
     }
   }
 }
 
 size_t ArenaPool::GetBytesAllocated() const {
   size_t total = 0;
-  MutexLock lock(Thread::Current(), lock_);
-  for (Arena* arena = free_arenas_; arena != nullptr; arena = arena->next_) {
-    total += arena->GetBytesAllocated();
+  Thread* self = Thread::Current();
+  for (const Shard& shard : shards_) {
+    MutexLock lock(self, shard.lock);
+    for (Arena* arena = shard.free_arenas; arena != nullptr; arena = arena->next_) {
+      total += arena->GetBytesAllocated();
+    }
   }
   return total;
 }
@@ -370,10 +423,10 @@ void ArenaPool::FreeArenaChain(Arena* first) {
     while (last->next_ != nullptr) {
       last = last->next_;
     }
-    Thread* self = Thread::Current();
-    MutexLock lock(self, lock_);
-    last->next_ = free_arenas_;
-    free_arenas_ = first;
+    Shard& shard = shards_[CurrentShardIndex()];
+    MutexLock lock(Thread::Current(), shard.lock);
+    last->next_ = shard.free_arenas;
+    shard.free_arenas = first;
   }
 }
 
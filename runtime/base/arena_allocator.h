@@ -20,6 +20,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "base/atomic.h"
 #include "base/bit_utils.h"
 #include "base/debug_stack.h"
 #include "base/dchecked_vector.h"
@@ -253,21 +254,47 @@ class ArenaPool {
                      bool low_4gb = false,
                      const char* name = "LinearAlloc");
   ~ArenaPool();
-  Arena* AllocArena(size_t size) REQUIRES(!lock_);
-  void FreeArenaChain(Arena* first) REQUIRES(!lock_);
-  size_t GetBytesAllocated() const REQUIRES(!lock_);
+  Arena* AllocArena(size_t size);
+  void FreeArenaChain(Arena* first);
+  size_t GetBytesAllocated() const;
   void ReclaimMemory() NO_THREAD_SAFETY_ANALYSIS;
-  void LockReclaimMemory() REQUIRES(!lock_);
+  void LockReclaimMemory();
   // Trim the maps in arenas by madvising, used by JIT to reduce memory usage. This only works
   // use_malloc is false.
-  void TrimMaps() REQUIRES(!lock_);
+  void TrimMaps();
+
+  // The number of arenas AllocArena() took from the free arenas, and the number it created.
+  size_t GetNumReusedArenas() const {
+    return num_reused_arenas_.LoadRelaxed();
+  }
+  size_t GetNumNewArenas() const {
+    return num_new_arenas_.LoadRelaxed();
+  }
 
  private:
+  // Free arenas are kept in shards picked by the thread, so that threads allocating in parallel,
+  // like the compiler threads of dex2oat, rarely contend for a lock. A thread takes arenas from
+  // the other shards before creating new ones.
+  static constexpr size_t kNumShards = 8;
+
+  struct Shard {
+    Shard() : lock("Arena pool lock", kArenaPoolLock), free_arenas(nullptr) {}
+
+    mutable Mutex lock DEFAULT_MUTEX_ACQUIRED_AFTER;
+    Arena* free_arenas GUARDED_BY(lock);
+  };
+
+  static size_t CurrentShardIndex();
+
+  // Take an arena of at least `size` bytes from the free arenas of `shard`, or return null.
+  static Arena* TakeFreeArena(Shard* shard, size_t size) REQUIRES(!shard->lock);
+
   const bool use_malloc_;
-  mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
-  Arena* free_arenas_ GUARDED_BY(lock_);
+  Shard shards_[kNumShards];
   const bool low_4gb_;
   const char* name_;
+  Atomic<size_t> num_reused_arenas_;
+  Atomic<size_t> num_new_arenas_;
   DISALLOW_COPY_AND_ASSIGN(ArenaPool);
 };
 
@@ -42,6 +42,30 @@ TEST_F(ArenaAllocatorTest, Test) {
   EXPECT_EQ(2U, bv.GetStorageSize());
 }
 
+TEST_F(ArenaAllocatorTest, ArenaReuse) {
+  if (arena_allocator::kArenaAllocatorPreciseTracking) {
+    printf("WARNING: TEST DISABLED FOR precise arena tracking\n");
+    return;
+  }
+  static constexpr size_t kSmallSize = arena_allocator::kArenaDefaultSize;
+  static constexpr size_t kLargeSize = 4 * arena_allocator::kArenaDefaultSize;
+  ArenaPool pool;
+  Arena* small_arena = pool.AllocArena(kSmallSize);
+  Arena* large_arena = pool.AllocArena(kLargeSize);
+  EXPECT_EQ(2u, pool.GetNumNewArenas());
+  EXPECT_EQ(0u, pool.GetNumReusedArenas());
+  // Free the small arena last, so that it comes first in the free arenas.
+  pool.FreeArenaChain(large_arena);
+  pool.FreeArenaChain(small_arena);
+  // The large request skips the small arena.
+  EXPECT_EQ(large_arena, pool.AllocArena(kLargeSize));
+  EXPECT_EQ(small_arena, pool.AllocArena(kSmallSize));
+  EXPECT_EQ(2u, pool.GetNumNewArenas());
+  EXPECT_EQ(2u, pool.GetNumReusedArenas());
+  pool.FreeArenaChain(small_arena);
+  pool.FreeArenaChain(large_arena);
+}
+
 TEST_F(ArenaAllocatorTest, MakeDefined) {
   // Regression test to make sure we mark the allocated area defined.
   ArenaPool pool;
@@ -156,19 +156,48 @@ inline void BaseMutex::RegisterAsUnlocked(Thread* self) {
   }
 }
 
+#if ART_USE_FUTEXES
+inline AtomicInteger* ReaderWriterMutex::GetReaderStripe(const Thread* self) const {
+  // Thread ids are mostly allocated in sequence, so consecutive threads get distinct stripes.
+  return &reader_stripes_[static_cast<uint32_t>(SafeGetTid(self)) % kNumReaderStripes].count;
+}
+
+inline void ReaderWriterMutex::ReleaseReaderStripe(AtomicInteger* stripe) {
+  // Sequentially consistent with the writer claiming state_ before summing the stripes: either
+  // the writer sees this decrement, or this thread sees the claim and wakes the writer.
+  stripe->FetchAndSubSequentiallyConsistent(1);
+  if (UNLIKELY(state_.LoadSequentiallyConsistent() < 0)) {
+    WakeupWriterWaitingForReaders();
+  }
+}
+#endif
+
 inline void ReaderWriterMutex::SharedLock(Thread* self) {
   DCHECK(self == nullptr || self == Thread::Current());
 #if ART_USE_FUTEXES
-  bool done = false;
-  do {
-    int32_t cur_state = state_.LoadRelaxed();
-    if (LIKELY(cur_state >= 0)) {
-      // Add as an extra reader.
-      done = state_.CompareAndSetWeakAcquire(cur_state, cur_state + 1);
-    } else {
-      HandleSharedLockContention(self, cur_state);
+  if (reader_stripes_ != nullptr) {
+    AtomicInteger* stripe = GetReaderStripe(self);
+    while (true) {
+      // Count as a reader first, then check that no writer holds the lock. A writer still
+      // waiting for readers to leave doesn't stop more readers.
+      stripe->FetchAndAddSequentiallyConsistent(1);
+      if (LIKELY(state_.LoadSequentiallyConsistent() != -1)) {
+        break;
+      }
+      HandleStripedSharedLockContention(self, stripe);
     }
-  } while (!done);
+  } else {
+    bool done = false;
+    do {
+      int32_t cur_state = state_.LoadRelaxed();
+      if (LIKELY(cur_state >= 0)) {
+        // Add as an extra reader.
+        done = state_.CompareAndSetWeakAcquire(cur_state, cur_state + 1);
+      } else {
+        HandleSharedLockContention(self, cur_state);
+      }
+    } while (!done);
+  }
 #else
   CHECK_MUTEX_CALL(pthread_rwlock_rdlock, (&rwlock_));
 #endif
@@ -183,6 +212,10 @@ inline void ReaderWriterMutex::SharedUnlock(Thread* self) {
   AssertSharedHeld(self);
   RegisterAsUnlocked(self);
 #if ART_USE_FUTEXES
+  if (reader_stripes_ != nullptr) {
+    ReleaseReaderStripe(GetReaderStripe(self));
+    return;
+  }
   bool done = false;
   do {
     int32_t cur_state = state_.LoadRelaxed();
@@ -26,6 +26,7 @@
 #include "base/systrace.h"
 #include "base/time_utils.h"
 #include "base/value_object.h"
+#include "lock_contention_profiler.h"
 #include "mutex-inl.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-inl.h"
@@ -166,10 +167,11 @@ class Locks::ScopedExpectedMutexesOnWeakRefAccessLock FINAL {
 class ScopedContentionRecorder FINAL : public ValueObject {
  public:
   ScopedContentionRecorder(BaseMutex* mutex, uint64_t blocked_tid, uint64_t owner_tid)
-      : mutex_(kLogLockContentions ? mutex : nullptr),
+      : mutex_(mutex),
         blocked_tid_(kLogLockContentions ? blocked_tid : 0),
         owner_tid_(kLogLockContentions ? owner_tid : 0),
-        start_nano_time_(kLogLockContentions ? NanoTime() : 0) {
+        profile_(LockContentionProfiler::IsEnabled()),
+        start_nano_time_((kLogLockContentions || profile_) ? NanoTime() : 0) {
     if (ATRACE_ENABLED()) {
       std::string msg = StringPrintf("Lock contention on %s (owner tid: %" PRIu64 ")",
                                      mutex->GetName(), owner_tid);
@@ -179,9 +181,15 @@ class ScopedContentionRecorder FINAL : public ValueObject {
 
   ~ScopedContentionRecorder() {
     ATRACE_END();
-    if (kLogLockContentions) {
+    if (kLogLockContentions || profile_) {
       uint64_t end_nano_time = NanoTime();
-      mutex_->RecordContention(blocked_tid_, owner_tid_, end_nano_time - start_nano_time_);
+      if (kLogLockContentions) {
+        mutex_->RecordContention(blocked_tid_, owner_tid_, end_nano_time - start_nano_time_);
+      }
+      if (profile_) {
+        LockContentionProfiler::RecordMutexContention(mutex_->GetName(),
+                                                      end_nano_time - start_nano_time_);
+      }
     }
   }
 
@@ -189,6 +197,7 @@ class ScopedContentionRecorder FINAL : public ValueObject {
   BaseMutex* const mutex_;
   const uint64_t blocked_tid_;
   const uint64_t owner_tid_;
+  const bool profile_;
   const uint64_t start_nano_time_;
 };
 
@@ -601,13 +610,16 @@ void Mutex::WakeupToRespondToEmptyCheckpoint() {
 #endif
 }
 
-ReaderWriterMutex::ReaderWriterMutex(const char* name, LockLevel level)
+ReaderWriterMutex::ReaderWriterMutex(const char* name, LockLevel level, bool scalable_readers)
     : BaseMutex(name, level)
 #if ART_USE_FUTEXES
-    , state_(0), num_pending_readers_(0), num_pending_writers_(0)
+    , state_(0), num_pending_readers_(0), num_pending_writers_(0),
+      reader_stripes_(scalable_readers ? new ReaderStripe[kNumReaderStripes]() : nullptr),
+      reader_stripes_sequence_(0)
 #endif
 {
 #if !ART_USE_FUTEXES
+  UNUSED(scalable_readers);  // Only supported with futexes.
   CHECK_MUTEX_CALL(pthread_rwlock_init, (&rwlock_, nullptr));
 #endif
   exclusive_owner_.StoreRelaxed(0);
@@ -619,6 +631,10 @@ ReaderWriterMutex::~ReaderWriterMutex() {
   CHECK_EQ(GetExclusiveOwnerTid(), 0);
   CHECK_EQ(num_pending_readers_.LoadRelaxed(), 0);
   CHECK_EQ(num_pending_writers_.LoadRelaxed(), 0);
+  if (reader_stripes_ != nullptr) {
+    CHECK_EQ(NumStripedReaders(), 0);
+    delete[] reader_stripes_;
+  }
 #else
   // We can't use CHECK_MUTEX_CALL here because on shutdown a suspended daemon thread
   // may still be using locks.
@@ -636,11 +652,13 @@ void ReaderWriterMutex::ExclusiveLock(Thread* self) {
   AssertNotExclusiveHeld(self);
 #if ART_USE_FUTEXES
   bool done = false;
+  // With reader stripes, claim the lock first and wait for the readers below.
+  const int32_t new_state = (reader_stripes_ != nullptr) ? kStripedWriterWaiting : -1;
   do {
     int32_t cur_state = state_.LoadRelaxed();
     if (LIKELY(cur_state == 0)) {
       // Change state from 0 to -1 and impose load/store ordering appropriate for lock acquisition.
-      done = state_.CompareAndSetWeakAcquire(0 /* cur_state*/, -1 /* new state */);
+      done = state_.CompareAndSetWeakAcquire(0 /* cur_state*/, new_state);
     } else {
       // Failed to acquire, hang up.
       ScopedContentionRecorder scr(this, SafeGetTid(self), GetExclusiveOwnerTid());
@@ -658,6 +676,10 @@ void ReaderWriterMutex::ExclusiveLock(Thread* self) {
       --num_pending_writers_;
     }
   } while (!done);
+  if (reader_stripes_ != nullptr) {
+    bool drained = WaitForStripedReaders(self, /* end_abs_ts */ nullptr);
+    DCHECK(drained);
+  }
   DCHECK_EQ(state_.LoadRelaxed(), -1);
 #else
   CHECK_MUTEX_CALL(pthread_rwlock_wrlock, (&rwlock_));
@@ -709,11 +731,12 @@ bool ReaderWriterMutex::ExclusiveLockWithTimeout(Thread* self, int64_t ms, int32
   bool done = false;
   timespec end_abs_ts;
   InitTimeSpec(true, CLOCK_MONOTONIC, ms, ns, &end_abs_ts);
+  const int32_t new_state = (reader_stripes_ != nullptr) ? kStripedWriterWaiting : -1;
   do {
     int32_t cur_state = state_.LoadRelaxed();
     if (cur_state == 0) {
       // Change state from 0 to -1 and impose load/store ordering appropriate for lock acquisition.
-      done = state_.CompareAndSetWeakAcquire(0 /* cur_state */, -1 /* new state */);
+      done = state_.CompareAndSetWeakAcquire(0 /* cur_state */, new_state);
     } else {
       // Failed to acquire, hang up.
       timespec now_abs_ts;
@@ -741,6 +764,14 @@ bool ReaderWriterMutex::ExclusiveLockWithTimeout(Thread* self, int64_t ms, int32
       --num_pending_writers_;
     }
   } while (!done);
+  if (reader_stripes_ != nullptr && !WaitForStripedReaders(self, &end_abs_ts)) {
+    // Give up the claim, waking the readers and writers that saw it.
+    state_.StoreSequentiallyConsistent(0);
+    if (num_pending_readers_.LoadRelaxed() > 0 || num_pending_writers_.LoadRelaxed() > 0) {
+      futex(state_.Address(), FUTEX_WAKE, -1, nullptr, nullptr, 0);
+    }
+    return false;  // Timed out.
+  }
 #else
   timespec ts;
   InitTimeSpec(true, CLOCK_REALTIME, ms, ns, &ts);
@@ -775,11 +806,86 @@ void ReaderWriterMutex::HandleSharedLockContention(Thread* self, int32_t cur_sta
   }
   --num_pending_readers_;
 }
+
+void ReaderWriterMutex::HandleStripedSharedLockContention(Thread* self, AtomicInteger* stripe) {
+  // A writer holds the lock, or is about to if no reader entered meanwhile. Back off so it can
+  // tell, and wait for the state to change.
+  ReleaseReaderStripe(stripe);
+  HandleSharedLockContention(self, -1);
+}
+
+void ReaderWriterMutex::WakeupWriterWaitingForReaders() {
+  ++reader_stripes_sequence_;
+  futex(reader_stripes_sequence_.Address(), FUTEX_WAKE, -1, nullptr, nullptr, 0);
+}
+
+int32_t ReaderWriterMutex::NumStripedReaders() const {
+  int32_t num_readers = 0;
+  for (size_t i = 0; i != kNumReaderStripes; ++i) {
+    num_readers += reader_stripes_[i].count.LoadSequentiallyConsistent();
+  }
+  return num_readers;
+}
+
+bool ReaderWriterMutex::WaitForStripedReaders(Thread* self, const timespec* end_abs_ts) {
+  DCHECK_EQ(state_.LoadRelaxed(), kStripedWriterWaiting);
+  while (true) {
+    // Read the sequence before the stripes, so that a reader leaving after the sum changes it.
+    int32_t cur_sequence = reader_stripes_sequence_.LoadSequentiallyConsistent();
+    if (NumStripedReaders() == 0) {
+      // Stop new readers, then check that none entered before they could see it.
+      state_.StoreSequentiallyConsistent(-1);
+      if (LIKELY(NumStripedReaders() == 0)) {
+        return true;
+      }
+      // Let the readers in, including those that saw -1 and wait for the state to change.
+      state_.StoreSequentiallyConsistent(kStripedWriterWaiting);
+      if (num_pending_readers_.LoadRelaxed() > 0) {
+        futex(state_.Address(), FUTEX_WAKE, -1, nullptr, nullptr, 0);
+      }
+      continue;
+    }
+    timespec rel_ts;
+    timespec* timeout = nullptr;
+    if (end_abs_ts != nullptr) {
+      timespec now_abs_ts;
+      InitTimeSpec(true, CLOCK_MONOTONIC, 0, 0, &now_abs_ts);
+      if (ComputeRelativeTimeSpec(&rel_ts, *end_abs_ts, now_abs_ts)) {
+        return false;  // Timed out.
+      }
+      timeout = &rel_ts;
+    }
+    ScopedContentionRecorder scr(this, SafeGetTid(self), -1);
+    ++num_pending_writers_;
+    if (UNLIKELY(should_respond_to_empty_checkpoint_request_)) {
+      self->CheckEmptyCheckpointFromMutex();
+    }
+    if (futex(reader_stripes_sequence_.Address(), FUTEX_WAIT, cur_sequence, timeout, nullptr, 0)
+        != 0) {
+      // Timeouts are handled at the top of the loop.
+      if ((errno != EAGAIN) && (errno != EINTR) && (errno != ETIMEDOUT)) {
+        PLOG(FATAL) << "futex wait failed for " << name_;
+      }
+    }
+    --num_pending_writers_;
+  }
+}
 #endif
 
 bool ReaderWriterMutex::SharedTryLock(Thread* self) {
   DCHECK(self == nullptr || self == Thread::Current());
 #if ART_USE_FUTEXES
+  if (reader_stripes_ != nullptr) {
+    AtomicInteger* stripe = GetReaderStripe(self);
+    stripe->FetchAndAddSequentiallyConsistent(1);
+    if (state_.LoadSequentiallyConsistent() == -1) {
+      ReleaseReaderStripe(stripe);
+      return false;
+    }
+    RegisterAsLocked(self);
+    AssertSharedHeld(self);
+    return true;
+  }
   bool done = false;
   do {
     int32_t cur_state = state_.LoadRelaxed();
@@ -827,6 +933,11 @@ void ReaderWriterMutex::Dump(std::ostream& os) const {
       << " num_pending_readers=" << num_pending_readers_.LoadSequentiallyConsistent()
 #endif
       << " ";
+#if ART_USE_FUTEXES
+  if (reader_stripes_ != nullptr) {
+    os << "striped_readers=" << NumStripedReaders() << " ";
+  }
+#endif
   DumpContention(os);
 }
 
@@ -847,6 +958,10 @@ void ReaderWriterMutex::WakeupToRespondToEmptyCheckpoint() {
   if (UNLIKELY(num_pending_readers_.LoadRelaxed() > 0 ||
                num_pending_writers_.LoadRelaxed() > 0)) {
     futex(state_.Address(), FUTEX_WAKE, -1, nullptr, nullptr, 0);
+    if (reader_stripes_ != nullptr) {
+      // A writer may be waiting for the stripes to drain instead.
+      WakeupWriterWaitingForReaders();
+    }
   }
 #else
   LOG(FATAL) << "Non futex case isn't supported.";
@@ -1096,7 +1211,9 @@ void Locks::Init() {
 
     UPDATE_CURRENT_LOCK_LEVEL(kMutatorLock);
     DCHECK(mutator_lock_ == nullptr);
-    mutator_lock_ = new MutatorMutex("mutator lock", current_lock_level);
+    mutator_lock_ = new MutatorMutex("mutator lock",
+                                     current_lock_level,
+                                     /* scalable_readers */ true);
 
     UPDATE_CURRENT_LOCK_LEVEL(kHeapBitmapLock);
     DCHECK(heap_bitmap_lock_ == nullptr);
@@ -1145,7 +1262,8 @@ void Locks::Init() {
     UPDATE_CURRENT_LOCK_LEVEL(kClassLinkerClassesLock);
     DCHECK(classlinker_classes_lock_ == nullptr);
     classlinker_classes_lock_ = new ReaderWriterMutex("ClassLinker classes lock",
-                                                      current_lock_level);
+                                                      current_lock_level,
+                                                      /* scalable_readers */ true);
 
     UPDATE_CURRENT_LOCK_LEVEL(kMonitorPoolLock);
     DCHECK(allocated_monitor_ids_lock_ == nullptr);
@@ -87,6 +87,7 @@ enum LockLevel {
   kAllocSpaceLock,
   kBumpPointerSpaceBlockLock,
   kArenaPoolLock,
+  kInternTableShardLock,
   kInternTableLock,
   kOatFileSecondaryLookupLock,
   kHostDlOpenHandlesLock,
@@ -329,10 +330,19 @@ class LOCKABLE Mutex : public BaseMutex {
 // Exclusive | Block         | Free            | Block            | error
 // Shared(n) | Block         | error           | SharedLock(n+1)* | Shared(n-1) or Free
 // * for large values of n the SharedLock may block.
+//
+// With scalable_readers, readers don't count themselves in the single state word but in one of
+// several cache line sized stripes picked by thread id, so that readers on different cores don't
+// bounce a cache line between them. The state word is then only used by writers, which claim it
+// and wait for the stripes to drain. As with the single state word, readers keep entering while
+// a writer waits. A reader that finds the lock held exclusive takes its count back and waits for
+// the writer. The exclusive operations are slower, so this is for locks that are mostly shared.
 std::ostream& operator<<(std::ostream& os, const ReaderWriterMutex& mu);
 class SHARED_LOCKABLE ReaderWriterMutex : public BaseMutex {
  public:
-  explicit ReaderWriterMutex(const char* name, LockLevel level = kDefaultMutexLevel);
+  explicit ReaderWriterMutex(const char* name,
+                             LockLevel level = kDefaultMutexLevel,
+                             bool scalable_readers = false);
   ~ReaderWriterMutex();
 
   virtual bool IsReaderWriterMutex() const { return true; }
@@ -419,7 +429,35 @@ class SHARED_LOCKABLE ReaderWriterMutex : public BaseMutex {
   // Out-of-inline path for handling contention for a SharedLock.
   void HandleSharedLockContention(Thread* self, int32_t cur_state);
 
-  // -1 implies held exclusive, +ve shared held by state_ many owners.
+  static constexpr size_t kNumReaderStripes = 32;
+  static constexpr size_t kReaderStripeSize = 64;  // At least a cache line.
+
+  struct ReaderStripe {
+    AtomicInteger count;
+    uint8_t padding[kReaderStripeSize - sizeof(AtomicInteger)];
+  };
+
+  AtomicInteger* GetReaderStripe(const Thread* self) const ALWAYS_INLINE;
+
+  // Drop the reader count of self from its stripe, waking a writer waiting for the stripes to
+  // drain.
+  void ReleaseReaderStripe(AtomicInteger* stripe) ALWAYS_INLINE;
+  void WakeupWriterWaitingForReaders();
+
+  // Out-of-inline path for a reader that found the lock claimed by a writer.
+  void HandleStripedSharedLockContention(Thread* self, AtomicInteger* stripe);
+
+  // Called by a writer that claimed state_, wait until the stripes have no readers and move
+  // state_ from kStripedWriterWaiting to -1. Returns false if the absolute CLOCK_MONOTONIC time
+  // end_abs_ts, if not null, passed first.
+  bool WaitForStripedReaders(Thread* self, const timespec* end_abs_ts);
+  int32_t NumStripedReaders() const;
+
+  // State of a lock with reader_stripes_ claimed by a writer that waits for the readers to leave.
+  static constexpr int32_t kStripedWriterWaiting = -2;
+
+  // -1 implies held exclusive, +ve shared held by state_ many owners. With reader_stripes_, never
+  // positive, readers are counted in the stripes.
   AtomicInteger state_;
   // Exclusive owner. Modification guarded by this mutex.
   Atomic<pid_t> exclusive_owner_;
@@ -427,6 +465,10 @@ class SHARED_LOCKABLE ReaderWriterMutex : public BaseMutex {
   AtomicInteger num_pending_readers_;
   // Number of contenders waiting to be the writer.
   AtomicInteger num_pending_writers_;
+  // Reader counts for scalable_readers, null otherwise.
+  ReaderStripe* const reader_stripes_;
+  // Bumped by readers leaving while a writer waits for the stripes to drain, the writer's futex.
+  AtomicInteger reader_stripes_sequence_;
 #else
   pthread_rwlock_t rwlock_;
   Atomic<pid_t> exclusive_owner_;  // Writes guarded by rwlock_. Asynchronous reads are OK.
@@ -450,8 +492,10 @@ class SHARED_LOCKABLE ReaderWriterMutex : public BaseMutex {
 std::ostream& operator<<(std::ostream& os, const MutatorMutex& mu);
 class SHARED_LOCKABLE MutatorMutex : public ReaderWriterMutex {
  public:
-  explicit MutatorMutex(const char* name, LockLevel level = kDefaultMutexLevel)
-    : ReaderWriterMutex(name, level) {}
+  explicit MutatorMutex(const char* name,
+                        LockLevel level = kDefaultMutexLevel,
+                        bool scalable_readers = false)
+    : ReaderWriterMutex(name, level, scalable_readers) {}
   ~MutatorMutex() {}
 
   virtual bool IsMutatorMutex() const { return true; }
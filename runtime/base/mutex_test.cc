@@ -171,4 +171,34 @@ TEST_F(MutexTest, SharedTryLockUnlock) {
   SharedTryLockUnlockTest();
 }
 
+// GCC has trouble with our mutex tests, so we have to turn off thread safety analysis.
+static void ScalableReadersTest() NO_THREAD_SAFETY_ANALYSIS {
+  Thread* self = Thread::Current();
+  ReaderWriterMutex mu("test rwmutex", kDefaultMutexLevel, /* scalable_readers */ true);
+  mu.SharedLock(self);
+  mu.AssertSharedHeld(self);
+  mu.AssertNotExclusiveHeld(self);
+#if HAVE_TIMED_RWLOCK
+  // The writer waits for the reader to leave and gives up.
+  ASSERT_FALSE(mu.ExclusiveLockWithTimeout(self, 10, 0));
+#endif
+  mu.SharedUnlock(self);
+  mu.AssertNotHeld(self);
+
+  mu.ExclusiveLock(self);
+  mu.AssertExclusiveHeld(self);
+  ASSERT_FALSE(mu.SharedTryLock(self));
+  mu.ExclusiveUnlock(self);
+  mu.AssertNotHeld(self);
+
+  ASSERT_TRUE(mu.SharedTryLock(self));
+  mu.AssertSharedHeld(self);
+  mu.SharedUnlock(self);
+  mu.AssertNotHeld(self);
+}
+
+TEST_F(MutexTest, ScalableReaders) {
+  ScalableReadersTest();
+}
+
 }  // namespace art
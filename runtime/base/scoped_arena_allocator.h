@@ -61,6 +61,11 @@ class ArenaStack : private DebugStackRefCounter, private ArenaAllocatorMemoryToo
 
   MemStats GetPeakStats() const;
 
+  // Total size of the arenas the stack holds. It only grows until Reset(), so it is the
+  // high-water mark of the memory the stack took from the pool. Unlike PeakBytesAllocated(),
+  // it does not depend on kArenaAllocatorCountAllocations.
+  size_t BytesReserved() const;
+
   // Return the arena tag associated with a pointer.
   static ArenaFreeTag& ArenaTagForAllocation(void* ptr) {
     DCHECK(kIsDebugBuild) << "Only debug builds have tags";
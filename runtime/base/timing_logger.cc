@@ -237,6 +237,20 @@ void TimingLogger::Dump(std::ostream &os, const char* indent_string) const {
   os << name_ << ": end, " << PrettyDuration(GetTotalNs()) << "\n";
 }
 
+void TimingLogger::DumpMachineReadable(std::ostream& os) const {
+  TimingLogger::TimingData timing_data(CalculateTimingData());
+  size_t depth = 0;
+  for (size_t i = 0; i < timings_.size(); ++i) {
+    if (timings_[i].IsStartTiming()) {
+      os << "phase " << depth << " " << timing_data.GetExclusiveTime(i) << " "
+         << timing_data.GetTotalTime(i) << " " << timings_[i].GetName() << "\n";
+      ++depth;
+    } else {
+      --depth;
+    }
+  }
+}
+
 void TimingLogger::Verify() {
   size_t counts[2] = { 0 };
   for (size_t i = 0; i < timings_.size(); ++i) {
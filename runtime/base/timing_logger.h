@@ -169,6 +169,8 @@ class TimingLogger {
   // Find the index of a timing by name.
   size_t FindTimingIndex(const char* name, size_t start_idx) const;
   void Dump(std::ostream& os, const char* indent_string = "  ") const;
+  // Dump one line per timing, "phase <depth> <exclusive ns> <total ns> <name>", for tools.
+  void DumpMachineReadable(std::ostream& os) const;
 
   // Scoped timing splits that can be nested and composed with the explicit split
   // starts and ends.
@@ -16,6 +16,8 @@
 
 #include "timing_logger.h"
 
+#include <sstream>
+
 #include "common_runtime_test.h"
 
 namespace art {
@@ -158,6 +160,23 @@ TEST_F(TimingLoggerTest, ScopedAndExplicit) {
   EXPECT_LE(timings[idx_innerinnersplit1].GetTime(), timings[idx_innerinnersplit2].GetTime());
 }
 
+TEST_F(TimingLoggerTest, DumpMachineReadable) {
+  TimingLogger logger("MachineReadable", true, false);
+  logger.StartTiming("Outer split");
+  logger.StartTiming("Inner split");
+  logger.EndTiming();
+  logger.EndTiming();
+  TimingLogger::TimingData timing_data(logger.CalculateTimingData());
+  std::ostringstream expected;
+  expected << "phase 0 " << timing_data.GetExclusiveTime(0) << " " << timing_data.GetTotalTime(0)
+           << " Outer split\n"
+           << "phase 1 " << timing_data.GetExclusiveTime(1) << " " << timing_data.GetTotalTime(1)
+           << " Inner split\n";
+  std::ostringstream oss;
+  logger.DumpMachineReadable(oss);
+  EXPECT_EQ(expected.str(), oss.str());
+}
+
 TEST_F(TimingLoggerTest, ThreadCpuAndMonotonic) {
   TimingLogger mon_logger("Scoped", true, false, TimingLogger::TimingKind::kMonotonic);
   TimingLogger cpu_logger("Scoped", true, false, TimingLogger::TimingKind::kThreadCpu);
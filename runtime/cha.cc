@@ -16,6 +16,7 @@
 
 #include "cha.h"
 
+#include "art_field-inl.h"
 #include "art_method-inl.h"
 #include "base/logging.h"  // For VLOG
 #include "jit/jit.h"
@@ -54,30 +55,75 @@ void ClassHierarchyAnalysis::RemoveAllDependenciesFor(ArtMethod* method) {
   cha_dependency_map_.erase(method);
 }
 
-void ClassHierarchyAnalysis::RemoveDependentsWithMethodHeaders(
+void ClassHierarchyAnalysis::AddFinalFieldDependency(ArtField* field,
+                                                     ArtMethod* dependent_method,
+                                                     OatQuickMethodHeader* dependent_header) {
+  final_field_dependency_map_[field].push_back({dependent_method, dependent_header});
+}
+
+bool ClassHierarchyAnalysis::IsFinalFieldModified(ArtField* field) {
+  MutexLock mu(Thread::Current(), *Locks::cha_lock_);
+  return IsFinalFieldModifiedLocked(field);
+}
+
+bool ClassHierarchyAnalysis::IsFinalFieldModifiedLocked(ArtField* field) {
+  return modified_final_fields_.find(field) != modified_final_fields_.end();
+}
+
+void ClassHierarchyAnalysis::InvalidateFinalFieldDependents(ArtField* field) {
+  Runtime* const runtime = Runtime::Current();
+  MutexLock mu(Thread::Current(), *Locks::cha_lock_);
+  if (!modified_final_fields_.insert(field).second) {
+    // The dependents have been invalidated already, and no code depends on the field
+    // since then.
+    return;
+  }
+  auto it = final_field_dependency_map_.find(field);
+  if (it == final_field_dependency_map_.end()) {
+    return;
+  }
+  for (const MethodAndMethodHeaderPair& dependent : it->second) {
+    VLOG(class_linker) << "Invalidated compiled code for " << dependent.first->PrettyMethod()
+                       << " which folded " << field->PrettyField();
+    DCHECK(runtime->UseJitCompilation());
+    runtime->GetJit()->GetCodeCache()->InvalidateCompiledCodeFor(dependent.first,
+                                                                 dependent.second);
+  }
+  final_field_dependency_map_.erase(it);
+}
+
+template <typename Key>
+static void RemoveDependentsWithMethodHeadersFrom(
+    std::unordered_map<Key, ClassHierarchyAnalysis::ListOfDependentPairs>* dependency_map,
     const std::unordered_set<OatQuickMethodHeader*>& method_headers) {
   // Iterate through all entries in the dependency map and remove any entry that
   // contains one of those in method_headers.
-  for (auto map_it = cha_dependency_map_.begin(); map_it != cha_dependency_map_.end(); ) {
-    ListOfDependentPairs& dependents = map_it->second;
+  for (auto map_it = dependency_map->begin(); map_it != dependency_map->end(); ) {
+    ClassHierarchyAnalysis::ListOfDependentPairs& dependents = map_it->second;
     dependents.erase(
         std::remove_if(
             dependents.begin(),
             dependents.end(),
-            [&method_headers](MethodAndMethodHeaderPair& dependent) {
+            [&method_headers](ClassHierarchyAnalysis::MethodAndMethodHeaderPair& dependent) {
               return method_headers.find(dependent.second) != method_headers.end();
             }),
         dependents.end());
 
     // Remove the map entry if there are no more dependents.
     if (dependents.empty()) {
-      map_it = cha_dependency_map_.erase(map_it);
+      map_it = dependency_map->erase(map_it);
     } else {
       map_it++;
     }
   }
 }
 
+void ClassHierarchyAnalysis::RemoveDependentsWithMethodHeaders(
+    const std::unordered_set<OatQuickMethodHeader*>& method_headers) {
+  RemoveDependentsWithMethodHeadersFrom(&cha_dependency_map_, method_headers);
+  RemoveDependentsWithMethodHeadersFrom(&final_field_dependency_map_, method_headers);
+}
+
 void ClassHierarchyAnalysis::ResetSingleImplementationInHierarchy(ObjPtr<mirror::Class> klass,
                                                                   const LinearAlloc* alloc,
                                                                   const PointerSize pointer_size)
@@ -695,6 +741,21 @@ void ClassHierarchyAnalysis::RemoveDependenciesForLinearAlloc(const LinearAlloc*
       ++it;
     }
   }
+  // The fields of the classes are in the allocator too.
+  for (auto it = final_field_dependency_map_.begin(); it != final_field_dependency_map_.end(); ) {
+    if (linear_alloc->ContainsUnsafe(it->first)) {
+      it = final_field_dependency_map_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = modified_final_fields_.begin(); it != modified_final_fields_.end(); ) {
+    if (linear_alloc->ContainsUnsafe(*it)) {
+      it = modified_final_fields_.erase(it);
+    } else {
+      ++it;
+    }
+  }
 }
 
 }  // namespace art
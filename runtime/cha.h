@@ -28,6 +28,7 @@
 
 namespace art {
 
+class ArtField;
 class ArtMethod;
 class LinearAlloc;
 
@@ -103,6 +104,25 @@ class ClassHierarchyAnalysis {
   // `method` has single-implementation.
   void RemoveAllDependenciesFor(ArtMethod* method) REQUIRES(Locks::cha_lock_);
 
+  // Add a dependency that compiled code with `dependent_header` for `dependent_method`
+  // folded the value of the static final `field` of an initialized class.
+  void AddFinalFieldDependency(ArtField* field,
+                               ArtMethod* dependent_method,
+                               OatQuickMethodHeader* dependent_header)
+      REQUIRES(Locks::cha_lock_);
+
+  // Return whether the static final `field` has been changed after its class was
+  // initialized, in which case its value must not be folded anymore.
+  bool IsFinalFieldModified(ArtField* field) REQUIRES(!Locks::cha_lock_);
+  bool IsFinalFieldModifiedLocked(ArtField* field) REQUIRES(Locks::cha_lock_);
+
+  // Called when the static final `field` of an initialized class is changed, which
+  // only JNI allows. Compiled code that folded the old value is invalidated, so that
+  // new invocations see the new value. Frames already executing that code are not
+  // deoptimized, as nothing in the code checks for it.
+  void InvalidateFinalFieldDependents(ArtField* field)
+      REQUIRES(!Locks::cha_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Remove from cha_dependency_map_ all entries that contain OatQuickMethodHeader from
   // the given `method_headers` set.
   // This is used when some compiled code is freed.
@@ -171,6 +191,13 @@ class ClassHierarchyAnalysis {
   std::unordered_map<ArtMethod*, ListOfDependentPairs> cha_dependency_map_
     GUARDED_BY(Locks::cha_lock_);
 
+  // A map that maps a static final field to the compiled code that folded its value.
+  std::unordered_map<ArtField*, ListOfDependentPairs> final_field_dependency_map_
+    GUARDED_BY(Locks::cha_lock_);
+
+  // Static final fields that have been changed after their class was initialized.
+  std::unordered_set<ArtField*> modified_final_fields_ GUARDED_BY(Locks::cha_lock_);
+
   DISALLOW_COPY_AND_ASSIGN(ClassHierarchyAnalysis);
 };
 
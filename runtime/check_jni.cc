@@ -313,7 +313,11 @@ bool CheckAttachedThread(const char* function_name) {
 class ScopedCheck {
  public:
   ScopedCheck(uint16_t flags, const char* functionName, bool has_method = true)
-      : function_name_(functionName), indent_(0), flags_(flags), has_method_(has_method) {
+      : function_name_(functionName),
+        indent_(0),
+        flags_(flags),
+        has_method_(has_method),
+        lite_(Runtime::Current()->GetJavaVM()->IsCheckJniLite()) {
   }
 
   ~ScopedCheck() {}
@@ -344,7 +348,7 @@ class ScopedCheck {
       AbortF("field operation on NULL object: %p", java_object);
       return false;
     }
-    if (!Runtime::Current()->GetHeap()->IsValidObjectAddress(o.Ptr())) {
+    if (!IsValidObjectAddress(o.Ptr())) {
       Runtime::Current()->GetHeap()->DumpSpaces(LOG_STREAM(ERROR));
       AbortF("field operation on invalid %s: %p",
              GetIndirectRefKindString(IndirectReferenceTable::GetIndirectRefKind(java_object)),
@@ -356,8 +360,11 @@ class ScopedCheck {
     if (f == nullptr) {
       return false;
     }
+    // In lite mode, check the object's class against the field's declaring class instead
+    // of searching its fields by name.
     mirror::Class* c = o->GetClass();
-    if (c->FindInstanceField(f->GetName(), f->GetTypeDescriptor()) == nullptr) {
+    if (lite_ ? !o->InstanceOf(f->GetDeclaringClass())
+              : c->FindInstanceField(f->GetName(), f->GetTypeDescriptor()) == nullptr) {
       AbortF("jfieldID %s not valid for an object of class %s",
              f->PrettyField().c_str(), o->PrettyTypeOf().c_str());
       return false;
@@ -858,7 +865,7 @@ class ScopedCheck {
       }
     }
 
-    if (!Runtime::Current()->GetHeap()->IsValidObjectAddress(obj.Ptr())) {
+    if (!IsValidObjectAddress(obj.Ptr())) {
       Runtime::Current()->GetHeap()->DumpSpaces(LOG_STREAM(ERROR));
       AbortF("%s is an invalid %s: %p (%p)",
              what,
@@ -1020,7 +1027,7 @@ class ScopedCheck {
         ObjPtr<mirror::Class> c = soa.Decode<mirror::Class>(jc);
         if (c == nullptr) {
           *msg += "NULL";
-        } else if (!Runtime::Current()->GetHeap()->IsValidObjectAddress(c.Ptr())) {
+        } else if (!IsValidObjectAddress(c.Ptr())) {
           StringAppendF(msg, "INVALID POINTER:%p", jc);
         } else if (!c->IsClass()) {
           *msg += "INVALID NON-CLASS OBJECT OF TYPE:" + c->PrettyTypeOf();
@@ -1189,7 +1196,7 @@ class ScopedCheck {
     }
 
     ObjPtr<mirror::Array> a = soa.Decode<mirror::Array>(java_array);
-    if (UNLIKELY(!Runtime::Current()->GetHeap()->IsValidObjectAddress(a.Ptr()))) {
+    if (UNLIKELY(!IsValidObjectAddress(a.Ptr()))) {
       Runtime::Current()->GetHeap()->DumpSpaces(LOG_STREAM(ERROR));
       AbortF("jarray is an invalid %s: %p (%p)",
              GetIndirectRefKindString(IndirectReferenceTable::GetIndirectRefKind(java_array)),
@@ -1266,7 +1273,7 @@ class ScopedCheck {
     }
     ArtField* f = jni::DecodeArtField(fid);
     // TODO: Better check here.
-    if (!Runtime::Current()->GetHeap()->IsValidObjectAddress(f->GetDeclaringClass().Ptr())) {
+    if (!IsValidObjectAddress(f->GetDeclaringClass().Ptr())) {
       Runtime::Current()->GetHeap()->DumpSpaces(LOG_STREAM(ERROR));
       AbortF("invalid jfieldID: %p", fid);
       return nullptr;
@@ -1281,7 +1288,7 @@ class ScopedCheck {
     }
     ArtMethod* m = jni::DecodeArtMethod(mid);
     // TODO: Better check here.
-    if (!Runtime::Current()->GetHeap()->IsValidObjectAddress(m->GetDeclaringClass())) {
+    if (!IsValidObjectAddress(m->GetDeclaringClass())) {
       Runtime::Current()->GetHeap()->DumpSpaces(LOG_STREAM(ERROR));
       AbortF("invalid jmethodID: %p", mid);
       return nullptr;
@@ -1460,6 +1467,12 @@ class ScopedCheck {
     return 0;
   }
 
+  // Lite mode trusts references that decoded successfully instead of searching for the heap
+  // space holding them, which takes time linear in the number of spaces.
+  bool IsValidObjectAddress(const void* addr) const {
+    return lite_ || Runtime::Current()->GetHeap()->IsValidObjectAddress(addr);
+  }
+
   void AbortF(const char* fmt, ...) __attribute__((__format__(__printf__, 2, 3))) {
     va_list args;
     va_start(args, fmt);
@@ -1476,6 +1489,9 @@ class ScopedCheck {
 
   const bool has_method_;
 
+  // Whether to skip checks that do not take constant time, see -Xjniopts:lite.
+  const bool lite_;
+
   DISALLOW_COPY_AND_ASSIGN(ScopedCheck);
 };
 
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "class_descriptor_filter.h"
+
+#include <algorithm>
+
+#include "dex/dex_file-inl.h"
+#include "dex/utf.h"
+
+namespace art {
+
+ClassDescriptorFilter::ClassDescriptorFilter(const std::vector<const DexFile*>& dex_files)
+    : num_dex_files_(dex_files.size()) {
+  size_t num_classes = 0u;
+  for (const DexFile* dex_file : dex_files) {
+    num_classes += dex_file->NumClassDefs();
+  }
+  const size_t num_bits =
+      RoundUpToPowerOfTwo(std::max(num_classes * kMinBitsPerClass, kBitsPerWord));
+  bits_.resize(num_bits / kBitsPerWord, 0u);
+  bit_mask_ = num_bits - 1u;
+  for (const DexFile* dex_file : dex_files) {
+    for (uint32_t i = 0; i != dex_file->NumClassDefs(); ++i) {
+      const char* descriptor = dex_file->GetClassDescriptor(dex_file->GetClassDef(i));
+      Add(ComputeModifiedUtf8Hash(descriptor));
+    }
+  }
+}
+
+}  // namespace art
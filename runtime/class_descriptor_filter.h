@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_CLASS_DESCRIPTOR_FILTER_H_
+#define ART_RUNTIME_CLASS_DESCRIPTOR_FILTER_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "base/bit_utils.h"
+#include "base/macros.h"
+
+namespace art {
+
+class DexFile;
+
+// Bloom filter over the descriptor hashes (see ComputeModifiedUtf8Hash()) of the classes defined
+// by a set of dex files. A class that the filter does not contain is not defined by any of the
+// dex files, which lets class lookups that miss skip probing each dex file's class defs.
+//
+// The filter is immutable once built, and can be read concurrently without locking.
+class ClassDescriptorFilter {
+ public:
+  // Build a filter for the classes of `dex_files`.
+  explicit ClassDescriptorFilter(const std::vector<const DexFile*>& dex_files);
+
+  // Return false if no class with the given descriptor hash was added to the filter.
+  bool MayContain(uint32_t descriptor_hash) const {
+    uint32_t h1 = descriptor_hash * kMultiplier1;
+    const uint32_t h2 = (descriptor_hash * kMultiplier2) | 1u;
+    for (size_t i = 0; i != kNumHashes; ++i, h1 += h2) {
+      const size_t bit = h1 & bit_mask_;
+      if ((bits_[bit / kBitsPerWord] & (UINT64_C(1) << (bit % kBitsPerWord))) == 0u) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Number of dex files the filter was built from.
+  size_t NumDexFiles() const {
+    return num_dex_files_;
+  }
+
+ private:
+  static constexpr size_t kBitsPerWord = BitSizeOf<uint64_t>();
+  // With at least 16 bits per class and 4 hashes, about 0.25% of misses are false positives.
+  static constexpr size_t kMinBitsPerClass = 16u;
+  static constexpr size_t kNumHashes = 4u;
+  // Mix the bits of the descriptor hash, whose low bits are weak for similar descriptors.
+  static constexpr uint32_t kMultiplier1 = 0x9e3779b1u;
+  static constexpr uint32_t kMultiplier2 = 0x85ebca6bu;
+
+  void Add(uint32_t descriptor_hash) {
+    uint32_t h1 = descriptor_hash * kMultiplier1;
+    const uint32_t h2 = (descriptor_hash * kMultiplier2) | 1u;
+    for (size_t i = 0; i != kNumHashes; ++i, h1 += h2) {
+      const size_t bit = h1 & bit_mask_;
+      bits_[bit / kBitsPerWord] |= UINT64_C(1) << (bit % kBitsPerWord);
+    }
+  }
+
+  std::vector<uint64_t> bits_;
+  size_t bit_mask_;
+  const size_t num_dex_files_;
+
+  DISALLOW_COPY_AND_ASSIGN(ClassDescriptorFilter);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_CLASS_DESCRIPTOR_FILTER_H_
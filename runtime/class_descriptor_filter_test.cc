@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "class_descriptor_filter.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common_runtime_test.h"
+#include "dex/dex_file-inl.h"
+#include "dex/utf.h"
+
+namespace art {
+
+class ClassDescriptorFilterTest : public CommonRuntimeTest {};
+
+TEST_F(ClassDescriptorFilterTest, MayContain) {
+  std::vector<std::unique_ptr<const DexFile>> dex_files = OpenTestDexFiles("MultiDex");
+  ASSERT_GT(dex_files.size(), 1u);
+  std::vector<const DexFile*> class_path;
+  for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
+    class_path.push_back(dex_file.get());
+  }
+  ClassDescriptorFilter filter(class_path);
+  EXPECT_EQ(class_path.size(), filter.NumDexFiles());
+
+  // All the classes of the dex files are in the filter.
+  for (const DexFile* dex_file : class_path) {
+    for (uint32_t i = 0; i != dex_file->NumClassDefs(); ++i) {
+      const char* descriptor = dex_file->GetClassDescriptor(dex_file->GetClassDef(i));
+      EXPECT_TRUE(filter.MayContain(ComputeModifiedUtf8Hash(descriptor))) << descriptor;
+    }
+  }
+
+  // Few other classes are.
+  size_t false_positives = 0u;
+  for (size_t i = 0; i != 1000u; ++i) {
+    std::string descriptor = "LDoesNotExist" + std::to_string(i) + ";";
+    if (filter.MayContain(ComputeModifiedUtf8Hash(descriptor.c_str()))) {
+      ++false_positives;
+    }
+  }
+  EXPECT_LT(false_positives, 20u);
+}
+
+}  // namespace art
@@ -49,6 +49,7 @@
 #include "base/utils.h"
 #include "base/value_object.h"
 #include "cha.h"
+#include "class_descriptor_filter.h"
 #include "class_linker-inl.h"
 #include "class_loader_utils.h"
 #include "class_table-inl.h"
@@ -118,6 +119,7 @@
 #include "object_lock.h"
 #include "runtime.h"
 #include "runtime_callbacks.h"
+#include "runtime_metrics.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-inl.h"
 #include "thread_list.h"
@@ -370,6 +372,14 @@ static void ShuffleForward(size_t* current_field_idx,
 ClassLinker::ClassLinker(InternTable* intern_table)
     : boot_class_table_(new ClassTable()),
       failed_dex_cache_class_lookups_(0),
+      boot_class_path_filter_(nullptr),
+      dex_cache_type_misses_(0u),
+      dex_cache_type_conflicts_(0u),
+      dex_cache_field_misses_(0u),
+      dex_cache_field_conflicts_(0u),
+      imt_conflict_tables_(0u),
+      imt_conflict_table_entries_(0u),
+      imt_conflict_table_additions_(0u),
       class_roots_(nullptr),
       array_iftable_(nullptr),
       find_array_class_cache_next_victim_(0),
@@ -2187,6 +2197,7 @@ ClassLinker::~ClassLinker() {
     DeleteClassLoader(self, data, false /*cleanup_cha*/);
   }
   class_loaders_.clear();
+  delete boot_class_path_filter_.LoadRelaxed();
 }
 
 void ClassLinker::DeleteClassLoader(Thread* self, const ClassLoaderData& data, bool cleanup_cha) {
@@ -2254,7 +2265,8 @@ mirror::DexCache* ClassLinker::AllocAndInitializeDexCache(Thread* self,
                                          location,
                                          &dex_file,
                                          linear_alloc,
-                                         image_pointer_size_);
+                                         image_pointer_size_,
+                                         /* large_caches */ false);
   }
   return dex_cache.Ptr();
 }
@@ -2366,9 +2378,19 @@ mirror::Class* ClassLinker::EnsureResolved(Thread* self,
 typedef std::pair<const DexFile*, const DexFile::ClassDef*> ClassPathEntry;
 
 // Search a collection of DexFiles for a descriptor
+// Search the class path for the class def of `descriptor`. The dex files covered by `filter`, a
+// prefix of the class path, are skipped if the filter does not contain the descriptor.
 ClassPathEntry FindInClassPath(const char* descriptor,
-                               size_t hash, const std::vector<const DexFile*>& class_path) {
-  for (const DexFile* dex_file : class_path) {
+                               size_t hash,
+                               const std::vector<const DexFile*>& class_path,
+                               const ClassDescriptorFilter* filter) {
+  size_t i = 0u;
+  if (filter != nullptr && !filter->MayContain(hash)) {
+    DCHECK_LE(filter->NumDexFiles(), class_path.size());
+    i = filter->NumDexFiles();
+  }
+  for (; i < class_path.size(); ++i) {
+    const DexFile* dex_file = class_path[i];
     const DexFile::ClassDef* dex_class_def = OatDexFile::FindClassDef(*dex_file, descriptor, hash);
     if (dex_class_def != nullptr) {
       return ClassPathEntry(dex_file, dex_class_def);
@@ -2377,6 +2399,24 @@ ClassPathEntry FindInClassPath(const char* descriptor,
   return ClassPathEntry(nullptr, nullptr);
 }
 
+const ClassDescriptorFilter* ClassLinker::GetBootClassPathFilter() {
+  const ClassDescriptorFilter* filter = boot_class_path_filter_.LoadAcquire();
+  if (UNLIKELY(filter == nullptr) && init_done_) {
+    // Wait for the initial boot class path to be set up so that the filter covers all of it.
+    // Most lookups that miss the boot class path come from class loaders delegating to their
+    // parent first, so build the filter for the first of them.
+    std::unique_ptr<const ClassDescriptorFilter> new_filter(
+        new ClassDescriptorFilter(boot_class_path_));
+    if (boot_class_path_filter_.CompareAndSetStrongRelease(nullptr, new_filter.get())) {
+      filter = new_filter.release();
+    } else {
+      // Another thread was faster, use its filter.
+      filter = boot_class_path_filter_.LoadAcquire();
+    }
+  }
+  return filter;
+}
+
 bool ClassLinker::FindClassInBaseDexClassLoader(ScopedObjectAccessAlreadyRunnable& soa,
                                                 Thread* self,
                                                 const char* descriptor,
@@ -2441,7 +2481,8 @@ ObjPtr<mirror::Class> ClassLinker::FindClassInBootClassLoaderClassPath(Thread* s
                                                                        const char* descriptor,
                                                                        size_t hash) {
   ObjPtr<mirror::Class> result = nullptr;
-  ClassPathEntry pair = FindInClassPath(descriptor, hash, boot_class_path_);
+  ClassPathEntry pair =
+      FindInClassPath(descriptor, hash, boot_class_path_, GetBootClassPathFilter());
   if (pair.second != nullptr) {
     ObjPtr<mirror::Class> klass = LookupClass(self, descriptor, hash, nullptr);
     if (klass != nullptr) {
@@ -2470,8 +2511,67 @@ ObjPtr<mirror::Class> ClassLinker::FindClassInBaseDexClassLoaderClassPath(
   DCHECK(IsPathOrDexClassLoader(soa, class_loader) || IsDelegateLastClassLoader(soa, class_loader))
       << "Unexpected class loader for descriptor " << descriptor;
 
+  // Dex files opened without an oat file may still be verified in the background, wait for them
+  // before reading their classes. Those that failed verification are skipped.
+  std::vector<const DexFile*> unverified_dex_files;
+  OatFileManager& oat_file_manager = Runtime::Current()->GetOatFileManager();
+  if (oat_file_manager.HasUnverifiedDexFiles()) {
+    std::vector<const DexFile*> dex_files;
+    VisitClassLoaderDexFiles(soa,
+                             class_loader,
+                             [&](const DexFile* cp_dex_file) {
+                               dex_files.push_back(cp_dex_file);
+                               return true;  // Continue with the next DexFile.
+                             });
+    ScopedThreadSuspension sts(soa.Self(), kNative);
+    for (const DexFile* cp_dex_file : dex_files) {
+      std::string error_msg;
+      if (!oat_file_manager.WaitForDexFileVerification(soa.Self(), *cp_dex_file, &error_msg)) {
+        unverified_dex_files.push_back(cp_dex_file);
+      }
+    }
+  }
+  auto is_unverified = [&](const DexFile* cp_dex_file) {
+    return !unverified_dex_files.empty() && ContainsElement(unverified_dex_files, cp_dex_file);
+  };
+
+  // Class loaders are often searched for classes they do not define, when they delegate to their
+  // parent or for optional classes probed by reflection. Use a filter of the classes of their
+  // dex files to reject these without searching each dex file.
+  ClassTable* const class_table = class_loader->GetClassTable();
+  if (class_table != nullptr) {
+    ObjPtr<mirror::Object> dex_elements = GetClassLoaderDexElements(class_loader);
+    const ClassDescriptorFilter* filter = class_table->GetDexFilesFilter(dex_elements);
+    if (filter == nullptr && dex_elements != nullptr) {
+      std::vector<const DexFile*> dex_files;
+      VisitClassLoaderDexFiles(soa,
+                               class_loader,
+                               [&](const DexFile* cp_dex_file) {
+                                 if (!is_unverified(cp_dex_file)) {
+                                   dex_files.push_back(cp_dex_file);
+                                 }
+                                 return true;  // Continue with the next DexFile.
+                               });
+      std::unique_ptr<const ClassDescriptorFilter> new_filter(
+          new ClassDescriptorFilter(dex_files));
+      filter = new_filter.get();
+      // Visiting the dex files reads the array again, only set the filter if it did not change.
+      if (GetClassLoaderDexElements(class_loader) == dex_elements) {
+        class_table->SetDexFilesFilter(dex_elements, std::move(new_filter));
+      } else {
+        filter = nullptr;
+      }
+    }
+    if (filter != nullptr && !filter->MayContain(hash)) {
+      return nullptr;
+    }
+  }
+
   ObjPtr<mirror::Class> ret;
   auto define_class = [&](const DexFile* cp_dex_file) REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (is_unverified(cp_dex_file)) {
+      return true;  // Continue with the next DexFile.
+    }
     const DexFile::ClassDef* dex_class_def =
         OatDexFile::FindClassDef(*cp_dex_file, descriptor, hash);
     if (dex_class_def != nullptr) {
@@ -2517,7 +2617,8 @@ mirror::Class* ClassLinker::FindClass(Thread* self,
   // Class is not yet loaded.
   if (descriptor[0] != '[' && class_loader == nullptr) {
     // Non-array class and the boot class loader, search the boot class path.
-    ClassPathEntry pair = FindInClassPath(descriptor, hash, boot_class_path_);
+    ClassPathEntry pair =
+      FindInClassPath(descriptor, hash, boot_class_path_, GetBootClassPathFilter());
     if (pair.second != nullptr) {
       return DefineClass(self,
                          descriptor,
@@ -2825,6 +2926,7 @@ mirror::Class* ClassLinker::DefineClass(Thread* self,
   // Notify native debugger of the new class and its layout.
   jit::Jit::NewTypeLoadedIfUsingJit(h_new_class.Get());
 
+  RuntimeMetrics::RecordClassDefined();
   return h_new_class.Get();
 }
 
@@ -3518,6 +3620,8 @@ ObjPtr<mirror::DexCache> ClassLinker::RegisterDexFile(const DexFile& dex_file,
                                                                   self,
                                                                   dex_file)));
   Handle<mirror::String> h_location(hs.NewHandle(location));
+  // Dex files the app uses at startup get larger type and field caches.
+  const bool large_caches = Runtime::Current()->GetOatFileManager().IsInStartupProfile(dex_file);
   {
     WriterMutexLock mu(self, *Locks::dex_lock_);
     old_data = FindDexCacheDataLocked(dex_file);
@@ -3531,7 +3635,8 @@ ObjPtr<mirror::DexCache> ClassLinker::RegisterDexFile(const DexFile& dex_file,
                                            h_location.Get(),
                                            &dex_file,
                                            linear_alloc,
-                                           image_pointer_size_);
+                                           image_pointer_size_,
+                                           large_caches);
       RegisterDexFileLocked(dex_file, h_dex_cache.Get(), h_class_loader.Get());
     }
   }
@@ -3553,6 +3658,8 @@ ObjPtr<mirror::DexCache> ClassLinker::RegisterDexFile(const DexFile& dex_file,
     // remembered sets and generational GCs.
     Runtime::Current()->GetHeap()->WriteBarrierEveryFieldOf(h_class_loader.Get());
   }
+  // Now that the dex file is known to the class loader, its classes can be found through it.
+  Runtime::Current()->GetOatFileManager().RunBackgroundClassLoading(dex_file, h_class_loader);
   return h_dex_cache.Get();
 }
 
@@ -6174,6 +6281,7 @@ ArtMethod* ClassLinker::AddMethodToConflictTable(ObjPtr<mirror::Class> klass,
   // atomic operations.
   QuasiAtomic::ThreadFenceRelease();
   new_conflict_method->SetImtConflictTable(new_table, image_pointer_size_);
+  imt_conflict_table_additions_.FetchAndAddRelaxed(1u);
   return new_conflict_method;
 }
 
@@ -6385,6 +6493,8 @@ void ClassLinker::FillIMTFromIfTable(ObjPtr<mirror::IfTable> if_table,
               Runtime::Current()->CreateImtConflictMethod(linear_alloc);
           new_conflict_method->SetImtConflictTable(new_table, image_pointer_size_);
           imt[i] = new_conflict_method;
+          imt_conflict_tables_.FetchAndAddRelaxed(1u);
+          imt_conflict_table_entries_.FetchAndAddRelaxed(conflicts);
         } else {
           LOG(ERROR) << "Failed to allocate conflict table";
           imt[i] = imt_conflict_method;
@@ -7811,6 +7921,10 @@ ObjPtr<mirror::Class> ClassLinker::DoLookupResolvedType(dex::TypeIndex type_idx,
 ObjPtr<mirror::Class> ClassLinker::DoResolveType(dex::TypeIndex type_idx,
                                                  Handle<mirror::DexCache> dex_cache,
                                                  Handle<mirror::ClassLoader> class_loader) {
+  dex_cache_type_misses_.FetchAndAddRelaxed(1u);
+  if (dex_cache->IsResolvedTypeSlotTaken(type_idx)) {
+    dex_cache_type_conflicts_.FetchAndAddRelaxed(1u);
+  }
   Thread* self = Thread::Current();
   const char* descriptor = dex_cache->GetDexFile()->StringByTypeIdx(type_idx);
   ObjPtr<mirror::Class> resolved = FindClass(self, descriptor, class_loader);
@@ -8049,6 +8163,13 @@ ArtField* ClassLinker::LookupResolvedField(uint32_t field_idx,
   return FindResolvedField(klass, dex_cache, class_loader, field_idx, is_static);
 }
 
+void ClassLinker::CountDexCacheFieldMiss(ObjPtr<mirror::DexCache> dex_cache, uint32_t field_idx) {
+  dex_cache_field_misses_.FetchAndAddRelaxed(1u);
+  if (dex_cache->IsResolvedFieldSlotTaken(field_idx, image_pointer_size_)) {
+    dex_cache_field_conflicts_.FetchAndAddRelaxed(1u);
+  }
+}
+
 ArtField* ClassLinker::ResolveField(uint32_t field_idx,
                                     Handle<mirror::DexCache> dex_cache,
                                     Handle<mirror::ClassLoader> class_loader,
@@ -8059,6 +8180,7 @@ ArtField* ClassLinker::ResolveField(uint32_t field_idx,
   if (resolved != nullptr) {
     return resolved;
   }
+  CountDexCacheFieldMiss(dex_cache.Get(), field_idx);
   const DexFile& dex_file = *dex_cache->GetDexFile();
   const DexFile::FieldId& field_id = dex_file.GetFieldId(field_idx);
   ObjPtr<mirror::Class> klass = ResolveType(field_id.class_idx_, dex_cache, class_loader);
@@ -8085,6 +8207,7 @@ ArtField* ClassLinker::ResolveFieldJLS(uint32_t field_idx,
   if (resolved != nullptr) {
     return resolved;
   }
+  CountDexCacheFieldMiss(dex_cache.Get(), field_idx);
   const DexFile& dex_file = *dex_cache->GetDexFile();
   const DexFile::FieldId& field_id = dex_file.GetFieldId(field_idx);
   ObjPtr<mirror::Class> klass = ResolveType(field_id.class_idx_, dex_cache, class_loader);
@@ -8590,6 +8713,13 @@ void ClassLinker::DumpForSigQuit(std::ostream& os) {
   ReaderMutexLock mu(soa.Self(), *Locks::classlinker_classes_lock_);
   os << "Zygote loaded classes=" << NumZygoteClasses() << " post zygote classes="
      << NumNonZygoteClasses() << "\n";
+  os << "Dex cache type misses=" << dex_cache_type_misses_.LoadRelaxed()
+     << " (conflicts=" << dex_cache_type_conflicts_.LoadRelaxed() << ")"
+     << " field misses=" << dex_cache_field_misses_.LoadRelaxed()
+     << " (conflicts=" << dex_cache_field_conflicts_.LoadRelaxed() << ")\n";
+  os << "IMT conflict tables=" << imt_conflict_tables_.LoadRelaxed()
+     << " entries=" << imt_conflict_table_entries_.LoadRelaxed()
+     << " added by dispatch=" << imt_conflict_table_additions_.LoadRelaxed() << "\n";
 }
 
 class CountClassesVisitor : public ClassLoaderVisitor {
@@ -24,6 +24,7 @@
 #include <utility>
 #include <vector>
 
+#include "base/atomic.h"
 #include "base/enums.h"
 #include "base/macros.h"
 #include "base/mutex.h"
@@ -55,6 +56,7 @@ class ClassLoader;
 class DexCache;
 class DexCachePointerArray;
 class DexCacheMethodHandlesTest_Open_Test;
+class DexCacheTest_LargeCaches_Test;
 class DexCacheTest_Open_Test;
 class IfTable;
 class MethodHandle;
@@ -67,6 +69,7 @@ using MethodDexCachePair = NativeDexCachePair<ArtMethod>;
 using MethodDexCacheType = std::atomic<MethodDexCachePair>;
 }  // namespace mirror
 
+class ClassDescriptorFilter;
 class ClassHierarchyAnalysis;
 class ClassTable;
 template<class T> class Handle;
@@ -912,6 +915,9 @@ class ClassLinker {
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::dex_lock_);
 
+  // Return the filter of the boot class path classes, building it if needed.
+  const ClassDescriptorFilter* GetBootClassPathFilter();
+
   // Finds the class in the boot class loader.
   // If the class is found the method returns the resolved class. Otherwise it returns null.
   ObjPtr<mirror::Class> FindClassInBootClassLoaderClassPath(Thread* self,
@@ -926,6 +932,10 @@ class ClassLinker {
                                              ObjPtr<mirror::ClassLoader> class_loader)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Count a miss of `field_idx` in the field cache of `dex_cache`, see DumpForSigQuit().
+  void CountDexCacheFieldMiss(ObjPtr<mirror::DexCache> dex_cache, uint32_t field_idx)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Implementation of ResolveType() called when the type was not found in the dex cache.
   ObjPtr<mirror::Class> DoResolveType(dex::TypeIndex type_idx,
                                       Handle<mirror::DexCache> dex_cache,
@@ -1313,6 +1323,25 @@ class ClassLinker {
   // the classes into the class_table_ to avoid dex cache based searches.
   Atomic<uint32_t> failed_dex_cache_class_lookups_;
 
+  // Filter of the classes defined by a prefix of boot_class_path_, built on first use by
+  // GetBootClassPathFilter(). Dex files appended to the boot class path later are searched
+  // without it.
+  Atomic<const ClassDescriptorFilter*> boot_class_path_filter_;
+
+  // Dex cache misses that resolved a type or a field, and how many of them found the slot
+  // taken by another type or field rather than empty. Reported by DumpForSigQuit().
+  Atomic<uint64_t> dex_cache_type_misses_;
+  Atomic<uint64_t> dex_cache_type_conflicts_;
+  Atomic<uint64_t> dex_cache_field_misses_;
+  Atomic<uint64_t> dex_cache_field_conflicts_;
+
+  // IMT conflict tables created when linking classes, their total number of entries, and the
+  // entries added later by interface dispatch misses. Long tables make the conflict trampoline
+  // scan more entries per call. Reported by DumpForSigQuit().
+  Atomic<uint64_t> imt_conflict_tables_;
+  Atomic<uint64_t> imt_conflict_table_entries_;
+  Atomic<uint64_t> imt_conflict_table_additions_;
+
   // Well known mirror::Class roots.
   GcRoot<mirror::ObjectArray<mirror::Class>> class_roots_;
 
@@ -1354,6 +1383,7 @@ class ClassLinker {
   friend class VMClassLoader;  // for LookupClass and FindClassInBaseDexClassLoader.
   ART_FRIEND_TEST(ClassLinkerTest, RegisterDexFileName);  // for DexLock, and RegisterDexFileLocked
   ART_FRIEND_TEST(mirror::DexCacheMethodHandlesTest, Open);  // for AllocDexCache
+  ART_FRIEND_TEST(mirror::DexCacheTest, LargeCaches);  // for AllocDexCache
   ART_FRIEND_TEST(mirror::DexCacheTest, Open);  // for AllocDexCache
   DISALLOW_COPY_AND_ASSIGN(ClassLinker);
 };
@@ -680,6 +680,14 @@ bool ClassLoaderContext::VerifyClassLoaderContextMatch(const std::string& contex
     DCHECK(dex_files_open_result_);
   }
 
+  // Fast path: in the common case the oat file was compiled with exactly this context, and all
+  // locations were encoded as absolute. An identical encoding implies that all the checks below
+  // pass, so we can avoid parsing the spec and comparing it element by element.
+  if (dex_files_open_attempted_ && dex_files_open_result_ &&
+      context_spec == EncodeContextForOatFile("")) {
+    return true;
+  }
+
   ClassLoaderContext expected_context;
   if (!expected_context.Parse(context_spec, verify_checksums)) {
     LOG(WARNING) << "Invalid class loader context: " << context_spec;
@@ -49,6 +49,20 @@ inline bool IsDelegateLastClassLoader(ScopedObjectAccessAlreadyRunnable& soa,
       soa.Decode<mirror::Class>(WellKnownClasses::dalvik_system_DelegateLastClassLoader);
 }
 
+// Return the DexPathList$Element array of the given class loader, or null if there is none.
+// This function assumes that the given classloader is a subclass of BaseDexClassLoader!
+inline ObjPtr<mirror::Object> GetClassLoaderDexElements(Handle<mirror::ClassLoader> class_loader)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  ObjPtr<mirror::Object> dex_path_list =
+      jni::DecodeArtField(WellKnownClasses::dalvik_system_BaseDexClassLoader_pathList)->
+          GetObject(class_loader.Get());
+  if (dex_path_list == nullptr) {
+    return nullptr;
+  }
+  return jni::DecodeArtField(WellKnownClasses::dalvik_system_DexPathList_dexElements)->
+      GetObject(dex_path_list);
+}
+
 // Visit the DexPathList$Element instances in the given classloader with the given visitor.
 // Constraints on the visitor:
 //   * The visitor should return true to continue visiting more Elements.
@@ -35,6 +35,9 @@ void ClassTable::VisitRoots(Visitor& visitor) {
   for (GcRoot<mirror::Object>& root : strong_roots_) {
     visitor.VisitRoot(root.AddressWithoutBarrier());
   }
+  for (const std::unique_ptr<DexFilesFilter>& filter : dex_files_filters_) {
+    visitor.VisitRoot(filter->dex_elements.AddressWithoutBarrier());
+  }
   for (const OatFile* oat_file : oat_files_) {
     for (GcRoot<mirror::Object>& root : oat_file->GetBssGcRoots()) {
       visitor.VisitRootIfNonNull(root.AddressWithoutBarrier());
@@ -53,6 +56,9 @@ void ClassTable::VisitRoots(const Visitor& visitor) {
   for (GcRoot<mirror::Object>& root : strong_roots_) {
     visitor.VisitRoot(root.AddressWithoutBarrier());
   }
+  for (const std::unique_ptr<DexFilesFilter>& filter : dex_files_filters_) {
+    visitor.VisitRoot(filter->dex_elements.AddressWithoutBarrier());
+  }
   for (const OatFile* oat_file : oat_files_) {
     for (GcRoot<mirror::Object>& root : oat_file->GetBssGcRoots()) {
       visitor.VisitRootIfNonNull(root.AddressWithoutBarrier());
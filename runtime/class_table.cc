@@ -17,12 +17,16 @@
 #include "class_table-inl.h"
 
 #include "base/stl_util.h"
+#include "class_descriptor_filter.h"
 #include "mirror/class-inl.h"
 #include "oat_file.h"
 
 namespace art {
 
-ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock) {
+ClassTable::ClassTable()
+    : lock_("Class loader classes", kClassLoaderClassesLock),
+      frozen_classes_(nullptr),
+      dex_files_filter_(nullptr) {
   Runtime* const runtime = Runtime::Current();
   classes_.push_back(ClassSet(runtime->GetHashTableMinLoadFactor(),
                               runtime->GetHashTableMaxLoadFactor()));
@@ -31,6 +35,18 @@ ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock
 void ClassTable::FreezeSnapshot() {
   WriterMutexLock mu(Thread::Current(), lock_);
   classes_.push_back(ClassSet());
+  PublishFrozenClassSetsLocked();
+}
+
+void ClassTable::PublishFrozenClassSetsLocked() {
+  std::unique_ptr<FrozenClassSets> frozen(new FrozenClassSets());
+  frozen->reserve(classes_.size() - 1u);
+  for (size_t i = 0; i != classes_.size() - 1u; ++i) {
+    frozen->push_back(&classes_[i]);
+  }
+  // Release so that the lock-free lookups see the initialized sets.
+  frozen_classes_.StoreRelease(frozen.get());
+  frozen_classes_storage_.push_back(std::move(frozen));
 }
 
 bool ClassTable::Contains(ObjPtr<mirror::Class> klass) {
@@ -131,7 +147,23 @@ size_t ClassTable::NumReferencedNonZygoteClasses() const {
 
 mirror::Class* ClassTable::Lookup(const char* descriptor, size_t hash) {
   DescriptorHashPair pair(descriptor, hash);
+  // Most lookups find image or zygote classes, search those first without the lock so that
+  // lookups from many threads do not contend on it.
+  const FrozenClassSets* const frozen = frozen_classes_.LoadAcquire();
+  if (frozen != nullptr) {
+    for (const ClassSet* class_set : *frozen) {
+      auto it = class_set->FindWithHash(pair, hash);
+      if (it != class_set->end()) {
+        return it->Read();
+      }
+    }
+  }
   ReaderMutexLock mu(Thread::Current(), lock_);
+  if (frozen != nullptr && frozen == frozen_classes_.LoadRelaxed()) {
+    // The frozen sets did not change since searched, only check the set new classes go to.
+    auto it = classes_.back().FindWithHash(pair, hash);
+    return (it != classes_.back().end()) ? it->Read() : nullptr;
+  }
   for (ClassSet& class_set : classes_) {
     auto it = class_set.FindWithHash(pair, hash);
     if (it != class_set.end()) {
@@ -189,7 +221,13 @@ bool ClassTable::Remove(const char* descriptor) {
   for (ClassSet& class_set : classes_) {
     auto it = class_set.Find(pair);
     if (it != class_set.end()) {
+      // Erasing does not resize the set. It is only safe against concurrent lock-free lookups
+      // in the last set though; only tests remove classes from frozen ones.
       class_set.Erase(it);
+      if (&class_set != &classes_.back()) {
+        // Make lookups that raced with the erase search again under the lock.
+        PublishFrozenClassSetsLocked();
+      }
       return true;
     }
   }
@@ -289,7 +327,29 @@ size_t ClassTable::ReadFromMemory(uint8_t* ptr) {
 
 void ClassTable::AddClassSet(ClassSet&& set) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.insert(classes_.begin(), std::move(set));
+  classes_.push_front(std::move(set));
+  PublishFrozenClassSetsLocked();
+}
+
+ClassTable::DexFilesFilter::DexFilesFilter(
+    ObjPtr<mirror::Object> elements, std::unique_ptr<const ClassDescriptorFilter> class_filter)
+    : dex_elements(elements), filter(std::move(class_filter)) {}
+
+ClassTable::DexFilesFilter::~DexFilesFilter() {}
+
+const ClassDescriptorFilter* ClassTable::GetDexFilesFilter(
+    ObjPtr<mirror::Object> dex_elements) const {
+  const DexFilesFilter* const data = dex_files_filter_.LoadAcquire();
+  return (data != nullptr && data->dex_elements.Read() == dex_elements) ? data->filter.get()
+                                                                         : nullptr;
+}
+
+void ClassTable::SetDexFilesFilter(ObjPtr<mirror::Object> dex_elements,
+                                   std::unique_ptr<const ClassDescriptorFilter> filter) {
+  std::unique_ptr<DexFilesFilter> data(new DexFilesFilter(dex_elements, std::move(filter)));
+  WriterMutexLock mu(Thread::Current(), lock_);
+  dex_files_filter_.StoreRelease(data.get());
+  dex_files_filters_.push_back(std::move(data));
 }
 
 void ClassTable::ClearStrongRoots() {
@@ -17,11 +17,14 @@
 #ifndef ART_RUNTIME_CLASS_TABLE_H_
 #define ART_RUNTIME_CLASS_TABLE_H_
 
+#include <deque>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "base/allocator.h"
+#include "base/atomic.h"
 #include "base/hash_set.h"
 #include "base/macros.h"
 #include "base/mutex.h"
@@ -30,6 +33,7 @@
 
 namespace art {
 
+class ClassDescriptorFilter;
 class OatFile;
 
 namespace linker {
@@ -199,7 +203,8 @@ class ClassTable {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
-  // Return the first class that matches the descriptor. Returns null if there are none.
+  // Return the first class that matches the descriptor. Returns null if there are none. The
+  // frozen class sets are searched without holding the lock.
   mirror::Class* Lookup(const char* descriptor, size_t hash)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -264,6 +269,18 @@ class ClassTable {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Return the filter of the classes defined by the dex files of the class loader if it was
+  // built for `dex_elements`, the current DexPathList.dexElements of a BaseDexClassLoader, or
+  // null. DexPathList replaces the array when adding dex files, which invalidates the filter.
+  const ClassDescriptorFilter* GetDexFilesFilter(ObjPtr<mirror::Object> dex_elements) const
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Set the filter of the classes defined by the dex files in `dex_elements`.
+  void SetDexFilesFilter(ObjPtr<mirror::Object> dex_elements,
+                         std::unique_ptr<const ClassDescriptorFilter> filter)
+      REQUIRES(!lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   ReaderWriterMutex& GetLock() {
     return lock_;
   }
@@ -283,10 +300,37 @@ class ClassTable {
       REQUIRES(lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Publish the current frozen class sets, all but the last one of `classes_`, for Lookup().
+  void PublishFrozenClassSetsLocked() REQUIRES(lock_);
+
   // Lock to guard inserting and removing.
   mutable ReaderWriterMutex lock_;
-  // We have a vector to help prevent dirty pages after the zygote forks by calling FreezeSnapshot.
-  std::vector<ClassSet> classes_ GUARDED_BY(lock_);
+  // We have multiple sets to help prevent dirty pages after the zygote forks by calling
+  // FreezeSnapshot. New classes are only inserted in the last set; the other ones come from
+  // images or previous snapshots and are never resized, so that Lookup() can search them
+  // without the lock. A deque keeps them at the same address when sets are added at either end.
+  std::deque<ClassSet> classes_ GUARDED_BY(lock_);
+  // The frozen class sets as last published, or null if there are none. Lookups that find the
+  // same value under the lock only need to search the last set of `classes_` after these.
+  using FrozenClassSets = std::vector<const ClassSet*>;
+  Atomic<const FrozenClassSets*> frozen_classes_;
+  // Every published FrozenClassSets, since a lookup may still use an older one.
+  std::vector<std::unique_ptr<const FrozenClassSets>> frozen_classes_storage_ GUARDED_BY(lock_);
+
+  struct DexFilesFilter {
+    DexFilesFilter(ObjPtr<mirror::Object> elements,
+                   std::unique_ptr<const ClassDescriptorFilter> class_filter)
+        REQUIRES_SHARED(Locks::mutator_lock_);
+    ~DexFilesFilter();
+
+    GcRoot<mirror::Object> dex_elements;
+    const std::unique_ptr<const ClassDescriptorFilter> filter;
+  };
+  // The latest filter set by SetDexFilesFilter(), or null.
+  Atomic<const DexFilesFilter*> dex_files_filter_;
+  // Every filter set, since a lookup may still use an older one. Their dex elements are visited
+  // as roots so that the comparison in GetDexFilesFilter() stays valid.
+  std::vector<std::unique_ptr<DexFilesFilter>> dex_files_filters_ GUARDED_BY(lock_);
   // Extra strong roots that can be either dex files or dex caches. Dex files used by the class
   // loader which may not be owned by the class loader must be held strongly live. Also dex caches
   // are held live to prevent them being unloading once they have classes in them.
@@ -104,6 +104,10 @@ TEST_F(ClassTableTest, ClassTable) {
   table.Insert(h_Y.Get());
   EXPECT_EQ(table.LookupByDescriptor(h_X.Get()), h_X.Get());
   EXPECT_EQ(table.LookupByDescriptor(h_Y.Get()), h_Y.Get());
+  // Lookup searches the frozen set without the lock, and the latest set with it.
+  EXPECT_EQ(table.Lookup(descriptor_x, ComputeModifiedUtf8Hash(descriptor_x)), h_X.Get());
+  EXPECT_EQ(table.Lookup(descriptor_y, ComputeModifiedUtf8Hash(descriptor_y)), h_Y.Get());
+  EXPECT_EQ(table.Lookup("NOT_THERE", ComputeModifiedUtf8Hash("NOT_THERE")), nullptr);
   EXPECT_TRUE(table.Contains(h_X.Get()));
   EXPECT_TRUE(table.Contains(h_Y.Get()));
 
@@ -143,6 +147,7 @@ TEST_F(ClassTableTest, ClassTable) {
   // Test remove.
   table.Remove(descriptor_x);
   EXPECT_FALSE(table.Contains(h_X.Get()));
+  EXPECT_EQ(table.Lookup(descriptor_x, ComputeModifiedUtf8Hash(descriptor_x)), nullptr);
 
   // Test that WriteToMemory and ReadFromMemory work.
   table.Insert(h_X.Get());
@@ -155,6 +160,8 @@ TEST_F(ClassTableTest, ClassTable) {
   // Strong roots are not serialized, only classes.
   EXPECT_TRUE(table2.Contains(h_X.Get()));
   EXPECT_TRUE(table2.Contains(h_Y.Get()));
+  EXPECT_EQ(table2.Lookup(descriptor_x, ComputeModifiedUtf8Hash(descriptor_x)), h_X.Get());
+  EXPECT_EQ(table2.Lookup(descriptor_y, ComputeModifiedUtf8Hash(descriptor_y)), h_Y.Get());
 
   // TODO: Add tests for UpdateClass, InsertOatFile.
 }
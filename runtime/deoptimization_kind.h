@@ -25,6 +25,8 @@ enum class DeoptimizationKind {
   kJitSameTarget,
   kLoopBoundsBCE,
   kLoopNullBCE,
+  kLoopCheckCast,
+  kLoopNullLICM,
   kBlockBCE,
   kCHA,
   kFullFrame,
@@ -38,6 +40,8 @@ inline const char* GetDeoptimizationKindName(DeoptimizationKind kind) {
     case DeoptimizationKind::kJitSameTarget: return "JIT same target";
     case DeoptimizationKind::kLoopBoundsBCE: return "loop bounds check elimination";
     case DeoptimizationKind::kLoopNullBCE: return "loop bounds check elimination on null";
+    case DeoptimizationKind::kLoopCheckCast: return "loop check cast elimination";
+    case DeoptimizationKind::kLoopNullLICM: return "loop invariant null check speculation";
     case DeoptimizationKind::kBlockBCE: return "block bounds check elimination";
     case DeoptimizationKind::kCHA: return "class hierarchy analysis";
     case DeoptimizationKind::kFullFrame: return "full frame";
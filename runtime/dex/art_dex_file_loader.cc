@@ -19,6 +19,10 @@
 #include <sys/mman.h>  // For the PROT_* and MAP_* constants.
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "android-base/stringprintf.h"
 
 #include "base/file_magic.h"
@@ -443,6 +447,11 @@ std::unique_ptr<const DexFile> ArtDexFileLoader::OpenOneDexFileFromZip(
 // seems an excessive number.
 static constexpr size_t kWarnOnManyDexFilesThreshold = 100;
 
+// Secondary dex files are extracted and verified on up to this many threads, including the
+// calling thread. Both mostly touch memory that is private to each dex file, and only read the
+// zip archive, so they scale with the number of entries.
+static constexpr size_t kMaxDexFileOpenThreads = 4;
+
 bool ArtDexFileLoader::OpenAllDexFilesFromZip(
     const ZipArchive& zip_archive,
     const std::string& location,
@@ -452,58 +461,80 @@ bool ArtDexFileLoader::OpenAllDexFilesFromZip(
     std::vector<std::unique_ptr<const DexFile>>* dex_files) const {
   ScopedTrace trace("Dex file open from Zip " + std::string(location));
   DCHECK(dex_files != nullptr) << "DexFile::OpenFromZip: out-param is nullptr";
-  ZipOpenErrorCode error_code;
-  std::unique_ptr<const DexFile> dex_file(OpenOneDexFileFromZip(zip_archive,
-                                                                kClassesDex,
-                                                                location,
-                                                                verify,
-                                                                verify_checksum,
-                                                                error_msg,
-                                                                &error_code));
-  if (dex_file.get() == nullptr) {
-    return false;
-  } else {
-    // Had at least classes.dex.
-    dex_files->push_back(std::move(dex_file));
-
-    // Now try some more.
-
-    // We could try to avoid std::string allocations by working on a char array directly. As we
-    // do not expect a lot of iterations, this seems too involved and brittle.
-
-    for (size_t i = 1; ; ++i) {
-      std::string name = GetMultiDexClassesDexName(i);
-      std::string fake_location = GetMultiDexLocation(i, location.c_str());
-      std::unique_ptr<const DexFile> next_dex_file(OpenOneDexFileFromZip(zip_archive,
-                                                                         name.c_str(),
-                                                                         fake_location,
-                                                                         verify,
-                                                                         verify_checksum,
-                                                                         error_msg,
-                                                                         &error_code));
-      if (next_dex_file.get() == nullptr) {
-        if (error_code != ZipOpenErrorCode::kEntryNotFound) {
-          LOG(WARNING) << "Zip open failed: " << *error_msg;
-        }
-        break;
-      } else {
-        dex_files->push_back(std::move(next_dex_file));
-      }
 
-      if (i == kWarnOnManyDexFilesThreshold) {
-        LOG(WARNING) << location << " has in excess of " << kWarnOnManyDexFilesThreshold
-                     << " dex files. Please consider coalescing and shrinking the number to "
-                        " avoid runtime overhead.";
-      }
+  // Find the names of all classesXXX.dex entries first. Looking up an entry is cheap, while
+  // extracting and verifying it is what takes time, so the latter is done in parallel below.
+  // We could try to avoid std::string allocations by working on a char array directly. As we
+  // do not expect a lot of iterations, this seems too involved and brittle.
+  std::vector<std::string> entry_names;
+  entry_names.push_back(kClassesDex);
+  for (size_t i = 1; ; ++i) {
+    std::string name = GetMultiDexClassesDexName(i);
+    std::string find_error_msg;
+    std::unique_ptr<ZipEntry> zip_entry(zip_archive.Find(name.c_str(), &find_error_msg));
+    if (zip_entry == nullptr) {
+      break;
+    }
+    entry_names.push_back(std::move(name));
 
-      if (i == std::numeric_limits<size_t>::max()) {
-        LOG(ERROR) << "Overflow in number of dex files!";
-        break;
-      }
+    if (i == kWarnOnManyDexFilesThreshold) {
+      LOG(WARNING) << location << " has in excess of " << kWarnOnManyDexFilesThreshold
+                   << " dex files. Please consider coalescing and shrinking the number to "
+                      " avoid runtime overhead.";
     }
 
-    return true;
+    if (i == std::numeric_limits<size_t>::max()) {
+      LOG(ERROR) << "Overflow in number of dex files!";
+      break;
+    }
+  }
+
+  const size_t num_entries = entry_names.size();
+  std::vector<std::unique_ptr<const DexFile>> opened(num_entries);
+  std::vector<std::string> error_msgs(num_entries);
+  std::vector<ZipOpenErrorCode> error_codes(num_entries, ZipOpenErrorCode::kNoError);
+  std::atomic<size_t> next_entry(0u);
+  auto open_entries = [&]() {
+    for (size_t i = next_entry.fetch_add(1u); i < num_entries; i = next_entry.fetch_add(1u)) {
+      std::string entry_location = GetMultiDexLocation(i, location.c_str());
+      opened[i] = OpenOneDexFileFromZip(zip_archive,
+                                        entry_names[i].c_str(),
+                                        entry_location,
+                                        verify,
+                                        verify_checksum,
+                                        &error_msgs[i],
+                                        &error_codes[i]);
+    }
+  };
+  // The worker threads do not need to be attached to the runtime, since opening a dex file does
+  // not use managed state. This also keeps the loader usable by tools that have no runtime.
+  std::vector<std::thread> threads;
+  const size_t num_threads = std::min(num_entries, kMaxDexFileOpenThreads);
+  for (size_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back(open_entries);
+  }
+  open_entries();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  if (opened[0] == nullptr) {
+    *error_msg = error_msgs[0];
+    return false;
+  }
+  // Keep the dex files up to the first one that failed to open, as if they were opened one
+  // after the other.
+  for (size_t i = 0; i != num_entries; ++i) {
+    if (opened[i] == nullptr) {
+      if (error_codes[i] != ZipOpenErrorCode::kEntryNotFound) {
+        LOG(WARNING) << "Zip open failed: " << error_msgs[i];
+      }
+      *error_msg = error_msgs[i];
+      break;
+    }
+    dex_files->push_back(std::move(opened[i]));
   }
+  return true;
 }
 
 std::unique_ptr<DexFile> ArtDexFileLoader::OpenCommon(const uint8_t* base,
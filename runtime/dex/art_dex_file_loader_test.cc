@@ -34,6 +34,7 @@
 #include "mem_map.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
+#include "ziparchive/zip_writer.h"
 
 namespace art {
 
@@ -93,6 +94,52 @@ TEST_F(ArtDexFileLoaderTest, GetMultiDexChecksums) {
   EXPECT_EQ(dexes[1]->GetLocationChecksum(), checksums[1]);
 }
 
+TEST_F(ArtDexFileLoaderTest, OpenZipManyDexFiles) {
+  std::unique_ptr<const DexFile> main(OpenTestDexFile("Main"));
+  ASSERT_TRUE(main != nullptr);
+
+  // Write an APK with more dex files than there are threads to open them, which alternate between
+  // compressed and stored entries. One entry is corrupt, so only the ones before it are opened.
+  static constexpr size_t kNumDexFiles = 9u;
+  static constexpr size_t kCorruptDexFile = 7u;
+  ScratchFile zip;
+  FILE* file = fopen(zip.GetFile()->GetPath().c_str(), "wb");
+  ASSERT_TRUE(file != nullptr);
+  ZipWriter writer(file);
+  for (size_t i = 0; i != kNumDexFiles; ++i) {
+    std::string name = DexFileLoader::GetMultiDexClassesDexName(i);
+    size_t flags = (i % 2u == 0u) ? ZipWriter::kCompress : ZipWriter::kAlign32;
+    ASSERT_EQ(0, writer.StartEntry(name.c_str(), flags));
+    if (i == kCorruptDexFile) {
+      std::vector<uint8_t> garbage(main->Size(), 0xabu);
+      ASSERT_EQ(0, writer.WriteBytes(garbage.data(), garbage.size()));
+    } else {
+      ASSERT_EQ(0, writer.WriteBytes(main->Begin(), main->Size()));
+    }
+    ASSERT_EQ(0, writer.FinishEntry());
+  }
+  ASSERT_EQ(0, writer.Finish());
+  fflush(file);
+  fclose(file);
+
+  const ArtDexFileLoader dex_file_loader;
+  std::string error_msg;
+  std::vector<std::unique_ptr<const DexFile>> dex_files;
+  const std::string& location = zip.GetFilename();
+  ASSERT_TRUE(dex_file_loader.Open(location.c_str(),
+                                   location,
+                                   /* verify */ true,
+                                   /* verify_checksum */ true,
+                                   &error_msg,
+                                   &dex_files)) << error_msg;
+  ASSERT_EQ(kCorruptDexFile, dex_files.size());
+  for (size_t i = 0; i != dex_files.size(); ++i) {
+    EXPECT_EQ(DexFileLoader::GetMultiDexLocation(i, location.c_str()), dex_files[i]->GetLocation());
+    EXPECT_EQ(main->Size(), dex_files[i]->Size());
+    EXPECT_EQ(0, memcmp(main->Begin(), dex_files[i]->Begin(), main->Size()));
+  }
+}
+
 TEST_F(ArtDexFileLoaderTest, ClassDefs) {
   ScopedObjectAccess soa(Thread::Current());
   std::unique_ptr<const DexFile> raw(OpenTestDexFile("Nested"));
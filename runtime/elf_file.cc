@@ -120,8 +120,9 @@ bool ElfFileImpl<ElfTypes>::Setup(File* file,
   }
 
   if (program_header_only_) {
-    // first just map ELF header to get program header size information
-    size_t elf_header_size = sizeof(Elf_Ehdr);
+    // First map the ELF header to get program header size information. Map the whole first
+    // page as the program headers usually follow the ELF header and we can avoid remapping.
+    size_t elf_header_size = std::min(file_length, static_cast<size_t>(kPageSize));
     if (!SetMap(file,
                 MemMap::MapFile(elf_header_size,
                                 prot,
@@ -134,7 +135,7 @@ bool ElfFileImpl<ElfTypes>::Setup(File* file,
                 error_msg)) {
       return false;
     }
-    // then remap to cover program header
+    // Then remap to cover program header if needed.
     size_t program_header_size = header_->e_phoff + (header_->e_phentsize * header_->e_phnum);
     if (file_length < program_header_size) {
       *error_msg = StringPrintf("File size of %zd bytes not large enough to contain ELF program "
@@ -142,7 +143,8 @@ bool ElfFileImpl<ElfTypes>::Setup(File* file,
                                 sizeof(Elf_Ehdr), file->GetPath().c_str());
       return false;
     }
-    if (!SetMap(file,
+    if (program_header_size > elf_header_size &&
+        !SetMap(file,
                 MemMap::MapFile(program_header_size,
                                 prot,
                                 flags,
@@ -1090,6 +1092,14 @@ bool ElfFileImpl<ElfTypes>::Load(File* file,
     }
   }
 
+  int64_t temp_file_length = file->GetLength();
+  if (temp_file_length < 0) {
+    errno = -temp_file_length;
+    *error_msg = StringPrintf("Failed to get length of file: '%s' fd=%d: %s",
+                              file->GetPath().c_str(), file->Fd(), strerror(errno));
+    return false;
+  }
+  size_t file_length = static_cast<size_t>(temp_file_length);
   bool reserved = false;
   for (Elf_Word i = 0; i < GetProgramHeaderNum(); i++) {
     Elf_Phdr* program_header = GetProgramHeader(i);
@@ -1119,14 +1129,6 @@ bool ElfFileImpl<ElfTypes>::Load(File* file,
     // non-zero, the segments require the specific address specified,
     // which either was specified in the file because we already set
     // base_address_ after the first zero segment).
-    int64_t temp_file_length = file->GetLength();
-    if (temp_file_length < 0) {
-      errno = -temp_file_length;
-      *error_msg = StringPrintf("Failed to get length of file: '%s' fd=%d: %s",
-                                file->GetPath().c_str(), file->Fd(), strerror(errno));
-      return false;
-    }
-    size_t file_length = static_cast<size_t>(temp_file_length);
     if (!reserved) {
       uint8_t* reserve_base = reinterpret_cast<uint8_t*>(program_header->p_vaddr);
       uint8_t* reserve_base_override = reserve_base;
@@ -27,6 +27,7 @@
 #include "dex/dex_file.h"
 #include "dex/invoke_type.h"
 #include "entrypoints/quick/callee_save_frame.h"
+#include "gc/heap.h"
 #include "handle_scope-inl.h"
 #include "imt_conflict_table.h"
 #include "imtable-inl.h"
@@ -37,6 +38,7 @@
 #include "mirror/object-inl.h"
 #include "mirror/throwable.h"
 #include "nth_caller_visitor.h"
+#include "oat_file.h"
 #include "runtime.h"
 #include "stack_map.h"
 #include "thread.h"
@@ -44,6 +46,21 @@
 
 namespace art {
 
+// Returns whether AOT-compiled code of `outer_method` may have inlined `inlined_method`
+// from another dex file, i.e. from a dex file of the same oat file or from the boot image.
+inline bool CanInlineAcrossDexFiles(ArtMethod* outer_method, ArtMethod* inlined_method)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  const OatDexFile* outer_oat_dex_file = outer_method->GetDexFile()->GetOatDexFile();
+  const OatDexFile* inlined_oat_dex_file = inlined_method->GetDexFile()->GetOatDexFile();
+  if (outer_oat_dex_file != nullptr &&
+      inlined_oat_dex_file != nullptr &&
+      outer_oat_dex_file->GetOatFile() == inlined_oat_dex_file->GetOatFile()) {
+    return true;
+  }
+  return Runtime::Current()->GetHeap()->ObjectIsInBootImageSpace(
+      inlined_method->GetDeclaringClass());
+}
+
 inline ArtMethod* GetResolvedMethod(ArtMethod* outer_method,
                                     const MethodInfo& method_info,
                                     const InlineInfo& inline_info,
@@ -86,11 +103,11 @@ inline ArtMethod* GetResolvedMethod(ArtMethod* outer_method,
       UNREACHABLE();
     }
     DCHECK(!inlined_method->IsRuntimeMethod());
-    if (UNLIKELY(inlined_method->GetDexFile() != method->GetDexFile())) {
-      // TODO: We could permit inlining within a multi-dex oat file and the boot image,
-      // even going back from boot image methods to the same oat file. However, this is
-      // not currently implemented in the compiler. Therefore crossing dex file boundary
-      // indicates that the inlined definition is not the same as the one used at runtime.
+    if (UNLIKELY(inlined_method->GetDexFile() != method->GetDexFile()) &&
+        !CanInlineAcrossDexFiles(outer_method, inlined_method)) {
+      // The compiler inlines across dex files only within the oat file of the outer
+      // method and from the boot image. Crossing any other dex file boundary indicates
+      // that the inlined definition is not the same as the one used at runtime.
       LOG(FATAL) << "Inlined method resolution crossed dex file boundary: from "
                  << method->PrettyMethod()
                  << " in " << method->GetDexFile()->GetLocation() << "/"
@@ -75,10 +75,11 @@ static void StoreObjectInBss(ArtMethod* outer_method,
 }
 
 static inline void StoreTypeInBss(ArtMethod* outer_method,
+                                  ArtMethod* caller,
                                   dex::TypeIndex type_idx,
                                   ObjPtr<mirror::Class> resolved_type)
     REQUIRES_SHARED(Locks::mutator_lock_) {
-  const DexFile* dex_file = outer_method->GetDexFile();
+  const DexFile* dex_file = caller->GetDexFile();
   DCHECK(dex_file != nullptr);
   const OatDexFile* oat_dex_file = dex_file->GetOatDexFile();
   if (oat_dex_file != nullptr) {
@@ -93,10 +94,11 @@ static inline void StoreTypeInBss(ArtMethod* outer_method,
 }
 
 static inline void StoreStringInBss(ArtMethod* outer_method,
+                                    ArtMethod* caller,
                                     dex::StringIndex string_idx,
                                     ObjPtr<mirror::String> resolved_string)
     REQUIRES_SHARED(Locks::mutator_lock_) __attribute__((optnone)) {
-  const DexFile* dex_file = outer_method->GetDexFile();
+  const DexFile* dex_file = caller->GetDexFile();
   DCHECK(dex_file != nullptr);
   const OatDexFile* oat_dex_file = dex_file->GetOatDexFile();
   if (oat_dex_file != nullptr) {
@@ -113,9 +115,11 @@ static inline void StoreStringInBss(ArtMethod* outer_method,
 static ALWAYS_INLINE bool CanReferenceBss(ArtMethod* outer_method, ArtMethod* caller)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   // .bss references are used only for AOT-compiled code and only when the instruction
-  // originates from the outer method's dex file and the type or string index is tied to
-  // that dex file. As we do not want to check if the call is coming from AOT-compiled
-  // code (that could be expensive), simply check if the caller has the same dex file.
+  // originates from a dex file of the outer method's oat file; the type or string index
+  // is tied to the caller's dex file, which the compiler may have inlined from another
+  // dex file of the same oat file. As we do not want to check if the call is coming from
+  // AOT-compiled code (that could be expensive), simply check if the caller's dex file
+  // belongs to the same oat file as the outer method's.
   //
   // If we've accepted running AOT-compiled code despite the runtime class loader
   // resolving the caller to a different dex file, this check shall prevent us from
@@ -123,10 +127,18 @@ static ALWAYS_INLINE bool CanReferenceBss(ArtMethod* outer_method, ArtMethod* ca
   // but correct; we do not really care that much about performance in this odd case.
   //
   // JIT can inline throwing instructions across dex files and this check prevents
-  // looking up the index in the wrong dex file in that case. If the caller and outer
-  // method have the same dex file, we may or may not find a .bss slot to update;
-  // if we do, this can still benefit AOT-compiled code executed later.
-  return outer_method->GetDexFile() == caller->GetDexFile();
+  // storing into the .bss of an oat file the outer method's class loader does not
+  // own in that case. If the caller's dex file is in the outer method's oat file, we
+  // may or may not find a .bss slot to update; if we do, this can still benefit
+  // AOT-compiled code executed later.
+  if (outer_method->GetDexFile() == caller->GetDexFile()) {
+    return true;
+  }
+  const OatDexFile* outer_oat_dex_file = outer_method->GetDexFile()->GetOatDexFile();
+  const OatDexFile* caller_oat_dex_file = caller->GetDexFile()->GetOatDexFile();
+  return outer_oat_dex_file != nullptr &&
+      caller_oat_dex_file != nullptr &&
+      outer_oat_dex_file->GetOatFile() == caller_oat_dex_file->GetOatFile();
 }
 
 extern "C" mirror::Class* artInitializeStaticStorageFromCode(uint32_t type_idx, Thread* self)
@@ -144,7 +156,7 @@ extern "C" mirror::Class* artInitializeStaticStorageFromCode(uint32_t type_idx,
                                                         /* can_run_clinit */ true,
                                                         /* verify_access */ false);
   if (LIKELY(result != nullptr) && CanReferenceBss(caller_and_outer.outer_method, caller)) {
-    StoreTypeInBss(caller_and_outer.outer_method, dex::TypeIndex(type_idx), result);
+    StoreTypeInBss(caller_and_outer.outer_method, caller, dex::TypeIndex(type_idx), result);
   }
   return result.Ptr();
 }
@@ -162,7 +174,7 @@ extern "C" mirror::Class* artInitializeTypeFromCode(uint32_t type_idx, Thread* s
                                                         /* can_run_clinit */ false,
                                                         /* verify_access */ false);
   if (LIKELY(result != nullptr) && CanReferenceBss(caller_and_outer.outer_method, caller)) {
-    StoreTypeInBss(caller_and_outer.outer_method, dex::TypeIndex(type_idx), result);
+    StoreTypeInBss(caller_and_outer.outer_method, caller, dex::TypeIndex(type_idx), result);
   }
   return result.Ptr();
 }
@@ -191,7 +203,7 @@ extern "C" mirror::String* artResolveStringFromCode(int32_t string_idx, Thread*
   ArtMethod* caller = caller_and_outer.caller;
   ObjPtr<mirror::String> result = ResolveStringFromCode(caller, dex::StringIndex(string_idx));
   if (LIKELY(result != nullptr) && CanReferenceBss(caller_and_outer.outer_method, caller)) {
-    StoreStringInBss(caller_and_outer.outer_method, dex::StringIndex(string_idx), result);
+    StoreStringInBss(caller_and_outer.outer_method, caller, dex::StringIndex(string_idx), result);
   }
   return result.Ptr();
 }
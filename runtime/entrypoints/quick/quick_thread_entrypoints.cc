@@ -15,6 +15,9 @@
  */
 
 #include "callee_save_frame.h"
+#include "entrypoints/entrypoint_utils.h"
+#include "jit/jit.h"
+#include "runtime.h"
 #include "thread-inl.h"
 
 namespace art {
@@ -23,6 +26,18 @@ extern "C" void artTestSuspendFromCode(Thread* self) REQUIRES_SHARED(Locks::muta
   // Called when suspend count check value is 0 and thread->suspend_count_ != 0
   ScopedQuickEntrypointChecks sqec(self);
   self->CheckSuspend();
+  // Suspend checks sample the methods running compiled code, look for hot baseline code.
+  Runtime* runtime = Runtime::Current();
+  jit::Jit* jit = runtime->GetJit();
+  if (jit != nullptr && jit->UseBaselineCompilation() && !jit->IsBaselineOnly()) {
+    ArtMethod** sp = self->GetManagedStack()->GetTopQuickFrameKnownNotTagged();
+    // Implicit suspend checks use a different frame.
+    if (*sp == runtime->GetCalleeSaveMethod(CalleeSaveType::kSaveEverythingForSuspendCheck)) {
+      ArtMethod* method =
+          GetCalleeSaveOuterMethod(self, CalleeSaveType::kSaveEverythingForSuspendCheck);
+      jit->MaybeOptimizeBaselineMethod(self, method);
+    }
+  }
 }
 
 }  // namespace art
@@ -32,6 +32,7 @@
 #include "imtable-inl.h"
 #include "index_bss_mapping.h"
 #include "instrumentation.h"
+#include "intrinsics_enum.h"
 #include "interpreter/interpreter.h"
 #include "jit/jit.h"
 #include "linear_alloc.h"
@@ -49,6 +50,7 @@
 #include "scoped_thread_state_change-inl.h"
 #include "stack.h"
 #include "thread-inl.h"
+#include "var_handles.h"
 #include "well_known_classes.h"
 
 namespace art {
@@ -2787,13 +2789,6 @@ extern "C" uintptr_t artInvokePolymorphic(
     return static_cast<uintptr_t>('V');
   }
 
-  // TODO(oth): Ensure this path isn't taken for VarHandle accessors (b/65872996).
-  DCHECK_EQ(resolved_method->GetDeclaringClass(),
-            WellKnownClasses::ToClass(WellKnownClasses::java_lang_invoke_MethodHandle));
-
-  Handle<mirror::MethodHandle> method_handle(hs.NewHandle(
-      ObjPtr<mirror::MethodHandle>::DownCast(MakeObjPtr(receiver_handle.Get()))));
-
   Handle<mirror::MethodType> method_type(
       hs.NewHandle(linker->ResolveMethodType(self, proto_idx, caller_method)));
 
@@ -2830,26 +2825,48 @@ extern "C" uintptr_t artInvokePolymorphic(
   ManagedStack fragment;
   self->PushManagedStackFragment(&fragment);
 
-  // Call DoInvokePolymorphic with |is_range| = true, as shadow frame has argument registers in
-  // consecutive order.
+  // Call the accessor or invoker with operands that are consecutive in the shadow frame and
+  // exclude the receiver.
   RangeInstructionOperands operands(first_arg + 1, num_vregs - 1);
-  bool isExact = (jni::EncodeArtMethod(resolved_method) ==
-                  WellKnownClasses::java_lang_invoke_MethodHandle_invokeExact);
   bool success = false;
-  if (isExact) {
-    success = MethodHandleInvokeExact(self,
+  if (resolved_method->GetDeclaringClass() ==
+      WellKnownClasses::ToClass(WellKnownClasses::java_lang_invoke_MethodHandle)) {
+    Handle<mirror::MethodHandle> method_handle(hs.NewHandle(
+        ObjPtr<mirror::MethodHandle>::DownCast(MakeObjPtr(receiver_handle.Get()))));
+    bool isExact = (jni::EncodeArtMethod(resolved_method) ==
+                    WellKnownClasses::java_lang_invoke_MethodHandle_invokeExact);
+    if (isExact) {
+      success = MethodHandleInvokeExact(self,
+                                        *shadow_frame,
+                                        method_handle,
+                                        method_type,
+                                        &operands,
+                                        result);
+    } else {
+      success = MethodHandleInvoke(self,
+                                   *shadow_frame,
+                                   method_handle,
+                                   method_type,
+                                   &operands,
+                                   result);
+    }
+  } else {
+    // VarHandle accessors are signature polymorphic too and the access mode is recorded as the
+    // intrinsic of the resolved method.
+    DCHECK_EQ(resolved_method->GetDeclaringClass(),
+              WellKnownClasses::ToClass(WellKnownClasses::java_lang_invoke_VarHandle));
+    DCHECK(resolved_method->IsIntrinsic());
+    Handle<mirror::VarHandle> var_handle(hs.NewHandle(
+        ObjPtr<mirror::VarHandle>::DownCast(MakeObjPtr(receiver_handle.Get()))));
+    mirror::VarHandle::AccessMode access_mode = mirror::VarHandle::GetAccessModeByIntrinsic(
+        static_cast<Intrinsics>(resolved_method->GetIntrinsic()));
+    success = VarHandleInvokeAccessor(self,
                                       *shadow_frame,
-                                      method_handle,
+                                      var_handle,
                                       method_type,
+                                      access_mode,
                                       &operands,
                                       result);
-  } else {
-    success = MethodHandleInvoke(self,
-                                 *shadow_frame,
-                                 method_handle,
-                                 method_type,
-                                 &operands,
-                                 result);
   }
   DCHECK(success || self->IsExceptionPending());
 
@@ -161,6 +161,67 @@ class AtomicStack {
     back_index_.StoreRelaxed(back_index_.LoadRelaxed() - n);
   }
 
+  // Work-stealing operations (Chase-Lev deque without resizing). The owning thread pushes and
+  // pops at the back with PushBackStealable() and PopBackStealable() while any number of other
+  // threads concurrently take items from the front with StealFront(). These must not be mixed
+  // with the other push/pop operations until all threads are done with the stack.
+
+  // Returns false if we overflowed the stack.
+  bool PushBackStealable(T* value) REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (kIsDebugBuild) {
+      debug_is_sorted_ = false;
+    }
+    const int32_t index = back_index_.LoadRelaxed();
+    if (UNLIKELY(static_cast<size_t>(index) >= growth_limit_)) {
+      return false;
+    }
+    begin_[index].Assign(value);
+    // Publish the element to the stealing threads.
+    back_index_.StoreSequentiallyConsistent(index + 1);
+    return true;
+  }
+
+  // Returns null if the stack is empty or if a stealing thread won the race for the last item.
+  T* PopBackStealable() REQUIRES_SHARED(Locks::mutator_lock_) {
+    const int32_t index = back_index_.LoadRelaxed() - 1;
+    back_index_.StoreSequentiallyConsistent(index);
+    const int32_t front_index = front_index_.LoadSequentiallyConsistent();
+    if (front_index > index) {
+      // Empty. Restore the back index.
+      back_index_.StoreRelaxed(index + 1);
+      return nullptr;
+    }
+    T* value = begin_[index].AsMirrorPtr();
+    if (front_index == index) {
+      // Last item, race with the stealing threads for it.
+      if (!front_index_.CompareAndSetStrongSequentiallyConsistent(front_index, front_index + 1)) {
+        value = nullptr;
+      }
+      back_index_.StoreRelaxed(index + 1);
+    }
+    return value;
+  }
+
+  // Returns null if the stack is empty or if we lost the race with another thread.
+  T* StealFront() REQUIRES_SHARED(Locks::mutator_lock_) {
+    const int32_t front_index = front_index_.LoadSequentiallyConsistent();
+    const int32_t back_index = back_index_.LoadSequentiallyConsistent();
+    if (front_index >= back_index) {
+      return nullptr;
+    }
+    T* value = begin_[front_index].AsMirrorPtr();
+    if (!front_index_.CompareAndSetStrongSequentiallyConsistent(front_index, front_index + 1)) {
+      return nullptr;
+    }
+    return value;
+  }
+
+  // Racy emptiness check that is safe to call while other threads use the work-stealing
+  // operations above.
+  bool IsEmptyStealable() const {
+    return front_index_.LoadSequentiallyConsistent() >= back_index_.LoadSequentiallyConsistent();
+  }
+
   bool IsEmpty() const {
     return Size() == 0;
   }
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "atomic_stack.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "common_runtime_test.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+namespace gc {
+namespace accounting {
+
+class AtomicStackTest : public CommonRuntimeTest {};
+
+// Fake, never dereferenced, object addresses that fit in a StackReference.
+static mirror::Object* FakeObject(size_t i) {
+  return reinterpret_cast<mirror::Object*>((i + 1) * kObjectAlignment);
+}
+
+TEST_F(AtomicStackTest, Stealable) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::unique_ptr<ObjectStack> stack(ObjectStack::Create("test stack", 4, 4));
+  EXPECT_TRUE(stack->IsEmptyStealable());
+  EXPECT_EQ(stack->PopBackStealable(), nullptr);
+  EXPECT_EQ(stack->StealFront(), nullptr);
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_TRUE(stack->PushBackStealable(FakeObject(i)));
+  }
+  // Overflow.
+  EXPECT_FALSE(stack->PushBackStealable(FakeObject(4)));
+  EXPECT_FALSE(stack->IsEmptyStealable());
+  // The owner pops the newest items and the thieves take the oldest ones.
+  EXPECT_EQ(stack->PopBackStealable(), FakeObject(3));
+  EXPECT_EQ(stack->StealFront(), FakeObject(0));
+  EXPECT_EQ(stack->StealFront(), FakeObject(1));
+  EXPECT_EQ(stack->PopBackStealable(), FakeObject(2));
+  EXPECT_TRUE(stack->IsEmptyStealable());
+  EXPECT_EQ(stack->PopBackStealable(), nullptr);
+  EXPECT_EQ(stack->StealFront(), nullptr);
+  EXPECT_TRUE(stack->IsEmpty());
+}
+
+TEST_F(AtomicStackTest, ConcurrentSteal) {
+  ScopedObjectAccess soa(Thread::Current());
+  static constexpr size_t kNumItems = 64 * KB;
+  static constexpr size_t kNumThieves = 4;
+  std::unique_ptr<ObjectStack> stack(ObjectStack::Create("test stack", kNumItems, kNumItems));
+  // Count how many times each item was taken. Every item must be taken exactly once.
+  std::unique_ptr<Atomic<uint32_t>[]> taken(new Atomic<uint32_t>[kNumItems]);
+  for (size_t i = 0; i < kNumItems; ++i) {
+    taken[i].StoreRelaxed(0);
+  }
+  auto take = [&](mirror::Object* obj) {
+    size_t i = reinterpret_cast<uintptr_t>(obj) / kObjectAlignment - 1;
+    ASSERT_LT(i, kNumItems);
+    taken[i].FetchAndAddSequentiallyConsistent(1);
+  };
+  Atomic<bool> done(false);
+  std::vector<std::thread> thieves;
+  for (size_t t = 0; t < kNumThieves; ++t) {
+    thieves.emplace_back([&]() NO_THREAD_SAFETY_ANALYSIS {
+      while (!done.LoadSequentiallyConsistent() || !stack->IsEmptyStealable()) {
+        mirror::Object* obj = stack->StealFront();
+        if (obj != nullptr) {
+          take(obj);
+        }
+      }
+    });
+  }
+  for (size_t i = 0; i < kNumItems; ++i) {
+    ASSERT_TRUE(stack->PushBackStealable(FakeObject(i)));
+    if (i % 3 == 0) {
+      mirror::Object* obj = stack->PopBackStealable();
+      if (obj != nullptr) {
+        take(obj);
+      }
+    }
+  }
+  mirror::Object* obj;
+  while ((obj = stack->PopBackStealable()) != nullptr) {
+    take(obj);
+  }
+  done.StoreSequentiallyConsistent(true);
+  for (std::thread& thief : thieves) {
+    thief.join();
+  }
+  for (size_t i = 0; i < kNumItems; ++i) {
+    EXPECT_EQ(taken[i].LoadRelaxed(), 1u) << i;
+  }
+}
+
+}  // namespace accounting
+}  // namespace gc
+}  // namespace art
@@ -333,6 +333,14 @@ class EmptyMarkObjectVisitor : public MarkObjectVisitor {
   void MarkHeapReference(mirror::HeapReference<mirror::Object>*, bool) OVERRIDE {}
 };
 
+void ModUnionTable::ClearAgedCards() {
+  CardTable* const card_table = GetHeap()->GetCardTable();
+  auto clear_aged_card = [](uint8_t card) {
+    return (card == CardTable::kCardAged) ? CardTable::kCardClean : card;
+  };
+  card_table->ModifyCardsAtomic(space_->Begin(), space_->End(), clear_aged_card, VoidFunctor());
+}
+
 void ModUnionTable::FilterCards() {
   EmptyMarkObjectVisitor visitor;
   // Use empty visitor since filtering is automatically done by UpdateAndMarkReferences.
@@ -68,6 +68,10 @@ class ModUnionTable {
   // references to track.
   virtual void ProcessCards() = 0;
 
+  // Clear the cards of the space which a previous ProcessCards aged after recording them in the
+  // table. Cards dirtied since then are left dirty, so this may run concurrently with mutators.
+  void ClearAgedCards();
+
   // Set all the cards.
   virtual void SetCards() = 0;
 
@@ -232,6 +232,13 @@ void ModUnionTableTest::RunTest(ModUnionTableFactory::TableType type) {
   // been removed from the mod union table during UpdateAndMarkReferences.
   ASSERT_FALSE(table->ContainsCardFor(reinterpret_cast<uintptr_t>(obj3)));
   ASSERT_FALSE(table->ContainsCardFor(reinterpret_cast<uintptr_t>(obj4)));
+  // Cards aged by ProcessCards get cleared, cards dirtied since then stay dirty.
+  CardTable* const card_table = heap->GetCardTable();
+  EXPECT_EQ(card_table->GetCard(obj3), CardTable::kCardAged);
+  obj4->Set(0, obj2);
+  table->ClearAgedCards();
+  EXPECT_EQ(card_table->GetCard(obj3), CardTable::kCardClean);
+  EXPECT_EQ(card_table->GetCard(obj4), CardTable::kCardDirty);
   {
     // Currently no-op, make sure it still works however.
     ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
@@ -120,7 +120,15 @@ inline void SpaceBitmap<kAlignment>::VisitMarkedRange(uintptr_t visit_begin,
     // Traverse the middle, full part.
     for (size_t i = index_start + 1; i < index_end; ++i) {
       uintptr_t w = bitmap_begin_[i].LoadRelaxed();
-      if (w != 0) {
+      if (w == 0) {
+        // Skip runs of clear words four at a time, with one branch per block, which is most of
+        // the work in sparse bitmaps.
+        while (i + 4 < index_end &&
+               (bitmap_begin_[i + 1].LoadRelaxed() | bitmap_begin_[i + 2].LoadRelaxed() |
+                bitmap_begin_[i + 3].LoadRelaxed() | bitmap_begin_[i + 4].LoadRelaxed()) == 0) {
+          i += 4;
+        }
+      } else {
         const uintptr_t ptr_base = IndexToOffset(i) + heap_begin_;
         // Iterate on the bits set in word `w`, from the least to the most significant bit.
         do {
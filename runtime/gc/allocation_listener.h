@@ -41,6 +41,13 @@ class AllocationListener {
 
   virtual void ObjectAllocated(Thread* self, ObjPtr<mirror::Object>* obj, size_t byte_count)
       REQUIRES_SHARED(Locks::mutator_lock_) = 0;
+
+  // Called after ObjectAllocated for the allocations picked by heap sampling, see
+  // Heap::SetAllocationSamplingInterval.
+  virtual void ObjectSampled(Thread* self ATTRIBUTE_UNUSED,
+                             ObjPtr<mirror::Object>* obj ATTRIBUTE_UNUSED,
+                             size_t byte_count ATTRIBUTE_UNUSED)
+      REQUIRES_SHARED(Locks::mutator_lock_) {}
 };
 
 }  // namespace gc
@@ -92,6 +92,20 @@ void AllocRecordObjectMap::SetProperties() {
       max_stack_depth_ = value;
     }
   }
+  // Check whether there's a system property asking to only record sampled allocations, see
+  // Heap::SetAllocationSamplingInterval.
+  propertyName = "dalvik.vm.allocTrackerSampleInterval";
+  char sampleIntervalString[PROPERTY_VALUE_MAX];
+  if (property_get(propertyName, sampleIntervalString, "") > 0) {
+    char* end;
+    size_t value = strtoul(sampleIntervalString, &end, 10);
+    if (*end != '\0') {
+      LOG(ERROR) << "Ignoring  " << propertyName << " '" << sampleIntervalString
+                 << "' --- invalid";
+    } else {
+      Runtime::Current()->GetHeap()->SetAllocationSamplingInterval(value);
+    }
+  }
 #endif  // ART_TARGET_ANDROID
 }
 
@@ -105,16 +119,16 @@ void AllocRecordObjectMap::VisitRoots(RootVisitor* visitor) {
   size_t count = recent_record_max_;
   // Only visit the last recent_record_max_ number of allocation records in entries_ and mark the
   // klass_ fields as strong roots.
-  for (auto it = entries_.rbegin(), end = entries_.rend(); it != end; ++it) {
-    AllocRecord& record = it->second;
-    if (count > 0) {
-      buffered_visitor.VisitRootIfNonNull(record.GetClassGcRoot());
-      --count;
-    }
-    // Visit all of the stack frames to make sure no methods in the stack traces get unloaded by
-    // class unloading.
-    for (size_t i = 0, depth = record.GetDepth(); i < depth; ++i) {
-      const AllocRecordStackTraceElement& element = record.StackElement(i);
+  for (auto it = entries_.rbegin(), end = entries_.rend(); it != end && count > 0; ++it) {
+    buffered_visitor.VisitRootIfNonNull(it->second.GetClassGcRoot());
+    --count;
+  }
+  // Visit all of the stack frames to make sure no methods in the stack traces get unloaded by
+  // class unloading. Records share their traces, visit each of them once.
+  for (const auto& pair : stack_traces_) {
+    const AllocRecordStackTrace* trace = pair.first;
+    for (size_t i = 0, depth = trace->GetDepth(); i < depth; ++i) {
+      const AllocRecordStackTraceElement& element = trace->GetStackElement(i);
       DCHECK(element.GetMethod() != nullptr);
       element.GetMethod()->VisitRoots(buffered_visitor, kRuntimePointerSize);
     }
@@ -155,6 +169,7 @@ void AllocRecordObjectMap::SweepAllocationRecords(IsMarkedVisitor* visitor) {
         SweepClassObject(&record, visitor);
         ++it;
       } else {
+        ReleaseStackTrace(record.GetStackTrace());
         it = entries_.erase(it);
         ++count_deleted;
       }
@@ -169,16 +184,15 @@ void AllocRecordObjectMap::SweepAllocationRecords(IsMarkedVisitor* visitor) {
   }
   VLOG(heap) << "Deleted " << count_deleted << " allocation records";
   VLOG(heap) << "Updated " << count_moved << " allocation records";
+  VLOG(heap) << "Sharing " << stack_traces_.size() << " stack traces";
 }
 
 void AllocRecordObjectMap::AllowNewAllocationRecords() {
-  CHECK(!kUseReadBarrier);
   allow_new_record_ = true;
   new_record_condition_.Broadcast(Thread::Current());
 }
 
 void AllocRecordObjectMap::DisallowNewAllocationRecords() {
-  CHECK(!kUseReadBarrier);
   allow_new_record_ = false;
 }
 
@@ -289,9 +303,10 @@ void AllocRecordObjectMap::RecordAllocation(Thread* self,
     return;
   }
 
-  // Wait for GC's sweeping to complete and allow new records.
-  while (UNLIKELY((!kUseReadBarrier && !allow_new_record_) ||
-                  (kUseReadBarrier && !self->GetWeakRefAccessEnabled()))) {
+  // Wait for GC's sweeping to complete and allow new records. With the read barrier, records can
+  // also be added while the thread-local weak ref access flag is set.
+  while (UNLIKELY(!allow_new_record_ &&
+                  (!kUseReadBarrier || !self->GetWeakRefAccessEnabled()))) {
     // Check and run the empty checkpoint before blocking so the empty checkpoint will work in the
     // presence of threads blocking for weak ref access.
     self->CheckEmptyCheckpointFromWeakRefAccess(Locks::alloc_tracker_lock_);
@@ -310,12 +325,40 @@ void AllocRecordObjectMap::RecordAllocation(Thread* self,
   trace.SetTid(self->GetTid());
 
   // Add the record.
-  Put(obj->Ptr(), AllocRecord(byte_count, (*obj)->GetClass(), std::move(trace)));
+  Put(obj->Ptr(),
+      AllocRecord(byte_count, (*obj)->GetClass(), InternStackTrace(std::move(trace))));
   DCHECK_LE(Size(), alloc_record_max_);
 }
 
+const AllocRecordStackTrace* AllocRecordObjectMap::InternStackTrace(
+    AllocRecordStackTrace&& trace) {
+  auto it = stack_traces_.find(&trace);
+  if (it != stack_traces_.end()) {
+    ++it->second;
+    return it->first;
+  }
+  const AllocRecordStackTrace* interned = new AllocRecordStackTrace(std::move(trace));
+  stack_traces_.emplace(interned, 1u);
+  return interned;
+}
+
+void AllocRecordObjectMap::ReleaseStackTrace(const AllocRecordStackTrace* trace) {
+  auto it = stack_traces_.find(trace);
+  DCHECK(it != stack_traces_.end());
+  DCHECK_EQ(it->first, trace);
+  DCHECK_GT(it->second, 0u);
+  if (--it->second == 0u) {
+    stack_traces_.erase(it);
+    delete trace;
+  }
+}
+
 void AllocRecordObjectMap::Clear() {
   entries_.clear();
+  for (const auto& pair : stack_traces_) {
+    delete pair.first;
+  }
+  stack_traces_.clear();
 }
 
 AllocRecordObjectMap::AllocRecordObjectMap()
@@ -19,6 +19,7 @@
 
 #include <list>
 #include <memory>
+#include <unordered_map>
 
 #include "base/mutex.h"
 #include "gc_root.h"
@@ -155,16 +156,17 @@ template <typename T> struct EqAllocRecordTypesPtr {
 
 class AllocRecord {
  public:
-  // All instances of AllocRecord should be managed by an instance of AllocRecordObjectMap.
-  AllocRecord(size_t count, mirror::Class* klass, AllocRecordStackTrace&& trace)
-      : byte_count_(count), klass_(klass), trace_(std::move(trace)) {}
+  // All instances of AllocRecord should be managed by an instance of AllocRecordObjectMap, which
+  // also owns the interned stack trace.
+  AllocRecord(size_t count, mirror::Class* klass, const AllocRecordStackTrace* trace)
+      : byte_count_(count), klass_(klass), trace_(trace) {}
 
   size_t GetDepth() const {
-    return trace_.GetDepth();
+    return trace_->GetDepth();
   }
 
   const AllocRecordStackTrace* GetStackTrace() const {
-    return &trace_;
+    return trace_;
   }
 
   size_t ByteCount() const {
@@ -172,7 +174,7 @@ class AllocRecord {
   }
 
   pid_t GetTid() const {
-    return trace_.GetTid();
+    return trace_->GetTid();
   }
 
   mirror::Class* GetClass() const REQUIRES_SHARED(Locks::mutator_lock_) {
@@ -187,15 +189,15 @@ class AllocRecord {
   }
 
   const AllocRecordStackTraceElement& StackElement(size_t index) const {
-    return trace_.GetStackElement(index);
+    return trace_->GetStackElement(index);
   }
 
  private:
   const size_t byte_count_;
   // The klass_ could be a strong or weak root for GC
   GcRoot<mirror::Class> klass_;
-  // TODO: Share between alloc records with identical stack traces.
-  AllocRecordStackTrace trace_;
+  // Shared between alloc records with identical stack traces.
+  const AllocRecordStackTrace* trace_;
 };
 
 class AllocRecordObjectMap {
@@ -225,6 +227,7 @@ class AllocRecordObjectMap {
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(Locks::alloc_tracker_lock_) {
     if (entries_.size() == alloc_record_max_) {
+      ReleaseStackTrace(entries_.front().second.GetStackTrace());
       entries_.pop_front();
     }
     entries_.push_back(EntryPair(GcRoot<mirror::Object>(obj), std::move(record)));
@@ -234,6 +237,11 @@ class AllocRecordObjectMap {
     return entries_.size();
   }
 
+  // Number of distinct stack traces shared by the records.
+  size_t NumStackTraces() const REQUIRES_SHARED(Locks::alloc_tracker_lock_) {
+    return stack_traces_.size();
+  }
+
   size_t GetRecentAllocationSize() const REQUIRES_SHARED(Locks::alloc_tracker_lock_) {
     CHECK_LE(recent_record_max_, alloc_record_max_);
     size_t sz = entries_.size();
@@ -290,6 +298,13 @@ class AllocRecordObjectMap {
 
   void Clear() REQUIRES(Locks::alloc_tracker_lock_);
 
+  // Return the shared copy of the trace, which stays valid until the last record using it is
+  // released with ReleaseStackTrace.
+  const AllocRecordStackTrace* InternStackTrace(AllocRecordStackTrace&& trace)
+      REQUIRES(Locks::alloc_tracker_lock_);
+  void ReleaseStackTrace(const AllocRecordStackTrace* trace)
+      REQUIRES(Locks::alloc_tracker_lock_);
+
  private:
   static constexpr size_t kDefaultNumAllocRecords = 512 * 1024;
   static constexpr size_t kDefaultNumRecentRecords = 64 * 1024 - 1;
@@ -303,6 +318,12 @@ class AllocRecordObjectMap {
   ConditionVariable new_record_condition_ GUARDED_BY(Locks::alloc_tracker_lock_);
   // see the comment in typedef of EntryList
   EntryList entries_ GUARDED_BY(Locks::alloc_tracker_lock_);
+  // The interned stack traces of the records in entries_, with the number of records using them.
+  std::unordered_map<const AllocRecordStackTrace*,
+                     size_t,
+                     HashAllocRecordTypesPtr<AllocRecordStackTrace>,
+                     EqAllocRecordTypesPtr<AllocRecordStackTrace>> stack_traces_
+      GUARDED_BY(Locks::alloc_tracker_lock_);
 
   void SetProperties() REQUIRES(Locks::alloc_tracker_lock_);
 };
@@ -16,6 +16,7 @@
 
 #include "rosalloc.h"
 
+#include <algorithm>
 #include <list>
 #include <map>
 #include <sstream>
@@ -1095,107 +1096,121 @@ size_t RosAlloc::BulkFree(Thread* self, void** ptrs, size_t num_ptrs) {
   // Now, iterate over the affected runs and update the alloc bit map
   // based on the bulk free bit map (for non-thread-local runs) and
   // union the bulk free bit map into the thread-local free bit map
-  // (for thread-local runs.)
-  for (Run* run : runs) {
+  // (for thread-local runs.) The runs are visited in size bracket order
+  // so that each size bracket lock is acquired once per bracket rather
+  // than once per run, which keeps the GC from repeatedly contending
+  // with the mutators that allocate from the shared runs.
 #ifdef ART_TARGET_ANDROID
-    DCHECK(run->to_be_bulk_freed_);
-    run->to_be_bulk_freed_ = false;
+  std::vector<Run*>& sorted_runs = runs;
+#else
+  std::vector<Run*> sorted_runs(runs.begin(), runs.end());
 #endif
-    size_t idx = run->size_bracket_idx_;
+  std::sort(sorted_runs.begin(), sorted_runs.end(), [](Run* a, Run* b) {
+    return a->size_bracket_idx_ < b->size_bracket_idx_;
+  });
+  for (auto it = sorted_runs.begin(); it != sorted_runs.end(); ) {
+    const size_t idx = (*it)->size_bracket_idx_;
     MutexLock brackets_mu(self, *size_bracket_locks_[idx]);
-    if (run->IsThreadLocal()) {
-      DCHECK_LT(run->size_bracket_idx_, kNumThreadLocalSizeBrackets);
-      DCHECK(non_full_runs_[idx].find(run) == non_full_runs_[idx].end());
-      DCHECK(full_runs_[idx].find(run) == full_runs_[idx].end());
-      run->MergeBulkFreeListToThreadLocalFreeList();
-      if (kTraceRosAlloc) {
-        LOG(INFO) << "RosAlloc::BulkFree() : Freed slot(s) in a thread local run 0x"
-                  << std::hex << reinterpret_cast<intptr_t>(run);
-      }
-      DCHECK(run->IsThreadLocal());
-      // A thread local run will be kept as a thread local even if
-      // it's become all free.
-    } else {
-      bool run_was_full = run->IsFull();
-      run->MergeBulkFreeListToFreeList();
-      if (kTraceRosAlloc) {
-        LOG(INFO) << "RosAlloc::BulkFree() : Freed slot(s) in a run 0x" << std::hex
-                  << reinterpret_cast<intptr_t>(run);
-      }
-      // Check if the run should be moved to non_full_runs_ or
-      // free_page_runs_.
-      auto* non_full_runs = &non_full_runs_[idx];
-      auto* full_runs = kIsDebugBuild ? &full_runs_[idx] : nullptr;
-      if (run->IsAllFree()) {
-        // It has just become completely free. Free the pages of the
-        // run.
-        bool run_was_current = run == current_runs_[idx];
-        if (run_was_current) {
-          DCHECK(full_runs->find(run) == full_runs->end());
-          DCHECK(non_full_runs->find(run) == non_full_runs->end());
-          // If it was a current run, reuse it.
-        } else if (run_was_full) {
-          // If it was full, remove it from the full run set (debug
-          // only.)
-          if (kIsDebugBuild) {
-            std::unordered_set<Run*, hash_run, eq_run>::iterator pos = full_runs->find(run);
-            DCHECK(pos != full_runs->end());
-            full_runs->erase(pos);
+    for (; it != sorted_runs.end() && (*it)->size_bracket_idx_ == idx; ++it) {
+      Run* run = *it;
+#ifdef ART_TARGET_ANDROID
+      DCHECK(run->to_be_bulk_freed_);
+      run->to_be_bulk_freed_ = false;
+#endif
+      if (run->IsThreadLocal()) {
+        DCHECK_LT(run->size_bracket_idx_, kNumThreadLocalSizeBrackets);
+        DCHECK(non_full_runs_[idx].find(run) == non_full_runs_[idx].end());
+        DCHECK(full_runs_[idx].find(run) == full_runs_[idx].end());
+        run->MergeBulkFreeListToThreadLocalFreeList();
+        if (kTraceRosAlloc) {
+          LOG(INFO) << "RosAlloc::BulkFree() : Freed slot(s) in a thread local run 0x"
+                    << std::hex << reinterpret_cast<intptr_t>(run);
+        }
+        DCHECK(run->IsThreadLocal());
+        // A thread local run will be kept as a thread local even if
+        // it's become all free.
+      } else {
+        bool run_was_full = run->IsFull();
+        run->MergeBulkFreeListToFreeList();
+        if (kTraceRosAlloc) {
+          LOG(INFO) << "RosAlloc::BulkFree() : Freed slot(s) in a run 0x" << std::hex
+                    << reinterpret_cast<intptr_t>(run);
+        }
+        // Check if the run should be moved to non_full_runs_ or
+        // free_page_runs_.
+        auto* non_full_runs = &non_full_runs_[idx];
+        auto* full_runs = kIsDebugBuild ? &full_runs_[idx] : nullptr;
+        if (run->IsAllFree()) {
+          // It has just become completely free. Free the pages of the
+          // run.
+          bool run_was_current = run == current_runs_[idx];
+          if (run_was_current) {
+            DCHECK(full_runs->find(run) == full_runs->end());
+            DCHECK(non_full_runs->find(run) == non_full_runs->end());
+            // If it was a current run, reuse it.
+          } else if (run_was_full) {
+            // If it was full, remove it from the full run set (debug
+            // only.)
+            if (kIsDebugBuild) {
+              std::unordered_set<Run*, hash_run, eq_run>::iterator pos = full_runs->find(run);
+              DCHECK(pos != full_runs->end());
+              full_runs->erase(pos);
+              if (kTraceRosAlloc) {
+                LOG(INFO) << "RosAlloc::BulkFree() : Erased run 0x" << std::hex
+                          << reinterpret_cast<intptr_t>(run)
+                          << " from full_runs_";
+              }
+              DCHECK(full_runs->find(run) == full_runs->end());
+            }
+          } else {
+            // If it was in a non full run set, remove it from the set.
+            DCHECK(full_runs->find(run) == full_runs->end());
+            DCHECK(non_full_runs->find(run) != non_full_runs->end());
+            non_full_runs->erase(run);
             if (kTraceRosAlloc) {
               LOG(INFO) << "RosAlloc::BulkFree() : Erased run 0x" << std::hex
                         << reinterpret_cast<intptr_t>(run)
-                        << " from full_runs_";
+                        << " from non_full_runs_";
             }
-            DCHECK(full_runs->find(run) == full_runs->end());
+            DCHECK(non_full_runs->find(run) == non_full_runs->end());
           }
-        } else {
-          // If it was in a non full run set, remove it from the set.
-          DCHECK(full_runs->find(run) == full_runs->end());
-          DCHECK(non_full_runs->find(run) != non_full_runs->end());
-          non_full_runs->erase(run);
-          if (kTraceRosAlloc) {
-            LOG(INFO) << "RosAlloc::BulkFree() : Erased run 0x" << std::hex
-                      << reinterpret_cast<intptr_t>(run)
-                      << " from non_full_runs_";
+          if (!run_was_current) {
+            run->ZeroHeaderAndSlotHeaders();
+            MutexLock lock_mu(self, lock_);
+            FreePages(self, run, true);
           }
-          DCHECK(non_full_runs->find(run) == non_full_runs->end());
-        }
-        if (!run_was_current) {
-          run->ZeroHeaderAndSlotHeaders();
-          MutexLock lock_mu(self, lock_);
-          FreePages(self, run, true);
-        }
-      } else {
-        // It is not completely free. If it wasn't the current run or
-        // already in the non-full run set (i.e., it was full) insert
-        // it into the non-full run set.
-        if (run == current_runs_[idx]) {
-          DCHECK(non_full_runs->find(run) == non_full_runs->end());
-          DCHECK(full_runs->find(run) == full_runs->end());
-          // If it was a current run, keep it.
-        } else if (run_was_full) {
-          // If it was full, remove it from the full run set (debug
-          // only) and insert into the non-full run set.
-          DCHECK(full_runs->find(run) != full_runs->end());
-          DCHECK(non_full_runs->find(run) == non_full_runs->end());
-          if (kIsDebugBuild) {
-            full_runs->erase(run);
+        } else {
+          // It is not completely free. If it wasn't the current run or
+          // already in the non-full run set (i.e., it was full) insert
+          // it into the non-full run set.
+          if (run == current_runs_[idx]) {
+            DCHECK(non_full_runs->find(run) == non_full_runs->end());
+            DCHECK(full_runs->find(run) == full_runs->end());
+            // If it was a current run, keep it.
+          } else if (run_was_full) {
+            // If it was full, remove it from the full run set (debug
+            // only) and insert into the non-full run set.
+            DCHECK(full_runs->find(run) != full_runs->end());
+            DCHECK(non_full_runs->find(run) == non_full_runs->end());
+            if (kIsDebugBuild) {
+              full_runs->erase(run);
+              if (kTraceRosAlloc) {
+                LOG(INFO) << "RosAlloc::BulkFree() : Erased run 0x" << std::hex
+                          << reinterpret_cast<intptr_t>(run)
+                          << " from full_runs_";
+              }
+            }
+            non_full_runs->insert(run);
             if (kTraceRosAlloc) {
-              LOG(INFO) << "RosAlloc::BulkFree() : Erased run 0x" << std::hex
+              LOG(INFO) << "RosAlloc::BulkFree() : Inserted run 0x" << std::hex
                         << reinterpret_cast<intptr_t>(run)
-                        << " from full_runs_";
+                        << " into non_full_runs_[" << std::dec << idx;
             }
+          } else {
+            // If it was not full, so leave it in the non full run set.
+            DCHECK(full_runs->find(run) == full_runs->end());
+            DCHECK(non_full_runs->find(run) != non_full_runs->end());
           }
-          non_full_runs->insert(run);
-          if (kTraceRosAlloc) {
-            LOG(INFO) << "RosAlloc::BulkFree() : Inserted run 0x" << std::hex
-                      << reinterpret_cast<intptr_t>(run)
-                      << " into non_full_runs_[" << std::dec << idx;
-          }
-        } else {
-          // If it was not full, so leave it in the non full run set.
-          DCHECK(full_runs->find(run) == full_runs->end());
-          DCHECK(non_full_runs->find(run) != non_full_runs->end());
         }
       }
     }
@@ -1627,11 +1642,11 @@ void RosAlloc::Initialize() {
   static_assert(kNumRegularSizeBrackets == kNumOfSizeBrackets - 2,
                 "There should be two non-regular brackets");
   for (size_t i = 0; i < kNumOfSizeBrackets; i++) {
-    if (i < kNumThreadLocalSizeBrackets) {
+    if (i < kNumFineSizeBrackets) {
       bracketSizes[i] = kThreadLocalBracketQuantumSize * (i + 1);
     } else if (i < kNumRegularSizeBrackets) {
-      bracketSizes[i] = kBracketQuantumSize * (i - kNumThreadLocalSizeBrackets + 1) +
-          (kThreadLocalBracketQuantumSize *  kNumThreadLocalSizeBrackets);
+      bracketSizes[i] = kBracketQuantumSize * (i - kNumFineSizeBrackets + 1) +
+          (kThreadLocalBracketQuantumSize *  kNumFineSizeBrackets);
     } else if (i == kNumOfSizeBrackets - 2) {
       bracketSizes[i] = 1 * KB;
     } else {
@@ -1644,9 +1659,9 @@ void RosAlloc::Initialize() {
   }
   // numOfPages.
   for (size_t i = 0; i < kNumOfSizeBrackets; i++) {
-    if (i < kNumThreadLocalSizeBrackets) {
+    if (i < kNumFineSizeBrackets) {
       numOfPages[i] = 1;
-    } else if (i < (kNumThreadLocalSizeBrackets + kNumRegularSizeBrackets) / 2) {
+    } else if (i < (kNumFineSizeBrackets + kNumRegularSizeBrackets) / 2) {
       numOfPages[i] = 1;
     } else if (i < kNumRegularSizeBrackets) {
       numOfPages[i] = 1;
@@ -1715,6 +1730,7 @@ void RosAlloc::Initialize() {
   // The smallest bracket size must be at least as large as the sizeof(Slot).
   DCHECK_LE(sizeof(Slot), bracketSizes[0]) << "sizeof(Slot) <= the smallest bracket size";
   // Check the invariants between the max bracket sizes and the number of brackets.
+  DCHECK_EQ(kMaxFineBracketSize, bracketSizes[kNumFineSizeBrackets - 1]);
   DCHECK_EQ(kMaxThreadLocalBracketSize, bracketSizes[kNumThreadLocalSizeBrackets - 1]);
   DCHECK_EQ(kMaxRegularBracketSize, bracketSizes[kNumRegularSizeBrackets - 1]);
 }
@@ -1994,29 +2010,11 @@ size_t RosAlloc::ReleasePages() {
         // Fall through.
       case kPageMapEmpty: {
         // This is currently the start of a free page run.
-        // Acquire the lock to prevent other threads racing in and modifying the page map.
-        MutexLock mu(self, lock_);
-        // Check that it's still empty after we acquired the lock since another thread could have
-        // raced in and placed an allocation here.
-        if (IsFreePage(i)) {
-          // Free page runs can start with a released page if we coalesced a released page free
-          // page run with an empty page run.
-          FreePageRun* fpr = reinterpret_cast<FreePageRun*>(base_ + i * kPageSize);
-          // There is a race condition where FreePage can coalesce fpr with the previous
-          // free page run before we acquire lock_. In that case free_page_runs_.find will not find
-          // a run starting at fpr. To handle this race, we skip reclaiming the page range and go
-          // to the next page.
-          if (free_page_runs_.find(fpr) != free_page_runs_.end()) {
-            size_t fpr_size = fpr->ByteSize(this);
-            DCHECK_ALIGNED(fpr_size, kPageSize);
-            uint8_t* start = reinterpret_cast<uint8_t*>(fpr);
-            reclaimed_bytes += ReleasePageRange(start, start + fpr_size);
-            size_t pages = fpr_size / kPageSize;
-            CHECK_GT(pages, 0U) << "Infinite loop probable";
-            i += pages;
-            DCHECK_LE(i, page_map_size_);
-            break;
-          }
+        size_t pages = ReleaseFreePageRun(self, i, &reclaimed_bytes);
+        if (pages != 0u) {
+          i += pages;
+          DCHECK_LE(i, page_map_size_);
+          break;
         }
         FALLTHROUGH_INTENDED;
       }
@@ -2034,6 +2032,45 @@ size_t RosAlloc::ReleasePages() {
   return reclaimed_bytes;
 }
 
+size_t RosAlloc::ReleaseFreePageRun(Thread* self, size_t idx, size_t* reclaimed_bytes) {
+  FreePageRun* fpr = reinterpret_cast<FreePageRun*>(base_ + idx * kPageSize);
+  size_t released_size = 0;
+  while (true) {
+    // Acquire the lock to prevent other threads racing in and modifying the page map.
+    MutexLock mu(self, lock_);
+    // Check that it's still free after we acquired the lock since another thread could have
+    // raced in and placed an allocation here, before the first batch or between two batches.
+    // Free page runs can start with a released page if we coalesced a released page free
+    // page run with an empty page run.
+    //
+    // There is a race condition where FreePage can coalesce fpr with the previous
+    // free page run while we do not hold lock_. In that case free_page_runs_.find will not find
+    // a run starting at fpr. To handle this race, we skip reclaiming the rest of the run.
+    if (!IsFreePage(idx) || free_page_runs_.find(fpr) == free_page_runs_.end()) {
+      return released_size / kPageSize;
+    }
+    // The run may also have been coalesced with the next free page run in the meantime.
+    size_t fpr_size = fpr->ByteSize(this);
+    DCHECK_ALIGNED(fpr_size, kPageSize);
+    DCHECK_LT(released_size, fpr_size);
+    uint8_t* start = reinterpret_cast<uint8_t*>(fpr);
+    size_t batch_end = std::min(fpr_size, released_size + kReleasePagesBatchSize * kPageSize);
+    // In debug builds, ReleasePageRange() keeps the first page of the range, which holds the
+    // magic number of the run. Start the later batches one page early to still release it.
+    uint8_t* batch_begin = start + released_size;
+    if (kIsDebugBuild && released_size != 0u) {
+      batch_begin -= kPageSize;
+    }
+    *reclaimed_bytes += ReleasePageRange(batch_begin, start + batch_end);
+    released_size = batch_end;
+    if (released_size == fpr_size) {
+      size_t pages = fpr_size / kPageSize;
+      CHECK_GT(pages, 0U) << "Infinite loop probable";
+      return pages;
+    }
+  }
+}
+
 size_t RosAlloc::ReleasePageRange(uint8_t* start, uint8_t* end) {
   DCHECK_ALIGNED(start, kPageSize);
   DCHECK_ALIGNED(end, kPageSize);
@@ -2048,22 +2085,35 @@ size_t RosAlloc::ReleasePageRange(uint8_t* start, uint8_t* end) {
       return 0;
     }
   }
-  if (!kMadviseZeroes) {
-    // TODO: Do this when we resurrect the page instead.
-    memset(start, 0, end - start);
-  }
-  CHECK_EQ(madvise(start, end - start, MADV_DONTNEED), 0);
   size_t pm_idx = ToPageMapIndex(start);
   size_t reclaimed_bytes = 0;
-  // Calculate reclaimed bytes and upate page map.
+  // Only madvise the pages which are not released yet. Released pages are not resident unless
+  // they have been written to since, which would have made them empty again, so skipping them
+  // saves the system calls and, without kMadviseZeroes, faulting them back in to zero them.
   const size_t max_idx = pm_idx + (end - start) / kPageSize;
-  for (; pm_idx < max_idx; ++pm_idx) {
+  while (pm_idx < max_idx) {
     DCHECK(IsFreePage(pm_idx));
-    if (page_map_[pm_idx] == kPageMapEmpty) {
-      // Mark the page as released and update how many bytes we released.
-      reclaimed_bytes += kPageSize;
+    if (page_map_[pm_idx] != kPageMapEmpty) {
+      ++pm_idx;
+      continue;
+    }
+    size_t range_end_idx = pm_idx + 1;
+    while (range_end_idx < max_idx && page_map_[range_end_idx] == kPageMapEmpty) {
+      ++range_end_idx;
+    }
+    uint8_t* range_begin = base_ + pm_idx * kPageSize;
+    size_t range_size = (range_end_idx - pm_idx) * kPageSize;
+    if (!kMadviseZeroes) {
+      // TODO: Do this when we resurrect the page instead.
+      memset(range_begin, 0, range_size);
+    }
+    CHECK_EQ(madvise(range_begin, range_size, MADV_DONTNEED), 0);
+    // Mark the pages as released and update how many bytes we released.
+    for (; pm_idx < range_end_idx; ++pm_idx) {
+      DCHECK(IsFreePage(pm_idx));
       page_map_[pm_idx] = kPageMapReleased;
     }
+    reclaimed_bytes += range_size;
   }
   return reclaimed_bytes;
 }
@@ -516,7 +516,7 @@ class RosAlloc {
   // Returns the index of the size bracket from the bracket size.
   static size_t BracketSizeToIndex(size_t size) {
     DCHECK(8 <= size &&
-           ((size <= kMaxThreadLocalBracketSize && size % kThreadLocalBracketQuantumSize == 0) ||
+           ((size <= kMaxFineBracketSize && size % kThreadLocalBracketQuantumSize == 0) ||
             (size <= kMaxRegularBracketSize && size % kBracketQuantumSize == 0) ||
             size == 1 * KB || size == 2 * KB));
     size_t idx;
@@ -524,14 +524,14 @@ class RosAlloc {
       idx = kNumOfSizeBrackets - 2;
     } else if (UNLIKELY(size == 2 * KB)) {
       idx = kNumOfSizeBrackets - 1;
-    } else if (LIKELY(size <= kMaxThreadLocalBracketSize)) {
+    } else if (LIKELY(size <= kMaxFineBracketSize)) {
       DCHECK_EQ(size % kThreadLocalBracketQuantumSize, 0U);
       idx = size / kThreadLocalBracketQuantumSize - 1;
     } else {
       DCHECK(size <= kMaxRegularBracketSize);
-      DCHECK_EQ((size - kMaxThreadLocalBracketSize) % kBracketQuantumSize, 0U);
-      idx = ((size - kMaxThreadLocalBracketSize) / kBracketQuantumSize - 1)
-          + kNumThreadLocalSizeBrackets;
+      DCHECK_EQ((size - kMaxFineBracketSize) % kBracketQuantumSize, 0U);
+      idx = ((size - kMaxFineBracketSize) / kBracketQuantumSize - 1)
+          + kNumFineSizeBrackets;
     }
     DCHECK(bracketSizes[idx] == size);
     return idx;
@@ -546,7 +546,7 @@ class RosAlloc {
   // Rounds up the size up the nearest bracket size.
   static size_t RoundToBracketSize(size_t size) {
     DCHECK(size <= kLargeSizeThreshold);
-    if (LIKELY(size <= kMaxThreadLocalBracketSize)) {
+    if (LIKELY(size <= kMaxFineBracketSize)) {
       return RoundUp(size, kThreadLocalBracketQuantumSize);
     } else if (size <= kMaxRegularBracketSize) {
       return RoundUp(size, kBracketQuantumSize);
@@ -560,11 +560,11 @@ class RosAlloc {
   // Returns the size bracket index from the byte size with rounding.
   static size_t SizeToIndex(size_t size) {
     DCHECK(size <= kLargeSizeThreshold);
-    if (LIKELY(size <= kMaxThreadLocalBracketSize)) {
+    if (LIKELY(size <= kMaxFineBracketSize)) {
       return RoundUp(size, kThreadLocalBracketQuantumSize) / kThreadLocalBracketQuantumSize - 1;
     } else if (size <= kMaxRegularBracketSize) {
-      return (RoundUp(size, kBracketQuantumSize) - kMaxThreadLocalBracketSize) / kBracketQuantumSize
-          - 1 + kNumThreadLocalSizeBrackets;
+      return (RoundUp(size, kBracketQuantumSize) - kMaxFineBracketSize) / kBracketQuantumSize
+          - 1 + kNumFineSizeBrackets;
     } else if (size <= 1 * KB) {
       return kNumOfSizeBrackets - 2;
     } else {
@@ -577,13 +577,13 @@ class RosAlloc {
     DCHECK(size <= kLargeSizeThreshold);
     size_t idx;
     size_t bracket_size;
-    if (LIKELY(size <= kMaxThreadLocalBracketSize)) {
+    if (LIKELY(size <= kMaxFineBracketSize)) {
       bracket_size = RoundUp(size, kThreadLocalBracketQuantumSize);
       idx = bracket_size / kThreadLocalBracketQuantumSize - 1;
     } else if (size <= kMaxRegularBracketSize) {
       bracket_size = RoundUp(size, kBracketQuantumSize);
-      idx = ((bracket_size - kMaxThreadLocalBracketSize) / kBracketQuantumSize - 1)
-          + kNumThreadLocalSizeBrackets;
+      idx = ((bracket_size - kMaxFineBracketSize) / kBracketQuantumSize - 1)
+          + kNumFineSizeBrackets;
     } else if (size <= 1 * KB) {
       bracket_size = 1 * KB;
       idx = kNumOfSizeBrackets - 2;
@@ -597,7 +597,7 @@ class RosAlloc {
     DCHECK_EQ(bracket_size, bracketSizes[idx]) << idx;
     DCHECK_LE(size, bracket_size) << idx;
     DCHECK(size > kMaxRegularBracketSize ||
-           (size <= kMaxThreadLocalBracketSize &&
+           (size <= kMaxFineBracketSize &&
             bracket_size - size < kThreadLocalBracketQuantumSize) ||
            (size <= kMaxRegularBracketSize && bracket_size - size < kBracketQuantumSize)) << idx;
     *bracket_size_out = bracket_size;
@@ -659,17 +659,32 @@ class RosAlloc {
   // The default value for page_release_size_threshold_.
   static constexpr size_t kDefaultPageReleaseSizeThreshold = 4 * MB;
 
+  // ReleasePages() releases large free page runs in batches of at most this many pages,
+  // dropping lock_ in between, so that it does not hold off allocations for long.
+  static constexpr size_t kReleasePagesBatchSize = 256;
+
   // We use thread-local runs for the size brackets whose indexes
   // are less than this index. We use shared (current) runs for the rest.
   // Sync this with the length of Thread::rosalloc_runs_.
-  static const size_t kNumThreadLocalSizeBrackets = 16;
+  static const size_t kNumThreadLocalSizeBrackets = 24;
   static_assert(kNumThreadLocalSizeBrackets == kNumRosAllocThreadLocalSizeBracketsInThread,
                 "Mismatch between kNumThreadLocalSizeBrackets and "
                 "kNumRosAllocThreadLocalSizeBracketsInThread");
 
   // The size of the largest bracket we use thread-local runs for.
   // This should be equal to bracketSizes[kNumThreadLocalSizeBrackets - 1].
-  static const size_t kMaxThreadLocalBracketSize = 128;
+  static const size_t kMaxThreadLocalBracketSize = 256;
+
+  // We use fine (8-byte increment) runs for the size brackets whose indexes are less than this
+  // index. The allocation fast paths in the quick entrypoints only handle the fine brackets and
+  // leave the larger thread-local brackets to the runtime.
+  static const size_t kNumFineSizeBrackets = 16;
+  static_assert(kNumFineSizeBrackets <= kNumThreadLocalSizeBrackets,
+                "The fine brackets must all be thread-local");
+
+  // The size of the largest fine (8-byte increment) bracket. This should be equal to
+  // bracketSizes[kNumFineSizeBrackets - 1].
+  static const size_t kMaxFineBracketSize = 128;
 
   // We use regular (8 or 16-bytes increment) runs for the size brackets whose indexes are less than
   // this index.
@@ -679,14 +694,14 @@ class RosAlloc {
   // 1 KB and the 2 KB brackets. This should be equal to bracketSizes[kNumRegularSizeBrackets - 1].
   static const size_t kMaxRegularBracketSize = 512;
 
-  // The bracket size increment for the thread-local brackets (<= kMaxThreadLocalBracketSize bytes).
+  // The bracket size increment for the fine brackets (<= kMaxFineBracketSize bytes).
   static constexpr size_t kThreadLocalBracketQuantumSize = 8;
 
   // Equal to Log2(kThreadLocalBracketQuantumSize).
   static constexpr size_t kThreadLocalBracketQuantumSizeShift = 3;
 
-  // The bracket size increment for the non-thread-local, regular brackets (of size <=
-  // kMaxRegularBracketSize bytes and > kMaxThreadLocalBracketSize bytes).
+  // The bracket size increment for the regular, non-fine brackets (of size <=
+  // kMaxRegularBracketSize bytes and > kMaxFineBracketSize bytes).
   static constexpr size_t kBracketQuantumSize = 16;
 
   // Equal to Log2(kBracketQuantumSize).
@@ -821,6 +836,10 @@ class RosAlloc {
   // Release a range of pages.
   size_t ReleasePageRange(uint8_t* start, uint8_t* end) REQUIRES(lock_);
 
+  // Release the free page run starting at page map index `idx`, if any. Returns the number of
+  // pages of the run that were processed, or 0 if there was no such free page run.
+  size_t ReleaseFreePageRun(Thread* self, size_t idx, size_t* reclaimed_bytes) REQUIRES(!lock_);
+
   // Dumps the page map for debugging.
   std::string DumpPageMap() REQUIRES(lock_);
 
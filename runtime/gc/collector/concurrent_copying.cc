@@ -17,6 +17,7 @@
 #include "concurrent_copying.h"
 
 #include "art_field-inl.h"
+#include "base/bounded_fifo.h"
 #include "base/enums.h"
 #include "base/file_utils.h"
 #include "base/histogram-inl.h"
@@ -42,6 +43,7 @@
 #include "scoped_thread_state_change-inl.h"
 #include "thread-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "well_known_classes.h"
 
 namespace art {
@@ -61,8 +63,15 @@ static constexpr bool kDisallowReadBarrierDuringScan = kIsDebugBuild;
 static constexpr size_t kReadBarrierMarkStackSize = 512 * KB;
 // Verify that there are no missing card marks.
 static constexpr bool kVerifyNoMissingCardMarks = kIsDebugBuild;
+// Prefetch the headers of the next few objects to process while processing the mark stacks,
+// like MarkSweep does. Scanning an object starts with dependent loads of its class pointer and
+// lock word, which otherwise miss the cache one object at a time.
+static constexpr bool kUseMarkStackPrefetch = true;
+static constexpr size_t kMarkStackPrefetchDistance = 4;
 
 ConcurrentCopying::ConcurrentCopying(Heap* heap,
+                                     bool young_gen,
+                                     bool use_generational_cc,
                                      const std::string& name_prefix,
                                      bool measure_read_barrier_slow_path)
     : GarbageCollector(heap,
@@ -77,6 +86,10 @@ ConcurrentCopying::ConcurrentCopying(Heap* heap,
                                                          kReadBarrierMarkStackSize)),
       rb_mark_bit_stack_full_(false),
       mark_stack_lock_("concurrent copying mark stack lock", kMarkSweepMarkStackLock),
+      parallel_marking_active_(false),
+      parallel_mark_registered_workers_(0),
+      parallel_mark_idle_workers_(0),
+      parallel_mark_count_(0),
       thread_running_gc_(nullptr),
       is_marking_(false),
       is_using_read_barrier_entrypoints_(false),
@@ -101,11 +114,14 @@ ConcurrentCopying::ConcurrentCopying(Heap* heap,
       rb_slow_path_count_gc_total_(0),
       rb_table_(heap_->GetReadBarrierTable()),
       force_evacuate_all_(false),
+      young_gen_(young_gen),
+      use_generational_cc_(use_generational_cc),
       gc_grays_immune_objects_(false),
       immune_gray_stack_lock_("concurrent copying immune gray stack lock",
                               kMarkSweepMarkStackLock) {
   static_assert(space::RegionSpace::kRegionSize == accounting::ReadBarrierTable::kRegionSize,
                 "The region space size and the read barrier table region size must match");
+  CHECK(!young_gen_ || use_generational_cc_);
   Thread* self = Thread::Current();
   {
     ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
@@ -270,7 +286,11 @@ void ConcurrentCopying::BindBitmaps() {
       // It is OK to clear the bitmap with mutators running since the only place it is read is
       // VisitObjects which has exclusion with CC.
       region_space_bitmap_ = region_space_->GetMarkBitmap();
-      region_space_bitmap_->Clear();
+      // A young collection does not mark the old regions, so keep the marks of their live objects
+      // from the last full collection.
+      if (!young_gen_) {
+        region_space_bitmap_->Clear();
+      }
     }
   }
 }
@@ -300,9 +320,10 @@ void ConcurrentCopying::InitializePhase() {
   bytes_moved_.StoreRelaxed(0);
   objects_moved_.StoreRelaxed(0);
   GcCause gc_cause = GetCurrentIteration()->GetGcCause();
-  if (gc_cause == kGcCauseExplicit ||
-      gc_cause == kGcCauseCollectorTransition ||
-      GetCurrentIteration()->GetClearSoftReferences()) {
+  if (!young_gen_ &&
+      (gc_cause == kGcCauseExplicit ||
+       gc_cause == kGcCauseCollectorTransition ||
+       GetCurrentIteration()->GetClearSoftReferences())) {
     force_evacuate_all_ = true;
   } else {
     force_evacuate_all_ = false;
@@ -326,8 +347,11 @@ void ConcurrentCopying::InitializePhase() {
     }
     LOG(INFO) << "GC end of InitializePhase";
   }
-  // Mark all of the zygote large objects without graying them.
-  MarkZygoteLargeObjects();
+  // Mark all of the zygote large objects without graying them. A young collection does not sweep
+  // the large object space.
+  if (!young_gen_) {
+    MarkZygoteLargeObjects();
+  }
 }
 
 // Used to switch the thread roots of a thread from from-space refs to to-space refs.
@@ -421,19 +445,33 @@ class ConcurrentCopying::FlipCallback : public Closure {
     Locks::mutator_lock_->AssertExclusiveHeld(self);
     {
       TimingLogger::ScopedTiming split2("(Paused)SetFromSpace", cc->GetTimings());
-      cc->region_space_->SetFromSpace(cc->rb_table_, cc->force_evacuate_all_);
+      cc->region_space_->SetFromSpace(cc->rb_table_, cc->force_evacuate_all_, cc->young_gen_);
     }
     cc->SwapStacks();
     if (ConcurrentCopying::kEnableFromSpaceAccountingCheck) {
       cc->RecordLiveStackFreezeSize(self);
-      cc->from_space_num_objects_at_first_pause_ = cc->region_space_->GetObjectsAllocated();
-      cc->from_space_num_bytes_at_first_pause_ = cc->region_space_->GetBytesAllocated();
+      if (cc->young_gen_) {
+        // The old regions stay in the to-space and are not accounted for in the check.
+        cc->from_space_num_objects_at_first_pause_ =
+            cc->region_space_->GetObjectsAllocatedInFromSpace() +
+            cc->region_space_->GetObjectsAllocatedInUnevacFromSpace();
+        cc->from_space_num_bytes_at_first_pause_ =
+            cc->region_space_->GetBytesAllocatedInFromSpace() +
+            cc->region_space_->GetBytesAllocatedInUnevacFromSpace();
+      } else {
+        cc->from_space_num_objects_at_first_pause_ = cc->region_space_->GetObjectsAllocated();
+        cc->from_space_num_bytes_at_first_pause_ = cc->region_space_->GetBytesAllocated();
+      }
     }
     cc->is_marking_ = true;
     cc->mark_stack_mode_.StoreRelaxed(ConcurrentCopying::kMarkStackModeThreadLocal);
-    if (kIsDebugBuild) {
+    if (kIsDebugBuild && !cc->young_gen_) {
+      // Old regions keep their live bytes across young collections.
       cc->region_space_->AssertAllRegionLiveBytesZeroOrCleared();
     }
+    if (cc->use_generational_cc_) {
+      cc->ProcessDirtyCardsForGenerationalCC();
+    }
     if (UNLIKELY(Runtime::Current()->IsActiveTransaction())) {
       CHECK(Runtime::Current()->IsAotCompiler());
       TimingLogger::ScopedTiming split3("(Paused)VisitTransactionRoots", cc->GetTimings());
@@ -719,11 +757,9 @@ void ConcurrentCopying::GrayAllNewlyDirtyImmuneObjects() {
                                              visitor,
                                              gc::accounting::CardTable::kCardDirty);
     if (table != nullptr) {
-      // Add the cards to the mod-union table so that we can clear cards to save RAM.
+      // Add the cards to the mod-union table so that we can clear them. This only ages the cards;
+      // they are cleared concurrently in the marking phase to keep the pause short.
       table->ProcessCards();
-      TimingLogger::ScopedTiming split2("(Paused)ClearCards", GetTimings());
-      card_table->ClearCardRange(space->Begin(),
-                                 AlignDown(space->End(), accounting::CardTable::kCardSize));
     }
   }
   // Since all of the objects that may point to other spaces are gray, we can avoid all the read
@@ -731,6 +767,73 @@ void ConcurrentCopying::GrayAllNewlyDirtyImmuneObjects() {
   updated_all_immune_objects_.StoreRelaxed(true);
 }
 
+void ConcurrentCopying::ProcessDirtyCardsForGenerationalCC() {
+  TimingLogger::ScopedTiming split("(Paused)ProcessDirtyCards", GetTimings());
+  DCHECK(use_generational_cc_);
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  Thread* const self = Thread::Current();
+  Locks::mutator_lock_->AssertExclusiveHeld(self);
+  WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
+  if (young_gen_) {
+    // Objects allocated in the non-moving spaces since the previous collection are only on the
+    // live stack. Mark them live so that the card scans below pick them up. A young collection
+    // does not sweep these spaces, so this is done here rather than in Sweep().
+    heap_->MarkAllocStackAsLive(heap_->GetLiveStack());
+  }
+  // An old object on a dirty card may reference a young object. Gray it so that mutators go
+  // through the read barrier when loading its fields, and have the GC scan it.
+  auto gray_and_push = [this](mirror::Object* obj)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_) {
+    if (kUseBakerReadBarrier) {
+      if (obj->GetReadBarrierState() != ReadBarrier::WhiteState()) {
+        return;
+      }
+      obj->SetReadBarrierState(ReadBarrier::GrayState());
+    }
+    PushOntoMarkStack(obj);
+  };
+  auto age_card = [](uint8_t card) {
+    return (card == accounting::CardTable::kCardDirty) ? accounting::CardTable::kCardAged : card;
+  };
+  for (space::ContinuousSpace* space : heap_->GetContinuousSpaces()) {
+    if (space == region_space_) {
+      if (young_gen_) {
+        region_space_->VisitOldObjectsOnCards(card_table,
+                                              accounting::CardTable::kCardDirty,
+                                              gray_and_push);
+      }
+      card_table->ModifyCardsAtomic(space->Begin(), space->Limit(), age_card, VoidFunctor());
+    } else if (space->IsContinuousMemMapAllocSpace() && !immune_spaces_.ContainsSpace(space)) {
+      if (young_gen_) {
+        card_table->Scan</* kClearCard */ false>(space->GetLiveBitmap(),
+                                                 space->Begin(),
+                                                 space->End(),
+                                                 gray_and_push,
+                                                 accounting::CardTable::kCardDirty);
+      }
+      card_table->ModifyCardsAtomic(space->Begin(), space->End(), age_card, VoidFunctor());
+    }
+  }
+}
+
+void ConcurrentCopying::ClearAgedCardsForGenerationalCC() {
+  TimingLogger::ScopedTiming split("ClearAgedCards", GetTimings());
+  DCHECK(use_generational_cc_);
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  // Cards dirtied since the pause stay dirty: they may cover references to objects allocated
+  // during this collection, which is the young generation of the next one.
+  auto clear_aged_card = [](uint8_t card) {
+    return (card == accounting::CardTable::kCardAged) ? accounting::CardTable::kCardClean : card;
+  };
+  for (space::ContinuousSpace* space : heap_->GetContinuousSpaces()) {
+    if (space == region_space_) {
+      card_table->ModifyCardsAtomic(space->Begin(), space->Limit(), clear_aged_card, VoidFunctor());
+    } else if (space->IsContinuousMemMapAllocSpace() && !immune_spaces_.ContainsSpace(space)) {
+      card_table->ModifyCardsAtomic(space->Begin(), space->End(), clear_aged_card, VoidFunctor());
+    }
+  }
+}
+
 void ConcurrentCopying::SwapStacks() {
   heap_->SwapStacks();
 }
@@ -804,6 +907,8 @@ void ConcurrentCopying::MarkingPhase() {
       accounting::ModUnionTable* table = heap_->FindModUnionTableFromSpace(space);
       ImmuneSpaceScanObjVisitor visitor(this);
       if (kUseBakerReadBarrier && kGrayDirtyImmuneObjects && table != nullptr) {
+        // The cards aged in the pause are recorded in the mod-union table, clear them to save RAM.
+        table->ClearAgedCards();
         table->VisitObjects(ImmuneSpaceScanObjVisitor::Callback, &visitor);
       } else {
         // TODO: Scan only the aged cards.
@@ -861,6 +966,13 @@ void ConcurrentCopying::MarkingPhase() {
     // weaks) that may happen concurrently while we processing the mark stack and newly mark/gray
     // objects and push refs on the mark stack.
     ProcessMarkStack();
+    // While weak ref accesses are still enabled, drop the references whose referents are already
+    // marked from the reference queues so that ProcessReferences() below has less to walk.
+    heap_->GetReferenceProcessor()->PreCleanReferences(GetTimings(), this);
+    // Block the system weak holders before weak ref accesses get disabled below. Each holder is
+    // allowed again as soon as SweepSystemWeaks() below has swept it, so mutators only wait for
+    // the holders they use rather than for all of the sweeping and the class unloading.
+    Runtime::Current()->DisallowNewSystemWeaks();
     // Switch to the shared mark stack mode. That is, revoke and process thread-local mark stacks
     // for the last time before transitioning to the shared mark stack mode, which would process new
     // refs that may have been concurrently pushed onto the mark stack during the ProcessMarkStack()
@@ -1073,6 +1185,21 @@ void ConcurrentCopying::PushOntoMarkStack(mirror::Object* to_ref) {
       << " " << to_ref << " " << mirror::Object::PrettyTypeOf(to_ref);
   Thread* self = Thread::Current();  // TODO: pass self as an argument from call sites?
   CHECK(thread_running_gc_ != nullptr);
+  if (UNLIKELY(parallel_marking_active_.LoadRelaxed())) {
+    accounting::ObjectStack* parallel_mark_stack = self->GetThreadLocalMarkStack();
+    if (IsParallelMarkStack(parallel_mark_stack)) {
+      // A parallel marking worker. Push onto its work-stealing mark stack. If it overflowed,
+      // spill onto the GC mark stack so that other idle workers can pick it up.
+      if (UNLIKELY(!parallel_mark_stack->PushBackStealable(to_ref))) {
+        MutexLock mu(self, mark_stack_lock_);
+        if (UNLIKELY(gc_mark_stack_->IsFull())) {
+          ExpandGcMarkStack();
+        }
+        gc_mark_stack_->PushBack(to_ref);
+      }
+      return;
+    }
+  }
   MarkStackMode mark_stack_mode = mark_stack_mode_.LoadRelaxed();
   if (LIKELY(mark_stack_mode == kMarkStackModeThreadLocal)) {
     if (LIKELY(self == thread_running_gc_)) {
@@ -1417,12 +1544,7 @@ bool ConcurrentCopying::ProcessMarkStackOnce() {
     // Process the thread-local mark stacks and the GC mark stack.
     count += ProcessThreadLocalMarkStacks(/* disable_weak_ref_access */ false,
                                           /* checkpoint_callback */ nullptr);
-    while (!gc_mark_stack_->IsEmpty()) {
-      mirror::Object* to_ref = gc_mark_stack_->PopBack();
-      ProcessMarkStackRef(to_ref);
-      ++count;
-    }
-    gc_mark_stack_->Reset();
+    count += ProcessGcMarkStack();
   } else if (mark_stack_mode == kMarkStackModeShared) {
     // Do an empty checkpoint to avoid a race with a mutator preempted in the middle of a read
     // barrier but before pushing onto the mark stack. b/32508093. Note the weak ref access is
@@ -1447,8 +1569,11 @@ bool ConcurrentCopying::ProcessMarkStackOnce() {
         }
         gc_mark_stack_->Reset();
       }
-      for (mirror::Object* ref : refs) {
-        ProcessMarkStackRef(ref);
+      for (size_t i = 0, size = refs.size(); i != size; ++i) {
+        if (kUseMarkStackPrefetch && i + kMarkStackPrefetchDistance < size) {
+          __builtin_prefetch(refs[i + kMarkStackPrefetchDistance]);
+        }
+        ProcessMarkStackRef(refs[i]);
         ++count;
       }
     }
@@ -1460,16 +1585,209 @@ bool ConcurrentCopying::ProcessMarkStackOnce() {
       CHECK(revoked_mark_stacks_.empty());
     }
     // Process the GC mark stack in the exclusive mode. No need to take the lock.
-    while (!gc_mark_stack_->IsEmpty()) {
-      mirror::Object* to_ref = gc_mark_stack_->PopBack();
+    count += ProcessGcMarkStack();
+  }
+
+  // Return true if the stack was empty.
+  return count == 0;
+}
+
+size_t ConcurrentCopying::GetParallelMarkThreadCount() const {
+  // Like MarkSweep, use only the GC-running thread in a background (non jank perceptible) state
+  // to leave more CPU time for the foreground apps.
+  ThreadPool* thread_pool = heap_->GetThreadPool();
+  if (thread_pool == nullptr || !Runtime::Current()->InJankPerceptibleProcessState()) {
+    return 1;
+  }
+  return std::min(heap_->GetParallelGCThreadCount(), thread_pool->GetThreadCount()) + 1;
+}
+
+size_t ConcurrentCopying::ProcessGcMarkStack() {
+  const size_t thread_count = GetParallelMarkThreadCount();
+  if (thread_count > 1 && gc_mark_stack_->Size() >= kMinimumParallelMarkStackSize) {
+    return ProcessGcMarkStackParallel(thread_count);
+  }
+  size_t count = 0;
+  BoundedFifoPowerOfTwo<mirror::Object*, kMarkStackPrefetchDistance> prefetch_fifo;
+  for (;;) {
+    mirror::Object* to_ref = nullptr;
+    if (kUseMarkStackPrefetch) {
+      // Processing a reference may push more onto the mark stack, so refill the FIFO each time.
+      while (!gc_mark_stack_->IsEmpty() && prefetch_fifo.size() < kMarkStackPrefetchDistance) {
+        mirror::Object* mark_stack_obj = gc_mark_stack_->PopBack();
+        DCHECK(mark_stack_obj != nullptr);
+        __builtin_prefetch(mark_stack_obj);
+        prefetch_fifo.push_back(mark_stack_obj);
+      }
+      if (prefetch_fifo.empty()) {
+        break;
+      }
+      to_ref = prefetch_fifo.front();
+      prefetch_fifo.pop_front();
+    } else {
+      if (gc_mark_stack_->IsEmpty()) {
+        break;
+      }
+      to_ref = gc_mark_stack_->PopBack();
+    }
+    ProcessMarkStackRef(to_ref);
+    ++count;
+  }
+  gc_mark_stack_->Reset();
+  return count;
+}
+
+class ConcurrentCopying::ParallelMarkTask : public Task {
+ public:
+  ParallelMarkTask(ConcurrentCopying* collector, size_t index)
+      : collector_(collector), index_(index) {}
+
+  // Like the MarkSweep tasks, the workers rely on the GC-running thread holding the mutator lock
+  // (shared) while it waits for them.
+  void Run(Thread* self) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    collector_->ParallelMark(self, index_);
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ConcurrentCopying* const collector_;
+  const size_t index_;
+};
+
+size_t ConcurrentCopying::ProcessGcMarkStackParallel(size_t thread_count) {
+  Thread* self = Thread::Current();
+  CHECK_EQ(self, thread_running_gc_);
+  MarkStackMode mark_stack_mode = mark_stack_mode_.LoadRelaxed();
+  // In the shared mode, mutators push onto the GC mark stack and we don't run in parallel.
+  CHECK(mark_stack_mode == kMarkStackModeThreadLocal ||
+        mark_stack_mode == kMarkStackModeGcExclusive)
+      << static_cast<uint32_t>(mark_stack_mode);
+  TimingLogger::ScopedTiming split("ProcessGcMarkStackParallel", GetTimings());
+  while (parallel_mark_stacks_.size() < thread_count) {
+    parallel_mark_stacks_.emplace_back(
+        accounting::ObjectStack::Create("concurrent copying parallel mark stack",
+                                        kParallelMarkStackSize,
+                                        kParallelMarkStackSize));
+  }
+  parallel_mark_registered_workers_.StoreRelaxed(0);
+  parallel_mark_idle_workers_.StoreRelaxed(0);
+  parallel_mark_count_.StoreRelaxed(0);
+  // The refs on the GC mark stack are handed out to the workers in chunks by
+  // TakeParallelMarkWork().
+  parallel_marking_active_.StoreSequentiallyConsistent(true);
+  ThreadPool* thread_pool = heap_->GetThreadPool();
+  for (size_t i = 0; i < thread_count; ++i) {
+    thread_pool->AddTask(self, new ParallelMarkTask(this, i));
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+  thread_pool->StopWorkers(self);
+  parallel_marking_active_.StoreSequentiallyConsistent(false);
+  {
+    MutexLock mu(self, mark_stack_lock_);
+    CHECK(gc_mark_stack_->IsEmpty());
+  }
+  gc_mark_stack_->Reset();
+  for (size_t i = 0; i < thread_count; ++i) {
+    CHECK(parallel_mark_stacks_[i]->IsEmpty());
+    parallel_mark_stacks_[i]->Reset();
+  }
+  return parallel_mark_count_.LoadRelaxed();
+}
+
+bool ConcurrentCopying::IsParallelMarkStack(const accounting::ObjectStack* mark_stack) const {
+  if (mark_stack == nullptr) {
+    return false;
+  }
+  for (const std::unique_ptr<accounting::ObjectStack>& parallel_mark_stack :
+       parallel_mark_stacks_) {
+    if (parallel_mark_stack.get() == mark_stack) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ConcurrentCopying::ParallelMark(Thread* self, size_t index) {
+  accounting::ObjectStack* mark_stack = parallel_mark_stacks_[index].get();
+  DCHECK(mark_stack->IsEmpty());
+  // Install the work-stealing mark stack so that PushOntoMarkStack() finds it.
+  CHECK(self->GetThreadLocalMarkStack() == nullptr);
+  self->SetThreadLocalMarkStack(mark_stack);
+  parallel_mark_registered_workers_.FetchAndAddSequentiallyConsistent(1);
+  size_t count = 0;
+  while (true) {
+    mirror::Object* to_ref;
+    while ((to_ref = mark_stack->PopBackStealable()) != nullptr) {
       ProcessMarkStackRef(to_ref);
       ++count;
     }
-    gc_mark_stack_->Reset();
+    if (!TakeParallelMarkWork(self, index) && !WaitForParallelMarkWork(self)) {
+      break;
+    }
   }
+  self->SetThreadLocalMarkStack(nullptr);
+  parallel_mark_count_.FetchAndAddRelaxed(count);
+}
 
-  // Return true if the stack was empty.
-  return count == 0;
+bool ConcurrentCopying::TakeParallelMarkWork(Thread* self, size_t index) {
+  accounting::ObjectStack* mark_stack = parallel_mark_stacks_[index].get();
+  {
+    // Take a chunk of the shared GC mark stack first.
+    MutexLock mu(self, mark_stack_lock_);
+    if (!gc_mark_stack_->IsEmpty()) {
+      for (size_t i = 0; i < kParallelMarkChunkSize && !gc_mark_stack_->IsEmpty(); ++i) {
+        bool success = mark_stack->PushBackStealable(gc_mark_stack_->PopBack());
+        DCHECK(success) << "The worker mark stack must have been empty";
+      }
+      return true;
+    }
+  }
+  // Otherwise, steal from the other workers.
+  for (size_t i = 1; i < parallel_mark_stacks_.size(); ++i) {
+    accounting::ObjectStack* victim =
+        parallel_mark_stacks_[(index + i) % parallel_mark_stacks_.size()].get();
+    mirror::Object* to_ref = victim->StealFront();
+    if (to_ref != nullptr) {
+      bool success = mark_stack->PushBackStealable(to_ref);
+      DCHECK(success) << "The worker mark stack must have been empty";
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ConcurrentCopying::WaitForParallelMarkWork(Thread* self) {
+  parallel_mark_idle_workers_.FetchAndAddSequentiallyConsistent(1);
+  while (true) {
+    // A worker only pushes onto its own mark stack (or the GC mark stack) while it isn't idle. So
+    // once all the registered workers are idle, all the mark stacks are empty and stay empty.
+    // Workers that start late register before looking for work and find nothing left to do.
+    if (parallel_mark_idle_workers_.LoadSequentiallyConsistent() ==
+        parallel_mark_registered_workers_.LoadSequentiallyConsistent()) {
+      return false;
+    }
+    bool has_work = false;
+    for (const std::unique_ptr<accounting::ObjectStack>& mark_stack : parallel_mark_stacks_) {
+      if (!mark_stack->IsEmptyStealable()) {
+        has_work = true;
+        break;
+      }
+    }
+    if (!has_work) {
+      MutexLock mu(self, mark_stack_lock_);
+      has_work = !gc_mark_stack_->IsEmpty();
+    }
+    if (has_work) {
+      parallel_mark_idle_workers_.FetchAndSubSequentiallyConsistent(1);
+      return true;
+    }
+    sched_yield();
+  }
 }
 
 size_t ConcurrentCopying::ProcessThreadLocalMarkStacks(bool disable_weak_ref_access,
@@ -1485,7 +1803,11 @@ size_t ConcurrentCopying::ProcessThreadLocalMarkStacks(bool disable_weak_ref_acc
     revoked_mark_stacks_.clear();
   }
   for (accounting::AtomicStack<mirror::Object>* mark_stack : mark_stacks) {
-    for (StackReference<mirror::Object>* p = mark_stack->Begin(); p != mark_stack->End(); ++p) {
+    StackReference<mirror::Object>* const end = mark_stack->End();
+    for (StackReference<mirror::Object>* p = mark_stack->Begin(); p != end; ++p) {
+      if (kUseMarkStackPrefetch && end - p > static_cast<ptrdiff_t>(kMarkStackPrefetchDistance)) {
+        __builtin_prefetch(p[kMarkStackPrefetchDistance].AsMirrorPtr());
+      }
       mirror::Object* to_ref = p->AsMirrorPtr();
       ProcessMarkStackRef(to_ref);
       ++count;
@@ -1514,8 +1836,11 @@ inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref) {
   }
   bool add_to_live_bytes = false;
   if (region_space_->IsInUnevacFromSpace(to_ref)) {
-    // Mark the bitmap only in the GC thread here so that we don't need a CAS.
-    if (!kUseBakerReadBarrier || !region_space_bitmap_->Set(to_ref)) {
+    // Mark the bitmap only in the GC thread here so that we don't need a CAS, unless there are
+    // parallel marking workers.
+    if (!kUseBakerReadBarrier ||
+        !(parallel_marking_active_.LoadRelaxed() ? region_space_bitmap_->AtomicTestAndSet(to_ref)
+                                                 : region_space_bitmap_->Set(to_ref))) {
       // It may be already marked if we accidentally pushed the same object twice due to the racy
       // bitmap read in MarkUnevacFromSpaceRegion.
       Scan(to_ref);
@@ -1556,8 +1881,8 @@ inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref) {
 #endif
 
   if (add_to_live_bytes) {
-    // Add to the live bytes per unevacuated from-space. Note this code is always run by the
-    // GC-running thread (no synchronization required).
+    // Add to the live bytes per unevacuated from-space. Note this code is run by the GC-running
+    // thread or the parallel marking workers (RegionSpace::AddLiveBytes() is atomic).
     DCHECK(region_space_bitmap_->Test(to_ref));
     size_t obj_size = to_ref->SizeOf<kDefaultVerifyFlags>();
     size_t alloc_size = RoundUp(obj_size, space::RegionSpace::kAlignment);
@@ -1662,7 +1987,7 @@ void ConcurrentCopying::CheckEmptyMarkStack() {
 void ConcurrentCopying::SweepSystemWeaks(Thread* self) {
   TimingLogger::ScopedTiming split("SweepSystemWeaks", GetTimings());
   ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
-  Runtime::Current()->SweepSystemWeaks(this);
+  Runtime::Current()->SweepSystemWeaks(this, /* allow_new_system_weaks */ true);
 }
 
 void ConcurrentCopying::Sweep(bool swap_bitmaps) {
@@ -1672,10 +1997,17 @@ void ConcurrentCopying::Sweep(bool swap_bitmaps) {
     if (kEnableFromSpaceAccountingCheck) {
       CHECK_GE(live_stack_freeze_size_, live_stack->Size());
     }
-    heap_->MarkAllocStackAsLive(live_stack);
+    // A young collection marked the live stack as live in the pause.
+    if (!young_gen_) {
+      heap_->MarkAllocStackAsLive(live_stack);
+    }
     live_stack->Reset();
   }
   CheckEmptyMarkStack();
+  if (young_gen_) {
+    // The non-moving spaces and the large object space are only collected by full collections.
+    return;
+  }
   TimingLogger::ScopedTiming split("Sweep", GetTimings());
   for (const auto& space : GetHeap()->GetContinuousSpaces()) {
     if (space->IsContinuousMemMapAllocSpace()) {
@@ -1799,7 +2131,10 @@ void ConcurrentCopying::ReclaimPhase() {
   {
     WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
     Sweep(false);
-    SwapBitmaps();
+    // A young collection does not mark the non-moving spaces; their live bitmaps stay as they are.
+    if (!young_gen_) {
+      SwapBitmaps();
+    }
     heap_->UnBindBitmaps();
 
     // The bitmap was cleared at the start of the GC, there is nothing we need to do here.
@@ -2049,6 +2384,8 @@ void ConcurrentCopying::AssertToSpaceInvariantInNonMovingSpace(mirror::Object* o
           << " ref=" << ref << " ref rb_state=" << ref->GetReadBarrierState()
           << " updated_all_immune_objects=" << updated_all_immune_objects;
     }
+  } else if (young_gen_) {
+    // Non-moving objects are not marked (but considered live) by a young collection.
   } else {
     accounting::ContinuousSpaceBitmap* mark_bitmap =
         heap_mark_bitmap_->GetContinuousSpaceBitmap(ref);
@@ -2358,7 +2695,11 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref,
   size_t dummy;
   bool fall_back_to_non_moving = false;
   mirror::Object* to_ref = region_space_->AllocNonvirtual</*kForEvac*/ true>(
-      region_space_alloc_size, &region_space_bytes_allocated, nullptr, &dummy);
+      region_space_alloc_size,
+      &region_space_bytes_allocated,
+      nullptr,
+      &dummy,
+      region_space_->GetNumaNode(from_ref));
   bytes_allocated = region_space_bytes_allocated;
   if (LIKELY(to_ref != nullptr)) {
     DCHECK_EQ(region_space_alloc_size, region_space_bytes_allocated);
@@ -2392,9 +2733,11 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref,
         LOG(FATAL) << "Object address=" << from_ref << " type=" << from_ref->PrettyTypeOf();
       }
       bytes_allocated = non_moving_space_bytes_allocated;
-      // Mark it in the mark bitmap.
-      accounting::ContinuousSpaceBitmap* mark_bitmap =
-          heap_mark_bitmap_->GetContinuousSpaceBitmap(to_ref);
+      // Mark it in the mark bitmap. A young collection does not swap the bitmaps of the non-moving
+      // space, so mark it directly in the live bitmap instead.
+      accounting::ContinuousSpaceBitmap* mark_bitmap = young_gen_
+          ? heap_->non_moving_space_->GetLiveBitmap()
+          : heap_mark_bitmap_->GetContinuousSpaceBitmap(to_ref);
       CHECK(mark_bitmap != nullptr);
       CHECK(!mark_bitmap->AtomicTestAndSet(to_ref));
     }
@@ -2443,8 +2786,9 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref,
         DCHECK(heap_->non_moving_space_->HasAddress(to_ref));
         DCHECK_EQ(bytes_allocated, non_moving_space_bytes_allocated);
         // Free the non-moving-space chunk.
-        accounting::ContinuousSpaceBitmap* mark_bitmap =
-            heap_mark_bitmap_->GetContinuousSpaceBitmap(to_ref);
+        accounting::ContinuousSpaceBitmap* mark_bitmap = young_gen_
+            ? heap_->non_moving_space_->GetLiveBitmap()
+            : heap_mark_bitmap_->GetContinuousSpaceBitmap(to_ref);
         CHECK(mark_bitmap != nullptr);
         CHECK(mark_bitmap->Clear(to_ref));
         heap_->non_moving_space_->Free(Thread::Current(), to_ref);
@@ -2527,6 +2871,9 @@ mirror::Object* ConcurrentCopying::IsMarked(mirror::Object* from_ref) {
     if (immune_spaces_.ContainsObject(from_ref)) {
       // An immune object is alive.
       to_ref = from_ref;
+    } else if (young_gen_) {
+      // Non-moving objects are only collected by full collections.
+      to_ref = from_ref;
     } else {
       // Non-immune non-moving space. Use the mark bitmap.
       accounting::ContinuousSpaceBitmap* mark_bitmap =
@@ -2576,6 +2923,11 @@ mirror::Object* ConcurrentCopying::MarkNonMoving(mirror::Object* ref,
   // ref is in a non-moving space (from_ref == to_ref).
   DCHECK(!region_space_->HasAddress(ref)) << ref;
   DCHECK(!immune_spaces_.ContainsObject(ref));
+  if (young_gen_) {
+    // Non-moving objects are considered live by a young collection. The ones which may reference
+    // the young generation were found through the card table in the pause.
+    return ref;
+  }
   // Use the mark bitmap.
   accounting::ContinuousSpaceBitmap* mark_bitmap =
       heap_mark_bitmap_->GetContinuousSpaceBitmap(ref);
@@ -2661,7 +3013,10 @@ void ConcurrentCopying::FinishPhase() {
   }
   // kVerifyNoMissingCardMarks relies on the region space cards not being cleared to avoid false
   // positives.
-  if (!kVerifyNoMissingCardMarks) {
+  if (use_generational_cc_) {
+    ReaderMutexLock mu(self, *Locks::mutator_lock_);
+    ClearAgedCardsForGenerationalCC();
+  } else if (!kVerifyNoMissingCardMarks) {
     TimingLogger::ScopedTiming split("ClearRegionSpaceCards", GetTimings());
     // We do not currently use the region space cards at all, madvise them away to save ram.
     heap_->GetCardTable()->ClearCardRange(region_space_->Begin(), region_space_->Limit());
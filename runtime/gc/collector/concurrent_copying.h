@@ -65,9 +65,16 @@ class ConcurrentCopying : public GarbageCollector {
   // pages.
   static constexpr bool kGrayDirtyImmuneObjects = true;
 
-  explicit ConcurrentCopying(Heap* heap,
-                             const std::string& name_prefix = "",
-                             bool measure_read_barrier_slow_path = false);
+  // If `young_gen` is true, the collector only evacuates the regions allocated since the previous
+  // collection (sticky collection); everything else is considered live, and the references from
+  // it into the young generation are found through the card table. `use_generational_cc` must be
+  // true for both the young and the full collector when generational CC is enabled, as the full
+  // collector then has to preserve the cards dirtied while it runs.
+  ConcurrentCopying(Heap* heap,
+                    bool young_gen,
+                    bool use_generational_cc,
+                    const std::string& name_prefix = "",
+                    bool measure_read_barrier_slow_path = false);
   ~ConcurrentCopying();
 
   virtual void RunPhases() OVERRIDE
@@ -87,7 +94,7 @@ class ConcurrentCopying : public GarbageCollector {
   void BindBitmaps() REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::heap_bitmap_lock_);
   virtual GcType GetGcType() const OVERRIDE {
-    return kGcTypePartial;
+    return young_gen_ ? kGcTypeSticky : kGcTypePartial;
   }
   virtual CollectorType GetCollectorType() const OVERRIDE {
     return kCollectorTypeCC;
@@ -175,6 +182,25 @@ class ConcurrentCopying : public GarbageCollector {
   virtual void ProcessMarkStack() OVERRIDE REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
   bool ProcessMarkStackOnce() REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  // Drain the GC mark stack in the thread-local or the GC exclusive mark stack mode, in parallel
+  // if there is enough work and parallel GC threads are available. Returns the number of
+  // processed refs.
+  size_t ProcessGcMarkStack() REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  size_t ProcessGcMarkStackParallel(size_t thread_count) REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_);
+  // Body of a parallel marking worker. `index` selects the worker's work-stealing mark stack.
+  void ParallelMark(Thread* self, size_t index) REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_);
+  // Find more work for the parallel marking worker `index`, either from the shared GC mark stack
+  // or by stealing from another worker. Returns false if none was found.
+  bool TakeParallelMarkWork(Thread* self, size_t index) REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_);
+  // Called by an idle parallel marking worker. Returns true if there may be new work and false
+  // if all workers are idle, i.e. marking has terminated.
+  bool WaitForParallelMarkWork(Thread* self) REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_);
+  bool IsParallelMarkStack(const accounting::ObjectStack* mark_stack) const;
+  size_t GetParallelMarkThreadCount() const;
   void ProcessMarkStackRef(mirror::Object* to_ref) REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
   void GrayAllDirtyImmuneObjects()
@@ -277,6 +303,14 @@ class ConcurrentCopying : public GarbageCollector {
   void DumpPerformanceInfo(std::ostream& os) OVERRIDE REQUIRES(!rb_slow_path_histogram_lock_);
   // Set the read barrier mark entrypoints to non-null.
   void ActivateReadBarrierEntrypoints();
+  // Age the dirty cards of the region space and of the non-immune alloc spaces. For a young
+  // collection, also gray the old objects on dirty cards and push them onto the mark stack, as
+  // they may reference the young generation.
+  void ProcessDirtyCardsForGenerationalCC() REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_);
+  // Clean the cards aged in the pause, leaving the cards dirtied during the collection for the
+  // next one.
+  void ClearAgedCardsForGenerationalCC() REQUIRES_SHARED(Locks::mutator_lock_);
 
   space::RegionSpace* region_space_;      // The underlying region space.
   std::unique_ptr<Barrier> gc_barrier_;
@@ -303,6 +337,20 @@ class ConcurrentCopying : public GarbageCollector {
   static constexpr size_t kMarkStackPoolSize = 256;
   std::vector<accounting::ObjectStack*> pooled_mark_stacks_
       GUARDED_BY(mark_stack_lock_);
+  // Parallel marking. Each worker (including the GC-running thread) pushes onto and pops from its
+  // own work-stealing mark stack, installed as the worker's thread-local mark stack, and spills
+  // onto the GC mark stack (with mark_stack_lock_) on overflow.
+  static constexpr size_t kParallelMarkStackSize = 16 * KB;
+  // Minimum GC mark stack size for processing it in parallel.
+  static constexpr size_t kMinimumParallelMarkStackSize = 128;
+  // Number of refs a worker takes from the GC mark stack at once.
+  static constexpr size_t kParallelMarkChunkSize = 64;
+  // Only resized by the GC-running thread when no parallel marking is ongoing.
+  std::vector<std::unique_ptr<accounting::ObjectStack>> parallel_mark_stacks_;
+  Atomic<bool> parallel_marking_active_;
+  AtomicInteger parallel_mark_registered_workers_;
+  AtomicInteger parallel_mark_idle_workers_;
+  Atomic<size_t> parallel_mark_count_;
   Thread* thread_running_gc_;
   bool is_marking_;                       // True while marking is ongoing.
   // True while we might dispatch on the read barrier entrypoints.
@@ -359,6 +407,10 @@ class ConcurrentCopying : public GarbageCollector {
 
   accounting::ReadBarrierTable* rb_table_;
   bool force_evacuate_all_;  // True if all regions are evacuated.
+  // True if this collector only collects the young generation (see the constructor).
+  const bool young_gen_;
+  // True if generational CC is enabled (for both the young and the full collector).
+  const bool use_generational_cc_;
   Atomic<bool> updated_all_immune_objects_;
   bool gc_grays_immune_objects_;
   Mutex immune_gray_stack_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
@@ -382,6 +434,7 @@ class ConcurrentCopying : public GarbageCollector {
   template <bool kConcurrent> class GrayImmuneObjectVisitor;
   class ImmuneSpaceScanObjVisitor;
   class LostCopyVisitor;
+  class ParallelMarkTask;
   class RefFieldsVisitor;
   class RevokeThreadLocalMarkStackCheckpoint;
   class ScopedGcGraysImmuneObjects;
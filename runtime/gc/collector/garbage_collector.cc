@@ -33,6 +33,7 @@
 #include "gc/space/large_object_space.h"
 #include "gc/space/space-inl.h"
 #include "runtime.h"
+#include "runtime_metrics.h"
 #include "thread-current-inl.h"
 #include "thread_list.h"
 
@@ -114,6 +115,12 @@ void GarbageCollector::Run(GcCause gc_cause, bool clear_soft_references) {
     MutexLock mu(self, pause_histogram_lock_);
     pause_histogram_.AdjustAndAddValue(pause_time);
   }
+  RuntimeMetrics::RecordGc(current_iteration->GetDurationNs(),
+                           current_iteration->GetPauseTimes(),
+                           current_iteration->GetFreedBytes() +
+                               current_iteration->GetFreedLargeObjectBytes(),
+                           heap_->GetBytesAllocatedEver(),
+                           heap_->GetBytesAllocated());
   is_transaction_active_ = false;
 }
 
@@ -210,6 +217,17 @@ uint64_t GarbageCollector::GetTotalPausedTimeNs() {
   return pause_histogram_.AdjustedSum();
 }
 
+uint64_t GarbageCollector::GetPauseTimePercentileNs(double percentile) {
+  MutexLock mu(Thread::Current(), pause_histogram_lock_);
+  if (pause_histogram_.SampleSize() == 0) {
+    return 0U;
+  }
+  Histogram<uint64_t>::CumulativeData cumulative_data;
+  pause_histogram_.CreateHistogram(&cumulative_data);
+  // The pauses are recorded with AdjustAndAddValue().
+  return static_cast<uint64_t>(pause_histogram_.AdjustedPercentile(percentile, cumulative_data));
+}
+
 void GarbageCollector::DumpPerformanceInfo(std::ostream& os) {
   const CumulativeLogger& logger = GetCumulativeTimings();
   const size_t iterations = logger.GetIterations();
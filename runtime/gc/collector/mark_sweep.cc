@@ -240,6 +240,9 @@ void MarkSweep::PreCleanCards() {
         static_cast<VisitRootFlags>(kVisitRootFlagClearRootLog | kVisitRootFlagNewRoots));
     // Process the newly aged cards.
     RecursiveMarkDirtyObjects(false, accounting::CardTable::kCardDirty - 1);
+    // Drop the references whose referents are already marked so that the paused reference
+    // processing has less to walk.
+    GetHeap()->GetReferenceProcessor()->PreCleanReferences(GetTimings(), this);
     // TODO: Empty allocation stack to reduce the number of objects we need to test / mark as live
     // in the next GC.
   }
@@ -340,9 +343,9 @@ void MarkSweep::ReclaimPhase() {
   Thread* const self = Thread::Current();
   // Process the references concurrently.
   ProcessReferences(self);
+  // The system weaks disallowed in the pause are allowed again as they get swept.
   SweepSystemWeaks(self);
   Runtime* const runtime = Runtime::Current();
-  runtime->AllowNewSystemWeaks();
   // Clean up class loaders after system weaks are swept since that is how we know if class
   // unloading occurred.
   runtime->GetClassLinker()->CleanupClassLoaders();
@@ -1099,7 +1102,7 @@ void MarkSweep::ReMarkRoots() {
 void MarkSweep::SweepSystemWeaks(Thread* self) {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
   ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
-  Runtime::Current()->SweepSystemWeaks(this);
+  Runtime::Current()->SweepSystemWeaks(this, /* allow_new_system_weaks */ true);
 }
 
 class MarkSweep::VerifySystemWeakVisitor : public IsMarkedVisitor {
@@ -59,6 +59,13 @@ static constexpr bool kProtectFromSpace = true;
 static constexpr bool kStoreStackTraces = false;
 static constexpr size_t kBytesPromotedThreshold = 4 * MB;
 static constexpr size_t kLargeObjectBytesAllocatedThreshold = 16 * MB;
+// Generational mode: when less than this percentage of the objects which survived the previous
+// collection survive the current one too, the survivors of the next collection are kept in the
+// bump pointer space for one more collection instead of being promoted. Most of them would
+// otherwise die in the promotion space and only be reclaimed by a whole heap collection.
+static constexpr size_t kMinPromotionSurvivalPercent = 25;
+// Generational mode: the survival rate is not measured on less than this many old bytes.
+static constexpr size_t kMinOldBytesForSurvivalRate = 256 * KB;
 
 void SemiSpace::BindBitmaps() {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
@@ -101,6 +108,9 @@ SemiSpace::SemiSpace(Heap* heap, bool generational, const std::string& name_pref
       generational_(generational),
       last_gc_to_space_end_(nullptr),
       bytes_promoted_(0),
+      old_bytes_(0),
+      old_bytes_survived_(0),
+      promote_old_objects_(true),
       bytes_promoted_since_last_whole_heap_collection_(0),
       large_object_bytes_allocated_at_last_whole_heap_collection_(0),
       collect_from_space_only_(generational),
@@ -223,6 +233,8 @@ void SemiSpace::MarkingPhase() {
     }
     // Reset this before the marking starts below.
     bytes_promoted_ = 0;
+    old_bytes_ = last_gc_to_space_end_ - from_space_->Begin();
+    old_bytes_survived_ = 0;
   }
   // Assume the cleared space is already empty.
   BindBitmaps();
@@ -514,7 +526,12 @@ mirror::Object* SemiSpace::MarkNonForwardedObject(mirror::Object* obj) {
   const size_t object_size = obj->SizeOf();
   size_t bytes_allocated, dummy;
   mirror::Object* forward_address = nullptr;
-  if (generational_ && reinterpret_cast<uint8_t*>(obj) < last_gc_to_space_end_) {
+  const bool is_old_object =
+      generational_ && reinterpret_cast<uint8_t*>(obj) < last_gc_to_space_end_;
+  if (is_old_object) {
+    old_bytes_survived_ += object_size;
+  }
+  if (is_old_object && promote_old_objects_) {
     // If it's allocated before the last GC (older), move
     // (pseudo-promote) it to the main free list space (as sort
     // of an old generation.)
@@ -567,7 +584,8 @@ mirror::Object* SemiSpace::MarkNonForwardedObject(mirror::Object* obj) {
       }
     }
   } else {
-    // If it's allocated after the last GC (younger), copy it to the to-space.
+    // If it's allocated after the last GC (younger), or if we keep the older objects for one
+    // more collection, copy it to the to-space.
     forward_address = to_space_->AllocThreadUnsafe(self_, object_size, &bytes_allocated, nullptr,
                                                    &dummy);
     if (forward_address != nullptr && to_space_live_bitmap_ != nullptr) {
@@ -816,6 +834,19 @@ void SemiSpace::FinishPhase() {
   mark_stack_->Reset();
   space::LargeObjectSpace* los = GetHeap()->GetLargeObjectsSpace();
   if (generational_) {
+    // Adapt the tenuring threshold to the survival rate of the objects which survived the
+    // previous collection: promote them after one collection if they are likely to stay alive,
+    // after two otherwise. Objects are never kept for more than two collections, so that
+    // the long lived ones are not copied within the bump pointer spaces over and over again.
+    if (!promote_old_objects_) {
+      promote_old_objects_ = true;
+    } else if (old_bytes_ >= kMinOldBytesForSurvivalRate) {
+      promote_old_objects_ =
+          old_bytes_survived_ * 100 >= old_bytes_ * kMinPromotionSurvivalPercent;
+    }
+    VLOG(heap) << "Old object survival " << PrettySize(old_bytes_survived_) << "/"
+               << PrettySize(old_bytes_) << ", promoting at next collection: "
+               << promote_old_objects_;
     // Decide whether to do a whole heap collection or a bump pointer
     // only space collection at the next collection by updating
     // collect_from_space_only_.
@@ -235,6 +235,17 @@ class SemiSpace : public GarbageCollector {
   // bump pointer space to the non-moving space.
   uint64_t bytes_promoted_;
 
+  // Used for the generational mode. During a collection, the bytes of
+  // the objects allocated before the last collection, and how many of
+  // them have survived so far.
+  uint64_t old_bytes_;
+  uint64_t old_bytes_survived_;
+
+  // Used for the generational mode. When true, the objects allocated
+  // before the last collection are promoted, otherwise they are copied
+  // to the to-space once more. Adapted to their survival rate.
+  bool promote_old_objects_;
+
   // Used for the generational mode. Keeps track of how many bytes of
   // objects have been copied so far from the bump pointer space to
   // the non-moving space, since the last whole heap collection.
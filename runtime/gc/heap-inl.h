@@ -181,7 +181,10 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self,
     DCHECK(!Runtime::Current()->HasStatsEnabled());
   }
   if (kInstrumented) {
-    if (IsAllocTrackingEnabled()) {
+    const size_t sampling_interval = GetAllocationSamplingInterval();
+    const bool sampled = sampling_interval == 0U ||
+        SampleAllocation(self, bytes_allocated, sampling_interval);
+    if (IsAllocTrackingEnabled() && sampled) {
       // allocation_records_ is not null since it never becomes null after allocation tracking is
       // enabled.
       DCHECK(allocation_records_ != nullptr);
@@ -192,6 +195,9 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self,
       // Same as above. We assume that a listener that was once stored will never be deleted.
       // Otherwise we'd have to perform this under a lock.
       l->ObjectAllocated(self, &obj, bytes_allocated);
+      if (sampled) {
+        l->ObjectSampled(self, &obj, bytes_allocated);
+      }
     }
   } else {
     DCHECK(!IsAllocTrackingEnabled());
@@ -231,6 +237,21 @@ inline void Heap::PushOnAllocationStack(Thread* self, ObjPtr<mirror::Object>* ob
   }
 }
 
+inline bool Heap::SampleAllocation(Thread* self, size_t byte_count, size_t interval) {
+  DCHECK_NE(interval, 0U);
+  size_t remaining = self->GetAllocSampleBytesRemaining();
+  if (UNLIKELY(remaining == 0U)) {
+    // First allocation of this thread with sampling enabled.
+    remaining = NextAllocationSampleInterval(interval);
+  }
+  if (LIKELY(byte_count < remaining)) {
+    self->SetAllocSampleBytesRemaining(remaining - byte_count);
+    return false;
+  }
+  self->SetAllocSampleBytesRemaining(NextAllocationSampleInterval(interval));
+  return true;
+}
+
 template <bool kInstrumented, typename PreFenceVisitor>
 inline mirror::Object* Heap::AllocLargeObject(Thread* self,
                                               ObjPtr<mirror::Class>* klass,
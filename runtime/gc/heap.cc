@@ -16,10 +16,15 @@
 
 #include "heap.h"
 
+#include <cmath>
 #include <limits>
 #include <memory>
 #include <vector>
 
+#if defined(__BIONIC__) || defined(__GLIBC__)
+#include <malloc.h>  // For mallinfo().
+#endif
+
 #include "android-base/stringprintf.h"
 
 #include "allocation_listener.h"
@@ -101,6 +106,22 @@ DEFINE_RUNTIME_DEBUG_FLAG(Heap, kStressCollectorTransition);
 // Minimum amount of remaining bytes before a concurrent GC is triggered.
 static constexpr size_t kMinConcurrentRemainingBytes = 128 * KB;
 static constexpr size_t kMaxConcurrentRemainingBytes = 512 * KB;
+// GC pacing: the pause percentile compared against the pause target, the factor the pacing
+// multipliers change by after each collection, and their upper bound.
+static constexpr double kGcPacingPausePercentile = 0.95;
+static constexpr double kGcPacingStep = 1.25;
+static constexpr double kMaxGcPacingMultiplier = 4.0;
+// Lower bound of the region space evacuation budget when pacing for a pause target.
+static constexpr size_t kMinPacedEvacuatedLivePercent = 2U;
+// Fragmentation compaction: the fraction of the main space that must be free, and the least free
+// space, for a compaction to be worth it, and the least time between two of them.
+static constexpr double kFragmentationCompactionThreshold = 0.5;
+static constexpr uint64_t kMinFragmentationCompactionFreeBytes = 8 * MB;
+static constexpr uint64_t kMinFragmentationCompactionInterval = MsToNs(30 * 1000);
+// How long RegisterNativeAllocation waits for the pending finalizers, in nanoseconds.
+static constexpr uint64_t kNativeAllocationFinalizeTimeout = MsToNs(250u);
+// The assumed cost of a homogeneous space compaction until one has been measured.
+static constexpr uint64_t kDefaultHomogeneousSpaceCompactNsPerKB = 2000U;
 // Sticky GC throughput adjustment, divided by 4. Increasing this causes sticky GC to occur more
 // relative to partial/full GC. This may be desirable since sticky GCs interfere less with mutator
 // threads (lower pauses, use less memory bandwidth).
@@ -191,7 +212,13 @@ Heap::Heap(size_t initial_size,
            bool gc_stress_mode,
            bool measure_gc_performance,
            bool use_homogeneous_space_compaction_for_oom,
-           uint64_t min_interval_homogeneous_space_compaction_by_oom)
+           uint64_t min_interval_homogeneous_space_compaction_by_oom,
+           bool use_generational_cc,
+           HugePageType region_space_huge_pages,
+           uint64_t gc_pause_target,
+           double gc_cpu_budget,
+           bool region_space_numa,
+           uint64_t fragmentation_compact_max_pause)
     : non_moving_space_(nullptr),
       rosalloc_space_(nullptr),
       dlmalloc_space_(nullptr),
@@ -226,6 +253,8 @@ Heap::Heap(size_t initial_size,
       num_bytes_allocated_(0),
       new_native_bytes_allocated_(0),
       old_native_bytes_allocated_(0),
+      native_bytes_at_last_gc_(GetNativeBytes()),
+      native_allocations_since_sample_(0),
       num_bytes_freed_revoke_(0),
       verify_missing_card_marks_(false),
       verify_system_weaks_(false),
@@ -255,19 +284,35 @@ Heap::Heap(size_t initial_size,
       target_utilization_(target_utilization),
       foreground_heap_growth_multiplier_(foreground_heap_growth_multiplier),
       total_wait_time_(0),
+      total_tlab_refills_(0),
       verify_object_mode_(kVerifyObjectModeDisabled),
       disable_moving_gc_count_(0),
       semi_space_collector_(nullptr),
       mark_compact_collector_(nullptr),
       concurrent_copying_collector_(nullptr),
+      young_concurrent_copying_collector_(nullptr),
+      active_concurrent_copying_collector_(nullptr),
+      use_generational_cc_(use_generational_cc),
+      region_space_huge_pages_(region_space_huge_pages),
+      region_space_numa_(region_space_numa),
+      gc_pause_target_ns_(gc_pause_target),
+      gc_cpu_budget_(gc_cpu_budget),
+      gc_pacing_growth_multiplier_(1.0),
+      gc_pacing_headroom_multiplier_(1.0),
+      gc_cpu_fraction_(0.0),
+      last_gc_end_time_ns_(0U),
       is_running_on_memory_tool_(Runtime::Current()->IsRunningOnMemoryTool()),
       use_tlab_(use_tlab),
       main_space_backup_(nullptr),
       min_interval_homogeneous_space_compaction_by_oom_(
           min_interval_homogeneous_space_compaction_by_oom),
       last_time_homogeneous_space_compaction_by_oom_(NanoTime()),
+      fragmentation_compact_max_pause_ns_(fragmentation_compact_max_pause),
+      homogeneous_space_compact_ns_per_kb_(kDefaultHomogeneousSpaceCompactNsPerKB),
+      last_time_fragmentation_compaction_(0U),
       pending_collector_transition_(nullptr),
       pending_heap_trim_(nullptr),
+      pending_fragmentation_compaction_(nullptr),
       use_homogeneous_space_compaction_for_oom_(use_homogeneous_space_compaction_for_oom),
       running_collection_is_blocking_(false),
       blocking_gc_count_(0U),
@@ -280,6 +325,8 @@ Heap::Heap(size_t initial_size,
       blocking_gc_count_rate_histogram_("blocking gc count rate histogram", 1U,
                                         kGcCountRateMaxBucketCount),
       alloc_tracking_enabled_(false),
+      alloc_sampling_interval_(0U),
+      alloc_sampling_seed_(NanoTime()),
       backtrace_lock_(nullptr),
       seen_backtrace_count_(0u),
       unique_backtrace_count_(0u),
@@ -437,9 +484,13 @@ Heap::Heap(size_t initial_size,
     // Reserve twice the capacity, to allow evacuating every region for explicit GCs.
     MemMap* region_space_mem_map = space::RegionSpace::CreateMemMap(kRegionSpaceName,
                                                                     capacity_ * 2,
-                                                                    request_begin);
+                                                                    request_begin,
+                                                                    region_space_huge_pages_);
     CHECK(region_space_mem_map != nullptr) << "No region space mem map";
-    region_space_ = space::RegionSpace::Create(kRegionSpaceName, region_space_mem_map);
+    region_space_ = space::RegionSpace::Create(kRegionSpaceName,
+                                               region_space_mem_map,
+                                               region_space_huge_pages_,
+                                               region_space_numa_);
     AddSpace(region_space_);
   } else if (IsMovingGc(foreground_collector_type_) &&
       foreground_collector_type_ != kCollectorTypeGSS) {
@@ -593,11 +644,24 @@ Heap::Heap(size_t initial_size,
     }
     if (MayUseCollector(kCollectorTypeCC)) {
       concurrent_copying_collector_ = new collector::ConcurrentCopying(this,
+                                                                       /*young_gen*/ false,
+                                                                       use_generational_cc_,
                                                                        "",
                                                                        measure_gc_performance);
       DCHECK(region_space_ != nullptr);
       concurrent_copying_collector_->SetRegionSpace(region_space_);
       garbage_collectors_.push_back(concurrent_copying_collector_);
+      if (use_generational_cc_) {
+        young_concurrent_copying_collector_ = new collector::ConcurrentCopying(
+            this,
+            /*young_gen*/ true,
+            use_generational_cc_,
+            "young",
+            measure_gc_performance);
+        young_concurrent_copying_collector_->SetRegionSpace(region_space_);
+        garbage_collectors_.push_back(young_concurrent_copying_collector_);
+      }
+      active_concurrent_copying_collector_ = concurrent_copying_collector_;
     }
     if (MayUseCollector(kCollectorTypeMC)) {
       mark_compact_collector_ = new collector::MarkCompact(this);
@@ -777,6 +841,33 @@ void Heap::DecrementDisableMovingGC(Thread* self) {
   --disable_moving_gc_count_;
 }
 
+void Heap::PinObjectForCriticalSection(Thread* self, ObjPtr<mirror::Object> obj) {
+  DCHECK(IsMovableObject(obj));
+  if (!kUseReadBarrier) {
+    IncrementDisableMovingGC(self);
+  } else if (region_space_ != nullptr && region_space_->HasAddress(obj.Ptr())) {
+    // A pinned region is never evacuated, so `obj` stays in place without delaying the GC.
+    // The thread flip cannot happen while we are runnable, so the next collection sees the pin.
+    region_space_->PinRegionOf(obj.Ptr());
+  } else {
+    // For the CC collector, we only need to wait for the thread flip rather than the whole GC
+    // to occur thanks to the to-space invariant.
+    IncrementDisableThreadFlip(self);
+  }
+}
+
+void Heap::UnpinObjectForCriticalSection(Thread* self, ObjPtr<mirror::Object> obj) {
+  DCHECK(IsMovableObject(obj));
+  if (!kUseReadBarrier) {
+    DecrementDisableMovingGC(self);
+  } else if (region_space_ != nullptr && region_space_->HasAddress(obj.Ptr())) {
+    // The object did not move while pinned, so it is still in the region pinned above.
+    region_space_->UnpinRegionOf(obj.Ptr());
+  } else {
+    DecrementDisableThreadFlip(self);
+  }
+}
+
 void Heap::IncrementDisableThreadFlip(Thread* self) {
   // Supposed to be called by mutators. If thread_flip_running_ is true, block. Otherwise, go ahead.
   CHECK(kUseReadBarrier);
@@ -895,7 +986,11 @@ void Heap::UpdateProcessState(ProcessState old_process_state, ProcessState new_p
 void Heap::CreateThreadPool() {
   const size_t num_threads = std::max(parallel_gc_threads_, conc_gc_threads_);
   if (num_threads != 0) {
-    thread_pool_.reset(new ThreadPool("Heap thread pool", num_threads));
+    // The parallel GC tasks split off more tasks from the workers, let them keep those local.
+    thread_pool_.reset(new ThreadPool("Heap thread pool",
+                                      num_threads,
+                                      /* create_peers */ false,
+                                      /* work_stealing */ true));
   }
 }
 
@@ -1025,6 +1120,12 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
   os << "Total mutator paused time: " << PrettyDuration(total_paused_time) << "\n";
   os << "Total time waiting for GC to complete: " << PrettyDuration(total_wait_time_) << "\n";
   os << "Total GC count: " << GetGcCount() << "\n";
+  os << "Total TLAB refills: " << GetTlabRefillCount() << "\n";
+  if (IsGcPacingEnabled()) {
+    os << "GC pacing growth multiplier: " << gc_pacing_growth_multiplier_
+       << " headroom multiplier: " << gc_pacing_headroom_multiplier_
+       << " GC time fraction: " << gc_cpu_fraction_ << "\n";
+  }
   os << "Total GC time: " << PrettyDuration(GetGcTime()) << "\n";
   os << "Total blocking GC count: " << GetBlockingGcCount() << "\n";
   os << "Total blocking GC time: " << PrettyDuration(GetBlockingGcTime()) << "\n";
@@ -1051,6 +1152,9 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
   os << "Registered native bytes allocated: "
      << old_native_bytes_allocated_.LoadRelaxed() + new_native_bytes_allocated_.LoadRelaxed()
      << "\n";
+  os << "Native bytes allocated: " << GetNativeBytes()
+     << " (" << native_bytes_at_last_gc_.LoadRelaxed() << " at last GC, watermark "
+     << NativeAllocationGcWatermark() << ")\n";
 
   BaseMutex::DumpAll(os);
 }
@@ -1278,6 +1382,13 @@ void Heap::Trim(Thread* self) {
     size_t count = runtime->GetMonitorList()->DeflateMonitors();
     VLOG(heap) << "Deflating " << count << " monitors took "
         << PrettyDuration(NanoTime() - start_time);
+  } else {
+    // Still return the idle monitors to the pool, without a pause.
+    ScopedTrace trace("Deflating idle monitors");
+    uint64_t start_time = NanoTime();
+    size_t count = runtime->GetMonitorList()->DeflateIdleMonitors(self);
+    VLOG(heap) << "Concurrently deflating " << count << " monitors took "
+        << PrettyDuration(NanoTime() - start_time);
   }
   TrimIndirectReferenceTables(self);
   TrimSpaces(self);
@@ -1351,6 +1462,9 @@ void Heap::TrimSpaces(Thread* self) {
         total_alloc_space_size += malloc_space->Size();
       }
     }
+    if (large_object_space_ != nullptr) {
+      managed_reclaimed += large_object_space_->Trim();
+    }
   }
   total_alloc_space_allocated = GetBytesAllocated();
   if (large_object_space_ != nullptr) {
@@ -1941,6 +2055,8 @@ HomogeneousSpaceCompactResult Heap::PerformHomogeneousSpaceCompact() {
     count_performed_homogeneous_space_compaction_++;
     // Print statics log and resume all threads.
     uint64_t duration = NanoTime() - start_time;
+    homogeneous_space_compact_ns_per_kb_ =
+        duration / std::max<uint64_t>(space_size_after_compaction / KB, 1U);
     VLOG(heap) << "Heap homogeneous space compaction took " << PrettyDuration(duration) << " size: "
                << PrettySize(space_size_before_compaction) << " -> "
                << PrettySize(space_size_after_compaction) << " compact-ratio: "
@@ -2129,6 +2245,9 @@ void Heap::ChangeCollector(CollectorType collector_type) {
     gc_plan_.clear();
     switch (collector_type_) {
       case kCollectorTypeCC: {
+        if (use_generational_cc_) {
+          gc_plan_.push_back(collector::kGcTypeSticky);
+        }
         gc_plan_.push_back(collector::kGcTypeFull);
         if (use_tlab_) {
           ChangeAllocator(kAllocatorTypeRegionTLAB);
@@ -2431,6 +2550,8 @@ void Heap::PreZygoteFork() {
   }
   AddModUnionTable(mod_union_table);
   large_object_space_->SetAllLargeObjectsAsZygoteObjects(self);
+  // Don't let every forked app inherit the mappings cached for reuse.
+  large_object_space_->Trim();
   if (collector::SemiSpace::kUseRememberedSet) {
     // Add a new remembered set for the post-zygote non-moving space.
     accounting::RememberedSet* post_zygote_non_moving_space_rem_set =
@@ -2556,6 +2677,7 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
     // old_native_bytes_allocated_ now that GC has been triggered, resetting
     // new_native_bytes_allocated_ to zero in the process.
     old_native_bytes_allocated_.FetchAndAddRelaxed(new_native_bytes_allocated_.ExchangeRelaxed(0));
+    native_bytes_at_last_gc_.StoreRelaxed(GetNativeBytes());
   }
 
   DCHECK_LT(gc_type, collector::kGcTypeMax);
@@ -2578,7 +2700,12 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
         collector = semi_space_collector_;
         break;
       case kCollectorTypeCC:
-        collector = concurrent_copying_collector_;
+        if (use_generational_cc_ && gc_type == collector::kGcTypeSticky && !clear_soft_references) {
+          collector = young_concurrent_copying_collector_;
+        } else {
+          collector = concurrent_copying_collector_;
+        }
+        active_concurrent_copying_collector_ = down_cast<collector::ConcurrentCopying*>(collector);
         break;
       case kCollectorTypeMC:
         mark_compact_collector_->SetSpace(bump_pointer_space_);
@@ -2587,7 +2714,9 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
       default:
         LOG(FATAL) << "Invalid collector type " << static_cast<size_t>(collector_type_);
     }
-    if (collector != mark_compact_collector_ && collector != concurrent_copying_collector_) {
+    if (collector != mark_compact_collector_ &&
+        collector != concurrent_copying_collector_ &&
+        collector != young_concurrent_copying_collector_) {
       temp_space_->GetMemMap()->Protect(PROT_READ | PROT_WRITE);
       if (kIsDebugBuild) {
         // Try to read each page of the memory map in case mprotect didn't work properly b/19894268.
@@ -2595,7 +2724,9 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
       }
       CHECK(temp_space_->IsEmpty());
     }
-    gc_type = collector::kGcTypeFull;  // TODO: Not hard code this in.
+    if (collector != young_concurrent_copying_collector_) {
+      gc_type = collector::kGcTypeFull;  // TODO: Not hard code this in.
+    }
   } else if (current_allocator_ == kAllocatorTypeRosAlloc ||
       current_allocator_ == kAllocatorTypeDlMalloc) {
     collector = FindCollectorByGcType(gc_type);
@@ -2617,6 +2748,7 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
   total_objects_freed_ever_ += GetCurrentGcIteration()->GetFreedObjects();
   total_bytes_freed_ever_ += GetCurrentGcIteration()->GetFreedBytes();
   RequestTrim(self);
+  RequestFragmentationCompaction(self);
   // Enqueue cleared references.
   reference_processor_->EnqueueClearedReferences(self);
   // Grow the heap so that we know when to perform the next GC.
@@ -3437,6 +3569,53 @@ double Heap::HeapGrowthMultiplier() const {
   return foreground_heap_growth_multiplier_;
 }
 
+void Heap::UpdateGcPacing(collector::GarbageCollector* collector_ran) {
+  const uint64_t now = NanoTime();
+  const uint64_t duration = current_gc_iteration_.GetDurationNs();
+  if (gc_cpu_budget_ > 0.0 && last_gc_end_time_ns_ != 0U && now > last_gc_end_time_ns_) {
+    // Approximate the GC CPU usage with the share of the wall time since the end of the previous
+    // collection that was spent in this one.
+    const double sample = static_cast<double>(duration) / (now - last_gc_end_time_ns_);
+    gc_cpu_fraction_ = (gc_cpu_fraction_ + std::min(sample, 1.0)) / 2;
+    if (gc_cpu_fraction_ > gc_cpu_budget_) {
+      // Over budget, collect less often by growing the heap more.
+      gc_pacing_growth_multiplier_ =
+          std::min(gc_pacing_growth_multiplier_ * kGcPacingStep, kMaxGcPacingMultiplier);
+    } else if (gc_cpu_fraction_ < gc_cpu_budget_ / 2) {
+      // Well within budget, give the memory back.
+      gc_pacing_growth_multiplier_ = std::max(gc_pacing_growth_multiplier_ / kGcPacingStep, 1.0);
+    }
+  }
+  if (gc_pause_target_ns_ != 0U) {
+    uint64_t pause = collector_ran->GetPauseTimePercentileNs(kGcPacingPausePercentile);
+    if (current_gc_iteration_.GetGcCause() == kGcCauseForAlloc) {
+      // The allocating thread waited for the whole collection, usually because the concurrent
+      // collection started too late.
+      pause = std::max(pause, duration);
+    }
+    if (pause > gc_pause_target_ns_) {
+      // Start the concurrent collections earlier and have them evacuate fewer regions so that they
+      // finish before the mutators run out of memory.
+      gc_pacing_headroom_multiplier_ =
+          std::min(gc_pacing_headroom_multiplier_ * kGcPacingStep, kMaxGcPacingMultiplier);
+      if (region_space_ != nullptr) {
+        region_space_->SetMaxEvacuatedLivePercent(
+            std::max(region_space_->GetMaxEvacuatedLivePercent() - 1U,
+                     kMinPacedEvacuatedLivePercent));
+      }
+    } else if (pause < gc_pause_target_ns_ / 2) {
+      gc_pacing_headroom_multiplier_ =
+          std::max(gc_pacing_headroom_multiplier_ / kGcPacingStep, 1.0);
+      if (region_space_ != nullptr) {
+        region_space_->SetMaxEvacuatedLivePercent(
+            std::min(region_space_->GetMaxEvacuatedLivePercent() + 1U,
+                     space::RegionSpace::kDefaultMaxEvacuatedLivePercent));
+      }
+    }
+  }
+  last_gc_end_time_ns_ = now;
+}
+
 void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
                               uint64_t bytes_allocated_before_gc) {
   // We know what our utilization is at this moment.
@@ -3444,10 +3623,13 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
   const uint64_t bytes_allocated = GetBytesAllocated();
   // Trace the new heap size after the GC is finished.
   TraceHeapSize(bytes_allocated);
+  if (IsGcPacingEnabled()) {
+    UpdateGcPacing(collector_ran);
+  }
   uint64_t target_size;
   collector::GcType gc_type = collector_ran->GetGcType();
-  // Use the multiplier to grow more for foreground.
-  const double multiplier = HeapGrowthMultiplier();
+  // Use the multiplier to grow more for foreground, and for the GC pacing.
+  const double multiplier = HeapGrowthMultiplier() * gc_pacing_growth_multiplier_;
   const uint64_t adjusted_min_free = static_cast<uint64_t>(min_free_ * multiplier);
   const uint64_t adjusted_max_free = static_cast<uint64_t>(max_free_ * multiplier);
   if (gc_type != collector::kGcTypeSticky) {
@@ -3463,6 +3645,11 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
     collector::GcType non_sticky_gc_type = NonStickyGcType();
     // Find what the next non sticky collector will be.
     collector::GarbageCollector* non_sticky_collector = FindCollectorByGcType(non_sticky_gc_type);
+    if (use_generational_cc_ && non_sticky_collector == nullptr) {
+      // The full concurrent copying collector reports itself as a partial collector.
+      non_sticky_collector = FindCollectorByGcType(collector::kGcTypePartial);
+    }
+    CHECK(non_sticky_collector != nullptr);
     // If the throughput of the current sticky GC >= throughput of the non sticky collector, then
     // do another sticky collection next.
     // We also check that the bytes allocated aren't over the footprint limit in order to prevent a
@@ -3499,6 +3686,9 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
       size_t remaining_bytes = bytes_allocated_during_gc;
       remaining_bytes = std::min(remaining_bytes, kMaxConcurrentRemainingBytes);
       remaining_bytes = std::max(remaining_bytes, kMinConcurrentRemainingBytes);
+      // Leave more room for the allocations during the next collection if the GC pacing asks for
+      // it.
+      remaining_bytes = static_cast<size_t>(remaining_bytes * gc_pacing_headroom_multiplier_);
       if (UNLIKELY(remaining_bytes > max_allowed_footprint_)) {
         // A never going to happen situation that from the estimated allocation rate we will exceed
         // the applications entire footprint with the given estimated allocation rate. Schedule
@@ -3718,6 +3908,68 @@ void Heap::RequestTrim(Thread* self) {
   task_processor_->AddTask(self, added_task);
 }
 
+class Heap::FragmentationCompactTask : public HeapTask {
+ public:
+  explicit FragmentationCompactTask(uint64_t delta_time) : HeapTask(NanoTime() + delta_time) { }
+  virtual void Run(Thread* self) OVERRIDE {
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    // Check again, the collections since the request may have changed the picture.
+    if (heap->ShouldCompactForFragmentation()) {
+      heap->last_time_fragmentation_compaction_ = NanoTime();
+      heap->PerformHomogeneousSpaceCompact();
+    }
+    heap->ClearPendingFragmentationCompaction(self);
+  }
+};
+
+void Heap::ClearPendingFragmentationCompaction(Thread* self) {
+  MutexLock mu(self, *pending_task_lock_);
+  pending_fragmentation_compaction_ = nullptr;
+}
+
+bool Heap::ShouldCompactForFragmentation() {
+  if (fragmentation_compact_max_pause_ns_ == 0U ||
+      !SupportHomogeneousSpaceCompactAndCollectorTransitions() ||
+      NanoTime() - last_time_fragmentation_compaction_ < kMinFragmentationCompactionInterval) {
+    return false;
+  }
+  // Getting the exact bytes allocated in the main space requires walking it, so bound them by the
+  // bytes allocated in the heap outside the large object space. This underestimates the free
+  // space and overestimates the pause, both of which only make us compact less often.
+  uint64_t live_bytes = GetBytesAllocated();
+  if (large_object_space_ != nullptr) {
+    live_bytes -= std::min(live_bytes, large_object_space_->GetBytesAllocated());
+  }
+  const uint64_t footprint = main_space_->Size();
+  if (footprint <= live_bytes) {
+    return false;
+  }
+  const uint64_t free_bytes = footprint - live_bytes;
+  if (free_bytes < kMinFragmentationCompactionFreeBytes ||
+      free_bytes < footprint * kFragmentationCompactionThreshold) {
+    return false;
+  }
+  const uint64_t expected_pause = live_bytes / KB * homogeneous_space_compact_ns_per_kb_;
+  return expected_pause <= fragmentation_compact_max_pause_ns_;
+}
+
+void Heap::RequestFragmentationCompaction(Thread* self) {
+  if (!CanAddHeapTask(self) || !ShouldCompactForFragmentation()) {
+    return;
+  }
+  FragmentationCompactTask* added_task = nullptr;
+  {
+    MutexLock mu(self, *pending_task_lock_);
+    if (pending_fragmentation_compaction_ != nullptr) {
+      return;
+    }
+    // Run in the daemon rather than at the end of the GC so that the mutators resume first.
+    added_task = new FragmentationCompactTask(0U);
+    pending_fragmentation_compaction_ = added_task;
+  }
+  task_processor_->AddTask(self, added_task);
+}
+
 void Heap::RevokeThreadLocalBuffers(Thread* thread) {
   if (rosalloc_space_ != nullptr) {
     size_t freed_bytes_revoke = rosalloc_space_->RevokeThreadLocalBuffers(thread);
@@ -3773,6 +4025,18 @@ void Heap::RunFinalization(JNIEnv* env, uint64_t timeout) {
 void Heap::RegisterNativeAllocation(JNIEnv* env, size_t bytes) {
   size_t old_value = new_native_bytes_allocated_.FetchAndAddRelaxed(bytes);
 
+  if (old_value > NativeAllocationBackPressureWatermark() * HeapGrowthMultiplier()) {
+    // Native memory keeps growing although GCs have been requested. The objects owning it are
+    // likely waiting for their finalizers, which release the memory, so let the finalizers catch
+    // up instead of requesting more GCs that would only grow the backlog. Daemon threads, the
+    // finalizer daemon among them, are never throttled.
+    Thread* self = ThreadForEnv(env);
+    if (!self->IsDaemon() && reference_processor_->TakePendingFinalizerCount() != 0u) {
+      ScopedTrace trace("Wait for finalizers on native allocation");
+      RunFinalization(env, kNativeAllocationFinalizeTimeout);
+    }
+  }
+
   if (old_value > NativeAllocationGcWatermark() * HeapGrowthMultiplier() &&
              !IsGCRequestPending()) {
     // Trigger another GC because there have been enough native bytes
@@ -3782,6 +4046,42 @@ void Heap::RegisterNativeAllocation(JNIEnv* env, size_t bytes) {
     } else {
       CollectGarbageInternal(NonStickyGcType(), kGcCauseForNativeAlloc, false);
     }
+  } else if (native_allocations_since_sample_.FetchAndAddRelaxed(1u) + 1u >=
+             kNativeAllocationSampleInterval) {
+    // The registered bytes do not call for a GC, but they may well miss most of the native
+    // memory the managed objects keep alive. Look at what malloc has to say.
+    native_allocations_since_sample_.StoreRelaxed(0u);
+    CheckNativeMemoryPressure(ThreadForEnv(env));
+  }
+}
+
+size_t Heap::GetNativeBytes() const {
+#if defined(__BIONIC__) || defined(__GLIBC__)
+  struct mallinfo mi = mallinfo();
+  // In-use bytes of the arenas, plus the bytes in separately mmapped chunks which glibc does
+  // not count in the former.
+  size_t malloc_bytes = mi.uordblks;
+#if defined(__GLIBC__)
+  malloc_bytes += mi.hblkhd;
+#endif
+  return malloc_bytes;
+#else
+  return old_native_bytes_allocated_.LoadRelaxed() + new_native_bytes_allocated_.LoadRelaxed();
+#endif
+}
+
+void Heap::CheckNativeMemoryPressure(Thread* self) {
+  size_t native_bytes = GetNativeBytes();
+  size_t native_bytes_at_last_gc = native_bytes_at_last_gc_.LoadRelaxed();
+  if (native_bytes > native_bytes_at_last_gc &&
+      native_bytes - native_bytes_at_last_gc >
+          NativeAllocationGcWatermark() * HeapGrowthMultiplier() &&
+      !IsGCRequestPending()) {
+    if (IsGcConcurrent()) {
+      RequestConcurrentGC(self, kGcCauseForNativeAlloc, /*force_full*/true);
+    } else {
+      CollectGarbageInternal(NonStickyGcType(), kGcCauseForNativeAlloc, false);
+    }
   }
 }
 
@@ -3883,7 +4183,6 @@ void Heap::SweepAllocationRecords(IsMarkedVisitor* visitor) const {
 }
 
 void Heap::AllowNewAllocationRecords() const {
-  CHECK(!kUseReadBarrier);
   MutexLock mu(Thread::Current(), *Locks::alloc_tracker_lock_);
   AllocRecordObjectMap* allocation_records = GetAllocationRecords();
   if (allocation_records != nullptr) {
@@ -3892,7 +4191,6 @@ void Heap::AllowNewAllocationRecords() const {
 }
 
 void Heap::DisallowNewAllocationRecords() const {
-  CHECK(!kUseReadBarrier);
   MutexLock mu(Thread::Current(), *Locks::alloc_tracker_lock_);
   AllocRecordObjectMap* allocation_records = GetAllocationRecords();
   if (allocation_records != nullptr) {
@@ -4031,7 +4329,8 @@ mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
     const size_t min_expand_size = alloc_size - self->TlabSize();
     const size_t expand_bytes = std::max(
         min_expand_size,
-        std::min(self->TlabRemainingCapacity() - self->TlabSize(), kPartialTlabSize));
+        std::min(self->TlabRemainingCapacity() - self->TlabSize(),
+                 ComputeTlabSize(self, kPartialTlabSize, space::RegionSpace::kRegionSize)));
     if (UNLIKELY(IsOutOfMemoryOnAllocation(allocator_type, expand_bytes, grow))) {
       return nullptr;
     }
@@ -4040,7 +4339,7 @@ mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
     DCHECK_LE(alloc_size, self->TlabSize());
   } else if (allocator_type == kAllocatorTypeTLAB) {
     DCHECK(bump_pointer_space_ != nullptr);
-    const size_t new_tlab_size = alloc_size + kDefaultTLABSize;
+    const size_t new_tlab_size = alloc_size + ComputeTlabSize(self, kDefaultTLABSize, kMaxTLABSize);
     if (UNLIKELY(IsOutOfMemoryOnAllocation(allocator_type, new_tlab_size, grow))) {
       return nullptr;
     }
@@ -4059,7 +4358,8 @@ mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
                                             space::RegionSpace::kRegionSize,
                                             grow))) {
         const size_t new_tlab_size = kUsePartialTlabs
-            ? std::max(alloc_size, kPartialTlabSize)
+            ? std::max(alloc_size,
+                       ComputeTlabSize(self, kPartialTlabSize, space::RegionSpace::kRegionSize))
             : gc::space::RegionSpace::kRegionSize;
         // Try to allocate a tlab.
         if (!region_space_->AllocNewTlab(self, new_tlab_size)) {
@@ -4101,6 +4401,43 @@ mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
   return ret;
 }
 
+size_t Heap::NextAllocationSampleInterval(size_t mean) {
+  // SplitMix64 over a shared counter, the race free step keeps the threads' sequences distinct.
+  uint64_t z = alloc_sampling_seed_.FetchAndAddRelaxed(UINT64_C(0x9e3779b97f4a7c15)) +
+      UINT64_C(0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+  z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+  z ^= z >> 31;
+  // Exponentially distributed intervals make the sample points a Poisson process over the
+  // allocated bytes, so that periodic allocation patterns do not bias the samples. Use the top 53
+  // bits for a uniform value in (0, 1].
+  const double uniform =
+      static_cast<double>((z >> 11) + 1U) / static_cast<double>(UINT64_C(1) << 53);
+  const double interval = -std::log(uniform) * static_cast<double>(mean);
+  return static_cast<size_t>(std::min(interval, static_cast<double>(mean) * 64.0)) + 1U;
+}
+
+size_t Heap::ComputeTlabSize(Thread* self, size_t default_size, size_t max_size) {
+  const uint64_t now = NanoTime();
+  size_t size = self->GetTlabRefillSize();
+  if (size == 0) {
+    // First refill of this thread.
+    size = default_size;
+  } else {
+    // The thread allocated about `size` bytes since the previous refill. Scale the size by the
+    // ratio of the target refill interval to the actual one, and average it with the previous
+    // size to dampen bursts.
+    const uint64_t interval = std::max<uint64_t>(now - self->GetLastTlabRefillTimeNs(), 1u);
+    const uint64_t target = std::min<uint64_t>(
+        static_cast<uint64_t>(size) * kTLABTargetRefillInterval / interval, max_size);
+    size = (size + static_cast<size_t>(target)) / 2;
+  }
+  size = RoundUp(std::min(std::max(size, kMinTLABSize), max_size), kObjectAlignment);
+  self->RecordTlabRefill(size, now);
+  total_tlab_refills_.FetchAndAddRelaxed(1);
+  return size;
+}
+
 const Verification* Heap::GetVerification() const {
   return verification_.get();
 }
@@ -39,6 +39,7 @@
 #include "gc/space/large_object_space.h"
 #include "globals.h"
 #include "handle.h"
+#include "mem_map.h"
 #include "obj_ptr.h"
 #include "offsets.h"
 #include "process_state.h"
@@ -137,8 +138,21 @@ class Heap {
   static constexpr size_t kDefaultLongPauseLogThreshold = MsToNs(5);
   static constexpr size_t kDefaultLongGCLogThreshold = MsToNs(100);
   static constexpr size_t kDefaultTLABSize = 32 * KB;
+  // Bounds of the adaptive TLAB (refill) size, see ComputeTlabSize().
+  static constexpr size_t kMinTLABSize = 4 * KB;
+  static constexpr size_t kMaxTLABSize = 256 * KB;
+  // The adaptive TLAB size aims at one TLAB refill per thread in this interval.
+  static constexpr uint64_t kTLABTargetRefillInterval = MsToNs(1);
   static constexpr double kDefaultTargetUtilization = 0.5;
   static constexpr double kDefaultHeapGrowthMultiplier = 2.0;
+  // Multiple of the native allocation GC watermark at which threads registering native
+  // allocations start waiting for the pending finalizers.
+  static constexpr size_t kNativeAllocationBackPressureFactor = 4u;
+  // Native memory growth tolerated between GCs, relative to the managed heap footprint.
+  static constexpr double kNativeToManagedGrowthRatio = 0.5;
+  // RegisterNativeAllocation samples malloc once per this many calls, since mallinfo() is
+  // too expensive to call on every registration.
+  static constexpr uint32_t kNativeAllocationSampleInterval = 32u;
   // Primitive arrays larger than this size are put in the large object space.
   static constexpr size_t kMinLargeObjectThreshold = 3 * kPageSize;
   static constexpr size_t kDefaultLargeObjectThreshold = kMinLargeObjectThreshold;
@@ -197,7 +211,13 @@ class Heap {
        bool gc_stress_mode,
        bool measure_gc_performance,
        bool use_homogeneous_space_compaction,
-       uint64_t min_interval_homogeneous_space_compaction_by_oom);
+       uint64_t min_interval_homogeneous_space_compaction_by_oom,
+       bool use_generational_cc = false,
+       HugePageType region_space_huge_pages = HugePageType::kDisabled,
+       uint64_t gc_pause_target = 0U,
+       double gc_cpu_budget = 0.0,
+       bool region_space_numa = false,
+       uint64_t fragmentation_compact_max_pause = 0U);
 
   ~Heap();
 
@@ -324,6 +344,15 @@ class Heap {
   // Temporarily disable thread flip for JNI critical calls.
   void IncrementDisableThreadFlip(Thread* self) REQUIRES(!*thread_flip_lock_);
   void DecrementDisableThreadFlip(Thread* self) REQUIRES(!*thread_flip_lock_);
+  // Keep the movable object `obj` in place for a JNI critical section. With the concurrent
+  // copying collector, this pins the region holding `obj`, which lets collections proceed.
+  // Otherwise it disables moving GC, or thread flips.
+  void PinObjectForCriticalSection(Thread* self, ObjPtr<mirror::Object> obj)
+      REQUIRES(!*gc_complete_lock_, !*thread_flip_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+  void UnpinObjectForCriticalSection(Thread* self, ObjPtr<mirror::Object> obj)
+      REQUIRES(!*gc_complete_lock_, !*thread_flip_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
   void ThreadFlipBegin(Thread* self) REQUIRES(!*thread_flip_lock_);
   void ThreadFlipEnd(Thread* self) REQUIRES(!*thread_flip_lock_);
 
@@ -727,8 +756,14 @@ class Heap {
     return zygote_space_ != nullptr;
   }
 
+  // Return the concurrent copying collector that is running or will run next. With generational
+  // CC, this is either the young or the full collector, and is what read barriers dispatch on.
   collector::ConcurrentCopying* ConcurrentCopyingCollector() {
-    return concurrent_copying_collector_;
+    return active_concurrent_copying_collector_;
+  }
+
+  bool IsGenerationalConcurrentCopying() const {
+    return use_generational_cc_;
   }
 
   CollectorType CurrentCollectorType() {
@@ -752,6 +787,10 @@ class Heap {
   // Request an asynchronous trim.
   void RequestTrim(Thread* self) REQUIRES(!*pending_task_lock_);
 
+  // Request an asynchronous homogeneous space compaction if the main space is fragmented and the
+  // compaction is expected to pause for no longer than -XX:FragmentationCompactMaxPauseMs.
+  void RequestFragmentationCompaction(Thread* self) REQUIRES(!*pending_task_lock_);
+
   // Request asynchronous GC.
   void RequestConcurrentGC(Thread* self, GcCause cause, bool force_full)
       REQUIRES(!*pending_task_lock_);
@@ -769,6 +808,21 @@ class Heap {
   uint64_t GetGcTime() const;
   uint64_t GetBlockingGcCount() const;
   uint64_t GetBlockingGcTime() const;
+  // The total number of TLAB refills (new TLABs and partial TLAB expansions) of all threads.
+  uint64_t GetTlabRefillCount() const {
+    return total_tlab_refills_.LoadRelaxed();
+  }
+  // Whether the GC trigger point, heap growth and evacuated regions are paced to meet a pause time
+  // target (-XX:GcPauseTargetMs) or a GC CPU budget (-XX:GcCpuBudget).
+  bool IsGcPacingEnabled() const {
+    return gc_pause_target_ns_ != 0U || gc_cpu_budget_ > 0.0;
+  }
+  double GetGcPacingGrowthMultiplier() const {
+    return gc_pacing_growth_multiplier_;
+  }
+  double GetGcPacingHeadroomMultiplier() const {
+    return gc_pacing_headroom_multiplier_;
+  }
   void DumpGcCountRateHistogram(std::ostream& os) const REQUIRES(!*gc_complete_lock_);
   void DumpBlockingGcCountRateHistogram(std::ostream& os) const REQUIRES(!*gc_complete_lock_);
 
@@ -809,6 +863,20 @@ class Heap {
   void BroadcastForNewAllocationRecords() const
       REQUIRES(!Locks::alloc_tracker_lock_);
 
+  // Heap sampling support. Instrumented allocations are sampled at Poisson distributed intervals
+  // of allocated bytes with the given mean, 0 samples every allocation. Only sampled allocations
+  // are recorded by the allocation tracker and reported to AllocationListener::ObjectSampled.
+  void SetAllocationSamplingInterval(size_t bytes) {
+    alloc_sampling_interval_.StoreRelaxed(bytes);
+  }
+  size_t GetAllocationSamplingInterval() const {
+    return alloc_sampling_interval_.LoadRelaxed();
+  }
+
+  // Returns true if allocating byte_count bytes reaches the next sample point of the thread, for a
+  // non zero sampling interval. A new interval takes effect after the current sample point.
+  ALWAYS_INLINE bool SampleAllocation(Thread* self, size_t byte_count, size_t interval);
+
   void DisableGCForShutdown() REQUIRES(!*gc_complete_lock_);
 
   // Create a new alloc space and compact default alloc space to it.
@@ -837,6 +905,7 @@ class Heap {
   class ConcurrentGCTask;
   class CollectorTransitionTask;
   class HeapTrimTask;
+  class FragmentationCompactTask;
 
   // Compact source space to target space. Returns the collector used.
   collector::GarbageCollector* Compact(space::ContinuousMemMapAllocSpace* target_space,
@@ -947,6 +1016,14 @@ class Heap {
                                    size_t* bytes_tl_bulk_allocated)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Compute the size of the next TLAB refill of `self` from its allocation rate history and
+  // record the refill. Threads that refill often get larger TLABs (up to `max_size`), mostly idle
+  // threads get smaller ones (down to kMinTLABSize).
+  size_t ComputeTlabSize(Thread* self, size_t default_size, size_t max_size);
+
+  // Draw the number of bytes until the next sampled allocation for a mean sampling interval.
+  size_t NextAllocationSampleInterval(size_t mean);
+
   void ThrowOutOfMemoryError(Thread* self, size_t byte_count, AllocatorType allocator_type)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -1015,6 +1092,10 @@ class Heap {
   void GrowForUtilization(collector::GarbageCollector* collector_ran,
                           uint64_t bytes_allocated_before_gc = 0);
 
+  // Adjust the GC pacing multipliers (and the region space evacuation budget) from the pause
+  // times and the duration of the collection that just ran. Called by GrowForUtilization.
+  void UpdateGcPacing(collector::GarbageCollector* collector_ran);
+
   size_t GetPercentFree();
 
   // Swap the allocation stack with the live stack.
@@ -1042,6 +1123,10 @@ class Heap {
 
   void ClearConcurrentGCRequest();
   void ClearPendingTrim(Thread* self) REQUIRES(!*pending_task_lock_);
+  void ClearPendingFragmentationCompaction(Thread* self) REQUIRES(!*pending_task_lock_);
+  // Whether the main space is fragmented enough, and the compaction expected to be short enough,
+  // for a fragmentation compaction.
+  bool ShouldCompactForFragmentation();
   void ClearPendingCollectorTransition(Thread* self) REQUIRES(!*pending_task_lock_);
 
   // What kind of concurrency behavior is the runtime after? Currently true for concurrent mark
@@ -1085,7 +1170,25 @@ class Heap {
     // where the gc watermark update would exceed max_free_. Using max_free_
     // instead of the target utilization means the watermark doesn't depend on
     // the current number of registered native allocations.
-    return max_free_;
+    //
+    // Larger managed heaps may own proportionally more native memory (bitmaps,
+    // buffers) before a GC is worth it, so the watermark also grows with the
+    // managed footprint.
+    return std::max(max_free_,
+                    static_cast<size_t>(max_allowed_footprint_ * kNativeToManagedGrowthRatio));
+  }
+
+  // Returns the bytes currently allocated by malloc, or the registered native bytes when
+  // malloc statistics are not available.
+  size_t GetNativeBytes() const;
+
+  // Samples malloc and requests a GC if the native memory grew too much since the last GC.
+  void CheckNativeMemoryPressure(Thread* self) REQUIRES(!*gc_complete_lock_, !*pending_task_lock_);
+
+  // How large new_native_bytes_allocated_ can grow before threads registering native
+  // allocations wait for the pending finalizers to run.
+  ALWAYS_INLINE size_t NativeAllocationBackPressureWatermark() const {
+    return NativeAllocationGcWatermark() * kNativeAllocationBackPressureFactor;
   }
 
   void TraceHeapSize(size_t heap_size);
@@ -1243,6 +1346,14 @@ class Heap {
   // old_native_bytes_allocated_ and new_native_bytes_allocated_.
   Atomic<size_t> old_native_bytes_allocated_;
 
+  // Bytes allocated by malloc, sampled with mallinfo() when the last non-sticky GC started.
+  // Registrations only cover the allocations someone remembered to register, so the sampled
+  // growth since then is used as a second trigger for GCs for native allocations.
+  Atomic<size_t> native_bytes_at_last_gc_;
+
+  // Number of RegisterNativeAllocation calls since malloc was last sampled.
+  Atomic<uint32_t> native_allocations_since_sample_;
+
   // Number of bytes freed by thread local buffer revokes. This will
   // cancel out the ahead-of-time bulk counting of bytes allocated in
   // rosalloc thread-local buffers.  It is temporarily accumulated
@@ -1341,6 +1452,9 @@ class Heap {
   // Total time which mutators are paused or waiting for GC to complete.
   uint64_t total_wait_time_;
 
+  // Total number of TLAB refills, see ComputeTlabSize().
+  Atomic<uint64_t> total_tlab_refills_;
+
   // The current state of heap verification, may be enabled or disabled.
   VerifyObjectMode verify_object_mode_;
 
@@ -1351,6 +1465,34 @@ class Heap {
   collector::SemiSpace* semi_space_collector_;
   collector::MarkCompact* mark_compact_collector_;
   collector::ConcurrentCopying* concurrent_copying_collector_;
+  // Only non-null when generational CC is enabled.
+  collector::ConcurrentCopying* young_concurrent_copying_collector_;
+  // The CC collector which runs the current (or the next) collection. Only changed by the thread
+  // running the GC while no CC collection is in progress.
+  collector::ConcurrentCopying* active_concurrent_copying_collector_;
+
+  // Whether the concurrent copying collector runs sticky (young-generation) collections of the
+  // regions allocated since the previous collection, in addition to full collections.
+  const bool use_generational_cc_;
+
+  // How the region space (and with it, the TLABs) is backed by huge pages.
+  const HugePageType region_space_huge_pages_;
+
+  // Whether the region space binds its regions to NUMA nodes and hands out node-local TLABs.
+  const bool region_space_numa_;
+
+  // GC pacing goals, 0 when disabled. The pause target is compared against a percentile of the
+  // pause histogram of the collector that ran, the CPU budget is a fraction of the wall time.
+  const uint64_t gc_pause_target_ns_;
+  const double gc_cpu_budget_;
+  // GC pacing state, only accessed by the thread running the GC. The growth multiplier scales the
+  // free space the heap grows by after a collection, the headroom multiplier scales how early the
+  // next concurrent collection starts.
+  double gc_pacing_growth_multiplier_;
+  double gc_pacing_headroom_multiplier_;
+  // Smoothed fraction of the wall time spent in collections, and when the last one finished.
+  double gc_cpu_fraction_;
+  uint64_t last_gc_end_time_ns_;
 
   const bool is_running_on_memory_tool_;
   const bool use_tlab_;
@@ -1377,12 +1519,23 @@ class Heap {
   // Count for performed homogeneous space compaction.
   Atomic<size_t> count_performed_homogeneous_space_compaction_;
 
+  // Homogeneous space compactions may run while the process cares about pause times if the main
+  // space is fragmented and the compaction is expected to pause for at most this long. 0 when
+  // disabled.
+  const uint64_t fragmentation_compact_max_pause_ns_;
+  // The measured cost of the last homogeneous space compaction, in nanoseconds per KB of the
+  // compacted space. Used to predict the pause of the next one.
+  uint64_t homogeneous_space_compact_ns_per_kb_;
+  // Time of the last fragmentation compaction.
+  uint64_t last_time_fragmentation_compaction_;
+
   // Whether or not a concurrent GC is pending.
   Atomic<bool> concurrent_gc_pending_;
 
   // Active tasks which we can modify (change target time, desired collector type, etc..).
   CollectorTransitionTask* pending_collector_transition_ GUARDED_BY(pending_task_lock_);
   HeapTrimTask* pending_heap_trim_ GUARDED_BY(pending_task_lock_);
+  FragmentationCompactTask* pending_fragmentation_compaction_ GUARDED_BY(pending_task_lock_);
 
   // Whether or not we use homogeneous space compaction to avoid OOM errors.
   bool use_homogeneous_space_compaction_for_oom_;
@@ -1413,6 +1566,11 @@ class Heap {
   Atomic<bool> alloc_tracking_enabled_;
   std::unique_ptr<AllocRecordObjectMap> allocation_records_;
 
+  // Heap sampling support, the mean sampling interval in bytes and the state of the random number
+  // generator used to draw the intervals.
+  Atomic<size_t> alloc_sampling_interval_;
+  Atomic<uint64_t> alloc_sampling_seed_;
+
   // GC stress related data structures.
   Mutex* backtrace_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   // Debugging variables, seen backtraces vs unique backtraces.
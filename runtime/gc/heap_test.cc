@@ -18,6 +18,8 @@
 #include "common_runtime_test.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/space_bitmap-inl.h"
+#include "gc/collector/concurrent_copying.h"
+#include "gc/heap-inl.h"
 #include "handle_scope-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
@@ -91,6 +93,46 @@ TEST_F(HeapTest, HeapBitmapCapacityTest) {
   bitmap->Set(fake_end_of_heap_object);
 }
 
+TEST_F(HeapTest, AdaptiveTlabSize) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  if (!heap->IsMovingGc(heap->CurrentCollectorType())) {
+    // TLABs are only used by the moving collectors.
+    return;
+  }
+  ScopedObjectAccess soa(Thread::Current());
+  const uint64_t refills_before = heap->GetTlabRefillCount();
+  const size_t thread_refills_before = soa.Self()->GetTlabRefillCount();
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::Class> c(
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "[Ljava/lang/Object;")));
+  // Allocate more than a region's worth of small arrays to force TLAB refills.
+  for (size_t i = 0; i < 4096; ++i) {
+    mirror::ObjectArray<mirror::Object>::Alloc(soa.Self(), c.Get(), 64);
+  }
+  EXPECT_GT(soa.Self()->GetTlabRefillCount(), thread_refills_before);
+  EXPECT_GT(heap->GetTlabRefillCount(), refills_before);
+  EXPECT_GE(soa.Self()->GetTlabRefillSize(), Heap::kMinTLABSize);
+  EXPECT_LE(soa.Self()->GetTlabRefillSize(), Heap::kMaxTLABSize);
+}
+
+TEST_F(HeapTest, AllocationSampling) {
+  ScopedObjectAccess soa(Thread::Current());
+  Heap* heap = Runtime::Current()->GetHeap();
+  static constexpr size_t kInterval = 4 * KB;
+  static constexpr size_t kAllocSize = 48;
+  static constexpr size_t kNumAllocs = 1 * MB;
+  size_t samples = 0;
+  for (size_t i = 0; i < kNumAllocs; ++i) {
+    if (heap->SampleAllocation(soa.Self(), kAllocSize, kInterval)) {
+      ++samples;
+    }
+  }
+  // About 12K samples are expected, with a standard deviation of about 110.
+  const size_t expected = kNumAllocs * kAllocSize / kInterval;
+  EXPECT_GT(samples, expected * 7 / 8);
+  EXPECT_LT(samples, expected * 9 / 8);
+}
+
 TEST_F(HeapTest, DumpGCPerformanceOnShutdown) {
   Runtime::Current()->GetHeap()->CollectGarbage(/* clear_soft_references */ false);
   Runtime::Current()->SetDumpGCPerformanceOnShutdown(true);
@@ -108,5 +150,65 @@ TEST_F(ZygoteHeapTest, PreZygoteFork) {
   Runtime::Current()->GetHeap()->PreZygoteFork();
 }
 
+class GenerationalCCHeapTest : public CommonRuntimeTest {
+  void SetUpRuntimeOptions(RuntimeOptions* options) {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-Xgc:generational_cc", nullptr));
+  }
+};
+
+TEST_F(GenerationalCCHeapTest, YoungCollectionKeepsObjectsReferencedFromOldObjects) {
+  if (!kUseReadBarrier) {
+    // Generational CC is only available with the concurrent copying collector.
+    return;
+  }
+  Heap* heap = Runtime::Current()->GetHeap();
+  ASSERT_TRUE(heap->IsGenerationalConcurrentCopying());
+  static constexpr size_t kLength = 256;
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<2> hs(soa.Self());
+  Handle<mirror::Class> c(
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "[Ljava/lang/Object;")));
+  Handle<mirror::ObjectArray<mirror::Object>> array(
+      hs.NewHandle(mirror::ObjectArray<mirror::Object>::Alloc(soa.Self(), c.Get(), kLength)));
+  // Promote the array to the old generation.
+  heap->CollectGarbage(/* clear_soft_references */ false);
+  // The strings are only reachable through the (old) array, i.e. through a dirty card.
+  for (size_t i = 0; i < kLength; ++i) {
+    array->Set<false>(i, mirror::String::AllocFromModifiedUtf8(soa.Self(), "young"));
+  }
+  // A full collection is followed by a sticky (young) one.
+  heap->ConcurrentGC(soa.Self(), kGcCauseBackground, /* force_full */ false);
+  EXPECT_EQ(collector::kGcTypeSticky, heap->ConcurrentCopyingCollector()->GetGcType());
+  for (size_t i = 0; i < kLength; ++i) {
+    mirror::Object* obj = array->Get(i);
+    ASSERT_TRUE(obj != nullptr);
+    EXPECT_TRUE(obj->AsString()->Equals("young"));
+  }
+}
+
+class GcPacingHeapTest : public CommonRuntimeTest {
+  void SetUpRuntimeOptions(RuntimeOptions* options) {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    // Targets that can't be met, so that the pacing has to react.
+    options->push_back(std::make_pair("-XX:GcPauseTargetMs=0", nullptr));
+    options->push_back(std::make_pair("-XX:GcCpuBudget=0.0001", nullptr));
+  }
+};
+
+TEST_F(GcPacingHeapTest, MultipliersStayInRange) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  // A zero pause target disables that goal, only the CPU budget is paced.
+  ASSERT_TRUE(heap->IsGcPacingEnabled());
+  for (size_t i = 0; i < 10; ++i) {
+    heap->CollectGarbage(/* clear_soft_references */ false);
+    EXPECT_GE(heap->GetGcPacingGrowthMultiplier(), 1.0);
+    EXPECT_LE(heap->GetGcPacingGrowthMultiplier(), 4.0);
+    EXPECT_EQ(heap->GetGcPacingHeadroomMultiplier(), 1.0);
+  }
+  // Back to back collections are way over the CPU budget.
+  EXPECT_GT(heap->GetGcPacingGrowthMultiplier(), 1.0);
+}
+
 }  // namespace gc
 }  // namespace art
@@ -19,6 +19,7 @@
 #include "base/time_utils.h"
 #include "base/utils.h"
 #include "collector/garbage_collector.h"
+#include "heap.h"
 #include "java_vm_ext.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
@@ -44,7 +45,8 @@ ReferenceProcessor::ReferenceProcessor()
       weak_reference_queue_(Locks::reference_queue_weak_references_lock_),
       finalizer_reference_queue_(Locks::reference_queue_finalizer_references_lock_),
       phantom_reference_queue_(Locks::reference_queue_phantom_references_lock_),
-      cleared_references_(Locks::reference_queue_cleared_references_lock_) {
+      cleared_references_(Locks::reference_queue_cleared_references_lock_),
+      pending_finalizer_count_(0u) {
 }
 
 void ReferenceProcessor::EnableSlowPath() {
@@ -124,6 +126,31 @@ void ReferenceProcessor::StopPreservingReferences(Thread* self) {
   condition_.Broadcast(self);
 }
 
+size_t ReferenceProcessor::GetThreadCount(bool concurrent) {
+  // Like MarkSweep, use less threads if we are in a background state (non jank perceptible) since
+  // we want to leave more CPU time for the foreground apps.
+  Heap* heap = Runtime::Current()->GetHeap();
+  if (heap->GetThreadPool() == nullptr || !Runtime::Current()->InJankPerceptibleProcessState()) {
+    return 1;
+  }
+  return (concurrent ? heap->GetConcGCThreadCount() : heap->GetParallelGCThreadCount()) + 1;
+}
+
+void ReferenceProcessor::PreCleanReferences(TimingLogger* timings,
+                                            collector::GarbageCollector* collector) {
+  TimingLogger::ScopedTiming t(__FUNCTION__, timings);
+  if (collector->IsTransactionActive()) {
+    // Nothing is enqueued in transaction mode, see DelayReferenceReferent().
+    return;
+  }
+  Thread* self = Thread::Current();
+  size_t count = soft_reference_queue_.PreCleanReferences(self, collector);
+  count += weak_reference_queue_.PreCleanReferences(self, collector);
+  count += finalizer_reference_queue_.PreCleanReferences(self, collector);
+  count += phantom_reference_queue_.PreCleanReferences(self, collector);
+  VLOG(gc) << "Pre-cleaned " << count << " references";
+}
+
 // Process reference class instances and schedule finalizations.
 void ReferenceProcessor::ProcessReferences(bool concurrent,
                                            TimingLogger* timings,
@@ -164,9 +191,12 @@ void ReferenceProcessor::ProcessReferences(bool concurrent,
       StopPreservingReferences(self);
     }
   }
-  // Clear all remaining soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  // Clear all remaining soft and weak references with white referents. Clearing doesn't mark
+  // anything so it is split between the heap thread pool workers. Enqueuing the finalizer
+  // references does mark and stays on the GC-running thread.
+  const size_t thread_count = GetThreadCount(concurrent);
+  soft_reference_queue_.ClearWhiteReferencesParallel(&cleared_references_, collector, thread_count);
+  weak_reference_queue_.ClearWhiteReferencesParallel(&cleared_references_, collector, thread_count);
   {
     TimingLogger::ScopedTiming t2(concurrent ? "EnqueueFinalizerReferences" :
         "(Paused)EnqueueFinalizerReferences", timings);
@@ -174,17 +204,20 @@ void ReferenceProcessor::ProcessReferences(bool concurrent,
       StartPreservingReferences(self);
     }
     // Preserve all white objects with finalize methods and schedule them for finalization.
-    finalizer_reference_queue_.EnqueueFinalizerReferences(&cleared_references_, collector);
+    size_t enqueued_finalizers =
+        finalizer_reference_queue_.EnqueueFinalizerReferences(&cleared_references_, collector);
+    pending_finalizer_count_.FetchAndAddRelaxed(enqueued_finalizers);
     collector->ProcessMarkStack();
     if (concurrent) {
       StopPreservingReferences(self);
     }
   }
   // Clear all finalizer referent reachable soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  soft_reference_queue_.ClearWhiteReferencesParallel(&cleared_references_, collector, thread_count);
+  weak_reference_queue_.ClearWhiteReferencesParallel(&cleared_references_, collector, thread_count);
   // Clear all phantom references with white referents.
-  phantom_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  phantom_reference_queue_.ClearWhiteReferencesParallel(
+      &cleared_references_, collector, thread_count);
   // At this point all reference queues other than the cleared references should be empty.
   DCHECK(soft_reference_queue_.IsEmpty());
   DCHECK(weak_reference_queue_.IsEmpty());
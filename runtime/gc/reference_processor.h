@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_GC_REFERENCE_PROCESSOR_H_
 #define ART_RUNTIME_GC_REFERENCE_PROCESSOR_H_
 
+#include "base/atomic.h"
 #include "base/mutex.h"
 #include "globals.h"
 #include "jni.h"
@@ -53,6 +54,14 @@ class ReferenceProcessor {
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(Locks::heap_bitmap_lock_)
       REQUIRES(!Locks::reference_processor_lock_);
+  // Remove the references whose referents are already marked from the pending queues. Called
+  // concurrently with the mutators, before ProcessReferences, to shrink the work left for it.
+  void PreCleanReferences(TimingLogger* timings, gc::collector::GarbageCollector* collector)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!Locks::reference_queue_soft_references_lock_,
+               !Locks::reference_queue_weak_references_lock_,
+               !Locks::reference_queue_finalizer_references_lock_,
+               !Locks::reference_queue_phantom_references_lock_);
   // The slow path bool is contained in the reference class object, can only be set once
   // Only allow setting this with mutators suspended so that we can avoid using a lock in the
   // GetReferent fast path as an optimization.
@@ -76,6 +85,12 @@ class ReferenceProcessor {
   void ClearReferent(ObjPtr<mirror::Reference> ref)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::reference_processor_lock_);
+  // Returns the number of finalizer references enqueued since the last call, and resets it.
+  // The runtime does not see the finalizers complete, so this is an upper bound of the objects
+  // waiting for finalization that have been handed to the Java side since then.
+  size_t TakePendingFinalizerCount() {
+    return pending_finalizer_count_.ExchangeRelaxed(0u);
+  }
 
  private:
   bool SlowPathEnabled() REQUIRES_SHARED(Locks::mutator_lock_);
@@ -87,6 +102,8 @@ class ReferenceProcessor {
   // referents.
   void StartPreservingReferences(Thread* self) REQUIRES(!Locks::reference_processor_lock_);
   void StopPreservingReferences(Thread* self) REQUIRES(!Locks::reference_processor_lock_);
+  // Number of threads, the GC-running thread included, used to clear white references.
+  static size_t GetThreadCount(bool concurrent);
   // Wait until reference processing is done.
   void WaitUntilDoneProcessingReferences(Thread* self)
       REQUIRES_SHARED(Locks::mutator_lock_)
@@ -106,6 +123,8 @@ class ReferenceProcessor {
   ReferenceQueue finalizer_reference_queue_;
   ReferenceQueue phantom_reference_queue_;
   ReferenceQueue cleared_references_;
+  // Number of finalizer references enqueued since the last TakePendingFinalizerCount().
+  Atomic<size_t> pending_finalizer_count_;
 
   DISALLOW_COPY_AND_ASSIGN(ReferenceProcessor);
 };
@@ -16,6 +16,8 @@
 
 #include "reference_queue.h"
 
+#include <vector>
+
 #include "accounting/card_table-inl.h"
 #include "collector/concurrent_copying.h"
 #include "heap.h"
@@ -23,6 +25,7 @@
 #include "mirror/object-inl.h"
 #include "mirror/reference-inl.h"
 #include "object_callbacks.h"
+#include "thread_pool.h"
 
 namespace art {
 namespace gc {
@@ -60,7 +63,7 @@ ObjPtr<mirror::Reference> ReferenceQueue::DequeuePendingReference() {
   ObjPtr<mirror::Reference> ref = list_->GetPendingNext<kWithoutReadBarrier>();
   DCHECK(ref != nullptr);
   // Note: the following code is thread-safe because it is only called from ProcessReferences which
-  // is single threaded.
+  // is single threaded, or from PreCleanReferences with lock_ held.
   if (list_ == ref) {
     list_ = nullptr;
   } else {
@@ -151,8 +154,132 @@ void ReferenceQueue::ClearWhiteReferences(ReferenceQueue* cleared_references,
   }
 }
 
-void ReferenceQueue::EnqueueFinalizerReferences(ReferenceQueue* cleared_references,
-                                                collector::GarbageCollector* collector) {
+// References below this count are cleared by the GC-running thread alone.
+static constexpr size_t kMinParallelClearReferences = 256;
+
+class ClearWhiteReferencesTask : public Task {
+ public:
+  ClearWhiteReferencesTask(collector::GarbageCollector* collector,
+                           mirror::Reference** begin,
+                           mirror::Reference** end)
+      : collector_(collector),
+        begin_(begin),
+        end_(end),
+        cleared_references_(Locks::reference_queue_cleared_references_lock_) {}
+
+  // Like the MarkSweep tasks, the workers rely on the GC-running thread holding the mutator lock
+  // (shared) while it waits for them. Each reference is owned by exactly one task, and the checks
+  // below don't mark anything, so the only shared state is the per-task cleared list.
+  void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    for (mirror::Reference** it = begin_; it != end_; ++it) {
+      ObjPtr<mirror::Reference> ref = *it;
+      mirror::HeapReference<mirror::Object>* referent_addr = ref->GetReferentReferenceAddr();
+      // do_atomic_update is false because this happens during the reference processing phase where
+      // Reference.clear() would block.
+      if (!collector_->IsNullOrMarkedHeapReference(referent_addr, /*do_atomic_update*/false)) {
+        // Referent is white, clear it. The parallel path is not used in transaction mode.
+        ref->ClearReferent<false>();
+        cleared_references_.EnqueueReference(ref);
+      }
+      cleared_references_.DisableReadBarrierForReference(ref);
+    }
+  }
+
+  ReferenceQueue* GetClearedReferences() {
+    return &cleared_references_;
+  }
+
+ private:
+  collector::GarbageCollector* const collector_;
+  mirror::Reference** const begin_;
+  mirror::Reference** const end_;
+  // Only accessed by the task, so its lock is never acquired.
+  ReferenceQueue cleared_references_;
+};
+
+void ReferenceQueue::ClearWhiteReferencesParallel(ReferenceQueue* cleared_references,
+                                                  collector::GarbageCollector* collector,
+                                                  size_t thread_count) {
+  ThreadPool* thread_pool = Runtime::Current()->GetHeap()->GetThreadPool();
+  if (thread_count <= 1 || thread_pool == nullptr || Runtime::Current()->IsActiveTransaction()) {
+    ClearWhiteReferences(cleared_references, collector);
+    return;
+  }
+  std::vector<mirror::Reference*> refs;
+  if (!IsEmpty()) {
+    ObjPtr<mirror::Reference> ref = list_;
+    do {
+      refs.push_back(ref.Ptr());
+      ref = ref->GetPendingNext<kWithoutReadBarrier>();
+    } while (ref != list_);
+  }
+  if (refs.size() < kMinParallelClearReferences) {
+    ClearWhiteReferences(cleared_references, collector);
+    return;
+  }
+  // Unlink everything up front, the workers only see their own slice of the array.
+  for (mirror::Reference* ref : refs) {
+    ref->SetPendingNext(nullptr);
+  }
+  list_ = nullptr;
+  thread_count = std::min(thread_count, thread_pool->GetThreadCount() + 1);
+  Thread* self = Thread::Current();
+  const size_t delta = RoundUp(refs.size(), thread_count) / thread_count;
+  std::vector<std::unique_ptr<ClearWhiteReferencesTask>> tasks;
+  for (size_t begin = 0; begin < refs.size(); begin += delta) {
+    const size_t end = std::min(begin + delta, refs.size());
+    tasks.emplace_back(new ClearWhiteReferencesTask(collector, &refs[begin], &refs[end]));
+    thread_pool->AddTask(self, tasks.back().get());
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+  thread_pool->StopWorkers(self);
+  for (const std::unique_ptr<ClearWhiteReferencesTask>& task : tasks) {
+    cleared_references->EnqueueQueue(task->GetClearedReferences());
+  }
+}
+
+size_t ReferenceQueue::PreCleanReferences(Thread* self, collector::GarbageCollector* collector) {
+  MutexLock mu(self, *lock_);
+  size_t count = 0;
+  ReferenceQueue retained(lock_);
+  while (!IsEmpty()) {
+    ObjPtr<mirror::Reference> ref = DequeuePendingReference();
+    mirror::HeapReference<mirror::Object>* referent_addr = ref->GetReferentReferenceAddr();
+    // do_atomic_update needs to be true because this happens outside of the reference processing
+    // phase and a mutator may concurrently call Reference.clear().
+    if (collector->IsNullOrMarkedHeapReference(referent_addr, /*do_atomic_update*/true)) {
+      // The referent is alive for this GC, the reference is done with.
+      DisableReadBarrierForReference(ref);
+      ++count;
+    } else {
+      retained.EnqueueReference(ref);
+    }
+  }
+  EnqueueQueue(&retained);
+  return count;
+}
+
+void ReferenceQueue::EnqueueQueue(ReferenceQueue* other) {
+  if (other->IsEmpty()) {
+    return;
+  }
+  if (IsEmpty()) {
+    list_ = other->list_;
+  } else {
+    // Join the two cycles: this one's tail now points to the other's head and vice versa.
+    ObjPtr<mirror::Reference> head = list_->GetPendingNext<kWithoutReadBarrier>();
+    ObjPtr<mirror::Reference> other_head = other->list_->GetPendingNext<kWithoutReadBarrier>();
+    list_->SetPendingNext(other_head);
+    other->list_->SetPendingNext(head);
+  }
+  other->Clear();
+}
+
+size_t ReferenceQueue::EnqueueFinalizerReferences(ReferenceQueue* cleared_references,
+                                                  collector::GarbageCollector* collector) {
+  size_t enqueued = 0;
   while (!IsEmpty()) {
     ObjPtr<mirror::FinalizerReference> ref = DequeuePendingReference()->AsFinalizerReference();
     mirror::HeapReference<mirror::Object>* referent_addr = ref->GetReferentReferenceAddr();
@@ -169,11 +296,13 @@ void ReferenceQueue::EnqueueFinalizerReferences(ReferenceQueue* cleared_referenc
         ref->ClearReferent<false>();
       }
       cleared_references->EnqueueReference(ref);
+      ++enqueued;
     }
     // Delay disabling the read barrier until here so that the ClearReferent call above in
     // transaction mode will trigger the read barrier.
     DisableReadBarrierForReference(ref->AsReference());
   }
+  return enqueued;
 }
 
 void ReferenceQueue::ForwardSoftReferences(MarkObjectVisitor* visitor) {
@@ -75,8 +75,8 @@ class ReferenceQueue {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Enqueues finalizer references with white referents.  White referents are blackened, moved to
-  // the zombie field, and the referent field is cleared.
-  void EnqueueFinalizerReferences(ReferenceQueue* cleared_references,
+  // the zombie field, and the referent field is cleared. Returns the number of enqueued references.
+  size_t EnqueueFinalizerReferences(ReferenceQueue* cleared_references,
                                   collector::GarbageCollector* collector)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -92,6 +92,25 @@ class ReferenceQueue {
                             collector::GarbageCollector* collector)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Same as ClearWhiteReferences, but splits the list between `thread_count` tasks that run on the
+  // heap thread pool (the calling thread included). Falls back to the serial version if the list
+  // is too short to be worth splitting.
+  void ClearWhiteReferencesParallel(ReferenceQueue* cleared_references,
+                                    collector::GarbageCollector* collector,
+                                    size_t thread_count)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Unlink the references whose referents are null or already marked, since marking is monotonic
+  // these can never be cleared by this GC. Runs concurrently with the mutators and the other
+  // enqueuers before the reference processing phase to shorten it. Returns the number of
+  // references removed from the list.
+  size_t PreCleanReferences(Thread* self, collector::GarbageCollector* collector)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*lock_);
+
+  // Move all the references of `other` to this queue, leaving `other` empty.
+  // Not thread safe, used when the other enqueuers can't run.
+  void EnqueueQueue(ReferenceQueue* other) REQUIRES_SHARED(Locks::mutator_lock_);
+
   void Dump(std::ostream& os) const REQUIRES_SHARED(Locks::mutator_lock_);
   size_t GetLength() const REQUIRES_SHARED(Locks::mutator_lock_);
 
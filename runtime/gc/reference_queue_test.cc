@@ -61,6 +61,47 @@ TEST_F(ReferenceQueueTest, EnqueueDequeue) {
   ASSERT_EQ(refs, dequeued);
 }
 
+TEST_F(ReferenceQueueTest, EnqueueQueue) {
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  StackHandleScope<20> hs(self);
+  Mutex lock("Reference queue lock");
+  ReferenceQueue queue(&lock);
+  ReferenceQueue other(&lock);
+  auto ref_class = hs.NewHandle(
+      Runtime::Current()->GetClassLinker()->FindClass(self, "Ljava/lang/ref/WeakReference;",
+                                                      ScopedNullHandle<mirror::ClassLoader>()));
+  ASSERT_TRUE(ref_class != nullptr);
+  std::set<mirror::Reference*> refs;
+  for (size_t i = 0; i < 5; ++i) {
+    Handle<mirror::Reference> ref(hs.NewHandle(ref_class->AllocObject(self)->AsReference()));
+    ASSERT_TRUE(ref != nullptr);
+    refs.insert(ref.Get());
+    // Put two references in the first queue and three in the other.
+    if (i < 2) {
+      queue.EnqueueReference(ref.Get());
+    } else {
+      other.EnqueueReference(ref.Get());
+    }
+  }
+  // Moving an empty queue is a no-op.
+  ReferenceQueue empty(&lock);
+  queue.EnqueueQueue(&empty);
+  ASSERT_EQ(queue.GetLength(), 2U);
+  queue.EnqueueQueue(&other);
+  ASSERT_TRUE(other.IsEmpty());
+  ASSERT_EQ(queue.GetLength(), 5U);
+  // Moving into an empty queue takes over the list.
+  empty.EnqueueQueue(&queue);
+  ASSERT_TRUE(queue.IsEmpty());
+  ASSERT_EQ(empty.GetLength(), 5U);
+  std::set<mirror::Reference*> dequeued;
+  while (!empty.IsEmpty()) {
+    dequeued.insert(empty.DequeuePendingReference().Ptr());
+  }
+  ASSERT_EQ(refs, dequeued);
+}
+
 TEST_F(ReferenceQueueTest, Dump) {
   Thread* self = Thread::Current();
   ScopedObjectAccess soa(self);
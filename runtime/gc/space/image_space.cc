@@ -992,9 +992,13 @@ class ImageSpaceLoader {
         // Space is not yet added to the heap, don't do a read barrier.
         mirror::Object* ref = obj->GetFieldObject<mirror::Object, kVerifyNone, kWithoutReadBarrier>(
             offset);
-        // Use SetFieldObjectWithoutWriteBarrier to avoid card marking since we are writing to the
-        // image.
-        obj->SetFieldObjectWithoutWriteBarrier<false, true, kVerifyNone>(offset, ForwardObject(ref));
+        mirror::Object* new_ref = ForwardObject(ref);
+        // Only write changed references so that pages without any keep sharing the clean file
+        // mapping. Use SetFieldObjectWithoutWriteBarrier to avoid card marking since we are
+        // writing to the image.
+        if (ref != new_ref) {
+          obj->SetFieldObjectWithoutWriteBarrier<false, true, kVerifyNone>(offset, new_ref);
+        }
       }
     }
 
@@ -1023,9 +1027,12 @@ class ImageSpaceLoader {
                     ObjPtr<mirror::Reference> ref) const
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::heap_bitmap_lock_) {
       mirror::Object* obj = ref->GetReferent<kWithoutReadBarrier>();
-      ref->SetFieldObjectWithoutWriteBarrier<false, true, kVerifyNone>(
-          mirror::Reference::ReferentOffset(),
-          ForwardObject(obj));
+      mirror::Object* new_obj = ForwardObject(obj);
+      if (obj != new_obj) {
+        ref->SetFieldObjectWithoutWriteBarrier<false, true, kVerifyNone>(
+            mirror::Reference::ReferentOffset(),
+            new_obj);
+      }
     }
 
     void operator()(mirror::Object* obj) const
@@ -1498,8 +1505,11 @@ static bool CheckSpace(const std::string& cache_filename, std::string* error_msg
 std::unique_ptr<ImageSpace> ImageSpace::CreateBootImage(const char* image_location,
                                                         const InstructionSet image_isa,
                                                         bool secondary_image,
+                                                        bool* use_unrelocated,
                                                         std::string* error_msg) {
   ScopedTrace trace(__FUNCTION__);
+  DCHECK(use_unrelocated != nullptr);
+  DCHECK(secondary_image || !*use_unrelocated);
 
   // Step 0: Extra zygote work.
 
@@ -1569,6 +1579,21 @@ std::unique_ptr<ImageSpace> ImageSpace::CreateBootImage(const char* image_locati
   // Collect all the errors.
   std::vector<std::string> error_msgs;
 
+  // Step 0.c: The primary image could not be relocated and was used from /system as is. Load the
+  //           secondary images the same way so that they are contiguous with it.
+  if (*use_unrelocated) {
+    if (!found_image || !has_system) {
+      *error_msg = StringPrintf("No unrelocated image for %s in /system", image_location);
+      return nullptr;
+    }
+    return ImageSpaceLoader::Load(image_location,
+                                  system_filename,
+                                  is_zygote,
+                                  is_global_cache,
+                                  /* validate_oat_file */ false,
+                                  error_msg);
+  }
+
   // Step 1: Check if we have an existing and relocated image.
 
   // Step 1.a: Have files in system and cache. Then they need to match.
@@ -1656,6 +1681,26 @@ std::unique_ptr<ImageSpace> ImageSpace::CreateBootImage(const char* image_locati
                                       image_location,
                                       cache_filename.c_str(),
                                       local_error_msg.c_str()));
+
+    // Step 2.c: We could not relocate the primary image. Rather than running without a boot
+    //           image, use the one in /system at the address it was compiled for. A secondary
+    //           image must match the primary one, so it cannot fall back on its own.
+    if (!secondary_image) {
+      local_error_msg.clear();
+      std::unique_ptr<ImageSpace> system_space =
+          ImageSpaceLoader::Load(image_location,
+                                 system_filename,
+                                 is_zygote,
+                                 is_global_cache,
+                                 /* validate_oat_file */ false,
+                                 &local_error_msg);
+      if (system_space != nullptr) {
+        LOG(WARNING) << "Using unrelocated boot image " << system_filename;
+        *use_unrelocated = true;
+        return system_space;
+      }
+      error_msgs.push_back(local_error_msg);
+    }
   }
 
   // Step 3: We do not have an existing image in /system, so generate an image into the dalvik
@@ -1721,6 +1766,7 @@ bool ImageSpace::LoadBootImage(const std::string& image_file_name,
   image_file_names.push_back(image_file_name);
 
   bool error = false;
+  bool use_unrelocated = false;
   uint8_t* oat_file_end_tmp = *oat_file_end;
 
   for (size_t index = 0; index < image_file_names.size(); ++index) {
@@ -1730,6 +1776,7 @@ bool ImageSpace::LoadBootImage(const std::string& image_file_name,
         image_name.c_str(),
         image_instruction_set,
         index > 0,
+        &use_unrelocated,
         &error_msg);
     if (boot_image_space_uptr != nullptr) {
       space::ImageSpace* boot_image_space = boot_image_space_uptr.release();
@@ -209,9 +209,12 @@ class ImageSpace : public MemMapSpace {
   // creation of the alloc space. The ReleaseOatFile will later be
   // used to transfer ownership of the OatFile to the ClassLinker when
   // it is initialized.
+  // If the primary image cannot be relocated, the unrelocated one from /system is used
+  // instead and `*use_unrelocated` is set, so that the secondary images are loaded the same way.
   static std::unique_ptr<ImageSpace> CreateBootImage(const char* image,
                                      InstructionSet image_isa,
                                      bool secondary_image,
+                                     bool* use_unrelocated,
                                      std::string* error_msg)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -41,7 +41,10 @@ namespace space {
 
 class MemoryToolLargeObjectMapSpace FINAL : public LargeObjectMapSpace {
  public:
-  explicit MemoryToolLargeObjectMapSpace(const std::string& name) : LargeObjectMapSpace(name) {
+  // Cached mappings would hide use-after-free of large objects from the memory tool, so this
+  // space does not keep any.
+  explicit MemoryToolLargeObjectMapSpace(const std::string& name)
+      : LargeObjectMapSpace(name, 0U /* reuse_pool_capacity */) {
   }
 
   ~MemoryToolLargeObjectMapSpace() OVERRIDE {
@@ -122,27 +125,96 @@ void LargeObjectSpace::CopyLiveToMarked() {
   mark_bitmap_->CopyFrom(live_bitmap_.get());
 }
 
-LargeObjectMapSpace::LargeObjectMapSpace(const std::string& name)
+LargeObjectMapSpace::LargeObjectMapSpace(const std::string& name, size_t reuse_pool_capacity)
     : LargeObjectSpace(name, nullptr, nullptr),
-      lock_("large object map space lock", kAllocSpaceLock) {}
+      lock_("large object map space lock", kAllocSpaceLock),
+      reuse_pool_bytes_(0U),
+      reuse_pool_capacity_(reuse_pool_capacity) {}
+
+LargeObjectMapSpace::~LargeObjectMapSpace() {
+  Trim();
+}
 
 LargeObjectMapSpace* LargeObjectMapSpace::Create(const std::string& name) {
   if (Runtime::Current()->IsRunningOnMemoryTool()) {
     return new MemoryToolLargeObjectMapSpace(name);
   } else {
-    return new LargeObjectMapSpace(name);
+    return new LargeObjectMapSpace(name, kDefaultReusePoolCapacity);
+  }
+}
+
+MemMap* LargeObjectMapSpace::TakeReusableMap(size_t size) {
+  auto it = reuse_pool_.find(size);
+  if (it == reuse_pool_.end()) {
+    return nullptr;
   }
+  MemMap* mem_map = it->second;
+  DCHECK_EQ(mem_map->BaseSize(), size);
+  reuse_pool_bytes_ -= size;
+  reuse_pool_.erase(it);
+  return mem_map;
+}
+
+void LargeObjectMapSpace::AddReusableMap(MemMap* mem_map, std::vector<MemMap*>* unmap) {
+  const size_t size = mem_map->BaseSize();
+  if (size > kMaxReusableMapSize || size > reuse_pool_capacity_) {
+    unmap->push_back(mem_map);
+    return;
+  }
+  // Make room by evicting the largest cached mappings since they cost the most to keep resident.
+  while (reuse_pool_bytes_ + size > reuse_pool_capacity_) {
+    DCHECK(!reuse_pool_.empty());
+    auto it = std::prev(reuse_pool_.end());
+    reuse_pool_bytes_ -= it->first;
+    unmap->push_back(it->second);
+    reuse_pool_.erase(it);
+  }
+  reuse_pool_.emplace(size, mem_map);
+  reuse_pool_bytes_ += size;
+}
+
+size_t LargeObjectMapSpace::Trim() {
+  std::vector<MemMap*> unmap;
+  size_t reclaimed = 0U;
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    for (auto& pair : reuse_pool_) {
+      unmap.push_back(pair.second);
+    }
+    reclaimed = reuse_pool_bytes_;
+    reuse_pool_.clear();
+    reuse_pool_bytes_ = 0U;
+  }
+  STLDeleteElements(&unmap);
+  return reclaimed;
+}
+
+size_t LargeObjectMapSpace::GetReusePoolBytes() {
+  MutexLock mu(Thread::Current(), lock_);
+  return reuse_pool_bytes_;
 }
 
 mirror::Object* LargeObjectMapSpace::Alloc(Thread* self, size_t num_bytes,
                                            size_t* bytes_allocated, size_t* usable_size,
                                            size_t* bytes_tl_bulk_allocated) {
-  std::string error_msg;
-  MemMap* mem_map = MemMap::MapAnonymous("large object space allocation", nullptr, num_bytes,
-                                         PROT_READ | PROT_WRITE, true, false, &error_msg);
-  if (UNLIKELY(mem_map == nullptr)) {
-    LOG(WARNING) << "Large object allocation failed: " << error_msg;
-    return nullptr;
+  MemMap* mem_map = nullptr;
+  const size_t page_aligned_size = RoundUp(num_bytes, kPageSize);
+  if (page_aligned_size <= kMaxReusableMapSize) {
+    MutexLock mu(self, lock_);
+    mem_map = TakeReusableMap(page_aligned_size);
+  }
+  if (mem_map != nullptr) {
+    // The pages still hold the dead object which used them. Clearing the resident pages is
+    // cheaper than faulting in the zero pages of a fresh mapping.
+    memset(mem_map->BaseBegin(), 0, page_aligned_size);
+  } else {
+    std::string error_msg;
+    mem_map = MemMap::MapAnonymous("large object space allocation", nullptr, num_bytes,
+                                   PROT_READ | PROT_WRITE, true, false, &error_msg);
+    if (UNLIKELY(mem_map == nullptr)) {
+      LOG(WARNING) << "Large object allocation failed: " << error_msg;
+      return nullptr;
+    }
   }
   mirror::Object* const obj = reinterpret_cast<mirror::Object*>(mem_map->Begin());
   MutexLock mu(self, lock_);
@@ -183,21 +255,27 @@ void LargeObjectMapSpace::SetAllLargeObjectsAsZygoteObjects(Thread* self) {
 }
 
 size_t LargeObjectMapSpace::Free(Thread* self, mirror::Object* ptr) {
-  MutexLock mu(self, lock_);
-  auto it = large_objects_.find(ptr);
-  if (UNLIKELY(it == large_objects_.end())) {
-    ScopedObjectAccess soa(self);
-    Runtime::Current()->GetHeap()->DumpSpaces(LOG_STREAM(FATAL_WITHOUT_ABORT));
-    LOG(FATAL) << "Attempted to free large object " << ptr << " which was not live";
-  }
-  MemMap* mem_map = it->second.mem_map;
-  const size_t map_size = mem_map->BaseSize();
-  DCHECK_GE(num_bytes_allocated_, map_size);
-  size_t allocation_size = map_size;
-  num_bytes_allocated_ -= allocation_size;
-  --num_objects_allocated_;
-  delete mem_map;
-  large_objects_.erase(it);
+  std::vector<MemMap*> unmap;
+  size_t allocation_size;
+  {
+    MutexLock mu(self, lock_);
+    auto it = large_objects_.find(ptr);
+    if (UNLIKELY(it == large_objects_.end())) {
+      ScopedObjectAccess soa(self);
+      Runtime::Current()->GetHeap()->DumpSpaces(LOG_STREAM(FATAL_WITHOUT_ABORT));
+      LOG(FATAL) << "Attempted to free large object " << ptr << " which was not live";
+    }
+    MemMap* mem_map = it->second.mem_map;
+    const size_t map_size = mem_map->BaseSize();
+    DCHECK_GE(num_bytes_allocated_, map_size);
+    allocation_size = map_size;
+    num_bytes_allocated_ -= allocation_size;
+    --num_objects_allocated_;
+    large_objects_.erase(it);
+    AddReusableMap(mem_map, &unmap);
+  }
+  // Unmap outside of lock_ so that concurrent large object allocations do not wait for munmap.
+  STLDeleteElements(&unmap);
   return allocation_size;
 }
 
@@ -23,6 +23,7 @@
 #include "dlmalloc_space.h"
 #include "space.h"
 
+#include <map>
 #include <set>
 #include <vector>
 
@@ -109,6 +110,12 @@ class LargeObjectSpace : public DiscontinuousSpace, public AllocSpace {
   // End() from different allocations.
   virtual std::pair<uint8_t*, uint8_t*> GetBeginEndAtomic() const = 0;
 
+  // Releases memory that the space keeps around for reuse by later allocations. Returns the number
+  // of bytes released.
+  virtual size_t Trim() {
+    return 0U;
+  }
+
  protected:
   explicit LargeObjectSpace(const std::string& name, uint8_t* begin, uint8_t* end);
   static void SweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg);
@@ -146,21 +153,47 @@ class LargeObjectMapSpace : public LargeObjectSpace {
 
   std::pair<uint8_t*, uint8_t*> GetBeginEndAtomic() const OVERRIDE REQUIRES(!lock_);
 
+  // Unmaps the mappings cached in the reuse pool.
+  size_t Trim() OVERRIDE REQUIRES(!lock_);
+
+  // Freed mappings of at most this many bytes may be cached for reuse.
+  static constexpr size_t kMaxReusableMapSize = 4 * MB;
+  // The default limit on the total size of the cached mappings.
+  static constexpr size_t kDefaultReusePoolCapacity = 8 * MB;
+
+  size_t GetReusePoolBytes() REQUIRES(!lock_);
+
  protected:
   struct LargeObject {
     MemMap* mem_map;
     bool is_zygote;
   };
-  explicit LargeObjectMapSpace(const std::string& name);
-  virtual ~LargeObjectMapSpace() {}
+  LargeObjectMapSpace(const std::string& name, size_t reuse_pool_capacity);
+  virtual ~LargeObjectMapSpace();
 
   bool IsZygoteLargeObject(Thread* self, mirror::Object* obj) const OVERRIDE REQUIRES(!lock_);
   void SetAllLargeObjectsAsZygoteObjects(Thread* self) OVERRIDE REQUIRES(!lock_);
 
+  // Returns a cached mapping of exactly `size` bytes, or null if there is none.
+  MemMap* TakeReusableMap(size_t size) REQUIRES(lock_);
+  // Caches the mapping of a freed large object. Mappings that do not fit in the pool, as well as
+  // any cached mappings evicted to make room, are added to `unmap` for the caller to delete once
+  // lock_ is released.
+  void AddReusableMap(MemMap* mem_map, std::vector<MemMap*>* unmap) REQUIRES(lock_);
+
   // Used to ensure mutual exclusion when the allocation spaces data structures are being modified.
   mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   AllocationTrackingSafeMap<mirror::Object*, LargeObject, kAllocatorTagLOSMaps> large_objects_
       GUARDED_BY(lock_);
+  // Recently freed mappings keyed by size. Reusing them saves the mmap/munmap pair and the page
+  // faults on the fresh mapping when an app repeatedly allocates large buffers of the same size.
+  std::multimap<size_t,
+                MemMap*,
+                std::less<size_t>,
+                TrackingAllocator<std::pair<const size_t, MemMap*>, kAllocatorTagLOSMaps>>
+      reuse_pool_ GUARDED_BY(lock_);
+  size_t reuse_pool_bytes_ GUARDED_BY(lock_);
+  const size_t reuse_pool_capacity_;
 };
 
 // A continuous large object space with a free-list to handle holes.
@@ -182,6 +182,43 @@ TEST_F(LargeObjectSpaceTest, RaceTest) {
   RaceTest();
 }
 
+TEST_F(LargeObjectSpaceTest, MapSpaceReusesFreedMappings) {
+  TEST_DISABLED_FOR_MEMORY_TOOL();
+  Thread* const self = Thread::Current();
+  LargeObjectMapSpace* const los = space::LargeObjectMapSpace::Create("large object space");
+  std::unique_ptr<LargeObjectSpace> los_holder(los);
+  const size_t request_size = 64 * KB + 1;
+  size_t allocation_size = 0;
+  size_t bytes_tl_bulk_allocated;
+  mirror::Object* obj = los->Alloc(self, request_size, &allocation_size, nullptr,
+                                   &bytes_tl_bulk_allocated);
+  ASSERT_TRUE(obj != nullptr);
+  memset(obj, 0xAB, request_size);
+  EXPECT_EQ(allocation_size, los->Free(self, obj));
+  EXPECT_EQ(allocation_size, los->GetReusePoolBytes());
+
+  // An allocation of the same page-aligned size gets the cached mapping back, cleared.
+  mirror::Object* reused = los->Alloc(self, request_size - 1, &allocation_size, nullptr,
+                                      &bytes_tl_bulk_allocated);
+  ASSERT_EQ(obj, reused);
+  EXPECT_EQ(0U, los->GetReusePoolBytes());
+  for (size_t k = 0; k < allocation_size; ++k) {
+    ASSERT_EQ(reinterpret_cast<const uint8_t*>(reused)[k], 0U);
+  }
+  los->Free(self, reused);
+  EXPECT_EQ(RoundUp(request_size, kPageSize), los->GetReusePoolBytes());
+  EXPECT_EQ(RoundUp(request_size, kPageSize), los->Trim());
+  EXPECT_EQ(0U, los->GetReusePoolBytes());
+
+  // Mappings larger than the reuse limit are unmapped right away.
+  obj = los->Alloc(self, LargeObjectMapSpace::kMaxReusableMapSize + kPageSize, &allocation_size,
+                   nullptr, &bytes_tl_bulk_allocated);
+  ASSERT_TRUE(obj != nullptr);
+  los->Free(self, obj);
+  EXPECT_EQ(0U, los->GetReusePoolBytes());
+  EXPECT_EQ(0U, los->GetBytesAllocated());
+}
+
 }  // namespace space
 }  // namespace gc
 }  // namespace art
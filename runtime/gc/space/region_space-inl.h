@@ -18,6 +18,8 @@
 #define ART_RUNTIME_GC_SPACE_REGION_SPACE_INL_H_
 
 #include "region_space.h"
+
+#include "gc/accounting/card_table-inl.h"
 #include "thread-current-inl.h"
 
 namespace art {
@@ -47,38 +49,31 @@ template<bool kForEvac>
 inline mirror::Object* RegionSpace::AllocNonvirtual(size_t num_bytes,
                                                     /* out */ size_t* bytes_allocated,
                                                     /* out */ size_t* usable_size,
-                                                    /* out */ size_t* bytes_tl_bulk_allocated) {
+                                                    /* out */ size_t* bytes_tl_bulk_allocated,
+                                                    size_t evac_numa_node) {
   DCHECK_ALIGNED(num_bytes, kAlignment);
+  DCHECK_LT(evac_numa_node, num_numa_nodes_);
   mirror::Object* obj;
   if (LIKELY(num_bytes <= kRegionSize)) {
     // Non-large object.
-    obj = (kForEvac ? evac_region_ : current_region_)->Alloc(num_bytes,
-                                                             bytes_allocated,
-                                                             usable_size,
-                                                             bytes_tl_bulk_allocated);
+    Region** const region = kForEvac ? &evac_regions_[evac_numa_node] : &current_region_;
+    obj = (*region)->Alloc(num_bytes, bytes_allocated, usable_size, bytes_tl_bulk_allocated);
     if (LIKELY(obj != nullptr)) {
       return obj;
     }
     MutexLock mu(Thread::Current(), region_lock_);
     // Retry with current region since another thread may have updated it.
-    obj = (kForEvac ? evac_region_ : current_region_)->Alloc(num_bytes,
-                                                             bytes_allocated,
-                                                             usable_size,
-                                                             bytes_tl_bulk_allocated);
+    obj = (*region)->Alloc(num_bytes, bytes_allocated, usable_size, bytes_tl_bulk_allocated);
     if (LIKELY(obj != nullptr)) {
       return obj;
     }
-    Region* r = AllocateRegion(kForEvac);
+    Region* r = AllocateRegion(kForEvac, kForEvac ? evac_numa_node : GetCurrentNumaNode());
     if (LIKELY(r != nullptr)) {
       obj = r->Alloc(num_bytes, bytes_allocated, usable_size, bytes_tl_bulk_allocated);
       CHECK(obj != nullptr);
       // Do our allocation before setting the region, this makes sure no threads race ahead
       // and fill in the region before we allocate the object. b/63153464
-      if (kForEvac) {
-        evac_region_ = r;
-      } else {
-        current_region_ = r;
-      }
+      *region = r;
       return obj;
     }
   } else {
@@ -235,6 +230,71 @@ inline void RegionSpace::WalkInternal(Visitor&& visitor) {
   }
 }
 
+template <typename Visitor>
+inline void RegionSpace::VisitOldObjectsOnCards(accounting::CardTable* card_table,
+                                                uint8_t minimum_age,
+                                                Visitor&& visitor) {
+  // Collect the old regions under the region lock. Their extent does not change for the rest of
+  // the collection: mutators and the GC only allocate into newly allocated or evacuation regions,
+  // and old regions are only reclaimed by a later full collection.
+  std::vector<Region*> old_regions;
+  {
+    MutexLock mu(Thread::Current(), region_lock_);
+    for (size_t i = 0; i < std::min(num_regions_, non_free_region_index_limit_); ++i) {
+      Region* r = &regions_[i];
+      if (r->IsInToSpace() &&
+          !r->IsLargeTail() &&
+          !r->IsNewlyAllocated() &&
+          r->AllocTime() < time_) {
+        old_regions.push_back(r);
+      }
+    }
+  }
+  for (Region* r : old_regions) {
+    uint8_t* pos = r->Begin();
+    uint8_t* top = r->Top();
+    if (r->IsLarge()) {
+      // The write barrier always marks the card of the holder object's start.
+      if (card_table->GetCard(reinterpret_cast<mirror::Object*>(pos)) >= minimum_age) {
+        visitor(reinterpret_cast<mirror::Object*>(pos));
+      }
+      continue;
+    }
+    // For regions evacuated into during a previous collection, live bytes will be -1.
+    const bool need_bitmap =
+        r->LiveBytes() != static_cast<size_t>(-1) &&
+        r->LiveBytes() != static_cast<size_t>(top - pos);
+    if (need_bitmap) {
+      card_table->Scan</* kClearCard */ false>(GetLiveBitmap(), pos, top, visitor, minimum_age);
+    } else if (pos < top) {
+      // Find the last card of the region with a sufficient age, to avoid walking the objects of
+      // regions (or region tails) without any.
+      uint8_t* const first_card = card_table->CardFromAddr(pos);
+      uint8_t* last_card = card_table->CardFromAddr(top - 1);
+      while (last_card >= first_card && *last_card < minimum_age) {
+        --last_card;
+      }
+      if (last_card < first_card) {
+        continue;
+      }
+      uint8_t* const limit = std::min(
+          top,
+          reinterpret_cast<uint8_t*>(card_table->AddrFromCard(last_card)) +
+              accounting::CardTable::kCardSize);
+      while (pos < limit) {
+        mirror::Object* obj = reinterpret_cast<mirror::Object*>(pos);
+        if (obj->GetClass<kDefaultVerifyFlags, kWithoutReadBarrier>() == nullptr) {
+          break;
+        }
+        if (card_table->GetCard(obj) >= minimum_age) {
+          visitor(obj);
+        }
+        pos = reinterpret_cast<uint8_t*>(GetNextObject(obj));
+      }
+    }
+  }
+}
+
 inline mirror::Object* RegionSpace::GetNextObject(mirror::Object* obj) {
   const uintptr_t position = reinterpret_cast<uintptr_t>(obj) + obj->SizeOf();
   return reinterpret_cast<mirror::Object*>(RoundUp(position, kAlignment));
@@ -282,6 +342,8 @@ inline mirror::Object* RegionSpace::AllocLarge(size_t num_bytes,
       if (kForEvac) {
         ++num_evac_regions_;
       } else {
+        // Tag the large object as part of the young generation.
+        first_reg->SetNewlyAllocated();
         ++num_non_free_regions_;
       }
       size_t allocated = num_regs * kRegionSize;
@@ -327,13 +389,16 @@ inline void RegionSpace::FreeLarge(mirror::Object* large_obj, size_t bytes_alloc
     } else {
       DCHECK(reg->IsLargeTail());
     }
-    reg->Clear(/*zero_and_release_pages*/true);
+    reg->Clear(/*zero_and_release_pages*/!use_huge_pages_);
     if (kForEvac) {
       --num_evac_regions_;
     } else {
       --num_non_free_regions_;
     }
   }
+  if (use_huge_pages_) {
+    ZeroAndReleaseRegionPages(begin_addr, end_addr, /* protect */ true);
+  }
   if (end_addr < Limit()) {
     // If we aren't at the end of the space, check that the next region is not a large tail.
     Region* following_reg = RefToRegionLocked(reinterpret_cast<mirror::Object*>(end_addr));
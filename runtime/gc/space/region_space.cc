@@ -14,6 +14,11 @@
  * limitations under the License.
  */
 
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "android-base/file.h"
+
 #include "bump_pointer_space-inl.h"
 #include "bump_pointer_space.h"
 #include "gc/accounting/read_barrier_table.h"
@@ -33,21 +38,78 @@ static constexpr uint kEvacuateLivePercentThreshold = 75U;
 // Only protect for target builds to prevent flaky test failures (b/63131961).
 static constexpr bool kProtectClearedRegions = kIsTargetBuild;
 
-MemMap* RegionSpace::CreateMemMap(const std::string& name, size_t capacity,
-                                  uint8_t* requested_begin) {
+// Memory policy of mbind(2), from <linux/mempolicy.h>.
+static constexpr int kMpolPreferred = 1;
+
+// Returns the number of NUMA nodes of the machine, 1 if it cannot tell or is not NUMA.
+static size_t GetNumNumaNodesOfMachine() {
+  std::string online;
+  if (!android::base::ReadFileToString("/sys/devices/system/node/online", &online)) {
+    return 1U;
+  }
+  // The file lists the online nodes in ascending order, e.g. "0" or "0-1" or "0,2-3". The last
+  // number is the highest node.
+  size_t last_start = online.find_last_of(",-");
+  last_start = (last_start == std::string::npos) ? 0U : last_start + 1;
+  char* end;
+  unsigned long max_node = strtoul(online.c_str() + last_start, &end, 10);  // NOLINT
+  if (end == online.c_str() + last_start) {
+    return 1U;
+  }
+  return static_cast<size_t>(max_node) + 1U;
+}
+
+MemMap* RegionSpace::CreateMemMap(const std::string& name,
+                                  size_t capacity,
+                                  uint8_t* requested_begin,
+                                  HugePageType huge_page_type) {
   CHECK_ALIGNED(capacity, kRegionSize);
   std::string error_msg;
-  // Ask for the capacity of an additional kRegionSize so that we can align the map by kRegionSize
-  // even if we get unaligned base address. This is necessary for the ReadBarrierTable to work.
+  if (huge_page_type != HugePageType::kDisabled) {
+    // Regions are carved out of whole huge pages.
+    capacity = RoundUp(capacity, MemMap::kHugePageSize);
+  }
+  if (huge_page_type == HugePageType::kExplicit) {
+    MemMap* mem_map = MemMap::MapAnonymousHugePages(name.c_str(),
+                                                    requested_begin,
+                                                    capacity,
+                                                    PROT_READ | PROT_WRITE,
+                                                    true,
+                                                    &error_msg);
+    if (mem_map == nullptr && requested_begin != nullptr) {
+      mem_map = MemMap::MapAnonymousHugePages(name.c_str(),
+                                              nullptr,
+                                              capacity,
+                                              PROT_READ | PROT_WRITE,
+                                              true,
+                                              &error_msg);
+    }
+    if (mem_map != nullptr) {
+      CHECK_ALIGNED(mem_map->Begin(), MemMap::kHugePageSize);
+      CHECK_EQ(mem_map->Size(), capacity);
+      return mem_map;
+    }
+    LOG(WARNING) << "Failed to allocate explicit huge pages for " << name << " of size "
+                 << PrettySize(capacity) << ", falling back to transparent huge pages: "
+                 << error_msg;
+    huge_page_type = HugePageType::kTransparent;
+  }
+  // Align by a huge page for transparent huge pages so that no huge page straddles the space
+  // boundaries.
+  const size_t alignment =
+      (huge_page_type == HugePageType::kDisabled) ? kRegionSize : MemMap::kHugePageSize;
+  // Ask for the capacity of an additional `alignment` so that we can align the map by it even if
+  // we get unaligned base address. This is necessary for the ReadBarrierTable to work.
   std::unique_ptr<MemMap> mem_map;
   while (true) {
     mem_map.reset(MemMap::MapAnonymous(name.c_str(),
                                        requested_begin,
-                                       capacity + kRegionSize,
+                                       capacity + alignment,
                                        PROT_READ | PROT_WRITE,
                                        true,
                                        false,
-                                       &error_msg));
+                                       &error_msg,
+                                       /* use_ashmem */ huge_page_type == HugePageType::kDisabled));
     if (mem_map.get() != nullptr || requested_begin == nullptr) {
       break;
     }
@@ -60,28 +122,37 @@ MemMap* RegionSpace::CreateMemMap(const std::string& name, size_t capacity,
     MemMap::DumpMaps(LOG_STREAM(ERROR));
     return nullptr;
   }
-  CHECK_EQ(mem_map->Size(), capacity + kRegionSize);
+  CHECK_EQ(mem_map->Size(), capacity + alignment);
   CHECK_EQ(mem_map->Begin(), mem_map->BaseBegin());
   CHECK_EQ(mem_map->Size(), mem_map->BaseSize());
-  if (IsAlignedParam(mem_map->Begin(), kRegionSize)) {
-    // Got an aligned map. Since we requested a map that's kRegionSize larger. Shrink by
-    // kRegionSize at the end.
+  if (IsAlignedParam(mem_map->Begin(), alignment)) {
+    // Got an aligned map. Since we requested a map that's `alignment` larger. Shrink by
+    // `alignment` at the end.
     mem_map->SetSize(capacity);
   } else {
     // Got an unaligned map. Align the both ends.
-    mem_map->AlignBy(kRegionSize);
+    mem_map->AlignBy(alignment);
   }
-  CHECK_ALIGNED(mem_map->Begin(), kRegionSize);
-  CHECK_ALIGNED(mem_map->End(), kRegionSize);
+  CHECK_ALIGNED_PARAM(mem_map->Begin(), alignment);
+  CHECK_ALIGNED_PARAM(mem_map->End(), alignment);
   CHECK_EQ(mem_map->Size(), capacity);
+  if (huge_page_type == HugePageType::kTransparent) {
+    mem_map->MadviseHugePages();
+  }
   return mem_map.release();
 }
 
-RegionSpace* RegionSpace::Create(const std::string& name, MemMap* mem_map) {
-  return new RegionSpace(name, mem_map);
+RegionSpace* RegionSpace::Create(const std::string& name,
+                                 MemMap* mem_map,
+                                 HugePageType huge_page_type,
+                                 bool numa_aware) {
+  return new RegionSpace(name, mem_map, huge_page_type, numa_aware);
 }
 
-RegionSpace::RegionSpace(const std::string& name, MemMap* mem_map)
+RegionSpace::RegionSpace(const std::string& name,
+                         MemMap* mem_map,
+                         HugePageType huge_page_type,
+                         bool numa_aware)
     : ContinuousMemMapAllocSpace(name, mem_map, mem_map->Begin(), mem_map->End(), mem_map->End(),
                                  kGcRetentionPolicyAlwaysCollect),
       region_lock_("Region lock", kRegionSpaceRegionLock),
@@ -92,10 +163,30 @@ RegionSpace::RegionSpace(const std::string& name, MemMap* mem_map)
       max_peak_num_non_free_regions_(0U),
       non_free_region_index_limit_(0U),
       current_region_(&full_region_),
-      evac_region_(nullptr) {
+      use_huge_pages_(huge_page_type != HugePageType::kDisabled),
+      max_evacuated_live_percent_(kDefaultMaxEvacuatedLivePercent),
+      num_numa_nodes_(1U),
+      num_regions_per_numa_node_(num_regions_) {
   CHECK_ALIGNED(mem_map->Size(), kRegionSize);
   CHECK_ALIGNED(mem_map->Begin(), kRegionSize);
+  if (use_huge_pages_) {
+    CHECK_ALIGNED(mem_map->Size(), MemMap::kHugePageSize);
+    CHECK_ALIGNED(mem_map->Begin(), MemMap::kHugePageSize);
+  }
   DCHECK_GT(num_regions_, 0U);
+  std::fill_n(evac_regions_, kMaxNumaNodes, nullptr);
+  if (numa_aware) {
+    // Keep whole huge pages on one node.
+    const size_t granularity = use_huge_pages_ ? MemMap::kHugePageSize / kRegionSize : 1U;
+    const size_t num_nodes = std::min(GetNumNumaNodesOfMachine(), kMaxNumaNodes);
+    if (num_nodes > 1U) {
+      const size_t per_node = RoundUp(num_regions_ / num_nodes, granularity);
+      if (per_node > 0U && per_node < num_regions_) {
+        num_numa_nodes_ = std::min(num_nodes, RoundUp(num_regions_, per_node) / per_node);
+        num_regions_per_numa_node_ = per_node;
+      }
+    }
+  }
   regions_.reset(new Region[num_regions_]);
   uint8_t* region_addr = mem_map->Begin();
   for (size_t i = 0; i < num_regions_; ++i, region_addr += kRegionSize) {
@@ -118,6 +209,48 @@ RegionSpace::RegionSpace(const std::string& name, MemMap* mem_map)
   DCHECK(full_region_.IsAllocated());
   size_t ignored;
   DCHECK(full_region_.Alloc(kAlignment, &ignored, nullptr, &ignored) == nullptr);
+  if (num_numa_nodes_ > 1U) {
+    BindRegionsToNumaNodes();
+  }
+}
+
+void RegionSpace::BindRegionsToNumaNodes() {
+#if defined(__linux__) && defined(__NR_mbind)
+  for (size_t node = 0; node < num_numa_nodes_; ++node) {
+    uint8_t* begin = Begin() + node * num_regions_per_numa_node_ * kRegionSize;
+    uint8_t* end = (node + 1 == num_numa_nodes_)
+        ? Limit()
+        : begin + num_regions_per_numa_node_ * kRegionSize;
+    unsigned long node_mask = 1UL << node;  // NOLINT
+    // Prefer rather than bind, so that the kernel can still hand out remote memory instead of
+    // failing when a node runs out.
+    if (syscall(__NR_mbind,
+                begin,
+                end - begin,
+                kMpolPreferred,
+                &node_mask,
+                sizeof(node_mask) * kBitsPerByte,
+                0U) != 0) {
+      PLOG(WARNING) << "Failed to bind the regions of " << GetName() << " to NUMA node " << node;
+    }
+  }
+#endif
+  VLOG(heap) << GetName() << " spreads " << num_regions_ << " regions over " << num_numa_nodes_
+             << " NUMA nodes";
+}
+
+size_t RegionSpace::GetCurrentNumaNode() const {
+  if (num_numa_nodes_ == 1U) {
+    return 0U;
+  }
+#if defined(__linux__) && defined(__NR_getcpu)
+  unsigned cpu;
+  unsigned node;
+  if (syscall(__NR_getcpu, &cpu, &node, nullptr) == 0 && node < num_numa_nodes_) {
+    return node;
+  }
+#endif
+  return 0U;
 }
 
 size_t RegionSpace::FromSpaceSize() {
@@ -161,8 +294,10 @@ inline bool RegionSpace::Region::ShouldBeEvacuated() {
   // The region should be evacuated if:
   // - the region was allocated after the start of the previous GC (newly allocated region); or
   // - the live ratio is below threshold (`kEvacuateLivePercentThreshold`).
+  // Newly allocated large regions are not copied; they are kept as unevacuated from-space and
+  // reclaimed in place if they turn out to be dead.
   bool result;
-  if (is_newly_allocated_) {
+  if (is_newly_allocated_ && !IsLarge()) {
     result = true;
   } else {
     bool is_live_percent_valid = (live_bytes_ != static_cast<size_t>(-1));
@@ -189,9 +324,29 @@ inline bool RegionSpace::Region::ShouldBeEvacuated() {
   return result;
 }
 
+// The cost-benefit ratio, as in log-structured file systems, of evacuating an
+// old region with utilization u (live / allocated bytes): the space freed,
+// weighted by the age of the region (older data is more stable, so it is less
+// likely to be freed in place soon), over the cost of reading the region and
+// copying its live data.
+static double EvacuationCostBenefit(size_t live_bytes, size_t allocated_bytes, uint32_t age) {
+  const double u = allocated_bytes == 0U
+      ? 0.0
+      : static_cast<double>(live_bytes) / static_cast<double>(allocated_bytes);
+  return (1.0 - u) * static_cast<double>(age) / (1.0 + u);
+}
+
 // Determine which regions to evacuate and mark them as
 // from-space. Mark the rest as unevacuated from-space.
-void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all) {
+//
+// Newly allocated regions are always evacuated. Old regions whose live ratio
+// is below `kEvacuateLivePercentThreshold` are evacuation candidates; they are
+// sorted by cost-benefit ratio and evacuated while the copied live bytes stay
+// within `max_evacuated_live_percent_` of the capacity. Densely-live and
+// over-budget regions are left in place as unevacuated from-space.
+void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table,
+                               bool force_evacuate_all,
+                               bool young_gen) {
   ++time_;
   if (kUseTableLookupReadBarrier) {
     DCHECK(rb_table->IsAllCleared());
@@ -207,6 +362,8 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
   const size_t iter_limit = kUseTableLookupReadBarrier
       ? num_regions_
       : std::min(num_regions_, non_free_region_index_limit_);
+  // Old, sparsely-live (non-large) regions, decided after the loop below.
+  std::vector<std::pair<double, Region*>> evacuation_candidates;
   for (size_t i = 0; i < iter_limit; ++i) {
     Region* r = &regions_[i];
     RegionState state = r->State();
@@ -217,7 +374,28 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
         DCHECK((state == RegionState::kRegionStateAllocated ||
                 state == RegionState::kRegionStateLarge) &&
                type == RegionType::kRegionTypeToSpace);
-        bool should_evacuate = force_evacuate_all || r->ShouldBeEvacuated();
+        if (young_gen && !r->IsNewlyAllocated()) {
+          // Old region: keep it (and its large tails, if any) in the to-space.
+          size_t num_regs = 1U;
+          if (UNLIKELY(state == RegionState::kRegionStateLarge)) {
+            num_regs = RoundUp(r->BytesAllocated(), kRegionSize) / kRegionSize;
+          }
+          if (kUseTableLookupReadBarrier) {
+            rb_table->Clear(r->Begin(), r->Begin() + num_regs * kRegionSize);
+          }
+          i += num_regs - 1;
+          continue;
+        }
+        // Pinned regions stay in place, even when all regions are to be evacuated.
+        bool should_evacuate =
+            !r->IsPinned() && (force_evacuate_all || r->ShouldBeEvacuated());
+        if (should_evacuate && !force_evacuate_all && !r->IsNewlyAllocated() && r->IsAllocated()) {
+          DCHECK_LE(r->AllocTime(), time_);
+          evacuation_candidates.emplace_back(
+              EvacuationCostBenefit(r->LiveBytes(), r->BytesAllocated(), time_ - r->AllocTime()),
+              r);
+          continue;
+        }
         if (should_evacuate) {
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
@@ -252,8 +430,29 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
     }
   }
   DCHECK_EQ(num_expected_large_tails, 0U);
+  // Evacuate the candidates with the best cost-benefit ratio first, within the budget.
+  std::sort(evacuation_candidates.begin(),
+            evacuation_candidates.end(),
+            [](const std::pair<double, Region*>& a, const std::pair<double, Region*>& b) {
+              return a.first > b.first;
+            });
+  const size_t max_evacuated_live_bytes =
+      std::max(kRegionSize, num_regions_ * kRegionSize / 100U * max_evacuated_live_percent_);
+  size_t evacuated_live_bytes = 0U;
+  for (const std::pair<double, Region*>& candidate : evacuation_candidates) {
+    Region* r = candidate.second;
+    DCHECK(r->IsAllocated() && r->IsInToSpace());
+    if (evacuated_live_bytes + r->LiveBytes() <= max_evacuated_live_bytes) {
+      evacuated_live_bytes += r->LiveBytes();
+      r->SetAsFromSpace();
+      DCHECK(r->IsInFromSpace());
+    } else {
+      r->SetAsUnevacFromSpace();
+      DCHECK(r->IsInUnevacFromSpace());
+    }
+  }
   current_region_ = &full_region_;
-  evac_region_ = &full_region_;
+  std::fill_n(evac_regions_, num_numa_nodes_, &full_region_);
 }
 
 static void ZeroAndProtectRegion(uint8_t* begin, uint8_t* end) {
@@ -263,6 +462,47 @@ static void ZeroAndProtectRegion(uint8_t* begin, uint8_t* end) {
   }
 }
 
+bool RegionSpace::IsHugePageFree(uint8_t* huge_page_begin) {
+  DCHECK_ALIGNED(huge_page_begin, MemMap::kHugePageSize);
+  const size_t begin_index = (huge_page_begin - Begin()) / kRegionSize;
+  const size_t end_index =
+      std::min(num_regions_, begin_index + MemMap::kHugePageSize / kRegionSize);
+  for (size_t i = begin_index; i < end_index; ++i) {
+    if (!regions_[i].IsFree()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void RegionSpace::ZeroAndReleaseRegionPages(uint8_t* begin, uint8_t* end, bool protect) {
+  if (begin == end) {
+    return;
+  }
+  if (!use_huge_pages_) {
+    if (protect) {
+      ZeroAndProtectRegion(begin, end);
+    } else {
+      ZeroAndReleasePages(begin, end - begin);
+    }
+    return;
+  }
+  // Releasing (or protecting) part of a huge page would split it. Only release the huge pages
+  // whose regions are all free (which may extend beyond [begin, end), as free regions are
+  // already zero) and just zero the cleared regions in the others.
+  for (uint8_t* huge_page = AlignDown(begin, MemMap::kHugePageSize);
+       huge_page < end;
+       huge_page += MemMap::kHugePageSize) {
+    if (IsHugePageFree(huge_page)) {
+      ZeroAndReleasePages(huge_page, MemMap::kHugePageSize);
+    } else {
+      uint8_t* zero_begin = std::max(huge_page, begin);
+      uint8_t* zero_end = std::min(huge_page + MemMap::kHugePageSize, end);
+      std::fill(zero_begin, zero_end, 0);
+    }
+  }
+}
+
 void RegionSpace::ClearFromSpace(/* out */ uint64_t* cleared_bytes,
                                  /* out */ uint64_t* cleared_objects) {
   DCHECK(cleared_bytes != nullptr);
@@ -292,13 +532,14 @@ void RegionSpace::ClearFromSpace(/* out */ uint64_t* cleared_bytes,
   // (see b/62194020).
   uint8_t* clear_block_begin = nullptr;
   uint8_t* clear_block_end = nullptr;
-  auto clear_region = [&clear_block_begin, &clear_block_end](Region* r) {
+  auto clear_region = [this, &clear_block_begin, &clear_block_end](Region* r)
+      REQUIRES(region_lock_) {
     r->Clear(/*zero_and_release_pages*/false);
     if (clear_block_end != r->Begin()) {
       // Region `r` is not adjacent to the current clear block; zero and release
       // pages within the current block and restart a new clear block at the
       // beginning of region `r`.
-      ZeroAndProtectRegion(clear_block_begin, clear_block_end);
+      ZeroAndReleaseRegionPages(clear_block_begin, clear_block_end, /* protect */ true);
       clear_block_begin = r->Begin();
     }
     // Add region `r` to the clear block.
@@ -379,10 +620,10 @@ void RegionSpace::ClearFromSpace(/* out */ uint64_t* cleared_bytes,
     }
   }
   // Clear pages for the last block since clearing happens when a new block opens.
-  ZeroAndReleasePages(clear_block_begin, clear_block_end - clear_block_begin);
+  ZeroAndReleaseRegionPages(clear_block_begin, clear_block_end, /* protect */ false);
   // Update non_free_region_index_limit_.
   SetNonFreeRegionLimit(new_non_free_region_index_limit);
-  evac_region_ = nullptr;
+  std::fill_n(evac_regions_, num_numa_nodes_, nullptr);
   num_non_free_regions_ += num_evac_regions_;
   num_evac_regions_ = 0;
 }
@@ -434,11 +675,14 @@ void RegionSpace::Clear() {
     if (!r->IsFree()) {
       --num_non_free_regions_;
     }
-    r->Clear(/*zero_and_release_pages*/true);
+    r->Clear(/*zero_and_release_pages*/!use_huge_pages_);
+  }
+  if (use_huge_pages_) {
+    ZeroAndReleaseRegionPages(Begin(), Limit(), /* protect */ false);
   }
   SetNonFreeRegionLimit(0);
   current_region_ = &full_region_;
-  evac_region_ = &full_region_;
+  std::fill_n(evac_regions_, num_numa_nodes_, &full_region_);
 }
 
 void RegionSpace::ClampGrowthLimit(size_t new_capacity) {
@@ -497,7 +741,7 @@ bool RegionSpace::AllocNewTlab(Thread* self, size_t min_bytes) {
   RevokeThreadLocalBuffersLocked(self);
   // Retain sufficient free regions for full evacuation.
 
-  Region* r = AllocateRegion(/*for_evac*/ false);
+  Region* r = AllocateRegion(/*for_evac*/ false, GetCurrentNumaNode());
   if (r != nullptr) {
     r->is_a_tlab_ = true;
     r->thread_ = self;
@@ -595,6 +839,7 @@ void RegionSpace::Region::Clear(bool zero_and_release_pages) {
   objects_allocated_.StoreRelaxed(0);
   alloc_time_ = 0;
   live_bytes_ = static_cast<size_t>(-1);
+  DCHECK(!IsPinned());
   if (zero_and_release_pages) {
     ZeroAndProtectRegion(begin_, end_);
   }
@@ -603,11 +848,15 @@ void RegionSpace::Region::Clear(bool zero_and_release_pages) {
   thread_ = nullptr;
 }
 
-RegionSpace::Region* RegionSpace::AllocateRegion(bool for_evac) {
+RegionSpace::Region* RegionSpace::AllocateRegion(bool for_evac, size_t numa_node) {
   if (!for_evac && (num_non_free_regions_ + 1) * 2 > num_regions_) {
     return nullptr;
   }
-  for (size_t i = 0; i < num_regions_; ++i) {
+  DCHECK_LT(numa_node, num_numa_nodes_);
+  // Start the search at the regions of `numa_node` and wrap around to the other nodes.
+  const size_t first = std::min(numa_node * num_regions_per_numa_node_, num_regions_ - 1);
+  for (size_t n = 0; n < num_regions_; ++n) {
+    const size_t i = (first + n < num_regions_) ? first + n : first + n - num_regions_;
     Region* r = &regions_[i];
     if (r->IsFree()) {
       r->Unfree(this, time_);
@@ -26,6 +26,7 @@ namespace art {
 namespace gc {
 
 namespace accounting {
+class CardTable;
 class ReadBarrierTable;
 }  // namespace accounting
 
@@ -43,8 +44,18 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
   // Create a region space mem map with the requested sizes. The requested base address is not
   // guaranteed to be granted, if it is required, the caller should call Begin on the returned
   // space to confirm the request was granted.
-  static MemMap* CreateMemMap(const std::string& name, size_t capacity, uint8_t* requested_begin);
-  static RegionSpace* Create(const std::string& name, MemMap* mem_map);
+  // With huge pages, the capacity is rounded up to a multiple of the huge page size and the map
+  // is huge page aligned. Falls back to transparent huge pages if explicit ones are unavailable.
+  static MemMap* CreateMemMap(const std::string& name,
+                              size_t capacity,
+                              uint8_t* requested_begin,
+                              HugePageType huge_page_type = HugePageType::kDisabled);
+  // With `numa_aware`, the regions are split into one contiguous range per NUMA node and each
+  // range is bound to the memory of its node. See GetNumaNode().
+  static RegionSpace* Create(const std::string& name,
+                             MemMap* mem_map,
+                             HugePageType huge_page_type = HugePageType::kDisabled,
+                             bool numa_aware = false);
 
   // Allocate `num_bytes`, returns null if the space is full.
   mirror::Object* Alloc(Thread* self,
@@ -60,12 +71,15 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
                                     /* out */ size_t* usable_size,
                                     /* out */ size_t* bytes_tl_bulk_allocated)
       OVERRIDE REQUIRES(Locks::mutator_lock_) REQUIRES(!region_lock_);
-  // The main allocation routine.
+  // The main allocation routine. Evacuation allocates from a to-space region of
+  // `evac_numa_node`, if there is a free one, so that a copied object can stay on the node of its
+  // from-space region.
   template<bool kForEvac>
   ALWAYS_INLINE mirror::Object* AllocNonvirtual(size_t num_bytes,
                                                 /* out */ size_t* bytes_allocated,
                                                 /* out */ size_t* usable_size,
-                                                /* out */ size_t* bytes_tl_bulk_allocated)
+                                                /* out */ size_t* bytes_tl_bulk_allocated,
+                                                size_t evac_numa_node = 0U)
       REQUIRES(!region_lock_);
   // Allocate/free large objects (objects that are larger than the region size).
   template<bool kForEvac>
@@ -198,6 +212,31 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
   static constexpr size_t kAlignment = kObjectAlignment;
   // The region size.
   static constexpr size_t kRegionSize = 256 * KB;
+  // Default upper bound on the live bytes of the old (not newly allocated) regions evacuated in a
+  // collection, as a percentage of the region space capacity. The candidates with the best
+  // cost-benefit ratio are evacuated first; the others are left in place until a later collection.
+  static constexpr size_t kDefaultMaxEvacuatedLivePercent = 10U;
+
+  // Adjusted by the heap's GC pacing. Only accessed by the thread running the GC.
+  size_t GetMaxEvacuatedLivePercent() const {
+    return max_evacuated_live_percent_;
+  }
+  void SetMaxEvacuatedLivePercent(size_t percent) {
+    DCHECK_GT(percent, 0U);
+    DCHECK_LE(percent, 100U);
+    max_evacuated_live_percent_ = percent;
+  }
+
+  // Pins the region containing `ref`, see Region::Pin(). Used by JNI critical sections.
+  void PinRegionOf(mirror::Object* ref) {
+    DCHECK(HasAddress(ref));
+    RefToRegionUnlocked(ref)->Pin();
+  }
+
+  void UnpinRegionOf(mirror::Object* ref) {
+    DCHECK(HasAddress(ref));
+    RefToRegionUnlocked(ref)->Unpin();
+  }
 
   bool IsInFromSpace(mirror::Object* ref) {
     if (HasAddress(ref)) {
@@ -250,7 +289,27 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
 
   // Determine which regions to evacuate and tag them as
   // from-space. Tag the rest as unevacuated from-space.
-  void SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all)
+  //
+  // For a young-generation collection (`young_gen` is true), only the
+  // regions allocated since the previous collection are considered;
+  // the other (old) regions are left in the to-space and all of their
+  // objects are implicitly live.
+  void SetFromSpace(accounting::ReadBarrierTable* rb_table,
+                    bool force_evacuate_all,
+                    bool young_gen)
+      REQUIRES(!region_lock_);
+
+  // Visit the objects of the old regions (regions that survived the
+  // previous collection and were not allocated during the current one)
+  // whose start lies on a card whose value is at least `minimum_age`.
+  // Used by young-generation collections to find the references from
+  // old objects to newly allocated objects.
+  template <typename Visitor>
+  void VisitOldObjectsOnCards(accounting::CardTable* card_table,
+                              uint8_t minimum_age,
+                              Visitor&& visitor)
+      REQUIRES(Locks::heap_bitmap_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!region_lock_);
 
   size_t FromSpaceSize() REQUIRES(!region_lock_);
@@ -282,8 +341,26 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     return time_;
   }
 
+  // The maximum number of NUMA nodes a NUMA-aware region space spreads its regions over.
+  static constexpr size_t kMaxNumaNodes = 8;
+
+  size_t GetNumNumaNodes() const {
+    return num_numa_nodes_;
+  }
+
+  // Returns the NUMA node whose memory backs `ref`, which must be in this space. Always 0 unless
+  // the space is NUMA-aware.
+  size_t GetNumaNode(const mirror::Object* ref) const {
+    DCHECK(HasAddress(ref));
+    return RegionIndexToNumaNode(
+        static_cast<size_t>(reinterpret_cast<const uint8_t*>(ref) - Begin()) / kRegionSize);
+  }
+
  private:
-  RegionSpace(const std::string& name, MemMap* mem_map);
+  RegionSpace(const std::string& name,
+              MemMap* mem_map,
+              HugePageType huge_page_type,
+              bool numa_aware);
 
   template<bool kToSpaceOnly, typename Visitor>
   ALWAYS_INLINE void WalkInternal(Visitor&& visitor) NO_THREAD_SAFETY_ANALYSIS;
@@ -295,7 +372,7 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
           begin_(nullptr), top_(nullptr), end_(nullptr),
           state_(RegionState::kRegionStateAllocated), type_(RegionType::kRegionTypeToSpace),
           objects_allocated_(0), alloc_time_(0), live_bytes_(static_cast<size_t>(-1)),
-          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr) {}
+          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr), pin_count_(0u) {}
 
     void Init(size_t idx, uint8_t* begin, uint8_t* end) {
       idx_ = idx;
@@ -310,6 +387,7 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       is_newly_allocated_ = false;
       is_a_tlab_ = false;
       thread_ = nullptr;
+      pin_count_.StoreRelaxed(0u);
       DCHECK_LT(begin, end);
       DCHECK_EQ(static_cast<size_t>(end - begin), kRegionSize);
     }
@@ -429,6 +507,8 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     void SetUnevacFromSpaceAsToSpace() {
       DCHECK(!IsFree() && IsInUnevacFromSpace());
       type_ = RegionType::kRegionTypeToSpace;
+      // A surviving (large) region is no longer part of the young generation.
+      is_newly_allocated_ = false;
     }
 
     // Return whether this region should be evacuated. Used by RegionSpace::SetFromSpace.
@@ -439,9 +519,12 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       DCHECK(!IsLargeTail());
       DCHECK_NE(live_bytes_, static_cast<size_t>(-1));
       // For large allocations, we always consider all bytes in the
-      // regions live.
-      live_bytes_ += IsLarge() ? Top() - begin_ : live_bytes;
-      DCHECK_LE(live_bytes_, BytesAllocated());
+      // regions live. This may be called concurrently by the parallel
+      // marking threads of ConcurrentCopying.
+      size_t delta = IsLarge() ? Top() - begin_ : live_bytes;
+      size_t old_live_bytes =
+          reinterpret_cast<Atomic<size_t>*>(&live_bytes_)->FetchAndAddRelaxed(delta);
+      DCHECK_LE(old_live_bytes + delta, BytesAllocated());
     }
 
     bool AllAllocatedBytesAreLive() const {
@@ -452,6 +535,26 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       return live_bytes_;
     }
 
+    uint32_t AllocTime() const {
+      return alloc_time_;
+    }
+
+    // A pinned region is never evacuated, so that raw pointers into its objects handed out
+    // by JNI critical sections stay valid across collections, without holding off thread
+    // flips. Pins nest and may be taken by several threads at once.
+    void Pin() {
+      pin_count_.FetchAndAddSequentiallyConsistent(1u);
+    }
+
+    void Unpin() {
+      uint32_t old_pin_count = pin_count_.FetchAndSubSequentiallyConsistent(1u);
+      DCHECK_NE(old_pin_count, 0u);
+    }
+
+    bool IsPinned() const {
+      return pin_count_.LoadRelaxed() != 0u;
+    }
+
     size_t BytesAllocated() const;
 
     size_t ObjectsAllocated() const;
@@ -505,6 +608,7 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     bool is_newly_allocated_;           // True if it's allocated after the last collection.
     bool is_a_tlab_;                    // True if it's a tlab.
     Thread* thread_;                    // The owning thread if it's a tlab.
+    Atomic<uint32_t> pin_count_;        // The number of JNI critical sections pinning it.
 
     friend class RegionSpace;
   };
@@ -569,7 +673,25 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     }
   }
 
-  Region* AllocateRegion(bool for_evac) REQUIRES(region_lock_);
+  // Allocates a free region, preferring the regions backed by the memory of `numa_node`.
+  Region* AllocateRegion(bool for_evac, size_t numa_node) REQUIRES(region_lock_);
+
+  size_t RegionIndexToNumaNode(size_t idx) const {
+    return std::min(idx / num_regions_per_numa_node_, num_numa_nodes_ - 1);
+  }
+
+  // Returns the NUMA node of the CPU the calling thread runs on, 0 if the space is not NUMA-aware.
+  size_t GetCurrentNumaNode() const;
+
+  // Binds the range of regions of each NUMA node to the memory of that node.
+  void BindRegionsToNumaNodes();
+
+  // Zero and release the pages of the cleared regions in [begin, end), respecting huge page
+  // boundaries if the space is backed by huge pages.
+  void ZeroAndReleaseRegionPages(uint8_t* begin, uint8_t* end, bool protect)
+      REQUIRES(region_lock_);
+  // Whether all the regions of the huge page starting at `huge_page_begin` are free.
+  bool IsHugePageFree(uint8_t* huge_page_begin) REQUIRES(region_lock_);
 
   Mutex region_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
@@ -597,12 +719,25 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
   size_t non_free_region_index_limit_ GUARDED_BY(region_lock_);
 
   Region* current_region_;         // The region currently used for allocation.
-  Region* evac_region_;            // The region currently used for evacuation.
+  // The regions currently used for evacuation, one per NUMA node.
+  Region* evac_regions_[kMaxNumaNodes];
   Region full_region_;             // The dummy/sentinel region that looks full.
 
   // Mark bitmap used by the GC.
   std::unique_ptr<accounting::ContinuousSpaceBitmap> mark_bitmap_;
 
+  // True if the space is backed by (transparent or explicit) huge pages.
+  const bool use_huge_pages_;
+
+  // See kDefaultMaxEvacuatedLivePercent.
+  size_t max_evacuated_live_percent_;
+
+  // The number of NUMA nodes the regions are spread over, 1 unless the space is NUMA-aware. Node
+  // `n` owns the regions from `n * num_regions_per_numa_node_` on; the last node also owns any
+  // remainder.
+  size_t num_numa_nodes_;
+  size_t num_regions_per_numa_node_;
+
   DISALLOW_COPY_AND_ASSIGN(RegionSpace);
 };
 
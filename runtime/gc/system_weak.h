@@ -48,7 +48,6 @@ class SystemWeakHolder : public AbstractSystemWeakHolder {
   void Allow() OVERRIDE
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!allow_disallow_lock_) {
-    CHECK(!kUseReadBarrier);
     MutexLock mu(Thread::Current(), allow_disallow_lock_);
     allow_new_system_weak_ = true;
     new_weak_condition_.Broadcast(Thread::Current());
@@ -57,7 +56,6 @@ class SystemWeakHolder : public AbstractSystemWeakHolder {
   void Disallow() OVERRIDE
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!allow_disallow_lock_) {
-    CHECK(!kUseReadBarrier);
     MutexLock mu(Thread::Current(), allow_disallow_lock_);
     allow_new_system_weak_ = false;
   }
@@ -77,9 +75,10 @@ class SystemWeakHolder : public AbstractSystemWeakHolder {
   void Wait(Thread* self)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(allow_disallow_lock_) {
-    // Wait for GC's sweeping to complete and allow new records
-    while (UNLIKELY((!kUseReadBarrier && !allow_new_system_weak_) ||
-                    (kUseReadBarrier && !self->GetWeakRefAccessEnabled()))) {
+    // Wait for GC's sweeping to complete and allow new records. With the read barrier, the holder
+    // is also accessible while the thread-local weak ref access flag is set.
+    while (UNLIKELY(!allow_new_system_weak_ &&
+                    (!kUseReadBarrier || !self->GetWeakRefAccessEnabled()))) {
       // Check and run the empty checkpoint before blocking so the empty checkpoint will work in the
       // presence of threads blocking for weak ref access.
       self->CheckEmptyCheckpointFromWeakRefAccess(&allow_disallow_lock_);
@@ -106,15 +106,18 @@ struct CountingSystemWeakHolder : public SystemWeakHolder {
   GcRoot<mirror::Object> weak_ GUARDED_BY(allow_disallow_lock_);
 };
 
-static bool CollectorDoesAllowOrBroadcast() {
+static size_t CollectorAllowOrBroadcastCount() {
   CollectorType type = Runtime::Current()->GetHeap()->CurrentCollectorType();
   switch (type) {
     case CollectorType::kCollectorTypeCMS:
+      return 1U;
+
     case CollectorType::kCollectorTypeCC:
-      return true;
+      // Allowed once swept, then broadcast when weak ref access is re-enabled.
+      return 2U;
 
     default:
-      return false;
+      return 0U;
   }
 }
 
@@ -122,6 +125,7 @@ static bool CollectorDoesDisallow() {
   CollectorType type = Runtime::Current()->GetHeap()->CurrentCollectorType();
   switch (type) {
     case CollectorType::kCollectorTypeCMS:
+    case CollectorType::kCollectorTypeCC:
       return true;
 
     default:
@@ -145,7 +149,7 @@ TEST_F(SystemWeakTest, Keep) {
   Runtime::Current()->GetHeap()->CollectGarbage(/* clear_soft_references */ false);
 
   // Expect the holder to have been called.
-  EXPECT_EQ(CollectorDoesAllowOrBroadcast() ? 1U : 0U, cswh.allow_count_);
+  EXPECT_EQ(CollectorAllowOrBroadcastCount(), cswh.allow_count_);
   EXPECT_EQ(CollectorDoesDisallow() ? 1U : 0U, cswh.disallow_count_);
   EXPECT_EQ(1U, cswh.sweep_count_);
 
@@ -166,7 +170,7 @@ TEST_F(SystemWeakTest, Discard) {
   Runtime::Current()->GetHeap()->CollectGarbage(/* clear_soft_references */ false);
 
   // Expect the holder to have been called.
-  EXPECT_EQ(CollectorDoesAllowOrBroadcast() ? 1U : 0U, cswh.allow_count_);
+  EXPECT_EQ(CollectorAllowOrBroadcastCount(), cswh.allow_count_);
   EXPECT_EQ(CollectorDoesDisallow() ? 1U : 0U, cswh.disallow_count_);
   EXPECT_EQ(1U, cswh.sweep_count_);
 
@@ -190,7 +194,7 @@ TEST_F(SystemWeakTest, Remove) {
   Runtime::Current()->GetHeap()->CollectGarbage(/* clear_soft_references */ false);
 
   // Expect the holder to have been called.
-  ASSERT_EQ(CollectorDoesAllowOrBroadcast() ? 1U : 0U, cswh.allow_count_);
+  ASSERT_EQ(CollectorAllowOrBroadcastCount(), cswh.allow_count_);
   ASSERT_EQ(CollectorDoesDisallow() ? 1U : 0U, cswh.disallow_count_);
   ASSERT_EQ(1U, cswh.sweep_count_);
 
@@ -205,7 +209,7 @@ TEST_F(SystemWeakTest, Remove) {
   Runtime::Current()->GetHeap()->CollectGarbage(/* clear_soft_references */ false);
 
   // Expectation: no change in the numbers.
-  EXPECT_EQ(CollectorDoesAllowOrBroadcast() ? 1U : 0U, cswh.allow_count_);
+  EXPECT_EQ(CollectorAllowOrBroadcastCount(), cswh.allow_count_);
   EXPECT_EQ(CollectorDoesDisallow() ? 1U : 0U, cswh.disallow_count_);
   EXPECT_EQ(1U, cswh.sweep_count_);
 }
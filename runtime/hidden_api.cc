@@ -197,6 +197,24 @@ static ALWAYS_INLINE void MaybeWhitelistMember(Runtime* runtime, T* member)
   }
 }
 
+template<typename T>
+bool GetCachedMemberAction(T* member, Action* action) {
+  const MemberActionCache* cache = Thread::Current()->GetHiddenApiCache();
+  return cache != nullptr && cache->Lookup(member, Runtime::Current()->GetHiddenApiEpoch(), action);
+}
+
+template<typename T>
+static void CacheMemberAction(T* member, uint32_t epoch, Action action)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  Thread* self = Thread::Current();
+  MemberActionCache* cache = self->GetHiddenApiCache();
+  if (cache == nullptr) {
+    cache = new MemberActionCache();
+    self->SetHiddenApiCache(cache);
+  }
+  cache->Set(member, epoch, action);
+}
+
 template<typename T>
 Action GetMemberActionImpl(T* member,
                            HiddenApiAccessFlags::ApiList api_list,
@@ -208,6 +226,8 @@ Action GetMemberActionImpl(T* member,
   MemberSignature member_signature(member);
 
   Runtime* runtime = Runtime::Current();
+  // Read the epoch before the settings the decision depends on.
+  const uint32_t epoch = runtime->GetHiddenApiEpoch();
 
   // Check for an exemption first. Exempted APIs are treated as white list.
   // We only do this if we're about to deny, or if the app is debuggable. This is because:
@@ -223,6 +243,7 @@ Action GetMemberActionImpl(T* member,
       // Note this results in no warning for the member, which seems like what one would expect.
       // Exemptions effectively adds new members to the whitelist.
       MaybeWhitelistMember(runtime, member);
+      CacheMemberAction(member, epoch, kAllow);
       return kAllow;
     }
 
@@ -243,6 +264,12 @@ Action GetMemberActionImpl(T* member,
     }
   }
 
+  if (access_method != kNone && runtime->ShouldDedupeHiddenApiWarnings()) {
+    // Do not examine, log or report this member again unless the settings change. This also
+    // covers denied members and intrinsics, which cannot be moved into the whitelist.
+    CacheMemberAction(member, epoch, action);
+  }
+
   if (action == kDeny) {
     // Block access
     return action;
@@ -267,6 +294,8 @@ Action GetMemberActionImpl(T* member,
 }
 
 // Need to instantiate this.
+template bool GetCachedMemberAction<ArtField>(ArtField* member, Action* action);
+template bool GetCachedMemberAction<ArtMethod>(ArtMethod* member, Action* action);
 template Action GetMemberActionImpl<ArtField>(ArtField* member,
                                               HiddenApiAccessFlags::ApiList api_list,
                                               Action action,
@@ -17,8 +17,11 @@
 #ifndef ART_RUNTIME_HIDDEN_API_H_
 #define ART_RUNTIME_HIDDEN_API_H_
 
+#include <array>
+
 #include "art_field-inl.h"
 #include "art_method-inl.h"
+#include "base/bit_utils.h"
 #include "base/mutex.h"
 #include "dex/hidden_api_access_flags.h"
 #include "mirror/class-inl.h"
@@ -149,6 +152,55 @@ class MemberSignature {
   void LogAccessToEventLog(AccessMethod access_method, Action action_taken);
 };
 
+// Small per-thread, direct-mapped cache of the decisions taken by GetMemberActionImpl(), keyed
+// by the ArtField or ArtMethod. These decisions do not depend on the caller, only on the member
+// and the runtime's hidden API settings, so entries are tagged with Runtime::GetHiddenApiEpoch()
+// and do not match after a setting changes. Only boot class path members have hidden API flags
+// and they are never unloaded, so the raw pointers stay valid.
+//
+// Since the cache is thread-local, it is accessed without synchronization.
+class MemberActionCache {
+ public:
+  static constexpr size_t kSize = 64;
+
+  // Returns true and sets `action` if there is a decision for `member` taken in `epoch`.
+  bool Lookup(const void* member, uint32_t epoch, Action* action) const {
+    const Entry& entry = data_[IndexOf(member)];
+    if (entry.member != member || entry.epoch != epoch) {
+      return false;
+    }
+    *action = entry.action;
+    return true;
+  }
+
+  // Replaces whatever entry `member` maps to.
+  void Set(const void* member, uint32_t epoch, Action action) {
+    Entry& entry = data_[IndexOf(member)];
+    entry.member = member;
+    entry.epoch = epoch;
+    entry.action = action;
+  }
+
+ private:
+  struct Entry {
+    const void* member = nullptr;
+    uint32_t epoch = 0u;
+    Action action = kAllow;
+  };
+
+  static size_t IndexOf(const void* member) {
+    static_assert(IsPowerOfTwo(kSize), "Size must be a power of two");
+    // ArtField and ArtMethod are at least 4 bytes in size and aligned.
+    return (reinterpret_cast<uintptr_t>(member) >> 2) & (kSize - 1);
+  }
+
+  std::array<Entry, kSize> data_;
+};
+
+// Returns true and sets `action` if the current thread has cached the decision for `member`.
+template<typename T>
+bool GetCachedMemberAction(T* member, Action* action) REQUIRES_SHARED(Locks::mutator_lock_);
+
 template<typename T>
 Action GetMemberActionImpl(T* member,
                            HiddenApiAccessFlags::ApiList api_list,
@@ -210,19 +262,31 @@ inline Action GetMemberAction(T* member,
   // results, e.g. print whitelist warnings (b/78327881).
   HiddenApiAccessFlags::ApiList api_list = member->GetHiddenApiAccessFlags();
 
-  Action action = GetActionFromAccessFlags(member->GetHiddenApiAccessFlags());
+  Action action = GetActionFromAccessFlags(api_list);
   if (action == kAllow) {
     // Nothing to do.
     return action;
   }
 
-  // Member is hidden. Invoke `fn_caller_in_platform` and find the origin of the access.
+  // Member is hidden. Reuse an earlier decision for it if there is one, e.g. an exemption.
+  Action cached_action;
+  const bool is_cached = detail::GetCachedMemberAction(member, &cached_action);
+  if (is_cached && cached_action == kAllow) {
+    return kAllow;
+  }
+
+  // Invoke `fn_caller_in_platform` and find the origin of the access.
   // This can be *very* expensive. Save it for last.
   if (fn_caller_is_trusted(self)) {
     // Caller is trusted. Exit.
     return kAllow;
   }
 
+  if (is_cached) {
+    // The access was already logged and reported when the decision was taken.
+    return cached_action;
+  }
+
   // Member is hidden and caller is not in the platform.
   return detail::GetMemberActionImpl(member, api_list, action, access_method);
 }
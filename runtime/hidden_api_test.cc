@@ -22,6 +22,7 @@
 
 namespace art {
 
+using hiddenapi::detail::MemberActionCache;
 using hiddenapi::detail::MemberSignature;
 using hiddenapi::GetActionFromAccessFlags;
 
@@ -125,6 +126,39 @@ TEST_F(HiddenApiTest, CheckGetActionFromRuntimeFlags) {
             hiddenapi::kDeny);
 }
 
+TEST_F(HiddenApiTest, CheckMemberActionCache) {
+  MemberActionCache cache;
+  hiddenapi::Action action;
+  ASSERT_FALSE(cache.Lookup(class1_field1_, 0u, &action));
+
+  cache.Set(class1_field1_, 0u, hiddenapi::kDeny);
+  cache.Set(class1_method1_, 0u, hiddenapi::kAllow);
+  ASSERT_TRUE(cache.Lookup(class1_field1_, 0u, &action));
+  ASSERT_EQ(action, hiddenapi::kDeny);
+  ASSERT_TRUE(cache.Lookup(class1_method1_, 0u, &action));
+  ASSERT_EQ(action, hiddenapi::kAllow);
+  ASSERT_FALSE(cache.Lookup(class1_method1_i_, 0u, &action));
+
+  // Decisions taken with other settings do not match.
+  ASSERT_FALSE(cache.Lookup(class1_field1_, 1u, &action));
+  cache.Set(class1_field1_, 1u, hiddenapi::kAllowButWarn);
+  ASSERT_TRUE(cache.Lookup(class1_field1_, 1u, &action));
+  ASSERT_EQ(action, hiddenapi::kAllowButWarn);
+  ASSERT_FALSE(cache.Lookup(class1_field1_, 0u, &action));
+}
+
+TEST_F(HiddenApiTest, CheckEpochChangesWithSettings) {
+  uint32_t epoch = runtime_->GetHiddenApiEpoch();
+  runtime_->SetHiddenApiEnforcementPolicy(hiddenapi::EnforcementPolicy::kBlacklistOnly);
+  ASSERT_NE(epoch, runtime_->GetHiddenApiEpoch());
+  epoch = runtime_->GetHiddenApiEpoch();
+  runtime_->SetHiddenApiExemptions(std::vector<std::string>({"L"}));
+  ASSERT_NE(epoch, runtime_->GetHiddenApiEpoch());
+  epoch = runtime_->GetHiddenApiEpoch();
+  runtime_->SetDedupeHiddenApiWarnings(false);
+  ASSERT_NE(epoch, runtime_->GetHiddenApiEpoch());
+}
+
 TEST_F(HiddenApiTest, CheckMembersRead) {
   ASSERT_NE(nullptr, class1_field1_);
   ASSERT_NE(nullptr, class1_field12_);
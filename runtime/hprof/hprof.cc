@@ -31,8 +31,10 @@
 #include <string.h>
 #include <sys/time.h>
 #include <sys/uio.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
+#include <zlib.h>
 
 #include <set>
 
@@ -413,6 +415,34 @@ class FileEndianOutput FINAL : public EndianOutputBuffered {
   bool errors_;
 };
 
+class GzipEndianOutput FINAL : public EndianOutputBuffered {
+ public:
+  GzipEndianOutput(gzFile gz, size_t reserved_size)
+      : EndianOutputBuffered(reserved_size), gz_(gz), errors_(false) {
+    DCHECK(gz != nullptr);
+  }
+  ~GzipEndianOutput() {
+  }
+
+  bool Errors() {
+    return errors_;
+  }
+
+ protected:
+  void HandleFlush(const uint8_t* buffer, size_t length) OVERRIDE {
+    // Records are flushed one by one, so zlib sees the stream incrementally and the
+    // uncompressed dump never needs to be in memory as a whole.
+    if (!errors_ && length != 0u) {
+      errors_ = gzwrite(gz_, buffer, static_cast<unsigned int>(length)) !=
+          static_cast<int>(length);
+    }
+  }
+
+ private:
+  gzFile gz_;
+  bool errors_;
+};
+
 class VectorEndianOuputput FINAL : public EndianOutputBuffered {
  public:
   VectorEndianOuputput(std::vector<uint8_t>& data, size_t reserved_size)
@@ -434,14 +464,21 @@ class VectorEndianOuputput FINAL : public EndianOutputBuffered {
 
 class Hprof : public SingleRootVisitor {
  public:
-  Hprof(const char* output_filename, int fd, bool direct_to_ddms)
+  Hprof(const char* output_filename,
+        int fd,
+        bool direct_to_ddms,
+        bool compress = false,
+        bool in_forked_child = false)
       : filename_(output_filename),
         fd_(fd),
-        direct_to_ddms_(direct_to_ddms) {
+        direct_to_ddms_(direct_to_ddms),
+        compress_(compress),
+        in_forked_child_(in_forked_child) {
+    DCHECK(!direct_to_ddms || (!compress && !in_forked_child));
     LOG(INFO) << "hprof: heap dump \"" << filename_ << "\" starting...";
   }
 
-  void Dump()
+  bool Dump()
     REQUIRES(Locks::mutator_lock_)
     REQUIRES(!Locks::heap_bitmap_lock_, !Locks::alloc_tracker_lock_) {
     {
@@ -482,6 +519,7 @@ class Hprof : public SingleRootVisitor {
                 << " objects " << total_objects_
                 << " objects with stack traces " << total_objects_with_stack_trace_;
     }
+    return okay;
   }
 
  private:
@@ -756,6 +794,16 @@ class Hprof : public SingleRootVisitor {
     //        Dbg::DdmSendChunkV(CHUNK_TYPE("HPDS"), iov, 2);
   }
 
+  // Throw, except in a forked child, where nobody would catch the exception and allocating it
+  // could need the threads that did not survive the fork. The parent reports the failure then.
+  void ReportError(const std::string& msg) REQUIRES(Locks::mutator_lock_) {
+    if (in_forked_child_) {
+      LOG(ERROR) << msg;
+    } else {
+      ThrowRuntimeException("%s", msg.c_str());
+    }
+  }
+
   bool DumpToFile(size_t overall_size, size_t max_length)
       REQUIRES(Locks::mutator_lock_) {
     // Where exactly are we writing to?
@@ -763,18 +811,25 @@ class Hprof : public SingleRootVisitor {
     if (fd_ >= 0) {
       out_fd = dup(fd_);
       if (out_fd < 0) {
-        ThrowRuntimeException("Couldn't dump heap; dup(%d) failed: %s", fd_, strerror(errno));
+        ReportError(android::base::StringPrintf("Couldn't dump heap; dup(%d) failed: %s",
+                                                fd_,
+                                                strerror(errno)));
         return false;
       }
     } else {
       out_fd = open(filename_.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
       if (out_fd < 0) {
-        ThrowRuntimeException("Couldn't dump heap; open(\"%s\") failed: %s", filename_.c_str(),
-                              strerror(errno));
+        ReportError(android::base::StringPrintf("Couldn't dump heap; open(\"%s\") failed: %s",
+                                                filename_.c_str(),
+                                                strerror(errno)));
         return false;
       }
     }
 
+    if (compress_) {
+      return DumpToGzipFile(out_fd, overall_size, max_length);
+    }
+
     std::unique_ptr<File> file(new File(out_fd, filename_, true));
     bool okay;
     {
@@ -800,13 +855,49 @@ class Hprof : public SingleRootVisitor {
       std::string msg(android::base::StringPrintf("Couldn't dump heap; writing \"%s\" failed: %s",
                                                   filename_.c_str(),
                                                   strerror(errno)));
-      ThrowRuntimeException("%s", msg.c_str());
+      ReportError(msg);
       LOG(ERROR) << msg;
     }
 
     return okay;
   }
 
+  // Like the rest of DumpToFile(), but streams the dump through zlib. Takes ownership of `out_fd`.
+  bool DumpToGzipFile(int out_fd, size_t overall_size, size_t max_length)
+      REQUIRES(Locks::mutator_lock_) {
+    gzFile gz = gzdopen(out_fd, "wb");
+    if (gz == nullptr) {
+      close(out_fd);
+      ReportError(android::base::StringPrintf("Couldn't dump heap; gzdopen(\"%s\") failed",
+                                              filename_.c_str()));
+      return false;
+    }
+    bool okay;
+    {
+      GzipEndianOutput gzip_output(gz, max_length);
+      output_ = &gzip_output;
+      ProcessHeap(true);
+      okay = !gzip_output.Errors();
+      if (okay) {
+        // The length is the uncompressed one. See DumpToFile for comment.
+        DCHECK_LE(gzip_output.SumLength(), overall_size);
+      }
+      output_ = nullptr;
+    }
+    // Closes `out_fd` as well.
+    okay = (gzclose(gz) == Z_OK) && okay;
+    if (!okay) {
+      if (fd_ < 0) {
+        unlink(filename_.c_str());
+      }
+      std::string msg(android::base::StringPrintf("Couldn't dump heap; writing \"%s\" failed",
+                                                  filename_.c_str()));
+      ReportError(msg);
+      LOG(ERROR) << msg;
+    }
+    return okay;
+  }
+
   bool DumpToDdmsDirect(size_t overall_size, size_t max_length, uint32_t chunk_type)
       REQUIRES(Locks::mutator_lock_) {
     CHECK(direct_to_ddms_);
@@ -876,6 +967,10 @@ class Hprof : public SingleRootVisitor {
   std::string filename_;
   int fd_;
   bool direct_to_ddms_;
+  // Whether the file is gzip compressed.
+  bool compress_;
+  // Whether this is the child of DumpHeapForked(), which only has the dumping thread.
+  bool in_forked_child_;
 
   uint64_t start_ns_ = NanoTime();
 
@@ -1598,7 +1693,7 @@ void Hprof::VisitRoot(mirror::Object* obj, const RootInfo& info) {
 // sent directly to DDMS.
 // If "fd" is >= 0, the output will be written to that file descriptor.
 // Otherwise, "filename" is used to create an output file.
-void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
+void DumpHeap(const char* filename, int fd, bool direct_to_ddms, bool compress) {
   CHECK(filename != nullptr);
   Thread* self = Thread::Current();
   // Need to take a heap dump while GC isn't running. See the comment in Heap::VisitObjects().
@@ -1607,9 +1702,59 @@ void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
                                   gc::kGcCauseHprof,
                                   gc::kCollectorTypeHprof);
   ScopedSuspendAll ssa(__FUNCTION__, true /* long suspend */);
-  Hprof hprof(filename, fd, direct_to_ddms);
+  Hprof hprof(filename, fd, direct_to_ddms, compress && !direct_to_ddms);
   hprof.Dump();
 }
 
+// Like DumpHeap() to a file, but the runtime is only suspended while fork() snapshots the
+// process. The copy-on-write child does the walk and writes the dump while the other threads of
+// the parent run again; the calling thread waits for the child without holding any lock.
+//
+// The child has no other threads, so it must not do anything that would wait for them, such as
+// a GC, a checkpoint or throwing. It keeps the GC critical section and the exclusive mutator
+// lock of the suspension, which also keep the snapshot of the heap consistent, and leaves with
+// _exit() so that no runtime shutdown runs in it.
+void DumpHeapForked(const char* filename, int fd, bool compress) {
+  CHECK(filename != nullptr);
+  Thread* self = Thread::Current();
+  const uint64_t start_ns = NanoTime();
+  pid_t pid;
+  uint64_t pause_ns;
+  {
+    gc::ScopedGCCriticalSection gcs(self,
+                                    gc::kGcCauseHprof,
+                                    gc::kCollectorTypeHprof);
+    ScopedSuspendAll ssa(__FUNCTION__, true /* long suspend */);
+    pid = fork();
+    if (pid == 0) {
+      Hprof hprof(filename, fd, false /* direct_to_ddms */, compress, true /* in_forked_child */);
+      _exit(hprof.Dump() ? 0 : 1);
+    }
+    pause_ns = NanoTime() - start_ns;
+  }
+  if (pid < 0) {
+    int fork_errno = errno;
+    ScopedObjectAccess soa(self);
+    ThrowRuntimeException("Couldn't dump heap; fork failed: %s", strerror(fork_errno));
+    return;
+  }
+  LOG(INFO) << "hprof: forked " << pid << " to dump \"" << filename << "\", paused for "
+            << PrettyDuration(pause_ns);
+  int status;
+  if (TEMP_FAILURE_RETRY(waitpid(pid, &status, 0)) != pid) {
+    int wait_errno = errno;
+    ScopedObjectAccess soa(self);
+    ThrowRuntimeException("Couldn't dump heap; waitpid(%d) failed: %s", pid, strerror(wait_errno));
+    return;
+  }
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    ScopedObjectAccess soa(self);
+    ThrowRuntimeException("Couldn't dump heap; writing \"%s\" failed in child %d (status 0x%x)",
+                          filename,
+                          pid,
+                          status);
+  }
+}
+
 }  // namespace hprof
 }  // namespace art
@@ -21,7 +21,13 @@ namespace art {
 
 namespace hprof {
 
-void DumpHeap(const char* filename, int fd, bool direct_to_ddms);
+// If `compress` is true, the file is gzip compressed. It is ignored with `direct_to_ddms`.
+void DumpHeap(const char* filename, int fd, bool direct_to_ddms, bool compress = false);
+
+// Dump the heap to `fd`, or to a new file `filename` if `fd` is negative, from a forked snapshot
+// of the process, which keeps the pause short on large heaps. If `compress` is true, the dump is
+// gzip compressed. Throws a RuntimeException on failure, like DumpHeap().
+void DumpHeapForked(const char* filename, int fd, bool compress);
 
 }  // namespace hprof
 
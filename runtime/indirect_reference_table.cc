@@ -27,6 +27,7 @@
 #include "scoped_thread_state_change-inl.h"
 #include "thread.h"
 
+#include <algorithm>
 #include <cstdlib>
 
 namespace art {
@@ -37,6 +38,9 @@ static constexpr bool kDebugIRT = false;
 // Maximum table size we allow.
 static constexpr size_t kMaxTableSizeInBytes = 128 * MB;
 
+// Stale free list entries allowed beyond twice the table's entries before the list is rebuilt.
+static constexpr size_t kFreeHolesSlack = 64;
+
 const char* GetIndirectRefKindString(const IndirectRefKind& kind) {
   switch (kind) {
     case kHandleScopeOrInvalid:
@@ -67,8 +71,9 @@ IndirectReferenceTable::IndirectReferenceTable(size_t max_count,
                                                ResizableCapacity resizable,
                                                std::string* error_msg)
     : segment_state_(kIRTFirstSegment),
+      table_(nullptr),
       kind_(desired_kind),
-      max_entries_(max_count),
+      max_entries_(0u),
       current_num_holes_(0),
       resizable_(resizable) {
   CHECK(error_msg != nullptr);
@@ -77,18 +82,16 @@ IndirectReferenceTable::IndirectReferenceTable(size_t max_count,
   // Overflow and maximum check.
   CHECK_LE(max_count, kMaxTableSizeInBytes / sizeof(IrtEntry));
 
-  const size_t table_bytes = max_count * sizeof(IrtEntry);
-  table_mem_map_.reset(MemMap::MapAnonymous("indirect ref table", nullptr, table_bytes,
-                                            PROT_READ | PROT_WRITE, false, false, error_msg));
-  if (table_mem_map_.get() == nullptr && error_msg->empty()) {
+  // The maximum entries is a power of two, so rounding up keeps the first chunk within it.
+  chunk_entries_ = RoundUpToPowerOfTwo(std::max<size_t>(max_count, 1u));
+  chunk_shift_ = WhichPowerOf2(chunk_entries_);
+  if (AddChunks(chunk_entries_, error_msg)) {
+    table_ = chunks_[0];
+  } else if (error_msg->empty()) {
     *error_msg = "Unable to map memory for indirect ref table";
   }
-
-  if (table_mem_map_.get() != nullptr) {
-    table_ = reinterpret_cast<IrtEntry*>(table_mem_map_->Begin());
-  } else {
-    table_ = nullptr;
-  }
+  // The rounded up chunk doesn't raise the maximum of a table that can't be resized.
+  max_entries_ = max_count;
   segment_state_ = kIRTFirstSegment;
   last_known_previous_state_ = kIRTFirstSegment;
 }
@@ -125,7 +128,7 @@ void IndirectReferenceTable::ConstexprChecks() {
 }
 
 bool IndirectReferenceTable::IsValid() const {
-  return table_mem_map_.get() != nullptr;
+  return table_ != nullptr;
 }
 
 // Holes:
@@ -162,11 +165,18 @@ bool IndirectReferenceTable::IsValid() const {
 // segment changes above. The condition is simply that the last known state is greater than or
 // equal to the current previous state, and smaller than the current state (top index). The
 // condition is conservative as it adds O(1) overhead to operations on an empty segment.
-
-static size_t CountNullEntries(const IrtEntry* table, size_t from, size_t to) {
+//
+// To find a hole without scanning, Remove also pushes the index of each hole it creates on the
+// free_holes_ list. The list isn't updated when holes are consumed by collapsing the top or when a
+// segment is popped, so an index popped from the list is only used if it's still a hole of the
+// current segment. Holes of the current segment are pushed after those of older segments it
+// still has: an index below the current segment ends the search, as the holes that segment had
+// before a pushed segment was popped may still be found by the scan.
+
+size_t IndirectReferenceTable::CountNullEntries(size_t from, size_t to) const {
   size_t count = 0;
   for (size_t index = from; index != to; ++index) {
-    if (table[index].GetReference()->IsNull()) {
+    if (GetEntry(index)->GetReference()->IsNull()) {
       count++;
     }
   }
@@ -177,7 +187,7 @@ void IndirectReferenceTable::RecoverHoles(IRTSegmentState prev_state) {
   if (last_known_previous_state_.top_index >= segment_state_.top_index ||
       last_known_previous_state_.top_index < prev_state.top_index) {
     const size_t top_index = segment_state_.top_index;
-    size_t count = CountNullEntries(table_, prev_state.top_index, top_index);
+    size_t count = CountNullEntries(prev_state.top_index, top_index);
 
     if (kDebugIRT) {
       LOG(INFO) << "+++ Recovered holes: "
@@ -195,17 +205,40 @@ void IndirectReferenceTable::RecoverHoles(IRTSegmentState prev_state) {
 }
 
 ALWAYS_INLINE
-static inline void CheckHoleCount(IrtEntry* table,
-                                  size_t exp_num_holes,
-                                  IRTSegmentState prev_state,
-                                  IRTSegmentState cur_state) {
+inline void IndirectReferenceTable::CheckHoleCount(size_t exp_num_holes,
+                                                   IRTSegmentState prev_state,
+                                                   IRTSegmentState cur_state) const {
   if (kIsDebugBuild) {
-    size_t count = CountNullEntries(table, prev_state.top_index, cur_state.top_index);
+    size_t count = CountNullEntries(prev_state.top_index, cur_state.top_index);
     CHECK_EQ(exp_num_holes, count) << "prevState=" << prev_state.top_index
                                    << " topIndex=" << cur_state.top_index;
   }
 }
 
+bool IndirectReferenceTable::AddChunks(size_t new_size, std::string* error_msg) {
+  const size_t num_chunks = RoundUp(new_size, chunk_entries_) >> chunk_shift_;
+  DCHECK_GT(num_chunks, chunks_.size());
+  const size_t num_new_chunks = num_chunks - chunks_.size();
+  const size_t table_bytes = num_new_chunks * chunk_entries_ * sizeof(IrtEntry);
+  std::unique_ptr<MemMap> new_map(MemMap::MapAnonymous("indirect ref table",
+                                                       nullptr,
+                                                       table_bytes,
+                                                       PROT_READ | PROT_WRITE,
+                                                       false,
+                                                       false,
+                                                       error_msg));
+  if (new_map == nullptr) {
+    return false;
+  }
+
+  IrtEntry* entries = reinterpret_cast<IrtEntry*>(new_map->Begin());
+  for (size_t i = 0; i != num_new_chunks; ++i) {
+    chunks_.push_back(entries + i * chunk_entries_);
+  }
+  table_mem_maps_.push_back(std::move(new_map));
+  return true;
+}
+
 bool IndirectReferenceTable::Resize(size_t new_size, std::string* error_msg) {
   CHECK_GT(new_size, max_entries_);
 
@@ -216,26 +249,44 @@ bool IndirectReferenceTable::Resize(size_t new_size, std::string* error_msg) {
   }
   // Note: the above check also ensures that there is no overflow below.
 
-  const size_t table_bytes = new_size * sizeof(IrtEntry);
-  std::unique_ptr<MemMap> new_map(MemMap::MapAnonymous("indirect ref table",
-                                                       nullptr,
-                                                       table_bytes,
-                                                       PROT_READ | PROT_WRITE,
-                                                       false,
-                                                       false,
-                                                       error_msg));
-  if (new_map == nullptr) {
+  // The existing chunks stay where they are, so nothing needs to be copied.
+  const size_t mapped_entries = chunks_.size() << chunk_shift_;
+  if (new_size > mapped_entries && !AddChunks(new_size, error_msg)) {
     return false;
   }
-
-  memcpy(new_map->Begin(), table_mem_map_->Begin(), table_mem_map_->Size());
-  table_mem_map_ = std::move(new_map);
-  table_ = reinterpret_cast<IrtEntry*>(table_mem_map_->Begin());
-  max_entries_ = new_size;
+  // The chunk size and kMaxEntries are powers of two, so this doesn't exceed kMaxEntries.
+  max_entries_ = chunks_.size() << chunk_shift_;
 
   return true;
 }
 
+bool IndirectReferenceTable::PopFreeHole(IRTSegmentState previous_state, size_t* index) {
+  while (!free_holes_.empty()) {
+    const uint32_t hole = free_holes_.back();
+    if (hole < previous_state.top_index) {
+      // A hole of an older segment, keep it for when that segment is current again.
+      return false;
+    }
+    free_holes_.pop_back();
+    if (hole < segment_state_.top_index && GetEntry(hole)->GetReference()->IsNull()) {
+      *index = hole;
+      return true;
+    }
+    // Collapsed into the top, or reused since.
+  }
+  return false;
+}
+
+void IndirectReferenceTable::PruneFreeHoles() {
+  free_holes_.clear();
+  const size_t top_index = segment_state_.top_index;
+  for (size_t index = 0; index != top_index; ++index) {
+    if (GetEntry(index)->GetReference()->IsNull()) {
+      free_holes_.push_back(index);
+    }
+  }
+}
+
 IndirectRef IndirectReferenceTable::Add(IRTSegmentState previous_state,
                                         ObjPtr<mirror::Object> obj,
                                         std::string* error_msg) {
@@ -286,7 +337,7 @@ IndirectRef IndirectReferenceTable::Add(IRTSegmentState previous_state,
   }
 
   RecoverHoles(previous_state);
-  CheckHoleCount(table_, current_num_holes_, previous_state, segment_state_);
+  CheckHoleCount(current_num_holes_, previous_state, segment_state_);
 
   // We know there's enough room in the table.  Now we just need to find
   // the right spot.  If there's a hole, find it and fill it; otherwise,
@@ -295,22 +346,22 @@ IndirectRef IndirectReferenceTable::Add(IRTSegmentState previous_state,
   size_t index;
   if (current_num_holes_ > 0) {
     DCHECK_GT(top_index, 1U);
-    // Find the first hole; likely to be near the end of the list.
-    IrtEntry* p_scan = &table_[top_index - 1];
-    DCHECK(!p_scan->GetReference()->IsNull());
-    --p_scan;
-    while (!p_scan->GetReference()->IsNull()) {
-      DCHECK_GE(p_scan, table_ + previous_state.top_index);
-      --p_scan;
+    if (!PopFreeHole(previous_state, &index)) {
+      // Find the first hole; likely to be near the end of the list.
+      DCHECK(!GetEntry(top_index - 1)->GetReference()->IsNull());
+      index = top_index - 2;
+      while (!GetEntry(index)->GetReference()->IsNull()) {
+        DCHECK_GT(index, previous_state.top_index);
+        --index;
+      }
     }
-    index = p_scan - table_;
     current_num_holes_--;
   } else {
     // Add to the end.
     index = top_index++;
     segment_state_.top_index = top_index;
   }
-  table_[index].Add(obj);
+  GetEntry(index)->Add(obj);
   result = ToIndirectRef(index);
   if (kDebugIRT) {
     LOG(INFO) << "+++ added at " << ExtractIndex(result) << " top=" << segment_state_.top_index
@@ -323,7 +374,7 @@ IndirectRef IndirectReferenceTable::Add(IRTSegmentState previous_state,
 
 void IndirectReferenceTable::AssertEmpty() {
   for (size_t i = 0; i < Capacity(); ++i) {
-    if (!table_[i].GetReference()->IsNull()) {
+    if (!GetEntry(i)->GetReference()->IsNull()) {
       LOG(FATAL) << "Internal Error: non-empty local reference table\n"
                  << MutatorLockedDumpable<IndirectReferenceTable>(*this);
       UNREACHABLE();
@@ -382,7 +433,7 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
   }
 
   RecoverHoles(previous_state);
-  CheckHoleCount(table_, current_num_holes_, previous_state, segment_state_);
+  CheckHoleCount(current_num_holes_, previous_state, segment_state_);
 
   if (idx == top_index - 1) {
     // Top-most entry.  Scan up and consume holes.
@@ -391,7 +442,7 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
       return false;
     }
 
-    *table_[idx].GetReference() = GcRoot<mirror::Object>(nullptr);
+    *GetEntry(idx)->GetReference() = GcRoot<mirror::Object>(nullptr);
     if (current_num_holes_ != 0) {
       uint32_t collapse_top_index = top_index;
       while (--collapse_top_index > bottom_index && current_num_holes_ != 0) {
@@ -399,9 +450,10 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
           ScopedObjectAccess soa(Thread::Current());
           LOG(INFO) << "+++ checking for hole at " << collapse_top_index - 1
                     << " (previous_state=" << bottom_index << ") val="
-                    << table_[collapse_top_index - 1].GetReference()->Read<kWithoutReadBarrier>();
+                    << GetEntry(collapse_top_index - 1)->GetReference()
+                           ->Read<kWithoutReadBarrier>();
         }
-        if (!table_[collapse_top_index - 1].GetReference()->IsNull()) {
+        if (!GetEntry(collapse_top_index - 1)->GetReference()->IsNull()) {
           break;
         }
         if (kDebugIRT) {
@@ -411,7 +463,7 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
       }
       segment_state_.top_index = collapse_top_index;
 
-      CheckHoleCount(table_, current_num_holes_, previous_state, segment_state_);
+      CheckHoleCount(current_num_holes_, previous_state, segment_state_);
     } else {
       segment_state_.top_index = top_index - 1;
       if (kDebugIRT) {
@@ -421,7 +473,7 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
   } else {
     // Not the top-most entry.  This creates a hole.  We null out the entry to prevent somebody
     // from deleting it twice and screwing up the hole count.
-    if (table_[idx].GetReference()->IsNull()) {
+    if (GetEntry(idx)->GetReference()->IsNull()) {
       LOG(INFO) << "--- WEIRD: removing null entry " << idx;
       return false;
     }
@@ -429,9 +481,16 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
       return false;
     }
 
-    *table_[idx].GetReference() = GcRoot<mirror::Object>(nullptr);
+    *GetEntry(idx)->GetReference() = GcRoot<mirror::Object>(nullptr);
     current_num_holes_++;
-    CheckHoleCount(table_, current_num_holes_, previous_state, segment_state_);
+    // Stale entries pile up when holes are collapsed or segments popped. Rebuild the list when
+    // it is too long, which is rare enough to keep the cost amortized O(1).
+    if (free_holes_.size() > 2u * top_index + kFreeHolesSlack) {
+      PruneFreeHoles();
+    } else {
+      free_holes_.push_back(idx);
+    }
+    CheckHoleCount(current_num_holes_, previous_state, segment_state_);
     if (kDebugIRT) {
       LOG(INFO) << "+++ left hole at " << idx << ", holes=" << current_num_holes_;
     }
@@ -443,9 +502,19 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
 void IndirectReferenceTable::Trim() {
   ScopedTrace trace(__PRETTY_FUNCTION__);
   const size_t top_index = Capacity();
-  auto* release_start = AlignUp(reinterpret_cast<uint8_t*>(&table_[top_index]), kPageSize);
-  uint8_t* release_end = table_mem_map_->End();
-  madvise(release_start, release_end - release_start, MADV_DONTNEED);
+  for (size_t i = 0; i != chunks_.size(); ++i) {
+    const size_t chunk_begin_index = i << chunk_shift_;
+    if (top_index >= chunk_begin_index + chunk_entries_) {
+      continue;  // Full chunk.
+    }
+    IrtEntry* chunk = chunks_[i];
+    IrtEntry* unused = &chunk[std::max(top_index, chunk_begin_index) - chunk_begin_index];
+    uint8_t* release_start = AlignUp(reinterpret_cast<uint8_t*>(unused), kPageSize);
+    uint8_t* release_end = AlignDown(reinterpret_cast<uint8_t*>(&chunk[chunk_entries_]), kPageSize);
+    if (release_start < release_end) {
+      madvise(release_start, release_end - release_start, MADV_DONTNEED);
+    }
+  }
 }
 
 void IndirectReferenceTable::VisitRoots(RootVisitor* visitor, const RootInfo& root_info) {
@@ -462,9 +531,9 @@ void IndirectReferenceTable::Dump(std::ostream& os) const {
   os << kind_ << " table dump:\n";
   ReferenceTable::Table entries;
   for (size_t i = 0; i < Capacity(); ++i) {
-    ObjPtr<mirror::Object> obj = table_[i].GetReference()->Read<kWithoutReadBarrier>();
+    ObjPtr<mirror::Object> obj = GetEntry(i)->GetReference()->Read<kWithoutReadBarrier>();
     if (obj != nullptr) {
-      obj = table_[i].GetReference()->Read();
+      obj = GetEntry(i)->GetReference()->Read();
       entries.push_back(GcRoot<mirror::Object>(obj));
     }
   }
@@ -21,7 +21,9 @@
 
 #include <iosfwd>
 #include <limits>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <android-base/logging.h>
 
@@ -109,7 +111,7 @@ const char* GetIndirectRefKindString(const IndirectRefKind& kind);
 //
 // If we delete entries from the middle of the list, we will be left with "holes".  We track the
 // number of holes so that, when adding new elements, we can quickly decide to do a trivial append
-// or go slot-hunting.
+// or go slot-hunting. Holes are also pushed on a free list so that the hunt usually takes O(1).
 //
 // When the top-most entry is removed, any holes immediately below it are also removed. Thus,
 // deletion of an entry may reduce "top_index" by more than one.
@@ -134,8 +136,9 @@ const char* GetIndirectRefKindString(const IndirectRefKind& kind);
 // detect stale references aren't possible (though we may be able to get similar benefits with other
 // approaches).
 //
-// TODO: consider a "lastDeleteIndex" for quick hole-filling when an add immediately follows a
-// delete; must invalidate after segment pop might be worth only using it for JNI globals.
+// The entries are stored in fixed size, power of two chunks, so that a resizable table grows by
+// mapping more chunks instead of copying the table. Lookups in the first chunk, which is all of
+// the table unless it was resized, index it directly.
 //
 // TODO: may want completely different add/remove algorithms for global and local refs to improve
 // performance.  A large circular buffer might reduce the amortized cost of adding global
@@ -185,8 +188,9 @@ static_assert(IsPowerOfTwo(sizeof(IrtEntry)), "Unexpected sizeof(IrtEntry)");
 
 class IrtIterator {
  public:
-  IrtIterator(IrtEntry* table, size_t i, size_t capacity) REQUIRES_SHARED(Locks::mutator_lock_)
-      : table_(table), i_(i), capacity_(capacity) {
+  IrtIterator(IrtEntry* const* chunks, size_t chunk_shift, size_t i, size_t capacity)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      : chunks_(chunks), chunk_shift_(chunk_shift), i_(i), capacity_(capacity) {
     // capacity_ is used in some target; has warning with unused attribute.
     UNUSED(capacity_);
   }
@@ -198,15 +202,17 @@ class IrtIterator {
 
   GcRoot<mirror::Object>* operator*() REQUIRES_SHARED(Locks::mutator_lock_) {
     // This does not have a read barrier as this is used to visit roots.
-    return table_[i_].GetReference();
+    const size_t chunk_mask = (static_cast<size_t>(1u) << chunk_shift_) - 1u;
+    return chunks_[i_ >> chunk_shift_][i_ & chunk_mask].GetReference();
   }
 
   bool equals(const IrtIterator& rhs) const {
-    return (i_ == rhs.i_ && table_ == rhs.table_);
+    return (i_ == rhs.i_ && chunks_ == rhs.chunks_);
   }
 
  private:
-  IrtEntry* const table_;
+  IrtEntry* const* const chunks_;
+  const size_t chunk_shift_;
   size_t i_;
   const size_t capacity_;
 };
@@ -301,11 +307,11 @@ class IndirectReferenceTable {
 
   // Note IrtIterator does not have a read barrier as it's used to visit roots.
   IrtIterator begin() {
-    return IrtIterator(table_, 0, Capacity());
+    return IrtIterator(chunks_.data(), chunk_shift_, 0, Capacity());
   }
 
   IrtIterator end() {
-    return IrtIterator(table_, Capacity(), Capacity());
+    return IrtIterator(chunks_.data(), chunk_shift_, Capacity(), Capacity());
   }
 
   void VisitRoots(RootVisitor* visitor, const RootInfo& root_info)
@@ -378,13 +384,36 @@ class IndirectReferenceTable {
 
   IndirectRef ToIndirectRef(uint32_t table_index) const {
     DCHECK_LT(table_index, max_entries_);
-    uint32_t serial = table_[table_index].GetSerial();
+    uint32_t serial = GetEntry(table_index)->GetSerial();
     return reinterpret_cast<IndirectRef>(EncodeIndirectRef(table_index, serial));
   }
 
-  // Resize the backing table. Currently must be larger than the current size.
+  ALWAYS_INLINE IrtEntry* GetEntry(size_t table_index) const {
+    if (LIKELY(table_index < chunk_entries_)) {
+      return &table_[table_index];
+    }
+    return &chunks_[table_index >> chunk_shift_][table_index & (chunk_entries_ - 1u)];
+  }
+
+  // Resize the backing table by mapping more chunks. Currently must be larger than the current
+  // size.
   bool Resize(size_t new_size, std::string* error_msg);
 
+  // Map chunks for the entries from max_entries_ to at least new_size in one mem map.
+  bool AddChunks(size_t new_size, std::string* error_msg);
+
+  // Pop the last hole known in the current segment from the free list, or return false if the
+  // free list has none.
+  bool PopFreeHole(IRTSegmentState previous_state, size_t* index);
+
+  // Drop the free list entries that are no longer holes in the table.
+  void PruneFreeHoles();
+
+  size_t CountNullEntries(size_t from, size_t to) const;
+  void CheckHoleCount(size_t exp_num_holes,
+                      IRTSegmentState prev_state,
+                      IRTSegmentState cur_state) const;
+
   void RecoverHoles(IRTSegmentState from);
 
   // Abort if check_jni is not enabled. Otherwise, just log as an error.
@@ -397,11 +426,16 @@ class IndirectReferenceTable {
   /// semi-public - read/write by jni down calls.
   IRTSegmentState segment_state_;
 
-  // Mem map where we store the indirect refs.
-  std::unique_ptr<MemMap> table_mem_map_;
-  // bottom of the stack. Do not directly access the object references
-  // in this as they are roots. Use Get() that has a read barrier.
+  // Mem maps where we store the indirect refs, each holding one or more chunks.
+  std::vector<std::unique_ptr<MemMap>> table_mem_maps_;
+  // The chunks, each with chunk_entries_ entries. Do not directly access the object
+  // references in these as they are roots. Use Get() that has a read barrier.
+  std::vector<IrtEntry*> chunks_;
+  // bottom of the stack, the first chunk.
   IrtEntry* table_;
+  // The entries per chunk, a power of two, and its log2.
+  size_t chunk_entries_;
+  size_t chunk_shift_;
   // bit mask, ORed into all irefs.
   const IndirectRefKind kind_;
 
@@ -410,10 +444,13 @@ class IndirectReferenceTable {
 
   // Some values to retain old behavior with holes. Description of the algorithm is in the .cc
   // file.
-  // TODO: Consider other data structures for compact tables, e.g., free lists.
   size_t current_num_holes_;
   IRTSegmentState last_known_previous_state_;
 
+  // Indexes of the removed entries, most recent last. Entries may be stale, i.e. no longer holes,
+  // and are checked when popped.
+  std::vector<uint32_t> free_holes_;
+
   // Whether the table's capacity may be resized. As there are no locks used, it is the caller's
   // responsibility to ensure thread-safety.
   ResizableCapacity resizable_;
@@ -503,11 +503,26 @@ TEST_F(IndirectReferenceTableTest, Resize) {
   CheckDump(&irt, 0, 0);
   const IRTSegmentState cookie = kIRTFirstSegment;
 
+  std::vector<IndirectRef> irefs;
   for (size_t i = 0; i != kTableMax + 1; ++i) {
-    irt.Add(cookie, obj0.Get(), &error_msg);
+    irefs.push_back(irt.Add(cookie, obj0.Get(), &error_msg));
   }
 
   EXPECT_EQ(irt.Capacity(), kTableMax + 1);
+
+  // The entries added before the table grew are still valid.
+  for (IndirectRef iref : irefs) {
+    EXPECT_OBJ_PTR_EQ(obj0.Get(), irt.Get(iref));
+  }
+
+  // The holes are reused, the top doesn't grow.
+  ASSERT_TRUE(irt.Remove(cookie, irefs[1]));
+  ASSERT_TRUE(irt.Remove(cookie, irefs[kTableMax - 1]));
+  for (size_t i = 0; i != 2; ++i) {
+    IndirectRef iref = irt.Add(cookie, obj0.Get(), &error_msg);
+    EXPECT_OBJ_PTR_EQ(obj0.Get(), irt.Get(iref));
+  }
+  EXPECT_EQ(irt.Capacity(), kTableMax + 1);
 }
 
 }  // namespace art
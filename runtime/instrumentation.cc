@@ -975,6 +975,10 @@ void Instrumentation::UndeoptimizeEverything(const char* key) {
   ConfigureStubs(key, InstrumentationLevel::kInstrumentNothing);
 }
 
+bool Instrumentation::MethodEntryExitNeedsInterpreter() const {
+  return kDeoptimizeForAccurateMethodEntryExitListeners && !Runtime::Current()->IsJavaDebuggable();
+}
+
 void Instrumentation::EnableMethodTracing(const char* key, bool needs_interpreter) {
   InstrumentationLevel level;
   if (needs_interpreter) {
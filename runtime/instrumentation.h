@@ -54,7 +54,8 @@ enum InterpreterHandlerTable {
 
 // Do we want to deoptimize for method entry and exit listeners or just try to intercept
 // invocations? Deoptimization forces all code to run in the interpreter and considerably hurts the
-// application's performance.
+// application's performance. See Instrumentation::MethodEntryExitNeedsInterpreter() for when
+// intercepting invocations is accurate anyway.
 static constexpr bool kDeoptimizeForAccurateMethodEntryExitListeners = true;
 
 // Instrumentation event listener API. Registered listeners will get the appropriate call back for
@@ -246,6 +247,12 @@ class Instrumentation {
   bool IsDeoptimized(ArtMethod* method)
       REQUIRES(!deoptimized_methods_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Whether method entry and exit listeners need everything to run in the interpreter to get all
+  // events. The entry and exit stubs miss the calls that compiled code inlined, unless the runtime
+  // is Java debuggable: then the only compiled code in use is debuggable JIT code, which does not
+  // inline, so it can keep running with the stubs instead.
+  bool MethodEntryExitNeedsInterpreter() const;
+
   // Enable method tracing by installing instrumentation entry/exit stubs or interpreter.
   void EnableMethodTracing(const char* key,
                            bool needs_interpreter = kDeoptimizeForAccurateMethodEntryExitListeners)
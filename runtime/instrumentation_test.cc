@@ -776,6 +776,21 @@ TEST_F(InstrumentationTest, MethodTracing_InstrumentationEntryExitStubs) {
   EXPECT_FALSE(instr->AreAllMethodsDeoptimized());
 }
 
+TEST_F(InstrumentationTest, MethodEntryExitNeedsInterpreter) {
+  Runtime* const runtime = Runtime::Current();
+  instrumentation::Instrumentation* instr = runtime->GetInstrumentation();
+  bool was_java_debuggable = runtime->IsJavaDebuggable();
+
+  runtime->SetJavaDebuggable(false);
+  EXPECT_EQ(kDeoptimizeForAccurateMethodEntryExitListeners,
+            instr->MethodEntryExitNeedsInterpreter());
+  // Compiled code does not inline, the entry/exit stubs see all calls.
+  runtime->SetJavaDebuggable(true);
+  EXPECT_FALSE(instr->MethodEntryExitNeedsInterpreter());
+
+  runtime->SetJavaDebuggable(was_java_debuggable);
+}
+
 // We use a macro to print the line number where the test is failing.
 #define CHECK_INSTRUMENTATION(_level, _user_count)                                      \
   do {                                                                                  \
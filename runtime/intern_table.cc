@@ -35,24 +35,42 @@
 namespace art {
 
 InternTable::InternTable()
-    : log_new_roots_(false),
-      weak_intern_condition_("New intern condition", *Locks::intern_table_lock_),
-      weak_root_state_(gc::kWeakRootStateNormal) {
+    : weak_intern_condition_("New intern condition", *Locks::intern_table_lock_),
+      weak_root_state_(gc::kWeakRootStateNormal),
+      image_interns_(nullptr) {
+}
+
+InternTable::Shard::Shard()
+    : lock_("InternTable shard lock", kInternTableShardLock),
+      log_new_roots_(false) {
 }
 
 size_t InternTable::Size() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.Size() + weak_interns_.Size();
+  return StrongSize() + WeakSize();
 }
 
 size_t InternTable::StrongSize() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.Size();
+  Thread* const self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
+  size_t size = 0u;
+  for (const UnorderedSet& table : image_tables_) {
+    size += table.Size();
+  }
+  for (const Shard& shard : shards_) {
+    MutexLock mu2(self, shard.lock_);
+    size += shard.strong_interns_.Size();
+  }
+  return size;
 }
 
 size_t InternTable::WeakSize() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return weak_interns_.Size();
+  Thread* const self = Thread::Current();
+  size_t size = 0u;
+  for (const Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    size += shard.weak_interns_.Size();
+  }
+  return size;
 }
 
 void InternTable::DumpForSigQuit(std::ostream& os) const {
@@ -60,42 +78,88 @@ void InternTable::DumpForSigQuit(std::ostream& os) const {
 }
 
 void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  Thread* const self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
   if ((flags & kVisitRootFlagAllRoots) != 0) {
-    strong_interns_.VisitRoots(visitor);
-  } else if ((flags & kVisitRootFlagNewRoots) != 0) {
-    for (auto& root : new_strong_intern_roots_) {
-      ObjPtr<mirror::String> old_ref = root.Read<kWithoutReadBarrier>();
-      root.VisitRoot(visitor, RootInfo(kRootInternedString));
-      ObjPtr<mirror::String> new_ref = root.Read<kWithoutReadBarrier>();
-      if (new_ref != old_ref) {
-        // The GC moved a root in the log. Need to search the strong interns and update the
-        // corresponding object. This is slow, but luckily for us, this may only happen with a
-        // concurrent moving GC.
-        strong_interns_.Remove(old_ref);
-        strong_interns_.Insert(new_ref);
+    BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(
+        visitor, RootInfo(kRootInternedString));
+    for (UnorderedSet& table : image_tables_) {
+      for (auto& intern : table) {
+        buffered_visitor.VisitRoot(intern);
       }
     }
   }
-  if ((flags & kVisitRootFlagClearRootLog) != 0) {
-    new_strong_intern_roots_.clear();
+  // Each shard logs its new roots, so that a string inserted in a shard after its roots are
+  // visited is logged.
+  for (Shard& shard : shards_) {
+    MutexLock mu2(self, shard.lock_);
+    if ((flags & kVisitRootFlagAllRoots) != 0) {
+      shard.strong_interns_.VisitRoots(visitor);
+    } else if ((flags & kVisitRootFlagNewRoots) != 0) {
+      for (auto& root : shard.new_strong_intern_roots_) {
+        ObjPtr<mirror::String> old_ref = root.Read<kWithoutReadBarrier>();
+        root.VisitRoot(visitor, RootInfo(kRootInternedString));
+        ObjPtr<mirror::String> new_ref = root.Read<kWithoutReadBarrier>();
+        if (new_ref != old_ref) {
+          // The GC moved a root in the log. Need to search the strong interns and update the
+          // corresponding object. This is slow, but luckily for us, this may only happen with a
+          // concurrent moving GC.
+          shard.strong_interns_.Remove(old_ref);
+          shard.strong_interns_.Insert(new_ref);
+        }
+      }
+    }
+    if ((flags & kVisitRootFlagClearRootLog) != 0) {
+      shard.new_strong_intern_roots_.clear();
+    }
+    if ((flags & kVisitRootFlagStartLoggingNewRoots) != 0) {
+      shard.log_new_roots_ = true;
+    } else if ((flags & kVisitRootFlagStopLoggingNewRoots) != 0) {
+      shard.log_new_roots_ = false;
+    }
   }
-  if ((flags & kVisitRootFlagStartLoggingNewRoots) != 0) {
-    log_new_roots_ = true;
-  } else if ((flags & kVisitRootFlagStopLoggingNewRoots) != 0) {
-    log_new_roots_ = false;
+  // Note: we deliberately don't visit the weak_interns_ tables.
+}
+
+template <typename Key>
+inline ObjPtr<mirror::String> InternTable::LookupImageInterns(const Key& key) {
+  const ImageTables* image_tables = image_interns_.LoadAcquire();
+  if (image_tables != nullptr) {
+    for (const UnorderedSet* table : *image_tables) {
+      auto it = table->Find(key);
+      if (it != table->end()) {
+        return it->Read();
+      }
+    }
   }
-  // Note: we deliberately don't visit the weak_interns_ table and the immutable image roots.
+  return nullptr;
+}
+
+void InternTable::PublishImageTablesLocked() {
+  std::unique_ptr<ImageTables> image_tables(new ImageTables());
+  image_tables->reserve(image_tables_.size());
+  for (const UnorderedSet& table : image_tables_) {
+    image_tables->push_back(&table);
+  }
+  image_interns_.StoreRelease(image_tables.get());
+  image_interns_storage_.push_back(std::move(image_tables));
 }
 
 ObjPtr<mirror::String> InternTable::LookupWeak(Thread* self, ObjPtr<mirror::String> s) {
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return LookupWeakLocked(s);
+  Shard& shard = GetShard(s->GetHashCode());
+  MutexLock mu(self, shard.lock_);
+  return LookupWeakLocked(shard, s);
 }
 
 ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self, ObjPtr<mirror::String> s) {
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return LookupStrongLocked(s);
+  GcRoot<mirror::String> key(s);
+  ObjPtr<mirror::String> image_string = LookupImageInterns(key);
+  if (image_string != nullptr) {
+    return image_string;
+  }
+  Shard& shard = GetShard(s->GetHashCode());
+  MutexLock mu(self, shard.lock_);
+  return LookupStrongLocked(shard, s);
 }
 
 ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
@@ -105,76 +169,95 @@ ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
   Utf8String string(utf16_length,
                     utf8_data,
                     ComputeUtf16HashFromModifiedUtf8(utf8_data, utf16_length));
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return strong_interns_.Find(string);
+  ObjPtr<mirror::String> image_string = LookupImageInterns(string);
+  if (image_string != nullptr) {
+    return image_string;
+  }
+  Shard& shard = GetShard(string.GetHash());
+  MutexLock mu(self, shard.lock_);
+  return shard.strong_interns_.Find(string);
 }
 
-ObjPtr<mirror::String> InternTable::LookupWeakLocked(ObjPtr<mirror::String> s) {
-  return weak_interns_.Find(s);
+ObjPtr<mirror::String> InternTable::LookupWeakLocked(Shard& shard, ObjPtr<mirror::String> s) {
+  return shard.weak_interns_.Find(s);
 }
 
-ObjPtr<mirror::String> InternTable::LookupStrongLocked(ObjPtr<mirror::String> s) {
-  return strong_interns_.Find(s);
+ObjPtr<mirror::String> InternTable::LookupStrongLocked(Shard& shard, ObjPtr<mirror::String> s) {
+  return shard.strong_interns_.Find(s);
 }
 
 void InternTable::AddNewTable() {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  weak_interns_.AddNewTable();
-  strong_interns_.AddNewTable();
+  Thread* const self = Thread::Current();
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    shard.weak_interns_.AddNewTable();
+    shard.strong_interns_.AddNewTable();
+  }
 }
 
-ObjPtr<mirror::String> InternTable::InsertStrong(ObjPtr<mirror::String> s) {
+ObjPtr<mirror::String> InternTable::InsertStrong(Shard& shard, ObjPtr<mirror::String> s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
+    Locks::intern_table_lock_->AssertHeld(Thread::Current());
     runtime->RecordStrongStringInsertion(s);
   }
-  if (log_new_roots_) {
-    new_strong_intern_roots_.push_back(GcRoot<mirror::String>(s));
+  if (shard.log_new_roots_) {
+    shard.new_strong_intern_roots_.push_back(GcRoot<mirror::String>(s));
   }
-  strong_interns_.Insert(s);
+  shard.strong_interns_.Insert(s);
   return s;
 }
 
-ObjPtr<mirror::String> InternTable::InsertWeak(ObjPtr<mirror::String> s) {
+ObjPtr<mirror::String> InternTable::InsertWeak(Shard& shard, ObjPtr<mirror::String> s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
+    Locks::intern_table_lock_->AssertHeld(Thread::Current());
     runtime->RecordWeakStringInsertion(s);
   }
-  weak_interns_.Insert(s);
+  shard.weak_interns_.Insert(s);
   return s;
 }
 
-void InternTable::RemoveStrong(ObjPtr<mirror::String> s) {
-  strong_interns_.Remove(s);
+void InternTable::RemoveStrong(Shard& shard, ObjPtr<mirror::String> s) {
+  shard.strong_interns_.Remove(s);
 }
 
-void InternTable::RemoveWeak(ObjPtr<mirror::String> s) {
+void InternTable::RemoveWeak(Shard& shard, ObjPtr<mirror::String> s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
+    Locks::intern_table_lock_->AssertHeld(Thread::Current());
     runtime->RecordWeakStringRemoval(s);
   }
-  weak_interns_.Remove(s);
+  shard.weak_interns_.Remove(s);
 }
 
 // Insert/remove methods used to undo changes made during an aborted transaction.
 ObjPtr<mirror::String> InternTable::InsertStrongFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  return InsertStrong(s);
+  Shard& shard = GetShard(s->GetHashCode());
+  MutexLock mu(Thread::Current(), shard.lock_);
+  return InsertStrong(shard, s);
 }
 
 ObjPtr<mirror::String> InternTable::InsertWeakFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  return InsertWeak(s);
+  Shard& shard = GetShard(s->GetHashCode());
+  MutexLock mu(Thread::Current(), shard.lock_);
+  return InsertWeak(shard, s);
 }
 
 void InternTable::RemoveStrongFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  RemoveStrong(s);
+  Shard& shard = GetShard(s->GetHashCode());
+  MutexLock mu(Thread::Current(), shard.lock_);
+  RemoveStrong(shard, s);
 }
 
 void InternTable::RemoveWeakFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  RemoveWeak(s);
+  Shard& shard = GetShard(s->GetHashCode());
+  MutexLock mu(Thread::Current(), shard.lock_);
+  RemoveWeak(shard, s);
 }
 
 void InternTable::AddImagesStringsToTable(const std::vector<gc::space::ImageSpace*>& image_spaces) {
@@ -195,17 +278,29 @@ void InternTable::BroadcastForNewInterns() {
   weak_intern_condition_.Broadcast(self);
 }
 
-void InternTable::WaitUntilAccessible(Thread* self) {
-  Locks::intern_table_lock_->ExclusiveUnlock(self);
+void InternTable::WaitUntilAccessible(Thread* self) NO_THREAD_SAFETY_ANALYSIS {
+  // Transactions hold the intern table lock, which the GC needs to change the weak root state.
+  const bool holding_lock = Locks::intern_table_lock_->IsExclusiveHeld(self);
+  if (holding_lock) {
+    Locks::intern_table_lock_->ExclusiveUnlock(self);
+  }
   {
     ScopedThreadSuspension sts(self, kWaitingWeakGcRootRead);
     MutexLock mu(self, *Locks::intern_table_lock_);
-    while ((!kUseReadBarrier && weak_root_state_ == gc::kWeakRootStateNoReadsOrWrites) ||
-           (kUseReadBarrier && !self->GetWeakRefAccessEnabled())) {
+    while (!IsWeakAccessible(self)) {
       weak_intern_condition_.Wait(self);
     }
   }
-  Locks::intern_table_lock_->ExclusiveLock(self);
+  if (holding_lock) {
+    Locks::intern_table_lock_->ExclusiveLock(self);
+  }
+}
+
+bool InternTable::IsWeakAccessible(Thread* self) const {
+  // With the read barrier, the table is also accessible while the thread-local weak ref access flag
+  // is set, that is, outside of the window in which the GC sweeps the system weaks.
+  return weak_root_state_.LoadAcquire() != gc::kWeakRootStateNoReadsOrWrites ||
+      (kUseReadBarrier && self->GetWeakRefAccessEnabled());
 }
 
 ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
@@ -215,53 +310,63 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
     return nullptr;
   }
   Thread* const self = Thread::Current();
-  MutexLock mu(self, *Locks::intern_table_lock_);
   if (kDebugLocking && !holding_locks) {
     Locks::mutator_lock_->AssertSharedHeld(self);
-    CHECK_EQ(2u, self->NumberOfHeldMutexes()) << "may only safely hold the mutator lock";
+    CHECK_EQ(1u, self->NumberOfHeldMutexes()) << "may only safely hold the mutator lock";
+  }
+  // Check the interns of the images, which are strong and cannot change.
+  ObjPtr<mirror::String> image_string = LookupImageInterns(GcRoot<mirror::String>(s));
+  if (image_string != nullptr) {
+    return image_string;
+  }
+  if (UNLIKELY(Runtime::Current()->IsActiveTransaction())) {
+    // Transactions record the changes of the intern table with its lock held. They are only used
+    // by the AOT compiler.
+    MutexLock mu(self, *Locks::intern_table_lock_);
+    return InsertInShard(self, s, is_strong, holding_locks);
   }
+  return InsertInShard(self, s, is_strong, holding_locks);
+}
+
+ObjPtr<mirror::String> InternTable::InsertInShard(Thread* self,
+                                                  ObjPtr<mirror::String> s,
+                                                  bool is_strong,
+                                                  bool holding_locks) {
+  Shard& shard = GetShard(s->GetHashCode());
   while (true) {
-    if (holding_locks) {
-      if (!kUseReadBarrier) {
-        CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
-      } else {
-        CHECK(self->GetWeakRefAccessEnabled());
+    {
+      MutexLock mu(self, shard.lock_);
+      if (holding_locks) {
+        CHECK(IsWeakAccessible(self));
+      }
+      // Check the strong table for a match.
+      ObjPtr<mirror::String> strong = LookupStrongLocked(shard, s);
+      if (strong != nullptr) {
+        return strong;
+      }
+      if (IsWeakAccessible(self)) {
+        // There is no match in the strong table, check the weak table.
+        ObjPtr<mirror::String> weak = LookupWeakLocked(shard, s);
+        if (weak != nullptr) {
+          if (is_strong) {
+            // A match was found in the weak table. Promote to the strong table.
+            RemoveWeak(shard, weak);
+            return InsertStrong(shard, weak);
+          }
+          return weak;
+        }
+        // No match in the strong table or the weak table. Insert into the strong / weak table.
+        return is_strong ? InsertStrong(shard, s) : InsertWeak(shard, s);
       }
     }
-    // Check the strong table for a match.
-    ObjPtr<mirror::String> strong = LookupStrongLocked(s);
-    if (strong != nullptr) {
-      return strong;
-    }
-    if ((!kUseReadBarrier && weak_root_state_ != gc::kWeakRootStateNoReadsOrWrites) ||
-        (kUseReadBarrier && self->GetWeakRefAccessEnabled())) {
-      break;
-    }
-    // weak_root_state_ is set to gc::kWeakRootStateNoReadsOrWrites in the GC pause but is only
-    // cleared after SweepSystemWeaks has completed. This is why we need to wait until it is
-    // cleared.
+    // weak_root_state_ is set to gc::kWeakRootStateNoReadsOrWrites by the GC (in the pause, or
+    // before disabling weak ref access with the read barrier) but is only cleared once the intern
+    // table is swept. This is why we need to wait until it is cleared.
     CHECK(!holding_locks);
     StackHandleScope<1> hs(self);
     auto h = hs.NewHandleWrapper(&s);
     WaitUntilAccessible(self);
   }
-  if (!kUseReadBarrier) {
-    CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
-  } else {
-    CHECK(self->GetWeakRefAccessEnabled());
-  }
-  // There is no match in the strong table, check the weak table.
-  ObjPtr<mirror::String> weak = LookupWeakLocked(s);
-  if (weak != nullptr) {
-    if (is_strong) {
-      // A match was found in the weak table. Promote to the strong table.
-      RemoveWeak(weak);
-      return InsertStrong(weak);
-    }
-    return weak;
-  }
-  // No match in the strong table or the weak table. Insert into the strong / weak table.
-  return is_strong ? InsertStrong(s) : InsertWeak(s);
 }
 
 ObjPtr<mirror::String> InternTable::InternStrong(int32_t utf16_length, const char* utf8_data) {
@@ -299,8 +404,11 @@ bool InternTable::ContainsWeak(ObjPtr<mirror::String> s) {
 }
 
 void InternTable::SweepInternTableWeaks(IsMarkedVisitor* visitor) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  weak_interns_.SweepWeaks(visitor);
+  Thread* const self = Thread::Current();
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    shard.weak_interns_.SweepWeaks(visitor);
+  }
 }
 
 size_t InternTable::AddTableFromMemory(const uint8_t* ptr) {
@@ -309,12 +417,44 @@ size_t InternTable::AddTableFromMemory(const uint8_t* ptr) {
 }
 
 size_t InternTable::AddTableFromMemoryLocked(const uint8_t* ptr) {
-  return strong_interns_.AddTableFromMemory(ptr);
+  size_t read_count = 0;
+  UnorderedSet set(ptr, /*make copy*/false, &read_count);
+  if (set.Empty()) {
+    // Avoid inserting empty sets.
+    return read_count;
+  }
+  // TODO: Disable this for app images if app images have intern tables.
+  static constexpr bool kCheckDuplicates = kIsDebugBuild;
+  if (kCheckDuplicates) {
+    Thread* const self = Thread::Current();
+    for (GcRoot<mirror::String>& string : set) {
+      ObjPtr<mirror::String> s = string.Read();
+      Shard& shard = GetShard(s->GetHashCode());
+      MutexLock mu(self, shard.lock_);
+      CHECK(LookupImageInterns(string) == nullptr && LookupStrongLocked(shard, s) == nullptr)
+          << "Already found " << s->ToModifiedUtf8();
+    }
+  }
+  image_tables_.push_back(std::move(set));
+  PublishImageTablesLocked();
+  return read_count;
 }
 
 size_t InternTable::WriteToMemory(uint8_t* ptr) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.WriteToMemory(ptr);
+  Thread* const self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
+  // Combine the tables of the images and of the shards into a single one.
+  UnorderedSet combined;
+  for (const UnorderedSet& table : image_tables_) {
+    for (const GcRoot<mirror::String>& string : table) {
+      combined.Insert(string);
+    }
+  }
+  for (Shard& shard : shards_) {
+    MutexLock mu2(self, shard.lock_);
+    shard.strong_interns_.CopyTo(&combined);
+  }
+  return combined.WriteToMemory(ptr);
 }
 
 std::size_t InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& root) const {
@@ -363,42 +503,12 @@ bool InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& a,
   }
 }
 
-size_t InternTable::Table::AddTableFromMemory(const uint8_t* ptr) {
-  size_t read_count = 0;
-  UnorderedSet set(ptr, /*make copy*/false, &read_count);
-  if (set.Empty()) {
-    // Avoid inserting empty sets.
-    return read_count;
-  }
-  // TODO: Disable this for app images if app images have intern tables.
-  static constexpr bool kCheckDuplicates = kIsDebugBuild;
-  if (kCheckDuplicates) {
-    for (GcRoot<mirror::String>& string : set) {
-      CHECK(Find(string.Read()) == nullptr) << "Already found " << string.Read()->ToModifiedUtf8();
+void InternTable::Table::CopyTo(UnorderedSet* set) const {
+  for (const UnorderedSet& table : tables_) {
+    for (const GcRoot<mirror::String>& string : table) {
+      set->Insert(string);
     }
   }
-  // Insert at the front since we add new interns into the back.
-  tables_.insert(tables_.begin(), std::move(set));
-  return read_count;
-}
-
-size_t InternTable::Table::WriteToMemory(uint8_t* ptr) {
-  if (tables_.empty()) {
-    return 0;
-  }
-  UnorderedSet* table_to_write;
-  UnorderedSet combined;
-  if (tables_.size() > 1) {
-    table_to_write = &combined;
-    for (UnorderedSet& table : tables_) {
-      for (GcRoot<mirror::String>& string : table) {
-        combined.Insert(string);
-      }
-    }
-  } else {
-    table_to_write = &tables_.back();
-  }
-  return table_to_write->WriteToMemory(ptr);
 }
 
 void InternTable::Table::Remove(ObjPtr<mirror::String> s) {
@@ -413,7 +523,6 @@ void InternTable::Table::Remove(ObjPtr<mirror::String> s) {
 }
 
 ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
   for (UnorderedSet& table : tables_) {
     auto it = table.Find(GcRoot<mirror::String>(s));
     if (it != table.end()) {
@@ -424,7 +533,6 @@ ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s) {
 }
 
 ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
   for (UnorderedSet& table : tables_) {
     auto it = table.Find(string);
     if (it != table.end()) {
@@ -490,8 +598,7 @@ void InternTable::ChangeWeakRootState(gc::WeakRootState new_state) {
 }
 
 void InternTable::ChangeWeakRootStateLocked(gc::WeakRootState new_state) {
-  CHECK(!kUseReadBarrier);
-  weak_root_state_ = new_state;
+  weak_root_state_.StoreRelease(new_state);
   if (new_state != gc::kWeakRootStateNoReadsOrWrites) {
     weak_intern_condition_.Broadcast(Thread::Current());
   }
@@ -17,10 +17,15 @@
 #ifndef ART_RUNTIME_INTERN_TABLE_H_
 #define ART_RUNTIME_INTERN_TABLE_H_
 
+#include <array>
+#include <deque>
+#include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include "base/atomic.h"
 #include "base/allocator.h"
+#include "base/bit_utils.h"
 #include "base/hash_set.h"
 #include "base/mutex.h"
 #include "gc/weak_root_state.h"
@@ -56,6 +61,11 @@ class Transaction;
  * String.intern. Some code (XML parsers being a prime example) relies on being able to intern
  * arbitrarily many strings for the duration of a parse without permanently increasing the memory
  * footprint.
+ *
+ * The interns of the images are immutable and are looked up without locking. The other interns
+ * are partitioned by hash in shards that each have their own lock, so that threads interning
+ * different strings rarely contend. Locks::intern_table_lock_ guards the image interns, the weak
+ * root state, and changes made by transactions.
  */
 class InternTable {
  public:
@@ -145,6 +155,9 @@ class InternTable {
       REQUIRES(!Locks::intern_table_lock_);
 
  private:
+  // Number of shards, must be a power of 2.
+  static constexpr size_t kNumShards = 16u;
+
   // Modified UTF-8-encoded string treated as UTF16.
   class Utf8String {
    public:
@@ -186,69 +199,96 @@ class InternTable {
     }
   };
 
+  typedef HashSet<GcRoot<mirror::String>, GcRootEmptyFn, StringHashEquals, StringHashEquals,
+      TrackingAllocator<GcRoot<mirror::String>, kAllocatorTagInternTable>> UnorderedSet;
+
   // Table which holds pre zygote and post zygote interned strings. There is one instance for
-  // weak interns and strong interns.
+  // weak interns and strong interns in each shard, and the shard's lock guards it.
   class Table {
    public:
     Table();
-    ObjPtr<mirror::String> Find(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    ObjPtr<mirror::String> Find(const Utf8String& string) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    void Insert(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    void Remove(ObjPtr<mirror::String> s)
-        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-    void VisitRoots(RootVisitor* visitor)
-        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-    void SweepWeaks(IsMarkedVisitor* visitor)
-        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+    ObjPtr<mirror::String> Find(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_);
+    ObjPtr<mirror::String> Find(const Utf8String& string) REQUIRES_SHARED(Locks::mutator_lock_);
+    void Insert(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_);
+    void Remove(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_);
+    void VisitRoots(RootVisitor* visitor) REQUIRES_SHARED(Locks::mutator_lock_);
+    void SweepWeaks(IsMarkedVisitor* visitor) REQUIRES_SHARED(Locks::mutator_lock_);
     // Add a new intern table that will only be inserted into from now on.
-    void AddNewTable() REQUIRES(Locks::intern_table_lock_);
-    size_t Size() const REQUIRES(Locks::intern_table_lock_);
-    // Read and add an intern table from ptr.
-    // Tables read are inserted at the front of the table array. Only checks for conflicts in
-    // debug builds. Returns how many bytes were read.
-    size_t AddTableFromMemory(const uint8_t* ptr)
-        REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
-    // Write the intern tables to ptr, if there are multiple tables they are combined into a single
-    // one. Returns how many bytes were written.
-    size_t WriteToMemory(uint8_t* ptr)
-        REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+    void AddNewTable();
+    size_t Size() const;
+    // Insert all the strings of the table into `set`.
+    void CopyTo(UnorderedSet* set) const REQUIRES_SHARED(Locks::mutator_lock_);
 
    private:
-    typedef HashSet<GcRoot<mirror::String>, GcRootEmptyFn, StringHashEquals, StringHashEquals,
-        TrackingAllocator<GcRoot<mirror::String>, kAllocatorTagInternTable>> UnorderedSet;
-
     void SweepWeaks(UnorderedSet* set, IsMarkedVisitor* visitor)
-        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+        REQUIRES_SHARED(Locks::mutator_lock_);
 
     // We call AddNewTable when we create the zygote to reduce private dirty pages caused by
     // modifying the zygote intern table. The back of table is modified when strings are interned.
     std::vector<UnorderedSet> tables_;
 
-    friend class linker::OatWriter;  // for boot image string table slot address lookup.
     ART_FRIEND_TEST(InternTableTest, CrossHash);
   };
 
+  // The interns of the strings whose hash maps to the shard, see GetShard(). A string and its
+  // promotion from weak to strong are in the same shard.
+  class Shard {
+   public:
+    Shard();
+
+    mutable Mutex lock_ ACQUIRED_AFTER(Locks::intern_table_lock_);
+    // Since these contain roots, they need a read barrier. Do not directly access the strings
+    // in them. Use functions that contain read barriers.
+    Table strong_interns_ GUARDED_BY(lock_);
+    Table weak_interns_ GUARDED_BY(lock_);
+    // Strong interns added while log_new_roots_ is set, for the GC.
+    std::vector<GcRoot<mirror::String>> new_strong_intern_roots_ GUARDED_BY(lock_);
+    bool log_new_roots_ GUARDED_BY(lock_);
+
+   private:
+    DISALLOW_COPY_AND_ASSIGN(Shard);
+  };
+
+  Shard& GetShard(int32_t hash) {
+    // Use the high bits of a multiplicative hash, the sets of the shard use the low bits.
+    static_assert(IsPowerOfTwo(kNumShards), "Number of shards is not a power of 2");
+    const uint32_t mixed_hash = static_cast<uint32_t>(hash) * 0x9e3779b1u;
+    return shards_[mixed_hash >> (BitSizeOf<uint32_t>() - WhichPowerOf2(kNumShards))];
+  }
+
+  // Look up a string in the interns of the images, without locking.
+  template <typename Key>
+  ObjPtr<mirror::String> LookupImageInterns(const Key& key) REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Make the current image tables visible to LookupImageInterns().
+  void PublishImageTablesLocked() REQUIRES(Locks::intern_table_lock_);
+
   // Insert if non null, otherwise return null. Must be called holding the mutator lock.
   // If holding_locks is true, then we may also hold other locks. If holding_locks is true, then we
   // require GC is not running since it is not safe to wait while holding locks.
   ObjPtr<mirror::String> Insert(ObjPtr<mirror::String> s, bool is_strong, bool holding_locks)
       REQUIRES(!Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+  // Insert() in the shard of `s`. Transactions hold the intern table lock, see Insert().
+  ObjPtr<mirror::String> InsertInShard(Thread* self,
+                                       ObjPtr<mirror::String> s,
+                                       bool is_strong,
+                                       bool holding_locks)
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
-  ObjPtr<mirror::String> LookupStrongLocked(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  ObjPtr<mirror::String> LookupWeakLocked(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  ObjPtr<mirror::String> InsertStrong(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  ObjPtr<mirror::String> InsertWeak(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  void RemoveStrong(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  void RemoveWeak(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+  // Lookups and changes in `shard`, which must be the shard of `s`. Changes made with an active
+  // transaction require the intern table lock.
+  ObjPtr<mirror::String> LookupStrongLocked(Shard& shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(shard.lock_);
+  ObjPtr<mirror::String> LookupWeakLocked(Shard& shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(shard.lock_);
+  ObjPtr<mirror::String> InsertStrong(Shard& shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(shard.lock_);
+  ObjPtr<mirror::String> InsertWeak(Shard& shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(shard.lock_);
+  void RemoveStrong(Shard& shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(shard.lock_);
+  void RemoveWeak(Shard& shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(shard.lock_);
 
   // Transaction rollback access.
   ObjPtr<mirror::String> InsertStrongFromTransaction(ObjPtr<mirror::String> s)
@@ -267,25 +307,29 @@ class InternTable {
   void ChangeWeakRootStateLocked(gc::WeakRootState new_state)
       REQUIRES(Locks::intern_table_lock_);
 
-  // Wait until we can read weak roots.
-  void WaitUntilAccessible(Thread* self)
-      REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+  // Whether the weak interns can be read or added to. The state only becomes inaccessible while
+  // the mutator lock is not held by `self`, so the result stays valid until `self` suspends.
+  bool IsWeakAccessible(Thread* self) const;
+
+  // Wait until we can read weak roots. Must not hold a shard lock.
+  void WaitUntilAccessible(Thread* self) REQUIRES_SHARED(Locks::mutator_lock_);
 
-  bool log_new_roots_ GUARDED_BY(Locks::intern_table_lock_);
   ConditionVariable weak_intern_condition_ GUARDED_BY(Locks::intern_table_lock_);
-  // Since this contains (strong) roots, they need a read barrier to
-  // enable concurrent intern table (strong) root scan. Do not
-  // directly access the strings in it. Use functions that contain
-  // read barriers.
-  Table strong_interns_ GUARDED_BY(Locks::intern_table_lock_);
-  std::vector<GcRoot<mirror::String>> new_strong_intern_roots_
+  // Weak root state, used for concurrent system weak processing and more. Changed with the
+  // intern table lock held, for weak_intern_condition_.
+  Atomic<gc::WeakRootState> weak_root_state_;
+
+  // Strong interns read from the images. They are never modified once added, other than by the
+  // GC visiting their roots, and are searched without locking through image_interns_.
+  std::deque<UnorderedSet> image_tables_ GUARDED_BY(Locks::intern_table_lock_);
+  using ImageTables = std::vector<const UnorderedSet*>;
+  Atomic<const ImageTables*> image_interns_;
+  // Every list published to image_interns_, kept until the intern table is deleted since
+  // lookups may still be reading an older one.
+  std::vector<std::unique_ptr<const ImageTables>> image_interns_storage_
       GUARDED_BY(Locks::intern_table_lock_);
-  // Since this contains (weak) roots, they need a read barrier. Do
-  // not directly access the strings in it. Use functions that contain
-  // read barriers.
-  Table weak_interns_ GUARDED_BY(Locks::intern_table_lock_);
-  // Weak root state, used for concurrent system weak processing and more.
-  gc::WeakRootState weak_root_state_ GUARDED_BY(Locks::intern_table_lock_);
+
+  std::array<Shard, kNumShards> shards_;
 
   friend class linker::OatWriter;  // for boot image string table slot address lookup.
   friend class Transaction;
@@ -77,8 +77,9 @@ TEST_F(InternTableTest, CrossHash) {
   // A string that has a negative hash value.
   GcRoot<mirror::String> str(mirror::String::AllocFromModifiedUtf8(soa.Self(), "00000000"));
 
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  for (InternTable::Table::UnorderedSet& table : t.strong_interns_.tables_) {
+  InternTable::Shard& shard = t.GetShard(str.Read()->GetHashCode());
+  MutexLock mu(Thread::Current(), shard.lock_);
+  for (InternTable::UnorderedSet& table : shard.strong_interns_.tables_) {
     // The negative hash value shall be 32-bit wide on every host.
     ASSERT_TRUE(IsUint<32>(table.hashfn_(str)));
   }
@@ -234,4 +235,37 @@ TEST_F(InternTableTest, LookupStrong) {
   EXPECT_TRUE(lookup_foobbS == nullptr);
 }
 
+TEST_F(InternTableTest, AddTableFromMemory) {
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable t;
+  StackHandleScope<3> hs(soa.Self());
+  Handle<mirror::String> foo(hs.NewHandle(t.InternStrong(3, "foo")));
+  Handle<mirror::String> bar(hs.NewHandle(t.InternStrong(3, "bar")));
+  ASSERT_TRUE(foo != nullptr);
+  ASSERT_TRUE(bar != nullptr);
+  const size_t size = t.WriteToMemory(nullptr);
+  std::vector<uint64_t> memory(RoundUp(size, sizeof(uint64_t)) / sizeof(uint64_t));
+  uint8_t* const ptr = reinterpret_cast<uint8_t*>(memory.data());
+  ASSERT_EQ(size, t.WriteToMemory(ptr));
+
+  // The strings read from memory are found by lookups and interning, as strong interns.
+  InternTable image_intern_table;
+  EXPECT_EQ(size, image_intern_table.AddTableFromMemory(ptr));
+  EXPECT_EQ(2u, image_intern_table.StrongSize());
+  EXPECT_EQ(0u, image_intern_table.WeakSize());
+  EXPECT_OBJ_PTR_EQ(foo.Get(), image_intern_table.LookupStrong(soa.Self(), 3, "foo"));
+  EXPECT_OBJ_PTR_EQ(bar.Get(), image_intern_table.LookupStrong(soa.Self(), bar.Get()));
+  EXPECT_OBJ_PTR_EQ(foo.Get(), image_intern_table.InternStrong(3, "foo"));
+  Handle<mirror::String> other_bar(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "bar")));
+  EXPECT_OBJ_PTR_EQ(bar.Get(), image_intern_table.InternWeak(other_bar.Get()));
+  EXPECT_EQ(0u, image_intern_table.WeakSize());
+
+  // Other strings go to the writable tables.
+  ObjPtr<mirror::String> baz = image_intern_table.InternStrong(3, "baz");
+  ASSERT_TRUE(baz != nullptr);
+  EXPECT_EQ(3u, image_intern_table.StrongSize());
+  EXPECT_OBJ_PTR_EQ(baz, image_intern_table.LookupStrong(soa.Self(), 3, "baz"));
+}
+
 }  // namespace art
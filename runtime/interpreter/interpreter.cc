@@ -26,6 +26,7 @@
 #include "interpreter_switch_impl.h"
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
+#include "jit/profiling_info.h"
 #include "jvalue-inl.h"
 #include "mirror/string-inl.h"
 #include "mterp/mterp.h"
@@ -238,6 +239,17 @@ enum InterpreterImplKind {
 
 static constexpr InterpreterImplKind kInterpreterImplKind = kMterpImplKind;
 
+// Mterp does not profile conditional branches, so methods whose branches are being
+// profiled by the JIT run in the switch interpreter until they get compiled.
+static bool IsProfilingBranches(ArtMethod* method) REQUIRES_SHARED(Locks::mutator_lock_) {
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  if (jit == nullptr || !jit->ProfileBranches()) {
+    return false;
+  }
+  ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+  return info != nullptr && info->GetNumberOfBranchCaches() != 0;
+}
+
 static inline JValue Execute(
     Thread* self,
     const CodeItemDataAccessor& accessor,
@@ -311,8 +323,8 @@ static inline JValue Execute(
                                                false);
       } else {
         while (true) {
-          // Mterp does not support all instrumentation/debugging.
-          if (MterpShouldSwitchInterpreters() != 0) {
+          // Mterp does not support all instrumentation/debugging, nor branch profiling.
+          if (MterpShouldSwitchInterpreters() != 0 || IsProfilingBranches(method)) {
             return ExecuteSwitchImpl<false, false>(self, accessor, shadow_frame, result_register,
                                                    false);
           }
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
+#define ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "base/bit_utils.h"
+#include "base/macros.h"
+
+namespace art {
+
+class ArtField;
+class ArtMethod;
+class Instruction;
+
+namespace mirror {
+class Class;
+}  // namespace mirror
+
+// Small per-thread, direct-mapped cache of resolution results for the interpreter, keyed by
+// the address of the dex instruction. For an invoke, a hit maps the receiver class seen at
+// that instruction to the method it dispatched to, which lets the interpreter skip method
+// resolution and the vtable or IMT lookup on repeated invokes. For an instance field access,
+// a hit yields the resolved field, which gives the fast path quickened iget/iput instructions
+// used to provide without rewriting the dex code.
+//
+// Since the cache is thread-local, it is accessed without synchronization. Entries hold raw
+// class and method pointers, so the cache is cleared whenever the owning thread's roots are
+// visited by the GC (classes may move and be unloaded, and dex instruction memory may be
+// reused afterwards), and by anything that changes dispatch with all threads suspended,
+// e.g. class redefinition.
+class InterpreterCache {
+ public:
+  // Aim for a small cache that fits comfortably in L1, and is cheap to clear.
+  static constexpr size_t kSize = 256;
+
+  InterpreterCache() {
+    Clear();
+  }
+
+  void Clear() {
+    for (Entry& entry : data_) {
+      entry = Entry();
+    }
+  }
+
+  // Returns the cached target for `inst` if the cached receiver class is `klass`,
+  // or null otherwise.
+  ALWAYS_INLINE ArtMethod* Lookup(const Instruction* inst, mirror::Class* klass) const {
+    const Entry& entry = data_[IndexOf(inst)];
+    return (entry.inst == inst && entry.klass == klass)
+        ? reinterpret_cast<ArtMethod*>(entry.value)
+        : nullptr;
+  }
+
+  // Returns the cached field accessed by `inst`, or null if there is none.
+  ALWAYS_INLINE ArtField* LookupField(const Instruction* inst) const {
+    const Entry& entry = data_[IndexOf(inst)];
+    // Field entries have no receiver class, so invoke entries can never match here.
+    return (entry.inst == inst && entry.klass == nullptr)
+        ? reinterpret_cast<ArtField*>(entry.value)
+        : nullptr;
+  }
+
+  // Replaces whatever entry `inst` maps to.
+  ALWAYS_INLINE void Set(const Instruction* inst, mirror::Class* klass, ArtMethod* target) {
+    Entry& entry = data_[IndexOf(inst)];
+    entry.inst = inst;
+    entry.klass = klass;
+    entry.value = target;
+  }
+
+  // Replaces whatever entry `inst` maps to with the field it accesses.
+  ALWAYS_INLINE void SetField(const Instruction* inst, ArtField* field) {
+    Entry& entry = data_[IndexOf(inst)];
+    entry.inst = inst;
+    entry.klass = nullptr;
+    entry.value = field;
+  }
+
+ private:
+  struct Entry {
+    const Instruction* inst = nullptr;
+    mirror::Class* klass = nullptr;  // Receiver class of an invoke, null for a field access.
+    void* value = nullptr;  // The ArtMethod* or ArtField*.
+  };
+
+  static ALWAYS_INLINE size_t IndexOf(const Instruction* inst) {
+    static_assert(IsPowerOfTwo(kSize), "Size must be power of two");
+    // Dex instructions are 2-byte aligned, so drop the always-zero low bit.
+    return (reinterpret_cast<uintptr_t>(inst) >> 1) & (kSize - 1);
+  }
+
+  std::array<Entry, kSize> data_;
+
+  DISALLOW_COPY_AND_ASSIGN(InterpreterCache);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "interpreter_cache.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace art {
+
+// The cache only compares and returns pointers, so fake ones are good enough.
+template <typename T>
+static T* FakePointer(uintptr_t value) {
+  return reinterpret_cast<T*>(value);
+}
+
+TEST(InterpreterCache, LookupAndClear) {
+  std::unique_ptr<InterpreterCache> cache(new InterpreterCache());
+  const Instruction* inst = FakePointer<const Instruction>(0x1000);
+  mirror::Class* klass = FakePointer<mirror::Class>(0x2000);
+  mirror::Class* other_klass = FakePointer<mirror::Class>(0x3000);
+  ArtMethod* target = FakePointer<ArtMethod>(0x4000);
+
+  EXPECT_EQ(nullptr, cache->Lookup(inst, klass));
+  cache->Set(inst, klass, target);
+  EXPECT_EQ(target, cache->Lookup(inst, klass));
+  // A different receiver class or instruction misses.
+  EXPECT_EQ(nullptr, cache->Lookup(inst, other_klass));
+  EXPECT_EQ(nullptr, cache->Lookup(FakePointer<const Instruction>(0x1002), klass));
+
+  cache->Clear();
+  EXPECT_EQ(nullptr, cache->Lookup(inst, klass));
+}
+
+TEST(InterpreterCache, ConflictReplacesEntry) {
+  std::unique_ptr<InterpreterCache> cache(new InterpreterCache());
+  // Two instructions that map to the same entry.
+  const Instruction* inst1 = FakePointer<const Instruction>(0x1000);
+  const Instruction* inst2 =
+      FakePointer<const Instruction>(0x1000 + 2 * InterpreterCache::kSize);
+  mirror::Class* klass = FakePointer<mirror::Class>(0x2000);
+  ArtMethod* target1 = FakePointer<ArtMethod>(0x4000);
+  ArtMethod* target2 = FakePointer<ArtMethod>(0x5000);
+
+  cache->Set(inst1, klass, target1);
+  cache->Set(inst2, klass, target2);
+  EXPECT_EQ(nullptr, cache->Lookup(inst1, klass));
+  EXPECT_EQ(target2, cache->Lookup(inst2, klass));
+}
+
+TEST(InterpreterCache, FieldEntries) {
+  std::unique_ptr<InterpreterCache> cache(new InterpreterCache());
+  const Instruction* field_inst = FakePointer<const Instruction>(0x1000);
+  const Instruction* invoke_inst = FakePointer<const Instruction>(0x1004);
+  mirror::Class* klass = FakePointer<mirror::Class>(0x2000);
+  ArtMethod* target = FakePointer<ArtMethod>(0x4000);
+  ArtField* field = FakePointer<ArtField>(0x6000);
+
+  EXPECT_EQ(nullptr, cache->LookupField(field_inst));
+  cache->SetField(field_inst, field);
+  EXPECT_EQ(field, cache->LookupField(field_inst));
+  EXPECT_EQ(nullptr, cache->LookupField(invoke_inst));
+  // Field and invoke entries never match each other's lookups.
+  cache->Set(invoke_inst, klass, target);
+  EXPECT_EQ(nullptr, cache->LookupField(invoke_inst));
+  EXPECT_EQ(nullptr, cache->Lookup(field_inst, klass));
+
+  cache->Clear();
+  EXPECT_EQ(nullptr, cache->LookupField(field_inst));
+}
+
+}  // namespace art
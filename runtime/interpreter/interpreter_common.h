@@ -120,6 +120,35 @@ template<bool is_range, bool do_assignability_check>
 bool DoCall(ArtMethod* called_method, Thread* self, ShadowFrame& shadow_frame,
             const Instruction* inst, uint16_t inst_data, JValue* result);
 
+// Finds the method called by the given invoke instruction. Virtual and interface invokes
+// without access checks first consult the thread's interpreter cache, which maps the invoke
+// instruction and the receiver class to the previously found target, to avoid repeating
+// method resolution and the vtable or IMT lookup for monomorphic call sites.
+template<InvokeType type, bool do_access_check>
+static ALWAYS_INLINE ArtMethod* FindMethodToCall(uint32_t method_idx,
+                                                ObjPtr<mirror::Object>* receiver,
+                                                ArtMethod* referrer,
+                                                Thread* self,
+                                                const Instruction* inst)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  constexpr bool kUseCache = !do_access_check && (type == kVirtual || type == kInterface);
+  if (kUseCache && *receiver != nullptr) {
+    ArtMethod* target =
+        self->GetInterpreterCache()->Lookup(inst, (*receiver)->GetClass());
+    if (target != nullptr) {
+      return target;
+    }
+  }
+  ArtMethod* called_method =
+      FindMethodFromCode<type, do_access_check>(method_idx, receiver, referrer, self);
+  if (kUseCache && called_method != nullptr) {
+    // A successful lookup implies a non-null receiver (possibly updated by a moving GC).
+    DCHECK(*receiver != nullptr);
+    self->GetInterpreterCache()->Set(inst, (*receiver)->GetClass(), called_method);
+  }
+  return called_method;
+}
+
 // Handles streamlined non-range invoke static, direct and virtual instructions originating in
 // mterp. Access checks and instrumentation other than jit profiling are not supported, but does
 // support interpreter intrinsics if applicable.
@@ -136,8 +165,8 @@ static inline bool DoFastInvoke(Thread* self,
       ? nullptr
       : shadow_frame.GetVRegReference(vregC);
   ArtMethod* sf_method = shadow_frame.GetMethod();
-  ArtMethod* const called_method = FindMethodFromCode<type, false>(
-      method_idx, &receiver, sf_method, self);
+  ArtMethod* const called_method = FindMethodToCall<type, false>(
+      method_idx, &receiver, sf_method, self, inst);
   // The shadow frame should already be pushed, so we don't need to update it.
   if (UNLIKELY(called_method == nullptr)) {
     CHECK(self->IsExceptionPending());
@@ -179,8 +208,8 @@ static inline bool DoInvoke(Thread* self,
   ObjPtr<mirror::Object> receiver =
       (type == kStatic) ? nullptr : shadow_frame.GetVRegReference(vregC);
   ArtMethod* sf_method = shadow_frame.GetMethod();
-  ArtMethod* const called_method = FindMethodFromCode<type, do_access_check>(
-      method_idx, &receiver, sf_method, self);
+  ArtMethod* const called_method = FindMethodToCall<type, do_access_check>(
+      method_idx, &receiver, sf_method, self, inst);
   // The shadow frame should already be pushed, so we don't need to update it.
   if (UNLIKELY(called_method == nullptr)) {
     CHECK(self->IsExceptionPending());
@@ -323,6 +323,88 @@ static ALWAYS_INLINE bool MterpStringEquals(ShadowFrame* shadow_frame,
   return true;
 }
 
+// java.lang.String.hashCode()I
+static ALWAYS_INLINE bool MterpStringHashCode(ShadowFrame* shadow_frame,
+                                              const Instruction* inst,
+                                              uint16_t inst_data,
+                                              JValue* result_register)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  uint32_t arg[Instruction::kMaxVarArgRegs] = {};
+  inst->GetVarArgs(arg, inst_data);
+  mirror::String* str = shadow_frame->GetVRegReference(arg[0])->AsString();
+  // Computes and caches the hash code in the same field as String.hashCode().
+  result_register->SetI(str->GetHashCode());
+  return true;
+}
+
+// java.util.Arrays.equals([B[B)Z
+static ALWAYS_INLINE bool MterpArraysEqualsByte(ShadowFrame* shadow_frame,
+                                                const Instruction* inst,
+                                                uint16_t inst_data,
+                                                JValue* result_register)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  uint32_t arg[Instruction::kMaxVarArgRegs] = {};
+  inst->GetVarArgs(arg, inst_data);
+  mirror::Object* obj1 = shadow_frame->GetVRegReference(arg[0]);
+  mirror::Object* obj2 = shadow_frame->GetVRegReference(arg[1]);
+  bool res;
+  if (obj1 == obj2) {
+    res = true;
+  } else if (obj1 == nullptr || obj2 == nullptr) {
+    res = false;
+  } else {
+    mirror::ByteArray* array1 = obj1->AsByteArray();
+    mirror::ByteArray* array2 = obj2->AsByteArray();
+    int32_t length = array1->GetLength();
+    res = (length == array2->GetLength()) &&
+          (memcmp(array1->GetData(), array2->GetData(), length) == 0);
+  }
+  result_register->SetZ(res);
+  return true;
+}
+
+// java.util.Arrays.fill([BB)V
+static ALWAYS_INLINE bool MterpArraysFillByte(ShadowFrame* shadow_frame,
+                                              const Instruction* inst,
+                                              uint16_t inst_data,
+                                              JValue* result_register ATTRIBUTE_UNUSED)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  uint32_t arg[Instruction::kMaxVarArgRegs] = {};
+  inst->GetVarArgs(arg, inst_data);
+  mirror::Object* obj = shadow_frame->GetVRegReference(arg[0]);
+  if (obj == nullptr) {
+    return false;  // Punt and let non-intrinsic version deal with the throw.
+  }
+  mirror::ByteArray* array = obj->AsByteArray();
+  memset(array->GetData(), static_cast<int8_t>(shadow_frame->GetVReg(arg[1])), array->GetLength());
+  return true;
+}
+
+// java.util.Arrays.hashCode([B)I
+static ALWAYS_INLINE bool MterpArraysHashCodeByte(ShadowFrame* shadow_frame,
+                                                  const Instruction* inst,
+                                                  uint16_t inst_data,
+                                                  JValue* result_register)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  uint32_t arg[Instruction::kMaxVarArgRegs] = {};
+  inst->GetVarArgs(arg, inst_data);
+  mirror::Object* obj = shadow_frame->GetVRegReference(arg[0]);
+  if (obj == nullptr) {
+    result_register->SetI(0);
+    return true;
+  }
+  mirror::ByteArray* array = obj->AsByteArray();
+  const int8_t* data = array->GetData();
+  int32_t length = array->GetLength();
+  // Same as the Java code, with unsigned arithmetic for the defined wrap-around.
+  uint32_t hash = 1u;
+  for (int32_t i = 0; i < length; ++i) {
+    hash = 31u * hash + static_cast<uint32_t>(static_cast<int32_t>(data[i]));
+  }
+  result_register->SetI(static_cast<int32_t>(hash));
+  return true;
+}
+
 #define VARHANDLE_FENCE_INTRINSIC(name, std_memory_operation)              \
 static ALWAYS_INLINE bool name(ShadowFrame* shadow_frame ATTRIBUTE_UNUSED, \
                                const Instruction* inst ATTRIBUTE_UNUSED,   \
@@ -500,6 +582,9 @@ bool MterpHandleIntrinsic(ShadowFrame* shadow_frame,
     UNIMPLEMENTED_CASE(MathRoundFloat /* (F)I */)
     UNIMPLEMENTED_CASE(SystemArrayCopyChar /* ([CI[CII)V */)
     UNIMPLEMENTED_CASE(SystemArrayCopy /* (Ljava/lang/Object;ILjava/lang/Object;II)V */)
+    INTRINSIC_CASE(ArraysEqualsByte)
+    INTRINSIC_CASE(ArraysFillByte)
+    INTRINSIC_CASE(ArraysHashCodeByte)
     UNIMPLEMENTED_CASE(ThreadCurrentThread /* ()Ljava/lang/Thread; */)
     UNIMPLEMENTED_CASE(MemoryPeekByte /* (J)B */)
     UNIMPLEMENTED_CASE(MemoryPeekIntNative /* (J)I */)
@@ -514,6 +599,7 @@ bool MterpHandleIntrinsic(ShadowFrame* shadow_frame,
     INTRINSIC_CASE(StringCompareTo)
     INTRINSIC_CASE(StringEquals)
     INTRINSIC_CASE(StringGetCharsNoCheck)
+    INTRINSIC_CASE(StringHashCode)
     INTRINSIC_CASE(StringIndexOf)
     INTRINSIC_CASE(StringIndexOfAfter)
     UNIMPLEMENTED_CASE(StringStringIndexOf /* (Ljava/lang/String;)I */)
@@ -109,6 +109,13 @@ namespace interpreter {
     }                                                                                          \
   } while (false)
 
+#define BRANCH_PROFILING(taken)                                                                \
+  do {                                                                                         \
+    if (UNLIKELY(profile_branches)) {                                                          \
+      jit->ConditionalBranch(shadow_frame.GetMethod(), dex_pc, taken);                         \
+    }                                                                                          \
+  } while (false)
+
 #define HANDLE_ASYNC_EXCEPTION()                                                               \
   if (UNLIKELY(self->ObserveAsyncException())) {                                               \
     HANDLE_PENDING_EXCEPTION();                                                                \
@@ -215,6 +222,7 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
   const Instruction* inst = Instruction::At(insns + dex_pc);
   uint16_t inst_data;
   jit::Jit* jit = Runtime::Current()->GetJit();
+  const bool profile_branches = jit != nullptr && jit->ProfileBranches();
 
   do {
     dex_pc = inst->GetDexPc(insns);
@@ -891,10 +899,12 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
         if (shadow_frame.GetVReg(inst->VRegA_22t(inst_data)) ==
             shadow_frame.GetVReg(inst->VRegB_22t(inst_data))) {
           int16_t offset = inst->VRegC_22t();
+          BRANCH_PROFILING(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILING(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -905,10 +915,12 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
         if (shadow_frame.GetVReg(inst->VRegA_22t(inst_data)) !=
             shadow_frame.GetVReg(inst->VRegB_22t(inst_data))) {
           int16_t offset = inst->VRegC_22t();
+          BRANCH_PROFILING(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILING(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -919,10 +931,12 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
         if (shadow_frame.GetVReg(inst->VRegA_22t(inst_data)) <
             shadow_frame.GetVReg(inst->VRegB_22t(inst_data))) {
           int16_t offset = inst->VRegC_22t();
+          BRANCH_PROFILING(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILING(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -933,10 +947,12 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
         if (shadow_frame.GetVReg(inst->VRegA_22t(inst_data)) >=
             shadow_frame.GetVReg(inst->VRegB_22t(inst_data))) {
           int16_t offset = inst->VRegC_22t();
+          BRANCH_PROFILING(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILING(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -947,10 +963,12 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
         if (shadow_frame.GetVReg(inst->VRegA_22t(inst_data)) >
         shadow_frame.GetVReg(inst->VRegB_22t(inst_data))) {
           int16_t offset = inst->VRegC_22t();
+          BRANCH_PROFILING(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILING(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -961,10 +979,12 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
         if (shadow_frame.GetVReg(inst->VRegA_22t(inst_data)) <=
             shadow_frame.GetVReg(inst->VRegB_22t(inst_data))) {
           int16_t offset = inst->VRegC_22t();
+          BRANCH_PROFILING(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILING(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -974,10 +994,12 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t(inst_data)) == 0) {
           int16_t offset = inst->VRegB_21t();
+          BRANCH_PROFILING(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILING(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -987,10 +1009,12 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t(inst_data)) != 0) {
           int16_t offset = inst->VRegB_21t();
+          BRANCH_PROFILING(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILING(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -1000,10 +1024,12 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t(inst_data)) < 0) {
           int16_t offset = inst->VRegB_21t();
+          BRANCH_PROFILING(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILING(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -1013,10 +1039,12 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t(inst_data)) >= 0) {
           int16_t offset = inst->VRegB_21t();
+          BRANCH_PROFILING(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILING(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -1026,10 +1054,12 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t(inst_data)) > 0) {
           int16_t offset = inst->VRegB_21t();
+          BRANCH_PROFILING(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILING(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -1039,10 +1069,12 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t(inst_data)) <= 0) {
           int16_t offset = inst->VRegB_21t();
+          BRANCH_PROFILING(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILING(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -457,6 +457,7 @@ JavaVMExt::JavaVMExt(Runtime* runtime,
       check_jni_abort_hook_data_(nullptr),
       check_jni_(false),  // Initialized properly in the constructor body below.
       force_copy_(runtime_options.Exists(RuntimeArgumentMap::JniOptsForceCopy)),
+      check_jni_lite_(runtime_options.Exists(RuntimeArgumentMap::JniOptsLite)),
       tracing_enabled_(runtime_options.Exists(RuntimeArgumentMap::JniTrace)
                        || VLOG_IS_ON(third_party_jni)),
       trace_(runtime_options.GetOrDefault(RuntimeArgumentMap::JniTrace)),
@@ -709,6 +710,9 @@ void JavaVMExt::DumpForSigQuit(std::ostream& os) {
   if (force_copy_) {
     os << " (with forcecopy)";
   }
+  if (check_jni_lite_) {
+    os << " (lite)";
+  }
   Thread* self = Thread::Current();
   {
     ReaderMutexLock mu(self, *Locks::jni_globals_lock_);
@@ -729,18 +733,19 @@ void JavaVMExt::DumpForSigQuit(std::ostream& os) {
 }
 
 void JavaVMExt::DisallowNewWeakGlobals() {
-  CHECK(!kUseReadBarrier);
   Thread* const self = Thread::Current();
   MutexLock mu(self, *Locks::jni_weak_globals_lock_);
-  // DisallowNewWeakGlobals is only called by CMS during the pause. It is required to have the
-  // mutator lock exclusively held so that we don't have any threads in the middle of
-  // DecodeWeakGlobal.
-  Locks::mutator_lock_->AssertExclusiveHeld(self);
+  // Without the read barrier, DisallowNewWeakGlobals is only called by CMS during the pause. It is
+  // required to have the mutator lock exclusively held so that we don't have any threads in the
+  // middle of DecodeWeakGlobal. With the read barrier, it is called by CC before the checkpoint
+  // that disables weak ref access, and threads still check their thread-local flag until then.
+  if (!kUseReadBarrier) {
+    Locks::mutator_lock_->AssertExclusiveHeld(self);
+  }
   allow_accessing_weak_globals_.StoreSequentiallyConsistent(false);
 }
 
 void JavaVMExt::AllowNewWeakGlobals() {
-  CHECK(!kUseReadBarrier);
   Thread* self = Thread::Current();
   MutexLock mu(self, *Locks::jni_weak_globals_lock_);
   allow_accessing_weak_globals_.StoreSequentiallyConsistent(true);
@@ -768,15 +773,16 @@ inline bool JavaVMExt::MayAccessWeakGlobals(Thread* self) const {
 
 inline bool JavaVMExt::MayAccessWeakGlobalsUnlocked(Thread* self) const {
   DCHECK(self != nullptr);
-  return kUseReadBarrier ?
-      self->GetWeakRefAccessEnabled() :
+  // With the read barrier, the weak globals are also accessible once they are swept, while the
+  // thread-local weak ref access flag is still disabled.
+  return (kUseReadBarrier && self->GetWeakRefAccessEnabled()) ||
       allow_accessing_weak_globals_.LoadSequentiallyConsistent();
 }
 
 ObjPtr<mirror::Object> JavaVMExt::DecodeWeakGlobal(Thread* self, IndirectRef ref) {
   // It is safe to access GetWeakRefAccessEnabled without the lock since CC uses checkpoints to call
-  // SetWeakRefAccessEnabled, and the other collectors only modify allow_accessing_weak_globals_
-  // when the mutators are paused.
+  // SetWeakRefAccessEnabled (and clears allow_accessing_weak_globals_ before that checkpoint), and
+  // the other collectors only clear allow_accessing_weak_globals_ when the mutators are paused.
   // This only applies in the case where MayAccessWeakGlobals goes from false to true. In the other
   // case, it may be racy, this is benign since DecodeWeakGlobalLocked does the correct behavior
   // if MayAccessWeakGlobals is false.
@@ -58,6 +58,11 @@ class JavaVMExt : public JavaVM {
     return force_copy_;
   }
 
+  // Whether CheckJNI only does the checks that take constant time, see -Xjniopts:lite.
+  bool IsCheckJniLite() const {
+    return check_jni_lite_;
+  }
+
   bool IsCheckJniEnabled() const {
     return check_jni_;
   }
@@ -226,6 +231,7 @@ class JavaVMExt : public JavaVM {
   // Extra checking.
   bool check_jni_;
   const bool force_copy_;
+  const bool check_jni_lite_;
   const bool tracing_enabled_;
 
   // Extra diagnostics.
@@ -106,7 +106,14 @@ JDWP::ObjectId ObjectRegistry::InternalAdd(Handle<T> obj_h) {
     entry->reference_count = 0;
     entry->id = 0;
     entry->identity_hash_code = identity_hash_code;
-    object_to_entry_.insert(std::make_pair(identity_hash_code, entry));
+    entry->next_with_same_hash = nullptr;
+    auto hash_it = object_to_entry_.Find(identity_hash_code);
+    if (hash_it == object_to_entry_.end()) {
+      object_to_entry_.Insert(std::make_pair(identity_hash_code, entry));
+    } else {
+      entry->next_with_same_hash = hash_it->second;
+      hash_it->second = entry;
+    }
 
     // This object isn't in the registry yet, so add it.
     JNIEnv* env = soa.Env();
@@ -118,7 +125,7 @@ JDWP::ObjectId ObjectRegistry::InternalAdd(Handle<T> obj_h) {
     entry->reference_count = 1;
     entry->id = next_id_++;
 
-    id_to_entry_.Put(entry->id, entry);
+    id_to_entry_.Insert(std::make_pair(entry->id, entry));
 
     env->DeleteLocalRef(local_reference);
   }
@@ -130,9 +137,12 @@ bool ObjectRegistry::ContainsLocked(Thread* self,
                                     int32_t identity_hash_code,
                                     ObjectRegistryEntry** out_entry) {
   DCHECK(o != nullptr);
-  for (auto it = object_to_entry_.lower_bound(identity_hash_code), end = object_to_entry_.end();
-       it != end && it->first == identity_hash_code; ++it) {
-    ObjectRegistryEntry* entry = it->second;
+  auto it = object_to_entry_.Find(identity_hash_code);
+  if (it == object_to_entry_.end()) {
+    return false;
+  }
+  for (ObjectRegistryEntry* entry = it->second; entry != nullptr;
+       entry = entry->next_with_same_hash) {
     if (o == self->DecodeJObject(entry->jni_reference)) {
       if (out_entry != nullptr) {
         *out_entry = entry;
@@ -143,6 +153,25 @@ bool ObjectRegistry::ContainsLocked(Thread* self,
   return false;
 }
 
+void ObjectRegistry::RemoveFromObjectToEntryLocked(ObjectRegistryEntry* entry) {
+  auto it = object_to_entry_.Find(entry->identity_hash_code);
+  CHECK(it != object_to_entry_.end());
+  if (it->second == entry) {
+    if (entry->next_with_same_hash == nullptr) {
+      object_to_entry_.Erase(it);
+    } else {
+      it->second = entry->next_with_same_hash;
+    }
+    return;
+  }
+  ObjectRegistryEntry* previous = it->second;
+  while (previous->next_with_same_hash != entry) {
+    previous = previous->next_with_same_hash;
+    CHECK(previous != nullptr);
+  }
+  previous->next_with_same_hash = entry->next_with_same_hash;
+}
+
 void ObjectRegistry::Clear() {
   Thread* const self = Thread::Current();
 
@@ -159,10 +188,10 @@ void ObjectRegistry::Clear() {
   Locks::mutator_lock_->AssertNotExclusiveHeld(self);
 
   MutexLock mu(self, lock_);
-  VLOG(jdwp) << "Object registry contained " << object_to_entry_.size() << " entries";
+  VLOG(jdwp) << "Object registry contained " << id_to_entry_.Size() << " entries";
   // Delete all the JNI references.
   JNIEnv* env = self->GetJniEnv();
-  for (const auto& pair : object_to_entry_) {
+  for (const auto& pair : id_to_entry_) {
     const ObjectRegistryEntry* entry = pair.second;
     if (entry->jni_reference_type == JNIWeakGlobalRefType) {
       env->DeleteWeakGlobalRef(entry->jni_reference);
@@ -172,14 +201,14 @@ void ObjectRegistry::Clear() {
     delete entry;
   }
   // Clear the maps.
-  object_to_entry_.clear();
-  id_to_entry_.clear();
+  object_to_entry_.Clear();
+  id_to_entry_.Clear();
 }
 
 mirror::Object* ObjectRegistry::InternalGet(JDWP::ObjectId id, JDWP::JdwpError* error) {
   Thread* self = Thread::Current();
   MutexLock mu(self, lock_);
-  auto it = id_to_entry_.find(id);
+  auto it = id_to_entry_.Find(id);
   if (it == id_to_entry_.end()) {
     *error = JDWP::ERR_INVALID_OBJECT;
     return nullptr;
@@ -195,7 +224,7 @@ jobject ObjectRegistry::GetJObject(JDWP::ObjectId id) {
   }
   Thread* self = Thread::Current();
   MutexLock mu(self, lock_);
-  auto it = id_to_entry_.find(id);
+  auto it = id_to_entry_.Find(id);
   CHECK(it != id_to_entry_.end()) << id;
   ObjectRegistryEntry& entry = *it->second;
   return entry.jni_reference;
@@ -204,7 +233,7 @@ jobject ObjectRegistry::GetJObject(JDWP::ObjectId id) {
 void ObjectRegistry::DisableCollection(JDWP::ObjectId id) {
   Thread* self = Thread::Current();
   MutexLock mu(self, lock_);
-  auto it = id_to_entry_.find(id);
+  auto it = id_to_entry_.Find(id);
   CHECK(it != id_to_entry_.end());
   Promote(*it->second);
 }
@@ -212,7 +241,7 @@ void ObjectRegistry::DisableCollection(JDWP::ObjectId id) {
 void ObjectRegistry::EnableCollection(JDWP::ObjectId id) {
   Thread* self = Thread::Current();
   MutexLock mu(self, lock_);
-  auto it = id_to_entry_.find(id);
+  auto it = id_to_entry_.Find(id);
   CHECK(it != id_to_entry_.end());
   Demote(*it->second);
 }
@@ -242,7 +271,7 @@ void ObjectRegistry::Promote(ObjectRegistryEntry& entry) {
 bool ObjectRegistry::IsCollected(JDWP::ObjectId id) {
   Thread* self = Thread::Current();
   MutexLock mu(self, lock_);
-  auto it = id_to_entry_.find(id);
+  auto it = id_to_entry_.Find(id);
   CHECK(it != id_to_entry_.end());
   ObjectRegistryEntry& entry = *it->second;
   if (entry.jni_reference_type == JNIWeakGlobalRefType) {
@@ -256,7 +285,7 @@ bool ObjectRegistry::IsCollected(JDWP::ObjectId id) {
 void ObjectRegistry::DisposeObject(JDWP::ObjectId id, uint32_t reference_count) {
   Thread* self = Thread::Current();
   MutexLock mu(self, lock_);
-  auto it = id_to_entry_.find(id);
+  auto it = id_to_entry_.Find(id);
   if (it == id_to_entry_.end()) {
     return;
   }
@@ -266,20 +295,13 @@ void ObjectRegistry::DisposeObject(JDWP::ObjectId id, uint32_t reference_count)
     JNIEnv* env = self->GetJniEnv();
     // Erase the object from the maps. Note object may be null if it's
     // a weak ref and the GC has cleared it.
-    int32_t hash_code = entry->identity_hash_code;
-    for (auto inner_it = object_to_entry_.lower_bound(hash_code), end = object_to_entry_.end();
-         inner_it != end && inner_it->first == hash_code; ++inner_it) {
-      if (entry == inner_it->second) {
-        object_to_entry_.erase(inner_it);
-        break;
-      }
-    }
+    RemoveFromObjectToEntryLocked(entry);
     if (entry->jni_reference_type == JNIWeakGlobalRefType) {
       env->DeleteWeakGlobalRef(entry->jni_reference);
     } else {
       env->DeleteGlobalRef(entry->jni_reference);
     }
-    id_to_entry_.erase(id);
+    id_to_entry_.Erase(it);
     delete entry;
   }
 }
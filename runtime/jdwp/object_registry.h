@@ -20,10 +20,10 @@
 #include <jni.h>
 #include <stdint.h>
 
-#include <map>
+#include <utility>
 
 #include "base/casts.h"
-#include "base/safe_map.h"
+#include "base/hash_map.h"
 #include "handle.h"
 #include "jdwp/jdwp.h"
 #include "obj_ptr.h"
@@ -51,6 +51,9 @@ struct ObjectRegistryEntry {
   // The identity hash code of the object. This is the same as the key
   // for object_to_entry_. Store this for DisposeObject().
   int32_t identity_hash_code;
+
+  // The next entry with the same identity hash code, see object_to_entry_.
+  ObjectRegistryEntry* next_with_same_hash;
 };
 std::ostream& operator<<(std::ostream& os, const ObjectRegistryEntry& rhs);
 
@@ -129,9 +132,27 @@ class ObjectRegistry {
                       ObjectRegistryEntry** out_entry)
       REQUIRES(lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
+  void RemoveFromObjectToEntryLocked(ObjectRegistryEntry* entry) REQUIRES(lock_);
+
+  // Empty slots of the maps have a zero key: ids and identity hash codes are never zero.
+  template <typename Key>
+  struct EmptyFn {
+    void MakeEmpty(std::pair<Key, ObjectRegistryEntry*>& item) const {
+      item.first = 0;
+      item.second = nullptr;
+    }
+    bool IsEmpty(const std::pair<Key, ObjectRegistryEntry*>& item) const {
+      return item.first == 0;
+    }
+  };
+
   Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
-  std::multimap<int32_t, ObjectRegistryEntry*> object_to_entry_ GUARDED_BY(lock_);
-  SafeMap<JDWP::ObjectId, ObjectRegistryEntry*> id_to_entry_ GUARDED_BY(lock_);
+  // Maps identity hash codes to the last added of the entries with that hash code, the others
+  // are chained through ObjectRegistryEntry::next_with_same_hash.
+  GroupHashMap<int32_t, ObjectRegistryEntry*, EmptyFn<int32_t>> object_to_entry_
+      GUARDED_BY(lock_);
+  GroupHashMap<JDWP::ObjectId, ObjectRegistryEntry*, EmptyFn<JDWP::ObjectId>> id_to_entry_
+      GUARDED_BY(lock_);
 
   size_t next_id_ GUARDED_BY(lock_);
 };
@@ -26,6 +26,7 @@
 
 #include <atomic>
 #include <unordered_map>
+#include <unordered_set>
 #include <cstddef>
 
 //
@@ -251,6 +252,9 @@ void RemoveNativeDebugInfoForDex(Thread* current_thread, ArrayRef<const uint8_t>
   }
 }
 
+// Number of packable entries which are merged together into a single packed entry.
+static constexpr size_t kJitDebugInfoPackSize = 64;
+
 static size_t __jit_debug_mem_usage
     GUARDED_BY(Locks::native_debug_interface_lock_) = 0;
 
@@ -258,7 +262,18 @@ static size_t __jit_debug_mem_usage
 static std::unordered_map<const void*, JITCodeEntry*> __jit_debug_entries
     GUARDED_BY(Locks::native_debug_interface_lock_);
 
-void AddNativeDebugInfoForJit(const void* handle, const std::vector<uint8_t>& symfile) {
+// Handles of the entries that are still waiting to be packed.
+static std::unordered_set<const void*> __jit_debug_unpacked_handles
+    GUARDED_BY(Locks::native_debug_interface_lock_);
+
+// Number of live handles described by each packed entry. A packed entry is freed together
+// with its last method. Until then it keeps describing the freed methods as well, but any
+// code later allocated at their addresses gets a newer entry, which native tools prefer.
+static std::unordered_map<JITCodeEntry*, size_t> __jit_debug_packed_entries
+    GUARDED_BY(Locks::native_debug_interface_lock_);
+
+static JITCodeEntry* CreateJITCodeEntryForJit(const std::vector<uint8_t>& symfile)
+    REQUIRES(Locks::native_debug_interface_lock_) {
   DCHECK_NE(symfile.size(), 0u);
 
   // Make a copy of the buffer to shrink it and to pass ownership to JITCodeEntry.
@@ -271,12 +286,66 @@ void AddNativeDebugInfoForJit(const void* handle, const std::vector<uint8_t>& sy
       __jit_debug_register_code_ptr,
       ArrayRef<const uint8_t>(copy, symfile.size()));
   __jit_debug_mem_usage += sizeof(JITCodeEntry) + entry->symfile_size_;
+  return entry;
+}
+
+static void DeleteJITCodeEntryForJit(JITCodeEntry* entry)
+    REQUIRES(Locks::native_debug_interface_lock_) {
+  const uint8_t* symfile_addr = entry->symfile_addr_;
+  uint64_t symfile_size = entry->symfile_size_;
+  DeleteJITCodeEntryInternal(__jit_debug_descriptor,
+                             __jit_debug_register_code_ptr,
+                             entry);
+  __jit_debug_mem_usage -= sizeof(JITCodeEntry) + symfile_size;
+  delete[] symfile_addr;
+}
+
+// Replace the unpacked entries by a single entry with merged and compressed debug info.
+static void PackJitDebugInfo(PackElfFileForJITFunction* pack,
+                             InstructionSet isa,
+                             const InstructionSetFeatures* features)
+    REQUIRES(Locks::native_debug_interface_lock_) {
+  std::vector<ArrayRef<const uint8_t>> elf_files;
+  elf_files.reserve(__jit_debug_unpacked_handles.size());
+  for (const void* handle : __jit_debug_unpacked_handles) {
+    const JITCodeEntry* entry = __jit_debug_entries.find(handle)->second;
+    elf_files.emplace_back(entry->symfile_addr_, entry->symfile_size_);
+  }
+  std::vector<uint8_t> packed =
+      pack(isa, features, ArrayRef<const ArrayRef<const uint8_t>>(elf_files));
+  if (packed.empty()) {
+    return;
+  }
+  // Register the packed entry first so that the methods are described at all times.
+  JITCodeEntry* packed_entry = CreateJITCodeEntryForJit(packed);
+  for (const void* handle : __jit_debug_unpacked_handles) {
+    auto it = __jit_debug_entries.find(handle);
+    DeleteJITCodeEntryForJit(it->second);
+    it->second = packed_entry;
+  }
+  __jit_debug_packed_entries.emplace(packed_entry, __jit_debug_unpacked_handles.size());
+  __jit_debug_unpacked_handles.clear();
+}
+
+void AddNativeDebugInfoForJit(const void* handle,
+                              const std::vector<uint8_t>& symfile,
+                              PackElfFileForJITFunction* pack,
+                              InstructionSet isa,
+                              const InstructionSetFeatures* features) {
+  JITCodeEntry* entry = CreateJITCodeEntryForJit(symfile);
 
   // We don't provide handle for type debug info, which means we cannot free it later.
   // (this only happens when --generate-debug-info flag is enabled for the purpose
   // of being debugged with gdb; it does not happen for debuggable apps by default).
   bool ok = handle == nullptr || __jit_debug_entries.emplace(handle, entry).second;
   DCHECK(ok) << "Native debug entry already exists for " << std::hex << handle;
+
+  if (pack != nullptr && handle != nullptr) {
+    __jit_debug_unpacked_handles.insert(handle);
+    if (__jit_debug_unpacked_handles.size() >= kJitDebugInfoPackSize) {
+      PackJitDebugInfo(pack, isa, features);
+    }
+  }
 }
 
 void RemoveNativeDebugInfoForJit(const void* handle) {
@@ -285,19 +354,22 @@ void RemoveNativeDebugInfoForJit(const void* handle) {
   // but we try to remove it unconditionally whenever code is freed from JIT cache.
   if (it != __jit_debug_entries.end()) {
     JITCodeEntry* entry = it->second;
-    const uint8_t* symfile_addr = entry->symfile_addr_;
-    uint64_t symfile_size = entry->symfile_size_;
-    DeleteJITCodeEntryInternal(__jit_debug_descriptor,
-                               __jit_debug_register_code_ptr,
-                               entry);
     __jit_debug_entries.erase(it);
-    __jit_debug_mem_usage -= sizeof(JITCodeEntry) + symfile_size;
-    delete[] symfile_addr;
+    auto packed_it = __jit_debug_packed_entries.find(entry);
+    if (packed_it == __jit_debug_packed_entries.end()) {
+      __jit_debug_unpacked_handles.erase(handle);
+      DeleteJITCodeEntryForJit(entry);
+    } else if (--packed_it->second == 0u) {
+      __jit_debug_packed_entries.erase(packed_it);
+      DeleteJITCodeEntryForJit(entry);
+    }
   }
 }
 
 size_t GetJitNativeDebugInfoMemUsage() {
-  return __jit_debug_mem_usage + __jit_debug_entries.size() * 2 * sizeof(void*);
+  return __jit_debug_mem_usage +
+      (__jit_debug_entries.size() + __jit_debug_unpacked_handles.size()) * 2 * sizeof(void*) +
+      __jit_debug_packed_entries.size() * 3 * sizeof(void*);
 }
 
 }  // namespace art
@@ -21,11 +21,20 @@
 #include <memory>
 #include <vector>
 
+#include "arch/instruction_set.h"
 #include "base/array_ref.h"
 #include "base/mutex.h"
 
 namespace art {
 
+class InstructionSetFeatures;
+
+// Merges in-memory ELF files describing single JIT methods into one ELF file.
+typedef std::vector<uint8_t> PackElfFileForJITFunction(
+    InstructionSet isa,
+    const InstructionSetFeatures* features,
+    ArrayRef<const ArrayRef<const uint8_t>> elf_files);
+
 // Notify native tools (e.g. libunwind) that DEX file has been opened.
 // It takes the lock itself. The parameter must point to dex data (not the DexFile* object).
 void AddNativeDebugInfoForDex(Thread* current_thread, ArrayRef<const uint8_t> dexfile);
@@ -37,7 +46,13 @@ void RemoveNativeDebugInfoForDex(Thread* current_thread, ArrayRef<const uint8_t>
 // Notify native tools about new JITed code by passing in-memory ELF.
 // The handle is the object that is being described (needed to be able to remove the entry).
 // The method will make copy of the passed ELF file (to shrink it to the minimum size).
-void AddNativeDebugInfoForJit(const void* handle, const std::vector<uint8_t>& symfile)
+// If a pack function is given, the entry is registered right away but it is later merged
+// with other recently added entries into a single entry with compressed debug info.
+void AddNativeDebugInfoForJit(const void* handle,
+                              const std::vector<uint8_t>& symfile,
+                              PackElfFileForJITFunction* pack = nullptr,
+                              InstructionSet isa = InstructionSet::kNone,
+                              const InstructionSetFeatures* features = nullptr)
     REQUIRES(Locks::native_debug_interface_lock_);
 
 // Notify native debugger that JITed code has been removed and free the debug info.
@@ -17,24 +17,34 @@
 #include "jit.h"
 
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sstream>
 
 #include "art_method-inl.h"
+#include "base/casts.h"
 #include "base/enums.h"
 #include "base/logging.h"  // For VLOG.
 #include "base/memory_tool.h"
 #include "base/runtime_debug.h"
+#include "base/time_utils.h"
 #include "base/utils.h"
 #include "debugger.h"
 #include "entrypoints/runtime_asm_entrypoints.h"
 #include "interpreter/interpreter.h"
 #include "java_vm_ext.h"
 #include "jit_code_cache.h"
+#include "jit_warm_start.h"
 #include "oat_file_manager.h"
 #include "oat_quick_method_header.h"
 #include "profile_compilation_info.h"
 #include "profile_saver.h"
 #include "runtime.h"
+#include "runtime_callbacks.h"
+#include "runtime_metrics.h"
 #include "runtime_options.h"
+#include "scoped_thread_state_change-inl.h"
 #include "stack.h"
 #include "stack_map.h"
 #include "thread-inl.h"
@@ -47,6 +57,8 @@ static constexpr bool kEnableOnStackReplacement = true;
 // At what priority to schedule jit threads. 9 is the lowest foreground priority on device.
 static constexpr int kJitPoolThreadPthreadPriority = 9;
 
+static ThreadPool* CreateJitThreadPool(size_t num_threads);
+
 // Different compilation threshold constants. These can be overridden on the command line.
 static constexpr size_t kJitDefaultCompileThreshold           = 10000;  // Non-debug default.
 static constexpr size_t kJitStressDefaultCompileThreshold     = 100;    // Fast-debug build.
@@ -57,8 +69,9 @@ void* Jit::jit_library_handle_ = nullptr;
 void* Jit::jit_compiler_handle_ = nullptr;
 void* (*Jit::jit_load_)(bool*) = nullptr;
 void (*Jit::jit_unload_)(void*) = nullptr;
-bool (*Jit::jit_compile_method_)(void*, ArtMethod*, Thread*, bool) = nullptr;
+bool (*Jit::jit_compile_method_)(void*, ArtMethod*, Thread*, bool, bool) = nullptr;
 void (*Jit::jit_types_loaded_)(void*, mirror::Class**, size_t count) = nullptr;
+void (*Jit::jit_dump_stats_)(void*, std::ostream*) = nullptr;
 bool Jit::generate_debug_info_ = false;
 
 struct StressModeHelper {
@@ -69,6 +82,19 @@ DEFINE_RUNTIME_DEBUG_FLAG(StressModeHelper, kSlowMode);
 JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& options) {
   auto* jit_options = new JitOptions;
   jit_options->use_jit_compilation_ = options.GetOrDefault(RuntimeArgumentMap::UseJitCompilation);
+  jit_options->use_baseline_compilation_ =
+      options.GetOrDefault(RuntimeArgumentMap::JITBaselineCompilation);
+  jit_options->baseline_only_ = options.GetOrDefault(RuntimeArgumentMap::JITBaselineOnly);
+  if (jit_options->baseline_only_) {
+    // Baseline code is the final tier, so methods need to be compiled to it in the first place.
+    jit_options->use_baseline_compilation_ = true;
+  }
+  jit_options->use_warm_start_ = options.GetOrDefault(RuntimeArgumentMap::JITWarmStart);
+  jit_options->profile_branches_ =
+      options.GetOrDefault(RuntimeArgumentMap::JITProfileBranches);
+  jit_options->perf_map_ = options.GetOrDefault(RuntimeArgumentMap::JITPerfMap);
+  jit_options->jit_dump_ = options.GetOrDefault(RuntimeArgumentMap::JITDump);
+  jit_options->event_log_ = options.GetOrDefault(RuntimeArgumentMap::JITEventLog);
 
   jit_options->code_cache_initial_capacity_ =
       options.GetOrDefault(RuntimeArgumentMap::JITCodeCacheInitialCapacity);
@@ -142,6 +168,11 @@ JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& opt
         static_cast<size_t>(1));
   }
 
+  jit_options->thread_pool_size_ = options.GetOrDefault(RuntimeArgumentMap::JITThreadPoolSize);
+  if (jit_options->thread_pool_size_ == 0) {
+    LOG(FATAL) << "JIT thread pool size cannot be 0.";
+  }
+
   return jit_options;
 }
 
@@ -152,8 +183,17 @@ bool Jit::ShouldUsePriorityThreadWeight(Thread* self) {
 void Jit::DumpInfo(std::ostream& os) {
   code_cache_->Dump(os);
   cumulative_timings_.Dump(os);
-  MutexLock mu(Thread::Current(), lock_);
-  memory_use_.PrintMemoryUse(os);
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    memory_use_.PrintMemoryUse(os);
+  }
+  DumpCompilerStats(os);
+}
+
+void Jit::DumpCompilerStats(std::ostream& os) {
+  if (jit_compiler_handle_ != nullptr) {
+    jit_dump_stats_(jit_compiler_handle_, &os);
+  }
 }
 
 void Jit::DumpForSigQuit(std::ostream& os) {
@@ -170,11 +210,17 @@ Jit::Jit() : dump_info_on_shutdown_(false),
              memory_use_("Memory used for compilation", 16),
              lock_("JIT memory use lock"),
              use_jit_compilation_(true),
+             use_baseline_compilation_(false),
+             baseline_only_(false),
+             use_warm_start_(false),
+             profile_branches_(false),
              hot_method_threshold_(0),
              warm_method_threshold_(0),
              osr_method_threshold_(0),
              priority_thread_weight_(0),
-             invoke_transition_weight_(0) {}
+             invoke_transition_weight_(0),
+             thread_pool_size_(0),
+             event_log_fd_(-1) {}
 
 Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
   DCHECK(options->UseJitCompilation() || options->GetProfileSaverOptions().IsEnabled());
@@ -194,11 +240,17 @@ Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
     return nullptr;
   }
   jit->use_jit_compilation_ = options->UseJitCompilation();
+  jit->use_baseline_compilation_ = options->UseBaselineCompilation();
+  jit->baseline_only_ = options->IsBaselineOnly();
+  jit->use_warm_start_ = options->UseWarmStart();
+  jit->profile_branches_ = options->ProfileBranches();
   jit->profile_saver_options_ = options->GetProfileSaverOptions();
   VLOG(jit) << "JIT created with initial_capacity="
       << PrettySize(options->GetCodeCacheInitialCapacity())
       << ", max_capacity=" << PrettySize(options->GetCodeCacheMaxCapacity())
       << ", compile_threshold=" << options->GetCompileThreshold()
+      << ", baseline=" << std::boolalpha << options->UseBaselineCompilation()
+      << ", baseline_only=" << options->IsBaselineOnly() << std::noboolalpha
       << ", profile_saver_options=" << options->GetProfileSaverOptions();
 
 
@@ -207,6 +259,14 @@ Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
   jit->osr_method_threshold_ = options->GetOsrThreshold();
   jit->priority_thread_weight_ = options->GetPriorityThreadWeight();
   jit->invoke_transition_weight_ = options->GetInvokeTransitionWeight();
+  jit->thread_pool_size_ = options->GetThreadPoolSize();
+  if (!options->GetEventLog().empty()) {
+    const char* event_log = options->GetEventLog().c_str();
+    jit->event_log_fd_ = open(event_log, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (jit->event_log_fd_ == -1) {
+      PLOG(WARNING) << "Could not open the JIT event log " << event_log;
+    }
+  }
 
   jit->CreateThreadPool();
 
@@ -237,7 +297,7 @@ bool Jit::LoadCompilerLibrary(std::string* error_msg) {
     *error_msg = "JIT couldn't find jit_unload entry point";
     return false;
   }
-  jit_compile_method_ = reinterpret_cast<bool (*)(void*, ArtMethod*, Thread*, bool)>(
+  jit_compile_method_ = reinterpret_cast<bool (*)(void*, ArtMethod*, Thread*, bool, bool)>(
       dlsym(jit_library_handle_, "jit_compile_method"));
   if (jit_compile_method_ == nullptr) {
     dlclose(jit_library_handle_);
@@ -251,6 +311,13 @@ bool Jit::LoadCompilerLibrary(std::string* error_msg) {
     *error_msg = "JIT couldn't find jit_types_loaded entry point";
     return false;
   }
+  jit_dump_stats_ = reinterpret_cast<void (*)(void*, std::ostream*)>(
+      dlsym(jit_library_handle_, "jit_dump_stats"));
+  if (jit_dump_stats_ == nullptr) {
+    dlclose(jit_library_handle_);
+    *error_msg = "JIT couldn't find jit_dump_stats entry point";
+    return false;
+  }
   return true;
 }
 
@@ -271,7 +338,7 @@ bool Jit::LoadCompiler(std::string* error_msg) {
   return true;
 }
 
-bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
+bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool baseline, bool osr) {
   DCHECK(Runtime::Current()->UseJitCompilation());
   DCHECK(!method->IsRuntimeMethod());
 
@@ -294,19 +361,33 @@ bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
   // If we get a request to compile a proxy method, we pass the actual Java method
   // of that proxy method, as the compiler does not expect a proxy method.
   ArtMethod* method_to_compile = method->GetInterfaceMethodIfProxy(kRuntimePointerSize);
-  if (!code_cache_->NotifyCompilationOf(method_to_compile, self, osr)) {
+  DCHECK(!baseline || !osr);
+  if (!code_cache_->NotifyCompilationOf(method_to_compile, self, baseline, osr)) {
     return false;
   }
 
   VLOG(jit) << "Compiling method "
             << ArtMethod::PrettyMethod(method_to_compile)
-            << " osr=" << std::boolalpha << osr;
-  bool success = jit_compile_method_(jit_compiler_handle_, method_to_compile, self, osr);
+            << " baseline=" << std::boolalpha << baseline
+            << " osr=" << osr;
+  uint64_t start_ns = NanoTime();
+  bool success = jit_compile_method_(jit_compiler_handle_, method_to_compile, self, baseline, osr);
+  if (event_log_fd_ != -1) {
+    LogCompilation(method_to_compile, baseline, osr, success, start_ns, NanoTime());
+  }
+  if (success && !osr) {
+    code_cache_->SetBaselineCompiled(method_to_compile, baseline);
+    if (baseline) {
+      // Baseline code counts its own hotness, start over to find out when it gets hot.
+      method_to_compile->SetCounter(0);
+    }
+  }
   code_cache_->DoneCompiling(method_to_compile, self, osr);
   if (!success) {
     VLOG(jit) << "Failed to compile method "
               << ArtMethod::PrettyMethod(method_to_compile)
-              << " osr=" << std::boolalpha << osr;
+              << " baseline=" << std::boolalpha << baseline
+              << " osr=" << osr;
   }
   if (kIsDebugBuild) {
     if (self->IsExceptionPending()) {
@@ -320,13 +401,42 @@ bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
   return success;
 }
 
+void Jit::LogCompilation(ArtMethod* method,
+                         bool baseline,
+                         bool osr,
+                         bool success,
+                         uint64_t start_ns,
+                         uint64_t end_ns) {
+  size_t code_size = 0u;
+  if (success) {
+    const OatQuickMethodHeader* header = nullptr;
+    if (osr) {
+      header = code_cache_->LookupOsrMethodHeader(method);
+    } else {
+      const void* entry_point = method->GetEntryPointFromQuickCompiledCode();
+      if (code_cache_->ContainsPc(entry_point)) {
+        header = OatQuickMethodHeader::FromEntryPoint(entry_point);
+      }
+    }
+    if (header != nullptr) {
+      code_size = header->GetCodeSize();
+    }
+  }
+  std::ostringstream oss;
+  oss << start_ns << " " << (end_ns - start_ns) << " "
+      << (osr ? "osr" : (baseline ? "baseline" : "optimized")) << " "
+      << code_size << " " << method->PrettyMethod() << "\n";
+  std::string line = oss.str();
+  if (TEMP_FAILURE_RETRY(write(event_log_fd_, line.data(), line.size())) !=
+      static_cast<ssize_t>(line.size())) {
+    PLOG(WARNING) << "Could not write to the JIT event log";
+  }
+}
+
 void Jit::CreateThreadPool() {
   // There is a DCHECK in the 'AddSamples' method to ensure the tread pool
   // is not null when we instrument.
-
-  // We need peers as we may report the JIT thread, e.g., in the debugger.
-  constexpr bool kJitPoolNeedsPeers = true;
-  thread_pool_.reset(new ThreadPool("Jit thread pool", 1, kJitPoolNeedsPeers));
+  thread_pool_.reset(CreateJitThreadPool(thread_pool_size_));
 
   thread_pool_->SetPthreadPriority(kJitPoolThreadPthreadPriority);
   Start();
@@ -358,6 +468,8 @@ void Jit::DeleteThreadPool() {
 
 void Jit::StartProfileSaver(const std::string& filename,
                             const std::vector<std::string>& code_paths) {
+  // Read the profile of the previous runs before the saver starts updating it.
+  StartWarmStart(filename);
   if (profile_saver_options_.IsEnabled()) {
     ProfileSaver::Start(profile_saver_options_,
                         filename,
@@ -370,6 +482,42 @@ void Jit::StopProfileSaver() {
   if (profile_saver_options_.IsEnabled() && ProfileSaver::IsStarted()) {
     ProfileSaver::Stop(dump_info_on_shutdown_);
   }
+  StopWarmStart();
+}
+
+void Jit::StartWarmStart(const std::string& filename) {
+  if (!use_warm_start_ || !use_jit_compilation_ || JitAtFirstUse() || warm_start_ != nullptr) {
+    return;
+  }
+  std::unique_ptr<ProfileCompilationInfo> profile = JitWarmStart::LoadProfile(filename);
+  if (profile == nullptr) {
+    return;
+  }
+  // Seed the counters just below the compilation threshold: the next sample compiles the method.
+  warm_start_.reset(new JitWarmStart(std::move(profile), hot_method_threshold_ - 1));
+  Thread* self = Thread::Current();
+  {
+    ScopedThreadStateChange tsc(self, kSuspended);
+    ScopedSuspendAll ssa(__FUNCTION__);
+    Runtime::Current()->GetRuntimeCallbacks()->AddClassLoadCallback(warm_start_.get());
+  }
+  // Classes linked from now on are seeded by the callback, take care of the ones before.
+  ScopedObjectAccess soa(self);
+  warm_start_->SeedLoadedClasses();
+}
+
+void Jit::StopWarmStart() {
+  if (warm_start_ == nullptr) {
+    return;
+  }
+  Thread* self = Thread::Current();
+  {
+    ScopedThreadStateChange tsc(self, kSuspended);
+    ScopedSuspendAll ssa(__FUNCTION__);
+    Runtime::Current()->GetRuntimeCallbacks()->RemoveClassLoadCallback(warm_start_.get());
+  }
+  VLOG(jit) << "JIT warm start seeded " << warm_start_->GetNumberOfSeededMethods() << " methods";
+  warm_start_.reset();
 }
 
 bool Jit::JitAtFirstUse() {
@@ -382,11 +530,15 @@ bool Jit::CanInvokeCompiledCode(ArtMethod* method) {
 
 Jit::~Jit() {
   DCHECK(!profile_saver_options_.IsEnabled() || !ProfileSaver::IsStarted());
+  DCHECK(warm_start_ == nullptr);
   if (dump_info_on_shutdown_) {
     DumpInfo(LOG_STREAM(INFO));
     Runtime::Current()->DumpDeoptimizations(LOG_STREAM(INFO));
   }
   DeleteThreadPool();
+  if (event_log_fd_ != -1) {
+    close(event_log_fd_);
+  }
   if (jit_compiler_handle_ != nullptr) {
     jit_unload_(jit_compiler_handle_);
     jit_compiler_handle_ = nullptr;
@@ -598,6 +750,7 @@ class JitCompileTask FINAL : public Task {
   enum TaskKind {
     kAllocateProfile,
     kCompile,
+    kCompileBaseline,
     kCompileOsr
   };
 
@@ -606,19 +759,24 @@ class JitCompileTask FINAL : public Task {
     // Add a global ref to the class to prevent class unloading until compilation is done.
     klass_ = soa.Vm()->AddGlobalRef(soa.Self(), method_->GetDeclaringClass());
     CHECK(klass_ != nullptr);
+    RuntimeMetrics::RecordJitTaskAdded();
   }
 
   ~JitCompileTask() {
     ScopedObjectAccess soa(Thread::Current());
     soa.Vm()->DeleteGlobalRef(soa.Self(), klass_);
+    RuntimeMetrics::RecordJitTaskDone();
   }
 
   void Run(Thread* self) OVERRIDE {
     ScopedObjectAccess soa(self);
+    Jit* jit = Runtime::Current()->GetJit();
     if (kind_ == kCompile) {
-      Runtime::Current()->GetJit()->CompileMethod(method_, self, /* osr */ false);
+      jit->CompileMethod(method_, self, /* baseline */ false, /* osr */ false);
+    } else if (kind_ == kCompileBaseline) {
+      jit->CompileMethod(method_, self, /* baseline */ true, /* osr */ false);
     } else if (kind_ == kCompileOsr) {
-      Runtime::Current()->GetJit()->CompileMethod(method_, self, /* osr */ true);
+      jit->CompileMethod(method_, self, /* baseline */ false, /* osr */ true);
     } else {
       DCHECK(kind_ == kAllocateProfile);
       if (ProfilingInfo::Create(self, method_, /* retry_allocation */ true)) {
@@ -626,12 +784,41 @@ class JitCompileTask FINAL : public Task {
       }
     }
     ProfileSaver::NotifyJitActivity();
+    if (jit->UseBaselineCompilation() && !jit->IsBaselineOnly()) {
+      jit->OptimizeHotBaselineMethods(self);
+    }
   }
 
   void Finalize() OVERRIDE {
     delete this;
   }
 
+  ArtMethod* GetMethod() const {
+    return method_;
+  }
+
+  TaskKind GetKind() const {
+    return kind_;
+  }
+
+  // Tasks with a higher priority run first. Profiling info allocations are cheap and
+  // unblock compilations, and OSR compilations are requested by methods stuck in the
+  // interpreter. Other compilations are ordered by the current hotness of their method.
+  uint32_t GetPriority() const {
+    switch (kind_) {
+      case kAllocateProfile:
+        return std::numeric_limits<uint32_t>::max();
+      case kCompileOsr:
+        return std::numeric_limits<uint32_t>::max() - 1u;
+      case kCompile:
+      case kCompileBaseline:
+        // The declaring class is kept alive by `klass_`, no need for the mutator lock.
+        return method_->GetCounter();
+    }
+    LOG(FATAL) << "Unreachable";
+    UNREACHABLE();
+  }
+
  private:
   ArtMethod* const method_;
   const TaskKind kind_;
@@ -640,6 +827,65 @@ class JitCompileTask FINAL : public Task {
   DISALLOW_IMPLICIT_CONSTRUCTORS(JitCompileTask);
 };
 
+// Thread pool of the JIT, running the highest priority task first rather than the oldest.
+class JitThreadPool FINAL : public ThreadPool {
+ public:
+  // We need peers as we may report the JIT threads, e.g., in the debugger.
+  explicit JitThreadPool(size_t num_threads)
+      : ThreadPool("Jit thread pool", num_threads, /* create_peers */ true) {}
+
+  // Queue a task of `kind` for `method`, unless such a task is already queued. A task that
+  // is already running is not detected, JitCodeCache::NotifyCompilationOf() filters it.
+  void AddCompileTask(Thread* self, ArtMethod* method, JitCompileTask::TaskKind kind)
+      REQUIRES(!task_queue_lock_) {
+    {
+      MutexLock mu(self, task_queue_lock_);
+      for (Task* task : tasks_) {
+        JitCompileTask* compile_task = down_cast<JitCompileTask*>(task);
+        if (compile_task->GetMethod() == method && compile_task->GetKind() == kind) {
+          return;
+        }
+      }
+    }
+    // Create the task without holding the queue lock, as it creates a global reference.
+    AddTask(self, new JitCompileTask(method, kind));
+  }
+
+ protected:
+  Task* TryGetTaskLocked() OVERRIDE REQUIRES(task_queue_lock_) {
+    if (!HasOutstandingTasks()) {
+      return nullptr;
+    }
+    // The queue only holds the methods waiting for a JIT thread, a linear search is fine.
+    auto best = tasks_.begin();
+    uint32_t best_priority = down_cast<JitCompileTask*>(*best)->GetPriority();
+    for (auto it = best + 1; it != tasks_.end(); ++it) {
+      uint32_t priority = down_cast<JitCompileTask*>(*it)->GetPriority();
+      if (priority > best_priority) {
+        best = it;
+        best_priority = priority;
+      }
+    }
+    Task* task = *best;
+    tasks_.erase(best);
+    return task;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(JitThreadPool);
+};
+
+static ThreadPool* CreateJitThreadPool(size_t num_threads) {
+  return new JitThreadPool(num_threads);
+}
+
+static void QueueCompileTask(ThreadPool* thread_pool,
+                             Thread* self,
+                             ArtMethod* method,
+                             JitCompileTask::TaskKind kind) {
+  down_cast<JitThreadPool*>(thread_pool)->AddCompileTask(self, method, kind);
+}
+
 void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_backedges) {
   if (thread_pool_ == nullptr) {
     // Should only see this when shutting down.
@@ -663,12 +909,26 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
   DCHECK_LE(priority_thread_weight_, hot_method_threshold_);
 
   int32_t starting_count = method->GetCounter();
+  if (UNLIKELY(method->IsNative()) && starting_count == 0 && use_jit_compilation_) {
+    // JNI stubs are shared by all native methods with the same shorty and access flags.
+    // On the first call, pick up the stub another method already got compiled, rather than
+    // going through the generic JNI trampoline until this method gets hot, too.
+    if (code_cache_->UseCompiledJniStub(method)) {
+      VLOG(jit) << "Reusing compiled JNI stub for " << method->PrettyMethod();
+    }
+  }
   if (Jit::ShouldUsePriorityThreadWeight(self)) {
     count *= priority_thread_weight_;
   }
   int32_t new_count = starting_count + count;   // int32 here to avoid wrap-around;
   // Note: Native method have no "warm" state or profiling info.
   if (LIKELY(!method->IsNative()) && starting_count < warm_method_threshold_) {
+    if (starting_count == 0) {
+      ProfileSaver::NotifyMethodSampled(self, method, /* warm */ false);
+    }
+    if (new_count >= warm_method_threshold_) {
+      ProfileSaver::NotifyMethodSampled(self, method, /* warm */ true);
+    }
     if ((new_count >= warm_method_threshold_) &&
         (method->GetProfilingInfo(kRuntimePointerSize) == nullptr)) {
       bool success = ProfilingInfo::Create(self, method, /* retry_allocation */ false);
@@ -686,7 +946,7 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
       if (!success) {
         // We failed allocating. Instead of doing the collection on the Java thread, we push
         // an allocation to a compiler thread, that will do the collection.
-        thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kAllocateProfile));
+        QueueCompileTask(thread_pool_.get(), self, method, JitCompileTask::kAllocateProfile);
       }
     }
     // Avoid jumping more than one state at a time.
@@ -695,20 +955,42 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
     if (starting_count < hot_method_threshold_) {
       if ((new_count >= hot_method_threshold_) &&
           !code_cache_->ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+        if (!method->IsNative() && method->GetProfilingInfo(kRuntimePointerSize) == nullptr) {
+          // The method skipped the warm state, for instance because a warm start seeded its
+          // counter. The compiler still needs a ProfilingInfo.
+          bool success = ProfilingInfo::Create(self, method, /* retry_allocation */ false);
+          if (thread_pool_ == nullptr) {
+            DCHECK(Runtime::Current()->IsShuttingDown(self));
+            return;
+          }
+          if (!success) {
+            QueueCompileTask(thread_pool_.get(), self, method, JitCompileTask::kAllocateProfile);
+            return;
+          }
+        }
         DCHECK(thread_pool_ != nullptr);
-        thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kCompile));
+        JitCompileTask::TaskKind kind = (use_baseline_compilation_ && !method->IsNative())
+            ? JitCompileTask::kCompileBaseline
+            : JitCompileTask::kCompile;
+        QueueCompileTask(thread_pool_.get(), self, method, kind);
       }
       // Avoid jumping more than one state at a time.
       new_count = std::min(new_count, osr_method_threshold_ - 1);
     } else if (starting_count < osr_method_threshold_) {
-      if (!with_backedges) {
+      if (!with_backedges || baseline_only_) {
+        // Baseline-only mode does not compile OSR code, loops can only enter the baseline
+        // code of the method.
         // If the samples don't contain any back edge, we don't increment the hotness.
         return;
       }
       DCHECK(!method->IsNative());  // No back edges reported for native methods.
-      if ((new_count >= osr_method_threshold_) &&  !code_cache_->IsOsrCompiled(method)) {
+      // Baseline code can be entered from the interpreter directly, no need for an OSR
+      // compilation until it gets replaced by optimized code.
+      if ((new_count >= osr_method_threshold_) &&
+          !code_cache_->IsOsrCompiled(method) &&
+          !code_cache_->IsBaselineCompiled(method)) {
         DCHECK(thread_pool_ != nullptr);
-        thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kCompileOsr));
+        QueueCompileTask(thread_pool_.get(), self, method, JitCompileTask::kCompileOsr);
       }
     }
   }
@@ -716,6 +998,30 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
   method->SetCounter(new_count);
 }
 
+void Jit::MaybeOptimizeBaselineMethod(Thread* self, ArtMethod* method) {
+  if (!use_baseline_compilation_ || baseline_only_ || thread_pool_ == nullptr) {
+    return;
+  }
+  // Check the counter first, the code cache lookup takes a lock.
+  if (method->GetCounter() >= hot_method_threshold_ &&
+      code_cache_->ScheduleOptimizedCompilation(method)) {
+    QueueCompileTask(thread_pool_.get(), self, method, JitCompileTask::kCompile);
+  }
+}
+
+void Jit::OptimizeHotBaselineMethods(Thread* self) {
+  if (thread_pool_ == nullptr) {
+    // Should only see this when shutting down.
+    return;
+  }
+  std::vector<ArtMethod*> methods;
+  code_cache_->GetHotBaselineMethods(hot_method_threshold_, &methods);
+  for (ArtMethod* method : methods) {
+    VLOG(jit) << "Optimizing hot baseline method " << method->PrettyMethod();
+    QueueCompileTask(thread_pool_.get(), self, method, JitCompileTask::kCompile);
+  }
+}
+
 void Jit::MethodEntered(Thread* thread, ArtMethod* method) {
   Runtime* runtime = Runtime::Current();
   if (UNLIKELY(runtime->UseJitCompilation() && runtime->GetJit()->JitAtFirstUse())) {
@@ -751,6 +1057,14 @@ void Jit::InvokeVirtualOrInterface(ObjPtr<mirror::Object> this_object,
   }
 }
 
+void Jit::ConditionalBranch(ArtMethod* method, uint32_t dex_pc, bool taken) {
+  ScopedAssertNoThreadSuspension ants(__FUNCTION__);
+  ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+  if (info != nullptr) {
+    info->AddBranchInfo(dex_pc, taken);
+  }
+}
+
 void Jit::WaitForCompilationToFinish(Thread* self) {
   if (thread_pool_ != nullptr) {
     thread_pool_->Wait(self, false, false);
@@ -41,6 +41,7 @@ namespace jit {
 
 class JitCodeCache;
 class JitOptions;
+class JitWarmStart;
 
 static constexpr int16_t kJitCheckForOSR = -1;
 static constexpr int16_t kJitHotnessDisabled = -2;
@@ -54,7 +55,9 @@ class Jit {
 
   virtual ~Jit();
   static Jit* Create(JitOptions* options, std::string* error_msg);
-  bool CompileMethod(ArtMethod* method, Thread* self, bool osr)
+  // Compile `method`. Baseline compilation favors compile time over code quality, the
+  // baseline code is recompiled with all optimizations once it gets hot.
+  bool CompileMethod(ArtMethod* method, Thread* self, bool baseline, bool osr)
       REQUIRES_SHARED(Locks::mutator_lock_);
   void CreateThreadPool();
 
@@ -70,6 +73,9 @@ class Jit {
   // Dump interesting info: #methods compiled, code vs data size, compile / verify cumulative
   // loggers.
   void DumpInfo(std::ostream& os) REQUIRES(!lock_);
+  // Dump the per-pass and per-method statistics of the JIT compiler, which are only
+  // collected with `-Xcompiler-option --dump-stats`.
+  void DumpCompilerStats(std::ostream& os);
   // Add a timing logger to cumulative_timings_.
   void AddTimingLogger(const TimingLogger& logger);
 
@@ -98,6 +104,26 @@ class Jit {
     return use_jit_compilation_;
   }
 
+  // Returns whether hot methods are first compiled to baseline code.
+  bool UseBaselineCompilation() const {
+    return use_baseline_compilation_;
+  }
+
+  // Returns whether baseline code is the final tier: baseline methods are never
+  // recompiled with all optimizations, and no OSR code is compiled.
+  bool IsBaselineOnly() const {
+    return baseline_only_;
+  }
+  bool UseWarmStart() const {
+    return use_warm_start_;
+  }
+
+  // Returns whether warm methods record the taken and not-taken counts of their
+  // conditional branches.
+  bool ProfileBranches() const {
+    return profile_branches_;
+  }
+
   bool GetSaveProfilingInfo() const {
     return profile_saver_options_.IsEnabled();
   }
@@ -112,12 +138,24 @@ class Jit {
   void AddSamples(Thread* self, ArtMethod* method, uint16_t samples, bool with_backedges)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Schedule an optimized compilation of `method` if it runs baseline code that got hot.
+  // Called when compiled code reaches a suspend check, which samples the running methods.
+  void MaybeOptimizeBaselineMethod(Thread* self, ArtMethod* method)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Schedule optimized compilations of all the baseline methods that got hot.
+  void OptimizeHotBaselineMethods(Thread* self)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   void InvokeVirtualOrInterface(ObjPtr<mirror::Object> this_object,
                                 ArtMethod* caller,
                                 uint32_t dex_pc,
                                 ArtMethod* callee)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  void ConditionalBranch(ArtMethod* method, uint32_t dex_pc, bool taken)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   void NotifyInterpreterToCompiledCodeTransition(Thread* self, ArtMethod* caller)
       REQUIRES_SHARED(Locks::mutator_lock_) {
     AddSamples(self, caller, invoke_transition_weight_, false);
@@ -131,6 +169,8 @@ class Jit {
   // Starts the profile saver if the config options allow profile recording.
   // The profile will be stored in the specified `filename` and will contain
   // information collected from the given `code_paths` (a set of dex locations).
+  // With -Xjitwarmstart, the methods already recorded as hot in `filename` are
+  // compiled as soon as they run.
   void StartProfileSaver(const std::string& filename,
                          const std::vector<std::string>& code_paths);
   void StopProfileSaver();
@@ -181,13 +221,29 @@ class Jit {
 
   static bool LoadCompiler(std::string* error_msg);
 
+  void StartWarmStart(const std::string& filename) REQUIRES(!Locks::mutator_lock_);
+  void StopWarmStart() REQUIRES(!Locks::mutator_lock_);
+
+  // Append a line for a finished compilation to the -Xjiteventlog file:
+  //   <start ns> <duration ns> <baseline|optimized|osr> <code size> <method>
+  // The start is a CLOCK_MONOTONIC time, like System.nanoTime(). The code size is 0 if the
+  // compilation failed, or if the code is not installed yet because its class is initializing.
+  void LogCompilation(ArtMethod* method,
+                      bool baseline,
+                      bool osr,
+                      bool success,
+                      uint64_t start_ns,
+                      uint64_t end_ns)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // JIT compiler
   static void* jit_library_handle_;
   static void* jit_compiler_handle_;
   static void* (*jit_load_)(bool*);
   static void (*jit_unload_)(void*);
-  static bool (*jit_compile_method_)(void*, ArtMethod*, Thread*, bool);
+  static bool (*jit_compile_method_)(void*, ArtMethod*, Thread*, bool, bool);
   static void (*jit_types_loaded_)(void*, mirror::Class**, size_t count);
+  static void (*jit_dump_stats_)(void*, std::ostream*);
 
   // Performance monitoring.
   bool dump_info_on_shutdown_;
@@ -198,6 +254,10 @@ class Jit {
   std::unique_ptr<jit::JitCodeCache> code_cache_;
 
   bool use_jit_compilation_;
+  bool use_baseline_compilation_;
+  bool baseline_only_;
+  bool use_warm_start_;
+  bool profile_branches_;
   ProfileSaverOptions profile_saver_options_;
   static bool generate_debug_info_;
   uint16_t hot_method_threshold_;
@@ -205,7 +265,12 @@ class Jit {
   uint16_t osr_method_threshold_;
   uint16_t priority_thread_weight_;
   uint16_t invoke_transition_weight_;
+  size_t thread_pool_size_;
   std::unique_ptr<ThreadPool> thread_pool_;
+  std::unique_ptr<JitWarmStart> warm_start_;
+  // The -Xjiteventlog file, or -1. Lines are written with single appending writes, so that the
+  // JIT threads need no lock.
+  int event_log_fd_;
 
   DISALLOW_COPY_AND_ASSIGN(Jit);
 };
@@ -228,6 +293,9 @@ class JitOptions {
   size_t GetInvokeTransitionWeight() const {
     return invoke_transition_weight_;
   }
+  size_t GetThreadPoolSize() const {
+    return thread_pool_size_;
+  }
   size_t GetCodeCacheInitialCapacity() const {
     return code_cache_initial_capacity_;
   }
@@ -249,6 +317,30 @@ class JitOptions {
   void SetUseJitCompilation(bool b) {
     use_jit_compilation_ = b;
   }
+  bool UseBaselineCompilation() const {
+    return use_baseline_compilation_;
+  }
+  bool IsBaselineOnly() const {
+    return baseline_only_;
+  }
+  bool UseWarmStart() const {
+    return use_warm_start_;
+  }
+  bool ProfileBranches() const {
+    return profile_branches_;
+  }
+  // Whether to record JIT code in a perf-PID.map file, without generating debug info.
+  bool WritePerfMap() const {
+    return perf_map_;
+  }
+  // Whether to record JIT code in a jit-PID.dump file for `perf inject --jit`.
+  bool WriteJitDump() const {
+    return jit_dump_;
+  }
+  // Where to log the compilations, see Jit::LogCompilation(). Empty if they are not logged.
+  const std::string& GetEventLog() const {
+    return event_log_;
+  }
   void SetSaveProfilingInfo(bool save_profiling_info) {
     profile_saver_options_.SetEnabled(save_profiling_info);
   }
@@ -266,6 +358,13 @@ class JitOptions {
 
  private:
   bool use_jit_compilation_;
+  bool use_baseline_compilation_;
+  bool baseline_only_;
+  bool use_warm_start_;
+  bool profile_branches_;
+  bool perf_map_;
+  bool jit_dump_;
+  std::string event_log_;
   size_t code_cache_initial_capacity_;
   size_t code_cache_max_capacity_;
   size_t compile_threshold_;
@@ -273,11 +372,18 @@ class JitOptions {
   size_t osr_threshold_;
   uint16_t priority_thread_weight_;
   size_t invoke_transition_weight_;
+  size_t thread_pool_size_;
   bool dump_info_on_shutdown_;
   ProfileSaverOptions profile_saver_options_;
 
   JitOptions()
       : use_jit_compilation_(false),
+        use_baseline_compilation_(false),
+        baseline_only_(false),
+        use_warm_start_(false),
+        profile_branches_(false),
+        perf_map_(false),
+        jit_dump_(false),
         code_cache_initial_capacity_(0),
         code_cache_max_capacity_(0),
         compile_threshold_(0),
@@ -285,6 +391,7 @@ class JitOptions {
         osr_threshold_(0),
         priority_thread_weight_(0),
         invoke_transition_weight_(0),
+        thread_pool_size_(0),
         dump_info_on_shutdown_(false) {}
 
   DISALLOW_COPY_AND_ASSIGN(JitOptions);
@@ -16,9 +16,15 @@
 
 #include "jit_code_cache.h"
 
+#include <sched.h>
+
+#include <algorithm>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 #include "arch/context.h"
+#include "art_field-inl.h"
 #include "art_method-inl.h"
 #include "base/enums.h"
 #include "base/logging.h"  // For VLOG.
@@ -157,6 +163,68 @@ class JitCodeCache::JniStubData {
   std::vector<ArtMethod*> methods_;
 };
 
+class JitCodeCache::CodeIndex {
+ public:
+  typedef std::pair<const void*, ArtMethod*> Entry;
+
+  explicit CodeIndex(const SafeMap<const void*, ArtMethod*>& method_code_map)
+      : entries_(method_code_map.begin(), method_code_map.end()) {}
+
+  // Return the entry with the highest code pointer below `pc`, null if there is none.
+  const Entry* Find(const void* pc) const {
+    auto it = std::lower_bound(entries_.begin(),
+                               entries_.end(),
+                               pc,
+                               [](const Entry& entry, const void* value) {
+                                 return entry.first < value;
+                               });
+    return (it != entries_.begin()) ? &*(--it) : nullptr;
+  }
+
+  bool ContainsMethod(ArtMethod* method) const {
+    for (const Entry& entry : entries_) {
+      if (entry.second == method) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  // Sorted by code pointer, as in method_code_map_.
+  const std::vector<Entry> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(CodeIndex);
+};
+
+// Read-side critical section for JitCodeCache::code_index_. The section must not block,
+// as PublishCodeIndex() spins with the lock_ held until the readers of the old index leave.
+class JitCodeCache::ScopedCodeIndexReader {
+ public:
+  explicit ScopedCodeIndexReader(JitCodeCache* code_cache)
+      : code_cache_(code_cache),
+        epoch_(code_cache->code_index_epoch_.LoadSequentiallyConsistent() & 1u) {
+    code_cache_->code_index_readers_[epoch_].FetchAndAddSequentiallyConsistent(1u);
+    index_ = code_cache_->code_index_.LoadSequentiallyConsistent();
+  }
+
+  ~ScopedCodeIndexReader() {
+    code_cache_->code_index_readers_[epoch_].FetchAndSubSequentiallyConsistent(1u);
+  }
+
+  // Null until the first method is committed.
+  const CodeIndex* Get() const {
+    return index_;
+  }
+
+ private:
+  JitCodeCache* const code_cache_;
+  const uint32_t epoch_;
+  const CodeIndex* index_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedCodeIndexReader);
+};
+
 JitCodeCache* JitCodeCache::Create(size_t initial_capacity,
                                    size_t max_capacity,
                                    bool generate_debug_info,
@@ -274,6 +342,12 @@ JitCodeCache::JitCodeCache(MemMap* code_map,
       number_of_compilations_(0),
       number_of_osr_compilations_(0),
       number_of_collections_(0),
+      number_of_deoptimizations_(0),
+      number_of_disabled_speculations_(0),
+      number_of_evicted_methods_(0),
+      evicted_code_size_(0),
+      number_of_resident_methods_(0),
+      resident_code_size_(0),
       histogram_stack_map_memory_use_("Memory used for stack maps", 16),
       histogram_code_memory_use_("Memory used for compiled code", 16),
       histogram_profiling_info_memory_use_("Memory used for profiling info", 16),
@@ -308,29 +382,43 @@ JitCodeCache::JitCodeCache(MemMap* code_map,
             << PrettySize(initial_code_capacity);
 }
 
-JitCodeCache::~JitCodeCache() {}
+JitCodeCache::~JitCodeCache() {
+  delete code_index_.LoadRelaxed();
+}
+
+void JitCodeCache::PublishCodeIndex() {
+  const CodeIndex* old_index = code_index_.LoadRelaxed();
+  code_index_.StoreSequentiallyConsistent(new CodeIndex(method_code_map_));
+  if (old_index == nullptr) {
+    return;
+  }
+  // Readers that register after an epoch flip observe the new index, as they load the
+  // index after the store above. A reader may have read the epoch before the previous
+  // publication's second flip, so drain both slots in turn, as userspace RCU does.
+  // Writers are serialized by lock_.
+  for (size_t phase = 0; phase != 2u; ++phase) {
+    uint32_t old_epoch = code_index_epoch_.FetchAndAddSequentiallyConsistent(1u) & 1u;
+    while (code_index_readers_[old_epoch].LoadSequentiallyConsistent() != 0u) {
+      sched_yield();
+    }
+  }
+  delete old_index;
+}
 
 bool JitCodeCache::ContainsPc(const void* ptr) const {
   return code_map_->Begin() <= ptr && ptr < code_map_->End();
 }
 
 bool JitCodeCache::ContainsMethod(ArtMethod* method) {
-  MutexLock mu(Thread::Current(), lock_);
   if (UNLIKELY(method->IsNative())) {
+    MutexLock mu(Thread::Current(), lock_);
     auto it = jni_stubs_map_.find(JniStubKey(method));
-    if (it != jni_stubs_map_.end() &&
+    return it != jni_stubs_map_.end() &&
         it->second.IsCompiled() &&
-        ContainsElement(it->second.GetMethods(), method)) {
-      return true;
-    }
-  } else {
-    for (const auto& it : method_code_map_) {
-      if (it.second == method) {
-        return true;
-      }
-    }
+        ContainsElement(it->second.GetMethods(), method);
   }
-  return false;
+  ScopedCodeIndexReader reader(this);
+  return reader.Get() != nullptr && reader.Get()->ContainsMethod(method);
 }
 
 const void* JitCodeCache::GetJniStubCode(ArtMethod* method) {
@@ -348,17 +436,25 @@ const void* JitCodeCache::GetJniStubCode(ArtMethod* method) {
 
 class ScopedCodeCacheWrite : ScopedTrace {
  public:
+  // NO_THREAD_SAFETY_ANALYSIS as this is called with the code cache lock held, or while the
+  // code cache is being constructed.
   explicit ScopedCodeCacheWrite(const JitCodeCache* const code_cache,
-                                bool only_for_tlb_shootdown = false)
+                                bool only_for_tlb_shootdown = false) NO_THREAD_SAFETY_ANALYSIS
       : ScopedTrace("ScopedCodeCacheWrite"),
         code_cache_(code_cache),
-        only_for_tlb_shootdown_(only_for_tlb_shootdown) {
+        // The code mspace never grows past its footprint limit, which is half of the current
+        // capacity, so only that prefix of the code map needs to be writable. Toggling just the
+        // pages in use keeps the cost of each write window proportional to the live cache
+        // instead of its maximum capacity.
+        size_(only_for_tlb_shootdown
+                  ? kPageSize
+                  : std::min(code_cache_->current_capacity_ / 2, code_cache_->code_map_->Size())) {
     ScopedTrace trace("mprotect all");
     CheckedCall(
         mprotect,
         "make code writable",
         code_cache_->code_map_->Begin(),
-        only_for_tlb_shootdown_ ? kPageSize : code_cache_->code_map_->Size(),
+        size_,
         code_cache_->memmap_flags_prot_code_ | PROT_WRITE);
   }
 
@@ -368,16 +464,16 @@ class ScopedCodeCacheWrite : ScopedTrace {
         mprotect,
         "make code protected",
         code_cache_->code_map_->Begin(),
-        only_for_tlb_shootdown_ ? kPageSize : code_cache_->code_map_->Size(),
+        size_,
         code_cache_->memmap_flags_prot_code_);
   }
 
  private:
   const JitCodeCache* const code_cache_;
 
-  // If we're using ScopedCacheWrite only for TLB shootdown, we limit the scope of mprotect to
-  // one page.
-  const bool only_for_tlb_shootdown_;
+  // Size of the range made writable. If we're using ScopedCacheWrite only for TLB shootdown,
+  // we limit the scope of mprotect to one page.
+  const size_t size_;
 
   DISALLOW_COPY_AND_ASSIGN(ScopedCodeCacheWrite);
 };
@@ -396,7 +492,9 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                   bool osr,
                                   Handle<mirror::ObjectArray<mirror::Object>> roots,
                                   bool has_should_deoptimize_flag,
-                                  const ArenaSet<ArtMethod*>& cha_single_implementation_list) {
+                                  const ArenaSet<ArtMethod*>& cha_single_implementation_list,
+                                  const ArenaSet<ArtField*>& final_field_dependencies,
+                                  const ArenaSet<ArtMethod*>& inlined_methods) {
   uint8_t* result = CommitCodeInternal(self,
                                        method,
                                        stack_map,
@@ -411,7 +509,9 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                        osr,
                                        roots,
                                        has_should_deoptimize_flag,
-                                       cha_single_implementation_list);
+                                       cha_single_implementation_list,
+                                       final_field_dependencies,
+                                       inlined_methods);
   if (result == nullptr) {
     // Retry.
     GarbageCollectCache(self);
@@ -429,7 +529,9 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                 osr,
                                 roots,
                                 has_should_deoptimize_flag,
-                                cha_single_implementation_list);
+                                cha_single_implementation_list,
+                                final_field_dependencies,
+                                inlined_methods);
   }
   return result;
 }
@@ -633,6 +735,26 @@ void JitCodeCache::RemoveMethodsIn(Thread* self, const LinearAlloc& alloc) {
           ++it;
         }
       }
+      PublishCodeIndex();
+    }
+    for (auto it = baseline_methods_.begin(); it != baseline_methods_.end();) {
+      if (alloc.ContainsUnsafe(it->first)) {
+        it = baseline_methods_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    for (auto it = inliners_.begin(); it != inliners_.end();) {
+      if (alloc.ContainsUnsafe(it->first)) {
+        it = inliners_.erase(it);
+      } else {
+        std::vector<ArtMethod*>& inliners = it->second;
+        inliners.erase(std::remove_if(inliners.begin(),
+                                      inliners.end(),
+                                      [&alloc](ArtMethod* m) { return alloc.ContainsUnsafe(m); }),
+                       inliners.end());
+        ++it;
+      }
     }
     for (auto it = osr_code_map_.begin(); it != osr_code_map_.end();) {
       if (alloc.ContainsUnsafe(it->first)) {
@@ -658,9 +780,8 @@ void JitCodeCache::RemoveMethodsIn(Thread* self, const LinearAlloc& alloc) {
 }
 
 bool JitCodeCache::IsWeakAccessEnabled(Thread* self) const {
-  return kUseReadBarrier
-      ? self->GetWeakRefAccessEnabled()
-      : is_weak_access_enabled_.LoadSequentiallyConsistent();
+  return (kUseReadBarrier && self->GetWeakRefAccessEnabled()) ||
+      is_weak_access_enabled_.LoadSequentiallyConsistent();
 }
 
 void JitCodeCache::WaitUntilInlineCacheAccessible(Thread* self) {
@@ -681,29 +802,32 @@ void JitCodeCache::BroadcastForInlineCacheAccess() {
 }
 
 void JitCodeCache::AllowInlineCacheAccess() {
-  DCHECK(!kUseReadBarrier);
   is_weak_access_enabled_.StoreSequentiallyConsistent(true);
   BroadcastForInlineCacheAccess();
 }
 
 void JitCodeCache::DisallowInlineCacheAccess() {
-  DCHECK(!kUseReadBarrier);
   is_weak_access_enabled_.StoreSequentiallyConsistent(false);
 }
 
 void JitCodeCache::CopyInlineCacheInto(const InlineCache& ic,
-                                       Handle<mirror::ObjectArray<mirror::Class>> array) {
+                                       Handle<mirror::ObjectArray<mirror::Class>> array,
+                                       /*out*/uint16_t* counts,
+                                       /*out*/uint16_t* megamorphic_count) {
   WaitUntilInlineCacheAccessible(Thread::Current());
   // Note that we don't need to lock `lock_` here, the compiler calling
   // this method has already ensured the inline cache will not be deleted.
+  std::fill_n(counts, InlineCache::kIndividualCacheSize, 0u);
   for (size_t in_cache = 0, in_array = 0;
        in_cache < InlineCache::kIndividualCacheSize;
        ++in_cache) {
     mirror::Class* object = ic.classes_[in_cache].Read();
     if (object != nullptr) {
+      counts[in_array] = ic.counts_[in_cache];
       array->Set(in_array++, object);
     }
   }
+  *megamorphic_count = ic.megamorphic_count_;
 }
 
 static void ClearMethodCounter(ArtMethod* method, bool was_warm) {
@@ -737,7 +861,9 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
                                           Handle<mirror::ObjectArray<mirror::Object>> roots,
                                           bool has_should_deoptimize_flag,
                                           const ArenaSet<ArtMethod*>&
-                                              cha_single_implementation_list) {
+                                              cha_single_implementation_list,
+                                          const ArenaSet<ArtField*>& final_field_dependencies,
+                                          const ArenaSet<ArtMethod*>& inlined_methods) {
   DCHECK_NE(stack_map != nullptr, method->IsNative());
   DCHECK(!method->IsNative() || !osr);
   size_t alignment = GetInstructionSetAlignment(kRuntimeISA);
@@ -810,9 +936,22 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
     DCHECK(cha_single_implementation_list.empty() || !Runtime::Current()->IsJavaDebuggable())
         << "Should not be using cha on debuggable apps/runs!";
 
+    ClassHierarchyAnalysis* cha =
+        Runtime::Current()->GetClassLinker()->GetClassHierarchyAnalysis();
+    for (ArtField* field : final_field_dependencies) {
+      if (cha->IsFinalFieldModifiedLocked(field)) {
+        // The folded value is stale. Clear the counter so that it may be recompiled later.
+        VLOG(jit) << "JIT discarded jitted code that folded modified " << field->PrettyField();
+        ClearMethodCounter(method, /*was_warm*/ false);
+        return nullptr;
+      }
+    }
+
     for (ArtMethod* single_impl : cha_single_implementation_list) {
-      Runtime::Current()->GetClassLinker()->GetClassHierarchyAnalysis()->AddDependency(
-          single_impl, method, method_header);
+      cha->AddDependency(single_impl, method, method_header);
+    }
+    for (ArtField* field : final_field_dependencies) {
+      cha->AddFinalFieldDependency(field, method, method_header);
     }
 
     // The following needs to be guarded by cha_lock_ also. Otherwise it's
@@ -846,6 +985,13 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
                        reinterpret_cast<char*>(roots_data + data_size));
       }
       method_code_map_.Put(code_ptr, method);
+      PublishCodeIndex();
+      for (ArtMethod* inlined_method : inlined_methods) {
+        std::vector<ArtMethod*>& inliners = inliners_.FindOrAdd(inlined_method)->second;
+        if (!ContainsElement(inliners, method)) {
+          inliners.push_back(method);
+        }
+      }
       if (osr) {
         number_of_osr_compilations_++;
         osr_code_map_.Put(method, code_ptr);
@@ -880,6 +1026,14 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
   return reinterpret_cast<uint8_t*>(method_header);
 }
 
+void JitCodeCache::GetInliners(ArtMethod* method, std::vector<ArtMethod*>* inliners) {
+  MutexLock mu(Thread::Current(), lock_);
+  auto it = inliners_.find(method);
+  if (it != inliners_.end()) {
+    inliners->insert(inliners->end(), it->second.begin(), it->second.end());
+  }
+}
+
 size_t JitCodeCache::CodeCacheSize() {
   MutexLock mu(Thread::Current(), lock_);
   return CodeCacheSizeLocked();
@@ -945,11 +1099,15 @@ bool JitCodeCache::RemoveMethodLocked(ArtMethod* method, bool release_memory) {
         ++it;
       }
     }
+    if (in_cache) {
+      PublishCodeIndex();
+    }
 
     auto osr_it = osr_code_map_.find(method);
     if (osr_it != osr_code_map_.end()) {
       osr_code_map_.erase(osr_it);
     }
+    baseline_methods_.erase(method);
   }
 
   return in_cache;
@@ -991,17 +1149,27 @@ void JitCodeCache::MoveObsoleteMethod(ArtMethod* old_method, ArtMethod* new_meth
     info->method_ = new_method;
   }
   // Update method_code_map_ to point to the new method.
+  bool updated = false;
   for (auto& it : method_code_map_) {
     if (it.second == old_method) {
       it.second = new_method;
+      updated = true;
     }
   }
+  if (updated) {
+    PublishCodeIndex();
+  }
   // Update osr_code_map_ to point to the new method.
   auto code_map = osr_code_map_.find(old_method);
   if (code_map != osr_code_map_.end()) {
     osr_code_map_.Put(new_method, code_map->second);
     osr_code_map_.erase(old_method);
   }
+  auto baseline_it = baseline_methods_.find(old_method);
+  if (baseline_it != baseline_methods_.end()) {
+    baseline_methods_.Overwrite(new_method, baseline_it->second);
+    baseline_methods_.erase(baseline_it);
+  }
 }
 
 size_t JitCodeCache::CodeCacheSizeLocked() {
@@ -1266,12 +1434,14 @@ void JitCodeCache::GarbageCollectCache(Thread* self) {
 
       // Start polling the liveness of compiled code to prepare for the next full collection.
       if (next_collection_will_be_full) {
+        std::unordered_set<ProfilingInfo*> resident;
+        SelectResidentMethods(&resident);
         // Save the entry point of methods we have compiled, and update the entry
         // point of those methods to the interpreter. If the method is invoked, the
         // interpreter will update its entry point to the compiled code and call it.
         for (ProfilingInfo* info : profiling_infos_) {
           const void* entry_point = info->GetMethod()->GetEntryPointFromQuickCompiledCode();
-          if (ContainsPc(entry_point)) {
+          if (ContainsPc(entry_point) && resident.find(info) == resident.end()) {
             info->SetSavedEntryPoint(entry_point);
             // Don't call Instrumentation::UpdateMethodsCode(), as it can check the declaring
             // class of the method. We may be concurrently running a GC which makes accessing
@@ -1309,6 +1479,44 @@ void JitCodeCache::GarbageCollectCache(Thread* self) {
   Runtime::Current()->GetJit()->AddTimingLogger(logger);
 }
 
+void JitCodeCache::SelectResidentMethods(std::unordered_set<ProfilingInfo*>* resident) {
+  std::vector<ProfilingInfo*> candidates;
+  for (ProfilingInfo* info : profiling_infos_) {
+    if (info->GetResidency() >= kResidencyThreshold &&
+        ContainsPc(info->GetMethod()->GetEntryPointFromQuickCompiledCode())) {
+      candidates.push_back(info);
+    }
+  }
+  // Baseline code keeps counting hotness, use it to break ties.
+  std::sort(candidates.begin(),
+            candidates.end(),
+            [](ProfilingInfo* lhs, ProfilingInfo* rhs) NO_THREAD_SAFETY_ANALYSIS {
+              if (lhs->GetResidency() != rhs->GetResidency()) {
+                return lhs->GetResidency() > rhs->GetResidency();
+              }
+              return lhs->GetMethod()->GetCounter() > rhs->GetMethod()->GetCounter();
+            });
+  // Always leave room for the code we need to poll, and for new compilations.
+  const size_t budget = current_capacity_ / 4;
+  number_of_resident_methods_ = 0;
+  resident_code_size_ = 0;
+  for (ProfilingInfo* info : candidates) {
+    const OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromEntryPoint(
+        info->GetMethod()->GetEntryPointFromQuickCompiledCode());
+    size_t code_size = method_header->GetCodeSize();
+    if (resident_code_size_ + code_size > budget) {
+      continue;
+    }
+    resident_code_size_ += code_size;
+    number_of_resident_methods_++;
+    // Age the method, so that code which stopped being used is eventually polled again.
+    info->DecrementResidency();
+    resident->insert(info);
+  }
+  VLOG(jit) << "Keeping " << number_of_resident_methods_ << " methods resident, code="
+            << PrettySize(resident_code_size_);
+}
+
 void JitCodeCache::RemoveUnmarkedCode(Thread* self) {
   ScopedTrace trace(__FUNCTION__);
   std::unordered_set<OatQuickMethodHeader*> method_headers;
@@ -1331,10 +1539,14 @@ void JitCodeCache::RemoveUnmarkedCode(Thread* self) {
       if (GetLiveBitmap()->Test(allocation)) {
         ++it;
       } else {
-        method_headers.insert(OatQuickMethodHeader::FromCodePointer(code_ptr));
+        OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
+        number_of_evicted_methods_++;
+        evicted_code_size_ += method_header->GetCodeSize();
+        method_headers.insert(method_header);
         it = method_code_map_.erase(it);
       }
     }
+    PublishCodeIndex();
   }
   FreeAllMethodHeaders(method_headers);
 }
@@ -1353,6 +1565,12 @@ void JitCodeCache::DoCollection(Thread* self, bool collect_profiling_info) {
         }
 
         if (info->GetSavedEntryPoint() != nullptr) {
+          // The method was polled: if it got invoked since, its compiled code is in use.
+          if (ContainsPc(ptr)) {
+            info->IncrementResidency();
+          } else {
+            info->ResetResidency();
+          }
           info->SetSavedEntryPoint(nullptr);
           // We are going to move this method back to interpreter. Clear the counter now to
           // give it a chance to be hot again.
@@ -1465,10 +1683,10 @@ OatQuickMethodHeader* JitCodeCache::LookupMethodHeader(uintptr_t pc, ArtMethod*
     CHECK(method != nullptr);
   }
 
-  MutexLock mu(Thread::Current(), lock_);
   OatQuickMethodHeader* method_header = nullptr;
   ArtMethod* found_method = nullptr;  // Only for DCHECK(), not for JNI stubs.
   if (method != nullptr && UNLIKELY(method->IsNative())) {
+    MutexLock mu(Thread::Current(), lock_);
     auto it = jni_stubs_map_.find(JniStubKey(method));
     if (it == jni_stubs_map_.end() || !ContainsElement(it->second.GetMethods(), method)) {
       return nullptr;
@@ -1479,18 +1697,22 @@ OatQuickMethodHeader* JitCodeCache::LookupMethodHeader(uintptr_t pc, ArtMethod*
       return nullptr;
     }
   } else {
-    auto it = method_code_map_.lower_bound(reinterpret_cast<const void*>(pc));
-    if (it != method_code_map_.begin()) {
-      --it;
-      const void* code_ptr = it->first;
-      if (OatQuickMethodHeader::FromCodePointer(code_ptr)->Contains(pc)) {
-        method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
-        found_method = it->second;
+    {
+      // The stale entries an index may hold for freed code are never matched: code is
+      // only freed when it is not on any thread stack, so no caller passes its pc.
+      ScopedCodeIndexReader reader(this);
+      const CodeIndex::Entry* entry =
+          (reader.Get() != nullptr) ? reader.Get()->Find(reinterpret_cast<const void*>(pc))
+                                    : nullptr;
+      if (entry != nullptr && OatQuickMethodHeader::FromCodePointer(entry->first)->Contains(pc)) {
+        method_header = OatQuickMethodHeader::FromCodePointer(entry->first);
+        found_method = entry->second;
       }
     }
     if (method_header == nullptr && method == nullptr) {
       // Scan all compiled JNI stubs as well. This slow search is used only
       // for checks in debug build, for release builds the `method` is not null.
+      MutexLock mu(Thread::Current(), lock_);
       for (auto&& entry : jni_stubs_map_) {
         const JniStubData& data = entry.second;
         if (data.IsCompiled() &&
@@ -1524,15 +1746,25 @@ OatQuickMethodHeader* JitCodeCache::LookupMethodHeader(uintptr_t pc, ArtMethod*
 OatQuickMethodHeader* JitCodeCache::LookupOsrMethodHeader(ArtMethod* method) {
   MutexLock mu(Thread::Current(), lock_);
   auto it = osr_code_map_.find(method);
-  if (it == osr_code_map_.end()) {
-    return nullptr;
+  if (it != osr_code_map_.end()) {
+    return OatQuickMethodHeader::FromCodePointer(it->second);
+  }
+  // Baseline code has OSR entries at its loop headers. Note that the entry point may already
+  // have been updated to optimized code, which has no OSR stack maps: callers fail to find
+  // an OSR entry for that code and keep interpreting.
+  if (baseline_methods_.find(method) != baseline_methods_.end()) {
+    const void* entry_point = method->GetEntryPointFromQuickCompiledCode();
+    if (ContainsPc(entry_point)) {
+      return OatQuickMethodHeader::FromEntryPoint(entry_point);
+    }
   }
-  return OatQuickMethodHeader::FromCodePointer(it->second);
+  return nullptr;
 }
 
 ProfilingInfo* JitCodeCache::AddProfilingInfo(Thread* self,
                                               ArtMethod* method,
                                               const std::vector<uint32_t>& entries,
+                                              const std::vector<uint32_t>& branch_entries,
                                               bool retry_allocation)
     // No thread safety analysis as we are using TryLock/Unlock explicitly.
     NO_THREAD_SAFETY_ANALYSIS {
@@ -1541,19 +1773,19 @@ ProfilingInfo* JitCodeCache::AddProfilingInfo(Thread* self,
     // If we are allocating for the interpreter, just try to lock, to avoid
     // lock contention with the JIT.
     if (lock_.ExclusiveTryLock(self)) {
-      info = AddProfilingInfoInternal(self, method, entries);
+      info = AddProfilingInfoInternal(self, method, entries, branch_entries);
       lock_.ExclusiveUnlock(self);
     }
   } else {
     {
       MutexLock mu(self, lock_);
-      info = AddProfilingInfoInternal(self, method, entries);
+      info = AddProfilingInfoInternal(self, method, entries, branch_entries);
     }
 
     if (info == nullptr) {
       GarbageCollectCache(self);
       MutexLock mu(self, lock_);
-      info = AddProfilingInfoInternal(self, method, entries);
+      info = AddProfilingInfoInternal(self, method, entries, branch_entries);
     }
   }
   return info;
@@ -1561,9 +1793,10 @@ ProfilingInfo* JitCodeCache::AddProfilingInfo(Thread* self,
 
 ProfilingInfo* JitCodeCache::AddProfilingInfoInternal(Thread* self ATTRIBUTE_UNUSED,
                                                       ArtMethod* method,
-                                                      const std::vector<uint32_t>& entries) {
+                                                      const std::vector<uint32_t>& entries,
+                                                      const std::vector<uint32_t>& branch_entries) {
   size_t profile_info_size = RoundUp(
-      sizeof(ProfilingInfo) + sizeof(InlineCache) * entries.size(),
+      ProfilingInfo::ComputeSize(entries.size(), branch_entries.size()),
       sizeof(void*));
 
   // Check whether some other thread has concurrently created it.
@@ -1576,7 +1809,7 @@ ProfilingInfo* JitCodeCache::AddProfilingInfoInternal(Thread* self ATTRIBUTE_UNU
   if (data == nullptr) {
     return nullptr;
   }
-  info = new (data) ProfilingInfo(method, entries);
+  info = new (data) ProfilingInfo(method, entries, branch_entries);
 
   // Make sure other threads see the data in the profiling info object before the
   // store in the ArtMethod's ProfilingInfo pointer.
@@ -1618,12 +1851,23 @@ void JitCodeCache::GetProfiledMethods(const std::set<std::string>& dex_base_loca
     }
     std::vector<ProfileMethodInfo::ProfileInlineCache> inline_caches;
 
+    // Branch biases are meaningful even before the method gets hot.
+    std::vector<ProfileMethodInfo::ProfileBranch> branches;
+    const BranchCache* branch_caches = info->GetBranchCaches();
+    for (size_t i = 0; i < info->GetNumberOfBranchCaches(); ++i) {
+      const BranchCache& cache = branch_caches[i];
+      if (cache.GetTakenCount() != 0 || cache.GetNotTakenCount() != 0) {
+        branches.emplace_back(/*ProfileMethodInfo::ProfileBranch*/
+            cache.GetDexPc(), cache.GetTakenCount(), cache.GetNotTakenCount());
+      }
+    }
+
     // If the method didn't reach the compilation threshold don't save the inline caches.
     // They might be incomplete and cause unnecessary deoptimizations.
     // If the inline cache is empty the compiler will generate a regular invoke virtual/interface.
     if (method->GetCounter() < jit_compile_threshold) {
       methods.emplace_back(/*ProfileMethodInfo*/
-          MethodReference(dex_file, method->GetDexMethodIndex()), inline_caches);
+          MethodReference(dex_file, method->GetDexMethodIndex()), inline_caches, branches);
       continue;
     }
 
@@ -1681,7 +1925,7 @@ void JitCodeCache::GetProfiledMethods(const std::set<std::string>& dex_base_loca
       }
     }
     methods.emplace_back(/*ProfileMethodInfo*/
-        MethodReference(dex_file, method->GetDexMethodIndex()), inline_caches);
+        MethodReference(dex_file, method->GetDexMethodIndex()), inline_caches, branches);
   }
 }
 
@@ -1694,8 +1938,13 @@ bool JitCodeCache::IsOsrCompiled(ArtMethod* method) {
   return osr_code_map_.find(method) != osr_code_map_.end();
 }
 
-bool JitCodeCache::NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr) {
-  if (!osr && ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+bool JitCodeCache::NotifyCompilationOf(ArtMethod* method,
+                                       Thread* self,
+                                       bool baseline,
+                                       bool osr) {
+  if (!osr &&
+      ContainsPc(method->GetEntryPointFromQuickCompiledCode()) &&
+      (baseline || !IsBaselineCompiled(method))) {
     return false;
   }
 
@@ -1716,22 +1965,7 @@ bool JitCodeCache::NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr
     JniStubData* data = &it->second;
     data->AddMethod(method);
     if (data->IsCompiled()) {
-      OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(data->GetCode());
-      const void* entrypoint = method_header->GetEntryPoint();
-      // Update also entrypoints of other methods held by the JniStubData.
-      // We could simply update the entrypoint of `method` but if the last JIT GC has
-      // changed these entrypoints to GenericJNI in preparation for a full GC, we may
-      // as well change them back as this stub shall not be collected anyway and this
-      // can avoid a few expensive GenericJNI calls.
-      instrumentation::Instrumentation* instrumentation = Runtime::Current()->GetInstrumentation();
-      for (ArtMethod* m : data->GetMethods()) {
-        // Call the dedicated method instead of the more generic UpdateMethodsCode, because
-        // `m` might be in the process of being deleted.
-        instrumentation->UpdateNativeMethodsCodeToJitCode(m, entrypoint);
-      }
-      if (collection_in_progress_) {
-        GetLiveBitmap()->AtomicTestAndSet(FromCodeToAllocation(data->GetCode()));
-      }
+      UpdateJniStubEntrypoints(*data);
     }
     return new_compilation;
   } else {
@@ -1753,6 +1987,47 @@ bool JitCodeCache::NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr
   }
 }
 
+void JitCodeCache::SetBaselineCompiled(ArtMethod* method, bool baseline) {
+  MutexLock mu(Thread::Current(), lock_);
+  if (baseline) {
+    baseline_methods_.Overwrite(method, /* scheduled */ false);
+  } else {
+    baseline_methods_.erase(method);
+  }
+}
+
+bool JitCodeCache::IsBaselineCompiled(ArtMethod* method) {
+  MutexLock mu(Thread::Current(), lock_);
+  return baseline_methods_.find(method) != baseline_methods_.end();
+}
+
+bool JitCodeCache::ScheduleOptimizedCompilation(ArtMethod* method) {
+  MutexLock mu(Thread::Current(), lock_);
+  auto it = baseline_methods_.find(method);
+  if (it == baseline_methods_.end() || it->second) {
+    return false;
+  }
+  if (!ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+    // The method is interpreted while a collection decides whether its code is still used.
+    return false;
+  }
+  it->second = true;
+  return true;
+}
+
+void JitCodeCache::GetHotBaselineMethods(uint16_t threshold, std::vector<ArtMethod*>* methods) {
+  MutexLock mu(Thread::Current(), lock_);
+  for (auto& entry : baseline_methods_) {
+    ArtMethod* method = entry.first;
+    if (!entry.second &&
+        method->GetCounter() >= threshold &&
+        ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+      entry.second = true;
+      methods->push_back(method);
+    }
+  }
+}
+
 ProfilingInfo* JitCodeCache::NotifyCompilerUse(ArtMethod* method, Thread* self) {
   MutexLock mu(self, lock_);
   ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
@@ -1772,6 +2047,45 @@ void JitCodeCache::DoneCompilerUse(ArtMethod* method, Thread* self) {
   info->DecrementInlineUse();
 }
 
+void JitCodeCache::UpdateJniStubEntrypoints(const JniStubData& data) {
+  DCHECK(data.IsCompiled());
+  OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(data.GetCode());
+  const void* entrypoint = method_header->GetEntryPoint();
+  // Update also entrypoints of other methods held by the JniStubData.
+  // We could simply update the entrypoint of the new method but if the last JIT GC has
+  // changed these entrypoints to GenericJNI in preparation for a full GC, we may
+  // as well change them back as this stub shall not be collected anyway and this
+  // can avoid a few expensive GenericJNI calls.
+  instrumentation::Instrumentation* instrumentation = Runtime::Current()->GetInstrumentation();
+  for (ArtMethod* m : data.GetMethods()) {
+    // Call the dedicated method instead of the more generic UpdateMethodsCode, because
+    // `m` might be in the process of being deleted.
+    instrumentation->UpdateNativeMethodsCodeToJitCode(m, entrypoint);
+  }
+  if (collection_in_progress_) {
+    GetLiveBitmap()->AtomicTestAndSet(FromCodeToAllocation(data.GetCode()));
+  }
+}
+
+bool JitCodeCache::UseCompiledJniStub(ArtMethod* method) {
+  DCHECK(method->IsNative());
+  MutexLock mu(Thread::Current(), lock_);
+  auto it = jni_stubs_map_.find(JniStubKey(method));
+  if (it == jni_stubs_map_.end() || !it->second.IsCompiled()) {
+    // No stub yet, or its compilation is still in progress.
+    return false;
+  }
+  JniStubData* data = &it->second;
+  if (ContainsElement(data->GetMethods(), method)) {
+    // The method used the stub before. If its entrypoint was reset by the JIT GC, leave it
+    // to the hotness count to decide whether the stub is still in use.
+    return false;
+  }
+  data->AddMethod(method);
+  UpdateJniStubEntrypoints(*data);
+  return true;
+}
+
 void JitCodeCache::DoneCompiling(ArtMethod* method, Thread* self, bool osr) {
   DCHECK_EQ(Thread::Current(), self);
   MutexLock mu(self, lock_);
@@ -1822,6 +2136,19 @@ void JitCodeCache::InvalidateCompiledCodeFor(ArtMethod* method,
   }
 }
 
+void JitCodeCache::AddDeoptimization(ArtMethod* method, DeoptimizationKind kind) {
+  DCHECK(!method->IsNative());
+  MutexLock mu(Thread::Current(), lock_);
+  number_of_deoptimizations_++;
+  // The profiling info may have been collected, in which case the counts start over.
+  ProfilingInfo* profiling_info = method->GetProfilingInfo(kRuntimePointerSize);
+  if (profiling_info != nullptr && profiling_info->AddDeoptimization(kind)) {
+    number_of_disabled_speculations_++;
+    VLOG(jit) << "Disabling " << GetDeoptimizationKindName(kind) << " speculations in "
+              << method->PrettyMethod();
+  }
+}
+
 uint8_t* JitCodeCache::AllocateCode(size_t code_size) {
   size_t alignment = GetInstructionSetAlignment(kRuntimeISA);
   uint8_t* result = reinterpret_cast<uint8_t*>(
@@ -1861,7 +2188,15 @@ void JitCodeCache::Dump(std::ostream& os) {
      << "Total number of JIT compilations: " << number_of_compilations_ << "\n"
      << "Total number of JIT compilations for on stack replacement: "
         << number_of_osr_compilations_ << "\n"
-     << "Total number of JIT code cache collections: " << number_of_collections_ << std::endl;
+     << "Total number of JIT code cache collections: " << number_of_collections_ << "\n"
+     << "Total number of JIT code deoptimizations: " << number_of_deoptimizations_ << "\n"
+     << "Total number of JIT speculations disabled by deoptimizations: "
+        << number_of_disabled_speculations_ << "\n"
+     << "Total number of JIT code cache evictions: " << number_of_evicted_methods_
+        << " (" << PrettySize(evicted_code_size_) << ")\n"
+     << "Methods kept resident by the last JIT code cache collection: "
+        << number_of_resident_methods_ << " (" << PrettySize(resident_code_size_) << ")"
+        << std::endl;
   histogram_stack_map_memory_use_.PrintMemoryUse(os);
   histogram_code_memory_use_.PrintMemoryUse(os);
   histogram_profiling_info_memory_use_.PrintMemoryUse(os);
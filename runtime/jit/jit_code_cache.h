@@ -25,11 +25,13 @@
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "base/safe_map.h"
+#include "deoptimization_kind.h"
 #include "dex/method_reference.h"
 #include "gc_root.h"
 
 namespace art {
 
+class ArtField;
 class ArtMethod;
 template<class T> class Handle;
 class LinearAlloc;
@@ -84,6 +86,10 @@ class JitCodeCache {
   // By default, do not GC until reaching 256KB.
   static constexpr size_t kReservedCapacity = kInitialCapacity * 4;
 
+  // Compiled code found in use by this many consecutive polls before a full collection is
+  // kept resident, instead of being moved back to the interpreter to poll it again.
+  static constexpr uint8_t kResidencyThreshold = 2;
+
   // Create the code cache with a code + data capacity equal to "capacity", error message is passed
   // in the out arg error_msg.
   static JitCodeCache* Create(size_t initial_capacity,
@@ -99,7 +105,34 @@ class JitCodeCache {
   // Number of bytes allocated in the data cache.
   size_t DataCacheSize() REQUIRES(!lock_);
 
-  bool NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr)
+  // Return whether `method` should be compiled. Only baseline code can be replaced
+  // by a non-osr compilation.
+  bool NotifyCompilationOf(ArtMethod* method, Thread* self, bool baseline, bool osr)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // If the JNI stub shared by native methods with the same shorty and flags as `method` is
+  // already compiled for other methods, make `method` use it and return true. Return false
+  // otherwise.
+  bool UseCompiledJniStub(ArtMethod* method)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // Record whether the code just committed for `method` is baseline code.
+  void SetBaselineCompiled(ArtMethod* method, bool baseline) REQUIRES(!lock_);
+
+  // Return whether the code of `method` is baseline code.
+  bool IsBaselineCompiled(ArtMethod* method) REQUIRES(!lock_);
+
+  // Return true if `method` runs baseline code that has not been scheduled for an optimized
+  // compilation yet, and mark it as scheduled.
+  bool ScheduleOptimizedCompilation(ArtMethod* method)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // Add to `methods` the baseline methods whose hotness count reached `threshold`, and mark
+  // them as scheduled for an optimized compilation.
+  void GetHotBaselineMethods(uint16_t threshold, std::vector<ArtMethod*>* methods)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!lock_);
 
@@ -128,7 +161,9 @@ class JitCodeCache {
   // still valid), since the compiled code still needs to be invalidated if the
   // single-implementation assumptions are violated later. This needs to be done
   // even if `has_should_deoptimize_flag` is false, which can happen due to CHA
-  // guard elimination.
+  // guard elimination. Likewise, `final_field_dependencies` are the static final
+  // fields whose value the code has folded. `inlined_methods` are recorded for
+  // GetInliners().
   uint8_t* CommitCode(Thread* self,
                       ArtMethod* method,
                       uint8_t* stack_map,
@@ -143,10 +178,16 @@ class JitCodeCache {
                       bool osr,
                       Handle<mirror::ObjectArray<mirror::Object>> roots,
                       bool has_should_deoptimize_flag,
-                      const ArenaSet<ArtMethod*>& cha_single_implementation_list)
+                      const ArenaSet<ArtMethod*>& cha_single_implementation_list,
+                      const ArenaSet<ArtField*>& final_field_dependencies,
+                      const ArenaSet<ArtMethod*>& inlined_methods)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!lock_);
 
+  // Append the methods whose compiled code inlined `method` to `inliners`. This may include
+  // methods whose code has been collected since.
+  void GetInliners(ArtMethod* method, std::vector<ArtMethod*>* inliners) REQUIRES(!lock_);
+
   // Return true if the code cache contains this pc.
   bool ContainsPc(const void* pc) const;
 
@@ -191,6 +232,8 @@ class JitCodeCache {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Return the code the interpreter can OSR into for `method`: its OSR compiled code, or
+  // otherwise its baseline code. Return null if there is neither.
   OatQuickMethodHeader* LookupOsrMethodHeader(ArtMethod* method)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -207,7 +250,13 @@ class JitCodeCache {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
-  void CopyInlineCacheInto(const InlineCache& ic, Handle<mirror::ObjectArray<mirror::Class>> array)
+  // Copy the classes of `ic` into `array`, and how many times each was seen into the
+  // `InlineCache::kIndividualCacheSize` entries of `counts`. `megamorphic_count` receives
+  // how many receivers did not fit in the cache.
+  void CopyInlineCacheInto(const InlineCache& ic,
+                           Handle<mirror::ObjectArray<mirror::Class>> array,
+                           /*out*/uint16_t* counts,
+                           /*out*/uint16_t* megamorphic_count)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -216,6 +265,7 @@ class JitCodeCache {
   ProfilingInfo* AddProfilingInfo(Thread* self,
                                   ArtMethod* method,
                                   const std::vector<uint32_t>& entries,
+                                  const std::vector<uint32_t>& branch_entries,
                                   bool retry_allocation)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -240,6 +290,12 @@ class JitCodeCache {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Record that the compiled code of `method` deoptimized because of a failed speculation
+  // of kind `kind`, so that the next compilation can avoid speculations that keep failing.
+  void AddDeoptimization(ArtMethod* method, DeoptimizationKind kind)
+      REQUIRES(!lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   void Dump(std::ostream& os) REQUIRES(!lock_);
 
   bool IsOsrCompiled(ArtMethod* method) REQUIRES(!lock_);
@@ -291,13 +347,16 @@ class JitCodeCache {
                               bool osr,
                               Handle<mirror::ObjectArray<mirror::Object>> roots,
                               bool has_should_deoptimize_flag,
-                              const ArenaSet<ArtMethod*>& cha_single_implementation_list)
+                              const ArenaSet<ArtMethod*>& cha_single_implementation_list,
+                              const ArenaSet<ArtField*>& final_field_dependencies,
+                              const ArenaSet<ArtMethod*>& inlined_methods)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   ProfilingInfo* AddProfilingInfoInternal(Thread* self,
                                           ArtMethod* method,
-                                          const std::vector<uint32_t>& entries)
+                                          const std::vector<uint32_t>& entries,
+                                          const std::vector<uint32_t>& branch_entries)
       REQUIRES(lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -337,6 +396,10 @@ class JitCodeCache {
   void SetFootprintLimit(size_t new_footprint) REQUIRES(lock_);
 
   // Return whether we should do a full collection given the current state of the cache.
+  // Choose which compiled methods are not polled before the next full collection: the ones
+  // found in use by the last polls, hottest first, up to half of the code capacity.
+  void SelectResidentMethods(std::unordered_set<ProfilingInfo*>* resident) REQUIRES(lock_);
+
   bool ShouldDoFullCollection()
       REQUIRES(lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -369,6 +432,18 @@ class JitCodeCache {
 
   class JniStubKey;
   class JniStubData;
+  class CodeIndex;
+  class ScopedCodeIndexReader;
+
+  // Point all the methods of the compiled JNI stub `data` to its code.
+  void UpdateJniStubEntrypoints(const JniStubData& data)
+      REQUIRES(lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Replace the lock-free lookup index with a snapshot of the current method_code_map_.
+  // Must be called after every modification of method_code_map_. Waits for readers of
+  // the previous index to leave before freeing it.
+  void PublishCodeIndex() REQUIRES(lock_);
 
   // Lock for guarding allocations, collections, and the method_code_map_.
   Mutex lock_;
@@ -390,8 +465,19 @@ class JitCodeCache {
   SafeMap<JniStubKey, JniStubData> jni_stubs_map_ GUARDED_BY(lock_);
   // Holds compiled code associated to the ArtMethod.
   SafeMap<const void*, ArtMethod*> method_code_map_ GUARDED_BY(lock_);
+  // Immutable sorted copy of method_code_map_, used by LookupMethodHeader() and
+  // ContainsMethod() to search compiled code without taking lock_.
+  Atomic<const CodeIndex*> code_index_;
+  // Readers of code_index_ register in the slot of the current epoch, so that
+  // PublishCodeIndex() can wait for the readers of a retired index to drain.
+  Atomic<uint32_t> code_index_epoch_;
+  Atomic<uint32_t> code_index_readers_[2];
+  // Methods running baseline code, and whether their optimized compilation is scheduled.
+  SafeMap<ArtMethod*, bool> baseline_methods_ GUARDED_BY(lock_);
   // Holds osr compiled code associated to the ArtMethod.
   SafeMap<ArtMethod*, const void*> osr_code_map_ GUARDED_BY(lock_);
+  // Holds the methods whose compiled code inlined the key, see GetInliners().
+  SafeMap<ArtMethod*, std::vector<ArtMethod*>> inliners_ GUARDED_BY(lock_);
   // ProfilingInfo objects we have allocated.
   std::vector<ProfilingInfo*> profiling_infos_ GUARDED_BY(lock_);
 
@@ -432,6 +518,19 @@ class JitCodeCache {
   // Number of code cache collections done throughout the lifetime of the JIT.
   size_t number_of_collections_ GUARDED_BY(lock_);
 
+  // Number of single frame deoptimizations of JIT code throughout the lifetime of the JIT,
+  // and number of times a method had one of its speculations disabled by them.
+  size_t number_of_deoptimizations_ GUARDED_BY(lock_);
+  size_t number_of_disabled_speculations_ GUARDED_BY(lock_);
+
+  // Number of compiled code entries, and their total size, freed by collections.
+  size_t number_of_evicted_methods_ GUARDED_BY(lock_);
+  size_t evicted_code_size_ GUARDED_BY(lock_);
+
+  // Number of methods, and their total code size, kept resident by the last collection.
+  size_t number_of_resident_methods_ GUARDED_BY(lock_);
+  size_t resident_code_size_ GUARDED_BY(lock_);
+
   // Histograms for keeping track of stack map size statistics.
   Histogram<uint64_t> histogram_stack_map_memory_use_ GUARDED_BY(lock_);
 
@@ -441,9 +540,9 @@ class JitCodeCache {
   // Histograms for keeping track of profiling info statistics.
   Histogram<uint64_t> histogram_profiling_info_memory_use_ GUARDED_BY(lock_);
 
-  // Whether the GC allows accessing weaks in inline caches. Note that this
-  // is not used by the concurrent collector, which uses
-  // Thread::SetWeakRefAccessEnabled instead.
+  // Whether the GC allows accessing weaks in inline caches. The concurrent
+  // collector clears it before disabling Thread::SetWeakRefAccessEnabled and
+  // sets it again once the root tables are swept.
   Atomic<bool> is_weak_access_enabled_;
 
   // Condition to wait on for accessing inline caches.
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jit_warm_start.h"
+
+#include "art_method-inl.h"
+#include "base/logging.h"  // For VLOG.
+#include "dex/dex_file.h"
+#include "handle.h"
+#include "mirror/class-inl.h"
+#include "runtime.h"
+#include "thread-current-inl.h"
+
+namespace art {
+namespace jit {
+
+JitWarmStart::JitWarmStart(std::unique_ptr<ProfileCompilationInfo> profile,
+                           uint16_t seed_counter)
+    : profile_(std::move(profile)),
+      seed_counter_(seed_counter),
+      lock_("JIT warm start lock"),
+      number_of_seeded_methods_(0) {
+  DCHECK(profile_ != nullptr);
+}
+
+std::unique_ptr<ProfileCompilationInfo> JitWarmStart::LoadProfile(const std::string& filename) {
+  std::unique_ptr<ProfileCompilationInfo> profile(new ProfileCompilationInfo());
+  if (!profile->Load(filename, /* clear_if_invalid */ false)) {
+    return nullptr;
+  }
+  if (profile->GetNumberOfMethods() == 0) {
+    VLOG(jit) << "No hot methods to warm up the JIT with in " << filename;
+    return nullptr;
+  }
+  return profile;
+}
+
+const std::set<uint16_t>* JitWarmStart::GetHotMethods(const DexFile& dex_file) {
+  auto key = std::make_pair(dex_file.GetLocation(), dex_file.GetLocationChecksum());
+  auto it = hot_methods_.find(key);
+  if (it == hot_methods_.end()) {
+    std::set<dex::TypeIndex> classes;
+    std::set<uint16_t> hot_methods;
+    std::set<uint16_t> startup_methods;
+    std::set<uint16_t> post_startup_methods;
+    // A dex file not in the profile, or one that changed since the profile was recorded, gets
+    // an empty set so that we do not look it up again.
+    if (!profile_->GetClassesAndMethods(dex_file,
+                                        &classes,
+                                        &hot_methods,
+                                        &startup_methods,
+                                        &post_startup_methods)) {
+      hot_methods.clear();
+    }
+    it = hot_methods_.emplace(std::move(key), std::move(hot_methods)).first;
+  }
+  return it->second.empty() ? nullptr : &it->second;
+}
+
+void JitWarmStart::SeedClass(ObjPtr<mirror::Class> klass) {
+  if (klass->IsProxyClass() || klass->IsArrayClass() || klass->IsPrimitive() ||
+      !klass->IsResolved()) {
+    return;
+  }
+  MutexLock mu(Thread::Current(), lock_);
+  const std::set<uint16_t>* hot_methods = GetHotMethods(klass->GetDexFile());
+  if (hot_methods == nullptr) {
+    return;
+  }
+  for (ArtMethod& method : klass->GetDeclaredMethods(kRuntimePointerSize)) {
+    if (method.IsClassInitializer() || !method.IsInvokable() || !method.IsCompilable()) {
+      continue;
+    }
+    if (hot_methods->find(method.GetDexMethodIndex()) == hot_methods->end()) {
+      continue;
+    }
+    // Never make a method look colder than it is.
+    if (method.GetCounter() < seed_counter_) {
+      method.SetCounter(seed_counter_);
+      ++number_of_seeded_methods_;
+    }
+  }
+}
+
+void JitWarmStart::SeedLoadedClasses() {
+  class SeedVisitor : public ClassVisitor {
+   public:
+    explicit SeedVisitor(JitWarmStart* warm_start) : warm_start_(warm_start) {}
+
+    bool operator()(ObjPtr<mirror::Class> klass) OVERRIDE REQUIRES_SHARED(Locks::mutator_lock_) {
+      warm_start_->SeedClass(klass);
+      return true;
+    }
+
+   private:
+    JitWarmStart* const warm_start_;
+  };
+  SeedVisitor visitor(this);
+  Runtime::Current()->GetClassLinker()->VisitClasses(&visitor);
+  VLOG(jit) << "JIT warm start seeded " << GetNumberOfSeededMethods()
+            << " methods of already loaded classes";
+}
+
+void JitWarmStart::ClassPrepare(Handle<mirror::Class> temp_klass ATTRIBUTE_UNUSED,
+                                Handle<mirror::Class> klass) {
+  SeedClass(klass.Get());
+}
+
+size_t JitWarmStart::GetNumberOfSeededMethods() {
+  MutexLock mu(Thread::Current(), lock_);
+  return number_of_seeded_methods_;
+}
+
+}  // namespace jit
+}  // namespace art
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_JIT_JIT_WARM_START_H_
+#define ART_RUNTIME_JIT_JIT_WARM_START_H_
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "class_linker.h"
+#include "profile_compilation_info.h"
+
+namespace art {
+
+class DexFile;
+
+namespace jit {
+
+// Uses the methods a previous run of the app recorded as hot in its profile to warm up the JIT
+// at startup. When a class gets linked, the hotness counter of each of its hot methods is set
+// just below the compilation threshold, so that the method gets JIT compiled the first time it
+// executes instead of after thousands of interpreted invocations.
+//
+// Compiled code itself is not persisted: it embeds addresses of runtime data structures and
+// would need to be relocated and revalidated against the boot image on each start. The profile
+// is keyed by dex location and checksum, so a stale profile only costs a few useless
+// compilations.
+class JitWarmStart FINAL : public ClassLoadCallback {
+ public:
+  JitWarmStart(std::unique_ptr<ProfileCompilationInfo> profile, uint16_t seed_counter);
+
+  // Load the profile at `filename`. Returns null if the file cannot be read or has no methods.
+  static std::unique_ptr<ProfileCompilationInfo> LoadProfile(const std::string& filename);
+
+  // Seed the methods of all the classes that have already been loaded.
+  void SeedLoadedClasses() REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!lock_);
+
+  // Seed the hot methods of `klass`.
+  void SeedClass(ObjPtr<mirror::Class> klass)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!lock_);
+
+  void ClassLoad(Handle<mirror::Class> klass ATTRIBUTE_UNUSED) OVERRIDE
+      REQUIRES_SHARED(Locks::mutator_lock_) {}
+
+  void ClassPrepare(Handle<mirror::Class> temp_klass ATTRIBUTE_UNUSED,
+                    Handle<mirror::Class> klass) OVERRIDE
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!lock_);
+
+  // Number of methods whose counter has been seeded so far.
+  size_t GetNumberOfSeededMethods() REQUIRES(!lock_);
+
+ private:
+  // Returns the hot methods of the given dex file, or null if the profile has none for it.
+  const std::set<uint16_t>* GetHotMethods(const DexFile& dex_file) REQUIRES(lock_);
+
+  const std::unique_ptr<ProfileCompilationInfo> profile_;
+  // The counter value given to hot methods.
+  const uint16_t seed_counter_;
+
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  // Hot methods of the dex files we have looked up, keyed by dex location and checksum.
+  std::map<std::pair<std::string, uint32_t>, std::set<uint16_t>> hot_methods_ GUARDED_BY(lock_);
+  size_t number_of_seeded_methods_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(JitWarmStart);
+};
+
+}  // namespace jit
+}  // namespace art
+
+#endif  // ART_RUNTIME_JIT_JIT_WARM_START_H_
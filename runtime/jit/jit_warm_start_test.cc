@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jit_warm_start.h"
+
+#include <memory>
+
+#include "art_method-inl.h"
+#include "class_linker-inl.h"
+#include "common_runtime_test.h"
+#include "dex/method_reference.h"
+#include "handle_scope-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+namespace jit {
+
+using Hotness = ProfileCompilationInfo::MethodHotness;
+
+class JitWarmStartTest : public CommonRuntimeTest {
+ protected:
+  ObjPtr<mirror::Class> FindMainClass(ScopedObjectAccess& soa)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    jobject class_loader = LoadDex("ProfileTestMultiDex");
+    StackHandleScope<1> hs(soa.Self());
+    Handle<mirror::ClassLoader> h_loader(
+        hs.NewHandle(soa.Decode<mirror::ClassLoader>(class_loader)));
+    ObjPtr<mirror::Class> klass =
+        class_linker_->FindClass(soa.Self(), "LMain;", h_loader);
+    CHECK(klass != nullptr);
+    return klass;
+  }
+
+  ArtMethod* FindMethod(ObjPtr<mirror::Class> klass, const char* name)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    ArtMethod* method = klass->FindClassMethod(name, "()Ljava/lang/String;", kRuntimePointerSize);
+    CHECK(method != nullptr);
+    return method;
+  }
+};
+
+TEST_F(JitWarmStartTest, SeedHotMethods) {
+  ScopedObjectAccess soa(Thread::Current());
+  ObjPtr<mirror::Class> klass = FindMainClass(soa);
+  ArtMethod* get_a = FindMethod(klass, "getA");
+  ArtMethod* get_b = FindMethod(klass, "getB");
+  ArtMethod* get_c = FindMethod(klass, "getC");
+  get_c->SetCounter(100);
+
+  std::unique_ptr<ProfileCompilationInfo> profile(new ProfileCompilationInfo());
+  ASSERT_TRUE(profile->AddMethodIndex(
+      Hotness::kFlagHot, MethodReference(get_a->GetDexFile(), get_a->GetDexMethodIndex())));
+  ASSERT_TRUE(profile->AddMethodIndex(
+      Hotness::kFlagHot, MethodReference(get_c->GetDexFile(), get_c->GetDexMethodIndex())));
+  JitWarmStart warm_start(std::move(profile), /* seed_counter */ 42);
+  warm_start.SeedClass(klass);
+
+  EXPECT_EQ(42u, get_a->GetCounter());
+  // Not hot in the profile.
+  EXPECT_EQ(0u, get_b->GetCounter());
+  // Already hotter than the seed.
+  EXPECT_EQ(100u, get_c->GetCounter());
+  EXPECT_EQ(1u, warm_start.GetNumberOfSeededMethods());
+}
+
+TEST_F(JitWarmStartTest, IgnoreStaleProfile) {
+  ScopedObjectAccess soa(Thread::Current());
+  ObjPtr<mirror::Class> klass = FindMainClass(soa);
+  ArtMethod* get_a = FindMethod(klass, "getA");
+  const DexFile* dex_file = get_a->GetDexFile();
+
+  // A profile recorded for another version of the dex file.
+  std::unique_ptr<ProfileCompilationInfo> profile(new ProfileCompilationInfo());
+  ASSERT_TRUE(profile->AddMethodIndex(Hotness::kFlagHot,
+                                      dex_file->GetLocation(),
+                                      dex_file->GetLocationChecksum() + 1,
+                                      get_a->GetDexMethodIndex(),
+                                      dex_file->NumMethodIds()));
+  JitWarmStart warm_start(std::move(profile), /* seed_counter */ 42);
+  warm_start.SeedClass(klass);
+
+  EXPECT_EQ(0u, get_a->GetCounter());
+  EXPECT_EQ(0u, warm_start.GetNumberOfSeededMethods());
+}
+
+}  // namespace jit
+}  // namespace art
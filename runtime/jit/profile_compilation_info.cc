@@ -52,10 +52,9 @@
 namespace art {
 
 const uint8_t ProfileCompilationInfo::kProfileMagic[] = { 'p', 'r', 'o', '\0' };
-// Last profile version: merge profiles directly from the file without creating
-// profile_compilation_info object. All the profile line headers are now placed together
-// before corresponding method_encodings and class_ids.
-const uint8_t ProfileCompilationInfo::kProfileVersion[] = { '0', '1', '0', '\0' };
+// Last profile version: add the taken and not-taken counts of the conditional branches
+// of each method after its inline caches.
+const uint8_t ProfileCompilationInfo::kProfileVersion[] = { '0', '1', '1', '\0' };
 
 // The name of the profile entry in the dex metadata file.
 // DO NOT CHANGE THIS! (it's similar to classes.dex in the apk files).
@@ -332,7 +331,10 @@ static constexpr size_t kLineHeaderSize =
  * profile_line_data:
  *   method_encoding_1,method_encoding_2...,class_id1,class_id2...,startup/post startup bitmap
  * The method_encoding is:
- *    method_id,number_of_inline_caches,inline_cache1,inline_cache2...
+ *    method_id,number_of_inline_caches,inline_cache1,inline_cache2...,
+ *    number_of_branches,branch1,branch2...
+ * The branch is:
+ *    dex_pc,taken_count,not_taken_count
  * The inline_cache is:
  *    dex_pc,[M|dex_map_size], dex_profile_index,class_id1,class_id2...,dex_profile_index2,...
  *    dex_map_size is the number of dex_indeces that follows.
@@ -426,6 +428,9 @@ bool ProfileCompilationInfo::Save(int fd) {
       last_method_index = method_it.first;
       AddUintToBuffer(&buffer, diff_with_last_method_index);
       AddInlineCacheToBuffer(&buffer, method_it.second);
+      auto branch_it = dex_data.branch_map.find(method_it.first);
+      AddBranchesToBuffer(&buffer,
+                          branch_it == dex_data.branch_map.end() ? nullptr : &branch_it->second);
     }
 
     uint16_t last_class_index = 0;
@@ -527,9 +532,30 @@ void ProfileCompilationInfo::AddInlineCacheToBuffer(std::vector<uint8_t>* buffer
   }
 }
 
+void ProfileCompilationInfo::AddBranchesToBuffer(std::vector<uint8_t>* buffer,
+                                                 const BranchMap* branch_map) {
+  // Add branch map size.
+  if (branch_map == nullptr) {
+    AddUintToBuffer(buffer, static_cast<uint16_t>(0));
+    return;
+  }
+  AddUintToBuffer(buffer, static_cast<uint16_t>(branch_map->size()));
+  for (const auto& branch_it : *branch_map) {
+    AddUintToBuffer(buffer, branch_it.first);  // dex pc
+    AddUintToBuffer(buffer, branch_it.second.taken_count);
+    AddUintToBuffer(buffer, branch_it.second.not_taken_count);
+  }
+}
+
 uint32_t ProfileCompilationInfo::GetMethodsRegionSize(const DexFileData& dex_data) {
-  // ((uint16_t)method index + (uint16_t)inline cache size) * number of methods
-  uint32_t size = 2 * sizeof(uint16_t) * dex_data.method_map.size();
+  // ((uint16_t)method index + (uint16_t)inline cache size + (uint16_t)branch map size)
+  //     * number of methods
+  uint32_t size = 3 * sizeof(uint16_t) * dex_data.method_map.size();
+  for (const auto& branch_it : dex_data.branch_map) {
+    DCHECK(dex_data.method_map.find(branch_it.first) != dex_data.method_map.end());
+    // (uint16_t)dex_pc + (uint16_t)taken count + (uint16_t)not taken count
+    size += 3 * sizeof(uint16_t) * branch_it.second.size();
+  }
   for (const auto& method_it : dex_data.method_map) {
     const InlineCacheMap& inline_cache = method_it.second;
     size += sizeof(uint16_t) * inline_cache.size();  // dex_pc
@@ -712,6 +738,20 @@ bool ProfileCompilationInfo::AddMethod(const ProfileMethodInfo& pmi, MethodHotne
   }
   data->SetMethodHotness(pmi.ref.index, flags);
 
+  if (!pmi.branches.empty()) {
+    BranchMap* branches = data->FindOrAddBranches(pmi.ref.index);
+    for (const ProfileMethodInfo::ProfileBranch& branch : pmi.branches) {
+      // Dex pcs are encoded on 16 bits, as for inline caches.
+      if (branch.dex_pc <= std::numeric_limits<uint16_t>::max()) {
+        branches->FindOrAdd(static_cast<uint16_t>(branch.dex_pc))->second.Add(
+            branch.taken_count, branch.not_taken_count);
+      }
+    }
+    if (branches->empty()) {
+      data->branch_map.erase(pmi.ref.index);
+    }
+  }
+
   for (const ProfileMethodInfo::ProfileInlineCache& cache : pmi.inline_caches) {
     if (cache.is_missing_types) {
       FindOrAddDexPc(inline_cache, cache.dex_pc)->SetIsMissingTypes();
@@ -803,10 +843,33 @@ bool ProfileCompilationInfo::ReadInlineCache(
   return true;
 }
 
+bool ProfileCompilationInfo::ReadBranches(SafeBuffer& buffer,
+                                          DexFileData* data,
+                                          uint16_t method_index,
+                                          /*out*/ std::string* error) {
+  uint16_t branch_map_size;
+  READ_UINT(uint16_t, buffer, branch_map_size, error);
+  if (branch_map_size == 0) {
+    return true;
+  }
+  BranchMap* branches = data->FindOrAddBranches(method_index);
+  for (; branch_map_size > 0; branch_map_size--) {
+    uint16_t dex_pc;
+    uint16_t taken_count;
+    uint16_t not_taken_count;
+    READ_UINT(uint16_t, buffer, dex_pc, error);
+    READ_UINT(uint16_t, buffer, taken_count, error);
+    READ_UINT(uint16_t, buffer, not_taken_count, error);
+    branches->FindOrAdd(dex_pc)->second.Add(taken_count, not_taken_count);
+  }
+  return true;
+}
+
 bool ProfileCompilationInfo::ReadMethods(SafeBuffer& buffer,
                                          uint8_t number_of_dex_files,
                                          const ProfileLineHeader& line_header,
                                          const SafeMap<uint8_t, uint8_t>& dex_profile_index_remap,
+                                         DexFileData* data,
                                          /*out*/std::string* error) {
   uint32_t unread_bytes_before_operation = buffer.CountUnreadBytes();
   if (unread_bytes_before_operation < line_header.method_region_size_bytes) {
@@ -817,9 +880,6 @@ bool ProfileCompilationInfo::ReadMethods(SafeBuffer& buffer,
       - line_header.method_region_size_bytes;
   uint16_t last_method_index = 0;
   while (buffer.CountUnreadBytes() > expected_unread_bytes_after_operation) {
-    DexFileData* const data = GetOrAddDexFileData(line_header.dex_location,
-                                                  line_header.checksum,
-                                                  line_header.num_method_ids);
     uint16_t diff_with_last_method_index;
     READ_UINT(uint16_t, buffer, diff_with_last_method_index, error);
     uint16_t method_index = last_method_index + diff_with_last_method_index;
@@ -835,6 +895,9 @@ bool ProfileCompilationInfo::ReadMethods(SafeBuffer& buffer,
                          error)) {
       return false;
     }
+    if (!ReadBranches(buffer, data, method_index, error)) {
+      return false;
+    }
   }
   uint32_t total_bytes_read = unread_bytes_before_operation - buffer.CountUnreadBytes();
   if (total_bytes_read != line_header.method_region_size_bytes) {
@@ -846,6 +909,7 @@ bool ProfileCompilationInfo::ReadMethods(SafeBuffer& buffer,
 
 bool ProfileCompilationInfo::ReadClasses(SafeBuffer& buffer,
                                          const ProfileLineHeader& line_header,
+                                         DexFileData* data,
                                          /*out*/std::string* error) {
   size_t unread_bytes_before_op = buffer.CountUnreadBytes();
   if (unread_bytes_before_op < line_header.class_set_size) {
@@ -859,12 +923,9 @@ bool ProfileCompilationInfo::ReadClasses(SafeBuffer& buffer,
     READ_UINT(uint16_t, buffer, diff_with_last_class_index, error);
     uint16_t type_index = last_class_index + diff_with_last_class_index;
     last_class_index = type_index;
-    if (!AddClassIndex(line_header.dex_location,
-                       line_header.checksum,
-                       dex::TypeIndex(type_index),
-                       line_header.num_method_ids)) {
-      return false;
-    }
+    // Classes are written in increasing order, so hinting the insertion at the end of the
+    // set makes loading a line linear in the number of classes when the set starts empty.
+    data->class_set.insert(data->class_set.end(), dex::TypeIndex(type_index));
   }
   size_t total_bytes_read = unread_bytes_before_op - buffer.CountUnreadBytes();
   uint32_t expected_bytes_read = line_header.class_set_size * sizeof(uint16_t);
@@ -1035,14 +1096,27 @@ ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::ReadProfileLin
     return kProfileLoadBadData;
   }
 
-  if (!ReadMethods(buffer, number_of_dex_files, line_header, dex_profile_index_remap, error)) {
+  if (!ReadMethods(buffer,
+                   number_of_dex_files,
+                   line_header,
+                   dex_profile_index_remap,
+                   data,
+                   error)) {
     return kProfileLoadBadData;
   }
 
   if (merge_classes) {
-    if (!ReadClasses(buffer, line_header, error)) {
+    if (!ReadClasses(buffer, line_header, data, error)) {
+      return kProfileLoadBadData;
+    }
+  } else {
+    // Skip the classes but keep the buffer in sync for the method bitmap that follows.
+    const size_t class_bytes = line_header.class_set_size * sizeof(uint16_t);
+    if (buffer.CountUnreadBytes() < class_bytes) {
+      *error += "Profile EOF reached prematurely for ReadClasses";
       return kProfileLoadBadData;
     }
+    buffer.Advance(class_bytes);
   }
 
   const size_t bytes = data->bitmap_storage.size();
@@ -1547,6 +1621,15 @@ bool ProfileCompilationInfo::MergeWith(const ProfileCompilationInfo& other,
       }
     }
 
+    // Merge the branch profiles.
+    for (const auto& other_branch_it : other_dex_data->branch_map) {
+      BranchMap* branches = dex_data->FindOrAddBranches(other_branch_it.first);
+      for (const auto& other_counts_it : other_branch_it.second) {
+        branches->FindOrAdd(other_counts_it.first)->second.Add(
+            other_counts_it.second.taken_count, other_counts_it.second.not_taken_count);
+      }
+    }
+
     // Merge the method bitmaps.
     dex_data->MergeBitmap(*other_dex_data);
   }
@@ -1610,6 +1693,16 @@ std::unique_ptr<ProfileCompilationInfo::OfflineProfileMethodInfo> ProfileCompila
 }
 
 
+const ProfileCompilationInfo::BranchMap* ProfileCompilationInfo::GetMethodBranches(
+    const MethodReference& method_ref) const {
+  const DexFileData* dex_data = FindDexData(method_ref.dex_file);
+  if (dex_data == nullptr) {
+    return nullptr;
+  }
+  auto it = dex_data->branch_map.find(method_ref.index);
+  return it == dex_data->branch_map.end() ? nullptr : &it->second;
+}
+
 bool ProfileCompilationInfo::ContainsClass(const DexFile& dex_file, dex::TypeIndex type_idx) const {
   const DexFileData* dex_data = FindDexData(&dex_file);
   if (dex_data != nullptr) {
@@ -1705,6 +1798,13 @@ std::string ProfileCompilationInfo::DumpInfo(const std::vector<const DexFile*>*
         }
         os << "}";
       }
+      auto branch_it = dex_data->branch_map.find(method_it.first);
+      if (branch_it != dex_data->branch_map.end()) {
+        for (const auto& counts_it : branch_it->second) {
+          os << "<" << std::hex << counts_it.first << std::dec << ":"
+             << counts_it.second.taken_count << "/" << counts_it.second.not_taken_count << ">";
+        }
+      }
       os << "], ";
     }
     bool startup = true;
@@ -1972,6 +2072,27 @@ ProfileCompilationInfo::DexFileData::FindOrAddMethod(uint16_t method_index) {
       InlineCacheMap(std::less<uint16_t>(), allocator_->Adapter(kArenaAllocProfile)))->second);
 }
 
+ProfileCompilationInfo::BranchMap*
+ProfileCompilationInfo::DexFileData::FindOrAddBranches(uint16_t method_index) {
+  DCHECK(method_map.find(method_index) != method_map.end());
+  return &(branch_map.FindOrAdd(
+      method_index,
+      BranchMap(std::less<uint16_t>(), allocator_->Adapter(kArenaAllocProfile)))->second);
+}
+
+void ProfileCompilationInfo::BranchCounts::Add(uint16_t taken, uint16_t not_taken) {
+  uint32_t new_taken_count = taken_count + taken;
+  uint32_t new_not_taken_count = not_taken_count + not_taken;
+  // Keep the bias of the branch, instead of saturating.
+  while (new_taken_count > std::numeric_limits<uint16_t>::max() ||
+         new_not_taken_count > std::numeric_limits<uint16_t>::max()) {
+    new_taken_count /= 2;
+    new_not_taken_count /= 2;
+  }
+  taken_count = static_cast<uint16_t>(new_taken_count);
+  not_taken_count = static_cast<uint16_t>(new_not_taken_count);
+}
+
 // Mark a method as executed at least once.
 bool ProfileCompilationInfo::DexFileData::AddMethod(MethodHotness::Flag flags, size_t index) {
   if (index >= num_method_ids) {
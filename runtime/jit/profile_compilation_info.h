@@ -50,14 +50,31 @@ struct ProfileMethodInfo {
     const std::vector<TypeReference> classes;
   };
 
+  struct ProfileBranch {
+    ProfileBranch(uint32_t pc, uint16_t taken, uint16_t not_taken)
+        : dex_pc(pc), taken_count(taken), not_taken_count(not_taken) {}
+
+    const uint32_t dex_pc;
+    const uint16_t taken_count;
+    const uint16_t not_taken_count;
+  };
+
   explicit ProfileMethodInfo(MethodReference reference) : ref(reference) {}
 
   ProfileMethodInfo(MethodReference reference, const std::vector<ProfileInlineCache>& caches)
       : ref(reference),
         inline_caches(caches) {}
 
+  ProfileMethodInfo(MethodReference reference,
+                    const std::vector<ProfileInlineCache>& caches,
+                    const std::vector<ProfileBranch>& branch_counts)
+      : ref(reference),
+        inline_caches(caches),
+        branches(branch_counts) {}
+
   MethodReference ref;
   std::vector<ProfileInlineCache> inline_caches;
+  std::vector<ProfileBranch> branches;
 };
 
 /**
@@ -171,6 +188,25 @@ class ProfileCompilationInfo {
   // Maps a method dex index to its inline cache.
   using MethodMap = ArenaSafeMap<uint16_t, InlineCacheMap>;
 
+  // How often a conditional branch was taken and not taken. The counts are both
+  // halved when one of them would overflow, so they only give the bias of the branch.
+  struct BranchCounts {
+    BranchCounts() : taken_count(0), not_taken_count(0) {}
+    void Add(uint16_t taken, uint16_t not_taken);
+    bool operator==(const BranchCounts& other) const {
+      return taken_count == other.taken_count && not_taken_count == other.not_taken_count;
+    }
+
+    uint16_t taken_count;
+    uint16_t not_taken_count;
+  };
+
+  // The branch map: DexPc -> BranchCounts.
+  using BranchMap = ArenaSafeMap<uint16_t, BranchCounts>;
+
+  // Maps a method dex index to the profile of its conditional branches.
+  using MethodBranchMap = ArenaSafeMap<uint16_t, BranchMap>;
+
   // Profile method hotness information for a single method. Also includes a pointer to the inline
   // cache map.
   class MethodHotness {
@@ -372,6 +408,11 @@ class ProfileCompilationInfo {
                                                       uint32_t dex_checksum,
                                                       uint16_t dex_method_index) const;
 
+  // Return the conditional branch profile of the given method, or null if there is none.
+  // Note: the map is stored in the profile and its allocation will go away if the
+  // profile goes out of scope.
+  const BranchMap* GetMethodBranches(const MethodReference& method_ref) const;
+
   // Dump all the loaded profile info into a string and returns it.
   // If dex_files is not null then the method indices will be resolved to their
   // names.
@@ -474,6 +515,7 @@ class ProfileCompilationInfo {
           profile_index(index),
           checksum(location_checksum),
           method_map(std::less<uint16_t>(), allocator->Adapter(kArenaAllocProfile)),
+          branch_map(std::less<uint16_t>(), allocator->Adapter(kArenaAllocProfile)),
           class_set(std::less<dex::TypeIndex>(), allocator->Adapter(kArenaAllocProfile)),
           num_method_ids(num_methods),
           bitmap_storage(allocator->Adapter(kArenaAllocProfile)) {
@@ -493,7 +535,9 @@ class ProfileCompilationInfo {
     }
 
     bool operator==(const DexFileData& other) const {
-      return checksum == other.checksum && method_map == other.method_map;
+      return checksum == other.checksum &&
+          method_map == other.method_map &&
+          branch_map == other.branch_map;
     }
 
     // Mark a method as executed at least once.
@@ -519,12 +563,17 @@ class ProfileCompilationInfo {
     uint32_t checksum;
     // The methonds' profile information.
     MethodMap method_map;
+    // The branch profiles of methods in `method_map`.
+    MethodBranchMap branch_map;
     // The classes which have been profiled. Note that these don't necessarily include
     // all the classes that can be found in the inline caches reference.
     ArenaSet<dex::TypeIndex> class_set;
     // Find the inline caches of the the given method index. Add an empty entry if
     // no previous data is found.
     InlineCacheMap* FindOrAddMethod(uint16_t method_index);
+    // Find the branch profile of the given method index. Add an empty entry if
+    // no previous data is found.
+    BranchMap* FindOrAddBranches(uint16_t method_index);
     // Num method ids.
     uint32_t num_method_ids;
     ArenaVector<uint8_t> bitmap_storage;
@@ -747,16 +796,18 @@ class ProfileCompilationInfo {
                                     bool merge_classes,
                                     /*out*/std::string* error);
 
-  // Read all the classes from the buffer into the profile `info_` structure.
+  // Read all the classes of the profile line from the buffer into `data`.
   bool ReadClasses(SafeBuffer& buffer,
                    const ProfileLineHeader& line_header,
+                   /*out*/DexFileData* data,
                    /*out*/std::string* error);
 
-  // Read all the methods from the buffer into the profile `info_` structure.
+  // Read all the methods of the profile line from the buffer into `data`.
   bool ReadMethods(SafeBuffer& buffer,
                    uint8_t number_of_dex_files,
                    const ProfileLineHeader& line_header,
                    const SafeMap<uint8_t, uint8_t>& dex_profile_index_remap,
+                   /*out*/DexFileData* data,
                    /*out*/std::string* error);
 
   // The method generates mapping of profile indices while merging a new profile
@@ -772,10 +823,20 @@ class ProfileCompilationInfo {
                        /*out*/InlineCacheMap* inline_cache,
                        /*out*/std::string* error);
 
+  // Read the branch profile encoding of `method_index` from line_bufer into `data`.
+  bool ReadBranches(SafeBuffer& buffer,
+                    DexFileData* data,
+                    uint16_t method_index,
+                    /*out*/std::string* error);
+
   // Encode the inline cache into the given buffer.
   void AddInlineCacheToBuffer(std::vector<uint8_t>* buffer,
                               const InlineCacheMap& inline_cache);
 
+  // Encode the branch profile of a method into the given buffer. `branch_map` is
+  // null if the method has no branch profile.
+  void AddBranchesToBuffer(std::vector<uint8_t>* buffer, const BranchMap* branch_map);
+
   // Return the number of bytes needed to encode the profile information
   // for the methods in dex_data.
   uint32_t GetMethodsRegionSize(const DexFileData& dex_data);
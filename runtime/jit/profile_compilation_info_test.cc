@@ -764,6 +764,63 @@ TEST_F(ProfileCompilationInfoTest, SaveArtMethodsWithInlineCaches) {
   }
 }
 
+TEST_F(ProfileCompilationInfoTest, SaveArtMethodsWithBranches) {
+  ScratchFile profile;
+
+  Thread* self = Thread::Current();
+  jobject class_loader;
+  {
+    ScopedObjectAccess soa(self);
+    class_loader = LoadDex("ProfileTestMultiDex");
+  }
+  ASSERT_NE(class_loader, nullptr);
+
+  std::vector<ArtMethod*> main_methods = GetVirtualMethods(class_loader, "LMain;");
+  ASSERT_FALSE(main_methods.empty());
+  ProfileCompilationInfo info;
+  {
+    ScopedObjectAccess soa(self);
+    ArtMethod* m = main_methods[0];
+    std::vector<ProfileMethodInfo::ProfileBranch> branches;
+    branches.emplace_back(/* dex_pc */ 3, /* taken */ 10, /* not_taken */ 1);
+    branches.emplace_back(/* dex_pc */ 7, /* taken */ 0xfff0, /* not_taken */ 0x8000);
+    std::vector<ProfileMethodInfo> profile_methods;
+    profile_methods.emplace_back(MethodReference(m->GetDexFile(), m->GetDexMethodIndex()),
+                                 std::vector<ProfileMethodInfo::ProfileInlineCache>(),
+                                 branches);
+    ASSERT_TRUE(info.AddMethods(profile_methods, Hotness::kFlagHot));
+  }
+  ASSERT_TRUE(info.Save(GetFd(profile)));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+
+  // Check that the branches survive a save and load.
+  ProfileCompilationInfo loaded_info;
+  ASSERT_TRUE(profile.GetFile()->ResetOffset());
+  ASSERT_TRUE(loaded_info.Load(GetFd(profile)));
+  ASSERT_TRUE(loaded_info.Equals(info));
+
+  // Merging adds the counts, halving both when one of them would overflow.
+  ASSERT_TRUE(loaded_info.MergeWith(info));
+  {
+    ScopedObjectAccess soa(self);
+    ArtMethod* m = main_methods[0];
+    const ProfileCompilationInfo::BranchMap* branches =
+        loaded_info.GetMethodBranches(MethodReference(m->GetDexFile(), m->GetDexMethodIndex()));
+    ASSERT_TRUE(branches != nullptr);
+    ASSERT_EQ(2u, branches->size());
+    EXPECT_EQ(20u, branches->Get(3).taken_count);
+    EXPECT_EQ(2u, branches->Get(3).not_taken_count);
+    EXPECT_EQ(0xfff0u, branches->Get(7).taken_count);
+    EXPECT_EQ(0x8000u, branches->Get(7).not_taken_count);
+
+    ArtMethod* other = main_methods.back();
+    if (other != m) {
+      EXPECT_TRUE(loaded_info.GetMethodBranches(
+          MethodReference(other->GetDexFile(), other->GetDexMethodIndex())) == nullptr);
+    }
+  }
+}
+
 TEST_F(ProfileCompilationInfoTest, InvalidChecksumInInlineCache) {
   ScratchFile profile;
 
@@ -1340,6 +1397,41 @@ TEST_F(ProfileCompilationInfoTest, FilteredLoadingWithClasses) {
 }
 
 
+TEST_F(ProfileCompilationInfoTest, LoadWithoutClasses) {
+  ScratchFile profile;
+
+  // Save a profile with 2 dex files containing both methods and classes.
+  ProfileCompilationInfo saved_info;
+  uint16_t item_count = 100;
+  for (uint16_t i = 0; i < item_count; i++) {
+    ASSERT_TRUE(AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ i, &saved_info));
+    ASSERT_TRUE(AddMethod("dex_location2", /* checksum */ 2, /* method_idx */ i, &saved_info));
+    ASSERT_TRUE(AddClass("dex_location1", /* checksum */ 1, dex::TypeIndex(i), &saved_info));
+    ASSERT_TRUE(AddClass("dex_location2", /* checksum */ 2, dex::TypeIndex(i), &saved_info));
+  }
+
+  ASSERT_TRUE(saved_info.Save(GetFd(profile)));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+
+  // Load without the classes. The class data must be skipped, not misread as the
+  // method bitmap.
+  ProfileCompilationInfo loaded_info;
+  ASSERT_TRUE(profile.GetFile()->ResetOffset());
+  ASSERT_TRUE(loaded_info.Load(GetFd(profile), /* merge_classes */ false));
+
+  // Compute the expectation.
+  ProfileCompilationInfo expected_info;
+  for (uint16_t i = 0; i < item_count; i++) {
+    ASSERT_TRUE(AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ i, &expected_info));
+    ASSERT_TRUE(AddMethod("dex_location2", /* checksum */ 2, /* method_idx */ i, &expected_info));
+  }
+
+  // Validate the expectation.
+  ASSERT_TRUE(loaded_info.Equals(expected_info));
+  ASSERT_EQ(0u, loaded_info.GetNumberOfResolvedClasses());
+}
+
+
 TEST_F(ProfileCompilationInfoTest, ClearData) {
   ProfileCompilationInfo info;
   for (uint16_t i = 0; i < 10; i++) {
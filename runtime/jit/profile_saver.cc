@@ -21,15 +21,20 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <map>
+#include <vector>
+
 #include "android-base/strings.h"
 
 #include "art_method-inl.h"
+#include "barrier.h"
 #include "base/enums.h"
 #include "base/logging.h"  // For VLOG.
 #include "base/scoped_arena_containers.h"
 #include "base/stl_util.h"
 #include "base/systrace.h"
 #include "base/time_utils.h"
+#include "class_linker.h"
 #include "class_table-inl.h"
 #include "compiler_filter.h"
 #include "dex/dex_file_loader.h"
@@ -40,11 +45,13 @@
 #include "jit/profile_compilation_info.h"
 #include "oat_file_manager.h"
 #include "scoped_thread_state_change-inl.h"
+#include "thread_list.h"
 
 namespace art {
 
 ProfileSaver* ProfileSaver::instance_ = nullptr;
 pthread_t ProfileSaver::profiler_pthread_ = 0U;
+Atomic<bool> ProfileSaver::collect_samples_(false);
 
 // At what priority to schedule the saver threads. 9 is the lowest foreground priority on device.
 static constexpr int kProfileSaverPthreadPriority = 9;
@@ -379,6 +386,95 @@ static void SampleClassesAndExecutedMethods(pthread_t profiler_pthread,
   }
 }
 
+// Moves the methods each thread recorded through ProfileSaver::NotifyMethodSampled() into
+// shared vectors.
+class CollectSampledMethodsClosure FINAL : public Closure {
+ public:
+  CollectSampledMethodsClosure(Barrier* barrier,
+                               std::vector<MethodReference>* warm_methods,
+                               std::vector<MethodReference>* sampled_methods)
+      : barrier_(barrier),
+        lock_("Collect sampled methods lock"),
+        warm_methods_(warm_methods),
+        sampled_methods_(sampled_methods) {}
+
+  void Run(Thread* thread) OVERRIDE REQUIRES_SHARED(Locks::mutator_lock_) {
+    DCHECK(thread == Thread::Current() || thread->IsSuspended());
+    std::vector<MethodReference> warm_methods;
+    std::vector<MethodReference> sampled_methods;
+    warm_methods.swap(*thread->GetProfileWarmMethods());
+    sampled_methods.swap(*thread->GetProfileSampledMethods());
+    {
+      MutexLock mu(Thread::Current(), lock_);
+      warm_methods_->insert(warm_methods_->end(), warm_methods.begin(), warm_methods.end());
+      sampled_methods_->insert(
+          sampled_methods_->end(), sampled_methods.begin(), sampled_methods.end());
+    }
+    barrier_->Pass(Thread::Current());
+  }
+
+ private:
+  Barrier* const barrier_;
+  Mutex lock_;
+  std::vector<MethodReference>* const warm_methods_ GUARDED_BY(lock_);
+  std::vector<MethodReference>* const sampled_methods_ GUARDED_BY(lock_);
+};
+
+// Collect the methods which threads executed for the first time or made warm since the last
+// collection. Unlike SampleClassesAndExecutedMethods(), the cost of this depends on how many
+// methods changed state, not on how many methods are loaded.
+// Methods recorded by threads which exited before the collection are not seen.
+static void CollectSampledMethods(MethodReferenceCollection* hot_methods,
+                                  MethodReferenceCollection* sampled_methods) {
+  Thread* const self = Thread::Current();
+  std::vector<MethodReference> warm_refs;
+  std::vector<MethodReference> sampled_refs;
+  ScopedObjectAccess soa(self);
+  {
+    Barrier barrier(0);
+    CollectSampledMethodsClosure closure(&barrier, &warm_refs, &sampled_refs);
+    size_t threads_running_checkpoint =
+        Runtime::Current()->GetThreadList()->RunCheckpoint(&closure);
+    // Now that we have run our checkpoint, move to a suspended state and wait
+    // for other threads to run the checkpoint.
+    ScopedThreadSuspension sts(self, kSuspended);
+    if (threads_running_checkpoint != 0) {
+      barrier.Increment(self, threads_running_checkpoint);
+    }
+  }
+  // The references were recorded before the checkpoint, so the dex files of class loaders
+  // unloaded since may be gone. Only keep references to dex files which are still registered.
+  ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
+  std::map<const DexFile*, bool> is_registered;
+  auto add_references = [&](const std::vector<MethodReference>& refs,
+                            MethodReferenceCollection* out) REQUIRES_SHARED(Locks::mutator_lock_) {
+    for (const MethodReference& ref : refs) {
+      auto it = is_registered.find(ref.dex_file);
+      if (it == is_registered.end()) {
+        it = is_registered.emplace(ref.dex_file,
+                                   class_linker->IsDexFileRegistered(self, *ref.dex_file)).first;
+      }
+      if (it->second) {
+        out->AddReference(ref.dex_file, ref.index);
+      }
+    }
+  };
+  add_references(warm_refs, hot_methods);
+  add_references(sampled_refs, sampled_methods);
+}
+
+void ProfileSaver::NotifyMethodSampled(Thread* self, ArtMethod* method, bool warm) {
+  if (!collect_samples_.LoadRelaxed()) {
+    return;
+  }
+  MethodReference ref(method->GetDexFile(), method->GetDexMethodIndex());
+  if (warm) {
+    self->GetProfileWarmMethods()->push_back(ref);
+  } else {
+    self->GetProfileSampledMethods()->push_back(ref);
+  }
+}
+
 void ProfileSaver::FetchAndCacheResolvedClassesAndMethods(bool startup) {
   ScopedTrace trace(__PRETTY_FUNCTION__);
   const uint64_t start_time = NanoTime();
@@ -402,14 +498,20 @@ void ProfileSaver::FetchAndCacheResolvedClassesAndMethods(bool startup) {
   const uint32_t hot_method_sample_threshold = startup ?
       options_.GetHotStartupMethodSamples(is_low_ram) :
       std::numeric_limits<uint32_t>::max();
-  SampleClassesAndExecutedMethods(profiler_pthread,
-                                  options_.GetProfileBootClassPath(),
-                                  &allocator,
-                                  hot_method_sample_threshold,
-                                  startup,
-                                  &resolved_classes,
-                                  &hot_methods,
-                                  &sampled_methods);
+  if (startup) {
+    SampleClassesAndExecutedMethods(profiler_pthread,
+                                    options_.GetProfileBootClassPath(),
+                                    &allocator,
+                                    hot_method_sample_threshold,
+                                    startup,
+                                    &resolved_classes,
+                                    &hot_methods,
+                                    &sampled_methods);
+  } else {
+    // Classes are only recorded at startup, and every method which executed since then has
+    // been recorded by the thread executing it. Avoid walking all the loaded classes again.
+    CollectSampledMethods(&hot_methods, &sampled_methods);
+  }
   MutexLock mu(self, *Locks::profiler_lock_);
   uint64_t total_number_of_profile_entries_cached = 0;
   using Hotness = ProfileCompilationInfo::MethodHotness;
@@ -514,6 +616,18 @@ bool ProfileSaver::ProcessProfilingInfo(bool force_save, /*out*/uint16_t* number
       jit_code_cache_->GetProfiledMethods(locations, profile_methods);
       total_number_of_code_cache_queries_++;
     }
+    if (!force_save &&
+        profile_methods.size() < options_.GetMinMethodsToSave() &&
+        options_.GetMinClassesToSave() > 0 &&
+        profile_cache_.find(filename) == profile_cache_.end()) {
+      // Classes are only added from the startup cache, and every new method comes from
+      // `profile_methods`, so merging can not reach the save thresholds. Skip loading and
+      // parsing the file, whose cost grows with the size of the profile.
+      VLOG(profiler) << "Not enough information to save to: " << filename
+                     << " Number of profiled methods: " << profile_methods.size();
+      total_number_of_skipped_writes_++;
+      continue;
+    }
     {
       ProfileCompilationInfo info(Runtime::Current()->GetArenaPool());
       if (!info.Load(filename, /*clear_if_invalid*/ true)) {
@@ -708,6 +822,7 @@ void ProfileSaver::Start(const ProfileSaverOptions& options,
                                output_filename,
                                jit_code_cache,
                                code_paths_to_profile);
+  collect_samples_.StoreRelaxed(true);
 
   // Create a new thread which does the saving.
   CHECK_PTHREAD_CALL(
@@ -737,6 +852,7 @@ void ProfileSaver::Stop(bool dump_info) {
     }
     instance_->shutting_down_ = true;
   }
+  collect_samples_.StoreRelaxed(false);
 
   {
     // Wake up the saver thread if it is sleeping to allow for a clean exit.
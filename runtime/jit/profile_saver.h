@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_JIT_PROFILE_SAVER_H_
 #define ART_RUNTIME_JIT_PROFILE_SAVER_H_
 
+#include "base/atomic.h"
 #include "base/mutex.h"
 #include "base/safe_map.h"
 #include "dex/method_reference.h"
@@ -53,6 +54,12 @@ class ProfileSaver {
       REQUIRES(!Locks::profiler_lock_, !wait_lock_)
       NO_THREAD_SAFETY_ANALYSIS;
 
+  // Record that `method` executed for the first time, or became warm if `warm` is true, so that
+  // the saver collects it without walking all the loaded classes. Only called on these state
+  // transitions of the method's hotness counter, hence cheap enough for the JIT sample path.
+  static void NotifyMethodSampled(Thread* self, ArtMethod* method, bool warm)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // For testing or manual purposes (SIGUSR1).
   static void ForceProcessProfiles();
 
@@ -108,6 +115,9 @@ class ProfileSaver {
   static ProfileSaver* instance_ GUARDED_BY(Locks::profiler_lock_);
   // Profile saver thread.
   static pthread_t profiler_pthread_ GUARDED_BY(Locks::profiler_lock_);
+  // Whether threads should record their newly sampled methods, i.e. whether there is a saver
+  // to collect them.
+  static Atomic<bool> collect_samples_;
 
   jit::JitCodeCache* jit_code_cache_;
 
@@ -16,6 +16,8 @@
 
 #include "profiling_info.h"
 
+#include <algorithm>
+
 #include "art_method-inl.h"
 #include "dex/dex_instruction.h"
 #include "jit/jit.h"
@@ -25,17 +27,27 @@
 
 namespace art {
 
-ProfilingInfo::ProfilingInfo(ArtMethod* method, const std::vector<uint32_t>& entries)
+ProfilingInfo::ProfilingInfo(ArtMethod* method,
+                             const std::vector<uint32_t>& entries,
+                             const std::vector<uint32_t>& branch_entries)
       : number_of_inline_caches_(entries.size()),
+        number_of_branch_caches_(branch_entries.size()),
         method_(method),
         is_method_being_compiled_(false),
         is_osr_method_being_compiled_(false),
+        residency_(0),
         current_inline_uses_(0),
         saved_entry_point_(nullptr) {
+  memset(&deoptimization_counts_, 0, sizeof(deoptimization_counts_));
   memset(&cache_, 0, number_of_inline_caches_ * sizeof(InlineCache));
   for (size_t i = 0; i < number_of_inline_caches_; ++i) {
     cache_[i].dex_pc_ = entries[i];
   }
+  BranchCache* branch_caches = GetBranchCaches();
+  memset(branch_caches, 0, number_of_branch_caches_ * sizeof(BranchCache));
+  for (size_t i = 0; i < number_of_branch_caches_; ++i) {
+    branch_caches[i].dex_pc_ = branch_entries[i];
+  }
 }
 
 bool ProfilingInfo::Create(Thread* self, ArtMethod* method, bool retry_allocation) {
@@ -43,7 +55,10 @@ bool ProfilingInfo::Create(Thread* self, ArtMethod* method, bool retry_allocatio
   // instructions we are interested in profiling.
   DCHECK(!method->IsNative());
 
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  bool profile_branches = jit->ProfileBranches();
   std::vector<uint32_t> entries;
+  std::vector<uint32_t> branch_entries;
   for (const DexInstructionPcPair& inst : method->DexInstructions()) {
     switch (inst->Opcode()) {
       case Instruction::INVOKE_VIRTUAL:
@@ -55,6 +70,23 @@ bool ProfilingInfo::Create(Thread* self, ArtMethod* method, bool retry_allocatio
         entries.push_back(inst.DexPc());
         break;
 
+      case Instruction::IF_EQ:
+      case Instruction::IF_NE:
+      case Instruction::IF_LT:
+      case Instruction::IF_GE:
+      case Instruction::IF_GT:
+      case Instruction::IF_LE:
+      case Instruction::IF_EQZ:
+      case Instruction::IF_NEZ:
+      case Instruction::IF_LTZ:
+      case Instruction::IF_GEZ:
+      case Instruction::IF_GTZ:
+      case Instruction::IF_LEZ:
+        if (profile_branches) {
+          branch_entries.push_back(inst.DexPc());
+        }
+        break;
+
       default:
         break;
     }
@@ -64,8 +96,9 @@ bool ProfilingInfo::Create(Thread* self, ArtMethod* method, bool retry_allocatio
   // interested in. The JIT code cache internally uses it.
 
   // Allocate the `ProfilingInfo` object int the JIT's data space.
-  jit::JitCodeCache* code_cache = Runtime::Current()->GetJit()->GetCodeCache();
-  return code_cache->AddProfilingInfo(self, method, entries, retry_allocation) != nullptr;
+  jit::JitCodeCache* code_cache = jit->GetCodeCache();
+  return code_cache->AddProfilingInfo(self, method, entries, branch_entries, retry_allocation)
+      != nullptr;
 }
 
 InlineCache* ProfilingInfo::GetInlineCache(uint32_t dex_pc) {
@@ -79,13 +112,46 @@ InlineCache* ProfilingInfo::GetInlineCache(uint32_t dex_pc) {
   UNREACHABLE();
 }
 
+BranchCache* ProfilingInfo::GetBranchCache(uint32_t dex_pc) {
+  BranchCache* begin = GetBranchCaches();
+  BranchCache* end = begin + number_of_branch_caches_;
+  BranchCache* it = std::lower_bound(
+      begin, end, dex_pc, [](const BranchCache& cache, uint32_t pc) {
+        return cache.dex_pc_ < pc;
+      });
+  return (it != end && it->dex_pc_ == dex_pc) ? it : nullptr;
+}
+
+void ProfilingInfo::AddBranchInfo(uint32_t dex_pc, bool taken) {
+  BranchCache* cache = GetBranchCache(dex_pc);
+  if (cache == nullptr) {
+    DCHECK_EQ(number_of_branch_caches_, 0u)
+        << "No branch cache found for " << ArtMethod::PrettyMethod(method_) << "@" << dex_pc;
+    return;
+  }
+  uint16_t* count = taken ? &cache->taken_count_ : &cache->not_taken_count_;
+  if (*count == std::numeric_limits<uint16_t>::max()) {
+    // Keep the bias of the branch, instead of saturating.
+    cache->taken_count_ /= 2;
+    cache->not_taken_count_ /= 2;
+  }
+  ++*count;
+}
+
+static void IncrementCount(uint16_t* count) {
+  if (*count != std::numeric_limits<uint16_t>::max()) {
+    ++*count;
+  }
+}
+
 void ProfilingInfo::AddInvokeInfo(uint32_t dex_pc, mirror::Class* cls) {
   InlineCache* cache = GetInlineCache(dex_pc);
   for (size_t i = 0; i < InlineCache::kIndividualCacheSize; ++i) {
     mirror::Class* existing = cache->classes_[i].Read<kWithoutReadBarrier>();
     mirror::Class* marked = ReadBarrier::IsMarked(existing);
     if (marked == cls) {
-      // Receiver type is already in the cache, nothing else to do.
+      // Receiver type is already in the cache, just count it.
+      IncrementCount(&cache->counts_[i]);
       return;
     } else if (marked == nullptr) {
       // Cache entry is empty, try to put `cls` in it.
@@ -100,13 +166,16 @@ void ProfilingInfo::AddInvokeInfo(uint32_t dex_pc, mirror::Class* cls) {
         // entry in case the entry contains `cls`.
         --i;
       } else {
-        // We successfully set `cls`, just return.
+        // We successfully set `cls`. The entry may have held a class that got unloaded,
+        // restart its count.
+        cache->counts_[i] = 1;
         return;
       }
     }
   }
   // Unsuccessfull - cache is full, making it megamorphic. We do not DCHECK it though,
   // as the garbage collector might clear the entries concurrently.
+  IncrementCount(&cache->megamorphic_count_);
 }
 
 }  // namespace art
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "base/macros.h"
+#include "deoptimization_kind.h"
 #include "gc_root.h"
 
 namespace art {
@@ -44,6 +45,11 @@ class InlineCache {
  private:
   uint32_t dex_pc_;
   GcRoot<mirror::Class> classes_[kIndividualCacheSize];
+  // How many times each of the classes was seen. The counts are not updated atomically
+  // and saturate, so they only give the relative frequency of the receivers.
+  uint16_t counts_[kIndividualCacheSize];
+  // How many times a receiver did not fit in a full cache.
+  uint16_t megamorphic_count_;
 
   friend class jit::JitCodeCache;
   friend class ProfilingInfo;
@@ -51,12 +57,45 @@ class InlineCache {
   DISALLOW_COPY_AND_ASSIGN(InlineCache);
 };
 
+// Structure to store how often a conditional branch was taken and not taken.
+class BranchCache {
+ public:
+  uint32_t GetDexPc() const {
+    return dex_pc_;
+  }
+
+  uint16_t GetTakenCount() const {
+    return taken_count_;
+  }
+
+  uint16_t GetNotTakenCount() const {
+    return not_taken_count_;
+  }
+
+ private:
+  uint32_t dex_pc_;
+  // The counts are not updated atomically, and are both halved when one of them
+  // would overflow, so they only give the bias of the branch.
+  uint16_t taken_count_;
+  uint16_t not_taken_count_;
+
+  friend class ProfilingInfo;
+
+  DISALLOW_COPY_AND_ASSIGN(BranchCache);
+};
+
 /**
  * Profiling info for a method, created and filled by the interpreter once the
  * method is warm, and used by the compiler to drive optimizations.
  */
 class ProfilingInfo {
  public:
+  // Number of deoptimizations of a given kind after which the JIT stops emitting
+  // that speculation when recompiling the method.
+  static constexpr uint8_t kMaxDeoptimizationsPerKind = 3;
+  static constexpr size_t kNumberOfDeoptimizationKinds =
+      static_cast<size_t>(DeoptimizationKind::kLast) + 1u;
+
   // Create a ProfilingInfo for 'method'. Return whether it succeeded, or if it is
   // not needed in case the method does not have virtual/interface invocations.
   static bool Create(Thread* self, ArtMethod* method, bool retry_allocation)
@@ -77,6 +116,33 @@ class ProfilingInfo {
   InlineCache* GetInlineCache(uint32_t dex_pc)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Add the outcome of an executed IF_* instruction to the profile. Does nothing
+  // if branches are not profiled.
+  void AddBranchInfo(uint32_t dex_pc, bool taken);
+
+  // Returns the branch cache for the IF_* instruction at `dex_pc`, or null if
+  // branches are not profiled.
+  BranchCache* GetBranchCache(uint32_t dex_pc);
+
+  uint32_t GetNumberOfBranchCaches() const {
+    return number_of_branch_caches_;
+  }
+
+  BranchCache* GetBranchCaches() {
+    return reinterpret_cast<BranchCache*>(&cache_[number_of_inline_caches_]);
+  }
+
+  const BranchCache* GetBranchCaches() const {
+    return reinterpret_cast<const BranchCache*>(&cache_[number_of_inline_caches_]);
+  }
+
+  // Size of the ProfilingInfo object with its inline and branch caches.
+  static size_t ComputeSize(size_t number_of_inline_caches, size_t number_of_branch_caches) {
+    return sizeof(ProfilingInfo) +
+        sizeof(InlineCache) * number_of_inline_caches +
+        sizeof(BranchCache) * number_of_branch_caches;
+  }
+
   bool IsMethodBeingCompiled(bool osr) const {
     return osr
         ? is_osr_method_being_compiled_
@@ -99,6 +165,26 @@ class ProfilingInfo {
     return saved_entry_point_;
   }
 
+  // Number of consecutive code cache polls in which the compiled code was found in use.
+  uint8_t GetResidency() const {
+    return residency_;
+  }
+
+  void IncrementResidency() {
+    if (residency_ != std::numeric_limits<uint8_t>::max()) {
+      residency_++;
+    }
+  }
+
+  void DecrementResidency() {
+    DCHECK_GT(residency_, 0u);
+    residency_--;
+  }
+
+  void ResetResidency() {
+    residency_ = 0;
+  }
+
   void ClearGcRootsInInlineCaches() {
     for (size_t i = 0; i < number_of_inline_caches_; ++i) {
       InlineCache* cache = &cache_[i];
@@ -124,17 +210,49 @@ class ProfilingInfo {
     current_inline_uses_--;
   }
 
+  // Record a deoptimization of the compiled code of the method due to a failed
+  // speculation of kind `kind`. Returns whether the speculation just got disabled.
+  bool AddDeoptimization(DeoptimizationKind kind) {
+    uint8_t& count = deoptimization_counts_[static_cast<size_t>(kind)];
+    if (count == kMaxDeoptimizationsPerKind) {
+      return false;
+    }
+    count++;
+    return count == kMaxDeoptimizationsPerKind;
+  }
+
+  uint8_t GetDeoptimizationCount(DeoptimizationKind kind) const {
+    return deoptimization_counts_[static_cast<size_t>(kind)];
+  }
+
+  // Bit mask, indexed by DeoptimizationKind, of the speculations that deoptimized the
+  // compiled code of the method too often to be worth emitting again.
+  uint32_t GetDisabledSpeculations() const {
+    uint32_t mask = 0u;
+    for (size_t i = 0; i < kNumberOfDeoptimizationKinds; ++i) {
+      if (deoptimization_counts_[i] == kMaxDeoptimizationsPerKind) {
+        mask |= 1u << i;
+      }
+    }
+    return mask;
+  }
+
   bool IsInUseByCompiler() const {
     return IsMethodBeingCompiled(/*osr*/ true) || IsMethodBeingCompiled(/*osr*/ false) ||
         (current_inline_uses_ > 0);
   }
 
  private:
-  ProfilingInfo(ArtMethod* method, const std::vector<uint32_t>& entries);
+  ProfilingInfo(ArtMethod* method,
+                const std::vector<uint32_t>& entries,
+                const std::vector<uint32_t>& branch_entries);
 
   // Number of instructions we are profiling in the ArtMethod.
   const uint32_t number_of_inline_caches_;
 
+  // Number of conditional branches we are profiling in the ArtMethod.
+  const uint32_t number_of_branch_caches_;
+
   // Method this profiling info is for.
   // Not 'const' as JVMTI introduces obsolete methods that we implement by creating new ArtMethods.
   // See JitCodeCache::MoveObsoleteMethod.
@@ -146,6 +264,14 @@ class ProfilingInfo {
   bool is_method_being_compiled_;
   bool is_osr_method_being_compiled_;
 
+  // How long the compiled code has been in use, see JitCodeCache::GarbageCollectCache.
+  // Implicitly guarded by the JIT code cache lock.
+  uint8_t residency_;
+
+  // How many times the compiled code of the method deoptimized, per DeoptimizationKind.
+  // Saturates at kMaxDeoptimizationsPerKind. Updated under the JIT code cache lock.
+  uint8_t deoptimization_counts_[kNumberOfDeoptimizationKinds];
+
   // When the compiler inlines the method associated to this ProfilingInfo,
   // it updates this counter so that the GC does not try to clear the inline caches.
   uint16_t current_inline_uses_;
@@ -154,7 +280,8 @@ class ProfilingInfo {
   // is poking for the liveness of compiled code.
   const void* saved_entry_point_;
 
-  // Dynamically allocated array of size `number_of_inline_caches_`.
+  // Dynamically allocated array of size `number_of_inline_caches_`, followed by
+  // `number_of_branch_caches_` branch caches sorted by dex pc.
   InlineCache cache_[0];
 
   friend class jit::JitCodeCache;
@@ -32,6 +32,7 @@
 #include "base/mutex.h"
 #include "base/safe_map.h"
 #include "base/stl_util.h"
+#include "cha.h"
 #include "class_linker-inl.h"
 #include "dex/dex_file-inl.h"
 #include "dex/utf.h"
@@ -151,6 +152,16 @@ static void NotifySetPrimitiveField(ArtField* field, jobject obj, JValue val)
   }
 }
 
+// The JIT folds the value of static final primitive fields of initialized classes,
+// and JNI is the only way to change them.
+static void NotifySetStaticFinalField(ArtField* field) REQUIRES_SHARED(Locks::mutator_lock_) {
+  DCHECK(field->IsStatic());
+  if (UNLIKELY(field->IsFinal()) && Runtime::Current()->UseJitCompilation()) {
+    Runtime::Current()->GetClassLinker()->GetClassHierarchyAnalysis()->
+        InvalidateFinalFieldDependents(field);
+  }
+}
+
 static void NotifyGetField(ArtField* field, jobject obj)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   instrumentation::Instrumentation* instrumentation = Runtime::Current()->GetInstrumentation();
@@ -1408,6 +1419,7 @@ class JNI {
   ScopedObjectAccess soa(env); \
   ArtField* f = jni::DecodeArtField(fid); \
   NotifySetPrimitiveField(f, nullptr, JValue::FromPrimitive<decltype(value)>(value)); \
+  NotifySetStaticFinalField(f); \
   f->Set ##fn <false>(f->GetDeclaringClass(), value)
 
   static jboolean GetBooleanField(JNIEnv* env, jobject obj, jfieldID fid) {
@@ -1879,13 +1891,7 @@ class JNI {
     if (heap->IsMovableObject(s)) {
       StackHandleScope<1> hs(soa.Self());
       HandleWrapperObjPtr<mirror::String> h(hs.NewHandleWrapper(&s));
-      if (!kUseReadBarrier) {
-        heap->IncrementDisableMovingGC(soa.Self());
-      } else {
-        // For the CC collector, we only need to wait for the thread flip rather than the whole GC
-        // to occur thanks to the to-space invariant.
-        heap->IncrementDisableThreadFlip(soa.Self());
-      }
+      heap->PinObjectForCriticalSection(soa.Self(), s);
     }
     if (s->IsCompressed()) {
       if (is_copy != nullptr) {
@@ -1913,11 +1919,7 @@ class JNI {
     gc::Heap* heap = Runtime::Current()->GetHeap();
     ObjPtr<mirror::String> s = soa.Decode<mirror::String>(java_string);
     if (heap->IsMovableObject(s)) {
-      if (!kUseReadBarrier) {
-        heap->DecrementDisableMovingGC(soa.Self());
-      } else {
-        heap->DecrementDisableThreadFlip(soa.Self());
-      }
+      heap->UnpinObjectForCriticalSection(soa.Self(), s);
     }
     if (s->IsCompressed() || (s->IsCompressed() == false && s->GetValue() != chars)) {
       delete[] chars;
@@ -2074,13 +2076,7 @@ class JNI {
     }
     gc::Heap* heap = Runtime::Current()->GetHeap();
     if (heap->IsMovableObject(array)) {
-      if (!kUseReadBarrier) {
-        heap->IncrementDisableMovingGC(soa.Self());
-      } else {
-        // For the CC collector, we only need to wait for the thread flip rather than the whole GC
-        // to occur thanks to the to-space invariant.
-        heap->IncrementDisableThreadFlip(soa.Self());
-      }
+      heap->PinObjectForCriticalSection(soa.Self(), array);
       // Re-decode in case the object moved since IncrementDisableGC waits for GC to complete.
       array = soa.Decode<mirror::Array>(java_array);
     }
@@ -2634,12 +2630,8 @@ class JNI {
       if (is_copy) {
         delete[] reinterpret_cast<uint64_t*>(elements);
       } else if (heap->IsMovableObject(array)) {
-        // Non copy to a movable object must means that we had disabled the moving GC.
-        if (!kUseReadBarrier) {
-          heap->DecrementDisableMovingGC(soa.Self());
-        } else {
-          heap->DecrementDisableThreadFlip(soa.Self());
-        }
+        // Non copy to a movable object must means that we had pinned it.
+        heap->UnpinObjectForCriticalSection(soa.Self(), array);
       }
     }
   }
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lock_contention_profiler.h"
+
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <tuple>
+#include <vector>
+
+#include "base/bit_utils.h"
+#include "base/time_utils.h"
+
+namespace art {
+
+Atomic<bool> LockContentionProfiler::enabled_;
+Atomic<LockContentionProfiler::Site*> LockContentionProfiler::sites_;
+
+void LockContentionProfiler::Site::Record(uint64_t wait_ns) {
+  uint64_t wait_us = wait_ns / 1000u;
+  size_t bucket = std::min<size_t>(MinimumBitsToStore(wait_us), kNumBuckets - 1u);
+  buckets_[bucket].FetchAndAddRelaxed(1u);
+  count_.FetchAndAddRelaxed(1u);
+  total_ns_.FetchAndAddRelaxed(wait_ns);
+  uint64_t max_ns = max_ns_.LoadRelaxed();
+  while (wait_ns > max_ns && !max_ns_.CompareAndSetWeakRelaxed(max_ns, wait_ns)) {
+    max_ns = max_ns_.LoadRelaxed();
+  }
+}
+
+void LockContentionProfiler::Site::SetOwnerStack(const std::string& owner_stack) {
+  std::string* sample = new std::string(owner_stack);
+  if (!owner_stack_.CompareAndSetStrongRelease(nullptr, sample)) {
+    delete sample;
+  }
+}
+
+void LockContentionProfiler::SetEnabled(bool enabled) {
+  if (enabled && sites_.LoadAcquire() == nullptr) {
+    // All atomics start at zero, i.e. all sites are free.
+    Site* sites = new Site[kMaxSites];
+    if (!sites_.CompareAndSetStrongRelease(nullptr, sites)) {
+      delete[] sites;
+    }
+  }
+  enabled_.StoreRelaxed(enabled);
+}
+
+LockContentionProfiler::Site* LockContentionProfiler::Probe(Kind kind,
+                                                            const void* key,
+                                                            uint32_t dex_pc,
+                                                            const std::string* name) {
+  Site* sites = sites_.LoadAcquire();
+  if (sites == nullptr) {
+    return nullptr;
+  }
+  size_t index = HashSite(key, dex_pc);
+  for (size_t i = 0; i != kMaxProbes; ++i, ++index) {
+    Site* site = &sites[index % kMaxSites];
+    uint32_t state = site->state_.LoadAcquire();
+    if (state == Site::kReady) {
+      if (site->kind_ == kind && site->key_ == key && site->dex_pc_ == dex_pc) {
+        return site;
+      }
+    } else if (state == Site::kFree) {
+      if (name == nullptr) {
+        return nullptr;  // The site would have been added here.
+      }
+      if (site->state_.CompareAndSetStrongRelaxed(Site::kFree, Site::kClaimed)) {
+        site->kind_ = kind;
+        site->key_ = key;
+        site->dex_pc_ = dex_pc;
+        site->name_ = *name;
+        site->state_.StoreRelease(Site::kReady);
+        return site;
+      }
+    }
+    // Skip sites that another thread is still adding.
+  }
+  return nullptr;
+}
+
+LockContentionProfiler::Site* LockContentionProfiler::FindSite(Kind kind,
+                                                               const void* key,
+                                                               uint32_t dex_pc) {
+  return Probe(kind, key, dex_pc, /* name */ nullptr);
+}
+
+LockContentionProfiler::Site* LockContentionProfiler::FindOrAddSite(Kind kind,
+                                                                    const void* key,
+                                                                    uint32_t dex_pc,
+                                                                    const std::string& name) {
+  return Probe(kind, key, dex_pc, &name);
+}
+
+void LockContentionProfiler::RecordMutexContention(const char* name, uint64_t wait_ns) {
+  Site* site = FindSite(Kind::kMutex, name, 0u);
+  if (site == nullptr) {
+    site = FindOrAddSite(Kind::kMutex, name, 0u, std::string(name));
+  }
+  if (site != nullptr) {
+    site->Record(wait_ns);
+  }
+}
+
+namespace {
+
+struct SiteSummary {
+  LockContentionProfiler::Kind kind;
+  const std::string* name;
+  uint64_t count = 0u;
+  uint64_t total_ns = 0u;
+  uint64_t max_ns = 0u;
+  uint64_t buckets[LockContentionProfiler::kNumBuckets] = {};
+  const std::string* owner_stack = nullptr;
+};
+
+// Upper bound of the waits in `bucket`.
+uint64_t BucketLimitNs(size_t bucket) {
+  return (UINT64_C(1) << bucket) * 1000u;
+}
+
+// Upper bound of the waits below the quantile `q` of `summary`.
+uint64_t QuantileLimitNs(const SiteSummary& summary, double q) {
+  uint64_t rank = static_cast<uint64_t>(q * summary.count);
+  uint64_t seen = 0u;
+  for (size_t i = 0; i != LockContentionProfiler::kNumBuckets; ++i) {
+    seen += summary.buckets[i];
+    if (seen > rank) {
+      return BucketLimitNs(i);
+    }
+  }
+  return BucketLimitNs(LockContentionProfiler::kNumBuckets - 1u);
+}
+
+}  // namespace
+
+void LockContentionProfiler::Dump(std::ostream& os) {
+  Site* sites = sites_.LoadAcquire();
+  if (sites == nullptr) {
+    return;
+  }
+  // Merge duplicate sites.
+  std::map<std::tuple<Kind, const void*, uint32_t>, SiteSummary> summaries;
+  for (size_t i = 0; i != kMaxSites; ++i) {
+    const Site& site = sites[i];
+    if (site.state_.LoadAcquire() != Site::kReady) {
+      continue;
+    }
+    SiteSummary& summary = summaries[std::make_tuple(site.kind_, site.key_, site.dex_pc_)];
+    summary.kind = site.kind_;
+    summary.name = &site.name_;
+    summary.count += site.count_.LoadRelaxed();
+    summary.total_ns += site.total_ns_.LoadRelaxed();
+    summary.max_ns = std::max(summary.max_ns, site.max_ns_.LoadRelaxed());
+    for (size_t b = 0; b != kNumBuckets; ++b) {
+      summary.buckets[b] += site.buckets_[b].LoadRelaxed();
+    }
+    if (summary.owner_stack == nullptr) {
+      summary.owner_stack = site.owner_stack_.LoadAcquire();
+    }
+  }
+  std::vector<const SiteSummary*> sorted;
+  for (const auto& entry : summaries) {
+    if (entry.second.count != 0u) {
+      sorted.push_back(&entry.second);
+    }
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const SiteSummary* lhs, const SiteSummary* rhs) {
+    return lhs->total_ns > rhs->total_ns;
+  });
+
+  os << "Lock contention profile (" << (IsEnabled() ? "enabled" : "disabled") << ", "
+     << sorted.size() << " sites):\n";
+  for (const SiteSummary* summary : sorted) {
+    os << "  " << (summary->kind == Kind::kMonitor ? "monitor at " : "mutex ") << *summary->name
+       << ": " << summary->count << " waits, total " << PrettyDuration(summary->total_ns)
+       << ", max " << PrettyDuration(summary->max_ns)
+       << ", p50 < " << PrettyDuration(QuantileLimitNs(*summary, 0.5))
+       << ", p99 < " << PrettyDuration(QuantileLimitNs(*summary, 0.99)) << "\n";
+    os << "    histogram:";
+    for (size_t b = 0; b != kNumBuckets; ++b) {
+      if (summary->buckets[b] != 0u) {
+        os << " <" << PrettyDuration(BucketLimitNs(b)) << ":" << summary->buckets[b];
+      }
+    }
+    os << "\n";
+    if (summary->owner_stack != nullptr) {
+      os << "    owner stack sample:\n" << *summary->owner_stack;
+    }
+  }
+  os << "\n";
+}
+
+void LockContentionProfiler::Reset() {
+  Site* sites = sites_.LoadAcquire();
+  if (sites == nullptr) {
+    return;
+  }
+  // Not atomic with respect to concurrent recording, which is fine for diagnostics.
+  for (size_t i = 0; i != kMaxSites; ++i) {
+    Site& site = sites[i];
+    site.count_.StoreRelaxed(0u);
+    site.total_ns_.StoreRelaxed(0u);
+    site.max_ns_.StoreRelaxed(0u);
+    for (size_t b = 0; b != kNumBuckets; ++b) {
+      site.buckets_[b].StoreRelaxed(0u);
+    }
+  }
+}
+
+}  // namespace art
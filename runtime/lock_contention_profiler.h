@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_LOCK_CONTENTION_PROFILER_H_
+#define ART_RUNTIME_LOCK_CONTENTION_PROFILER_H_
+
+#include <stdint.h>
+#include <iosfwd>
+#include <string>
+
+#include "base/atomic.h"
+#include "base/macros.h"
+
+namespace art {
+
+// Collects histograms of the time threads spend blocked on contended locks while enabled:
+// per contending call site (method and dex pc) for monitors, and per mutex name for the native
+// Mutex and ReaderWriterMutex. Monitor sites also keep a sample of the owner's stack. Unlike the
+// lock profiling threshold of Monitor::Init(), which logs long waits one by one, this aggregates
+// all waits so that the locks that make up the tail of the wait times stand out.
+//
+// Contended mutexes record into the profiler, so recording must not take a lock. Sites live in a
+// fixed size, open addressed table whose slots are claimed with a CAS and never freed. Two
+// threads that claim a slot for the same site at the same time may create duplicates, which
+// Dump() merges.
+class LockContentionProfiler {
+ public:
+  enum class Kind : uint32_t {
+    kMonitor,
+    kMutex,
+  };
+
+  // Bucket i counts waits shorter than 2^i microseconds that don't fit in bucket i - 1. The last
+  // bucket also counts all longer waits.
+  static constexpr size_t kNumBuckets = 24;
+
+  // Monitor waits at least this long sample the owner's stack, if the site has no sample yet.
+  static constexpr uint64_t kOwnerStackSampleNs = 1000 * 1000;
+
+  class Site {
+   public:
+    void Record(uint64_t wait_ns);
+
+    bool NeedsOwnerStack() const {
+      return owner_stack_.LoadRelaxed() == nullptr;
+    }
+
+    // Keeps the first sample only.
+    void SetOwnerStack(const std::string& owner_stack);
+
+   private:
+    static constexpr uint32_t kFree = 0u;
+    static constexpr uint32_t kClaimed = 1u;
+    static constexpr uint32_t kReady = 2u;
+
+    Atomic<uint32_t> state_;
+    Kind kind_;
+    const void* key_;
+    uint32_t dex_pc_;
+    // Set before state_ becomes kReady, and immutable afterwards.
+    std::string name_;
+
+    Atomic<uint64_t> count_;
+    Atomic<uint64_t> total_ns_;
+    Atomic<uint64_t> max_ns_;
+    Atomic<uint64_t> buckets_[kNumBuckets];
+    // Leaked on purpose, readers don't synchronize with writers.
+    Atomic<std::string*> owner_stack_;
+
+    friend class LockContentionProfiler;
+  };
+
+  static bool IsEnabled() {
+    return enabled_.LoadRelaxed();
+  }
+
+  static void SetEnabled(bool enabled);
+
+  // Returns the site for `key` and `dex_pc`, or null if there is none yet.
+  static Site* FindSite(Kind kind, const void* key, uint32_t dex_pc);
+
+  // Returns the site for `key` and `dex_pc`, adding it with the printable `name` if there is none
+  // yet. Returns null if the profiler was never enabled or the table is full.
+  static Site* FindOrAddSite(Kind kind,
+                             const void* key,
+                             uint32_t dex_pc,
+                             const std::string& name);
+
+  // Record a wait on the native mutex called `name`. Names are compared by address.
+  static void RecordMutexContention(const char* name, uint64_t wait_ns);
+
+  // Print the sites with the longest total waits first, with their histograms.
+  static void Dump(std::ostream& os);
+
+  // Forget the recorded waits. Sites and owner stack samples stay.
+  static void Reset();
+
+ private:
+  static constexpr size_t kMaxSites = 2048;
+  static constexpr size_t kMaxProbes = 16;
+
+  // Probe the slots of the site, adding it with `name` if `name` is not null.
+  static Site* Probe(Kind kind, const void* key, uint32_t dex_pc, const std::string* name);
+
+  static size_t HashSite(const void* key, uint32_t dex_pc) {
+    uint64_t h = reinterpret_cast<uintptr_t>(key) ^ (static_cast<uint64_t>(dex_pc) << 32);
+    h *= UINT64_C(0x9e3779b97f4a7c15);
+    return static_cast<size_t>(h >> 32);
+  }
+
+  static Atomic<bool> enabled_;
+  // Allocated once, when first enabled, and never freed.
+  static Atomic<Site*> sites_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(LockContentionProfiler);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_LOCK_CONTENTION_PROFILER_H_
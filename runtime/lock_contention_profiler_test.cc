@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lock_contention_profiler.h"
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace art {
+
+TEST(LockContentionProfilerTest, RecordAndDump) {
+  static const char kFastLock[] = "test fast lock";
+  static const char kSlowLock[] = "test slow lock";
+  LockContentionProfiler::SetEnabled(true);
+  LockContentionProfiler::Reset();
+  EXPECT_EQ(nullptr,
+            LockContentionProfiler::FindSite(LockContentionProfiler::Kind::kMutex, kFastLock, 0u));
+  for (size_t i = 0; i != 100; ++i) {
+    LockContentionProfiler::RecordMutexContention(kFastLock, 1500u);  // < 2us.
+  }
+  LockContentionProfiler::RecordMutexContention(kSlowLock, 3 * 1000 * 1000u);  // < 4.1ms.
+  LockContentionProfiler::Site* site =
+      LockContentionProfiler::FindSite(LockContentionProfiler::Kind::kMutex, kFastLock, 0u);
+  ASSERT_NE(nullptr, site);
+  EXPECT_EQ(site,
+            LockContentionProfiler::FindOrAddSite(
+                LockContentionProfiler::Kind::kMutex, kFastLock, 0u, "unused"));
+  EXPECT_TRUE(site->NeedsOwnerStack());
+  site->SetOwnerStack("first\n");
+  site->SetOwnerStack("second\n");
+  EXPECT_FALSE(site->NeedsOwnerStack());
+
+  std::ostringstream oss;
+  LockContentionProfiler::Dump(oss);
+  std::string dump = oss.str();
+  // The slow lock has the longer total wait, so it comes first.
+  size_t slow_pos = dump.find("mutex test slow lock: 1 waits");
+  size_t fast_pos = dump.find("mutex test fast lock: 100 waits");
+  ASSERT_NE(std::string::npos, slow_pos) << dump;
+  ASSERT_NE(std::string::npos, fast_pos) << dump;
+  EXPECT_LT(slow_pos, fast_pos);
+  EXPECT_NE(std::string::npos, dump.find("owner stack sample:\nfirst\n")) << dump;
+  EXPECT_EQ(std::string::npos, dump.find("second")) << dump;
+
+  LockContentionProfiler::Reset();
+  LockContentionProfiler::SetEnabled(false);
+  std::ostringstream after_reset;
+  LockContentionProfiler::Dump(after_reset);
+  EXPECT_EQ(std::string::npos, after_reset.str().find("test fast lock")) << after_reset.str();
+}
+
+}  // namespace art
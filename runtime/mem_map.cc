@@ -388,6 +388,152 @@ MemMap* MemMap::MapAnonymous(const char* name,
                     page_aligned_byte_count, prot, reuse);
 }
 
+MemMap* MemMap::MapAnonymousHugePages(const char* name,
+                                      uint8_t* expected_ptr,
+                                      size_t byte_count,
+                                      int prot,
+                                      bool low_4gb,
+                                      std::string* error_msg) {
+#ifndef __LP64__
+  UNUSED(low_4gb);
+#endif
+  CHECK_ALIGNED(byte_count, kHugePageSize);
+#ifdef MAP_HUGETLB
+  void* actual = MapInternal(expected_ptr,
+                             byte_count,
+                             prot,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                             -1,
+                             0,
+                             low_4gb);
+  if (actual == MAP_FAILED) {
+    if (error_msg != nullptr) {
+      *error_msg = StringPrintf("Failed huge page mmap(%p, %zd, 0x%x): %s",
+                                expected_ptr,
+                                byte_count,
+                                prot,
+                                strerror(errno));
+    }
+    return nullptr;
+  }
+  if (!CheckMapRequest(expected_ptr, actual, byte_count, error_msg)) {
+    return nullptr;
+  }
+  CHECK_ALIGNED(actual, kHugePageSize);
+  return new MemMap(name, reinterpret_cast<uint8_t*>(actual), byte_count, actual,
+                    byte_count, prot, false);
+#else
+  UNUSED(name, expected_ptr, prot, low_4gb);
+  if (error_msg != nullptr) {
+    *error_msg = "Explicit huge pages (MAP_HUGETLB) are not supported";
+  }
+  return nullptr;
+#endif
+}
+
+MemMap* MemMap::ReserveAddressSpace(const char* name,
+                                    uint8_t* expected_ptr,
+                                    size_t byte_count,
+                                    bool low_4gb,
+                                    std::string* error_msg) {
+#ifndef __LP64__
+  UNUSED(low_4gb);
+#endif
+  if (byte_count == 0) {
+    return new MemMap(name, nullptr, 0, nullptr, 0, PROT_NONE, false);
+  }
+  size_t page_aligned_byte_count = RoundUp(byte_count, kPageSize);
+  void* actual = MapInternal(expected_ptr,
+                             page_aligned_byte_count,
+                             PROT_NONE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                             -1,
+                             0,
+                             low_4gb);
+  if (actual == MAP_FAILED) {
+    if (error_msg != nullptr) {
+      *error_msg = StringPrintf("Failed to reserve address space mmap(%p, %zd): %s",
+                                expected_ptr,
+                                page_aligned_byte_count,
+                                strerror(errno));
+    }
+    return nullptr;
+  }
+  if (!CheckMapRequest(expected_ptr, actual, page_aligned_byte_count, error_msg)) {
+    return nullptr;
+  }
+  return new MemMap(name, reinterpret_cast<uint8_t*>(actual), page_aligned_byte_count, actual,
+                    page_aligned_byte_count, PROT_NONE, false);
+}
+
+MemMap* MemMap::MapAnonymousFromReservation(const char* name,
+                                            MemMap* reservation,
+                                            size_t byte_count,
+                                            int prot,
+                                            std::string* error_msg) {
+  CHECK(reservation != nullptr);
+  CHECK_EQ(reservation->GetProtect(), PROT_NONE) << "Not a reservation: " << *reservation;
+  CHECK(!reservation->reuse_);
+  CHECK_EQ(reservation->redzone_size_, 0u);
+  CHECK_EQ(reservation->Begin(), reservation->BaseBegin());
+  if (byte_count == 0) {
+    return new MemMap(name, nullptr, 0, nullptr, 0, prot, false);
+  }
+  size_t page_aligned_byte_count = RoundUp(byte_count, kPageSize);
+  if (page_aligned_byte_count > reservation->BaseSize()) {
+    if (error_msg != nullptr) {
+      *error_msg = StringPrintf("Reservation '%s' has %zd bytes left, %zd requested",
+                                reservation->GetName().c_str(),
+                                reservation->BaseSize(),
+                                page_aligned_byte_count);
+    }
+    return nullptr;
+  }
+  uint8_t* begin = reservation->Begin();
+  // The reserved pages were never accessible, so they still read as zeroes.
+  if (prot != PROT_NONE && mprotect(begin, page_aligned_byte_count, prot) != 0) {
+    if (error_msg != nullptr) {
+      *error_msg = StringPrintf("mprotect(%p, %zd, 0x%x) of reservation '%s' failed: %s",
+                                begin,
+                                page_aligned_byte_count,
+                                prot,
+                                reservation->GetName().c_str(),
+                                strerror(errno));
+    }
+    return nullptr;
+  }
+  reservation->ReleaseReservedMemory(page_aligned_byte_count);
+  return new MemMap(name, begin, byte_count, begin, page_aligned_byte_count, prot, false);
+}
+
+void MemMap::ReleaseReservedMemory(size_t byte_count) {
+  DCHECK_ALIGNED(byte_count, kPageSize);
+  DCHECK_LE(byte_count, base_size_);
+  std::lock_guard<std::mutex> mu(*mem_maps_lock_);
+  DCHECK(gMaps != nullptr);
+  bool found = false;
+  for (auto it = gMaps->lower_bound(base_begin_), end = gMaps->end();
+       it != end && it->first == base_begin_; ++it) {
+    if (it->second == this) {
+      found = true;
+      gMaps->erase(it);
+      break;
+    }
+  }
+  CHECK(found) << "MemMap not found";
+  size_ -= byte_count;
+  base_size_ -= byte_count;
+  if (base_size_ == 0u) {
+    // Like an empty map: nothing left to unmap or to track in gMaps.
+    begin_ = nullptr;
+    base_begin_ = nullptr;
+  } else {
+    begin_ += byte_count;
+    base_begin_ = begin_;
+    gMaps->insert(std::make_pair(base_begin_, this));
+  }
+}
+
 MemMap* MemMap::MapDummy(const char* name, uint8_t* addr, size_t byte_count) {
   if (byte_count == 0) {
     return new MemMap(name, nullptr, 0, nullptr, 0, 0, false);
@@ -710,6 +856,16 @@ void MemMap::MadviseDontNeedAndZero() {
   }
 }
 
+bool MemMap::MadviseHugePages() {
+#ifdef MADV_HUGEPAGE
+  if (madvise(begin_, size_, MADV_HUGEPAGE) == 0) {
+    return true;
+  }
+  PLOG(WARNING) << "madvise(MADV_HUGEPAGE) failed for " << name_;
+#endif
+  return false;
+}
+
 bool MemMap::Sync() {
   bool result;
   if (redzone_size_ != 0) {
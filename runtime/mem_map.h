@@ -47,6 +47,13 @@ static constexpr bool kMadviseZeroes = false;
 #define HAVE_MREMAP_SYSCALL false
 #endif
 
+// How an anonymous mapping is backed by huge pages.
+enum class HugePageType {
+  kDisabled,     // Regular pages only.
+  kTransparent,  // Transparent huge pages, requested with madvise(MADV_HUGEPAGE).
+  kExplicit,     // Explicit (hugetlbfs) huge pages, mapped with MAP_HUGETLB.
+};
+
 // Used to keep track of mmap segments.
 //
 // On 64b systems not supporting MAP_32BIT, the implementation of MemMap will do a linear scan
@@ -58,6 +65,9 @@ class MemMap {
  public:
   static constexpr bool kCanReplaceMapping = HAVE_MREMAP_SYSCALL;
 
+  // The (default) huge page size used for HugePageType::kTransparent and kExplicit mappings.
+  static constexpr size_t kHugePageSize = 2 * MB;
+
   // Replace the data in this memmmap with the data in the memmap pointed to by source. The caller
   // relinquishes ownership of the source mmap.
   //
@@ -100,6 +110,42 @@ class MemMap {
                               std::string* error_msg,
                               bool use_ashmem = true);
 
+  // Request an anonymous region backed by explicit huge pages (MAP_HUGETLB). 'byte_count' must
+  // be a multiple of kHugePageSize. Fails (returns null) if the system has no huge pages
+  // reserved. The returned mapping is kHugePageSize aligned.
+  static MemMap* MapAnonymousHugePages(const char* name,
+                                       uint8_t* addr,
+                                       size_t byte_count,
+                                       int prot,
+                                       bool low_4gb,
+                                       std::string* error_msg);
+
+  // Reserve 'byte_count' bytes of address space without committing memory: the pages are
+  // PROT_NONE and MAP_NORESERVE until carved out with MapAnonymousFromReservation(). Reserving
+  // large ranges up front keeps the mappings carved from them contiguous instead of scattering
+  // them over the address space.
+  //
+  // On success, returns a MemMap instance. On failure, returns null.
+  static MemMap* ReserveAddressSpace(const char* name,
+                                     uint8_t* addr,
+                                     size_t byte_count,
+                                     bool low_4gb,
+                                     std::string* error_msg);
+
+  // Carve an anonymous region of length 'byte_count' out of the front of 'reservation', which
+  // must come from ReserveAddressSpace() and shrinks by the page aligned size. This needs no
+  // mmap; only an mprotect unless 'prot' is PROT_NONE. The region reads as zeroes, and is
+  // unmapped with the returned MemMap, not given back to the reservation. The caller must
+  // serialize carving from the same reservation.
+  //
+  // On success, returns a MemMap instance. On failure, if the reservation is too small
+  // or the mprotect fails, returns null and leaves the reservation unchanged.
+  static MemMap* MapAnonymousFromReservation(const char* name,
+                                             MemMap* reservation,
+                                             size_t byte_count,
+                                             int prot,
+                                             std::string* error_msg);
+
   // Create placeholder for a region allocated by direct call to mmap.
   // This is useful when we do not have control over the code calling mmap,
   // but when we still want to keep track of it in the list.
@@ -162,6 +208,9 @@ class MemMap {
 
   void MadviseDontNeedAndZero();
 
+  // Ask the kernel to back the map with transparent huge pages. Returns false if not supported.
+  bool MadviseHugePages();
+
   int GetProtect() const {
     return prot_;
   }
@@ -247,6 +296,9 @@ class MemMap {
   static bool ContainedWithinExistingMap(uint8_t* ptr, size_t size, std::string* error_msg)
       REQUIRES(!MemMap::mem_maps_lock_);
 
+  // Drop the first 'byte_count' bytes, which must be page aligned, from this reservation.
+  void ReleaseReservedMemory(size_t byte_count) REQUIRES(!MemMap::mem_maps_lock_);
+
   // Internal version of mmap that supports low 4gb emulation.
   static void* MapInternal(void* addr,
                            size_t length,
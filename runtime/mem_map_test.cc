@@ -567,6 +567,64 @@ TEST_F(MemMapTest, MapAnonymousReuse) {
   ASSERT_TRUE(error_msg.empty());
 }
 
+TEST_F(MemMapTest, MapAnonymousFromReservation) {
+  CommonInit();
+  std::string error_msg;
+  std::unique_ptr<MemMap> reservation(MemMap::ReserveAddressSpace("MapAnonymousFromReservation",
+                                                                  nullptr,
+                                                                  4 * kPageSize,
+                                                                  false,
+                                                                  &error_msg));
+  ASSERT_NE(nullptr, reservation.get()) << error_msg;
+  uint8_t* reservation_begin = reservation->Begin();
+  ASSERT_EQ(4 * kPageSize, reservation->Size());
+
+  // Carve a page and a bit, which takes two pages.
+  std::unique_ptr<MemMap> map(MemMap::MapAnonymousFromReservation("MapAnonymousFromReservation1",
+                                                                  reservation.get(),
+                                                                  kPageSize + 1,
+                                                                  PROT_READ | PROT_WRITE,
+                                                                  &error_msg));
+  ASSERT_NE(nullptr, map.get()) << error_msg;
+  ASSERT_EQ(reservation_begin, map->Begin());
+  ASSERT_EQ(kPageSize + 1, map->Size());
+  ASSERT_EQ(2 * kPageSize, map->BaseSize());
+  ASSERT_EQ(map->End() + kPageSize - 1, reservation->Begin());
+  ASSERT_EQ(2 * kPageSize, reservation->Size());
+  for (size_t i = 0; i != map->Size(); ++i) {
+    ASSERT_EQ(0u, map->Begin()[i]);
+  }
+  map->Begin()[kPageSize] = 42u;
+
+  // Too big for what is left.
+  std::unique_ptr<MemMap> too_big(MemMap::MapAnonymousFromReservation("MapAnonymousTooBig",
+                                                                      reservation.get(),
+                                                                      3 * kPageSize,
+                                                                      PROT_READ,
+                                                                      &error_msg));
+  ASSERT_EQ(nullptr, too_big.get());
+  ASSERT_FALSE(error_msg.empty());
+  ASSERT_EQ(2 * kPageSize, reservation->Size());
+
+  // Take the rest, which leaves the reservation empty.
+  error_msg.clear();
+  std::unique_ptr<MemMap> rest(MemMap::MapAnonymousFromReservation("MapAnonymousFromReservation3",
+                                                                   reservation.get(),
+                                                                   2 * kPageSize,
+                                                                   PROT_READ | PROT_WRITE,
+                                                                   &error_msg));
+  ASSERT_NE(nullptr, rest.get()) << error_msg;
+  ASSERT_EQ(reservation_begin + 2 * kPageSize, rest->Begin());
+  ASSERT_EQ(0u, reservation->Size());
+  ASSERT_EQ(nullptr, reservation->Begin());
+  rest->Begin()[0] = 1u;
+  ASSERT_EQ(42u, map->Begin()[kPageSize]);
+
+  // The carved maps outlive the reservation.
+  reservation.reset();
+  ASSERT_EQ(1u, rest->Begin()[0]);
+}
+
 TEST_F(MemMapTest, CheckNoGaps) {
   CommonInit();
   std::string error_msg;
@@ -92,8 +92,12 @@ inline void DexCache::ClearString(dex::StringIndex string_idx) {
 
 inline uint32_t DexCache::TypeSlotIndex(dex::TypeIndex type_idx) {
   DCHECK_LT(type_idx.index_, GetDexFile()->NumTypeIds());
-  const uint32_t slot_idx = type_idx.index_ % kDexCacheTypeCacheSize;
-  DCHECK_LT(slot_idx, NumResolvedTypes());
+  // The cache has a slot for each type, or a power of 2 number of slots.
+  const uint32_t num_slots = NumResolvedTypes();
+  const uint32_t slot_idx = LIKELY(type_idx.index_ < num_slots)
+      ? type_idx.index_
+      : type_idx.index_ & (num_slots - 1u);
+  DCHECK(IsPowerOfTwo(num_slots) || num_slots == GetDexFile()->NumTypeIds());
   return slot_idx;
 }
 
@@ -127,6 +131,12 @@ inline void DexCache::ClearResolvedType(dex::TypeIndex type_idx) {
   }
 }
 
+inline bool DexCache::IsResolvedTypeSlotTaken(dex::TypeIndex type_idx) {
+  uint32_t slot_idx = TypeSlotIndex(type_idx);
+  uint32_t index = GetResolvedTypes()[slot_idx].load(std::memory_order_relaxed).index;
+  return index != type_idx.index_ && index != TypeDexCachePair::InvalidIndexForSlot(slot_idx);
+}
+
 inline uint32_t DexCache::MethodTypeSlotIndex(uint32_t proto_idx) {
   DCHECK(Runtime::Current()->IsMethodHandlesEnabled());
   DCHECK_LT(proto_idx, GetDexFile()->NumProtoIds());
@@ -179,8 +189,12 @@ inline CallSite* DexCache::SetResolvedCallSite(uint32_t call_site_idx, CallSite*
 
 inline uint32_t DexCache::FieldSlotIndex(uint32_t field_idx) {
   DCHECK_LT(field_idx, GetDexFile()->NumFieldIds());
-  const uint32_t slot_idx = field_idx % kDexCacheFieldCacheSize;
-  DCHECK_LT(slot_idx, NumResolvedFields());
+  // The cache has a slot for each field, or a power of 2 number of slots.
+  const uint32_t num_slots = NumResolvedFields();
+  const uint32_t slot_idx = LIKELY(field_idx < num_slots)
+      ? field_idx
+      : field_idx & (num_slots - 1u);
+  DCHECK(IsPowerOfTwo(num_slots) || num_slots == GetDexFile()->NumFieldIds());
   return slot_idx;
 }
 
@@ -209,6 +223,12 @@ inline void DexCache::ClearResolvedField(uint32_t field_idx, PointerSize ptr_siz
   }
 }
 
+inline bool DexCache::IsResolvedFieldSlotTaken(uint32_t field_idx, PointerSize ptr_size) {
+  uint32_t slot_idx = FieldSlotIndex(field_idx);
+  uint32_t index = GetNativePairPtrSize(GetResolvedFields(), slot_idx, ptr_size).index;
+  return index != field_idx && index != FieldDexCachePair::InvalidIndexForSlot(slot_idx);
+}
+
 inline uint32_t DexCache::MethodSlotIndex(uint32_t method_idx) {
   DCHECK_LT(method_idx, GetDexFile()->NumMethodIds());
   const uint32_t slot_idx = method_idx % kDexCacheMethodCacheSize;
@@ -39,10 +39,11 @@ void DexCache::InitializeDexCache(Thread* self,
                                   ObjPtr<mirror::String> location,
                                   const DexFile* dex_file,
                                   LinearAlloc* linear_alloc,
-                                  PointerSize image_pointer_size) {
+                                  PointerSize image_pointer_size,
+                                  bool large_caches) {
   DCHECK(dex_file != nullptr);
   ScopedAssertNoThreadSuspension sants(__FUNCTION__);
-  DexCacheArraysLayout layout(image_pointer_size, dex_file);
+  DexCacheArraysLayout layout(image_pointer_size, dex_file, large_caches);
   uint8_t* raw_arrays = nullptr;
 
   if (dex_file->NumStringIds() != 0u ||
@@ -70,14 +71,8 @@ void DexCache::InitializeDexCache(Thread* self,
   if (dex_file->NumStringIds() < num_strings) {
     num_strings = dex_file->NumStringIds();
   }
-  size_t num_types = kDexCacheTypeCacheSize;
-  if (dex_file->NumTypeIds() < num_types) {
-    num_types = dex_file->NumTypeIds();
-  }
-  size_t num_fields = kDexCacheFieldCacheSize;
-  if (dex_file->NumFieldIds() < num_fields) {
-    num_fields = dex_file->NumFieldIds();
-  }
+  size_t num_types = TypeCacheSize(dex_file->NumTypeIds(), large_caches);
+  size_t num_fields = FieldCacheSize(dex_file->NumFieldIds(), large_caches);
   size_t num_methods = kDexCacheMethodCacheSize;
   if (dex_file->NumMethodIds() < num_methods) {
     num_methods = dex_file->NumMethodIds();
@@ -17,6 +17,8 @@
 #ifndef ART_RUNTIME_MIRROR_DEX_CACHE_H_
 #define ART_RUNTIME_MIRROR_DEX_CACHE_H_
 
+#include <algorithm>
+
 #include "array.h"
 #include "base/bit_utils.h"
 #include "base/mutex.h"
@@ -147,6 +149,12 @@ class MANAGED DexCache FINAL : public Object {
   static_assert(IsPowerOfTwo(kDexCacheTypeCacheSize),
                 "Type dex cache size is not a power of 2.");
 
+  // Maximum size of the type and field dex caches of hot dex files, see InitializeDexCache().
+  // Needs to be a power of 2 so that indexes beyond it can be mapped to a slot by masking.
+  static constexpr size_t kDexCacheLargeCacheSize = 16 * 1024;
+  static_assert(IsPowerOfTwo(kDexCacheLargeCacheSize),
+                "Large dex cache size is not a power of 2.");
+
   // Size of string dex cache. Needs to be a power of 2 for entrypoint assumptions to hold.
   static constexpr size_t kDexCacheStringCacheSize = 1024;
   static_assert(IsPowerOfTwo(kDexCacheStringCacheSize),
@@ -188,17 +196,32 @@ class MANAGED DexCache FINAL : public Object {
     return kDexCacheMethodTypeCacheSize;
   }
 
+  // Number of slots of the type dex cache of a dex file with `num_type_ids` types.
+  static constexpr size_t TypeCacheSize(size_t num_type_ids, bool large_caches) {
+    return std::min(num_type_ids, large_caches ? kDexCacheLargeCacheSize : kDexCacheTypeCacheSize);
+  }
+
+  // Number of slots of the field dex cache of a dex file with `num_field_ids` fields.
+  static constexpr size_t FieldCacheSize(size_t num_field_ids, bool large_caches) {
+    return std::min(num_field_ids,
+                    large_caches ? kDexCacheLargeCacheSize : kDexCacheFieldCacheSize);
+  }
+
   // Size of an instance of java.lang.DexCache not including referenced values.
   static constexpr uint32_t InstanceSize() {
     return sizeof(DexCache);
   }
 
+  // Allocate the dex cache arrays of `dex_file` and initialize `dex_cache` with them. With
+  // `large_caches`, used for hot dex files, the type and field caches get up to
+  // kDexCacheLargeCacheSize slots so that they see fewer conflicts.
   static void InitializeDexCache(Thread* self,
                                  ObjPtr<mirror::DexCache> dex_cache,
                                  ObjPtr<mirror::String> location,
                                  const DexFile* dex_file,
                                  LinearAlloc* linear_alloc,
-                                 PointerSize image_pointer_size)
+                                 PointerSize image_pointer_size,
+                                 bool large_caches)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(Locks::dex_lock_);
 
@@ -287,6 +310,10 @@ class MANAGED DexCache FINAL : public Object {
 
   void ClearResolvedType(dex::TypeIndex type_idx) REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Return whether the slot of `type_idx` holds another type, i.e. whether a miss for
+  // `type_idx` is due to a conflict rather than to the type not being resolved yet.
+  bool IsResolvedTypeSlotTaken(dex::TypeIndex type_idx) REQUIRES_SHARED(Locks::mutator_lock_);
+
   ALWAYS_INLINE ArtMethod* GetResolvedMethod(uint32_t method_idx, PointerSize ptr_size)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -307,6 +334,10 @@ class MANAGED DexCache FINAL : public Object {
   ALWAYS_INLINE void ClearResolvedField(uint32_t idx, PointerSize ptr_size)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Return whether the slot of field `idx` holds another field, see IsResolvedTypeSlotTaken().
+  bool IsResolvedFieldSlotTaken(uint32_t idx, PointerSize ptr_size)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   MethodType* GetResolvedMethodType(uint32_t proto_idx) REQUIRES_SHARED(Locks::mutator_lock_);
 
   void SetResolvedMethodType(uint32_t proto_idx, MethodType* resolved)
@@ -76,6 +76,53 @@ TEST_F(DexCacheMethodHandlesTest, Open) {
       || java_lang_dex_file_->NumProtoIds() == dex_cache->NumResolvedMethodTypes());
 }
 
+TEST_F(DexCacheTest, LargeCaches) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<2> hs(soa.Self());
+  ASSERT_TRUE(java_lang_dex_file_ != nullptr);
+  ObjPtr<String> location;
+  Handle<DexCache> dex_cache(
+      hs.NewHandle(class_linker_->AllocDexCache(&location, soa.Self(), *java_lang_dex_file_)));
+  ASSERT_TRUE(dex_cache != nullptr);
+  {
+    WriterMutexLock mu(soa.Self(), *Locks::dex_lock_);
+    DexCache::InitializeDexCache(soa.Self(),
+                                 dex_cache.Get(),
+                                 location,
+                                 java_lang_dex_file_,
+                                 Runtime::Current()->GetLinearAlloc(),
+                                 kRuntimePointerSize,
+                                 /* large_caches */ true);
+  }
+  const uint32_t num_types = java_lang_dex_file_->NumTypeIds();
+  ASSERT_GT(num_types, DexCache::StaticTypeSize());
+  EXPECT_EQ(DexCache::TypeCacheSize(num_types, /* large_caches */ true),
+            dex_cache->NumResolvedTypes());
+  EXPECT_GT(dex_cache->NumResolvedTypes(), DexCache::StaticTypeSize());
+  EXPECT_EQ(DexCache::FieldCacheSize(java_lang_dex_file_->NumFieldIds(), /* large_caches */ true),
+            dex_cache->NumResolvedFields());
+
+  // Types past the default cache size get their own slot.
+  Handle<Class> object_class(
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;")));
+  ASSERT_TRUE(object_class != nullptr);
+  const dex::TypeIndex type_idx(DexCache::StaticTypeSize());
+  const dex::TypeIndex aliased_type_idx(0u);
+  EXPECT_FALSE(dex_cache->IsResolvedTypeSlotTaken(type_idx));
+  dex_cache->SetResolvedType(type_idx, object_class.Get());
+  EXPECT_EQ(object_class.Get(), dex_cache->GetResolvedType(type_idx));
+  EXPECT_FALSE(dex_cache->IsResolvedTypeSlotTaken(aliased_type_idx));
+  EXPECT_TRUE(dex_cache->GetResolvedType(aliased_type_idx) == nullptr);
+
+  // Types past the large cache size share slots.
+  if (num_types > DexCache::kDexCacheLargeCacheSize) {
+    const dex::TypeIndex conflicting_type_idx(type_idx.index_ + DexCache::kDexCacheLargeCacheSize);
+    EXPECT_EQ(dex_cache->TypeSlotIndex(type_idx), dex_cache->TypeSlotIndex(conflicting_type_idx));
+    EXPECT_TRUE(dex_cache->IsResolvedTypeSlotTaken(conflicting_type_idx));
+    EXPECT_TRUE(dex_cache->GetResolvedType(conflicting_type_idx) == nullptr);
+  }
+}
+
 TEST_F(DexCacheTest, LinearAlloc) {
   ScopedObjectAccess soa(Thread::Current());
   jobject jclass_loader(LoadDex("Main"));
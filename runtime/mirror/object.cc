@@ -214,7 +214,12 @@ int32_t Object::IdentityHashCode() {
         // Already inflated, return the hash stored in the monitor.
         Monitor* monitor = lw.FatLockMonitor();
         DCHECK(monitor != nullptr);
-        return monitor->GetHashCode();
+        int32_t hash_code = monitor->GetHashCode();
+        if (LIKELY(hash_code != Monitor::kDeflatedHashCode)) {
+          return hash_code;
+        }
+        // The monitor was deflated concurrently before it got a hash code, re-read the lock word.
+        break;
       }
       case LockWord::kHashCode: {
         return lw.GetHashCode();
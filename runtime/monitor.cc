@@ -16,6 +16,7 @@
 
 #include "monitor.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "android-base/stringprintf.h"
@@ -31,6 +32,7 @@
 #include "dex/dex_file-inl.h"
 #include "dex/dex_file_types.h"
 #include "dex/dex_instruction-inl.h"
+#include "lock_contention_profiler.h"
 #include "lock_word-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
@@ -100,6 +102,7 @@ Monitor::Monitor(Thread* self, Thread* owner, mirror::Object* obj, int32_t hash_
       hash_code_(hash_code),
       locking_method_(nullptr),
       locking_dex_pc_(0),
+      spin_budget_(kInitialSpinBudget),
       monitor_id_(MonitorPool::ComputeMonitorId(this, self)) {
 #ifdef __LP64__
   DCHECK(false) << "Should not be reached in 64b";
@@ -123,6 +126,7 @@ Monitor::Monitor(Thread* self, Thread* owner, mirror::Object* obj, int32_t hash_
       hash_code_(hash_code),
       locking_method_(nullptr),
       locking_dex_pc_(0),
+      spin_budget_(kInitialSpinBudget),
       monitor_id_(id) {
 #ifdef __LP64__
   next_free_ = nullptr;
@@ -134,6 +138,7 @@ Monitor::Monitor(Thread* self, Thread* owner, mirror::Object* obj, int32_t hash_
 }
 
 int32_t Monitor::GetHashCode() {
+  // Note: returns kDeflatedHashCode if DeflateIfIdle() deflated the monitor first.
   while (!HasHashCode()) {
     if (hash_code_.CompareAndSetWeakRelaxed(0, mirror::Object::GenerateIdentityHashCode())) {
       break;
@@ -389,6 +394,9 @@ bool Monitor::TryLockLocked(Thread* self) {
 
 bool Monitor::TryLock(Thread* self) {
   MutexLock mu(self, monitor_lock_);
+  if (UNLIKELY(obj_.IsNull())) {
+    return false;  // Deflated, see Lock().
+  }
   return TryLockLocked(self);
 }
 
@@ -409,11 +417,83 @@ class ScopedAssertNotHeld {
   DISALLOW_COPY_AND_ASSIGN(ScopedAssertNotHeld);
 };
 
+bool Monitor::SpinUntilUnowned(size_t spins) {
+  for (size_t i = 0; i != spins; ++i) {
+    // Like the thin lock spinning in MonitorEnter(), yield rather than busy-wait.
+    sched_yield();
+    if (GetOwner() == nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the Java stack of the thread with id `thread_id`, or an empty string if it is gone.
+static std::string GetJavaStackOfThread(Thread* self, uint32_t thread_id)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  struct CollectStackTrace : public Closure {
+    void Run(art::Thread* thread) OVERRIDE REQUIRES_SHARED(art::Locks::mutator_lock_) {
+      thread->DumpJavaStack(oss);
+    }
+
+    std::ostringstream oss;
+  };
+  Locks::thread_list_lock_->ExclusiveLock(self);
+  Thread* thread = Runtime::Current()->GetThreadList()->FindThreadByThreadId(thread_id);
+  if (thread == nullptr) {
+    Locks::thread_list_lock_->ExclusiveUnlock(self);
+    return std::string();
+  }
+  CollectStackTrace trace;
+  // RequestSynchronousCheckpoint releases the thread_list_lock_ as a part of its execution.
+  thread->RequestSynchronousCheckpoint(&trace);
+  return trace.oss.str();
+}
+
+void Monitor::ProfileContention(Thread* self, uint64_t wait_ns, uint32_t owner_thread_id) {
+  uint32_t dex_pc;
+  ArtMethod* method = self->GetCurrentMethod(&dex_pc);
+  constexpr LockContentionProfiler::Kind kKind = LockContentionProfiler::Kind::kMonitor;
+  LockContentionProfiler::Site* site = LockContentionProfiler::FindSite(kKind, method, dex_pc);
+  if (site == nullptr) {
+    const char* filename;
+    int32_t line_number;
+    TranslateLocation(method, dex_pc, &filename, &line_number);
+    std::string name = StringPrintf("%s (%s:%d)",
+                                    ArtMethod::PrettyMethod(method).c_str(),
+                                    filename != nullptr ? filename : "null",
+                                    line_number);
+    site = LockContentionProfiler::FindOrAddSite(kKind, method, dex_pc, name);
+  }
+  if (site == nullptr) {
+    return;
+  }
+  site->Record(wait_ns);
+  if (wait_ns >= LockContentionProfiler::kOwnerStackSampleNs &&
+      site->NeedsOwnerStack() &&
+      owner_thread_id != self->GetThreadId()) {
+    // The owner may have moved on, but a thread that held the monitor for this long usually
+    // still does related work.
+    std::string owner_stack = GetJavaStackOfThread(self, owner_thread_id);
+    if (!owner_stack.empty()) {
+      site->SetOwnerStack(owner_stack);
+    }
+  }
+}
+
 template <LockReason reason>
-void Monitor::Lock(Thread* self) {
+bool Monitor::Lock(Thread* self) {
   ScopedAssertNotHeld sanh(self, monitor_lock_);
   bool called_monitors_callback = false;
+  bool spun = false;
   monitor_lock_.Lock(self);
+  if (UNLIKELY(obj_.IsNull())) {
+    // DeflateIfIdle() reset the object's lock word after the caller read it. Once we are counted
+    // in num_waiters_ below, or own the monitor, it can't be deflated anymore.
+    DCHECK(reason == LockReason::kForLock);
+    monitor_lock_.Unlock(self);
+    return false;
+  }
   while (true) {
     if (TryLockLocked(self)) {
       break;
@@ -426,6 +506,9 @@ void Monitor::Lock(Thread* self) {
     // Do this before releasing the lock so that we don't get deflated.
     size_t num_waiters = num_waiters_;
     ++num_waiters_;
+    // Spin at most once per Lock(), see spin_budget_.
+    const size_t spins = spun ? 0u : spin_budget_;
+    spun = true;
 
     // If systrace logging is enabled, first look at the lock owner. Acquiring the monitor's
     // lock and then re-acquiring the mutator lock can deadlock.
@@ -455,6 +538,16 @@ void Monitor::Lock(Thread* self) {
     }
 
     monitor_lock_.Unlock(self);  // Let go of locks in order.
+    if (SpinUntilUnowned(spins)) {
+      if (started_trace) {
+        ATRACE_END();
+      }
+      monitor_lock_.Lock(self);
+      --num_waiters_;
+      // The owner released the monitor quickly, keep spinning for it.
+      spin_budget_ = std::min<size_t>(spin_budget_ + 1u, size_t{kMaxSpinBudget});
+      continue;
+    }
     // Call the contended locking cb once and only once. Also only call it if we are locking for
     // the first time, not during a Wait wakeup.
     if (reason == LockReason::kForLock && !called_monitors_callback) {
@@ -462,15 +555,18 @@ void Monitor::Lock(Thread* self) {
       Runtime::Current()->GetRuntimeCallbacks()->MonitorContendedLocking(this);
     }
     self->SetMonitorEnterObject(GetObject());
+    const uint64_t block_start_ns = NanoTime();
+    bool blocked = false;
+    uint32_t original_owner_thread_id = 0u;
     {
       ScopedThreadSuspension tsc(self, kBlocked);  // Change to blocked and give up mutator_lock_.
-      uint32_t original_owner_thread_id = 0u;
       {
         // Reacquire monitor_lock_ without mutator_lock_ for Wait.
         MutexLock mu2(self, monitor_lock_);
         if (owner_ != nullptr) {  // Did the owner_ give the lock up?
           original_owner_thread_id = owner_->GetThreadId();
           monitor_contenders_.Wait(self);  // Still contended so wait.
+          blocked = true;
         }
       }
       if (original_owner_thread_id != 0u) {
@@ -583,8 +679,20 @@ void Monitor::Lock(Thread* self) {
       ATRACE_END();
     }
     self->SetMonitorEnterObject(nullptr);
+    if (blocked && LockContentionProfiler::IsEnabled()) {
+      ProfileContention(self, NanoTime() - block_start_ns, original_owner_thread_id);
+    }
     monitor_lock_.Lock(self);  // Reacquire locks in order.
     --num_waiters_;
+    if (blocked) {
+      // Spin for longer if we were woken up soon after giving up spinning, spin less for owners
+      // that hold the monitor for long.
+      if (NanoTime() - block_start_ns < kShortBlockNs) {
+        spin_budget_ = std::min<size_t>(2u * spin_budget_ + 1u, size_t{kMaxSpinBudget});
+      } else {
+        spin_budget_ /= 2;
+      }
+    }
   }
   monitor_lock_.Unlock(self);
   // We need to pair this with a single contended locking call. NB we match the RI behavior and call
@@ -593,10 +701,11 @@ void Monitor::Lock(Thread* self) {
     CHECK(reason == LockReason::kForLock);
     Runtime::Current()->GetRuntimeCallbacks()->MonitorContendedLocked(this);
   }
+  return true;
 }
 
-template void Monitor::Lock<LockReason::kForLock>(Thread* self);
-template void Monitor::Lock<LockReason::kForWait>(Thread* self);
+template bool Monitor::Lock<LockReason::kForLock>(Thread* self);
+template bool Monitor::Lock<LockReason::kForWait>(Thread* self);
 
 static void ThrowIllegalMonitorStateExceptionF(const char* fmt, ...)
                                               __attribute__((format(printf, 1, 2)));
@@ -843,8 +952,9 @@ void Monitor::Wait(Thread* self, int64_t ms, int32_t ns,
   // We just slept, tell the runtime callbacks about this.
   Runtime::Current()->GetRuntimeCallbacks()->MonitorWaitFinished(this, timed_out);
 
-  // Re-acquire the monitor and lock.
-  Lock<LockReason::kForWait>(self);
+  // Re-acquire the monitor and lock. Being counted in num_waiters_ kept it from being deflated.
+  bool locked = Lock<LockReason::kForWait>(self);
+  DCHECK(locked);
   monitor_lock_.Lock(self);
   self->GetWaitMutex()->AssertNotHeld(self);
 
@@ -954,6 +1064,39 @@ bool Monitor::Deflate(Thread* self, mirror::Object* obj) {
   return true;
 }
 
+bool Monitor::DeflateIfIdle(Thread* self) {
+  MutexLock mu(self, monitor_lock_);
+  // Unlike Deflate(), mutators run concurrently. Only deflate monitors that nobody owns, waits on
+  // or contends for; Lock() and TryLock() re-check obj_ under monitor_lock_ for threads that read
+  // the lock word before we reset it.
+  if (owner_ != nullptr || num_waiters_ != 0 || obj_.IsNull()) {
+    return false;
+  }
+  mirror::Object* obj = GetObject();
+  // A hash code stored in the monitor never changes, so it can go back into the lock word. If
+  // there is none yet, claim hash_code_ so that a concurrent GetHashCode() can't hand out a hash
+  // code that would be lost with the monitor; mirror::Object::IdentityHashCode() retries then.
+  int32_t hash_code = 0;
+  if (!hash_code_.CompareAndSetStrongRelaxed(0, kDeflatedHashCode)) {
+    hash_code = hash_code_.LoadRelaxed();
+  }
+  while (true) {
+    LockWord lw = obj->GetLockWord(true);
+    DCHECK_EQ(lw.GetState(), LockWord::kFatLocked);
+    DCHECK_EQ(lw.FatLockMonitor(), this);
+    // Preserve the read barrier state, which the GC may change concurrently.
+    LockWord new_lw = (hash_code != 0) ? LockWord::FromHashCode(hash_code, lw.GCState())
+                                       : LockWord::FromDefault(lw.GCState());
+    if (obj->CasLockWordWeakRelease(lw, new_lw)) {
+      break;
+    }
+  }
+  VLOG(monitor) << "Concurrently deflated " << obj
+      << (hash_code != 0 ? " to hash monitor" : " to empty lock word");
+  obj_ = GcRoot<mirror::Object>(nullptr);
+  return true;
+}
+
 void Monitor::Inflate(Thread* self, Thread* owner, mirror::Object* obj, int32_t hash_code) {
   DCHECK(self != nullptr);
   DCHECK(obj != nullptr);
@@ -1104,10 +1247,20 @@ mirror::Object* Monitor::MonitorEnter(Thread* self, mirror::Object* obj, bool tr
         QuasiAtomic::ThreadFenceAcquire();
         Monitor* mon = lock_word.FatLockMonitor();
         if (trylock) {
-          return mon->TryLock(self) ? h_obj.Get() : nullptr;
+          if (mon->TryLock(self)) {
+            return h_obj.Get();  // Success!
+          }
+          if (h_obj->GetLockWord(true).GetValue() == lock_word.GetValue()) {
+            return nullptr;  // Owned by another thread.
+          }
+          // The monitor may have been deflated, see Monitor::DeflateIfIdle().
+          continue;  // Start from the beginning.
         } else {
-          mon->Lock(self);
-          return h_obj.Get();  // Success!
+          if (mon->Lock(self)) {
+            return h_obj.Get();  // Success!
+          }
+          // The monitor was deflated concurrently, see Monitor::DeflateIfIdle().
+          continue;  // Start from the beginning.
         }
       }
       case LockWord::kHashCode:
@@ -1591,6 +1744,37 @@ size_t MonitorList::DeflateMonitors() {
   return visitor.deflate_count_;
 }
 
+size_t MonitorList::DeflateIdleMonitors(Thread* self) {
+  Monitors deflated;
+  {
+    ScopedObjectAccess soa(self);
+    MutexLock mu(self, monitor_list_lock_);
+    // Like Add(), wait until the GC allows reading the monitors' weak roots.
+    while (UNLIKELY((!kUseReadBarrier && !allow_new_monitors_) ||
+                    (kUseReadBarrier && !self->GetWeakRefAccessEnabled()))) {
+      self->CheckEmptyCheckpointFromWeakRefAccess(&monitor_list_lock_);
+      monitor_add_condition_.WaitHoldingLocks(self);
+    }
+    for (auto it = list_.begin(); it != list_.end(); ) {
+      Monitor* m = *it;
+      if (m->DeflateIfIdle(self)) {
+        // Remove the monitor right away so that the GC never sees it with its claimed hash code.
+        deflated.push_back(m);
+        it = list_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  if (!deflated.empty()) {
+    // A thread that read a lock word before it was deflated uses the monitor without passing a
+    // suspend point, so the monitors can be reused once every runnable thread passed one.
+    Runtime::Current()->GetThreadList()->RunEmptyCheckpoint();
+    MonitorPool::ReleaseMonitors(self, &deflated);
+  }
+  return deflated.size();
+}
+
 MonitorInfo::MonitorInfo(mirror::Object* obj) : owner_(nullptr), entry_count_(0) {
   DCHECK(obj != nullptr);
   LockWord lock_word = obj->GetLockWord(true);
@@ -59,6 +59,12 @@ class Monitor {
   // a lock word. See Runtime::max_spins_before_thin_lock_inflation_.
   constexpr static size_t kDefaultMaxSpinsBeforeThinLockInflation = 50;
 
+  // Bounds of the adaptive spinning of contended fat locks, see spin_budget_.
+  constexpr static size_t kInitialSpinBudget = 8;
+  constexpr static size_t kMaxSpinBudget = 64;
+  // Blocking for less than this means spinning a little longer would have acquired the monitor.
+  constexpr static uint64_t kShortBlockNs = 50 * 1000;
+
   ~Monitor();
 
   static void Init(uint32_t lock_profiling_threshold, uint32_t stack_dump_lock_profiling_threshold);
@@ -127,6 +133,10 @@ class Monitor {
 
   int32_t GetHashCode();
 
+  // Value of hash_code_ once DeflateIfIdle() deflated a monitor that had no hash code. Never a
+  // valid identity hash code, see mirror::Object::GenerateIdentityHashCode().
+  static constexpr int32_t kDeflatedHashCode = -1;
+
   bool IsLocked() REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!monitor_lock_);
 
   bool HasHashCode() const {
@@ -147,6 +157,13 @@ class Monitor {
   static bool Deflate(Thread* self, mirror::Object* obj)
       REQUIRES_SHARED(Locks::mutator_lock_) NO_THREAD_SAFETY_ANALYSIS;
 
+  // Deflate the monitor back into its object's lock word while mutators are running, provided it
+  // is unowned and has no waiters or contenders. Returns true if it was deflated; the caller must
+  // not free it before all threads passed a suspend point.
+  bool DeflateIfIdle(Thread* self)
+      REQUIRES(!monitor_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
 #ifndef __LP64__
   void* operator new(size_t size) {
     // Align Monitor* as per the monitor ID field size in the lock word.
@@ -196,6 +213,12 @@ class Monitor {
                           uint32_t owner_dex_pc)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Record a blocking wait in the LockContentionProfiler, at the current method and dex pc of
+  // `self`, which must be runnable.
+  void ProfileContention(Thread* self, uint64_t wait_ns, uint32_t owner_thread_id)
+      REQUIRES(!monitor_lock_, !Locks::thread_list_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   static void FailedUnlock(mirror::Object* obj,
                            uint32_t expected_owner_thread_id,
                            uint32_t found_owner_thread_id,
@@ -204,7 +227,8 @@ class Monitor {
                !monitor_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
-  // Try to lock without blocking, returns true if we acquired the lock.
+  // Try to lock without blocking, returns true if we acquired the lock. Also returns false if the
+  // monitor was deflated, see Lock().
   bool TryLock(Thread* self)
       REQUIRES(!monitor_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -213,8 +237,15 @@ class Monitor {
       REQUIRES(monitor_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Returns false without acquiring the monitor if DeflateIfIdle() deflated it after the caller
+  // read the object's lock word, in which case the caller should re-read the lock word.
+  // Spin until the monitor has no owner, giving up after `spins` attempts. Returns whether the
+  // monitor was seen unowned; another thread may still acquire it first.
+  bool SpinUntilUnowned(size_t spins)
+      REQUIRES(!monitor_lock_);
+
   template<LockReason reason = LockReason::kForLock>
-  void Lock(Thread* self)
+  bool Lock(Thread* self)
       REQUIRES(!monitor_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -315,12 +346,18 @@ class Monitor {
   ArtMethod* locking_method_ GUARDED_BY(monitor_lock_);
   uint32_t locking_dex_pc_ GUARDED_BY(monitor_lock_);
 
+  // How many times a contending thread spins for the owner to release the monitor before it
+  // blocks. Grows when the owner released it while we spun, or soon after we blocked, and shrinks
+  // when owners hold the monitor for long.
+  size_t spin_budget_ GUARDED_BY(monitor_lock_);
+
   // The denser encoded version of this monitor as stored in the lock word.
   MonitorId monitor_id_;
 
 #ifdef __LP64__
-  // Free list for monitor pool.
-  Monitor* next_free_ GUARDED_BY(Locks::allocated_monitor_ids_lock_);
+  // Free list for monitor pool. Guarded by Locks::allocated_monitor_ids_lock_ on the pool's free
+  // list, and only accessed by the owning thread on a thread's cached free list.
+  Monitor* next_free_;
 #endif
 
   friend class MonitorInfo;
@@ -344,6 +381,10 @@ class MonitorList {
   void BroadcastForNewMonitors() REQUIRES(!monitor_list_lock_);
   // Returns how many monitors were deflated.
   size_t DeflateMonitors() REQUIRES(!monitor_list_lock_) REQUIRES(Locks::mutator_lock_);
+  // Deflates the idle monitors without suspending the mutators, see Monitor::DeflateIfIdle().
+  // Returns how many monitors were deflated.
+  size_t DeflateIdleMonitors(Thread* self)
+      REQUIRES(!monitor_list_lock_, !Locks::mutator_lock_);
   size_t Size() REQUIRES(!monitor_list_lock_);
 
   typedef std::list<Monitor*, TrackingAllocator<Monitor*, kAllocatorTagMonitorList>> Monitors;
@@ -108,17 +108,27 @@ void MonitorPool::FreeInternal() {
 Monitor* MonitorPool::CreateMonitorInPool(Thread* self, Thread* owner, mirror::Object* obj,
                                           int32_t hash_code)
     REQUIRES_SHARED(Locks::mutator_lock_) {
-  // We are gonna allocate, so acquire the writer lock.
-  MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
+  Monitor* mon_uninitialized = self->GetFreeMonitors();
+  if (mon_uninitialized == nullptr) {
+    // Refill the thread's cache, so acquire the writer lock.
+    MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
+
+    // Enough space, or need to resize?
+    if (first_free_ == nullptr) {
+      VLOG(monitor) << "Allocating a new chunk.";
+      AllocateChunk();
+    }
 
-  // Enough space, or need to resize?
-  if (first_free_ == nullptr) {
-    VLOG(monitor) << "Allocating a new chunk.";
-    AllocateChunk();
+    // Take up to kThreadCacheSize monitors off the free list.
+    mon_uninitialized = first_free_;
+    Monitor* last = first_free_;
+    for (size_t i = 1; i < kThreadCacheSize && last->next_free_ != nullptr; ++i) {
+      last = last->next_free_;
+    }
+    first_free_ = last->next_free_;
+    last->next_free_ = nullptr;
   }
-
-  Monitor* mon_uninitialized = first_free_;
-  first_free_ = first_free_->next_free_;
+  self->SetFreeMonitors(mon_uninitialized->next_free_);
 
   // Pull out the id which was preinitialized.
   MonitorId id = mon_uninitialized->monitor_id_;
@@ -132,7 +142,10 @@ Monitor* MonitorPool::CreateMonitorInPool(Thread* self, Thread* owner, mirror::O
 void MonitorPool::ReleaseMonitorToPool(Thread* self, Monitor* monitor) {
   // Might be racy with allocation, so acquire lock.
   MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
+  ReleaseMonitorToPoolLocked(monitor);
+}
 
+void MonitorPool::ReleaseMonitorToPoolLocked(Monitor* monitor) {
   // Keep the monitor id. Don't trust it's not cleared.
   MonitorId id = monitor->monitor_id_;
 
@@ -149,9 +162,25 @@ void MonitorPool::ReleaseMonitorToPool(Thread* self, Monitor* monitor) {
 }
 
 void MonitorPool::ReleaseMonitorsToPool(Thread* self, MonitorList::Monitors* monitors) {
+  MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
   for (Monitor* mon : *monitors) {
-    ReleaseMonitorToPool(self, mon);
+    ReleaseMonitorToPoolLocked(mon);
   }
 }
 
+void MonitorPool::ReleaseThreadCacheToPool(Thread* self) {
+  Monitor* first = self->GetFreeMonitors();
+  if (first == nullptr) {
+    return;
+  }
+  self->SetFreeMonitors(nullptr);
+  Monitor* last = first;
+  while (last->next_free_ != nullptr) {
+    last = last->next_free_;
+  }
+  MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
+  last->next_free_ = first_free_;
+  first_free_ = first;
+}
+
 }  // namespace art
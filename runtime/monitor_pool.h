@@ -71,6 +71,15 @@ class MonitorPool {
 #endif
   }
 
+  // Return the free monitors cached by the exiting thread `self` to the pool.
+  static void ReleaseThreadCache(Thread* self) {
+#ifndef __LP64__
+    UNUSED(self);
+#else
+    GetMonitorPool()->ReleaseThreadCacheToPool(self);
+#endif
+  }
+
   static Monitor* MonitorFromMonitorId(MonitorId mon_id) {
 #ifndef __LP64__
     return reinterpret_cast<Monitor*>(mon_id << LockWord::kMonitorIdAlignmentShift);
@@ -127,6 +136,9 @@ class MonitorPool {
 
   void ReleaseMonitorToPool(Thread* self, Monitor* monitor);
   void ReleaseMonitorsToPool(Thread* self, MonitorList::Monitors* monitors);
+  void ReleaseMonitorToPoolLocked(Monitor* monitor)
+      REQUIRES(Locks::allocated_monitor_ids_lock_);
+  void ReleaseThreadCacheToPool(Thread* self);
 
   // Note: This is safe as we do not ever move chunks.  All needed entries in the monitor_chunks_
   // data structure are read-only once we get here.  Updates happen-before this call because
@@ -195,6 +207,9 @@ class MonitorPool {
   // Currently we set it a bit smaller, to save half a page per process.  We make it tiny in
   // debug builds to catch growth errors. The only value we really expect to tune.
   static constexpr size_t kInitialChunkStorage = kIsDebugBuild ? 1U : 256U;
+  // Number of free monitors a thread takes from first_free_ at a time. Creating monitors then only
+  // acquires allocated_monitor_ids_lock_ once per batch.
+  static constexpr size_t kThreadCacheSize = 16;
   static_assert(IsPowerOfTwo(kInitialChunkStorage), "kInitialChunkStorage must be power of 2");
   // The number of lists, each containing pointers to storage chunks.
   static constexpr size_t kMaxChunkLists = 8;  //  Dictated by 3 bit index. Don't increase above 8.
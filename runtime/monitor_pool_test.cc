@@ -16,6 +16,8 @@
 
 #include "monitor_pool.h"
 
+#include <set>
+
 #include "common_runtime_test.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
@@ -124,4 +126,25 @@ TEST_F(MonitorPoolTest, MonitorPoolTest) {
   }
 }
 
+TEST_F(MonitorPoolTest, ThreadCache) {
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+
+  // Monitors come in batches from the thread's cache, a partially used batch goes back to the pool
+  // when the thread exits. None of this may hand out a monitor twice.
+  std::set<Monitor*> monitors;
+  for (size_t i = 0; i < 100; ++i) {
+    Monitor* mon = MonitorPool::CreateMonitor(self, self, nullptr, static_cast<int32_t>(i));
+    VerifyMonitor(mon, self);
+    EXPECT_TRUE(monitors.insert(mon).second);
+    if (i % 7 == 0) {
+      MonitorPool::ReleaseThreadCache(self);
+    }
+  }
+  for (Monitor* mon : monitors) {
+    MonitorPool::ReleaseMonitor(self, mon);
+  }
+  MonitorPool::ReleaseThreadCache(self);
+}
+
 }  // namespace art
@@ -24,6 +24,7 @@
 #include "class_linker-inl.h"
 #include "common_runtime_test.h"
 #include "handle_scope-inl.h"
+#include "lock_word.h"
 #include "mirror/class-inl.h"
 #include "mirror/string-inl.h"  // Strings are easiest to allocate
 #include "object_lock.h"
@@ -290,6 +291,61 @@ static void CommonWaitSetup(MonitorTest* test, ClassLinker* class_linker, uint64
   thread_pool.StopWorkers(self);
 }
 
+// Inflates the lock of `obj` without a hash code, by overflowing the thin lock count.
+static void InflateWithoutHashCode(Thread* self, Handle<mirror::Object> obj)
+    REQUIRES_SHARED(Locks::mutator_lock_) NO_THREAD_SAFETY_ANALYSIS {
+  for (size_t i = 0; i <= LockWord::kThinLockMaxCount + 1; ++i) {
+    Monitor::MonitorEnter(self, obj.Get(), /* trylock */ false);
+  }
+  EXPECT_EQ(LockWord::kFatLocked, obj->GetLockWord(true).GetState());
+  for (size_t i = 0; i <= LockWord::kThinLockMaxCount + 1; ++i) {
+    Monitor::MonitorExit(self, obj.Get());
+  }
+}
+
+// Test that idle monitors are deflated without suspending the mutators, and keep their hash code.
+TEST_F(MonitorTest, DeflateIdleMonitors) {
+  Thread* const self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  StackHandleScope<3> hs(self);
+  Handle<mirror::Object> hashed(
+      hs.NewHandle<mirror::Object>(mirror::String::AllocFromModifiedUtf8(self, "hashed")));
+  Handle<mirror::Object> plain(
+      hs.NewHandle<mirror::Object>(mirror::String::AllocFromModifiedUtf8(self, "plain")));
+  Handle<mirror::Object> held(
+      hs.NewHandle<mirror::Object>(mirror::String::AllocFromModifiedUtf8(self, "held")));
+  int32_t hash_code;
+  {
+    // Hashing a thin locked object inflates its lock.
+    ObjectLock<mirror::Object> lock(self, hashed);
+    hash_code = hashed->IdentityHashCode();
+    ASSERT_EQ(LockWord::kFatLocked, hashed->GetLockWord(true).GetState());
+  }
+  InflateWithoutHashCode(self, plain);
+  {
+    ObjectLock<mirror::Object> lock(self, held);
+    held->IdentityHashCode();
+    ASSERT_EQ(LockWord::kFatLocked, held->GetLockWord(true).GetState());
+    size_t count;
+    {
+      ScopedThreadSuspension sts(self, kNative);
+      count = Runtime::Current()->GetMonitorList()->DeflateIdleMonitors(self);
+    }
+    EXPECT_GE(count, 2u);
+    // The owned monitor stays.
+    EXPECT_EQ(LockWord::kFatLocked, held->GetLockWord(true).GetState());
+  }
+  EXPECT_EQ(LockWord::kHashCode, hashed->GetLockWord(true).GetState());
+  EXPECT_EQ(hash_code, hashed->IdentityHashCode());
+  EXPECT_EQ(LockWord::kUnlocked, plain->GetLockWord(true).GetState());
+  // Deflated objects can be locked again.
+  {
+    ObjectLock<mirror::Object> lock(self, plain);
+    EXPECT_EQ(LockWord::kThinLocked, plain->GetLockWord(true).GetState());
+  }
+  InflateWithoutHashCode(self, plain);
+}
+
 
 // First test: throwing an exception when trying to wait in Monitor with another thread.
 TEST_F(MonitorTest, CheckExceptionsWait1) {
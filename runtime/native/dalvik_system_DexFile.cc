@@ -291,6 +291,9 @@ static jobject DexFile_openDexFileNative(JNIEnv* env,
   if (!dex_files.empty()) {
     jlongArray array = ConvertDexFilesToJavaArray(env, oat_file, dex_files);
     if (array == nullptr) {
+      for (auto& dex_file : dex_files) {
+        runtime->GetOatFileManager().ForgetDexFileVerification(Thread::Current(), *dex_file);
+      }
       ScopedObjectAccess soa(env);
       for (auto& dex_file : dex_files) {
         if (linker->IsDexFileRegistered(soa.Self(), *dex_file)) {
@@ -322,6 +325,12 @@ static jboolean DexFile_closeDexFile(JNIEnv* env, jclass, jobject cookie) {
     return JNI_FALSE;
   }
   Runtime* const runtime = Runtime::Current();
+  // A dex file may still be verified in the background, wait before deleting it.
+  for (const DexFile* dex_file : dex_files) {
+    if (dex_file != nullptr) {
+      runtime->GetOatFileManager().ForgetDexFileVerification(Thread::Current(), *dex_file);
+    }
+  }
   bool all_deleted = true;
   {
     ScopedObjectAccess soa(env);
@@ -379,7 +388,13 @@ static jclass DexFile_defineClassNative(JNIEnv* env,
   }
   const std::string descriptor(DotToDescriptor(class_name.c_str()));
   const size_t hash(ComputeModifiedUtf8Hash(descriptor.c_str()));
+  OatFileManager& oat_file_manager = Runtime::Current()->GetOatFileManager();
   for (auto& dex_file : dex_files) {
+    std::string error_msg;
+    if (!oat_file_manager.WaitForDexFileVerification(Thread::Current(), *dex_file, &error_msg)) {
+      VLOG(class_linker) << error_msg;
+      continue;
+    }
     const DexFile::ClassDef* dex_class_def =
         OatDexFile::FindClassDef(*dex_file, descriptor.c_str(), hash);
     if (dex_class_def != nullptr) {
@@ -435,7 +450,13 @@ static jobjectArray DexFile_getClassNameList(JNIEnv* env, jclass, jobject cookie
   // Push all class descriptors into a set. Use set instead of unordered_set as we want to
   // retrieve all in the end.
   std::set<const char*, CharPointerComparator> descriptors;
+  OatFileManager& oat_file_manager = Runtime::Current()->GetOatFileManager();
   for (auto& dex_file : dex_files) {
+    std::string error_msg;
+    if (!oat_file_manager.WaitForDexFileVerification(Thread::Current(), *dex_file, &error_msg)) {
+      VLOG(class_linker) << error_msg;
+      continue;
+    }
     for (size_t i = 0; i < dex_file->NumClassDefs(); ++i) {
       const DexFile::ClassDef& class_def = dex_file->GetClassDef(i);
       const char* descriptor = dex_file->GetClassDescriptor(class_def);
@@ -246,7 +246,12 @@ static void VMDebug_dumpHprofData(JNIEnv* env, jclass, jstring javaFilename, jin
 
   int fd = javaFd;
 
-  hprof::DumpHeap(filename.c_str(), fd, false);
+  Runtime* runtime = Runtime::Current();
+  if (runtime->UseForkedHprof()) {
+    hprof::DumpHeapForked(filename.c_str(), fd, runtime->UseCompressedHprof());
+  } else {
+    hprof::DumpHeap(filename.c_str(), fd, false, runtime->UseCompressedHprof());
+  }
 }
 
 static void VMDebug_dumpHprofDataDdms(JNIEnv*, jclass) {
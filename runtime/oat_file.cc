@@ -527,6 +527,11 @@ bool OatFileBase::Setup(int zip_fd, const char* abs_dex_location, std::string* e
                               key_value_store_size);
     return false;
   }
+  const char* compiler_filter = GetOatHeader().GetStoreValueByKey(OatHeader::kCompilerFilter);
+  has_compiler_filter_ = compiler_filter != nullptr &&
+      CompilerFilter::ParseCompilerFilter(compiler_filter, &compiler_filter_);
+  is_pic_ = GetOatHeader().IsPic();
+  is_debuggable_ = GetOatHeader().IsDebuggable();
 
   size_t oat_dex_files_offset = GetOatHeader().GetOatDexFilesOffset();
   if (oat_dex_files_offset < GetOatHeader().GetHeaderSize() || oat_dex_files_offset > Size()) {
@@ -1547,6 +1552,10 @@ OatFile::OatFile(const std::string& location, bool is_executable)
       bss_methods_(nullptr),
       bss_roots_(nullptr),
       is_executable_(is_executable),
+      has_compiler_filter_(false),
+      compiler_filter_(CompilerFilter::kDefaultCompilerFilter),
+      is_pic_(false),
+      is_debuggable_(false),
       vdex_begin_(nullptr),
       vdex_end_(nullptr),
       secondary_lookup_lock_("OatFile secondary lookup lock", kOatFileSecondaryLookupLock) {
@@ -1939,16 +1948,17 @@ void OatFile::OatMethod::LinkMethod(ArtMethod* method) const {
 }
 
 bool OatFile::IsPic() const {
-  return GetOatHeader().IsPic();
+  return is_pic_;
   // TODO: Check against oat_patches. b/18144996
 }
 
 bool OatFile::IsDebuggable() const {
-  return GetOatHeader().IsDebuggable();
+  return is_debuggable_;
 }
 
 CompilerFilter::Filter OatFile::GetCompilerFilter() const {
-  return GetOatHeader().GetCompilerFilter();
+  // Without a valid cached value let the OatHeader report the error.
+  return has_compiler_filter_ ? compiler_filter_ : GetOatHeader().GetCompilerFilter();
 }
 
 std::string OatFile::GetClassLoaderContext() const {
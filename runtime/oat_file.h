@@ -378,6 +378,13 @@ class OatFile {
   // Was this oat_file loaded executable?
   const bool is_executable_;
 
+  // Values from the key-value store of the OatHeader, cached by OatFileBase::Setup()
+  // to avoid searching the store and parsing the values on every query.
+  bool has_compiler_filter_;
+  CompilerFilter::Filter compiler_filter_;
+  bool is_pic_;
+  bool is_debuggable_;
+
   // Pointer to the .vdex section, if present, otherwise null.
   uint8_t* vdex_begin_;
 
@@ -39,6 +39,7 @@
 #include "hidden_api.h"
 #include "image.h"
 #include "oat.h"
+#include "oat_file_manager.h"
 #include "runtime.h"
 #include "scoped_thread_state_change-inl.h"
 #include "vdex_file.h"
@@ -893,15 +894,36 @@ const std::vector<uint32_t>* OatFileAssistant::GetRequiredDexChecksums() {
     required_dex_checksums_attempted_ = true;
     required_dex_checksums_found_ = false;
     cached_required_dex_checksums_.clear();
+    // Class loaders opening the same file reuse the checksums read by the first one.
+    Runtime* runtime = Runtime::Current();
+    OatFileManager* oat_file_manager =
+        (runtime != nullptr && zip_fd_ < 0) ? &runtime->GetOatFileManager() : nullptr;
+    struct stat dex_stat;
+    if (oat_file_manager != nullptr && stat(dex_location_.c_str(), &dex_stat) != 0) {
+      oat_file_manager = nullptr;
+    }
     std::string error_msg;
     const ArtDexFileLoader dex_file_loader;
-    if (dex_file_loader.GetMultiDexChecksums(dex_location_.c_str(),
-                                             &cached_required_dex_checksums_,
-                                             &error_msg,
-                                             zip_fd_,
-                                             &zip_file_only_contains_uncompressed_dex_)) {
+    if (oat_file_manager != nullptr &&
+        oat_file_manager->FindDexChecksums(dex_location_,
+                                           dex_stat,
+                                           &cached_required_dex_checksums_,
+                                           &zip_file_only_contains_uncompressed_dex_)) {
+      required_dex_checksums_found_ = true;
+      has_original_dex_files_ = true;
+    } else if (dex_file_loader.GetMultiDexChecksums(dex_location_.c_str(),
+                                                    &cached_required_dex_checksums_,
+                                                    &error_msg,
+                                                    zip_fd_,
+                                                    &zip_file_only_contains_uncompressed_dex_)) {
       required_dex_checksums_found_ = true;
       has_original_dex_files_ = true;
+      if (oat_file_manager != nullptr) {
+        oat_file_manager->AddDexChecksums(dex_location_,
+                                          dex_stat,
+                                          cached_required_dex_checksums_,
+                                          zip_file_only_contains_uncompressed_dex_);
+      }
     } else {
       // This can happen if the original dex file has been stripped from the
       // apk.
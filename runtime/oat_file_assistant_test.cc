@@ -38,6 +38,7 @@
 #include "oat_file_manager.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
+#include "ziparchive/zip_writer.h"
 
 namespace art {
 
@@ -1568,6 +1569,113 @@ TEST_F(OatFileAssistantTest, SystemOdex) {
   }
 }
 
+class OatFileAssistantBackgroundVerificationTest : public OatFileAssistantTest {
+ public:
+  void SetUpRuntimeOptions(RuntimeOptions* options) OVERRIDE {
+    OatFileAssistantTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-XX:BackgroundVerificationThreads:2", nullptr));
+  }
+
+  // Write a jar whose classes.dex is the Main test dex file, with its last byte changed if
+  // `corrupt`, which fails the dex file checksum.
+  void WriteJar(const std::string& jar_location, bool corrupt) {
+    std::unique_ptr<const DexFile> main(OpenTestDexFile("Main"));
+    ASSERT_TRUE(main != nullptr);
+    std::vector<uint8_t> data(main->Begin(), main->Begin() + main->Size());
+    if (corrupt) {
+      data.back() ^= 0xffu;
+    }
+    FILE* file = fopen(jar_location.c_str(), "wb");
+    ASSERT_TRUE(file != nullptr);
+    ZipWriter writer(file);
+    ASSERT_EQ(0, writer.StartEntry("classes.dex", ZipWriter::kAlign32));
+    ASSERT_EQ(0, writer.WriteBytes(data.data(), data.size()));
+    ASSERT_EQ(0, writer.FinishEntry());
+    ASSERT_EQ(0, writer.Finish());
+    fclose(file);
+  }
+
+  std::vector<std::unique_ptr<const DexFile>> OpenDexFiles(const std::string& dex_location) {
+    std::vector<std::string> error_msgs;
+    const OatFile* oat_file = nullptr;
+    std::vector<std::unique_ptr<const DexFile>> dex_files =
+        Runtime::Current()->GetOatFileManager().OpenDexFilesFromOat(dex_location.c_str(),
+                                                                     /* class_loader */ nullptr,
+                                                                     /* dex_elements */ nullptr,
+                                                                     &oat_file,
+                                                                     &error_msgs);
+    EXPECT_EQ(1u, dex_files.size()) << android::base::Join(error_msgs, '\n');
+    EXPECT_TRUE(oat_file == nullptr);
+    return dex_files;
+  }
+};
+
+// Case: We have a dex file without oat file and background verification is enabled.
+// Expect: The dex file is opened without verifying it, and its users get the verification
+// result when waiting for it.
+TEST_F(OatFileAssistantBackgroundVerificationTest, VerifiedDexFile) {
+  std::string dex_location = GetScratchDir() + "/BackgroundVerified.jar";
+  WriteJar(dex_location, /* corrupt */ false);
+
+  std::vector<std::unique_ptr<const DexFile>> dex_files = OpenDexFiles(dex_location);
+  ASSERT_EQ(1u, dex_files.size());
+  OatFileManager& oat_file_manager = Runtime::Current()->GetOatFileManager();
+  std::string error_msg;
+  EXPECT_TRUE(oat_file_manager.WaitForDexFileVerification(
+      Thread::Current(), *dex_files[0], &error_msg)) << error_msg;
+  // Verified dex files are forgotten.
+  EXPECT_FALSE(oat_file_manager.HasUnverifiedDexFiles());
+}
+
+TEST_F(OatFileAssistantBackgroundVerificationTest, CorruptDexFile) {
+  std::string dex_location = GetScratchDir() + "/BackgroundCorrupt.jar";
+  WriteJar(dex_location, /* corrupt */ true);
+
+  std::vector<std::unique_ptr<const DexFile>> dex_files = OpenDexFiles(dex_location);
+  ASSERT_EQ(1u, dex_files.size());
+  OatFileManager& oat_file_manager = Runtime::Current()->GetOatFileManager();
+  std::string error_msg;
+  EXPECT_FALSE(oat_file_manager.WaitForDexFileVerification(
+      Thread::Current(), *dex_files[0], &error_msg));
+  EXPECT_FALSE(error_msg.empty());
+  // The failure sticks until the dex file is deleted.
+  EXPECT_TRUE(oat_file_manager.HasUnverifiedDexFiles());
+  error_msg.clear();
+  EXPECT_FALSE(oat_file_manager.WaitForDexFileVerification(
+      Thread::Current(), *dex_files[0], &error_msg));
+  EXPECT_FALSE(error_msg.empty());
+  oat_file_manager.ForgetDexFileVerification(Thread::Current(), *dex_files[0]);
+  EXPECT_FALSE(oat_file_manager.HasUnverifiedDexFiles());
+}
+
+// Checksums read from a dex location are reused until the file changes.
+TEST_F(OatFileAssistantTest, DexChecksumsCache) {
+  std::string dex_location = GetScratchDir() + "/DexChecksumsCache.jar";
+  Copy(GetDexSrc1(), dex_location);
+
+  OatFileAssistant oat_file_assistant(dex_location.c_str(), kRuntimeISA, false);
+  EXPECT_TRUE(oat_file_assistant.HasOriginalDexFiles());
+
+  struct stat dex_stat;
+  ASSERT_EQ(0, stat(dex_location.c_str(), &dex_stat));
+  OatFileManager& oat_file_manager = Runtime::Current()->GetOatFileManager();
+  std::vector<uint32_t> checksums;
+  bool only_contains_uncompressed_dex = false;
+  ASSERT_TRUE(oat_file_manager.FindDexChecksums(
+      dex_location, dex_stat, &checksums, &only_contains_uncompressed_dex));
+  EXPECT_EQ(1u, checksums.size());
+
+  // A different size or modification time means the file was replaced.
+  struct stat changed_stat = dex_stat;
+  changed_stat.st_size += 1;
+  EXPECT_FALSE(oat_file_manager.FindDexChecksums(
+      dex_location, changed_stat, &checksums, &only_contains_uncompressed_dex));
+  changed_stat = dex_stat;
+  changed_stat.st_mtim.tv_nsec ^= 1;
+  EXPECT_FALSE(oat_file_manager.FindDexChecksums(
+      dex_location, changed_stat, &checksums, &only_contains_uncompressed_dex));
+}
+
 // TODO: More Tests:
 //  * Test class linker falls back to unquickened dex for DexNoOat
 //  * Test class linker falls back to unquickened dex for MultiDexNoOat
@@ -16,6 +16,7 @@
 
 #include "oat_file_manager.h"
 
+#include <algorithm>
 #include <memory>
 #include <queue>
 #include <vector>
@@ -35,18 +36,24 @@
 #include "dex/dex_file-inl.h"
 #include "dex/dex_file_loader.h"
 #include "dex/dex_file_tracking_registrar.h"
+#include "dex/dex_file_verifier.h"
 #include "gc/scoped_gc_critical_section.h"
 #include "gc/space/image_space.h"
 #include "handle_scope-inl.h"
+#include "java_vm_ext.h"
+#include "jit/profile_compilation_info.h"
 #include "jni_internal.h"
+#include "mirror/class-inl.h"
 #include "mirror/class_loader.h"
 #include "mirror/object-inl.h"
 #include "oat_file.h"
 #include "oat_file_assistant.h"
 #include "obj_ptr-inl.h"
+#include "runtime.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "well_known_classes.h"
 
 namespace art {
@@ -143,7 +150,14 @@ const OatFile* OatFileManager::GetPrimaryOatFile() const {
 }
 
 OatFileManager::OatFileManager()
-    : have_non_pic_oat_file_(false), only_use_system_oat_files_(false) {}
+    : have_non_pic_oat_file_(false),
+      only_use_system_oat_files_(false),
+      thread_pool_deleted_(false),
+      dex_file_verification_lock_("Dex file verification lock"),
+      dex_file_verification_cond_("Dex file verification condition",
+                                  dex_file_verification_lock_),
+      num_unverified_dex_files_(0u),
+      dex_checksums_lock_("Dex checksums lock") {}
 
 OatFileManager::~OatFileManager() {
   // Explicitly clear oat_files_ since the OatFile destructor calls back into OatFileManager for
@@ -357,7 +371,7 @@ static bool CollisionCheck(std::vector<const DexFile*>& dex_files_loaded,
 // new oat file. Any disagreement indicates a collision.
 bool OatFileManager::HasCollisions(const OatFile* oat_file,
                                    const ClassLoaderContext* context,
-                                   std::string* error_msg /*out*/) const {
+                                   std::string* error_msg /*out*/) {
   DCHECK(oat_file != nullptr);
   DCHECK(error_msg != nullptr);
 
@@ -380,6 +394,18 @@ bool OatFileManager::HasCollisions(const OatFile* oat_file,
   // The class loader context does not match. Perform a full duplicate classes check.
 
   std::vector<const DexFile*> dex_files_loaded = context->FlattenOpenedDexFiles();
+  if (HasUnverifiedDexFiles()) {
+    // The check reads the classes of the loaded dex files, some of which may still be verified
+    // in the background. Those that failed verification define no classes.
+    Thread* const self = Thread::Current();
+    auto failed_verification = [&](const DexFile* dex_file) {
+      std::string verify_error_msg;
+      return !WaitForDexFileVerification(self, *dex_file, &verify_error_msg);
+    };
+    dex_files_loaded.erase(
+        std::remove_if(dex_files_loaded.begin(), dex_files_loaded.end(), failed_verification),
+        dex_files_loaded.end());
+  }
 
   // Vector that holds the newly opened dex files live, this is done to prevent leaks.
   std::vector<std::unique_ptr<const DexFile>> opened_dex_files;
@@ -611,16 +637,22 @@ std::vector<std::unique_ptr<const DexFile>> OatFileManager::OpenDexFilesFromOat(
     if (oat_file_assistant.HasOriginalDexFiles()) {
       if (Runtime::Current()->IsDexFileFallbackEnabled()) {
         static constexpr bool kVerifyChecksum = true;
+        // The dex file verifier reads each whole dex file. With background verification, it
+        // runs on the background threads instead, while the caller goes on with the dex files.
+        const bool verify = Runtime::Current()->IsVerificationEnabled();
+        const bool verify_in_background = verify && VerifyDexFilesInBackground();
         const ArtDexFileLoader dex_file_loader;
         if (!dex_file_loader.Open(dex_location,
                                   dex_location,
-                                  Runtime::Current()->IsVerificationEnabled(),
+                                  verify && !verify_in_background,
                                   kVerifyChecksum,
                                   /*out*/ &error_msg,
                                   &dex_files)) {
           LOG(WARNING) << error_msg;
           error_msgs->push_back("Failed to open dex files from " + std::string(dex_location)
                                 + " because: " + error_msg);
+        } else if (verify_in_background) {
+          StartBackgroundDexFileVerification(dex_files);
         }
       } else {
         error_msgs->push_back("Fallback mode disabled, skipping dex files.");
@@ -634,6 +666,379 @@ std::vector<std::unique_ptr<const DexFile>> OatFileManager::OpenDexFilesFromOat(
   return dex_files;
 }
 
+static bool IsSameFile(const struct stat& st,
+                       dev_t dev,
+                       ino_t ino,
+                       off_t size,
+                       const struct timespec& mtime) {
+  return st.st_dev == dev &&
+         st.st_ino == ino &&
+         st.st_size == size &&
+         st.st_mtim.tv_sec == mtime.tv_sec &&
+         st.st_mtim.tv_nsec == mtime.tv_nsec;
+}
+
+bool OatFileManager::FindDexChecksums(const std::string& dex_location,
+                                      const struct stat& dex_stat,
+                                      /*out*/ std::vector<uint32_t>* checksums,
+                                      /*out*/ bool* only_contains_uncompressed_dex) {
+  MutexLock mu(Thread::Current(), dex_checksums_lock_);
+  auto it = dex_checksums_.find(dex_location);
+  if (it == dex_checksums_.end()) {
+    return false;
+  }
+  const DexChecksums& entry = it->second;
+  if (!IsSameFile(dex_stat, entry.dev, entry.ino, entry.size, entry.mtime)) {
+    // The file was replaced or modified, the entry is going to be replaced as well.
+    return false;
+  }
+  *checksums = entry.checksums;
+  *only_contains_uncompressed_dex = entry.only_contains_uncompressed_dex;
+  return true;
+}
+
+void OatFileManager::AddDexChecksums(const std::string& dex_location,
+                                     const struct stat& dex_stat,
+                                     const std::vector<uint32_t>& checksums,
+                                     bool only_contains_uncompressed_dex) {
+  MutexLock mu(Thread::Current(), dex_checksums_lock_);
+  DexChecksums& entry = dex_checksums_[dex_location];
+  entry.dev = dex_stat.st_dev;
+  entry.ino = dex_stat.st_ino;
+  entry.size = dex_stat.st_size;
+  entry.mtime = dex_stat.st_mtim;
+  entry.checksums = checksums;
+  entry.only_contains_uncompressed_dex = only_contains_uncompressed_dex;
+}
+
+// Runs the dex file verifier over a dex file that OpenDexFilesFromOat() opened without it, unless
+// a thread that needed the dex file already did.
+class BackgroundDexFileVerificationTask FINAL : public SelfDeletingTask {
+ public:
+  explicit BackgroundDexFileVerificationTask(const DexFile& dex_file) : dex_file_(dex_file) {}
+
+  void Run(Thread* self) OVERRIDE {
+    Runtime::Current()->GetOatFileManager().VerifyDexFileIfPending(self, dex_file_);
+  }
+
+ private:
+  // Only dereferenced once the verification is claimed, the dex file may be gone otherwise.
+  const DexFile& dex_file_;
+
+  DISALLOW_COPY_AND_ASSIGN(BackgroundDexFileVerificationTask);
+};
+
+bool OatFileManager::VerifyDexFilesInBackground() const {
+  Runtime* const runtime = Runtime::Current();
+  return !runtime->IsAotCompiler() &&
+         !runtime->IsZygote() &&
+         runtime->GetBackgroundVerificationThreads() != 0u;
+}
+
+void OatFileManager::StartBackgroundDexFileVerification(
+    const std::vector<std::unique_ptr<const DexFile>>& dex_files) {
+  Thread* const self = Thread::Current();
+  {
+    MutexLock mu(self, dex_file_verification_lock_);
+    for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
+      dex_file_verifications_.emplace(dex_file.get(), DexFileVerification());
+    }
+    num_unverified_dex_files_.StoreRelease(dex_file_verifications_.size());
+  }
+  bool added_tasks = false;
+  {
+    ScopedObjectAccess soa(self);
+    ThreadPool* const pool =
+        GetOrCreateThreadPool(self, Runtime::Current()->GetBackgroundVerificationThreads());
+    if (pool != nullptr) {
+      for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
+        VLOG(class_linker) << "Verifying dex file " << dex_file->GetLocation()
+                           << " in the background";
+        pool->AddTask(self, new BackgroundDexFileVerificationTask(*dex_file));
+      }
+      added_tasks = true;
+    }
+  }
+  if (!added_tasks) {
+    // The pool was deleted for shutdown.
+    for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
+      VerifyDexFileIfPending(self, *dex_file);
+    }
+  }
+}
+
+void OatFileManager::VerifyDexFileIfPending(Thread* self, const DexFile& dex_file) {
+  {
+    MutexLock mu(self, dex_file_verification_lock_);
+    auto it = dex_file_verifications_.find(&dex_file);
+    if (it == dex_file_verifications_.end() ||
+        it->second.state != DexFileVerificationState::kPending) {
+      return;
+    }
+    it->second.state = DexFileVerificationState::kRunning;
+  }
+  RunDexFileVerification(self, dex_file);
+}
+
+void OatFileManager::RunDexFileVerification(Thread* self, const DexFile& dex_file) {
+  ScopedTrace trace("Verify dex file " + dex_file.GetLocation());
+  std::string error_msg;
+  const bool verified = DexFileVerifier::Verify(&dex_file,
+                                                dex_file.Begin(),
+                                                dex_file.Size(),
+                                                dex_file.GetLocation().c_str(),
+                                                /* verify_checksum */ true,
+                                                &error_msg);
+  if (!verified) {
+    LOG(WARNING) << "Dex file " << dex_file.GetLocation() << " failed verification, its classes "
+                 << "will not be available: " << error_msg;
+  }
+  MutexLock mu(self, dex_file_verification_lock_);
+  auto it = dex_file_verifications_.find(&dex_file);
+  DCHECK(it != dex_file_verifications_.end());
+  DCHECK(it->second.state == DexFileVerificationState::kRunning);
+  if (verified) {
+    dex_file_verifications_.erase(it);
+    num_unverified_dex_files_.StoreRelease(dex_file_verifications_.size());
+  } else {
+    it->second.state = DexFileVerificationState::kFailed;
+    it->second.error_msg = std::move(error_msg);
+  }
+  dex_file_verification_cond_.Broadcast(self);
+}
+
+bool OatFileManager::WaitForDexFileVerification(Thread* self,
+                                                const DexFile& dex_file,
+                                                std::string* error_msg) {
+  if (!HasUnverifiedDexFiles()) {
+    return true;
+  }
+  while (true) {
+    {
+      MutexLock mu(self, dex_file_verification_lock_);
+      auto it = dex_file_verifications_.find(&dex_file);
+      if (it == dex_file_verifications_.end()) {
+        return true;
+      }
+      if (it->second.state == DexFileVerificationState::kFailed) {
+        *error_msg = it->second.error_msg;
+        return false;
+      }
+      if (it->second.state == DexFileVerificationState::kRunning) {
+        dex_file_verification_cond_.Wait(self);
+        continue;
+      }
+      // Rather than waiting for a background thread to get to it, verify the dex file here.
+      it->second.state = DexFileVerificationState::kRunning;
+    }
+    RunDexFileVerification(self, dex_file);
+  }
+}
+
+void OatFileManager::ForgetDexFileVerification(Thread* self, const DexFile& dex_file) {
+  if (!HasUnverifiedDexFiles()) {
+    return;
+  }
+  MutexLock mu(self, dex_file_verification_lock_);
+  while (true) {
+    auto it = dex_file_verifications_.find(&dex_file);
+    if (it == dex_file_verifications_.end()) {
+      return;
+    }
+    if (it->second.state == DexFileVerificationState::kRunning) {
+      dex_file_verification_cond_.Wait(self);
+      continue;
+    }
+    dex_file_verifications_.erase(it);
+    num_unverified_dex_files_.StoreRelease(dex_file_verifications_.size());
+    return;
+  }
+}
+
+// Loads and verifies classes of a dex file through the class loader the dex file was registered
+// with.
+class BackgroundClassLoadingTask FINAL : public SelfDeletingTask {
+ public:
+  BackgroundClassLoadingTask(const DexFile& dex_file,
+                             jobject class_loader,
+                             std::vector<dex::TypeIndex>&& types)
+      : dex_file_(dex_file),
+        class_loader_(class_loader),
+        types_(std::move(types)) {}
+
+  ~BackgroundClassLoadingTask() {
+    Runtime::Current()->GetJavaVM()->DeleteGlobalRef(Thread::Current(), class_loader_);
+  }
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    StackHandleScope<2> hs(self);
+    Handle<mirror::ClassLoader> class_loader =
+        hs.NewHandle(soa.Decode<mirror::ClassLoader>(class_loader_));
+    MutableHandle<mirror::Class> klass = hs.NewHandle<mirror::Class>(nullptr);
+    Runtime* const runtime = Runtime::Current();
+    ClassLinker* const class_linker = runtime->GetClassLinker();
+    const bool verify = runtime->IsVerificationEnabled();
+    for (dex::TypeIndex type_idx : types_) {
+      const char* descriptor = dex_file_.StringByTypeIdx(type_idx);
+      // Pool threads cannot call into Java, so this only loads classes through class loaders
+      // the runtime can walk itself, and does not run any class loader code.
+      klass.Assign(class_linker->FindClass(self, descriptor, class_loader));
+      if (klass == nullptr) {
+        self->ClearException();
+        continue;
+      }
+      // The class may be defined by another dex file, for instance in a parent class loader.
+      // Only verify resolved classes, others are already verified or being verified.
+      if (!verify ||
+          &klass->GetDexFile() != &dex_file_ ||
+          klass->GetStatus() != ClassStatus::kResolved) {
+        continue;
+      }
+      class_linker->VerifyClass(self, klass);
+      // A verification failure is recorded in the class, and thrown again to the thread
+      // initializing it.
+      self->ClearException();
+    }
+  }
+
+ private:
+  const DexFile& dex_file_;
+  const jobject class_loader_;
+  const std::vector<dex::TypeIndex> types_;
+
+  DISALLOW_COPY_AND_ASSIGN(BackgroundClassLoadingTask);
+};
+
+ThreadPool* OatFileManager::GetOrCreateThreadPool(Thread* self, size_t thread_count) {
+  {
+    // Creating the pool attaches its threads, do not block suspension meanwhile.
+    ScopedThreadSuspension sts(self, kNative);
+    WriterMutexLock mu(self, *Locks::oat_file_manager_lock_);
+    if (thread_pool_deleted_) {
+      return nullptr;
+    }
+    if (thread_pool_ == nullptr) {
+      thread_pool_.reset(new ThreadPool("Background class loading thread pool", thread_count));
+      thread_pool_->StartWorkers(self);
+    }
+  }
+  // The pool is only deleted with all threads suspended, so it stays valid while we are
+  // runnable. Tasks are added without holding the lock, which is below the queue lock.
+  ReaderMutexLock mu(self, *Locks::oat_file_manager_lock_);
+  return thread_pool_.get();
+}
+
+void OatFileManager::RunBackgroundClassLoading(const DexFile& dex_file,
+                                               Handle<mirror::ClassLoader> class_loader) {
+  Runtime* const runtime = Runtime::Current();
+  if (runtime->IsAotCompiler() || runtime->IsZygote() || class_loader == nullptr) {
+    return;
+  }
+  Thread* const self = Thread::Current();
+  std::vector<dex::TypeIndex> types;
+  size_t thread_count = 0u;
+  if (dex_file.GetOatDexFile() == nullptr &&
+      runtime->IsVerificationEnabled() &&
+      runtime->GetBackgroundVerificationThreads() != 0u) {
+    VLOG(class_linker) << "Verifying " << dex_file.GetLocation() << " in the background";
+    thread_count = runtime->GetBackgroundVerificationThreads();
+    types.reserve(dex_file.NumClassDefs());
+    for (uint32_t i = 0; i != dex_file.NumClassDefs(); ++i) {
+      types.push_back(dex_file.GetClassDef(i).class_idx_);
+    }
+  } else if (runtime->GetStartupClassPreloadThreads() != 0u) {
+    ReaderMutexLock mu(self, *Locks::oat_file_manager_lock_);
+    if (startup_profile_ == nullptr) {
+      return;
+    }
+    for (const DexCacheResolvedClasses& classes :
+         startup_profile_->GetResolvedClasses({&dex_file})) {
+      for (dex::TypeIndex type_idx : classes.GetClasses()) {
+        // Classes of other dex files, typically of the boot class path, are loaded already.
+        if (type_idx.index_ < dex_file.NumTypeIds() && dex_file.FindClassDef(type_idx) != nullptr) {
+          types.push_back(type_idx);
+        }
+      }
+    }
+    if (!types.empty()) {
+      VLOG(class_linker) << "Preloading " << types.size() << " startup classes of "
+                         << dex_file.GetLocation();
+    }
+    thread_count = runtime->GetStartupClassPreloadThreads();
+    // Load the classes in type index order, which follows the order of the descriptors.
+    std::sort(types.begin(), types.end());
+  }
+  if (types.empty()) {
+    return;
+  }
+  ThreadPool* const pool = GetOrCreateThreadPool(
+      self,
+      std::max(runtime->GetBackgroundVerificationThreads(),
+               runtime->GetStartupClassPreloadThreads()));
+  if (pool == nullptr) {
+    return;  // Deleted for shutdown.
+  }
+  // Split the classes in a few tasks per thread to balance the work.
+  const size_t num_tasks = std::min<size_t>(types.size(), thread_count * 4u);
+  const size_t types_per_task = RoundUp(types.size(), num_tasks) / num_tasks;
+  JavaVMExt* const vm = runtime->GetJavaVM();
+  for (size_t begin = 0u; begin < types.size(); begin += types_per_task) {
+    const size_t end = std::min(types.size(), begin + types_per_task);
+    pool->AddTask(self,
+                  new BackgroundClassLoadingTask(
+                      dex_file,
+                      vm->AddGlobalRef(self, class_loader.Get()),
+                      std::vector<dex::TypeIndex>(types.begin() + begin, types.begin() + end)));
+  }
+}
+
+void OatFileManager::SetStartupProfile(std::unique_ptr<const ProfileCompilationInfo> profile) {
+  WriterMutexLock mu(Thread::Current(), *Locks::oat_file_manager_lock_);
+  if (startup_profile_ == nullptr) {
+    startup_profile_ = std::move(profile);
+  }
+}
+
+bool OatFileManager::IsInStartupProfile(const DexFile& dex_file) {
+  ReaderMutexLock mu(Thread::Current(), *Locks::oat_file_manager_lock_);
+  if (startup_profile_ == nullptr) {
+    return false;
+  }
+  for (const DexCacheResolvedClasses& classes :
+       startup_profile_->GetResolvedClasses({&dex_file})) {
+    if (!classes.GetClasses().empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void OatFileManager::DeleteThreadPool() {
+  Thread* const self = Thread::Current();
+  DCHECK(Runtime::Current()->IsShuttingDown(self));
+  {
+    // Wait for a thread creating the pool, and make sure it is not created again.
+    WriterMutexLock mu(self, *Locks::oat_file_manager_lock_);
+    thread_pool_deleted_ = true;
+    if (thread_pool_ == nullptr) {
+      return;
+    }
+  }
+  std::unique_ptr<ThreadPool> pool;
+  {
+    // Clear the pool while the threads are suspended, a mutator adding tasks checks against it.
+    ScopedSuspendAll ssa(__FUNCTION__);
+    WriterMutexLock mu(self, *Locks::oat_file_manager_lock_);
+    pool = std::move(thread_pool_);
+  }
+  // Drop the pending tasks, and wait for the running ones which only take a class or a dex file
+  // each. Dex files whose verification task was dropped get verified when first used.
+  pool->StopWorkers(self);
+  pool->RemoveAllTasks(self);
+  pool->Wait(self, /* do_work */ false, /* may_hold_locks */ false);
+}
+
 void OatFileManager::SetOnlyUseSystemOatFiles() {
   ReaderMutexLock mu(Thread::Current(), *Locks::oat_file_manager_lock_);
   CHECK_EQ(oat_files_.size(), GetBootOatFiles().size());
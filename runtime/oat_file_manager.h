@@ -17,12 +17,15 @@
 #ifndef ART_RUNTIME_OAT_FILE_MANAGER_H_
 #define ART_RUNTIME_OAT_FILE_MANAGER_H_
 
+#include <sys/stat.h>
+
 #include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "base/atomic.h"
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "jni.h"
@@ -35,9 +38,16 @@ class ImageSpace;
 }  // namespace space
 }  // namespace gc
 
+namespace mirror {
+class ClassLoader;
+}  // namespace mirror
+
 class ClassLoaderContext;
 class DexFile;
+template<class T> class Handle;
 class OatFile;
+class ProfileCompilationInfo;
+class ThreadPool;
 
 // Class for dealing with oat file management.
 //
@@ -95,18 +105,88 @@ class OatFileManager {
   // This method should not be called with the mutator_lock_ held, because it
   // could end up starving GC if we need to generate or relocate any oat
   // files.
+  //
+  // With background verification, the original dex files are returned before the dex file
+  // verifier ran over them, see WaitForDexFileVerification().
   std::vector<std::unique_ptr<const DexFile>> OpenDexFilesFromOat(
       const char* dex_location,
       jobject class_loader,
       jobjectArray dex_elements,
       /*out*/ const OatFile** out_oat_file,
       /*out*/ std::vector<std::string>* error_msgs)
-      REQUIRES(!Locks::oat_file_manager_lock_, !Locks::mutator_lock_);
+      REQUIRES(!Locks::oat_file_manager_lock_,
+               !dex_file_verification_lock_,
+               !Locks::mutator_lock_);
 
   void DumpForSigQuit(std::ostream& os);
 
   void SetOnlyUseSystemOatFiles();
 
+  // Load and verify classes of `dex_file`, which was just registered with `class_loader`, on a
+  // pool of background threads:
+  //  - all of its classes if the dex file has no oat file and background verification is
+  //    enabled,
+  //  - otherwise the classes of the startup profile, see SetStartupProfile().
+  // The classes are loaded through `class_loader` and not initialized; a thread initializing
+  // one of them only waits if the class is being loaded or verified at that time.
+  void RunBackgroundClassLoading(const DexFile& dex_file,
+                                 Handle<mirror::ClassLoader> class_loader)
+      REQUIRES(!Locks::oat_file_manager_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Set the profile whose classes are preloaded by RunBackgroundClassLoading() for the dex
+  // files registered from now on. Only the first profile set is used.
+  void SetStartupProfile(std::unique_ptr<const ProfileCompilationInfo> profile)
+      REQUIRES(!Locks::oat_file_manager_lock_);
+
+  // Return whether the startup profile lists classes of `dex_file`, which makes the dex file
+  // hot enough to get the larger dex cache arrays, see mirror::DexCache::InitializeDexCache().
+  bool IsInStartupProfile(const DexFile& dex_file) REQUIRES(!Locks::oat_file_manager_lock_);
+
+  // Stop background class loading and delete its thread pool. Only done at shutdown.
+  void DeleteThreadPool() REQUIRES(!Locks::oat_file_manager_lock_);
+
+  // Wait for the dex file verifier to be done with `dex_file`, which OpenDexFilesFromOat() may
+  // have left to the background threads, see StartBackgroundDexFileVerification(). The contents
+  // of a dex file beyond its header must not be read before. If the verification has not started
+  // yet, it is run on the calling thread.
+  // Returns false, with the reason in `error_msg`, if the dex file failed verification. Such a
+  // dex file defines no classes as far as its users are concerned.
+  bool WaitForDexFileVerification(Thread* self, const DexFile& dex_file, std::string* error_msg)
+      REQUIRES(!dex_file_verification_lock_, !Locks::mutator_lock_);
+
+  // Return whether some dex files are being verified in the background, or failed it. Callers
+  // holding the mutator lock can check this before suspending to call
+  // WaitForDexFileVerification().
+  bool HasUnverifiedDexFiles() const {
+    return num_unverified_dex_files_.LoadAcquire() != 0u;
+  }
+
+  // Forget the verification state of `dex_file`, which is about to be deleted. Waits for a
+  // verification in progress.
+  void ForgetDexFileVerification(Thread* self, const DexFile& dex_file)
+      REQUIRES(!dex_file_verification_lock_, !Locks::mutator_lock_);
+
+  // Run the dex file verifier on `dex_file` if no other thread did it yet. Used by the
+  // background verification tasks.
+  void VerifyDexFileIfPending(Thread* self, const DexFile& dex_file)
+      REQUIRES(!dex_file_verification_lock_);
+
+  // Process-wide cache of the checksums read from dex locations by the OatFileAssistant, so
+  // that class loaders opening the same file do not each open the zip archive again. Entries
+  // are only valid while the file has the given identity, size and modification time, as
+  // returned by stat().
+  bool FindDexChecksums(const std::string& dex_location,
+                        const struct stat& dex_stat,
+                        /*out*/ std::vector<uint32_t>* checksums,
+                        /*out*/ bool* only_contains_uncompressed_dex)
+      REQUIRES(!dex_checksums_lock_);
+  void AddDexChecksums(const std::string& dex_location,
+                       const struct stat& dex_stat,
+                       const std::vector<uint32_t>& checksums,
+                       bool only_contains_uncompressed_dex)
+      REQUIRES(!dex_checksums_lock_);
+
  private:
   // Check that the class loader context of the given oat file matches the given context.
   // This will perform a check that all class loaders in the chain have the same type and
@@ -119,12 +199,34 @@ class OatFileManager {
   // Return true if there are any class definition collisions in the oat_file.
   bool HasCollisions(const OatFile* oat_file,
                      const ClassLoaderContext* context,
-                     /*out*/ std::string* error_msg) const
-      REQUIRES(!Locks::oat_file_manager_lock_);
+                     /*out*/ std::string* error_msg)
+      REQUIRES(!Locks::oat_file_manager_lock_, !dex_file_verification_lock_);
 
   const OatFile* FindOpenedOatFileFromOatLocationLocked(const std::string& oat_location) const
       REQUIRES(Locks::oat_file_manager_lock_);
 
+  // Whether OpenDexFilesFromOat() leaves the verification of the dex files it opens without an
+  // oat file to the background threads.
+  bool VerifyDexFilesInBackground() const;
+
+  // Register `dex_files`, opened without verification, as pending verification and add a
+  // background task for each.
+  void StartBackgroundDexFileVerification(
+      const std::vector<std::unique_ptr<const DexFile>>& dex_files)
+      REQUIRES(!Locks::oat_file_manager_lock_, !dex_file_verification_lock_,
+               !Locks::mutator_lock_);
+
+  // Run the dex file verifier on `dex_file`, whose verification this thread claimed, and
+  // publish the result.
+  void RunDexFileVerification(Thread* self, const DexFile& dex_file)
+      REQUIRES(!dex_file_verification_lock_);
+
+  // Return the background thread pool, creating it with `thread_count` threads if needed.
+  // Returns null once the pool was deleted at shutdown.
+  ThreadPool* GetOrCreateThreadPool(Thread* self, size_t thread_count)
+      REQUIRES(!Locks::oat_file_manager_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   std::set<std::unique_ptr<const OatFile>> oat_files_ GUARDED_BY(Locks::oat_file_manager_lock_);
   bool have_non_pic_oat_file_;
 
@@ -132,6 +234,48 @@ class OatFileManager {
   // is not on /system, don't load it "executable".
   bool only_use_system_oat_files_;
 
+  // Threads of the background class loading, created on first use.
+  std::unique_ptr<ThreadPool> thread_pool_ GUARDED_BY(Locks::oat_file_manager_lock_);
+  // Set once the thread pool has been deleted at shutdown, so it is not created again.
+  bool thread_pool_deleted_ GUARDED_BY(Locks::oat_file_manager_lock_);
+
+  // Classes to preload, see SetStartupProfile().
+  std::unique_ptr<const ProfileCompilationInfo> startup_profile_
+      GUARDED_BY(Locks::oat_file_manager_lock_);
+
+  // State of a dex file opened without running the dex file verifier. Dex files are forgotten
+  // once they are verified, while the ones that failed are kept so that they stay unusable.
+  enum class DexFileVerificationState {
+    kPending,
+    kRunning,
+    kFailed,
+  };
+  struct DexFileVerification {
+    DexFileVerificationState state = DexFileVerificationState::kPending;
+    std::string error_msg;
+  };
+
+  Mutex dex_file_verification_lock_;
+  ConditionVariable dex_file_verification_cond_ GUARDED_BY(dex_file_verification_lock_);
+  std::unordered_map<const DexFile*, DexFileVerification> dex_file_verifications_
+      GUARDED_BY(dex_file_verification_lock_);
+  // Size of dex_file_verifications_, which lets the common case of no such dex files skip the
+  // lock.
+  Atomic<size_t> num_unverified_dex_files_;
+
+  // Entry of the dex checksums cache, see FindDexChecksums().
+  struct DexChecksums {
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    std::vector<uint32_t> checksums;
+    bool only_contains_uncompressed_dex;
+  };
+
+  Mutex dex_checksums_lock_;
+  std::unordered_map<std::string, DexChecksums> dex_checksums_ GUARDED_BY(dex_checksums_lock_);
+
   DISALLOW_COPY_AND_ASSIGN(OatFileManager);
 };
 
@@ -92,6 +92,8 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
           .IntoKey(M::CheckJni)
       .Define("-Xjniopts:forcecopy")
           .IntoKey(M::JniOptsForceCopy)
+      .Define("-Xjniopts:lite")
+          .IntoKey(M::JniOptsLite)
       .Define("-XjdwpProvider:_")
           .WithType<JdwpProvider>()
           .IntoKey(M::JdwpProvider)
@@ -147,6 +149,15 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:LongGCLogThreshold=_")  // in ms
           .WithType<MillisecondsToNanoseconds>()  // store as ns
           .IntoKey(M::LongGCLogThreshold)
+      .Define("-XX:GcPauseTargetMs=_")  // in ms
+          .WithType<MillisecondsToNanoseconds>()  // store as ns
+          .IntoKey(M::GcPauseTarget)
+      .Define("-XX:GcCpuBudget=_")
+          .WithType<double>().WithRange(0.0, 1.0)
+          .IntoKey(M::GcCpuBudget)
+      .Define("-XX:FragmentationCompactMaxPauseMs=_")  // in ms
+          .WithType<MillisecondsToNanoseconds>()  // store as ns
+          .IntoKey(M::FragmentationCompactMaxPause)
       .Define("-XX:DumpGCPerformanceOnShutdown")
           .IntoKey(M::DumpGCPerformanceOnShutdown)
       .Define("-XX:DumpJITInfoOnShutdown")
@@ -165,14 +176,69 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
           .IntoKey(M::DumpNativeStackOnSigQuit)
+      .Define("-XX:DeferNativeStacksOnSigQuit:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::DeferNativeStacksOnSigQuit)
+      .Define("-XX:LockContentionProfiling:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::LockContentionProfiling)
       .Define("-XX:MadviseRandomAccess:_")
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
           .IntoKey(M::MadviseRandomAccess)
+      .Define("-XX:BackgroundVerificationThreads:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::BackgroundVerificationThreads)
+      .Define("-XX:StartupClassPreloadThreads:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::StartupClassPreloadThreads)
+      .Define("-XX:ForkedHprof:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::ForkedHprof)
+      .Define("-XX:CompressedHprof:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::CompressedHprof)
+      .Define("-XX:SamplingProfilerIntervalUs:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::SamplingProfilerIntervalUs)
+      .Define("-XX:MetricsDir:_")
+          .WithType<std::string>()
+          .IntoKey(M::MetricsDir)
       .Define("-Xusejit:_")
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
           .IntoKey(M::UseJitCompilation)
+      .Define("-Xjitbaseline:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::JITBaselineCompilation)
+      .Define("-Xjitbaselineonly:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::JITBaselineOnly)
+      .Define("-Xjitwarmstart:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::JITWarmStart)
+      .Define("-Xjitprofilebranches:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::JITProfileBranches)
+      .Define("-Xjitperfmap:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::JITPerfMap)
+      .Define("-Xjitdump:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::JITDump)
+      .Define("-Xjiteventlog:_")
+          .WithType<std::string>()
+          .IntoKey(M::JITEventLog)
       .Define("-Xjitinitialsize:_")
           .WithType<MemoryKiB>()
           .IntoKey(M::JITCodeCacheInitialCapacity)
@@ -194,6 +260,9 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-Xjittransitionweight:_")
           .WithType<unsigned int>()
           .IntoKey(M::JITInvokeTransitionWeight)
+      .Define("-Xjitthreads:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::JITThreadPoolSize)
       .Define("-Xjitsaveprofilinginfo")
           .WithType<ProfileSaverOptions>()
           .AppendValues()
@@ -238,6 +307,15 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:LargeObjectThreshold=_")
           .WithType<Memory<1>>()
           .IntoKey(M::LargeObjectThreshold)
+      .Define("-XX:RegionSpaceHugePages=_")
+          .WithType<HugePageType>()
+          .WithValueMap({{"disabled",    HugePageType::kDisabled},
+                         {"transparent", HugePageType::kTransparent},
+                         {"explicit",    HugePageType::kExplicit}})
+          .IntoKey(M::RegionSpaceHugePages)
+      .Define({"-XX:EnableRegionSpaceNuma", "-XX:DisableRegionSpaceNuma"})
+          .WithValues({true, false})
+          .IntoKey(M::RegionSpaceNuma)
       .Define("-XX:BackgroundGC=_")
           .WithType<BackgroundGcOption>()
           .IntoKey(M::BackgroundGc)
@@ -718,6 +796,7 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -Xgc:[no]postsweepingverify_rosalloc\n");
   UsageMessage(stream, "  -Xgc:[no]postverify_rosalloc\n");
   UsageMessage(stream, "  -Xgc:[no]presweepingverify\n");
+  UsageMessage(stream, "  -Xgc:[no]generational_cc\n");
   UsageMessage(stream, "  -Ximage:filename\n");
   UsageMessage(stream, "  -Xbootclasspath-locations:bootclasspath\n"
                        "     (override the dex locations of the -Xbootclasspath files)\n");
@@ -727,6 +806,9 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -XX:MaxSpinsBeforeThinLockInflation=integervalue\n");
   UsageMessage(stream, "  -XX:LongPauseLogThreshold=integervalue\n");
   UsageMessage(stream, "  -XX:LongGCLogThreshold=integervalue\n");
+  UsageMessage(stream, "  -XX:GcPauseTargetMs=integervalue\n");
+  UsageMessage(stream, "  -XX:GcCpuBudget=doublevalue (fraction of time spent in GC, 0.0-1.0)\n");
+  UsageMessage(stream, "  -XX:FragmentationCompactMaxPauseMs=integervalue\n");
   UsageMessage(stream, "  -XX:ThreadSuspendTimeout=integervalue\n");
   UsageMessage(stream, "  -XX:DumpGCPerformanceOnShutdown\n");
   UsageMessage(stream, "  -XX:DumpJITInfoOnShutdown\n");
@@ -735,8 +817,19 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -XX:BackgroundGC=none\n");
   UsageMessage(stream, "  -XX:LargeObjectSpace={disabled,map,freelist}\n");
   UsageMessage(stream, "  -XX:LargeObjectThreshold=N\n");
+  UsageMessage(stream, "  -XX:RegionSpaceHugePages={disabled,transparent,explicit}\n");
+  UsageMessage(stream, "  -XX:EnableRegionSpaceNuma\n");
+  UsageMessage(stream, "  -XX:DisableRegionSpaceNuma\n");
   UsageMessage(stream, "  -XX:DumpNativeStackOnSigQuit=booleanvalue\n");
+  UsageMessage(stream, "  -XX:DeferNativeStacksOnSigQuit=booleanvalue\n");
+  UsageMessage(stream, "  -XX:LockContentionProfiling:booleanvalue\n");
   UsageMessage(stream, "  -XX:MadviseRandomAccess:booleanvalue\n");
+  UsageMessage(stream, "  -XX:BackgroundVerificationThreads:integervalue\n");
+  UsageMessage(stream, "  -XX:StartupClassPreloadThreads:integervalue\n");
+  UsageMessage(stream, "  -XX:ForkedHprof:booleanvalue\n");
+  UsageMessage(stream, "  -XX:CompressedHprof:booleanvalue\n");
+  UsageMessage(stream, "  -XX:SamplingProfilerIntervalUs:integervalue\n");
+  UsageMessage(stream, "  -XX:MetricsDir:directory\n");
   UsageMessage(stream, "  -XX:SlowDebug={false,true}\n");
   UsageMessage(stream, "  -Xmethod-trace\n");
   UsageMessage(stream, "  -Xmethod-trace-file:filename");
@@ -754,11 +847,19 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -Ximage-compiler-option dex2oat-option\n");
   UsageMessage(stream, "  -Xpatchoat:filename\n");
   UsageMessage(stream, "  -Xusejit:booleanvalue\n");
+  UsageMessage(stream, "  -Xjitbaseline:booleanvalue\n");
+  UsageMessage(stream, "  -Xjitbaselineonly:booleanvalue\n");
+  UsageMessage(stream, "  -Xjitwarmstart:booleanvalue\n");
+  UsageMessage(stream, "  -Xjitprofilebranches:booleanvalue\n");
+  UsageMessage(stream, "  -Xjitperfmap:booleanvalue\n");
+  UsageMessage(stream, "  -Xjitdump:booleanvalue\n");
+  UsageMessage(stream, "  -Xjiteventlog:filename\n");
   UsageMessage(stream, "  -Xjitinitialsize:N\n");
   UsageMessage(stream, "  -Xjitmaxsize:N\n");
   UsageMessage(stream, "  -Xjitwarmupthreshold:integervalue\n");
   UsageMessage(stream, "  -Xjitosrthreshold:integervalue\n");
   UsageMessage(stream, "  -Xjitprithreadweight:integervalue\n");
+  UsageMessage(stream, "  -Xjitthreads:integervalue\n");
   UsageMessage(stream, "  -X[no]relocate\n");
   UsageMessage(stream, "  -X[no]dex2oat (Whether to invoke dex2oat on the application)\n");
   UsageMessage(stream, "  -X[no]image-dex2oat (Whether to create and use a boot image)\n");
@@ -784,7 +885,7 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -Xint:portable, -Xint:fast, -Xint:jit\n");
   UsageMessage(stream, "  -Xdexopt:{none,verified,all,full}\n");
   UsageMessage(stream, "  -Xnoquithandler\n");
-  UsageMessage(stream, "  -Xjniopts:{warnonly,forcecopy}\n");
+  UsageMessage(stream, "  -Xjniopts:{warnonly,forcecopy,lite}\n");
   UsageMessage(stream, "  -Xjnigreflimit:integervalue\n");
   UsageMessage(stream, "  -Xgc:[no]precise\n");
   UsageMessage(stream, "  -Xgc:[no]verifycardtable\n");
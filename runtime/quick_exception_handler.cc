@@ -100,10 +100,13 @@ class CatchBlockStackVisitor FINAL : public StackVisitor {
  private:
   bool HandleTryItems(ArtMethod* method)
       REQUIRES_SHARED(Locks::mutator_lock_) {
-    uint32_t dex_pc = dex::kDexNoIndex;
-    if (!method->IsNative()) {
-      dex_pc = GetDexPc();
+    if (method->IsNative()) {
+      return true;  // Continue stack walk.
     }
+    // Only methods with try items can catch. Do not decode the dex pc of the others, or set
+    // aside the exception to look up their catch block.
+    uint32_t dex_pc =
+        (method->DexInstructionData().TriesSize() != 0u) ? GetDexPc() : dex::kDexNoIndex;
     if (dex_pc != dex::kDexNoIndex) {
       bool clear_exception = false;
       StackHandleScope<1> hs(GetThread());
@@ -119,15 +122,16 @@ class CatchBlockStackVisitor FINAL : public StackVisitor {
         exception_handler_->SetHandlerQuickFrame(GetCurrentQuickFrame());
         exception_handler_->SetHandlerMethodHeader(GetCurrentOatQuickMethodHeader());
         return false;  // End stack walk.
-      } else if (UNLIKELY(GetThread()->HasDebuggerShadowFrames())) {
-        // We are going to unwind this frame. Did we prepare a shadow frame for debugging?
-        size_t frame_id = GetFrameId();
-        ShadowFrame* frame = GetThread()->FindDebuggerShadowFrame(frame_id);
-        if (frame != nullptr) {
-          // We will not execute this shadow frame so we can safely deallocate it.
-          GetThread()->RemoveDebuggerShadowFrameMapping(frame_id);
-          ShadowFrame::DeleteDeoptimizedFrame(frame);
-        }
+      }
+    }
+    if (UNLIKELY(GetThread()->HasDebuggerShadowFrames())) {
+      // We are going to unwind this frame. Did we prepare a shadow frame for debugging?
+      size_t frame_id = GetFrameId();
+      ShadowFrame* frame = GetThread()->FindDebuggerShadowFrame(frame_id);
+      if (frame != nullptr) {
+        // We will not execute this shadow frame so we can safely deallocate it.
+        GetThread()->RemoveDebuggerShadowFrameMapping(frame_id);
+        ShadowFrame::DeleteDeoptimizedFrame(frame);
       }
     }
     return true;  // Continue stack walk.
@@ -551,8 +555,12 @@ void QuickExceptionHandler::DeoptimizeSingleFrame(DeoptimizationKind kind) {
     DumpFramesWithType(self_, /* details */ true);
   }
   if (Runtime::Current()->UseJitCompilation()) {
-    Runtime::Current()->GetJit()->GetCodeCache()->InvalidateCompiledCodeFor(
-        deopt_method, visitor.GetSingleFrameDeoptQuickMethodHeader());
+    jit::JitCodeCache* code_cache = Runtime::Current()->GetJit()->GetCodeCache();
+    const OatQuickMethodHeader* header = visitor.GetSingleFrameDeoptQuickMethodHeader();
+    if (code_cache->ContainsPc(header->GetCode())) {
+      code_cache->AddDeoptimization(deopt_method, kind);
+    }
+    code_cache->InvalidateCompiledCodeFor(deopt_method, header);
   } else {
     // Transfer the code to interpreter.
     Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
@@ -94,9 +94,11 @@
 #include "java_vm_ext.h"
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
+#include "jit/profile_compilation_info.h"
 #include "jit/profile_saver.h"
 #include "jni_internal.h"
 #include "linear_alloc.h"
+#include "lock_contention_profiler.h"
 #include "memory_representation.h"
 #include "mirror/array.h"
 #include "mirror/class-inl.h"
@@ -151,7 +153,9 @@
 #include "reflection.h"
 #include "runtime_callbacks.h"
 #include "runtime_intrinsics.h"
+#include "runtime_metrics.h"
 #include "runtime_options.h"
+#include "sampling_profiler.h"
 #include "scoped_thread_state_change-inl.h"
 #include "sigchain.h"
 #include "signal_catcher.h"
@@ -267,13 +271,20 @@ Runtime::Runtime()
       experimental_flags_(ExperimentalFlags::kNone),
       oat_file_manager_(nullptr),
       is_low_memory_mode_(false),
+      background_verification_threads_(0u),
+      startup_class_preload_threads_(0u),
+      forked_hprof_(false),
+      compressed_hprof_(false),
+      sampling_profiler_interval_us_(0u),
       safe_mode_(false),
       hidden_api_policy_(hiddenapi::EnforcementPolicy::kNoChecks),
       pending_hidden_api_warning_(false),
       dedupe_hidden_api_warnings_(true),
       always_set_hidden_api_warning_flag_(false),
       hidden_api_access_event_log_rate_(0),
+      hidden_api_epoch_(0u),
       dump_native_stack_on_sig_quit_(true),
+      defer_native_stacks_on_sig_quit_(false),
       pruned_dalvik_cache_(false),
       // Initially assume we perceive jank in case the process state is never updated.
       process_state_(kProcessStateJankPerceptible),
@@ -320,6 +331,9 @@ Runtime::~Runtime() {
     LOG(WARNING) << "Current thread not detached in Runtime shutdown";
   }
 
+  SamplingProfiler::Stop();
+  RuntimeMetrics::Stop();
+
   if (dump_gc_performance_on_shutdown_) {
     ScopedLogSeverity sls(LogSeverity::INFO);
     // This can't be called from the Heap destructor below because it
@@ -377,6 +391,10 @@ Runtime::~Runtime() {
     // JIT compiler threads.
     jit_->DeleteThreadPool();
   }
+  if (oat_file_manager_ != nullptr) {
+    // Likewise for the background verification threads.
+    oat_file_manager_->DeleteThreadPool();
+  }
 
   // Make sure our internal threads are dead before we start tearing down things they're using.
   GetRuntimeCallbacks()->StopDebugger();
@@ -602,23 +620,42 @@ void Runtime::CallExitHook(jint status) {
   }
 }
 
-void Runtime::SweepSystemWeaks(IsMarkedVisitor* visitor) {
+void Runtime::SweepSystemWeaks(IsMarkedVisitor* visitor, bool allow_new_system_weaks) {
+  // Mutators blocked on a holder can resume as soon as that holder is swept, since everything left
+  // in it is then marked. This keeps the window in which weak accesses block short for the holders
+  // swept first, e.g. the intern table with many loaded classes.
   GetInternTable()->SweepInternTableWeaks(visitor);
+  if (allow_new_system_weaks) {
+    intern_table_->ChangeWeakRootState(gc::kWeakRootStateNormal);
+  }
   GetMonitorList()->SweepMonitorList(visitor);
+  if (allow_new_system_weaks && !kUseReadBarrier) {
+    monitor_list_->AllowNewMonitors();
+  }
   GetJavaVM()->SweepJniWeakGlobals(visitor);
+  if (allow_new_system_weaks) {
+    java_vm_->AllowNewWeakGlobals();
+  }
   GetHeap()->SweepAllocationRecords(visitor);
+  if (allow_new_system_weaks) {
+    heap_->AllowNewAllocationRecords();
+  }
   if (GetJit() != nullptr) {
     // Visit JIT literal tables. Objects in these tables are classes and strings
     // and only classes can be affected by class unloading. The strings always
     // stay alive as they are strongly interned.
-    // TODO: Move this closer to CleanupClassLoaders, to avoid blocking weak accesses
-    // from mutators. See b/32167580.
     GetJit()->GetCodeCache()->SweepRootTables(visitor);
+    if (allow_new_system_weaks) {
+      GetJit()->GetCodeCache()->AllowInlineCacheAccess();
+    }
   }
 
   // All other generic system-weak holders.
   for (gc::AbstractSystemWeakHolder* holder : system_weak_holders_) {
     holder->Sweep(visitor);
+    if (allow_new_system_weaks) {
+      holder->Allow();
+    }
   }
 }
 
@@ -916,6 +953,17 @@ void Runtime::InitNonZygoteOrPostFork(
     CreateJit();
   }
 
+  // Interval timers are not inherited by forked processes, so start sampling here rather than in
+  // the zygote.
+  if (sampling_profiler_interval_us_ != 0u) {
+    SamplingProfiler::Start(sampling_profiler_interval_us_);
+  }
+
+  // Likewise, each forked process exports its own metrics file.
+  if (!metrics_dir_.empty()) {
+    RuntimeMetrics::Start(metrics_dir_);
+  }
+
   StartSignalCatcher();
 
   // Start the JDWP thread. If the command-line debugger flags specified "suspend=y",
@@ -1169,6 +1217,11 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   dex2oat_enabled_ = runtime_options.GetOrDefault(Opt::Dex2Oat);
   image_dex2oat_enabled_ = runtime_options.GetOrDefault(Opt::ImageDex2Oat);
   dump_native_stack_on_sig_quit_ = runtime_options.GetOrDefault(Opt::DumpNativeStackOnSigQuit);
+  defer_native_stacks_on_sig_quit_ =
+      runtime_options.GetOrDefault(Opt::DeferNativeStacksOnSigQuit);
+  if (runtime_options.GetOrDefault(Opt::LockContentionProfiling)) {
+    LockContentionProfiler::SetEnabled(true);
+  }
 
   vfprintf_ = runtime_options.GetOrDefault(Opt::HookVfprintf);
   exit_ = runtime_options.GetOrDefault(Opt::HookExit);
@@ -1234,6 +1287,14 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   experimental_flags_ = runtime_options.GetOrDefault(Opt::Experimental);
   is_low_memory_mode_ = runtime_options.Exists(Opt::LowMemoryMode);
   madvise_random_access_ = runtime_options.GetOrDefault(Opt::MadviseRandomAccess);
+  background_verification_threads_ =
+      runtime_options.GetOrDefault(Opt::BackgroundVerificationThreads);
+  startup_class_preload_threads_ = runtime_options.GetOrDefault(Opt::StartupClassPreloadThreads);
+  forked_hprof_ = runtime_options.GetOrDefault(Opt::ForkedHprof);
+  compressed_hprof_ = runtime_options.GetOrDefault(Opt::CompressedHprof);
+  sampling_profiler_interval_us_ =
+      runtime_options.GetOrDefault(Opt::SamplingProfilerIntervalUs);
+  metrics_dir_ = runtime_options.ReleaseOrDefault(Opt::MetricsDir);
 
   plugins_ = runtime_options.ReleaseOrDefault(Opt::Plugins);
   agent_specs_ = runtime_options.ReleaseOrDefault(Opt::AgentPath);
@@ -1284,7 +1345,13 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
                        xgc_option.gcstress_,
                        xgc_option.measure_,
                        runtime_options.GetOrDefault(Opt::EnableHSpaceCompactForOOM),
-                       runtime_options.GetOrDefault(Opt::HSpaceCompactForOOMMinIntervalsMs));
+                       runtime_options.GetOrDefault(Opt::HSpaceCompactForOOMMinIntervalsMs),
+                       xgc_option.generational_cc_,
+                       runtime_options.GetOrDefault(Opt::RegionSpaceHugePages),
+                       runtime_options.GetOrDefault(Opt::GcPauseTarget),
+                       runtime_options.GetOrDefault(Opt::GcCpuBudget),
+                       runtime_options.GetOrDefault(Opt::RegionSpaceNuma),
+                       runtime_options.GetOrDefault(Opt::FragmentationCompactMaxPause));
 
   if (!heap_->HasBootImageSpace() && !allow_dex_file_fallback_) {
     LOG(ERROR) << "Dex file fallback disabled, cannot continue without image.";
@@ -1824,6 +1891,8 @@ void Runtime::DumpForSigQuit(std::ostream& os) {
 
   thread_list_->DumpForSigQuit(os);
   BaseMutex::DumpAll(os);
+  LockContentionProfiler::Dump(os);
+  SamplingProfiler::Dump(os);
 
   // Inform anyone else who is interested in SigQuit.
   {
@@ -2120,8 +2189,10 @@ ArtMethod* Runtime::CreateCalleeSaveMethod() {
 }
 
 void Runtime::DisallowNewSystemWeaks() {
-  CHECK(!kUseReadBarrier);
-  monitor_list_->DisallowNewMonitors();
+  if (!kUseReadBarrier) {
+    // New monitors don't need to wait with the read barrier, see MonitorList::Add().
+    monitor_list_->DisallowNewMonitors();
+  }
   intern_table_->ChangeWeakRootState(gc::kWeakRootStateNoReadsOrWrites);
   java_vm_->DisallowNewWeakGlobals();
   heap_->DisallowNewAllocationRecords();
@@ -2136,9 +2207,10 @@ void Runtime::DisallowNewSystemWeaks() {
 }
 
 void Runtime::AllowNewSystemWeaks() {
-  CHECK(!kUseReadBarrier);
-  monitor_list_->AllowNewMonitors();
-  intern_table_->ChangeWeakRootState(gc::kWeakRootStateNormal);  // TODO: Do this in the sweeping.
+  if (!kUseReadBarrier) {
+    monitor_list_->AllowNewMonitors();
+  }
+  intern_table_->ChangeWeakRootState(gc::kWeakRootStateNormal);
   java_vm_->AllowNewWeakGlobals();
   heap_->AllowNewAllocationRecords();
   if (GetJit() != nullptr) {
@@ -2224,6 +2296,16 @@ void Runtime::ClearCalleeSaveMethods() {
 
 void Runtime::RegisterAppInfo(const std::vector<std::string>& code_paths,
                               const std::string& profile_output_filename) {
+  if (startup_class_preload_threads_ != 0u && !profile_output_filename.empty()) {
+    // The classes of the app are loaded from its code paths after this, when their dex files
+    // get registered with the app's class loader.
+    std::unique_ptr<ProfileCompilationInfo> profile(new ProfileCompilationInfo());
+    if (profile->Load(profile_output_filename, /*clear_if_invalid*/ false)) {
+      VLOG(profiler) << "Preloading startup classes from " << profile_output_filename;
+      oat_file_manager_->SetStartupProfile(std::move(profile));
+    }
+  }
+
   if (jit_.get() == nullptr) {
     // We are not JITing. Nothing to do.
     return;
@@ -2607,6 +2689,8 @@ class UpdateEntryPointsClassVisitor : public ClassVisitor {
 
 void Runtime::SetJavaDebuggable(bool value) {
   is_java_debuggable_ = value;
+  // Debuggable apps check exemptions and get warnings for more hidden API accesses.
+  InvalidateHiddenApiDecisions();
   // Do not call DeoptimizeBootImage just yet, the runtime may still be starting up.
 }
 
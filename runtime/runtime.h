@@ -312,6 +312,8 @@ class Runtime {
     return true;
   }
 
+  // Without the read barrier, called by CMS in the pause. With the read barrier, called by CC right
+  // before disabling weak ref access so that the holders stay blocked until each one is swept.
   void DisallowNewSystemWeaks() REQUIRES_SHARED(Locks::mutator_lock_);
   void AllowNewSystemWeaks() REQUIRES_SHARED(Locks::mutator_lock_);
   // broadcast_for_checkpoint is true when we broadcast for making blocking threads to respond to
@@ -343,8 +345,9 @@ class Runtime {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Sweep system weaks, the system weak is deleted if the visitor return null. Otherwise, the
-  // system weak is updated to be the visitor's returned value.
-  void SweepSystemWeaks(IsMarkedVisitor* visitor)
+  // system weak is updated to be the visitor's returned value. If allow_new_system_weaks is true,
+  // each holder is allowed again as soon as it is swept instead of waiting for all of them.
+  void SweepSystemWeaks(IsMarkedVisitor* visitor, bool allow_new_system_weaks = false)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Returns a special method that calls into a trampoline for runtime method resolution
@@ -530,6 +533,7 @@ class Runtime {
 
   void SetHiddenApiEnforcementPolicy(hiddenapi::EnforcementPolicy policy) {
     hidden_api_policy_ = policy;
+    InvalidateHiddenApiDecisions();
   }
 
   hiddenapi::EnforcementPolicy GetHiddenApiEnforcementPolicy() const {
@@ -542,6 +546,7 @@ class Runtime {
 
   void SetHiddenApiExemptions(const std::vector<std::string>& exemptions) {
     hidden_api_exemptions_ = exemptions;
+    InvalidateHiddenApiDecisions();
   }
 
   const std::vector<std::string>& GetHiddenApiExemptions() {
@@ -554,6 +559,7 @@ class Runtime {
 
   void SetDedupeHiddenApiWarnings(bool value) {
     dedupe_hidden_api_warnings_ = value;
+    InvalidateHiddenApiDecisions();
   }
 
   bool ShouldDedupeHiddenApiWarnings() {
@@ -576,6 +582,16 @@ class Runtime {
     return hidden_api_access_event_log_rate_;
   }
 
+  // Hidden API decisions cached for class members are only valid while the epoch is unchanged.
+  // It changes with any setting that the decisions depend on.
+  uint32_t GetHiddenApiEpoch() const {
+    return hidden_api_epoch_.load(std::memory_order_relaxed);
+  }
+
+  void InvalidateHiddenApiDecisions() {
+    hidden_api_epoch_.fetch_add(1u, std::memory_order_relaxed);
+  }
+
   const std::string& GetProcessPackageName() const {
     return process_package_name_;
   }
@@ -691,6 +707,10 @@ class Runtime {
     return dump_native_stack_on_sig_quit_;
   }
 
+  bool GetDeferNativeStacksOnSigQuit() const {
+    return defer_native_stacks_on_sig_quit_;
+  }
+
   bool GetPrunedDalvikCache() const {
     return pruned_dalvik_cache_;
   }
@@ -766,6 +786,39 @@ class Runtime {
     return madvise_random_access_;
   }
 
+  // Number of threads verifying the classes of dex files loaded without an oat file in the
+  // background, see OatFileManager::RunBackgroundClassLoading(). 0 disables it.
+  unsigned int GetBackgroundVerificationThreads() const {
+    return background_verification_threads_;
+  }
+
+  // Number of threads loading the classes of the app's profile in the background when its
+  // dex files get registered, see RegisterAppInfo(). 0 disables it.
+  unsigned int GetStartupClassPreloadThreads() const {
+    return startup_class_preload_threads_;
+  }
+
+  // Whether heap dumps to a file only suspend the runtime to fork a snapshot of the process,
+  // which writes the dump, see hprof::DumpHeapForked().
+  bool UseForkedHprof() const {
+    return forked_hprof_;
+  }
+
+  // Whether heap dumps to a file are gzip compressed.
+  bool UseCompressedHprof() const {
+    return compressed_hprof_;
+  }
+
+  // CPU time between two samples of the SamplingProfiler, 0 if it is disabled.
+  unsigned int GetSamplingProfilerIntervalUs() const {
+    return sampling_profiler_interval_us_;
+  }
+
+  // Where RuntimeMetrics exports its file, empty if it is disabled.
+  const std::string& GetMetricsDir() const {
+    return metrics_dir_;
+  }
+
   const std::string& GetJdwpOptions() {
     return jdwp_options_;
   }
@@ -1019,6 +1072,22 @@ class Runtime {
   // This is beneficial for low RAM devices since it reduces page cache thrashing.
   bool madvise_random_access_;
 
+  // Number of background verification threads, 0 if disabled.
+  unsigned int background_verification_threads_;
+
+  // Number of startup class preloading threads, 0 if disabled.
+  unsigned int startup_class_preload_threads_;
+
+  // Heap dump options, see UseForkedHprof() and UseCompressedHprof().
+  bool forked_hprof_;
+  bool compressed_hprof_;
+
+  // See GetSamplingProfilerIntervalUs().
+  unsigned int sampling_profiler_interval_us_;
+
+  // See GetMetricsDir().
+  std::string metrics_dir_;
+
   // Whether the application should run in safe mode, that is, interpreter only.
   bool safe_mode_;
 
@@ -1046,12 +1115,19 @@ class Runtime {
   // (never) and 0x10000 (always).
   uint32_t hidden_api_access_event_log_rate_;
 
+  // See GetHiddenApiEpoch().
+  std::atomic<uint32_t> hidden_api_epoch_;
+
   // The package of the app running in this process.
   std::string process_package_name_;
 
   // Whether threads should dump their native stack on SIGQUIT.
   bool dump_native_stack_on_sig_quit_;
 
+  // Whether the native stacks of SIGQUIT dumps are unwound and symbolized after the threads have
+  // dumped their managed stacks and resumed, rather than in the dump checkpoint.
+  bool defer_native_stacks_on_sig_quit_;
+
   // Whether the dalvik cache was pruned when initializing the runtime.
   bool pruned_dalvik_cache_;
 
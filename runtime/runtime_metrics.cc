@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "runtime_metrics.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <new>
+
+#include "base/bit_utils.h"
+#include "base/logging.h"
+
+namespace art {
+
+static_assert(sizeof(Atomic<uint64_t>) == sizeof(uint64_t) &&
+                  sizeof(Atomic<int64_t>) == sizeof(int64_t),
+              "The atomic counters must have the layout of plain integers in the metrics file");
+
+Atomic<RuntimeMetricsData*> RuntimeMetrics::data_(nullptr);
+std::string RuntimeMetrics::path_;
+
+bool RuntimeMetrics::Start(const std::string& dir) {
+  CHECK(Get() == nullptr);
+  std::string path = dir + "/art-metrics-" + std::to_string(getpid());
+  // Write the header in a temporary file, so that readers never see a partial one.
+  std::string temp_path = path + ".tmp";
+  int fd = open(temp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd == -1) {
+    PLOG(WARNING) << "Could not create the metrics file " << temp_path;
+    return false;
+  }
+  size_t size = RoundUp(sizeof(RuntimeMetricsData), kPageSize);
+  void* address = MAP_FAILED;
+  if (ftruncate(fd, size) == 0) {
+    address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (address == MAP_FAILED) {
+    PLOG(WARNING) << "Could not map the metrics file " << temp_path;
+    close(fd);
+    unlink(temp_path.c_str());
+    return false;
+  }
+  close(fd);
+  // The file is zero-filled, which is the initial value of all counters.
+  RuntimeMetricsData* data = new (address) RuntimeMetricsData();
+  data->magic = RuntimeMetricsData::kMagic;
+  data->version = RuntimeMetricsData::kVersion;
+  data->size = sizeof(RuntimeMetricsData);
+  data->pid = static_cast<uint32_t>(getpid());
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    PLOG(WARNING) << "Could not rename the metrics file to " << path;
+    munmap(address, size);
+    unlink(temp_path.c_str());
+    return false;
+  }
+  path_ = path;
+  data_.StoreRelease(data);
+  return true;
+}
+
+void RuntimeMetrics::Stop() {
+  if (Get() != nullptr && !path_.empty()) {
+    unlink(path_.c_str());
+    path_.clear();
+  }
+}
+
+size_t RuntimeMetrics::GetPauseBucket(uint64_t pause_ns) {
+  return std::min<size_t>(MinimumBitsToStore(pause_ns / 1000u),
+                          RuntimeMetricsData::kNumPauseBuckets - 1u);
+}
+
+void RuntimeMetrics::RecordGc(uint64_t duration_ns,
+                              const std::vector<uint64_t>& pause_times_ns,
+                              int64_t freed_bytes,
+                              uint64_t bytes_allocated_ever,
+                              uint64_t heap_bytes_allocated) {
+  RuntimeMetricsData* data = Get();
+  if (data == nullptr) {
+    return;
+  }
+  data->gc_count.FetchAndAddRelaxed(1u);
+  data->gc_time_ns.FetchAndAddRelaxed(duration_ns);
+  data->gc_freed_bytes.FetchAndAddRelaxed(freed_bytes);
+  for (uint64_t pause_ns : pause_times_ns) {
+    data->gc_pause_count.FetchAndAddRelaxed(1u);
+    data->gc_pause_time_ns.FetchAndAddRelaxed(pause_ns);
+    data->gc_pause_buckets[GetPauseBucket(pause_ns)].FetchAndAddRelaxed(1u);
+  }
+  data->bytes_allocated_ever.StoreRelaxed(bytes_allocated_ever);
+  data->heap_bytes_allocated.StoreRelaxed(heap_bytes_allocated);
+}
+
+}  // namespace art
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ART_RUNTIME_RUNTIME_METRICS_H_
+#define ART_RUNTIME_RUNTIME_METRICS_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "base/atomic.h"
+#include "base/macros.h"
+
+namespace art {
+
+// The layout of the metrics file, see RuntimeMetrics. It is read by other processes, so fields
+// are only ever added at the end, with an increment of kVersion. Readers must check the magic
+// and not read past `size`.
+//
+// The counters are updated with relaxed atomics. A reader sees each of them consistent, but not
+// a consistent snapshot of all of them.
+struct RuntimeMetricsData {
+  static constexpr uint32_t kMagic = 0x4d545241u;  // "ARTM" in little endian.
+  static constexpr uint32_t kVersion = 1u;
+  // Bucket 0 counts the GC pauses shorter than 1us, bucket i > 0 those in [2^(i-1), 2^i) us.
+  // The last bucket also counts all longer pauses.
+  static constexpr size_t kNumPauseBuckets = 32u;
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size;
+  uint32_t pid;
+
+  Atomic<uint64_t> gc_count;
+  Atomic<uint64_t> gc_time_ns;
+  // Signed, a moving GC can count objects copied to a bigger space as negative freed bytes.
+  Atomic<int64_t> gc_freed_bytes;
+  Atomic<uint64_t> gc_pause_count;
+  Atomic<uint64_t> gc_pause_time_ns;
+  Atomic<uint64_t> gc_pause_buckets[kNumPauseBuckets];
+  // Heap state at the end of the last GC. Allocating does not update the file, the allocation
+  // rate is the difference of bytes_allocated_ever between GCs.
+  Atomic<uint64_t> bytes_allocated_ever;
+  Atomic<uint64_t> heap_bytes_allocated;
+
+  // Classes defined from dex files, not counting the ones of the boot image.
+  Atomic<uint64_t> classes_defined;
+
+  // JIT tasks queued and finished. Their difference is the depth of the JIT queue, including
+  // the task being run.
+  Atomic<uint64_t> jit_tasks_added;
+  Atomic<uint64_t> jit_tasks_done;
+};
+
+// Exports counters of the GC, class loading and the JIT in a file mapped shared, so that an
+// external agent can read them at any rate without signalling the process.
+// -XX:MetricsDir:<dir> enables it, with the file <dir>/art-metrics-<pid>.
+class RuntimeMetrics {
+ public:
+  // Create and map the metrics file of the current process. Returns false, with a warning, if
+  // that fails. Called after the fork from the zygote, so that each process has its own file.
+  static bool Start(const std::string& dir);
+
+  // Remove the metrics file. The mapping stays, threads may still be recording.
+  static void Stop();
+
+  // The mapped data, or null if metrics are disabled.
+  static RuntimeMetricsData* Get() {
+    return data_.LoadRelaxed();
+  }
+
+  static size_t GetPauseBucket(uint64_t pause_ns);
+
+  static void RecordGc(uint64_t duration_ns,
+                       const std::vector<uint64_t>& pause_times_ns,
+                       int64_t freed_bytes,
+                       uint64_t bytes_allocated_ever,
+                       uint64_t heap_bytes_allocated);
+
+  static void RecordClassDefined() {
+    RuntimeMetricsData* data = Get();
+    if (data != nullptr) {
+      data->classes_defined.FetchAndAddRelaxed(1u);
+    }
+  }
+
+  static void RecordJitTaskAdded() {
+    RuntimeMetricsData* data = Get();
+    if (data != nullptr) {
+      data->jit_tasks_added.FetchAndAddRelaxed(1u);
+    }
+  }
+
+  static void RecordJitTaskDone() {
+    RuntimeMetricsData* data = Get();
+    if (data != nullptr) {
+      data->jit_tasks_done.FetchAndAddRelaxed(1u);
+    }
+  }
+
+ private:
+  static Atomic<RuntimeMetricsData*> data_;
+  static std::string path_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(RuntimeMetrics);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_RUNTIME_METRICS_H_
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "runtime_metrics.h"
+
+#include <unistd.h>
+
+#include "android-base/file.h"
+
+#include "common_runtime_test.h"
+#include "gc/heap.h"
+#include "runtime.h"
+
+namespace art {
+
+class RuntimeMetricsTest : public CommonRuntimeTest {};
+
+TEST_F(RuntimeMetricsTest, PauseBuckets) {
+  EXPECT_EQ(0u, RuntimeMetrics::GetPauseBucket(0u));
+  EXPECT_EQ(0u, RuntimeMetrics::GetPauseBucket(999u));
+  EXPECT_EQ(1u, RuntimeMetrics::GetPauseBucket(1000u));
+  EXPECT_EQ(2u, RuntimeMetrics::GetPauseBucket(2000u));
+  EXPECT_EQ(2u, RuntimeMetrics::GetPauseBucket(3999u));
+  EXPECT_EQ(3u, RuntimeMetrics::GetPauseBucket(4000u));
+  EXPECT_EQ(RuntimeMetricsData::kNumPauseBuckets - 1u,
+            RuntimeMetrics::GetPauseBucket(UINT64_C(1) << 62));
+}
+
+TEST_F(RuntimeMetricsTest, File) {
+  ASSERT_TRUE(RuntimeMetrics::Start(android_data_));
+  std::string path = android_data_ + "/art-metrics-" + std::to_string(getpid());
+  ASSERT_EQ(0, access(path.c_str(), R_OK)) << path;
+
+  RuntimeMetrics::RecordGc(/* duration_ns */ 5000u,
+                           /* pause_times_ns */ {500u, 3000u},
+                           /* freed_bytes */ 128,
+                           /* bytes_allocated_ever */ 4096u,
+                           /* heap_bytes_allocated */ 1024u);
+  RuntimeMetrics::RecordJitTaskAdded();
+  RuntimeMetrics::RecordJitTaskAdded();
+  RuntimeMetrics::RecordJitTaskDone();
+
+  // Read back what another process would see.
+  std::string content;
+  ASSERT_TRUE(android::base::ReadFileToString(path, &content));
+  ASSERT_GE(content.size(), sizeof(RuntimeMetricsData));
+  const RuntimeMetricsData* data = reinterpret_cast<const RuntimeMetricsData*>(content.data());
+  EXPECT_EQ(RuntimeMetricsData::kMagic, data->magic);
+  EXPECT_EQ(RuntimeMetricsData::kVersion, data->version);
+  EXPECT_EQ(sizeof(RuntimeMetricsData), data->size);
+  EXPECT_EQ(static_cast<uint32_t>(getpid()), data->pid);
+  EXPECT_EQ(1u, data->gc_count.LoadRelaxed());
+  EXPECT_EQ(5000u, data->gc_time_ns.LoadRelaxed());
+  EXPECT_EQ(128, data->gc_freed_bytes.LoadRelaxed());
+  EXPECT_EQ(2u, data->gc_pause_count.LoadRelaxed());
+  EXPECT_EQ(3500u, data->gc_pause_time_ns.LoadRelaxed());
+  EXPECT_EQ(1u, data->gc_pause_buckets[0].LoadRelaxed());
+  EXPECT_EQ(1u, data->gc_pause_buckets[2].LoadRelaxed());
+  EXPECT_EQ(4096u, data->bytes_allocated_ever.LoadRelaxed());
+  EXPECT_EQ(1024u, data->heap_bytes_allocated.LoadRelaxed());
+  EXPECT_EQ(2u, data->jit_tasks_added.LoadRelaxed());
+  EXPECT_EQ(1u, data->jit_tasks_done.LoadRelaxed());
+
+  // A real GC updates the shared mapping too.
+  uint64_t gc_count = RuntimeMetrics::Get()->gc_count.LoadRelaxed();
+  Runtime::Current()->GetHeap()->CollectGarbage(/* clear_soft_references */ false);
+  EXPECT_LT(gc_count, RuntimeMetrics::Get()->gc_count.LoadRelaxed());
+  EXPECT_NE(0u, RuntimeMetrics::Get()->bytes_allocated_ever.LoadRelaxed());
+
+  RuntimeMetrics::Stop();
+  EXPECT_NE(0, access(path.c_str(), F_OK));
+}
+
+}  // namespace art
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sampling_profiler.h"
+
+#include <string.h>
+#include <sys/time.h>
+
+#include <ostream>
+
+#include "art_method-inl.h"
+#include "barrier.h"
+#include "base/logging.h"
+#include "runtime.h"
+#include "scoped_thread_state_change-inl.h"
+#include "stack.h"
+#include "thread-current-inl.h"
+#include "thread_list.h"
+
+namespace art {
+
+Atomic<bool> SamplingProfiler::running_;
+Atomic<bool> SamplingProfiler::installed_;
+uint32_t SamplingProfiler::interval_us_ = 0u;
+
+void SamplingProfiler::HandleSignal(int signal_number ATTRIBUTE_UNUSED,
+                                    siginfo_t* info ATTRIBUTE_UNUSED,
+                                    void* context ATTRIBUTE_UNUSED) {
+  // Only async signal safe work here: the sample is taken at the next suspend point.
+  Thread* self = Thread::Current();
+  if (self != nullptr && running_.LoadRelaxed()) {
+    self->AtomicSetFlag(kSampleRequest);
+  }
+}
+
+bool SamplingProfiler::Start(uint32_t interval_us) {
+  CHECK_NE(interval_us, 0u);
+  if (!installed_.LoadRelaxed()) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    sigemptyset(&action.sa_mask);
+    action.sa_sigaction = HandleSignal;
+    // Restart the system calls the signal interrupts. Few are, since the signal goes to a thread
+    // which used CPU time.
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+      PLOG(WARNING) << "Could not install the sampling profiler signal handler";
+      return false;
+    }
+    installed_.StoreRelaxed(true);
+  }
+  interval_us_ = interval_us;
+  running_.StoreRelaxed(true);
+  itimerval timer;
+  timer.it_interval.tv_sec = interval_us / 1000000u;
+  timer.it_interval.tv_usec = interval_us % 1000000u;
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    PLOG(WARNING) << "Could not start the sampling profiler timer";
+    running_.StoreRelaxed(false);
+    return false;
+  }
+  return true;
+}
+
+void SamplingProfiler::Stop() {
+  if (!running_.LoadRelaxed()) {
+    return;
+  }
+  // Keep the signal handler, signals may still be pending.
+  itimerval timer;
+  memset(&timer, 0, sizeof(timer));
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    PLOG(WARNING) << "Could not stop the sampling profiler timer";
+  }
+  running_.StoreRelaxed(false);
+}
+
+SamplingProfiler::ScopedBlockSignal::ScopedBlockSignal() : blocked_(installed_.LoadRelaxed()) {
+  if (blocked_) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGPROF);
+    CHECK_EQ(pthread_sigmask(SIG_BLOCK, &mask, &old_mask_), 0);
+  }
+}
+
+SamplingProfiler::ScopedBlockSignal::~ScopedBlockSignal() {
+  if (blocked_) {
+    CHECK_EQ(pthread_sigmask(SIG_SETMASK, &old_mask_, nullptr), 0);
+  }
+}
+
+namespace {
+
+class SampleStackVisitor FINAL : public StackVisitor {
+ public:
+  SampleStackVisitor(Thread* thread, std::vector<ArtMethod*>* stack)
+      : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kIncludeInlinedFrames),
+        stack_(stack) {
+    stack_->clear();
+  }
+
+  bool VisitFrame() OVERRIDE REQUIRES_SHARED(Locks::mutator_lock_) {
+    ArtMethod* m = GetMethod();
+    // Ignore runtime frames (in particular callee save).
+    if (!m->IsRuntimeMethod()) {
+      stack_->push_back(m);
+    }
+    return stack_->size() < SamplingProfiler::kMaxFrames;
+  }
+
+ private:
+  std::vector<ArtMethod*>* const stack_;
+};
+
+// Adds the samples of each thread to shared counts per collapsed stack.
+class CollectSampledStacksClosure FINAL : public Closure {
+ public:
+  CollectSampledStacksClosure(Barrier* barrier, std::map<std::string, uint64_t>* counts)
+      : barrier_(barrier),
+        lock_("Collect sampled stacks lock"),
+        counts_(counts),
+        num_samples_(0u) {}
+
+  void Run(Thread* thread) OVERRIDE REQUIRES_SHARED(Locks::mutator_lock_) {
+    DCHECK(thread == Thread::Current() || thread->IsSuspended());
+    const SampledStacks* stacks = thread->GetSampledStacks();
+    if (stacks != nullptr) {
+      std::string name;
+      thread->GetThreadName(name);
+      MutexLock mu(Thread::Current(), lock_);
+      for (const auto& entry : stacks->GetEntries()) {
+        (*counts_)[name + ";" + entry.second.frames] += entry.second.count;
+      }
+      num_samples_ += stacks->NumSamples();
+    }
+    barrier_->Pass(Thread::Current());
+  }
+
+  uint64_t NumSamples() REQUIRES(!lock_) {
+    MutexLock mu(Thread::Current(), lock_);
+    return num_samples_;
+  }
+
+ private:
+  Barrier* const barrier_;
+  Mutex lock_;
+  std::map<std::string, uint64_t>* const counts_ GUARDED_BY(lock_);
+  uint64_t num_samples_ GUARDED_BY(lock_);
+};
+
+}  // namespace
+
+void SamplingProfiler::RecordSample(Thread* self) {
+  DCHECK_EQ(self, Thread::Current());
+  SampledStacks* stacks = self->GetSampledStacks();
+  if (stacks == nullptr) {
+    stacks = new SampledStacks();
+    self->SetSampledStacks(stacks);
+  }
+  SampleStackVisitor visitor(self, &stacks->scratch_);
+  visitor.WalkStack();
+  if (stacks->scratch_.empty()) {
+    return;
+  }
+  auto it = stacks->entries_.find(stacks->scratch_);
+  if (it == stacks->entries_.end()) {
+    std::string frames;
+    for (auto rit = stacks->scratch_.rbegin(); rit != stacks->scratch_.rend(); ++rit) {
+      if (!frames.empty()) {
+        frames += ';';
+      }
+      frames += (*rit)->PrettyMethod(/* with_signature */ false);
+    }
+    it = stacks->entries_.emplace(stacks->scratch_, SampledStacks::Entry{frames, 0u}).first;
+  }
+  ++it->second.count;
+  ++stacks->num_samples_;
+}
+
+void SamplingProfiler::Dump(std::ostream& os) {
+  if (!installed_.LoadRelaxed()) {
+    return;
+  }
+  Thread* self = Thread::Current();
+  std::map<std::string, uint64_t> counts;
+  Barrier barrier(0);
+  CollectSampledStacksClosure closure(&barrier, &counts);
+  {
+    ScopedObjectAccess soa(self);
+    size_t threads_running_checkpoint =
+        Runtime::Current()->GetThreadList()->RunCheckpoint(&closure);
+    // Now that we have run our checkpoint, move to a suspended state and wait
+    // for other threads to run the checkpoint.
+    ScopedThreadSuspension sts(self, kSuspended);
+    if (threads_running_checkpoint != 0) {
+      barrier.Increment(self, threads_running_checkpoint);
+    }
+  }
+  os << "Sampling profile (" << (IsRunning() ? "running" : "stopped") << ", every "
+     << interval_us_ << "us of CPU time, " << closure.NumSamples() << " samples):\n";
+  for (const auto& entry : counts) {
+    os << entry.first << " " << entry.second << "\n";
+  }
+  os << "\n";
+}
+
+}  // namespace art
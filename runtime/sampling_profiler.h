@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_SAMPLING_PROFILER_H_
+#define ART_RUNTIME_SAMPLING_PROFILER_H_
+
+#include <signal.h>
+#include <stdint.h>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/atomic.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+
+class ArtMethod;
+class Thread;
+
+// The Java stacks a thread was sampled in, and how often. Owned by the thread, see
+// Thread::GetSampledStacks().
+class SampledStacks {
+ public:
+  struct Entry {
+    // The frames from the outermost, as printed by SamplingProfiler::Dump(). Computed when the
+    // stack is first seen, so that Dump() never looks at methods which may have been unloaded.
+    std::string frames;
+    uint64_t count;
+  };
+
+  SampledStacks() {}
+
+  // Keyed by the methods of the stack, innermost first.
+  const std::map<std::vector<ArtMethod*>, Entry>& GetEntries() const {
+    return entries_;
+  }
+
+  uint64_t NumSamples() const {
+    return num_samples_;
+  }
+
+ private:
+  std::map<std::vector<ArtMethod*>, Entry> entries_;
+  uint64_t num_samples_ = 0u;
+  // Reused for walking the stack.
+  std::vector<ArtMethod*> scratch_;
+
+  friend class SamplingProfiler;
+
+  DISALLOW_COPY_AND_ASSIGN(SampledStacks);
+};
+
+// Samples the Java stacks of the threads that use CPU time, cheaply enough to stay on.
+//
+// A SIGPROF interval timer fires after each interval of CPU time used by the process, on the
+// thread that used it. The signal handler only sets the kSampleRequest flag of that thread,
+// which makes it walk its own stack at its next suspend point, see Thread::RunSampleRequest().
+// So no thread gets suspended for someone else's sample, and walking the stack needs no async
+// signal safety. The samples are biased towards suspend points, and time spent in native code
+// is attributed to the Java frames that called it.
+//
+// Each thread counts its samples per distinct stack on its own, without locking. Dump() collects
+// them with a checkpoint. Samples of threads that exited before are not seen.
+class SamplingProfiler {
+ public:
+  // Deeper stacks keep their innermost frames only.
+  static constexpr size_t kMaxFrames = 128u;
+
+  static bool IsRunning() {
+    return running_.LoadRelaxed();
+  }
+
+  // Start sampling after each `interval_us` microseconds of CPU time used by the process.
+  // Returns false, with a warning, if the signal handler or the timer could not be set up.
+  static bool Start(uint32_t interval_us);
+
+  static void Stop();
+
+  // Record a sample of the stack of `self`, which is the current thread.
+  static void RecordSample(Thread* self) REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Print the samples of all threads in the collapsed stack format of flame graph tools: one
+  // line per distinct stack, with the thread name as the root frame, frames from the outermost
+  // separated by ';', and the number of samples.
+  static void Dump(std::ostream& os)
+      REQUIRES(!Locks::mutator_lock_,
+               !Locks::thread_list_lock_,
+               !Locks::thread_suspend_count_lock_);
+
+  // Keep sampling signals from reaching the current thread while it is unregistered, when its
+  // Thread is deleted but still findable through Thread::Current().
+  class ScopedBlockSignal {
+   public:
+    ScopedBlockSignal();
+    ~ScopedBlockSignal();
+
+   private:
+    bool blocked_;
+    sigset_t old_mask_;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedBlockSignal);
+  };
+
+ private:
+  static void HandleSignal(int signal_number, siginfo_t* info, void* context);
+
+  static Atomic<bool> running_;
+  // Whether Start() ever installed the signal handler.
+  static Atomic<bool> installed_;
+  static uint32_t interval_us_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(SamplingProfiler);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_SAMPLING_PROFILER_H_
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sampling_profiler.h"
+
+#include <sstream>
+#include <string>
+
+#include "common_runtime_test.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-current-inl.h"
+
+namespace art {
+
+class SamplingProfilerTest : public CommonRuntimeTest {};
+
+TEST_F(SamplingProfilerTest, SampleRequest) {
+  Thread* self = Thread::Current();
+  ASSERT_TRUE(SamplingProfiler::Start(/* interval_us */ 100 * 1000));
+  EXPECT_TRUE(SamplingProfiler::IsRunning());
+  {
+    ScopedObjectAccess soa(self);
+    self->AtomicSetFlag(kSampleRequest);
+    self->CheckSuspend();
+    EXPECT_FALSE(self->ReadFlag(kSampleRequest));
+    // The test thread has no Java frames, so there was nothing to count.
+    ASSERT_NE(nullptr, self->GetSampledStacks());
+    EXPECT_EQ(0u, self->GetSampledStacks()->NumSamples());
+
+    // A sample request does not keep a thread from becoming runnable.
+    self->AtomicSetFlag(kSampleRequest);
+    {
+      ScopedThreadSuspension sts(self, kNative);
+    }
+    EXPECT_EQ(kRunnable, self->GetState());
+    self->CheckSuspend();
+    EXPECT_FALSE(self->ReadFlag(kSampleRequest));
+  }
+  SamplingProfiler::Stop();
+  EXPECT_FALSE(SamplingProfiler::IsRunning());
+
+  std::ostringstream oss;
+  SamplingProfiler::Dump(oss);
+  EXPECT_EQ(0u, oss.str().find("Sampling profile (stopped, every 100000us of CPU time, 0 samples)"))
+      << oss.str();
+}
+
+}  // namespace art
@@ -1277,6 +1277,9 @@ struct CodeInfoEncoding {
   BitEncodingTable<BitRegionEncoding> stack_mask;
   BitEncodingTable<InvokeInfoEncoding> invoke_info;
   BitEncodingTable<InlineInfoEncoding> inline_info;
+  // Number of leading stack maps sorted by native pc offset (serialized). The safepoint stack maps
+  // are recorded in code order; catch stack maps are appended after them out of order.
+  size_t num_sorted_stack_maps = 0u;
 
   CodeInfoEncoding() {}
 
@@ -1285,6 +1288,7 @@ struct CodeInfoEncoding {
     dex_register_map.Decode(&ptr);
     location_catalog.Decode(&ptr);
     stack_map.Decode(&ptr);
+    num_sorted_stack_maps = DecodeUnsignedLeb128(&ptr);
     register_mask.Decode(&ptr);
     stack_mask.Decode(&ptr);
     invoke_info.Decode(&ptr);
@@ -1304,6 +1308,7 @@ struct CodeInfoEncoding {
     dex_register_map.Encode(dest);
     location_catalog.Encode(dest);
     stack_map.Encode(dest);
+    EncodeUnsignedLeb128(dest, num_sorted_stack_maps);
     register_mask.Encode(dest);
     stack_mask.Encode(dest);
     invoke_info.Encode(dest);
@@ -1540,12 +1545,33 @@ class CodeInfo {
     return StackMap();
   }
 
+  // Returns the first stack map at `native_pc_offset`, as a linear search would. The sorted
+  // safepoint stack maps are binary searched, and only the catch stack maps after them are
+  // scanned.
   StackMap GetStackMapForNativePcOffset(uint32_t native_pc_offset,
                                         const CodeInfoEncoding& encoding) const {
-    // TODO: Safepoint stack maps are sorted by native_pc_offset but catch stack
-    //       maps are not. If we knew that the method does not have try/catch,
-    //       we could do binary search.
-    for (size_t i = 0, e = GetNumberOfStackMaps(encoding); i < e; ++i) {
+    const StackMapEncoding& stack_map_encoding = encoding.stack_map.encoding;
+    DCHECK_LE(encoding.num_sorted_stack_maps, GetNumberOfStackMaps(encoding));
+    size_t begin = 0u;
+    size_t end = encoding.num_sorted_stack_maps;
+    while (begin != end) {
+      const size_t mid = begin + (end - begin) / 2u;
+      if (GetStackMapAt(mid, encoding).GetNativePcOffset(stack_map_encoding, kRuntimeISA) <
+          native_pc_offset) {
+        begin = mid + 1u;
+      } else {
+        end = mid;
+      }
+    }
+    if (begin != encoding.num_sorted_stack_maps) {
+      StackMap stack_map = GetStackMapAt(begin, encoding);
+      if (stack_map.GetNativePcOffset(stack_map_encoding, kRuntimeISA) == native_pc_offset) {
+        return stack_map;
+      }
+    }
+    for (size_t i = encoding.num_sorted_stack_maps, e = GetNumberOfStackMaps(encoding);
+         i < e;
+         ++i) {
       StackMap stack_map = GetStackMapAt(i, encoding);
       if (stack_map.GetNativePcOffset(encoding.stack_map.encoding, kRuntimeISA) ==
           native_pc_offset) {
@@ -56,6 +56,8 @@ inline void Thread::CheckSuspend() {
       FullSuspendCheck();
     } else if (ReadFlag(kEmptyCheckpointRequest)) {
       RunEmptyCheckpoint();
+    } else if (ReadFlag(kSampleRequest)) {
+      RunSampleRequest();
     } else {
       break;
     }
@@ -182,31 +184,21 @@ inline void Thread::TransitionToSuspendedAndRunCheckpoints(ThreadState new_state
   DCHECK_NE(new_state, kRunnable);
   DCHECK_EQ(GetState(), kRunnable);
   union StateAndFlags old_state_and_flags;
-  union StateAndFlags new_state_and_flags;
-  while (true) {
-    old_state_and_flags.as_int = tls32_.state_and_flags.as_int;
-    if (UNLIKELY((old_state_and_flags.as_struct.flags & kCheckpointRequest) != 0)) {
-      RunCheckpointFunction();
-      continue;
-    }
-    if (UNLIKELY((old_state_and_flags.as_struct.flags & kEmptyCheckpointRequest) != 0)) {
-      RunEmptyCheckpoint();
-      continue;
-    }
+  old_state_and_flags.as_int = tls32_.state_and_flags.as_int;
+  if (LIKELY((old_state_and_flags.as_struct.flags &
+              (kCheckpointRequest | kEmptyCheckpointRequest)) == 0)) {
     // Change the state but keep the current flags (kCheckpointRequest is clear).
-    DCHECK_EQ((old_state_and_flags.as_struct.flags & kCheckpointRequest), 0);
-    DCHECK_EQ((old_state_and_flags.as_struct.flags & kEmptyCheckpointRequest), 0);
+    union StateAndFlags new_state_and_flags;
     new_state_and_flags.as_struct.flags = old_state_and_flags.as_struct.flags;
     new_state_and_flags.as_struct.state = new_state;
-
     // CAS the value with a memory ordering.
-    bool done =
-        tls32_.state_and_flags.as_atomic_int.CompareAndSetWeakRelease(old_state_and_flags.as_int,
-                                                                        new_state_and_flags.as_int);
-    if (LIKELY(done)) {
-      break;
+    if (LIKELY(tls32_.state_and_flags.as_atomic_int.CompareAndSetWeakRelease(
+                                                   old_state_and_flags.as_int,
+                                                   new_state_and_flags.as_int))) {
+      return;
     }
   }
+  TransitionToSuspendedAndRunCheckpointsSlow(new_state);
 }
 
 inline void Thread::PassActiveSuspendBarriers() {
@@ -239,65 +231,30 @@ inline void Thread::TransitionFromRunnableToSuspended(ThreadState new_state) {
 inline ThreadState Thread::TransitionFromSuspendedToRunnable() {
   union StateAndFlags old_state_and_flags;
   old_state_and_flags.as_int = tls32_.state_and_flags.as_int;
-  int16_t old_state = old_state_and_flags.as_struct.state;
-  DCHECK_NE(static_cast<ThreadState>(old_state), kRunnable);
-  do {
+  ThreadState old_state = static_cast<ThreadState>(old_state_and_flags.as_struct.state);
+  DCHECK_NE(old_state, kRunnable);
+  if (LIKELY(old_state_and_flags.as_struct.flags == 0)) {
+    // Optimize for the return from native code case - this is the fast path.
+    // Atomically change from suspended to runnable if no suspend request pending.
     Locks::mutator_lock_->AssertNotHeld(this);  // Otherwise we starve GC..
-    old_state_and_flags.as_int = tls32_.state_and_flags.as_int;
-    DCHECK_EQ(old_state_and_flags.as_struct.state, old_state);
-    if (LIKELY(old_state_and_flags.as_struct.flags == 0)) {
-      // Optimize for the return from native code case - this is the fast path.
-      // Atomically change from suspended to runnable if no suspend request pending.
-      union StateAndFlags new_state_and_flags;
-      new_state_and_flags.as_int = old_state_and_flags.as_int;
-      new_state_and_flags.as_struct.state = kRunnable;
-      // CAS the value with a memory barrier.
-      if (LIKELY(tls32_.state_and_flags.as_atomic_int.CompareAndSetWeakAcquire(
-                                                 old_state_and_flags.as_int,
-                                                 new_state_and_flags.as_int))) {
-        // Mark the acquisition of a share of the mutator_lock_.
-        Locks::mutator_lock_->TransitionFromSuspendedToRunnable(this);
-        break;
-      }
-    } else if ((old_state_and_flags.as_struct.flags & kActiveSuspendBarrier) != 0) {
-      PassActiveSuspendBarriers(this);
-    } else if ((old_state_and_flags.as_struct.flags &
-                (kCheckpointRequest | kEmptyCheckpointRequest)) != 0) {
-      // Impossible
-      LOG(FATAL) << "Transitioning to runnable with checkpoint flag, "
-                 << " flags=" << old_state_and_flags.as_struct.flags
-                 << " state=" << old_state_and_flags.as_struct.state;
-    } else if ((old_state_and_flags.as_struct.flags & kSuspendRequest) != 0) {
-      // Wait while our suspend count is non-zero.
-
-      // We pass null to the MutexLock as we may be in a situation where the
-      // runtime is shutting down. Guarding ourselves from that situation
-      // requires to take the shutdown lock, which is undesirable here.
-      Thread* thread_to_pass = nullptr;
-      if (kIsDebugBuild && !IsDaemon()) {
-        // We know we can make our debug locking checks on non-daemon threads,
-        // so re-enable them on debug builds.
-        thread_to_pass = this;
-      }
-      MutexLock mu(thread_to_pass, *Locks::thread_suspend_count_lock_);
-      ScopedTransitioningToRunnable scoped_transitioning_to_runnable(this);
-      old_state_and_flags.as_int = tls32_.state_and_flags.as_int;
-      DCHECK_EQ(old_state_and_flags.as_struct.state, old_state);
-      while ((old_state_and_flags.as_struct.flags & kSuspendRequest) != 0) {
-        // Re-check when Thread::resume_cond_ is notified.
-        Thread::resume_cond_->Wait(thread_to_pass);
-        old_state_and_flags.as_int = tls32_.state_and_flags.as_int;
-        DCHECK_EQ(old_state_and_flags.as_struct.state, old_state);
+    union StateAndFlags new_state_and_flags;
+    new_state_and_flags.as_int = old_state_and_flags.as_int;
+    new_state_and_flags.as_struct.state = kRunnable;
+    // CAS the value with a memory barrier.
+    if (LIKELY(tls32_.state_and_flags.as_atomic_int.CompareAndSetWeakAcquire(
+                                               old_state_and_flags.as_int,
+                                               new_state_and_flags.as_int))) {
+      // Mark the acquisition of a share of the mutator_lock_.
+      Locks::mutator_lock_->TransitionFromSuspendedToRunnable(this);
+      // Only claim the flip function, with a CAS, when there is one.
+      if (UNLIKELY(reinterpret_cast<Atomic<Closure*>*>(&tlsPtr_.flip_function)->LoadRelaxed() !=
+                   nullptr)) {
+        RunFlipFunction();
       }
-      DCHECK_EQ(GetSuspendCount(), 0);
+      return old_state;
     }
-  } while (true);
-  // Run the flip function, if set.
-  Closure* flip_func = GetFlipFunction();
-  if (flip_func != nullptr) {
-    flip_func->Run(this);
   }
-  return static_cast<ThreadState>(old_state);
+  return TransitionFromSuspendedToRunnableSlow(old_state);
 }
 
 inline mirror::Object* Thread::AllocTlab(size_t bytes) {
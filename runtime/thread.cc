@@ -61,6 +61,7 @@
 #include "gc/space/space-inl.h"
 #include "gc_root.h"
 #include "handle_scope-inl.h"
+#include "hidden_api.h"
 #include "indirect_reference_table-inl.h"
 #include "interpreter/interpreter.h"
 #include "interpreter/shadow_frame.h"
@@ -73,6 +74,7 @@
 #include "mirror/stack_trace_element.h"
 #include "monitor.h"
 #include "monitor_objects_stack_visitor.h"
+#include "monitor_pool.h"
 #include "native_stack_dump.h"
 #include "nativehelper/scoped_local_ref.h"
 #include "nativehelper/scoped_utf_chars.h"
@@ -86,11 +88,13 @@
 #include "reflection.h"
 #include "runtime.h"
 #include "runtime_callbacks.h"
+#include "sampling_profiler.h"
 #include "scoped_thread_state_change-inl.h"
 #include "stack.h"
 #include "stack_map.h"
 #include "thread-inl.h"
 #include "thread_list.h"
+#include "trace.h"
 #include "verifier/method_verifier.h"
 #include "verify_object.h"
 #include "well_known_classes.h"
@@ -1380,6 +1384,102 @@ void Thread::RunEmptyCheckpoint() {
   Runtime::Current()->GetThreadList()->EmptyCheckpointBarrier()->Pass(this);
 }
 
+void Thread::RunSampleRequest() {
+  DCHECK_EQ(Thread::Current(), this);
+  AtomicClearFlag(kSampleRequest);
+  SamplingProfiler::RecordSample(this);
+}
+
+void Thread::TransitionToSuspendedAndRunCheckpointsSlow(ThreadState new_state) {
+  DCHECK_NE(new_state, kRunnable);
+  DCHECK_EQ(GetState(), kRunnable);
+  union StateAndFlags old_state_and_flags;
+  union StateAndFlags new_state_and_flags;
+  while (true) {
+    old_state_and_flags.as_int = tls32_.state_and_flags.as_int;
+    if (UNLIKELY((old_state_and_flags.as_struct.flags & kCheckpointRequest) != 0)) {
+      RunCheckpointFunction();
+      continue;
+    }
+    if (UNLIKELY((old_state_and_flags.as_struct.flags & kEmptyCheckpointRequest) != 0)) {
+      RunEmptyCheckpoint();
+      continue;
+    }
+    // Change the state but keep the current flags (kCheckpointRequest is clear).
+    DCHECK_EQ((old_state_and_flags.as_struct.flags & kCheckpointRequest), 0);
+    DCHECK_EQ((old_state_and_flags.as_struct.flags & kEmptyCheckpointRequest), 0);
+    new_state_and_flags.as_struct.flags = old_state_and_flags.as_struct.flags;
+    new_state_and_flags.as_struct.state = new_state;
+
+    // CAS the value with a memory ordering.
+    bool done =
+        tls32_.state_and_flags.as_atomic_int.CompareAndSetWeakRelease(old_state_and_flags.as_int,
+                                                                        new_state_and_flags.as_int);
+    if (LIKELY(done)) {
+      break;
+    }
+  }
+}
+
+ThreadState Thread::TransitionFromSuspendedToRunnableSlow(ThreadState old_state) {
+  union StateAndFlags old_state_and_flags;
+  DCHECK_NE(old_state, kRunnable);
+  do {
+    Locks::mutator_lock_->AssertNotHeld(this);  // Otherwise we starve GC..
+    old_state_and_flags.as_int = tls32_.state_and_flags.as_int;
+    DCHECK_EQ(static_cast<ThreadState>(old_state_and_flags.as_struct.state), old_state);
+    if (LIKELY((old_state_and_flags.as_struct.flags & ~kSampleRequest) == 0)) {
+      // The flags were cleared, or the weak CAS of the fast path failed spuriously.
+      // Atomically change from suspended to runnable if no suspend request pending. A sample
+      // request stays pending until the next suspend check.
+      union StateAndFlags new_state_and_flags;
+      new_state_and_flags.as_int = old_state_and_flags.as_int;
+      new_state_and_flags.as_struct.state = kRunnable;
+      // CAS the value with a memory barrier.
+      if (LIKELY(tls32_.state_and_flags.as_atomic_int.CompareAndSetWeakAcquire(
+                                                 old_state_and_flags.as_int,
+                                                 new_state_and_flags.as_int))) {
+        // Mark the acquisition of a share of the mutator_lock_.
+        Locks::mutator_lock_->TransitionFromSuspendedToRunnable(this);
+        break;
+      }
+    } else if ((old_state_and_flags.as_struct.flags & kActiveSuspendBarrier) != 0) {
+      PassActiveSuspendBarriers(this);
+    } else if ((old_state_and_flags.as_struct.flags &
+                (kCheckpointRequest | kEmptyCheckpointRequest)) != 0) {
+      // Impossible
+      LOG(FATAL) << "Transitioning to runnable with checkpoint flag, "
+                 << " flags=" << old_state_and_flags.as_struct.flags
+                 << " state=" << old_state_and_flags.as_struct.state;
+    } else if ((old_state_and_flags.as_struct.flags & kSuspendRequest) != 0) {
+      // Wait while our suspend count is non-zero.
+
+      // We pass null to the MutexLock as we may be in a situation where the
+      // runtime is shutting down. Guarding ourselves from that situation
+      // requires to take the shutdown lock, which is undesirable here.
+      Thread* thread_to_pass = nullptr;
+      if (kIsDebugBuild && !IsDaemon()) {
+        // We know we can make our debug locking checks on non-daemon threads,
+        // so re-enable them on debug builds.
+        thread_to_pass = this;
+      }
+      MutexLock mu(thread_to_pass, *Locks::thread_suspend_count_lock_);
+      ScopedTransitioningToRunnable scoped_transitioning_to_runnable(this);
+      old_state_and_flags.as_int = tls32_.state_and_flags.as_int;
+      DCHECK_EQ(static_cast<ThreadState>(old_state_and_flags.as_struct.state), old_state);
+      while ((old_state_and_flags.as_struct.flags & kSuspendRequest) != 0) {
+        // Re-check when Thread::resume_cond_ is notified.
+        Thread::resume_cond_->Wait(thread_to_pass);
+        old_state_and_flags.as_int = tls32_.state_and_flags.as_int;
+        DCHECK_EQ(static_cast<ThreadState>(old_state_and_flags.as_struct.state), old_state);
+      }
+      DCHECK_EQ(GetSuspendCount(), 0);
+    }
+  } while (true);
+  RunFlipFunction();
+  return old_state;
+}
+
 bool Thread::RequestCheckpoint(Closure* function) {
   union StateAndFlags old_state_and_flags;
   old_state_and_flags.as_int = tls32_.state_and_flags.as_int;
@@ -1571,6 +1671,13 @@ Closure* Thread::GetFlipFunction() {
   return func;
 }
 
+void Thread::RunFlipFunction() {
+  Closure* flip_func = GetFlipFunction();
+  if (flip_func != nullptr) {
+    flip_func->Run(this);
+  }
+}
+
 void Thread::SetFlipFunction(Closure* function) {
   CHECK(function != nullptr);
   Atomic<Closure*>* atomic_func = reinterpret_cast<Atomic<Closure*>*>(&tlsPtr_.flip_function);
@@ -2000,6 +2107,13 @@ void Thread::DumpStack(std::ostream& os,
   }
 }
 
+bool Thread::DumpWithoutNativeStack(std::ostream& state_os, std::ostream& stack_os) const {
+  DumpState(state_os);
+  bool show_native_stack = ShouldShowNativeStack(this);
+  DumpStack(stack_os, /* dump_native_stack */ false);
+  return show_native_stack;
+}
+
 void Thread::ThreadExitCallback(void* arg) {
   Thread* self = reinterpret_cast<Thread*>(arg);
   if (self->tls32_.thread_exit_check_count == 0) {
@@ -2240,6 +2354,7 @@ void Thread::Destroy() {
       Runtime::Current()->GetHeap()->ConcurrentCopyingCollector()->RevokeThreadLocalMarkStack(this);
     }
   }
+  MonitorPool::ReleaseThreadCache(this);
 }
 
 Thread::~Thread() {
@@ -2284,6 +2399,9 @@ Thread::~Thread() {
   delete tlsPtr_.instrumentation_stack;
   delete tlsPtr_.name;
   delete tlsPtr_.deps_or_stack_trace_sample.stack_trace_sample;
+  delete sampled_stacks_;
+  delete trace_thread_buffer_;
+  delete hidden_api_cache_;
 
   Runtime::Current()->GetHeap()->AssertThreadLocalBuffersAreRevoked(this);
 
@@ -3745,6 +3863,9 @@ class RootCallbackVisitor {
 template <bool kPrecise>
 void Thread::VisitRoots(RootVisitor* visitor) {
   const pid_t thread_id = GetThreadId();
+  // The interpreter cache holds raw class pointers that are not reported as roots.
+  // Drop its entries rather than tracking moved or unloaded classes.
+  interpreter_cache_.Clear();
   visitor->VisitRootIfNonNull(&tlsPtr_.opeer, RootInfo(kRootThreadObject, thread_id));
   if (tlsPtr_.exception != nullptr && tlsPtr_.exception != GetDeoptimizationException()) {
     visitor->VisitRoot(reinterpret_cast<mirror::Object**>(&tlsPtr_.exception),
@@ -25,6 +25,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "arch/context.h"
 #include "arch/instruction_set.h"
@@ -32,11 +33,13 @@
 #include "base/enums.h"
 #include "base/macros.h"
 #include "base/mutex.h"
+#include "dex/method_reference.h"
 #include "entrypoints/jni/jni_entrypoints.h"
 #include "entrypoints/quick/quick_entrypoints.h"
 #include "globals.h"
 #include "handle_scope.h"
 #include "instrumentation.h"
+#include "interpreter/interpreter_cache.h"
 #include "jvalue.h"
 #include "managed_stack.h"
 #include "offsets.h"
@@ -58,6 +61,10 @@ class SemiSpace;
 }  // namespace collector
 }  // namespace gc
 
+namespace hiddenapi {
+class MemberActionCache;
+}  // namespace hiddenapi
+
 namespace mirror {
 class Array;
 class Class;
@@ -89,12 +96,14 @@ class JavaVMExt;
 class JNIEnvExt;
 class Monitor;
 class RootVisitor;
+class SampledStacks;
 class ScopedObjectAccessAlreadyRunnable;
 class ShadowFrame;
 class SingleStepControl;
 class StackedShadowFrameRecord;
 class Thread;
 class ThreadList;
+class TraceThreadBuffer;
 enum VisitRootFlags : uint8_t;
 
 // Thread priorities. These must match the Thread.MIN_PRIORITY,
@@ -111,6 +120,7 @@ enum ThreadFlag {
   kCheckpointRequest = 2,  // Request that the thread do some checkpoint work and then continue.
   kEmptyCheckpointRequest = 4,  // Request that the thread do empty checkpoint and then continue.
   kActiveSuspendBarrier = 8,  // Register that at least 1 suspend barrier needs to be passed.
+  kSampleRequest = 16,  // Request that the thread records its stack for the SamplingProfiler.
 };
 
 enum class StackedShadowFrameType {
@@ -126,7 +136,7 @@ enum class DeoptimizationMethodType {
 };
 
 // This should match RosAlloc::kNumThreadLocalSizeBrackets.
-static constexpr size_t kNumRosAllocThreadLocalSizeBracketsInThread = 16;
+static constexpr size_t kNumRosAllocThreadLocalSizeBracketsInThread = 24;
 
 // Thread's stack layout for implicit stack overflow checks:
 //
@@ -213,6 +223,12 @@ class Thread {
       REQUIRES(!Locks::thread_suspend_count_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Dumps like Dump(), but leaves the native stack to the caller: the state goes to `state_os` and
+  // the rest to `stack_os`. Returns whether the native stack should be dumped between the two.
+  bool DumpWithoutNativeStack(std::ostream& state_os, std::ostream& stack_os) const
+      REQUIRES(!Locks::thread_suspend_count_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   void DumpJavaStack(std::ostream& os,
                      bool check_suspended = true,
                      bool dump_locks = true) const
@@ -293,6 +309,8 @@ class Thread {
 
   void SetFlipFunction(Closure* function);
   Closure* GetFlipFunction();
+  // Claim and run the flip function, if set.
+  void RunFlipFunction() REQUIRES_SHARED(Locks::mutator_lock_);
 
   gc::accounting::AtomicStack<mirror::Object>* GetThreadLocalMarkStack() {
     CHECK(kUseReadBarrier);
@@ -1146,6 +1164,80 @@ class Thread {
     return tlsPtr_.thread_local_pos;
   }
 
+  // Adaptive TLAB sizing, see Heap::ComputeTlabSize(). Returns 0 if no TLAB was refilled yet.
+  size_t GetTlabRefillSize() const {
+    return tlab_refill_size_;
+  }
+  uint64_t GetLastTlabRefillTimeNs() const {
+    return last_tlab_refill_time_ns_;
+  }
+  size_t GetTlabRefillCount() const {
+    return tlab_refill_count_;
+  }
+  void RecordTlabRefill(size_t refill_size, uint64_t now_ns) {
+    tlab_refill_size_ = refill_size;
+    last_tlab_refill_time_ns_ = now_ns;
+    ++tlab_refill_count_;
+  }
+
+  // Heap sampling, see Heap::SampleAllocation(). Returns 0 if the thread did not allocate with
+  // sampling enabled yet.
+  size_t GetAllocSampleBytesRemaining() const {
+    return alloc_sample_bytes_remaining_;
+  }
+  void SetAllocSampleBytesRemaining(size_t bytes) {
+    alloc_sample_bytes_remaining_ = bytes;
+  }
+
+  // Head of the free monitors this thread took from the MonitorPool, only accessed by this thread.
+  Monitor* GetFreeMonitors() const {
+    return free_monitors_;
+  }
+  void SetFreeMonitors(Monitor* monitors) {
+    free_monitors_ = monitors;
+  }
+
+  // Invoke target cache of the interpreter, only accessed by this thread, or while it is
+  // suspended.
+  InterpreterCache* GetInterpreterCache() {
+    return &interpreter_cache_;
+  }
+
+  // Methods this thread executed for the first time, and methods it made warm, since the
+  // profile saver last collected them. See ProfileSaver::NotifyMethodSampled().
+  std::vector<MethodReference>* GetProfileSampledMethods() {
+    return &profile_sampled_methods_;
+  }
+  std::vector<MethodReference>* GetProfileWarmMethods() {
+    return &profile_warm_methods_;
+  }
+
+  // Stacks the SamplingProfiler sampled this thread in, null before the first sample. Only
+  // accessed by this thread, or while it is suspended or running a checkpoint.
+  SampledStacks* GetSampledStacks() const {
+    return sampled_stacks_;
+  }
+  void SetSampledStacks(SampledStacks* sampled_stacks) {
+    sampled_stacks_ = sampled_stacks;
+  }
+
+  // Streaming method trace events of this thread, null if it has none. See Trace.
+  TraceThreadBuffer* GetTraceThreadBuffer() const {
+    return trace_thread_buffer_;
+  }
+  void SetTraceThreadBuffer(TraceThreadBuffer* trace_thread_buffer) {
+    trace_thread_buffer_ = trace_thread_buffer;
+  }
+
+  // Hidden API decisions taken by this thread, null before the first one. Only accessed by this
+  // thread.
+  hiddenapi::MemberActionCache* GetHiddenApiCache() const {
+    return hidden_api_cache_;
+  }
+  void SetHiddenApiCache(hiddenapi::MemberActionCache* hidden_api_cache) {
+    hidden_api_cache_ = hidden_api_cache;
+  }
+
   // Remove the suspend trigger for this thread by making the suspend_trigger_ TLS value
   // equal to a valid pointer.
   // TODO: does this need to atomic?  I don't think so.
@@ -1359,6 +1451,14 @@ class Thread {
   ALWAYS_INLINE void TransitionToSuspendedAndRunCheckpoints(ThreadState new_state)
       REQUIRES(!Locks::thread_suspend_count_lock_, !Roles::uninterruptible_);
 
+  // Out-of-line slow paths of the state transitions, for when a flag is raised or the CAS fails.
+  // Keeps the inlined fast paths, at every ScopedObjectAccess and JNI transition, small.
+  void TransitionToSuspendedAndRunCheckpointsSlow(ThreadState new_state)
+      REQUIRES(!Locks::thread_suspend_count_lock_, !Roles::uninterruptible_);
+  ThreadState TransitionFromSuspendedToRunnableSlow(ThreadState old_state)
+      REQUIRES(!Locks::thread_suspend_count_lock_)
+      SHARED_LOCK_FUNCTION(Locks::mutator_lock_);
+
   ALWAYS_INLINE void PassActiveSuspendBarriers()
       REQUIRES(!Locks::thread_suspend_count_lock_, !Roles::uninterruptible_);
 
@@ -1388,6 +1488,8 @@ class Thread {
   // the kCheckpointRequest flag is cleared.
   void RunCheckpointFunction();
   void RunEmptyCheckpoint();
+  // Clears the kSampleRequest flag and records a sample of the stack.
+  void RunSampleRequest() REQUIRES_SHARED(Locks::mutator_lock_);
 
   bool PassActiveSuspendBarriers(Thread* self)
       REQUIRES(!Locks::thread_suspend_count_lock_);
@@ -1758,6 +1860,36 @@ class Thread {
   // By default this is true.
   bool can_call_into_java_;
 
+  // Adaptive TLAB sizing history (only accessed by this thread): the size of the last TLAB
+  // refill, when it happened and how many refills the thread did.
+  size_t tlab_refill_size_ = 0;
+  uint64_t last_tlab_refill_time_ns_ = 0;
+  size_t tlab_refill_count_ = 0;
+
+  // Bytes this thread can allocate before its next sampled allocation (only accessed by this
+  // thread).
+  size_t alloc_sample_bytes_remaining_ = 0;
+
+  // Monomorphic invoke targets of the interpreter, see InterpreterCache.
+  InterpreterCache interpreter_cache_;
+
+  // Free monitors cached by MonitorPool::CreateMonitorInPool() (only accessed by this thread).
+  Monitor* free_monitors_ = nullptr;
+
+  // Pending profile saver samples (only accessed by this thread, or while it is suspended or
+  // running a checkpoint).
+  std::vector<MethodReference> profile_sampled_methods_;
+  std::vector<MethodReference> profile_warm_methods_;
+
+  // Owned, see GetSampledStacks().
+  SampledStacks* sampled_stacks_ = nullptr;
+
+  // Owned, see GetTraceThreadBuffer().
+  TraceThreadBuffer* trace_thread_buffer_ = nullptr;
+
+  // Owned, see GetHiddenApiCache().
+  hiddenapi::MemberActionCache* hidden_api_cache_ = nullptr;
+
   friend class Dbg;  // For SetStateUnsafe.
   friend class gc::collector::SemiSpace;  // For getting stack traces.
   friend class Runtime;  // For CreatePeer.
@@ -21,6 +21,8 @@
 #include <unistd.h>
 
 #include <sstream>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "android-base/stringprintf.h"
@@ -28,6 +30,7 @@
 #include "nativehelper/scoped_local_ref.h"
 #include "nativehelper/scoped_utf_chars.h"
 
+#include "art_method-inl.h"
 #include "base/aborting.h"
 #include "base/histogram-inl.h"
 #include "base/mutex-inl.h"
@@ -44,8 +47,10 @@
 #include "lock_word.h"
 #include "monitor.h"
 #include "native_stack_dump.h"
+#include "sampling_profiler.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread.h"
+#include "thread_pool.h"
 #include "trace.h"
 #include "well_known_classes.h"
 
@@ -76,6 +81,7 @@ ThreadList::ThreadList(uint64_t thread_suspend_timeout_ns)
       debug_suspend_all_count_(0),
       unregistering_count_(0),
       suspend_all_historam_("suspend all histogram", 16, 64),
+      max_suspend_all_time_(0u),
       long_suspend_(false),
       shut_down_(false),
       thread_suspend_timeout_ns_(thread_suspend_timeout_ns),
@@ -151,9 +157,13 @@ void ThreadList::DumpForSigQuit(std::ostream& os) {
       suspend_all_historam_.CreateHistogram(&data);
       suspend_all_historam_.PrintConfidenceIntervals(os, 0.99, data);  // Dump time to suspend.
     }
+    if (!max_suspend_all_thread_.empty()) {
+      os << "Slowest suspend all: " << PrettyDuration(max_suspend_all_time_) << " waiting for "
+         << max_suspend_all_thread_ << "\n";
+    }
   }
   bool dump_native_stack = Runtime::Current()->GetDumpNativeStackOnSigQuit();
-  Dump(os, dump_native_stack);
+  Dump(os, dump_native_stack, Runtime::Current()->GetDeferNativeStacksOnSigQuit());
   DumpUnattachedThreads(os, dump_native_stack && kDumpUnattachedThreadNativeStackForSigQuit);
 }
 
@@ -201,11 +211,12 @@ static constexpr uint32_t kDumpWaitTimeout = kIsTargetBuild ? 100000 : 20000;
 // A closure used by Thread::Dump.
 class DumpCheckpoint FINAL : public Closure {
  public:
-  DumpCheckpoint(std::ostream* os, bool dump_native_stack)
+  DumpCheckpoint(std::ostream* os, bool dump_native_stack, bool defer_native_stacks)
       : os_(os),
         barrier_(0),
         backtrace_map_(dump_native_stack ? BacktraceMap::Create(getpid()) : nullptr),
-        dump_native_stack_(dump_native_stack) {
+        dump_native_stack_(dump_native_stack),
+        defer_native_stacks_(dump_native_stack && defer_native_stacks) {
     if (backtrace_map_ != nullptr) {
       backtrace_map_->SetSuffixesToIgnore(std::vector<std::string> { "oat", "odex" });
     }
@@ -216,6 +227,24 @@ class DumpCheckpoint FINAL : public Closure {
     // request.
     Thread* self = Thread::Current();
     CHECK(self != nullptr);
+    if (defer_native_stacks_) {
+      DeferredDump dump;
+      dump.tid = thread->GetTid();
+      std::ostringstream state_os;
+      std::ostringstream stack_os;
+      {
+        ScopedObjectAccess soa(self);
+        dump.dump_native_stack = thread->DumpWithoutNativeStack(state_os, stack_os);
+      }
+      dump.state = state_os.str();
+      dump.stack = stack_os.str();
+      {
+        MutexLock mu(self, *Locks::logging_lock_);
+        deferred_dumps_.push_back(std::move(dump));
+      }
+      barrier_.Pass(self);
+      return;
+    }
     std::ostringstream local_os;
     {
       ScopedObjectAccess soa(self);
@@ -229,6 +258,30 @@ class DumpCheckpoint FINAL : public Closure {
     barrier_.Pass(self);
   }
 
+  // Writes the dumps of the threads that ran the checkpoint with deferred native stacks. The
+  // threads have resumed, so their native stacks are unwound as they are now, like the stacks
+  // of unattached threads.
+  void DumpDeferred() {
+    if (!defer_native_stacks_) {
+      return;
+    }
+    std::vector<DeferredDump> dumps;
+    {
+      MutexLock mu(Thread::Current(), *Locks::logging_lock_);
+      dumps.swap(deferred_dumps_);
+    }
+    for (const DeferredDump& dump : dumps) {
+      std::ostringstream local_os;
+      local_os << dump.state;
+      if (dump.dump_native_stack) {
+        DumpKernelStack(local_os, dump.tid, "  kernel: ", false);
+        DumpNativeStack(local_os, dump.tid, backtrace_map_.get(), "  native: ");
+      }
+      local_os << dump.stack;
+      *os_ << local_os.str() << std::endl;
+    }
+  }
+
   void WaitForThreadsToRunThroughCheckpoint(size_t threads_running_checkpoint) {
     Thread* self = Thread::Current();
     ScopedThreadStateChange tsc(self, kWaitingForCheckPointsToRun);
@@ -249,16 +302,27 @@ class DumpCheckpoint FINAL : public Closure {
   std::unique_ptr<BacktraceMap> backtrace_map_;
   // Whether we should dump the native stack.
   const bool dump_native_stack_;
+  // Whether the native stacks are dumped by DumpDeferred().
+  const bool defer_native_stacks_;
+
+  struct DeferredDump {
+    pid_t tid;
+    bool dump_native_stack;
+    std::string state;
+    std::string stack;
+  };
+  // The dumps waiting for their native stack, guarded by the logging lock.
+  std::vector<DeferredDump> deferred_dumps_;
 };
 
-void ThreadList::Dump(std::ostream& os, bool dump_native_stack) {
+void ThreadList::Dump(std::ostream& os, bool dump_native_stack, bool defer_native_stacks) {
   Thread* self = Thread::Current();
   {
     MutexLock mu(self, *Locks::thread_list_lock_);
     os << "DALVIK THREADS (" << list_.size() << "):\n";
   }
   if (self != nullptr) {
-    DumpCheckpoint checkpoint(&os, dump_native_stack);
+    DumpCheckpoint checkpoint(&os, dump_native_stack, defer_native_stacks);
     size_t threads_running_checkpoint;
     {
       // Use SOA to prevent deadlocks if multiple threads are calling Dump() at the same time.
@@ -268,6 +332,7 @@ void ThreadList::Dump(std::ostream& os, bool dump_native_stack) {
     if (threads_running_checkpoint != 0) {
       checkpoint.WaitForThreadsToRunThroughCheckpoint(threads_running_checkpoint);
     }
+    checkpoint.DumpDeferred();
   } else {
     DumpUnattachedThreads(os, dump_native_stack);
   }
@@ -535,6 +600,68 @@ size_t ThreadList::RunCheckpointOnRunnableThreads(Closure* checkpoint_function)
   return count;
 }
 
+// Runs the flip functions of the suspended threads not yet claimed by another worker. What a
+// worker marks goes onto its own thread-local mark stack, as for a mutator.
+class FlipThreadsTask : public Task {
+ public:
+  FlipThreadsTask(const std::vector<Thread*>* threads, Atomic<size_t>* next_index)
+      : threads_(threads), next_index_(next_index) {}
+
+  // Like the parallel marking tasks, the workers rely on the GC-running thread holding the
+  // mutator lock (shared) while it waits for them.
+  void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    const size_t num_threads = threads_->size();
+    for (size_t i = next_index_->FetchAndAddRelaxed(1u); i < num_threads;
+         i = next_index_->FetchAndAddRelaxed(1u)) {
+      Thread* thread = (*threads_)[i];
+      Closure* flip_func = thread->GetFlipFunction();
+      if (flip_func != nullptr) {
+        flip_func->Run(thread);
+      }
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  const std::vector<Thread*>* const threads_;
+  Atomic<size_t>* const next_index_;
+};
+
+void ThreadList::RunFlipFunctions(Thread* self,
+                                  const std::vector<Thread*>& threads,
+                                  gc::Heap* heap) {
+  ThreadPool* thread_pool = heap->GetThreadPool();
+  size_t num_workers = 0u;
+  // Like parallel marking, leave the CPU time to the foreground apps when in the background.
+  if (thread_pool != nullptr &&
+      threads.size() >= kMinParallelFlipThreads &&
+      Runtime::Current()->InJankPerceptibleProcessState()) {
+    num_workers = std::min(heap->GetParallelGCThreadCount(), thread_pool->GetThreadCount());
+  }
+  if (num_workers == 0u) {
+    for (Thread* thread : threads) {
+      Closure* flip_func = thread->GetFlipFunction();
+      if (flip_func != nullptr) {
+        flip_func->Run(thread);
+      }
+    }
+    return;
+  }
+  // The GC-running thread takes part too. A thread whose flip function was already run, by itself
+  // or by a checkpoint, is simply skipped by whoever claims it.
+  Atomic<size_t> next_index(0u);
+  for (size_t i = 0; i <= num_workers; ++i) {
+    thread_pool->AddTask(self, new FlipThreadsTask(&threads, &next_index));
+  }
+  thread_pool->SetMaxActiveWorkers(num_workers);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+  thread_pool->StopWorkers(self);
+}
+
 // A checkpoint/suspend-all hybrid to switch thread roots from
 // from-space to to-space refs. Used to synchronize threads at a point
 // to mark the initiation of marking while maintaining the to-space
@@ -555,14 +682,14 @@ size_t ThreadList::FlipThreadRoots(Closure* thread_flip_visitor,
   // ThreadFlipBegin happens before we suspend all the threads, so it does not count towards the
   // pause.
   const uint64_t suspend_start_time = NanoTime();
-  SuspendAllInternal(self, self, nullptr);
+  Thread* slowest_thread = SuspendAllInternal(self, self, nullptr);
   if (pause_listener != nullptr) {
     pause_listener->StartPause();
   }
 
   // Run the flip callback for the collector.
   Locks::mutator_lock_->ExclusiveLock(self);
-  suspend_all_historam_.AdjustAndAddValue(NanoTime() - suspend_start_time);
+  RecordSuspendAllTime(NanoTime() - suspend_start_time, slowest_thread);
   flip_callback->Run(self);
   Locks::mutator_lock_->ExclusiveUnlock(self);
   collector->RegisterPause(NanoTime() - suspend_start_time);
@@ -610,12 +737,7 @@ size_t ThreadList::FlipThreadRoots(Closure* thread_flip_visitor,
   {
     TimingLogger::ScopedTiming split3("FlipOtherThreads", collector->GetTimings());
     ReaderMutexLock mu(self, *Locks::mutator_lock_);
-    for (const auto& thread : other_threads) {
-      Closure* flip_func = thread->GetFlipFunction();
-      if (flip_func != nullptr) {
-        flip_func->Run(thread);
-      }
-    }
+    RunFlipFunctions(self, other_threads, collector->GetHeap());
     // Run it for self.
     Closure* flip_func = self->GetFlipFunction();
     if (flip_func != nullptr) {
@@ -649,7 +771,7 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
     ScopedTrace trace("Suspending mutator threads");
     const uint64_t start_time = NanoTime();
 
-    SuspendAllInternal(self, self);
+    Thread* slowest_thread = SuspendAllInternal(self, self);
     // All threads are known to have suspended (but a thread may still own the mutator lock)
     // Make sure this thread grabs exclusive access to the mutator lock and its protected data.
 #if HAVE_TIMED_RWLOCK
@@ -672,11 +794,7 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
     long_suspend_ = long_suspend;
 
     const uint64_t end_time = NanoTime();
-    const uint64_t suspend_time = end_time - start_time;
-    suspend_all_historam_.AdjustAndAddValue(suspend_time);
-    if (suspend_time > kLongThreadSuspendThreshold) {
-      LOG(WARNING) << "Suspending all threads took: " << PrettyDuration(suspend_time);
-    }
+    RecordSuspendAllTime(end_time - start_time, slowest_thread);
 
     if (kDebugLocking) {
       // Debug check that all threads are suspended.
@@ -696,10 +814,52 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
 // Debugger thread might be set to kRunnable for a short period of time after the
 // SuspendAllInternal. This is safe because it will be set back to suspended state before
 // the SuspendAll returns.
-void ThreadList::SuspendAllInternal(Thread* self,
-                                    Thread* ignore1,
-                                    Thread* ignore2,
-                                    SuspendReason reason) {
+void ThreadList::RecordSuspendAllTime(uint64_t suspend_time, Thread* slowest_thread) {
+  suspend_all_historam_.AdjustAndAddValue(suspend_time);
+  if (suspend_time <= kLongThreadSuspendThreshold) {
+    return;
+  }
+  // The thread is suspended now, so we can tell where it got to its suspend point, or the Java
+  // caller of the native code it returned to.
+  std::string slowest;
+  if (slowest_thread != nullptr) {
+    std::string thread_name;
+    slowest_thread->GetThreadName(thread_name);
+    uint32_t dex_pc = 0u;
+    ArtMethod* method = slowest_thread->GetCurrentMethod(&dex_pc,
+                                                         /* check_suspended */ true,
+                                                         /* abort_on_error */ false);
+    slowest = StringPrintf("\"%s\" tid=%d in %s at dex pc 0x%x",
+                           thread_name.c_str(),
+                           slowest_thread->GetTid(),
+                           ArtMethod::PrettyMethod(method).c_str(),
+                           dex_pc);
+  }
+  LOG(WARNING) << "Suspending all threads took: " << PrettyDuration(suspend_time)
+               << (slowest.empty() ? "" : ", waiting for ") << slowest;
+  if (suspend_time > max_suspend_all_time_ && !slowest.empty()) {
+    max_suspend_all_time_ = suspend_time;
+    max_suspend_all_thread_ = slowest;
+  }
+}
+
+Thread* ThreadList::FindThreadWithActiveSuspendBarrier(Thread* self,
+                                                       Thread* ignore1,
+                                                       Thread* ignore2) {
+  MutexLock mu(self, *Locks::thread_list_lock_);
+  MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
+  for (Thread* thread : list_) {
+    if (thread != ignore1 && thread != ignore2 && thread->ReadFlag(kActiveSuspendBarrier)) {
+      return thread;
+    }
+  }
+  return nullptr;
+}
+
+Thread* ThreadList::SuspendAllInternal(Thread* self,
+                                       Thread* ignore1,
+                                       Thread* ignore2,
+                                       SuspendReason reason) {
   Locks::mutator_lock_->AssertNotExclusiveHeld(self);
   Locks::thread_list_lock_->AssertNotHeld(self);
   Locks::thread_suspend_count_lock_->AssertNotHeld(self);
@@ -754,12 +914,15 @@ void ThreadList::SuspendAllInternal(Thread* self,
   }
 
   // Wait for the barrier to be passed by all runnable threads. This wait
-  // is done with a timeout so that we can detect problems.
+  // is done with a timeout so that we can detect problems. The timeout is short
+  // so that we also see which thread is the last to suspend when it takes long.
 #if ART_USE_FUTEXES
   timespec wait_timeout;
-  InitTimeSpec(false, CLOCK_MONOTONIC, NsToMs(thread_suspend_timeout_ns_), 0, &wait_timeout);
+  InitTimeSpec(false, CLOCK_MONOTONIC, NsToMs(kLongThreadSuspendThreshold), 0, &wait_timeout);
+  uint64_t next_timeout_ns = thread_suspend_timeout_ns_;
 #endif
   const uint64_t start_time = NanoTime();
+  Thread* slowest_thread = nullptr;
   while (true) {
     int32_t cur_val = pending_threads.LoadRelaxed();
     if (LIKELY(cur_val > 0)) {
@@ -768,9 +931,17 @@ void ThreadList::SuspendAllInternal(Thread* self,
         // EAGAIN and EINTR both indicate a spurious failure, try again from the beginning.
         if ((errno != EAGAIN) && (errno != EINTR)) {
           if (errno == ETIMEDOUT) {
-            LOG(kIsDebugBuild ? ::android::base::FATAL : ::android::base::ERROR)
-                << "Timed out waiting for threads to suspend, waited for "
-                << PrettyDuration(NanoTime() - start_time);
+            Thread* pending_thread = FindThreadWithActiveSuspendBarrier(self, ignore1, ignore2);
+            if (pending_thread != nullptr) {
+              slowest_thread = pending_thread;
+            }
+            const uint64_t wait_time = NanoTime() - start_time;
+            if (wait_time >= next_timeout_ns) {
+              LOG(kIsDebugBuild ? ::android::base::FATAL : ::android::base::ERROR)
+                  << "Timed out waiting for threads to suspend, waited for "
+                  << PrettyDuration(wait_time);
+              next_timeout_ns += thread_suspend_timeout_ns_;
+            }
           } else {
             PLOG(FATAL) << "futex wait failed for SuspendAllInternal()";
           }
@@ -785,6 +956,7 @@ void ThreadList::SuspendAllInternal(Thread* self,
       break;
     }
   }
+  return slowest_thread;
 }
 
 void ThreadList::ResumeAll() {
@@ -1477,6 +1649,8 @@ void ThreadList::Unregister(Thread* self) {
     }
     // We failed to remove the thread due to a suspend request, loop and try again.
   }
+  // A sampling signal would find the deleted Thread until the TLS is cleared.
+  SamplingProfiler::ScopedBlockSignal sbs;
   delete self;
 
   // Release the thread ID after the thread is finished and deleted to avoid cases where we can
@@ -1504,6 +1678,15 @@ void ThreadList::ForEach(void (*callback)(Thread*, void*), void* context) {
   }
 }
 
+void ThreadList::ClearInterpreterCaches() const {
+  Thread* self = Thread::Current();
+  Locks::mutator_lock_->AssertExclusiveHeld(self);
+  MutexLock mu(self, *Locks::thread_list_lock_);
+  for (Thread* thread : list_) {
+    thread->GetInterpreterCache()->Clear();
+  }
+}
+
 void ThreadList::VisitRootsForSuspendedThreads(RootVisitor* visitor) {
   Thread* const self = Thread::Current();
   std::vector<Thread*> threads_to_visit;
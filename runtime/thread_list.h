@@ -27,6 +27,7 @@
 
 #include <bitset>
 #include <list>
+#include <string>
 #include <vector>
 
 namespace art {
@@ -35,6 +36,7 @@ namespace collector {
 class GarbageCollector;
 }  // namespace collector
 class GcPauseListener;
+class Heap;
 }  // namespace gc
 class Closure;
 class RootVisitor;
@@ -56,8 +58,10 @@ class ThreadList {
 
   void DumpForSigQuit(std::ostream& os)
       REQUIRES(!Locks::thread_list_lock_, !Locks::mutator_lock_);
-  // For thread suspend timeout dumps.
-  void Dump(std::ostream& os, bool dump_native_stack = true)
+  // For thread suspend timeout dumps. With `defer_native_stacks`, threads only dump their managed
+  // stacks in the dump checkpoint and resume, and their native stacks are unwound and symbolized
+  // afterwards by the caller.
+  void Dump(std::ostream& os, bool dump_native_stack = true, bool defer_native_stacks = false)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
   pid_t GetLockOwner();  // For SignalCatcher.
 
@@ -151,6 +155,11 @@ class ThreadList {
   void ForEach(void (*callback)(Thread*, void*), void* context)
       REQUIRES(Locks::thread_list_lock_);
 
+  // Clears the interpreter cache of all threads. Requires all other threads to be suspended,
+  // e.g. when dispatch targets change due to class redefinition.
+  void ClearInterpreterCaches() const
+      REQUIRES(Locks::mutator_lock_, !Locks::thread_list_lock_);
+
   // Add/remove current thread from list.
   void Register(Thread* self)
       REQUIRES(Locks::runtime_shutdown_lock_)
@@ -198,15 +207,34 @@ class ThreadList {
   void WaitForOtherNonDaemonThreadsToExit()
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
-  void SuspendAllInternal(Thread* self,
-                          Thread* ignore1,
-                          Thread* ignore2 = nullptr,
-                          SuspendReason reason = SuspendReason::kInternal)
+  // Returns the last thread seen not yet suspended if suspending took longer than
+  // kLongThreadSuspendThreshold, null otherwise. It stays valid until the threads are resumed.
+  Thread* SuspendAllInternal(Thread* self,
+                             Thread* ignore1,
+                             Thread* ignore2 = nullptr,
+                             SuspendReason reason = SuspendReason::kInternal)
+      REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
+
+  // Find a thread that has not passed its suspend barrier yet, if any.
+  Thread* FindThreadWithActiveSuspendBarrier(Thread* self, Thread* ignore1, Thread* ignore2)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // Record the time to suspend all threads and, for the slowest so far, the thread which took the
+  // longest and where it got suspended.
+  void RecordSuspendAllTime(uint64_t suspend_time, Thread* slowest_thread)
+      REQUIRES(Locks::mutator_lock_);
+
   void AssertThreadsAreSuspended(Thread* self, Thread* ignore1, Thread* ignore2 = nullptr)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // Run the flip functions of the suspended `threads` for FlipThreadRoots(), spread over the GC
+  // thread pool of `heap` when there are enough of them.
+  void RunFlipFunctions(Thread* self, const std::vector<Thread*>& threads, gc::Heap* heap)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Minimum number of suspended threads for running their flip functions in parallel.
+  static constexpr size_t kMinParallelFlipThreads = 16;
+
   std::bitset<kMaxThreadId> allocated_ids_ GUARDED_BY(Locks::allocated_thread_ids_lock_);
 
   // The actual list of all threads.
@@ -223,6 +251,11 @@ class ThreadList {
   // by mutator lock ensures no thread can read when another thread is modifying it.
   Histogram<uint64_t> suspend_all_historam_ GUARDED_BY(Locks::mutator_lock_);
 
+  // The longest time to suspend all threads, and the thread which held it up, guarded like the
+  // histogram.
+  uint64_t max_suspend_all_time_ GUARDED_BY(Locks::mutator_lock_);
+  std::string max_suspend_all_thread_ GUARDED_BY(Locks::mutator_lock_);
+
   // Whether or not the current thread suspension is long.
   bool long_suspend_;
 
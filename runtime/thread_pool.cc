@@ -39,6 +39,55 @@ using android::base::StringPrintf;
 
 static constexpr bool kMeasureWaitTime = false;
 
+bool TaskDeque::Push(Task* task) {
+  const intptr_t bottom = bottom_.LoadRelaxed();
+  const intptr_t top = top_.LoadAcquire();
+  if (bottom - top >= static_cast<intptr_t>(kCapacity)) {
+    return false;
+  }
+  tasks_[bottom % kCapacity].StoreRelaxed(task);
+  // Publish the task before the thieves can see the new bottom.
+  QuasiAtomic::ThreadFenceRelease();
+  bottom_.StoreRelaxed(bottom + 1);
+  return true;
+}
+
+Task* TaskDeque::Pop() {
+  const intptr_t bottom = bottom_.LoadRelaxed() - 1;
+  bottom_.StoreRelaxed(bottom);
+  // Order the claim of the bottom task before reading the top, against Steal().
+  QuasiAtomic::ThreadFenceSequentiallyConsistent();
+  intptr_t top = top_.LoadRelaxed();
+  if (top > bottom) {
+    // Empty.
+    bottom_.StoreRelaxed(bottom + 1);
+    return nullptr;
+  }
+  Task* task = tasks_[bottom % kCapacity].LoadRelaxed();
+  if (top == bottom) {
+    // The last task, race the thieves for it.
+    if (!top_.CompareAndSetStrongSequentiallyConsistent(top, top + 1)) {
+      task = nullptr;
+    }
+    bottom_.StoreRelaxed(bottom + 1);
+  }
+  return task;
+}
+
+Task* TaskDeque::Steal() {
+  const intptr_t top = top_.LoadAcquire();
+  QuasiAtomic::ThreadFenceSequentiallyConsistent();
+  const intptr_t bottom = bottom_.LoadAcquire();
+  if (top >= bottom) {
+    return nullptr;
+  }
+  Task* task = tasks_[top % kCapacity].LoadRelaxed();
+  if (!top_.CompareAndSetStrongSequentiallyConsistent(top, top + 1)) {
+    return nullptr;
+  }
+  return task;
+}
+
 ThreadPoolWorker::ThreadPoolWorker(ThreadPool* thread_pool, const std::string& name,
                                    size_t stack_size)
     : thread_pool_(thread_pool),
@@ -107,6 +156,17 @@ void* ThreadPoolWorker::Callback(void* arg) {
 }
 
 void ThreadPool::AddTask(Thread* self, Task* task) {
+  TaskDeque* local_tasks = GetLocalTasks(self);
+  if (local_tasks != nullptr && local_tasks->Push(task)) {
+    num_local_tasks_.FetchAndAddSequentiallyConsistent(1u);
+    if (MayHaveWaitingWorkers()) {
+      MutexLock mu(self, task_queue_lock_);
+      if (started_ && waiting_count_ != 0) {
+        task_queue_condition_.Signal(self);
+      }
+    }
+    return;
+  }
   MutexLock mu(self, task_queue_lock_);
   tasks_.push_back(task);
   // If we have any waiters, signal one.
@@ -115,12 +175,32 @@ void ThreadPool::AddTask(Thread* self, Task* task) {
   }
 }
 
+void ThreadPool::AddTasks(Thread* self, ArrayRef<Task* const> tasks) {
+  MutexLock mu(self, task_queue_lock_);
+  tasks_.insert(tasks_.end(), tasks.begin(), tasks.end());
+  if (started_ && waiting_count_ != 0) {
+    if (tasks.size() == 1u) {
+      task_queue_condition_.Signal(self);
+    } else {
+      task_queue_condition_.Broadcast(self);
+    }
+  }
+}
+
 void ThreadPool::RemoveAllTasks(Thread* self) {
   MutexLock mu(self, task_queue_lock_);
   tasks_.clear();
+  for (const std::unique_ptr<TaskDeque>& local_tasks : local_tasks_) {
+    while (local_tasks->Steal() != nullptr) {
+      num_local_tasks_.FetchAndSubSequentiallyConsistent(1u);
+    }
+  }
 }
 
-ThreadPool::ThreadPool(const char* name, size_t num_threads, bool create_peers)
+ThreadPool::ThreadPool(const char* name,
+                       size_t num_threads,
+                       bool create_peers,
+                       bool work_stealing)
   : name_(name),
     task_queue_lock_("task queue lock"),
     task_queue_condition_("task queue condition", task_queue_lock_),
@@ -133,8 +213,14 @@ ThreadPool::ThreadPool(const char* name, size_t num_threads, bool create_peers)
     // Add one since the caller of constructor waits on the barrier too.
     creation_barier_(num_threads + 1),
     max_active_workers_(num_threads),
-    create_peers_(create_peers) {
+    create_peers_(create_peers),
+    num_local_tasks_(0u) {
   Thread* self = Thread::Current();
+  if (work_stealing) {
+    for (size_t i = 0; i != num_threads; ++i) {
+      local_tasks_.emplace_back(new TaskDeque());
+    }
+  }
   while (GetThreadCount() < num_threads) {
     const std::string worker_name = StringPrintf("%s worker thread %zu", name_.c_str(),
                                                  GetThreadCount());
@@ -178,7 +264,41 @@ void ThreadPool::StopWorkers(Thread* self) {
   started_ = false;
 }
 
+TaskDeque* ThreadPool::GetLocalTasks(Thread* self) {
+  if (local_tasks_.empty()) {
+    return nullptr;
+  }
+  for (size_t i = 0, size = threads_.size(); i != size; ++i) {
+    if (threads_[i]->GetThread() == self) {
+      return local_tasks_[i].get();
+    }
+  }
+  return nullptr;
+}
+
+Task* ThreadPool::TryGetLocalTask(Thread* self) {
+  if (num_local_tasks_.LoadSequentiallyConsistent() == 0u) {
+    return nullptr;
+  }
+  TaskDeque* own_tasks = GetLocalTasks(self);
+  Task* task = (own_tasks != nullptr) ? own_tasks->Pop() : nullptr;
+  for (size_t i = 0, size = local_tasks_.size(); task == nullptr && i != size; ++i) {
+    if (local_tasks_[i].get() != own_tasks) {
+      task = local_tasks_[i]->Steal();
+    }
+  }
+  if (task != nullptr) {
+    num_local_tasks_.FetchAndSubSequentiallyConsistent(1u);
+  }
+  return task;
+}
+
 Task* ThreadPool::GetTask(Thread* self) {
+  // Run the tasks of the own deque first, without locking.
+  Task* local_task = TryGetLocalTask(self);
+  if (local_task != nullptr) {
+    return local_task;
+  }
   MutexLock mu(self, task_queue_lock_);
   while (!IsShuttingDown()) {
     const size_t thread_count = GetThreadCount();
@@ -187,13 +307,17 @@ Task* ThreadPool::GetTask(Thread* self) {
     // <= since self is considered an active worker.
     if (active_threads <= max_active_workers_) {
       Task* task = TryGetTaskLocked();
+      if (task == nullptr && started_) {
+        task = TryGetLocalTask(self);
+      }
       if (task != nullptr) {
         return task;
       }
     }
 
     ++waiting_count_;
-    if (waiting_count_ == GetThreadCount() && !HasOutstandingTasks()) {
+    if (waiting_count_ == GetThreadCount() && !HasOutstandingTasks() &&
+        !HasOutstandingLocalTasks()) {
       // We may be done, lets broadcast to the completion condition.
       completion_condition_.Broadcast(self);
     }
@@ -212,7 +336,8 @@ Task* ThreadPool::GetTask(Thread* self) {
 
 Task* ThreadPool::TryGetTask(Thread* self) {
   MutexLock mu(self, task_queue_lock_);
-  return TryGetTaskLocked();
+  Task* task = TryGetTaskLocked();
+  return (task != nullptr) ? task : TryGetLocalTask(self);
 }
 
 Task* ThreadPool::TryGetTaskLocked() {
@@ -235,7 +360,9 @@ void ThreadPool::Wait(Thread* self, bool do_work, bool may_hold_locks) {
   }
   // Wait until each thread is waiting and the task list is empty.
   MutexLock mu(self, task_queue_lock_);
-  while (!shutting_down_ && (waiting_count_ != GetThreadCount() || HasOutstandingTasks())) {
+  while (!shutting_down_ &&
+         (waiting_count_ != GetThreadCount() || HasOutstandingTasks() ||
+          HasOutstandingLocalTasks())) {
     if (!may_hold_locks) {
       completion_condition_.Wait(self);
     } else {
@@ -246,7 +373,7 @@ void ThreadPool::Wait(Thread* self, bool do_work, bool may_hold_locks) {
 
 size_t ThreadPool::GetTaskCount(Thread* self) {
   MutexLock mu(self, task_queue_lock_);
-  return tasks_.size();
+  return tasks_.size() + num_local_tasks_.LoadSequentiallyConsistent();
 }
 
 void ThreadPool::SetPthreadPriority(int priority) {
@@ -21,6 +21,8 @@
 #include <vector>
 
 #include "barrier.h"
+#include "base/array_ref.h"
+#include "base/atomic.h"
 #include "base/mutex.h"
 #include "mem_map.h"
 
@@ -48,6 +50,31 @@ class SelfDeletingTask : public Task {
   }
 };
 
+// A bounded Chase-Lev work-stealing deque of tasks. Only the worker owning it pushes and pops at
+// the bottom, without locking. Any other thread may steal from the top.
+class TaskDeque {
+ public:
+  static constexpr size_t kCapacity = 256;
+
+  TaskDeque() : top_(0), bottom_(0) {}
+
+  // Owner only. Returns false if the deque is full.
+  bool Push(Task* task);
+
+  // Owner only. Returns the most recently pushed task, or null if there is none.
+  Task* Pop();
+
+  // Returns the least recently pushed task, or null if there is none or another thread got it.
+  Task* Steal();
+
+ private:
+  Atomic<intptr_t> top_;
+  Atomic<intptr_t> bottom_;
+  Atomic<Task*> tasks_[kCapacity];
+
+  DISALLOW_COPY_AND_ASSIGN(TaskDeque);
+};
+
 class ThreadPoolWorker {
  public:
   static const size_t kDefaultStackSize = 1 * MB;
@@ -99,9 +126,13 @@ class ThreadPool {
   void StopWorkers(Thread* self) REQUIRES(!task_queue_lock_);
 
   // Add a new task, the first available started worker will process it. Does not delete the task
-  // after running it, it is the caller's responsibility.
+  // after running it, it is the caller's responsibility. In a work stealing pool, a task added by
+  // a worker goes onto the worker's own deque, see ThreadPool().
   void AddTask(Thread* self, Task* task) REQUIRES(!task_queue_lock_);
 
+  // Add the tasks at once, like AddTask(), taking the lock only once.
+  void AddTasks(Thread* self, ArrayRef<Task* const> tasks) REQUIRES(!task_queue_lock_);
+
   // Remove all tasks in the queue.
   void RemoveAllTasks(Thread* self) REQUIRES(!task_queue_lock_);
 
@@ -110,7 +141,15 @@ class ThreadPool {
   // If create_peers is true, all worker threads will have a Java peer object. Note that if the
   // pool is asked to do work on the current thread (see Wait), a peer may not be available. Wait
   // will conservatively abort if create_peers and do_work are true.
-  ThreadPool(const char* name, size_t num_threads, bool create_peers = false);
+  //
+  // If work_stealing is true, the tasks that workers add, like those a parallel GC task splits
+  // off, are pushed onto a deque of the worker and run by it (last in, first out) without taking
+  // the queue lock. Idle workers steal from them. For pools whose tasks spawn more tasks and do
+  // not depend on the FIFO order.
+  ThreadPool(const char* name,
+             size_t num_threads,
+             bool create_peers = false,
+             bool work_stealing = false);
   virtual ~ThreadPool();
 
   // Wait for all tasks currently on queue to get completed. If the pool has been stopped, only
@@ -138,7 +177,9 @@ class ThreadPool {
 
   // Try to get a task, returning null if there is none available.
   Task* TryGetTask(Thread* self) REQUIRES(!task_queue_lock_);
-  Task* TryGetTaskLocked() REQUIRES(task_queue_lock_);
+  // Remove the next task to run from the queue. Tasks run in FIFO order by default,
+  // subclasses may order them differently.
+  virtual Task* TryGetTaskLocked() REQUIRES(task_queue_lock_);
 
   // Are we shutting down?
   bool IsShuttingDown() const REQUIRES(task_queue_lock_) {
@@ -149,6 +190,24 @@ class ThreadPool {
     return started_ && !tasks_.empty();
   }
 
+  // Whether there are tasks on the deques of the workers, which TryGetTaskLocked() does not see.
+  bool HasOutstandingLocalTasks() const REQUIRES(task_queue_lock_) {
+    return started_ && num_local_tasks_.LoadSequentiallyConsistent() != 0u;
+  }
+
+  // The deque of the worker running on `self`, or null if it is not a worker of a work stealing
+  // pool.
+  TaskDeque* GetLocalTasks(Thread* self);
+
+  // Pop a task of the worker running on `self` or steal one from the other workers.
+  Task* TryGetLocalTask(Thread* self);
+
+  // Unlocked and racy. A worker just going to wait may be missed, then the owner of a local task
+  // runs it itself.
+  bool MayHaveWaitingWorkers() const NO_THREAD_SAFETY_ANALYSIS {
+    return waiting_count_ != 0u;
+  }
+
   const std::string name_;
   Mutex task_queue_lock_;
   ConditionVariable task_queue_condition_ GUARDED_BY(task_queue_lock_);
@@ -166,6 +225,10 @@ class ThreadPool {
   Barrier creation_barier_;
   size_t max_active_workers_ GUARDED_BY(task_queue_lock_);
   const bool create_peers_;
+  // One deque per worker, in the order of threads_, if work stealing. Tasks on them are counted
+  // in num_local_tasks_.
+  std::vector<std::unique_ptr<TaskDeque>> local_tasks_;
+  Atomic<size_t> num_local_tasks_;
 
  private:
   friend class ThreadPoolWorker;
@@ -17,6 +17,7 @@
 #include "thread_pool.h"
 
 #include <string>
+#include <vector>
 
 #include "base/atomic.h"
 #include "common_runtime_test.h"
@@ -160,6 +161,88 @@ TEST_F(ThreadPoolTest, RecursiveTest) {
   EXPECT_EQ((1 << depth) - 1, count.LoadSequentiallyConsistent());
 }
 
+// Test that the tasks added from within tasks to the deques of the workers all get run.
+TEST_F(ThreadPoolTest, WorkStealingRecursiveTest) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Thread pool test thread pool",
+                         num_threads,
+                         /* create_peers */ false,
+                         /* work_stealing */ true);
+  AtomicInteger count(0);
+  // Workers run the subtrees they add themselves, idle workers steal the others.
+  static const int depth = 12;
+  thread_pool.AddTask(self, new TreeTask(&thread_pool, &count, depth));
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, true, false);
+  EXPECT_EQ((1 << depth) - 1, count.LoadSequentiallyConsistent());
+  EXPECT_EQ(0u, thread_pool.GetTaskCount(self));
+}
+
+TEST_F(ThreadPoolTest, AddTasks) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Thread pool test thread pool", num_threads);
+  AtomicInteger count(0);
+  std::vector<Task*> tasks;
+  for (int32_t i = 0; i < num_threads * 4; ++i) {
+    tasks.push_back(new CountTask(&count));
+  }
+  thread_pool.AddTasks(self, ArrayRef<Task* const>(tasks));
+  EXPECT_EQ(tasks.size(), thread_pool.GetTaskCount(self));
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, true, false);
+  EXPECT_EQ(num_threads * 4, count.LoadSequentiallyConsistent());
+}
+
+class OrderTask : public Task {
+ public:
+  OrderTask(std::vector<int>* order, int id) : order_(order), id_(id) {}
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) {
+    order_->push_back(id_);
+  }
+
+  void Finalize() {
+    delete this;
+  }
+
+ private:
+  std::vector<int>* const order_;
+  const int id_;
+};
+
+class LifoThreadPool : public ThreadPool {
+ public:
+  LifoThreadPool() : ThreadPool("Thread pool test thread pool", 1) {}
+
+ protected:
+  Task* TryGetTaskLocked() OVERRIDE REQUIRES(task_queue_lock_) {
+    if (!HasOutstandingTasks()) {
+      return nullptr;
+    }
+    Task* task = tasks_.back();
+    tasks_.pop_back();
+    return task;
+  }
+};
+
+// Test that subclasses can choose the order in which the tasks run.
+TEST_F(ThreadPoolTest, TaskOrder) {
+  Thread* self = Thread::Current();
+  LifoThreadPool thread_pool;
+  // Only accessed by the single worker.
+  std::vector<int> order;
+  static const int num_tasks = 8;
+  for (int i = 0; i < num_tasks; ++i) {
+    thread_pool.AddTask(self, new OrderTask(&order, i));
+  }
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, false, false);
+  ASSERT_EQ(static_cast<size_t>(num_tasks), order.size());
+  for (int i = 0; i < num_tasks; ++i) {
+    EXPECT_EQ(num_tasks - 1 - i, order[i]);
+  }
+}
+
 class PeerTask : public Task {
  public:
   PeerTask() {}
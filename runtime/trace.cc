@@ -24,6 +24,7 @@
 #include "art_method-inl.h"
 #include "base/casts.h"
 #include "base/enums.h"
+#include "base/leb128.h"
 #include "base/os.h"
 #include "base/stl_util.h"
 #include "base/systrace.h"
@@ -57,6 +58,12 @@ static constexpr size_t TraceActionBits = MinimumBitsToStore(
 static constexpr uint8_t kOpNewMethod = 1U;
 static constexpr uint8_t kOpNewThread = 2U;
 static constexpr uint8_t kOpTraceSummary = 3U;
+static constexpr uint8_t kOpThreadEvents = 4U;
+
+// Three unsigned LEB128 values of up to five bytes.
+static constexpr size_t kMaxStreamingEventSize = 15U;
+// Threads wait for the writer thread when this many blocks are pending.
+static constexpr size_t kMaxPendingStreamingBlocks = 64U;
 
 class BuildStackTraceVisitor : public StackVisitor {
  public:
@@ -91,6 +98,7 @@ static const uint16_t kTraceVersionSingleClock    = 2;
 static const uint16_t kTraceVersionDualClock      = 3;
 static const uint16_t kTraceRecordSizeSingleClock = 10;  // using v2
 static const uint16_t kTraceRecordSizeDualClock   = 14;  // using v3 with two timestamps
+static const uint16_t kTraceVersionStreaming      = 4;   // LEB128 events, see trace.h
 
 TraceClockSource Trace::default_clock_source_ = kDefaultTraceClockSource;
 
@@ -110,7 +118,7 @@ ArtMethod* Trace::DecodeTraceMethod(uint32_t tmid) {
   return unique_methods_[tmid >> TraceActionBits];
 }
 
-uint32_t Trace::EncodeTraceMethod(ArtMethod* method) {
+uint32_t Trace::EncodeTraceMethod(ArtMethod* method, bool* is_new) {
   MutexLock mu(Thread::Current(), *unique_methods_lock_);
   uint32_t idx;
   auto it = art_method_id_map_.find(method);
@@ -121,6 +129,9 @@ uint32_t Trace::EncodeTraceMethod(ArtMethod* method) {
     idx = unique_methods_.size() - 1;
     art_method_id_map_.emplace(method, idx);
   }
+  if (is_new != nullptr) {
+    *is_new = (it == art_method_id_map_.end());
+  }
   DCHECK_LT(idx, unique_methods_.size());
   DCHECK_EQ(unique_methods_[idx], method);
   return idx;
@@ -374,6 +385,9 @@ void Trace::Start(const char* trace_filename, int trace_fd, size_t buffer_size,
       enable_stats = (flags && kTraceCountAllocs) != 0;
       the_trace_ = new Trace(trace_file.release(), trace_filename, buffer_size, flags, output_mode,
                              trace_mode);
+      if (output_mode == TraceOutputMode::kStreaming) {
+        the_trace_->StartStreamingWriter();
+      }
       if (trace_mode == TraceMode::kSampling) {
         CHECK_PTHREAD_CALL(pthread_create, (&sampling_pthread_, nullptr, &RunSamplingThread,
                                             reinterpret_cast<void*>(interval_us)),
@@ -385,7 +399,9 @@ void Trace::Start(const char* trace_filename, int trace_fd, size_t buffer_size,
                                                    instrumentation::Instrumentation::kMethodExited |
                                                    instrumentation::Instrumentation::kMethodUnwind);
         // TODO: In full-PIC mode, we don't need to fully deopt.
-        runtime->GetInstrumentation()->EnableMethodTracing(kTracerInstrumentationKey);
+        runtime->GetInstrumentation()->EnableMethodTracing(
+            kTracerInstrumentationKey,
+            runtime->GetInstrumentation()->MethodEntryExitNeedsInterpreter());
       }
     }
   }
@@ -422,23 +438,38 @@ void Trace::StopTracing(bool finish_tracing, bool flush_file) {
 
   if (the_trace != nullptr) {
     stop_alloc_counting = (the_trace->flags_ & Trace::kTraceCountAllocs) != 0;
-    if (finish_tracing) {
+    const bool streaming = (the_trace->trace_output_mode_ == TraceOutputMode::kStreaming);
+    if (finish_tracing && !streaming) {
       the_trace->FinishTracing();
     }
-    gc::ScopedGCCriticalSection gcs(self,
-                                    gc::kGcCauseInstrumentation,
-                                    gc::kCollectorTypeInstrumentation);
-    ScopedSuspendAll ssa(__FUNCTION__);
+    {
+      gc::ScopedGCCriticalSection gcs(self,
+                                      gc::kGcCauseInstrumentation,
+                                      gc::kCollectorTypeInstrumentation);
+      ScopedSuspendAll ssa(__FUNCTION__);
 
-    if (the_trace->trace_mode_ == TraceMode::kSampling) {
-      MutexLock mu(self, *Locks::thread_list_lock_);
-      runtime->GetThreadList()->ForEach(ClearThreadStackTraceAndClockBase, nullptr);
-    } else {
-      runtime->GetInstrumentation()->DisableMethodTracing(kTracerInstrumentationKey);
-      runtime->GetInstrumentation()->RemoveListener(
-          the_trace, instrumentation::Instrumentation::kMethodEntered |
-          instrumentation::Instrumentation::kMethodExited |
-          instrumentation::Instrumentation::kMethodUnwind);
+      if (the_trace->trace_mode_ == TraceMode::kSampling) {
+        MutexLock mu(self, *Locks::thread_list_lock_);
+        runtime->GetThreadList()->ForEach(ClearThreadStackTraceAndClockBase, nullptr);
+      } else {
+        runtime->GetInstrumentation()->DisableMethodTracing(kTracerInstrumentationKey);
+        runtime->GetInstrumentation()->RemoveListener(
+            the_trace, instrumentation::Instrumentation::kMethodEntered |
+            instrumentation::Instrumentation::kMethodExited |
+            instrumentation::Instrumentation::kMethodUnwind);
+      }
+      if (streaming) {
+        // No more events come in, hand the buffered ones to the writer.
+        MutexLock mu(self, *Locks::thread_list_lock_);
+        runtime->GetThreadList()->ForEach(FlushAndDeleteThreadBuffer, the_trace);
+      }
+    }
+    if (streaming) {
+      // The summary goes after all the events.
+      the_trace->StopStreamingWriter();
+      if (finish_tracing) {
+        the_trace->FinishTracing();
+      }
     }
     if (the_trace->trace_file_.get() != nullptr) {
       // Do not try to erase, so flush and close explicitly.
@@ -567,7 +598,9 @@ void Trace::Resume() {
                                                  instrumentation::Instrumentation::kMethodExited |
                                                  instrumentation::Instrumentation::kMethodUnwind);
       // TODO: In full-PIC mode, we don't need to fully deopt.
-      runtime->GetInstrumentation()->EnableMethodTracing(kTracerInstrumentationKey);
+      runtime->GetInstrumentation()->EnableMethodTracing(
+          kTracerInstrumentationKey,
+          runtime->GetInstrumentation()->MethodEntryExitNeedsInterpreter());
     }
   }
 
@@ -604,10 +637,11 @@ Trace::Trace(File* trace_file, const char* trace_name, size_t buffer_size, int f
       buffer_size_(std::max(kMinBufSize, buffer_size)),
       start_time_(MicroTime()), clock_overhead_ns_(GetClockOverheadNanoSeconds()), cur_offset_(0),
       overflow_(false), interval_us_(0), streaming_lock_(nullptr),
+      stop_streaming_writer_(false), streaming_writer_pthread_(0U),
       unique_methods_lock_(new Mutex("unique methods lock", kTracingUniqueMethodsLock)) {
   uint16_t trace_version = GetTraceVersion(clock_source_);
   if (output_mode == TraceOutputMode::kStreaming) {
-    trace_version |= 0xF0U;
+    trace_version = kTraceVersionStreaming | 0xF0U;
   }
   // Set up the beginning of the trace.
   memset(buf_.get(), 0, kTraceHeaderLength);
@@ -627,11 +661,13 @@ Trace::Trace(File* trace_file, const char* trace_name, size_t buffer_size, int f
   if (output_mode == TraceOutputMode::kStreaming) {
     streaming_file_name_ = trace_name;
     streaming_lock_ = new Mutex("tracing lock", LockLevel::kTracingStreamingLock);
+    streaming_cond_.reset(new ConditionVariable("tracing condition", *streaming_lock_));
     seen_threads_.reset(new ThreadIDBitSet());
   }
 }
 
 Trace::~Trace() {
+  streaming_cond_.reset();
   delete streaming_lock_;
   delete unique_methods_lock_;
 }
@@ -661,10 +697,7 @@ void Trace::FinishTracing() {
   size_t final_offset = 0;
 
   std::set<ArtMethod*> visited_methods;
-  if (trace_output_mode_ == TraceOutputMode::kStreaming) {
-    // Clean up.
-    STLDeleteValues(&seen_methods_);
-  } else {
+  if (trace_output_mode_ != TraceOutputMode::kStreaming) {
     final_offset = cur_offset_.LoadRelaxed();
     GetVisitedMethods(final_offset, &visited_methods);
   }
@@ -707,7 +740,8 @@ void Trace::FinishTracing() {
   std::string header(os.str());
 
   if (trace_output_mode_ == TraceOutputMode::kStreaming) {
-    MutexLock mu(Thread::Current(), *streaming_lock_);  // To serialize writing.
+    // The writer thread has exited, see StopTracing().
+    MutexLock mu(Thread::Current(), *streaming_lock_);
     // Write a special token to mark the end of trace records and the start of
     // trace summary.
     uint8_t buf[7];
@@ -858,20 +892,6 @@ void Trace::ReadClocks(Thread* thread, uint32_t* thread_clock_diff, uint32_t* wa
   }
 }
 
-bool Trace::RegisterMethod(ArtMethod* method) {
-  mirror::DexCache* dex_cache = method->GetDexCache();
-  const DexFile* dex_file = dex_cache->GetDexFile();
-  if (seen_methods_.find(dex_file) == seen_methods_.end()) {
-    seen_methods_.insert(std::make_pair(dex_file, new DexIndexBitSet()));
-  }
-  DexIndexBitSet* bit_set = seen_methods_.find(dex_file)->second;
-  if (!(*bit_set)[method->GetDexMethodIndex()]) {
-    bit_set->set(method->GetDexMethodIndex());
-    return true;
-  }
-  return false;
-}
-
 bool Trace::RegisterThread(Thread* thread) {
   pid_t tid = thread->GetTid();
   CHECK_LT(0U, static_cast<uint32_t>(tid));
@@ -935,7 +955,7 @@ void Trace::LogMethodTraceEvent(Thread* thread, ArtMethod* method,
   int32_t new_offset;
   int32_t old_offset = 0;
 
-  // We do a busy loop here trying to acquire the next offset.
+  // We do a busy loop here trying to acquire the next offset. Streaming mode buffers per thread.
   if (trace_output_mode_ != TraceOutputMode::kStreaming) {
     do {
       old_offset = cur_offset_.LoadRelaxed();
@@ -962,18 +982,15 @@ void Trace::LogMethodTraceEvent(Thread* thread, ArtMethod* method,
       UNIMPLEMENTED(FATAL) << "Unexpected event: " << event;
   }
 
-  uint32_t method_value = EncodeTraceMethodAndAction(method, action);
-
-  // Write data
-  uint8_t* ptr;
-  static constexpr size_t kPacketSize = 14U;  // The maximum size of data in a packet.
-  uint8_t stack_buf[kPacketSize];             // Space to store a packet when in streaming mode.
   if (trace_output_mode_ == TraceOutputMode::kStreaming) {
-    ptr = stack_buf;
-  } else {
-    ptr = buf_.get() + old_offset;
+    LogStreamingEvent(thread, method, action, thread_clock_diff, wall_clock_diff);
+    return;
   }
 
+  uint32_t method_value = EncodeTraceMethodAndAction(method, action);
+
+  // Write data
+  uint8_t* ptr = buf_.get() + old_offset;
   Append2LE(ptr, thread->GetTid());
   Append4LE(ptr + 2, method_value);
   ptr += 6;
@@ -985,34 +1002,160 @@ void Trace::LogMethodTraceEvent(Thread* thread, ArtMethod* method,
   if (UseWallClock()) {
     Append4LE(ptr, wall_clock_diff);
   }
-  static_assert(kPacketSize == 2 + 4 + 4 + 4, "Packet size incorrect.");
+}
 
-  if (trace_output_mode_ == TraceOutputMode::kStreaming) {
-    MutexLock mu(Thread::Current(), *streaming_lock_);  // To serialize writing.
-    if (RegisterMethod(method)) {
-      // Write a special block with the name.
+void Trace::LogStreamingEvent(Thread* thread,
+                              ArtMethod* method,
+                              TraceAction action,
+                              uint32_t thread_clock_diff,
+                              uint32_t wall_clock_diff) {
+  TraceThreadBuffer* buffer = thread->GetTraceThreadBuffer();
+  if (UNLIKELY(buffer == nullptr)) {
+    buffer = new TraceThreadBuffer();
+    buffer->events_.reserve(TraceThreadBuffer::kCapacity);
+    thread->SetTraceThreadBuffer(buffer);
+  } else if (UNLIKELY(buffer->events_.size() + kMaxStreamingEventSize >
+                      TraceThreadBuffer::kCapacity)) {
+    FlushThreadBuffer(thread, buffer);
+  }
+
+  uint32_t method_id;
+  auto it = buffer->method_ids_.find(method);
+  if (it != buffer->method_ids_.end()) {
+    method_id = it->second;
+  } else {
+    bool is_new = false;
+    method_id = EncodeTraceMethod(method, &is_new);
+    buffer->method_ids_.emplace(method, method_id);
+    if (is_new) {
+      // Write a special block with the name, before the events of the block that use it.
       std::string method_line(GetMethodLine(method));
-      uint8_t buf2[5];
-      Append2LE(buf2, 0);
-      buf2[2] = kOpNewMethod;
-      Append2LE(buf2 + 3, static_cast<uint16_t>(method_line.length()));
-      WriteToBuf(buf2, sizeof(buf2));
-      WriteToBuf(reinterpret_cast<const uint8_t*>(method_line.c_str()), method_line.length());
+      uint8_t buf[5];
+      Append2LE(buf, 0);
+      buf[2] = kOpNewMethod;
+      Append2LE(buf + 3, static_cast<uint16_t>(method_line.length()));
+      buffer->new_methods_.insert(buffer->new_methods_.end(), buf, buf + sizeof(buf));
+      buffer->new_methods_.insert(buffer->new_methods_.end(),
+                                  method_line.begin(),
+                                  method_line.end());
+    }
+  }
+
+  EncodeUnsignedLeb128(&buffer->events_, (method_id << TraceActionBits) | action);
+  // The clocks only go forward, but the differences are taken modulo 2^32 like the clocks.
+  if (UseThreadCpuClock()) {
+    EncodeUnsignedLeb128(&buffer->events_, thread_clock_diff - buffer->last_thread_clock_);
+    buffer->last_thread_clock_ = thread_clock_diff;
+  }
+  if (UseWallClock()) {
+    EncodeUnsignedLeb128(&buffer->events_, wall_clock_diff - buffer->last_wall_clock_);
+    buffer->last_wall_clock_ = wall_clock_diff;
+  }
+}
+
+void Trace::FlushThreadBuffer(Thread* thread, TraceThreadBuffer* buffer) {
+  std::unique_ptr<std::vector<uint8_t>> block(new std::vector<uint8_t>());
+  block->swap(buffer->new_methods_);
+  if (!buffer->events_.empty()) {
+    uint8_t buf[9];
+    Append2LE(buf, 0);
+    buf[2] = kOpThreadEvents;
+    Append2LE(buf + 3, static_cast<uint16_t>(thread->GetTid()));
+    Append4LE(buf + 5, static_cast<uint32_t>(buffer->events_.size()));
+    block->insert(block->end(), buf, buf + sizeof(buf));
+    block->insert(block->end(), buffer->events_.begin(), buffer->events_.end());
+    buffer->events_.clear();
+  }
+  // The next block starts from zero again.
+  buffer->last_thread_clock_ = 0u;
+  buffer->last_wall_clock_ = 0u;
+
+  Thread* self = Thread::Current();
+  MutexLock mu(self, *streaming_lock_);
+  if (RegisterThread(thread)) {
+    // It might be better to postpone this. Threads might not have received names...
+    std::string thread_name;
+    thread->GetThreadName(thread_name);
+    uint8_t buf[7];
+    Append2LE(buf, 0);
+    buf[2] = kOpNewThread;
+    Append2LE(buf + 3, static_cast<uint16_t>(thread->GetTid()));
+    Append2LE(buf + 5, static_cast<uint16_t>(thread_name.length()));
+    std::unique_ptr<std::vector<uint8_t>> thread_block(new std::vector<uint8_t>(buf, buf + 7));
+    thread_block->insert(thread_block->end(), thread_name.begin(), thread_name.end());
+    streaming_blocks_.push_back(std::move(thread_block));
+  }
+  if (block->empty()) {
+    return;
+  }
+  // Rather than buffering without bounds, wait for the writer to catch up. The caller may be
+  // runnable, but the writer never needs the mutator lock.
+  while (streaming_blocks_.size() >= kMaxPendingStreamingBlocks && !stop_streaming_writer_) {
+    streaming_cond_->WaitHoldingLocks(self);
+  }
+  streaming_blocks_.push_back(std::move(block));
+  streaming_cond_->Broadcast(self);
+}
+
+void Trace::FlushAndDeleteThreadBuffer(Thread* thread, void* arg) {
+  TraceThreadBuffer* buffer = thread->GetTraceThreadBuffer();
+  if (buffer != nullptr) {
+    reinterpret_cast<Trace*>(arg)->FlushThreadBuffer(thread, buffer);
+    thread->SetTraceThreadBuffer(nullptr);
+    delete buffer;
+  }
+}
+
+void Trace::StartStreamingWriter() {
+  // The header is the only data written from buf_ before the summary.
+  if (!trace_file_->WriteFully(buf_.get(), kTraceHeaderLength)) {
+    PLOG(WARNING) << "Failed streaming the trace header.";
+  }
+  cur_offset_.StoreRelease(0);
+  CHECK_PTHREAD_CALL(pthread_create, (&streaming_writer_pthread_, nullptr, &RunStreamingWriter,
+                                      this),
+                                      "Trace writer thread");
+}
+
+void Trace::StopStreamingWriter() {
+  {
+    MutexLock mu(Thread::Current(), *streaming_lock_);
+    stop_streaming_writer_ = true;
+    streaming_cond_->Broadcast(Thread::Current());
+  }
+  CHECK_PTHREAD_CALL(pthread_join, (streaming_writer_pthread_, nullptr), "trace writer shutdown");
+  streaming_writer_pthread_ = 0U;
+}
+
+void* Trace::RunStreamingWriter(void* arg) {
+  Runtime* runtime = Runtime::Current();
+  Trace* trace = reinterpret_cast<Trace*>(arg);
+  CHECK(runtime->AttachCurrentThread("Trace Writer", true, runtime->GetSystemThreadGroup(),
+                                     !runtime->IsAotCompiler()));
+  Thread* self = Thread::Current();
+  while (true) {
+    std::unique_ptr<std::vector<uint8_t>> block;
+    {
+      MutexLock mu(self, *trace->streaming_lock_);
+      while (trace->streaming_blocks_.empty() && !trace->stop_streaming_writer_) {
+        trace->streaming_cond_->Wait(self);
+      }
+      if (trace->streaming_blocks_.empty()) {
+        break;  // Stopped, and all blocks are written.
+      }
+      block = std::move(trace->streaming_blocks_.front());
+      trace->streaming_blocks_.pop_front();
+      // Wake up threads waiting for space.
+      trace->streaming_cond_->Broadcast(self);
     }
-    if (RegisterThread(thread)) {
-      // It might be better to postpone this. Threads might not have received names...
-      std::string thread_name;
-      thread->GetThreadName(thread_name);
-      uint8_t buf2[7];
-      Append2LE(buf2, 0);
-      buf2[2] = kOpNewThread;
-      Append2LE(buf2 + 3, static_cast<uint16_t>(thread->GetTid()));
-      Append2LE(buf2 + 5, static_cast<uint16_t>(thread_name.length()));
-      WriteToBuf(buf2, sizeof(buf2));
-      WriteToBuf(reinterpret_cast<const uint8_t*>(thread_name.c_str()), thread_name.length());
+    ScopedTrace trace_write("Trace write");
+    if (!trace->trace_file_->WriteFully(block->data(), block->size())) {
+      PLOG(WARNING) << "Failed streaming tracing events.";
     }
-    WriteToBuf(stack_buf, sizeof(stack_buf));
   }
+
+  runtime->DetachCurrentThread();
+  return nullptr;
 }
 
 void Trace::GetVisitedMethods(size_t buf_size,
@@ -1059,6 +1202,11 @@ void Trace::StoreExitingThreadInfo(Thread* thread) {
     // The same thread/tid may be used multiple times. As SafeMap::Put does not allow to override
     // a previous mapping, use SafeMap::Overwrite.
     the_trace_->exited_threads_.Overwrite(thread->GetTid(), name);
+    if (the_trace_->trace_output_mode_ == TraceOutputMode::kStreaming) {
+      // The sampling thread may use the buffer while holding the thread list lock.
+      MutexLock mu2(thread, *Locks::thread_list_lock_);
+      FlushAndDeleteThreadBuffer(thread, the_trace_);
+    }
   }
 }
 
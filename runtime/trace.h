@@ -18,6 +18,7 @@
 #define ART_RUNTIME_TRACE_H_
 
 #include <bitset>
+#include <deque>
 #include <map>
 #include <memory>
 #include <ostream>
@@ -41,8 +42,6 @@ class DexFile;
 class ShadowFrame;
 class Thread;
 
-using DexIndexBitSet = std::bitset<65536>;
-
 constexpr size_t kMaxThreadIdNumber = kIsTargetBuild ? 65536U : 1048576U;
 using ThreadIDBitSet = std::bitset<kMaxThreadIdNumber>;
 
@@ -85,6 +84,18 @@ enum TracingMode {
 // 32 bits of microseconds is 70 minutes.
 //
 // All values are stored in little-endian order.
+//
+// Streaming mode sets the high nibble of the version, and the record size is the one of the v3
+// records the stream converts to (see tools/stream-trace-converter.py). After the header come
+// blocks which start with a u2 0 and a u1 opcode:
+//     1: new method: u2 length, the method line
+//     2: new thread: u2 thread ID, u2 length, the thread name
+//     3: trace summary: u4 length, the summary
+//     4: events of one thread: u2 thread ID, u4 length, the events
+//
+// Each event is a sequence of unsigned LEB128 values: method ID | method action, then the
+// differences in each clock of the record format v3 to the previous event of the block, or to
+// zero for the first event.
 
 enum TraceAction {
     kTraceMethodEnter = 0x00,       // method entry
@@ -94,6 +105,31 @@ enum TraceAction {
     kTraceMethodActionMask = 0x03,  // two bits
 };
 
+// Streaming mode events of one thread which it has not handed to the writer yet. Only accessed by
+// the thread, or while it is suspended or holding the thread list lock to unregister.
+class TraceThreadBuffer {
+ public:
+  TraceThreadBuffer() {}
+
+ private:
+  // Hand the events to the writer when they reach this size.
+  static constexpr size_t kCapacity = 16 * KB;
+
+  // Events, encoded from the thread's previous block.
+  std::vector<uint8_t> events_;
+  // New method blocks for the methods this thread used first.
+  std::vector<uint8_t> new_methods_;
+  // The IDs of the methods this thread used, which saves taking the unique methods lock.
+  std::unordered_map<ArtMethod*, uint32_t> method_ids_;
+  // The clocks of the last event in events_.
+  uint32_t last_thread_clock_ = 0u;
+  uint32_t last_wall_clock_ = 0u;
+
+  friend class Trace;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceThreadBuffer);
+};
+
 class Trace FINAL : public instrumentation::InstrumentationListener {
  public:
   enum TraceFlag {
@@ -201,8 +237,8 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
   static std::vector<ArtMethod*>* AllocStackTrace();
   // Clear and store an old stack trace for later use.
   static void FreeStackTrace(std::vector<ArtMethod*>* stack_trace);
-  // Save id and name of a thread before it exits.
-  static void StoreExitingThreadInfo(Thread* thread);
+  // Save id and name of a thread before it exits, and hand its streaming events to the writer.
+  static void StoreExitingThreadInfo(Thread* thread) REQUIRES(!Locks::thread_list_lock_);
 
   static TraceOutputMode GetOutputMode() REQUIRES(!Locks::trace_lock_);
   static TraceMode GetMode() REQUIRES(!Locks::trace_lock_);
@@ -235,6 +271,27 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
                            uint32_t thread_clock_diff, uint32_t wall_clock_diff)
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_, !*streaming_lock_);
 
+  // Streaming mode: append the event to the buffer of `thread`, without locking unless the thread
+  // uses the method for the first time or the buffer is full.
+  void LogStreamingEvent(Thread* thread,
+                         ArtMethod* method,
+                         TraceAction action,
+                         uint32_t thread_clock_diff,
+                         uint32_t wall_clock_diff)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_, !*streaming_lock_);
+  // Hand the buffered events of `thread` to the writer thread.
+  void FlushThreadBuffer(Thread* thread, TraceThreadBuffer* buffer) REQUIRES(!*streaming_lock_);
+  // Flush and delete the buffer of `thread`, for ThreadList::ForEach().
+  static void FlushAndDeleteThreadBuffer(Thread* thread, void* arg)
+      REQUIRES(Locks::thread_list_lock_);
+
+  // The writer thread writes the blocks which other threads hand over to the file, so that they
+  // don't wait for I/O.
+  void StartStreamingWriter() REQUIRES(!*streaming_lock_);
+  // Write the remaining blocks and join the writer thread.
+  void StopStreamingWriter() REQUIRES(!*streaming_lock_);
+  static void* RunStreamingWriter(void* arg) REQUIRES(!Locks::trace_lock_);
+
   // Methods to output traced methods and threads.
   void GetVisitedMethods(size_t end_offset, std::set<ArtMethod*>* visited_methods)
       REQUIRES(!*unique_methods_lock_);
@@ -242,10 +299,7 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_);
   void DumpThreadList(std::ostream& os) REQUIRES(!Locks::thread_list_lock_);
 
-  // Methods to register seen entitites in streaming mode. The methods return true if the entity
-  // is newly discovered.
-  bool RegisterMethod(ArtMethod* method)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(streaming_lock_);
+  // Register a seen thread in streaming mode. Returns true if the thread is newly discovered.
   bool RegisterThread(Thread* thread)
       REQUIRES(streaming_lock_);
 
@@ -257,7 +311,9 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
   void FlushBuf()
       REQUIRES(streaming_lock_);
 
-  uint32_t EncodeTraceMethod(ArtMethod* method) REQUIRES(!*unique_methods_lock_);
+  // Sets `is_new`, if not null, to whether the method got its ID in this call.
+  uint32_t EncodeTraceMethod(ArtMethod* method, bool* is_new = nullptr)
+      REQUIRES(!*unique_methods_lock_);
   uint32_t EncodeTraceMethodAndAction(ArtMethod* method, TraceAction action)
       REQUIRES(!*unique_methods_lock_);
   ArtMethod* DecodeTraceMethod(uint32_t tmid) REQUIRES(!*unique_methods_lock_);
@@ -320,8 +376,13 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
   // Streaming mode data.
   std::string streaming_file_name_;
   Mutex* streaming_lock_;
-  std::map<const DexFile*, DexIndexBitSet*> seen_methods_;
   std::unique_ptr<ThreadIDBitSet> seen_threads_;
+  // Blocks waiting for the writer thread, and whether it should exit once they are written.
+  std::deque<std::unique_ptr<std::vector<uint8_t>>> streaming_blocks_ GUARDED_BY(streaming_lock_);
+  bool stop_streaming_writer_ GUARDED_BY(streaming_lock_);
+  // Signaled when blocks are added or written, and to stop the writer.
+  std::unique_ptr<ConditionVariable> streaming_cond_;
+  pthread_t streaming_writer_pthread_;
 
   // Bijective map from ArtMethod* to index.
   // Map from ArtMethod* to index in unique_methods_;
@@ -264,13 +264,22 @@ void Transaction::Rollback() {
   Thread* self = Thread::Current();
   self->AssertNoPendingException();
   MutexLock mu1(self, *Locks::intern_table_lock_);
-  MutexLock mu2(self, log_lock_);
   rolling_back_ = true;
   CHECK(!Runtime::Current()->IsActiveTransaction());
-  UndoObjectModifications();
-  UndoArrayModifications();
-  UndoInternStringTableModifications();
-  UndoResolveStringModifications();
+  std::list<InternStringLog> intern_string_logs;
+  {
+    MutexLock mu2(self, log_lock_);
+    UndoObjectModifications();
+    UndoArrayModifications();
+    intern_string_logs.swap(intern_string_logs_);
+  }
+  // Undo the changes of the intern table without the log lock, which is acquired after the locks
+  // of the intern table shards.
+  UndoInternStringTableModifications(intern_string_logs);
+  {
+    MutexLock mu2(self, log_lock_);
+    UndoResolveStringModifications();
+  }
   rolling_back_ = false;
 }
 
@@ -292,14 +301,14 @@ void Transaction::UndoArrayModifications() {
   array_logs_.clear();
 }
 
-void Transaction::UndoInternStringTableModifications() {
+void Transaction::UndoInternStringTableModifications(
+    const std::list<InternStringLog>& intern_string_logs) {
   InternTable* const intern_table = Runtime::Current()->GetInternTable();
   // We want to undo each operation from the most recent to the oldest. List has been filled so the
   // most recent operation is at list begin so just have to iterate over it.
-  for (const InternStringLog& string_log : intern_string_logs_) {
+  for (const InternStringLog& string_log : intern_string_logs) {
     string_log.Undo(intern_table);
   }
-  intern_string_logs_.clear();
 }
 
 void Transaction::UndoResolveStringModifications() {
@@ -277,9 +277,9 @@ class Transaction FINAL {
   void UndoArrayModifications()
       REQUIRES(log_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
-  void UndoInternStringTableModifications()
+  void UndoInternStringTableModifications(const std::list<InternStringLog>& intern_string_logs)
       REQUIRES(Locks::intern_table_lock_)
-      REQUIRES(log_lock_)
+      REQUIRES(!log_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
   void UndoResolveStringModifications()
       REQUIRES(log_lock_)
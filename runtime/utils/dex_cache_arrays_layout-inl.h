@@ -31,8 +31,10 @@ namespace art {
 
 inline DexCacheArraysLayout::DexCacheArraysLayout(PointerSize pointer_size,
                                                   const DexFile::Header& header,
-                                                  uint32_t num_call_sites)
+                                                  uint32_t num_call_sites,
+                                                  bool large_caches)
     : pointer_size_(pointer_size),
+      large_caches_(large_caches),
       /* types_offset_ is always 0u, so it's constexpr */
       methods_offset_(
           RoundUp(types_offset_ + TypesSize(header.type_ids_size_), MethodsAlignment())),
@@ -48,8 +50,13 @@ inline DexCacheArraysLayout::DexCacheArraysLayout(PointerSize pointer_size,
       size_(RoundUp(call_sites_offset_ + CallSitesSize(num_call_sites), Alignment())) {
 }
 
-inline DexCacheArraysLayout::DexCacheArraysLayout(PointerSize pointer_size, const DexFile* dex_file)
-    : DexCacheArraysLayout(pointer_size, dex_file->GetHeader(), dex_file->NumCallSiteIds()) {
+inline DexCacheArraysLayout::DexCacheArraysLayout(PointerSize pointer_size,
+                                                  const DexFile* dex_file,
+                                                  bool large_caches)
+    : DexCacheArraysLayout(pointer_size,
+                           dex_file->GetHeader(),
+                           dex_file->NumCallSiteIds(),
+                           large_caches) {
 }
 
 inline size_t DexCacheArraysLayout::Alignment() const {
@@ -76,15 +83,13 @@ constexpr PointerSize GcRootAsPointerSize() {
 }
 
 inline size_t DexCacheArraysLayout::TypeOffset(dex::TypeIndex type_idx) const {
+  DCHECK(!large_caches_);
   return types_offset_ + ElementOffset(PointerSize::k64,
                                        type_idx.index_ % mirror::DexCache::kDexCacheTypeCacheSize);
 }
 
 inline size_t DexCacheArraysLayout::TypesSize(size_t num_elements) const {
-  size_t cache_size = mirror::DexCache::kDexCacheTypeCacheSize;
-  if (num_elements < cache_size) {
-    cache_size = num_elements;
-  }
+  size_t cache_size = mirror::DexCache::TypeCacheSize(num_elements, large_caches_);
   return PairArraySize(GcRootAsPointerSize<mirror::Class>(), cache_size);
 }
 
@@ -128,15 +133,13 @@ inline size_t DexCacheArraysLayout::StringsAlignment() const {
 }
 
 inline size_t DexCacheArraysLayout::FieldOffset(uint32_t field_idx) const {
+  DCHECK(!large_caches_);
   uint32_t field_hash = field_idx % mirror::DexCache::kDexCacheFieldCacheSize;
   return fields_offset_ + 2u * static_cast<size_t>(pointer_size_) * field_hash;
 }
 
 inline size_t DexCacheArraysLayout::FieldsSize(size_t num_elements) const {
-  size_t cache_size = mirror::DexCache::kDexCacheFieldCacheSize;
-  if (num_elements < cache_size) {
-    cache_size = num_elements;
-  }
+  size_t cache_size = mirror::DexCache::FieldCacheSize(num_elements, large_caches_);
   return PairArraySize(pointer_size_, cache_size);
 }
 
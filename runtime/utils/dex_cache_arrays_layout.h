@@ -33,6 +33,7 @@ class DexCacheArraysLayout {
   DexCacheArraysLayout()
       : /* types_offset_ is always 0u */
         pointer_size_(kRuntimePointerSize),
+        large_caches_(false),
         methods_offset_(0u),
         strings_offset_(0u),
         fields_offset_(0u),
@@ -41,13 +42,17 @@ class DexCacheArraysLayout {
         size_(0u) {
   }
 
-  // Construct a layout for a particular dex file header.
+  // Construct a layout for a particular dex file header. With `large_caches`, the type and
+  // field arrays are sized as mirror::DexCache::InitializeDexCache() does for hot dex files.
   DexCacheArraysLayout(PointerSize pointer_size,
                        const DexFile::Header& header,
-                       uint32_t num_call_sites);
+                       uint32_t num_call_sites,
+                       bool large_caches = false);
 
   // Construct a layout for a particular dex file.
-  DexCacheArraysLayout(PointerSize pointer_size, const DexFile* dex_file);
+  DexCacheArraysLayout(PointerSize pointer_size,
+                       const DexFile* dex_file,
+                       bool large_caches = false);
 
   bool Valid() const {
     return Size() != 0u;
@@ -120,6 +125,7 @@ class DexCacheArraysLayout {
  private:
   static constexpr size_t types_offset_ = 0u;
   const PointerSize pointer_size_;  // Must be first for construction initialization order.
+  const bool large_caches_;  // Must precede the offsets for construction initialization order.
   const size_t methods_offset_;
   const size_t strings_offset_;
   const size_t fields_offset_;
@@ -62,7 +62,8 @@ class VdexFile {
    public:
     VerifierDepsHeader(uint32_t number_of_dex_files_,
                        uint32_t verifier_deps_size,
-                       bool has_dex_section);
+                       bool has_dex_section,
+                       uint32_t classpath_checksum = 0u);
 
     const char* GetMagic() const { return reinterpret_cast<const char*>(magic_); }
     const char* GetVerifierDepsVersion() const {
@@ -82,6 +83,10 @@ class VdexFile {
     uint32_t GetVerifierDepsSize() const { return verifier_deps_size_; }
     uint32_t GetNumberOfDexFiles() const { return number_of_dex_files_; }
 
+    // Checksum of the boot class path and class path the verifier deps were recorded against,
+    // or 0 if unknown. If it did not change, the verifier deps are known to still hold.
+    uint32_t GetClasspathChecksum() const { return classpath_checksum_; }
+
     size_t GetSizeOfChecksumsSection() const {
       return sizeof(VdexChecksum) * GetNumberOfDexFiles();
     }
@@ -92,8 +97,8 @@ class VdexFile {
     static constexpr uint8_t kVdexMagic[] = { 'v', 'd', 'e', 'x' };
 
     // The format version of the verifier deps header and the verifier deps.
-    // Last update: Add DexSectionHeader
-    static constexpr uint8_t kVerifierDepsVersion[] = { '0', '1', '9', '\0' };
+    // Last update: Add classpath checksum
+    static constexpr uint8_t kVerifierDepsVersion[] = { '0', '2', '0', '\0' };
 
     // The format version of the dex section header and the dex section, containing
     // both the dex code and the quickening data.
@@ -109,6 +114,7 @@ class VdexFile {
     uint8_t dex_section_version_[4];
     uint32_t number_of_dex_files_;
     uint32_t verifier_deps_size_;
+    uint32_t classpath_checksum_;
   };
 
   struct DexSectionHeader {
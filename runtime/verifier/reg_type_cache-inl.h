@@ -183,6 +183,7 @@ inline RegTypeType& RegTypeCache::AddEntry(RegTypeType* new_entry) {
     DCHECK(!klass->IsPrimitive());
     klass_entries_.push_back(std::make_pair(GcRoot<mirror::Class>(klass), new_entry));
   }
+  AddDescriptorEntry(new_entry);
   return *new_entry;
 }
 
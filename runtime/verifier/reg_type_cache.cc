@@ -169,6 +169,23 @@ mirror::Class* RegTypeCache::ResolveClass(const char* descriptor, mirror::ClassL
   return klass;
 }
 
+void RegTypeCache::AddDescriptorEntry(const RegType* entry) {
+  const uint16_t id = entry->GetId();
+  DCHECK_EQ(id + 1u, entries_.size());
+  DCHECK_NE(id, 0u);
+  next_descriptor_entries_.resize(entries_.size(), 0u);
+  if (entry->descriptor_.empty()) {
+    return;
+  }
+  auto it = descriptor_entries_.find(entry->descriptor_);
+  if (it == descriptor_entries_.end()) {
+    descriptor_entries_.emplace(entry->descriptor_, std::make_pair(id, id));
+  } else {
+    next_descriptor_entries_[it->second.second] = id;
+    it->second.second = id;
+  }
+}
+
 StringPiece RegTypeCache::AddString(const StringPiece& string_piece) {
   char* ptr = allocator_.AllocArray<char>(string_piece.length());
   memcpy(ptr, string_piece.data(), string_piece.length());
@@ -181,9 +198,12 @@ const RegType& RegTypeCache::From(mirror::ClassLoader* loader,
   StringPiece sp_descriptor(descriptor);
   // Try looking up the class in the cache first. We use a StringPiece to avoid continual strlen
   // operations on the descriptor.
-  for (size_t i = primitive_count_; i < entries_.size(); i++) {
-    if (MatchDescriptor(i, sp_descriptor, precise)) {
-      return *(entries_[i]);
+  auto it = descriptor_entries_.find(sp_descriptor);
+  if (it != descriptor_entries_.end()) {
+    for (uint16_t i = it->second.first; i != 0u; i = next_descriptor_entries_[i]) {
+      if (MatchDescriptor(i, sp_descriptor, precise)) {
+        return *(entries_[i]);
+      }
     }
   }
   // Class not found in the cache, will create a new type for that.
@@ -277,6 +297,8 @@ const RegType& RegTypeCache::FromClass(const char* descriptor, mirror::Class* kl
 RegTypeCache::RegTypeCache(bool can_load_classes, ScopedArenaAllocator& allocator, bool can_suspend)
     : entries_(allocator.Adapter(kArenaAllocVerifier)),
       klass_entries_(allocator.Adapter(kArenaAllocVerifier)),
+      descriptor_entries_(allocator.Adapter(kArenaAllocVerifier)),
+      next_descriptor_entries_(allocator.Adapter(kArenaAllocVerifier)),
       can_load_classes_(can_load_classes),
       allocator_(allocator) {
   DCHECK(can_suspend || !can_load_classes) << "Cannot load classes if suspension is disabled!";
@@ -289,6 +311,7 @@ RegTypeCache::RegTypeCache(bool can_load_classes, ScopedArenaAllocator& allocato
   // We want to have room for additional entries after inserting primitives and small
   // constants.
   entries_.reserve(kNumReserveEntries + kNumPrimitivesAndSmallConstants);
+  next_descriptor_entries_.reserve(kNumReserveEntries + kNumPrimitivesAndSmallConstants);
   FillPrimitiveAndSmallConstantTypes();
 }
 
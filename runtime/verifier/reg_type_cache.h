@@ -23,6 +23,7 @@
 #include "base/casts.h"
 #include "base/macros.h"
 #include "base/scoped_arena_containers.h"
+#include "base/stringpiece.h"
 #include "dex/primitive.h"
 #include "gc_root.h"
 
@@ -32,7 +33,6 @@ class Class;
 class ClassLoader;
 }  // namespace mirror
 class ScopedArenaAllocator;
-class StringPiece;
 
 namespace verifier {
 
@@ -173,6 +173,9 @@ class RegTypeCache {
   // verifier.
   StringPiece AddString(const StringPiece& string_piece);
 
+  // Record a new entry in descriptor_entries_, so From() can find it without a linear search.
+  void AddDescriptorEntry(const RegType* entry);
+
   static void CreatePrimitiveAndSmallConstantTypes() REQUIRES_SHARED(Locks::mutator_lock_);
 
   // A quick look up for popular small constants.
@@ -196,6 +199,26 @@ class RegTypeCache {
   // Fast lookup for quickly finding entries that have a matching class.
   ScopedArenaVector<std::pair<GcRoot<mirror::Class>, const RegType*>> klass_entries_;
 
+  // Hash of a descriptor, which is not null-terminated for the entries of the cache.
+  struct DescriptorHash {
+    size_t operator()(const StringPiece& descriptor) const {
+      size_t hash = 0;
+      for (char c : descriptor) {
+        hash = hash * 31 + static_cast<unsigned char>(c);
+      }
+      return hash;
+    }
+  };
+
+  // Fast lookup for the entries that have a given descriptor, used by From(). Maps a
+  // descriptor to the ids of the first and last entries with that descriptor, the entries in
+  // between are chained in id order through next_descriptor_entries_ so that the lookup finds
+  // the same entry as a search of entries_ would. Id 0 is the undefined type, which has no
+  // descriptor, and ends a chain.
+  ScopedArenaUnorderedMap<StringPiece, std::pair<uint16_t, uint16_t>, DescriptorHash>
+      descriptor_entries_;
+  ScopedArenaVector<uint16_t> next_descriptor_entries_;
+
   // Whether or not we're allowed to load classes.
   const bool can_load_classes_;
 
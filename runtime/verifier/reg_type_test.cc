@@ -17,6 +17,8 @@
 #include "reg_type.h"
 
 #include <set>
+#include <string>
+#include <vector>
 
 #include "base/bit_vector.h"
 #include "base/casts.h"
@@ -481,6 +483,35 @@ TEST_F(RegTypeReferenceTest, JavalangObject) {
   EXPECT_TRUE(ref_type_3.Equals(ref_type_2));
   EXPECT_EQ(ref_type.GetId(), ref_type_3.GetId());
 }
+
+TEST_F(RegTypeReferenceTest, FromDescriptorManyEntries) {
+  // Fill the cache with unrelated types and check that each descriptor still finds the first
+  // entry created for it, with the precision asked for.
+  ArenaStack stack(Runtime::Current()->GetArenaPool());
+  ScopedArenaAllocator allocator(&stack);
+  ScopedObjectAccess soa(Thread::Current());
+  RegTypeCache cache(true, allocator);
+  std::vector<std::string> descriptors;
+  std::vector<uint16_t> ids;
+  for (size_t i = 0; i != 100u; ++i) {
+    descriptors.push_back("Ljava/lang/DoesNotExist" + std::to_string(i) + ";");
+    const RegType& type = cache.FromDescriptor(nullptr, descriptors.back().c_str(), false);
+    EXPECT_TRUE(type.IsUnresolvedReference());
+    ids.push_back(type.GetId());
+  }
+  const RegType& imprecise_object = cache.JavaLangObject(false);
+  const RegType& precise_object = cache.JavaLangObject(true);
+  cache.Uninitialized(precise_object, 0u);
+  EXPECT_NE(imprecise_object.GetId(), precise_object.GetId());
+  for (size_t i = 0; i != descriptors.size(); ++i) {
+    EXPECT_EQ(ids[i], cache.FromDescriptor(nullptr, descriptors[i].c_str(), true).GetId());
+  }
+  EXPECT_EQ(imprecise_object.GetId(),
+            cache.FromDescriptor(nullptr, "Ljava/lang/Object;", false).GetId());
+  EXPECT_EQ(precise_object.GetId(),
+            cache.FromDescriptor(nullptr, "Ljava/lang/Object;", true).GetId());
+}
+
 TEST_F(RegTypeReferenceTest, Merging) {
   // Tests merging logic
   // String and object , LUB is object.
@@ -16,7 +16,9 @@
 
 #include "verifier_deps.h"
 
+#include <algorithm>
 #include <cstring>
+#include <numeric>
 
 #include "art_field-inl.h"
 #include "art_method-inl.h"
@@ -63,6 +65,57 @@ void VerifierDeps::MergeWith(const VerifierDeps& other,
   }
 }
 
+void VerifierDeps::SortExtraStrings() {
+  for (auto& entry : dex_deps_) {
+    const uint32_t num_ids_in_dex = entry.first->NumStringIds();
+    DexFileDeps* deps = entry.second.get();
+    std::vector<std::string>& strings = deps->strings_;
+    if (std::is_sorted(strings.begin(), strings.end())) {
+      continue;
+    }
+    std::vector<uint32_t> order(strings.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&strings](uint32_t lhs, uint32_t rhs) {
+      return strings[lhs] < strings[rhs];
+    });
+    // `order` maps new positions to old ones, `new_ids` the old ids to new ones.
+    std::vector<uint32_t> new_ids(strings.size());
+    std::vector<std::string> sorted_strings(strings.size());
+    for (uint32_t i = 0; i != order.size(); ++i) {
+      new_ids[order[i]] = num_ids_in_dex + i;
+      sorted_strings[i] = std::move(strings[order[i]]);
+    }
+    strings = std::move(sorted_strings);
+    auto remap = [num_ids_in_dex, &new_ids](dex::StringIndex id) {
+      return (id.index_ < num_ids_in_dex)
+          ? id
+          : dex::StringIndex(new_ids[id.index_ - num_ids_in_dex]);
+    };
+    auto remap_types = [&remap](std::set<TypeAssignability>* types) {
+      std::set<TypeAssignability> remapped;
+      for (const TypeAssignability& assignability : *types) {
+        remapped.emplace(remap(assignability.GetDestination()), remap(assignability.GetSource()));
+      }
+      types->swap(remapped);
+    };
+    remap_types(&deps->assignable_types_);
+    remap_types(&deps->unassignable_types_);
+    std::set<FieldResolution> fields;
+    for (const FieldResolution& field : deps->fields_) {
+      fields.emplace(
+          field.GetDexFieldIndex(), field.GetAccessFlags(), remap(field.GetDeclaringClassIndex()));
+    }
+    deps->fields_.swap(fields);
+    std::set<MethodResolution> methods;
+    for (const MethodResolution& method : deps->methods_) {
+      methods.emplace(method.GetDexMethodIndex(),
+                      method.GetAccessFlags(),
+                      remap(method.GetDeclaringClassIndex()));
+    }
+    deps->methods_.swap(methods);
+  }
+}
+
 VerifierDeps::DexFileDeps* VerifierDeps::GetDexFileDeps(const DexFile& dex_file) {
   auto it = dex_deps_.find(&dex_file);
   return (it == dex_deps_.end()) ? nullptr : it->second.get();
@@ -848,6 +901,9 @@ void VerifierDeps::Dump(VariableIndentationOutputStream* vios) const {
 
 bool VerifierDeps::ValidateDependencies(Handle<mirror::ClassLoader> class_loader,
                                         Thread* self) const {
+  if (known_valid_) {
+    return true;
+  }
   for (const auto& entry : dex_deps_) {
     if (!VerifyDexFile(class_loader, *entry.first, *entry.second, self)) {
       return false;
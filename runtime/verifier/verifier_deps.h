@@ -65,6 +65,11 @@ class VerifierDeps {
   // same set of dex files.
   void MergeWith(const VerifierDeps& other, const std::vector<const DexFile*>& dex_files);
 
+  // Sort the strings that are not in the dex files and renumber their uses, so that the
+  // encoding does not depend on the order in which concurrent verifier threads added them.
+  // Must not run while strings are being added.
+  void SortExtraStrings();
+
   // Record the verification status of the class at `type_idx`.
   static void MaybeRecordVerificationStatus(const DexFile& dex_file,
                                             dex::TypeIndex type_idx,
@@ -125,6 +130,12 @@ class VerifierDeps {
     return output_only_;
   }
 
+  // Record that the dependencies are known to hold, for instance because they were recorded
+  // against the same class paths. ValidateDependencies() then does not look them up again.
+  void SetKnownValid() {
+    known_valid_ = true;
+  }
+
  private:
   static constexpr uint16_t kUnresolvedMarker = static_cast<uint16_t>(-1);
 
@@ -330,6 +341,9 @@ class VerifierDeps {
   // Output only signifies if we are using the verifier deps to verify or just to generate them.
   const bool output_only_;
 
+  // Whether the dependencies are known to hold, see SetKnownValid().
+  bool known_valid_ = false;
+
   friend class VerifierDepsTest;
   ART_FRIEND_TEST(VerifierDepsTest, StringToId);
   ART_FRIEND_TEST(VerifierDepsTest, EncodeDecode);
@@ -292,6 +292,13 @@ void SignalChain::Handler(int signo, siginfo_t* siginfo, void* ucontext_raw) {
   // Try the special handlers first.
   // If one of them crashes, we'll reenter this handler and pass that crash onto the user handler.
   if (!GetHandlingSignal()) {
+    // Faults handled by the runtime (implicit null and suspend checks, stack overflows) are hot,
+    // so keep the system calls to a minimum: only change the signal mask when a special handler
+    // asks for a different one than the previous handler, which is then assumed to have restored
+    // any change it made. The mask is not restored after the special handlers either: when they
+    // all decline, the mask is set for the user's handler below, and when one handles the signal,
+    // returning from the signal handler restores the mask of the interrupted code.
+    const sigset_t* current_mask = nullptr;
     for (const auto& handler : chains[signo].special_handlers_) {
       if (handler.sc_sigaction == nullptr) {
         break;
@@ -301,8 +308,11 @@ void SignalChain::Handler(int signo, siginfo_t* siginfo, void* ucontext_raw) {
       // Avoid setting the thread local flag in this case, since we'll never
       // get a chance to restore it.
       bool handler_noreturn = (handler.sc_flags & SIGCHAIN_ALLOW_NORETURN);
-      sigset_t previous_mask;
-      linked_sigprocmask(SIG_SETMASK, &handler.sc_mask, &previous_mask);
+      if (current_mask == nullptr ||
+          memcmp(current_mask, &handler.sc_mask, sizeof(handler.sc_mask)) != 0) {
+        linked_sigprocmask(SIG_SETMASK, &handler.sc_mask, nullptr);
+        current_mask = &handler.sc_mask;
+      }
 
       ScopedHandlingSignal restorer;
       if (!handler_noreturn) {
@@ -312,8 +322,6 @@ void SignalChain::Handler(int signo, siginfo_t* siginfo, void* ucontext_raw) {
       if (handler.sc_sigaction(signo, siginfo, ucontext_raw)) {
         return;
       }
-
-      linked_sigprocmask(SIG_SETMASK, &previous_mask, nullptr);
     }
   }
 
@@ -83,6 +83,37 @@ static void TestSignalBlocking(std::function<void()> fn) {
   ASSERT_FALSE(sigismember64(&mask, SIGSEGV));
 }
 
+TEST_F(SigchainTest, special_handlers_chain) {
+  static int declined_count = 0;
+  static int handled_count = 0;
+  art::SigchainAction declining_action = {
+      .sc_sigaction = [](int, siginfo_t*, void*) { ++declined_count; return false; },
+      .sc_mask = {},
+      .sc_flags = 0,
+  };
+  art::SigchainAction handling_action = {
+      .sc_sigaction = [](int, siginfo_t*, void*) { ++handled_count; return true; },
+      .sc_mask = {},
+      .sc_flags = 0,
+  };
+  // Replace the fixture's handler, so that the declining handler runs first.
+  art::RemoveSpecialSignalHandlerFn(SIGSEGV, action.sc_sigaction);
+  art::AddSpecialSignalHandlerFn(SIGSEGV, &declining_action);
+  art::AddSpecialSignalHandlerFn(SIGSEGV, &handling_action);
+
+  // The second handler sees the signal after the first one declined it, and the mask of
+  // the interrupted code is restored when the signal handler returns.
+  TestSignalBlocking([]() {
+    ASSERT_EQ(0, raise(SIGSEGV));
+  });
+  ASSERT_EQ(1, declined_count);
+  ASSERT_EQ(1, handled_count);
+
+  art::RemoveSpecialSignalHandlerFn(SIGSEGV, declining_action.sc_sigaction);
+  art::RemoveSpecialSignalHandlerFn(SIGSEGV, handling_action.sc_sigaction);
+  art::AddSpecialSignalHandlerFn(SIGSEGV, &action);
+}
+
 TEST_F(SigchainTest, sigprocmask_setmask) {
   TestSignalBlocking([]() {
     sigset_t mask;
@@ -28,6 +28,27 @@ namespace arm64 {
 // in the beginning of following methods, with compile time constant `kCanSimulate`.
 // TODO: when Simulator is always available, remove the these checks.
 
+// Decoder visitor counting the instructions the simulator executes. It is registered after the
+// simulator, so it sees every instruction once, right after it has been simulated.
+class InstructionCounter : public DecoderVisitor {
+ public:
+  InstructionCounter() : count_(0u) {}
+
+#define DECLARE_VISIT(A) void Visit##A(const Instruction* instr ATTRIBUTE_UNUSED) OVERRIDE { \
+    ++count_;                                                                                 \
+  }
+  VISITOR_LIST(DECLARE_VISIT)
+#undef DECLARE_VISIT
+
+  uint64_t GetCount() const { return count_; }
+  void Reset() { count_ = 0u; }
+
+ private:
+  uint64_t count_;
+
+  DISALLOW_COPY_AND_ASSIGN(InstructionCounter);
+};
+
 CodeSimulatorArm64* CodeSimulatorArm64::CreateCodeSimulatorArm64() {
   if (kCanSimulate) {
     return new CodeSimulatorArm64();
@@ -37,20 +58,24 @@ CodeSimulatorArm64* CodeSimulatorArm64::CreateCodeSimulatorArm64() {
 }
 
 CodeSimulatorArm64::CodeSimulatorArm64()
-    : CodeSimulator(), decoder_(nullptr), simulator_(nullptr) {
+    : CodeSimulator(), decoder_(nullptr), simulator_(nullptr), instruction_counter_(nullptr) {
   DCHECK(kCanSimulate);
   decoder_ = new Decoder();
   simulator_ = new Simulator(decoder_);
+  instruction_counter_ = new InstructionCounter();
+  decoder_->AppendVisitor(instruction_counter_);
 }
 
 CodeSimulatorArm64::~CodeSimulatorArm64() {
   DCHECK(kCanSimulate);
   delete simulator_;
+  delete instruction_counter_;
   delete decoder_;
 }
 
 void CodeSimulatorArm64::RunFrom(intptr_t code_buffer) {
   DCHECK(kCanSimulate);
+  instruction_counter_->Reset();
   simulator_->RunFrom(reinterpret_cast<const Instruction*>(code_buffer));
 }
 
@@ -69,5 +94,10 @@ int64_t CodeSimulatorArm64::GetCReturnInt64() const {
   return simulator_->ReadXRegister(0);
 }
 
+uint64_t CodeSimulatorArm64::GetInstructionCount() const {
+  DCHECK(kCanSimulate);
+  return instruction_counter_->GetCount();
+}
+
 }  // namespace arm64
 }  // namespace art
@@ -31,6 +31,8 @@
 namespace art {
 namespace arm64 {
 
+class InstructionCounter;
+
 class CodeSimulatorArm64 : public CodeSimulator {
  public:
   static CodeSimulatorArm64* CreateCodeSimulatorArm64();
@@ -42,11 +44,14 @@ class CodeSimulatorArm64 : public CodeSimulator {
   int32_t GetCReturnInt32() const OVERRIDE;
   int64_t GetCReturnInt64() const OVERRIDE;
 
+  uint64_t GetInstructionCount() const OVERRIDE;
+
  private:
   CodeSimulatorArm64();
 
   vixl::aarch64::Decoder* decoder_;
   vixl::aarch64::Simulator* simulator_;
+  InstructionCounter* instruction_counter_;
 
   // TODO: Enable CodeSimulatorArm64 for more host ISAs once Simulator supports them.
   static constexpr bool kCanSimulate = (kRuntimeISA == InstructionSet::kX86_64);
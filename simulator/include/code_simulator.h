@@ -35,6 +35,10 @@ class CodeSimulator {
   virtual int32_t GetCReturnInt32() const = 0;
   virtual int64_t GetCReturnInt64() const = 0;
 
+  // Get the number of instructions executed by the last call to RunFrom(), as a rough
+  // indication of the cost of the simulated code on the target.
+  virtual uint64_t GetInstructionCount() const = 0;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(CodeSimulator);
 };
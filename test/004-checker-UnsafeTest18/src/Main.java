@@ -57,6 +57,12 @@ public class Main {
   /// CHECK-START: long Main.set64(java.lang.Object, long, long) intrinsics_recognition (after)
   /// CHECK-DAG: <<Result:j\d+>> InvokeVirtual intrinsic:UnsafeGetAndSetLong
   /// CHECK-DAG:                 Return [<<Result>>]
+  //
+  /// CHECK-START-ARM64: long Main.set64(java.lang.Object, long, long) disassembly (after)
+  /// CHECK:                     InvokeVirtual intrinsic:UnsafeGetAndSetLong
+  /// CHECK-NOT:                 blr
+  /// CHECK:                     ldaxr
+  /// CHECK:                     stlxr
   private static long set64(Object o, long offset, long newValue) {
     return unsafe.getAndSetLong(o, offset, newValue);
   }
@@ -75,6 +81,12 @@ public class Main {
   /// CHECK-START: int Main.add32(java.lang.Object, long, int) intrinsics_recognition (after)
   /// CHECK-DAG: <<Result:i\d+>> InvokeVirtual intrinsic:UnsafeGetAndAddInt
   /// CHECK-DAG:                 Return [<<Result>>]
+  //
+  /// CHECK-START-ARM64: int Main.add32(java.lang.Object, long, int) disassembly (after)
+  /// CHECK:                     InvokeVirtual intrinsic:UnsafeGetAndAddInt
+  /// CHECK-NOT:                 blr
+  /// CHECK:                     ldaxr
+  /// CHECK:                     stlxr
   private static int add32(Object o, long offset, int delta) {
     return unsafe.getAndAddInt(o, offset, delta);
   }
@@ -47,15 +47,18 @@ public class Main {
     return OtherDex.returnIntMethod();
   }
 
-  /// CHECK-START: int Main.dontInlineOtherDexStatic() inliner (before)
+  /// CHECK-START: int Main.inlineOtherDexStatic() inliner (before)
   /// CHECK-DAG:     <<Invoke:i\d+>>  InvokeStaticOrDirect
   /// CHECK-DAG:                      Return [<<Invoke>>]
 
-  /// CHECK-START: int Main.dontInlineOtherDexStatic() inliner (after)
-  /// CHECK-DAG:     <<Invoke:i\d+>>  InvokeStaticOrDirect
-  /// CHECK-DAG:                      Return [<<Invoke>>]
+  /// CHECK-START: int Main.inlineOtherDexStatic() inliner (after)
+  /// CHECK-NOT:                      InvokeStaticOrDirect
+
+  /// CHECK-START: int Main.inlineOtherDexStatic() inliner (after)
+  /// CHECK-DAG:     <<Static:i\d+>>  StaticFieldGet
+  /// CHECK-DAG:                      Return [<<Static>>]
 
-  public static int dontInlineOtherDexStatic() {
+  public static int inlineOtherDexStatic() {
     return OtherDex.returnOtherDexStatic();
   }
 
@@ -86,27 +89,33 @@ public class Main {
     return OtherDex.recursiveCall();
   }
 
-  /// CHECK-START: java.lang.String Main.dontInlineReturnString() inliner (before)
+  /// CHECK-START: java.lang.String Main.inlineReturnString() inliner (before)
   /// CHECK-DAG:     <<Invoke:l\d+>>  InvokeStaticOrDirect
   /// CHECK-DAG:                      Return [<<Invoke>>]
 
-  /// CHECK-START: java.lang.String Main.dontInlineReturnString() inliner (after)
-  /// CHECK-DAG:     <<Invoke:l\d+>>  InvokeStaticOrDirect
-  /// CHECK-DAG:                      Return [<<Invoke>>]
+  /// CHECK-START: java.lang.String Main.inlineReturnString() inliner (after)
+  /// CHECK-NOT:                      InvokeStaticOrDirect
 
-  public static String dontInlineReturnString() {
+  /// CHECK-START: java.lang.String Main.inlineReturnString() inliner (after)
+  /// CHECK-DAG:     <<String:l\d+>>  LoadString
+  /// CHECK-DAG:                      Return [<<String>>]
+
+  public static String inlineReturnString() {
     return OtherDex.returnString();
   }
 
-  /// CHECK-START: java.lang.Class Main.dontInlineOtherDexClass() inliner (before)
+  /// CHECK-START: java.lang.Class Main.inlineOtherDexClass() inliner (before)
   /// CHECK-DAG:     <<Invoke:l\d+>>  InvokeStaticOrDirect
   /// CHECK-DAG:                      Return [<<Invoke>>]
 
-  /// CHECK-START: java.lang.Class Main.dontInlineOtherDexClass() inliner (after)
-  /// CHECK-DAG:     <<Invoke:l\d+>>  InvokeStaticOrDirect
-  /// CHECK-DAG:                      Return [<<Invoke>>]
+  /// CHECK-START: java.lang.Class Main.inlineOtherDexClass() inliner (after)
+  /// CHECK-NOT:                      InvokeStaticOrDirect
+
+  /// CHECK-START: java.lang.Class Main.inlineOtherDexClass() inliner (after)
+  /// CHECK-DAG:                     Return [<<Class:l\d+>>]
+  /// CHECK-DAG:     <<Class>>       LoadClass
 
-  public static Class<?> dontInlineOtherDexClass() {
+  public static Class<?> inlineOtherDexClass() {
     return OtherDex.returnOtherDexClass();
   }
 
@@ -127,15 +136,18 @@ public class Main {
     return OtherDex.returnMainClass();
   }
 
-  /// CHECK-START: java.lang.Class Main.dontInlineOtherDexClassStaticCall() inliner (before)
+  /// CHECK-START: java.lang.Class Main.inlineOtherDexClassStaticCall() inliner (before)
   /// CHECK-DAG:     <<Invoke:l\d+>>  InvokeStaticOrDirect
   /// CHECK-DAG:                      Return [<<Invoke>>]
 
-  /// CHECK-START: java.lang.Class Main.dontInlineOtherDexClassStaticCall() inliner (after)
-  /// CHECK-DAG:     <<Invoke:l\d+>>  InvokeStaticOrDirect
-  /// CHECK-DAG:                      Return [<<Invoke>>]
+  /// CHECK-START: java.lang.Class Main.inlineOtherDexClassStaticCall() inliner (after)
+  /// CHECK-NOT:                      InvokeStaticOrDirect
+
+  /// CHECK-START: java.lang.Class Main.inlineOtherDexClassStaticCall() inliner (after)
+  /// CHECK-DAG:                     Return [<<Class:l\d+>>]
+  /// CHECK-DAG:     <<Class>>       LoadClass
 
-  public static Class<?> dontInlineOtherDexClassStaticCall() {
+  public static Class<?> inlineOtherDexClassStaticCall() {
     return OtherDex.returnOtherDexClassStaticCall();
   }
 
@@ -166,7 +178,7 @@ public class Main {
       throw new Error("Expected 38");
     }
 
-    if (dontInlineOtherDexStatic() != 1) {
+    if (inlineOtherDexStatic() != 1) {
       throw new Error("Expected 1");
     }
 
@@ -174,15 +186,15 @@ public class Main {
       throw new Error("Expected 42");
     }
 
-    if (dontInlineReturnString() != "OtherDex") {
+    if (inlineReturnString() != "OtherDex") {
       throw new Error("Expected OtherDex");
     }
 
-    if (dontInlineOtherDexClass() != OtherDex.class) {
+    if (inlineOtherDexClass() != OtherDex.class) {
       throw new Error("Expected " + OtherDex.class);
     }
 
-    if (dontInlineOtherDexClassStaticCall() != OtherDex.class) {
+    if (inlineOtherDexClassStaticCall() != OtherDex.class) {
       throw new Error("Expected " + OtherDex.class);
     }
 
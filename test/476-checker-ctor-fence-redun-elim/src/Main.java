@@ -377,6 +377,36 @@ class TestNonEscaping {
   }
 }
 
+class TestNonEscapingAllocation implements Test {
+  static int counter;
+
+  /// CHECK-START: void TestNonEscapingAllocation.exercise() constructor_fence_redundancy_elimination (before)
+  /// CHECK: <<NewInstance:l\d+>>     NewInstance
+  /// CHECK:                          ConstructorFence [<<NewInstance>>]
+  /// CHECK:                          MonitorOperation [<<NewInstance>>]
+
+  /// CHECK-START: void TestNonEscapingAllocation.exercise() constructor_fence_redundancy_elimination (after)
+  /// CHECK: <<NewInstance:l\d+>>     NewInstance
+  /// CHECK:                          MonitorOperation [<<NewInstance>>]
+
+  /// CHECK-START: void TestNonEscapingAllocation.exercise() constructor_fence_redundancy_elimination (after)
+  /// CHECK-NOT:                      ConstructorFence
+  @Override
+  public void exercise() {
+    // The lock never escapes this thread, so its fence can be removed even though
+    // the allocation itself is kept alive by the monitor operations.
+    Object lock = new Object();
+    synchronized (lock) {
+      counter++;
+    }
+  }
+
+  @Override
+  public void check() {
+    Assert.stringEquals("1", counter);
+  }
+}
+
 class TestDontOptimizeAcrossBlocks implements Test {
   // Prevent constant folding.
   static boolean test;
@@ -791,6 +821,7 @@ public class Main {
       TestThreeFinalTwice.class,
       TestNonEscaping.Invoke.class,
       TestNonEscaping.Store.class,
+      TestNonEscapingAllocation.class,
       TestDontOptimizeAcrossBlocks.class,
       TestDontOptimizeAcrossEscape.Invoke.class,
       TestDontOptimizeAcrossEscape.StoreIput.class,
@@ -294,11 +294,12 @@ public class Main {
     return obj2.i;
   }
 
+  // GVN may already have removed the second load of obj.i, as the static
+  // field cannot alias it.
   /// CHECK-START: int Main.test10(TestClass) load_store_elimination (before)
   /// CHECK: StaticFieldGet
   /// CHECK: InstanceFieldGet
   /// CHECK: StaticFieldSet
-  /// CHECK: InstanceFieldGet
 
   /// CHECK-START: int Main.test10(TestClass) load_store_elimination (after)
   /// CHECK: StaticFieldGet
@@ -568,27 +569,81 @@ public class Main {
   /// CHECK: InstanceFieldSet
 
   /// CHECK-START: int Main.test23(boolean) load_store_elimination (after)
-  /// CHECK: NewInstance
+  /// CHECK-DAG:     <<Add1:i\d+>>    Add
+  /// CHECK-DAG:     <<Add2:i\d+>>    Add
+  /// CHECK-DAG:     <<Phi:i\d+>>     Phi [<<Arg1:i\d+>>,<<Arg2:i\d+>>]
+  /// CHECK-DAG:                       Return [<<Phi>>]
+  /// CHECK-EVAL:    set(["<<Arg1>>","<<Arg2>>"]) == set(["<<Add1>>","<<Add2>>"])
+
+  /// CHECK-START: int Main.test23(boolean) load_store_elimination (after)
+  /// CHECK-NOT: NewInstance
   /// CHECK-NOT: InstanceFieldSet
   /// CHECK-NOT: InstanceFieldGet
-  /// CHECK: InstanceFieldSet
-  /// CHECK: InstanceFieldGet
-  /// CHECK: Return
-  /// CHECK-NOT: InstanceFieldGet
-  /// CHECK: InstanceFieldSet
 
   // Test store elimination on merging.
   static int test23(boolean b) {
     TestClass obj = new TestClass();
     obj.i = 3;      // This store can be eliminated since the value flows into each branch.
     if (b) {
-      obj.i += 1;   // This store cannot be eliminated due to the merge later.
+      obj.i += 1;   // The stored values are merged with a phi,
     } else {
-      obj.i += 2;   // This store cannot be eliminated due to the merge later.
+      obj.i += 2;   // and the stores are eliminated.
+    }
+    return obj.i;
+  }
+
+  /// CHECK-START: int Main.testMergeWithDefaultValue(boolean) load_store_elimination (before)
+  /// CHECK: NewInstance
+  /// CHECK: InstanceFieldSet
+  /// CHECK: InstanceFieldGet
+
+  /// CHECK-START: int Main.testMergeWithDefaultValue(boolean) load_store_elimination (after)
+  /// CHECK-DAG:     <<Const0:i\d+>>  IntConstant 0
+  /// CHECK-DAG:     <<Const5:i\d+>>  IntConstant 5
+  /// CHECK-DAG:     <<Phi:i\d+>>     Phi [<<Arg1:i\d+>>,<<Arg2:i\d+>>]
+  /// CHECK-DAG:                       Return [<<Phi>>]
+  /// CHECK-EVAL:    set(["<<Arg1>>","<<Arg2>>"]) == set(["<<Const0>>","<<Const5>>"])
+
+  /// CHECK-START: int Main.testMergeWithDefaultValue(boolean) load_store_elimination (after)
+  /// CHECK-NOT: NewInstance
+  /// CHECK-NOT: InstanceFieldSet
+  /// CHECK-NOT: InstanceFieldGet
+
+  // Test merging a stored value with the default value of the field.
+  static int testMergeWithDefaultValue(boolean b) {
+    TestClass obj = new TestClass();
+    if (b) {
+      obj.i = 5;
     }
     return obj.i;
   }
 
+  /// CHECK-START: int Main.testMergeInLoop(int[]) load_store_elimination (before)
+  /// CHECK: NewInstance
+  /// CHECK: InstanceFieldSet
+  /// CHECK: InstanceFieldSet
+  /// CHECK: InstanceFieldGet
+
+  /// CHECK-START: int Main.testMergeInLoop(int[]) load_store_elimination (after)
+  /// CHECK-NOT: NewInstance
+  /// CHECK-NOT: InstanceFieldSet
+  /// CHECK-NOT: InstanceFieldGet
+
+  // Test merging the fields of a temporary object allocated in a loop.
+  static int testMergeInLoop(int[] array) {
+    int sum = 0;
+    for (int i = 0; i < array.length; i++) {
+      TestClass obj = new TestClass();
+      if (array[i] > 0) {
+        obj.i = array[i];
+      } else {
+        obj.i = -array[i];
+      }
+      sum += obj.i;
+    }
+    return sum;
+  }
+
   /// CHECK-START: float Main.test24() load_store_elimination (before)
   /// CHECK-DAG:     <<True:i\d+>>     IntConstant 1
   /// CHECK-DAG:     <<Float8:f\d+>>   FloatConstant 8
@@ -1194,6 +1249,9 @@ public class Main {
     assertIntEquals(test22(), 13);
     assertIntEquals(test23(true), 4);
     assertIntEquals(test23(false), 5);
+    assertIntEquals(testMergeWithDefaultValue(true), 5);
+    assertIntEquals(testMergeWithDefaultValue(false), 0);
+    assertIntEquals(testMergeInLoop(new int[] { 1, -2, 3 }), 6);
     assertFloatEquals(test24(), 8.0f);
     testFinalizableByForcingGc();
     assertIntEquals($noinline$testHSelect(true), 0xdead);
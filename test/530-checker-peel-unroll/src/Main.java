@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Test loop optimizations, in particular scalar loop peeling and unrolling.
+//
+public class Main {
+
+  static final int LENGTH = 4 * 1024;
+
+  private static final void initIntArray(int[] a) {
+    for (int i = 0; i < a.length; i++) {
+      a[i] = i % 4;
+    }
+  }
+
+  /// CHECK-START: void Main.unrollingLoadStoreElimination(int[]) loop_optimization (before)
+  /// CHECK-DAG:                 ArrayGet         loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG:                 ArrayGet         loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 ArraySet         loop:<<Loop>>      outer_loop:none
+  //
+  /// CHECK-START: void Main.unrollingLoadStoreElimination(int[]) loop_optimization (before)
+  /// CHECK:                     ArraySet
+  /// CHECK-NOT:                 ArraySet
+  //
+  /// CHECK-START: void Main.unrollingLoadStoreElimination(int[]) loop_optimization (after)
+  /// CHECK-DAG: <<Const0:i\d+>> IntConstant 0    loop:none
+  /// CHECK-DAG:                 If [<<Const0>>]  loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG:                 ArrayGet         loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 ArrayGet         loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 ArraySet         loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 ArrayGet         loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 ArrayGet         loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 ArraySet         loop:<<Loop>>      outer_loop:none
+  private static final void unrollingLoadStoreElimination(int[] a) {
+    for (int i = 0; i < LENGTH - 2; i++) {
+      a[i] += a[i + 1];
+    }
+  }
+
+  /// CHECK-START: void Main.unrollingOddTripCount(int[]) loop_optimization (after)
+  /// CHECK:                     ArraySet
+  /// CHECK-NOT:                 ArraySet
+  private static final void unrollingOddTripCount(int[] a) {
+    for (int i = 0; i < LENGTH - 3; i++) {
+      a[i] += a[i + 1];
+    }
+  }
+
+  /// CHECK-START: void Main.peelingSimple(int[], boolean) loop_optimization (before)
+  /// CHECK-DAG: <<Param:z\d+>>  ParameterValue   loop:none
+  /// CHECK-DAG:                 If [<<Param>>]   loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG:                 ArraySet         loop:<<Loop>>      outer_loop:none
+  //
+  /// CHECK-START: void Main.peelingSimple(int[], boolean) loop_optimization (after)
+  /// CHECK-DAG: <<Param:z\d+>>  ParameterValue   loop:none
+  /// CHECK-DAG: <<Const0:i\d+>> IntConstant 0    loop:none
+  /// CHECK-DAG:                 If [<<Param>>]   loop:none
+  /// CHECK-DAG:                 ArraySet         loop:none
+  /// CHECK-DAG:                 If [<<Const0>>]  loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG:                 ArraySet         loop:<<Loop>>      outer_loop:none
+  //
+  /// CHECK-START: void Main.peelingSimple(int[], boolean) dead_code_elimination$final (after)
+  /// CHECK-DAG: <<Param:z\d+>>  ParameterValue   loop:none
+  /// CHECK-DAG:                 If [<<Param>>]   loop:none
+  /// CHECK-DAG:                 ArraySet         loop:<<Loop:B\d+>> outer_loop:none
+  private static final void peelingSimple(int[] a, boolean f) {
+    for (int i = 0; i < a.length; i++) {
+      if (f) {
+        break;
+      }
+      a[i] += 1;
+    }
+  }
+
+  /// CHECK-START: int Main.peelingLiveOutNotSupported(int[], boolean) loop_optimization (after)
+  /// CHECK-DAG: <<Param:z\d+>>  ParameterValue   loop:none
+  /// CHECK-DAG:                 If [<<Param>>]   loop:<<Loop:B\d+>> outer_loop:none
+  //
+  /// CHECK-START: int Main.peelingLiveOutNotSupported(int[], boolean) loop_optimization (after)
+  /// CHECK:                     If [<<Param>>]
+  /// CHECK-NOT:                 If [<<Param>>]
+  private static final int peelingLiveOutNotSupported(int[] a, boolean f) {
+    int sum = 0;
+    for (int i = 0; i < a.length; i++) {
+      if (f) {
+        break;
+      }
+      sum += a[i];
+    }
+    return sum;
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  public static void main(String[] args) {
+    int[] a = new int[LENGTH];
+    int[] b = new int[LENGTH];
+    initIntArray(a);
+    initIntArray(b);
+
+    unrollingLoadStoreElimination(a);
+    unrollingOddTripCount(b);
+    for (int i = 0; i < LENGTH - 2; i++) {
+      expectEquals((i % 4) + ((i + 1) % 4), a[i]);
+    }
+    for (int i = 0; i < LENGTH - 3; i++) {
+      expectEquals((i % 4) + ((i + 1) % 4), b[i]);
+    }
+    expectEquals((LENGTH - 3) % 4, b[LENGTH - 3]);
+
+    initIntArray(a);
+    peelingSimple(a, true);
+    expectEquals(1, a[1]);
+    peelingSimple(a, false);
+    for (int i = 0; i < LENGTH; i++) {
+      expectEquals((i % 4) + 1, a[i]);
+    }
+
+    initIntArray(a);
+    expectEquals(0, peelingLiveOutNotSupported(a, true));
+    expectEquals(6 * LENGTH / 4, peelingLiveOutNotSupported(a, false));
+
+    System.out.println("passed");
+  }
+}
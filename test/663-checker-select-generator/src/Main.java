@@ -45,7 +45,81 @@ public class Main {
     }
   }
 
+  public static void assertIntEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  /// CHECK-START: int Main.$noinline$cheapBranches(boolean, int, int) select_generator (before)
+  /// CHECK-DAG:                    If
+  /// CHECK-DAG:                    Shl
+  /// CHECK-DAG:                    Add
+  /// CHECK-DAG:                    Sub
+
+  /// CHECK-START: int Main.$noinline$cheapBranches(boolean, int, int) select_generator (after)
+  /// CHECK-DAG:     <<Shl:i\d+>>   Shl
+  /// CHECK-DAG:     <<Add:i\d+>>   Add [<<Shl>>,{{i\d+}}]
+  /// CHECK-DAG:     <<Sub:i\d+>>   Sub
+  /// CHECK-DAG:     <<Sel:i\d+>>   Select [<<Sub>>,<<Add>>,{{z\d+}}]
+  /// CHECK-DAG:                    Return [<<Sel>>]
+
+  /// CHECK-START: int Main.$noinline$cheapBranches(boolean, int, int) select_generator (after)
+  /// CHECK-NOT:                    If
+  public static int $noinline$cheapBranches(boolean c, int a, int b) {
+    return c ? (a << 1) + 1 : a - b;
+  }
+
+  /// CHECK-START: int Main.$noinline$twoPhis(boolean, int, int) select_generator (before)
+  /// CHECK-DAG:                    If
+  /// CHECK-DAG:                    Phi
+  /// CHECK-DAG:                    Phi
+
+  /// CHECK-START: int Main.$noinline$twoPhis(boolean, int, int) select_generator (after)
+  /// CHECK-DAG:     <<Cond:z\d+>>  ParameterValue
+  /// CHECK-DAG:     <<X:i\d+>>     Select [{{i\d+}},{{i\d+}},<<Cond>>]
+  /// CHECK-DAG:     <<Y:i\d+>>     Select [{{i\d+}},{{i\d+}},<<Cond>>]
+  /// CHECK-DAG:                    Sub
+
+  /// CHECK-START: int Main.$noinline$twoPhis(boolean, int, int) select_generator (after)
+  /// CHECK-NOT:                    If
+  /// CHECK-NOT:                    Phi
+  public static int $noinline$twoPhis(boolean c, int a, int b) {
+    int x;
+    int y;
+    if (c) {
+      x = a;
+      y = b;
+    } else {
+      x = b;
+      y = a;
+    }
+    return x - y;
+  }
+
+  /// CHECK-START: int Main.$noinline$clamp(int, int, int) select_generator (before)
+  /// CHECK:                        If
+  /// CHECK:                        If
+
+  /// CHECK-START: int Main.$noinline$clamp(int, int, int) select_generator (after)
+  /// CHECK:                        Select
+  /// CHECK:                        Select
+
+  /// CHECK-START: int Main.$noinline$clamp(int, int, int) select_generator (after)
+  /// CHECK-NOT:                    If
+  public static int $noinline$clamp(int x, int lo, int hi) {
+    return x < lo ? lo : (x > hi ? hi : x);
+  }
+
   public static void main(String[] args) throws Throwable {
+    assertIntEquals(7, $noinline$cheapBranches(true, 3, 5));
+    assertIntEquals(-2, $noinline$cheapBranches(false, 3, 5));
+    assertIntEquals(-2, $noinline$twoPhis(true, 3, 5));
+    assertIntEquals(2, $noinline$twoPhis(false, 3, 5));
+    assertIntEquals(1, $noinline$clamp(-4, 1, 9));
+    assertIntEquals(9, $noinline$clamp(42, 1, 9));
+    assertIntEquals(5, $noinline$clamp(5, 1, 9));
+
     Class<?> c = Class.forName("TestCase");
     Method m = c.getMethod("testCase", boolean.class);
     Method m2 = c.getMethod("referenceTypeTestCase", Sub1.class, Sub2.class, boolean.class);
@@ -46,6 +46,11 @@ void Java_Main_callThrough(JNIEnv* env, jclass, jclass klass, jstring methodName
   env->CallStaticVoidMethod(klass, method);
 }
 
+extern "C" JNIEXPORT
+void Java_Main_callThroughAgain(JNIEnv* env, jclass main_klass, jclass klass, jstring methodName) {
+  Java_Main_callThrough(env, main_klass, klass, methodName);
+}
+
 extern "C" JNIEXPORT
 void Java_Main_jitGc(JNIEnv*, jclass) {
   CHECK(Runtime::Current()->GetJit() != nullptr);
@@ -26,6 +26,7 @@ public class Main {
 
     testCompilationUseAndCollection();
     testMixedFramesOnStack();
+    testStubSharedBySignature();
   }
 
   public static void testCompilationUseAndCollection() {
@@ -106,6 +107,16 @@ public class Main {
     jitGc();
   }
 
+  public static void testStubSharedBySignature() {
+    // callThroughAgain() has the same shorty as callThrough(), so they share a JNI stub.
+    ensureCompiledCallThroughEntrypoint(/* call */ true);
+    assertFalse(hasJitCompiledEntrypoint(Main.class, "callThroughAgain"));
+    // A single call is enough for callThroughAgain() to pick up the compiled stub.
+    callThroughAgain(Main.class, "doNothing");
+    assertTrue(hasJitCompiledEntrypoint(Main.class, "callThroughAgain"));
+    callThroughAgain(Main.class, "doNothing");
+  }
+
   public static void testStubCanBeCollected() {
     assertTrue(hasJitCompiledCode(Main.class, "callThrough"));
     doJitGcsUntilFullJitGcIsScheduled();
@@ -170,8 +181,10 @@ public class Main {
   public static void throwError() { throw new Error(); }
 
   // Note that the callThrough()'s shorty differs from shorties of the other
-  // native methods used in this test because of the return type `void.`
+  // native methods used in this test because of the return type `void.`,
+  // except for callThroughAgain() which is meant to share its JNI stub.
   public native static void callThrough(Class<?> cls, String methodName);
+  public native static void callThroughAgain(Class<?> cls, String methodName);
 
   public native static void jitGc();
   public native static boolean isNextJitGcFull();
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Tests for vectorization of selects and of the overlapping vector epilogue.
+ */
+public class Main {
+
+  /// CHECK-START: void Main.selectGreater(int[], int[], int[]) loop_optimization (before)
+  /// CHECK-DAG: <<Phi:i\d+>>  Phi                                 loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Get1:i\d+>> ArrayGet                            loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Get2:i\d+>> ArrayGet                            loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Cnd:z\d+>>  GreaterThan [<<Get1>>,<<Get2>>]     loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Sel:i\d+>>  Select [{{i\d+}},<<Get1>>,<<Cnd>>]  loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:               ArraySet [{{l\d+}},<<Phi>>,<<Sel>>] loop:<<Loop>>      outer_loop:none
+  //
+  /// CHECK-START-{ARM64,X86_64}: void Main.selectGreater(int[], int[], int[]) loop_optimization (after)
+  /// CHECK-DAG: <<Get1:d\d+>> VecLoad                                           loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Get2:d\d+>> VecLoad                                           loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Cnd:d\d+>>  VecCondition [<<Get1>>,<<Get2>>] packed_type:Int32 loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Sel:d\d+>>  VecSelect [<<Cnd>>,<<Get1>>,{{d\d+}}]             loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:               VecStore [{{l\d+}},{{i\d+}},<<Sel>>]              loop:<<Loop>>      outer_loop:none
+  private static void selectGreater(int[] x, int[] y, int[] z) {
+    int min = Math.min(x.length, Math.min(y.length, z.length));
+    for (int i = 0; i < min; i++) {
+      int a = y[i];
+      x[i] = a > z[i] ? a : 0;
+    }
+  }
+
+  private static void selectLessEqual(byte[] x, byte[] y, byte[] z) {
+    int min = Math.min(x.length, Math.min(y.length, z.length));
+    for (int i = 0; i < min; i++) {
+      byte a = y[i];
+      x[i] = a <= z[i] ? a : 7;
+    }
+  }
+
+  // A loop that reads no written array can redo iterations in an overlapping
+  // vector epilogue, which replaces the scalar cleanup for a known trip count.
+  //
+  /// CHECK-START-{ARM64,X86_64}: int[] Main.fill() loop_optimization (after)
+  /// CHECK-DAG: VecStore loop:<<Loop1:B\d+>> outer_loop:none
+  /// CHECK-DAG: VecStore loop:<<Loop2:B\d+>> outer_loop:none
+  /// CHECK-EVAL: "<<Loop1>>" != "<<Loop2>>"
+  //
+  /// CHECK-START-{ARM64,X86_64}: int[] Main.fill() loop_optimization (after)
+  /// CHECK-NOT: ArraySet
+  private static int[] fill() {
+    int[] x = new int[101];
+    for (int i = 0; i < 101; i++) {
+      x[i] = 5;
+    }
+    return x;
+  }
+
+  // Two arrays of the same type may be the same array, so the epilogue is
+  // guarded by a != b, and the scalar cleanup loop remains for when it is skipped.
+  //
+  /// CHECK-START-{ARM64,X86_64}: void Main.copy(int[], int[]) loop_optimization (after)
+  /// CHECK-DAG: VecStore loop:<<Loop1:B\d+>> outer_loop:none
+  /// CHECK-DAG: VecStore loop:<<Loop2:B\d+>> outer_loop:none
+  /// CHECK-DAG: ArraySet loop:{{B\d+}}       outer_loop:none
+  /// CHECK-EVAL: "<<Loop1>>" != "<<Loop2>>"
+  private static void copy(int[] a, int[] b) {
+    int min = Math.min(a.length, b.length);
+    for (int i = 0; i < min; i++) {
+      a[i] = b[i] + 1;
+    }
+  }
+
+  // A written array that is also read cannot be redone.
+  //
+  /// CHECK-START-{ARM64,X86_64}: void Main.inPlace(int[]) loop_optimization (after)
+  /// CHECK-DAG: VecStore loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: ArraySet loop:{{B\d+}}      outer_loop:none
+  //
+  /// CHECK-START-{ARM64,X86_64}: void Main.inPlace(int[]) loop_optimization (after)
+  /// CHECK:     VecStore
+  /// CHECK-NOT: VecStore
+  private static void inPlace(int[] a) {
+    for (int i = 0; i < a.length; i++) {
+      a[i] += 1;
+    }
+  }
+
+  public static void main(String[] args) {
+    // Odd lengths exercise the epilogue and the cleanup.
+    for (int n = 0; n < 40; n++) {
+      int[] x = new int[n];
+      int[] y = new int[n];
+      int[] z = new int[n];
+      byte[] bx = new byte[n];
+      byte[] by = new byte[n];
+      byte[] bz = new byte[n];
+      for (int i = 0; i < n; i++) {
+        y[i] = (i * 0x12345678) ^ (i << 3);
+        z[i] = (i * 0x7654321) - 1000;
+        by[i] = (byte) y[i];
+        bz[i] = (byte) z[i];
+      }
+      selectGreater(x, y, z);
+      selectLessEqual(bx, by, bz);
+      for (int i = 0; i < n; i++) {
+        expectEquals(y[i] > z[i] ? y[i] : 0, x[i]);
+        expectEquals(by[i] <= bz[i] ? by[i] : 7, bx[i]);
+      }
+      copy(x, y);
+      for (int i = 0; i < n; i++) {
+        expectEquals(y[i] + 1, x[i]);
+      }
+      // Aliased arguments take the scalar path.
+      copy(y, y);
+      inPlace(z);
+      for (int i = 0; i < n; i++) {
+        expectEquals(x[i], y[i]);
+        expectEquals((i * 0x7654321) - 999, z[i]);
+      }
+    }
+    int[] x = fill();
+    expectEquals(101, x.length);
+    for (int i = 0; i < x.length; i++) {
+      expectEquals(5, x[i]);
+    }
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jni.h"
+
+#include "nativehelper/ScopedUtfChars.h"
+
+namespace art {
+
+extern "C" JNIEXPORT void JNICALL Java_Main_setStaticIntField(JNIEnv* env,
+                                                              jclass,
+                                                              jclass cls,
+                                                              jstring name,
+                                                              jint value) {
+  ScopedUtfChars name_chars(env, name);
+  if (name_chars.c_str() == nullptr) {
+    return;
+  }
+  jfieldID field_id = env->GetStaticFieldID(cls, name_chars.c_str(), "I");
+  if (field_id == nullptr) {
+    return;
+  }
+  env->SetStaticIntField(cls, field_id, value);
+}
+
+}  // namespace art
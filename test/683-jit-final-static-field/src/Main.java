@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class Config {
+  // Not a compile-time constant, so javac does not inline it.
+  static final int LEVEL = Integer.parseInt("1");
+}
+
+public class Main {
+  public static void main(String[] args) {
+    System.loadLibrary(args[0]);
+    if (!hasJit()) {
+      // The test requires JIT for the folding.
+      System.out.println("passed");
+      return;
+    }
+    assertEquals(1, getLevel());
+    ensureJitCompiled(Main.class, "getLevel");
+    assertEquals(1, getLevel());
+
+    setStaticIntField(Config.class, "LEVEL", 2);
+    assertEquals(2, getLevel());
+
+    // The JIT must not fold the field again now that it is known to change.
+    ensureJitCompiled(Main.class, "getLevel");
+    setStaticIntField(Config.class, "LEVEL", 3);
+    assertEquals(3, getLevel());
+    System.out.println("passed");
+  }
+
+  public static int getLevel() {
+    return Config.LEVEL;
+  }
+
+  public static void assertEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  private static native boolean hasJit();
+  private static native void ensureJitCompiled(Class<?> cls, String methodName);
+  private static native void setStaticIntField(Class<?> cls, String name, int value);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.util.Arrays;
+
+public class Main {
+  public static void main(String[] args) {
+    testEquals();
+    testFill();
+    testHashCode();
+    testStringHashCode();
+    System.out.println("passed");
+  }
+
+  private static void testEquals() {
+    byte[] empty = new byte[0];
+    assertTrue(Arrays.equals((byte[]) null, (byte[]) null));
+    assertFalse(Arrays.equals(empty, null));
+    assertFalse(Arrays.equals(null, empty));
+    assertTrue(Arrays.equals(empty, empty));
+    for (int length = 0; length < 70; length++) {
+      byte[] a = makeArray(length);
+      byte[] b = makeArray(length);
+      assertTrue(Arrays.equals(a, b));
+      assertFalse(Arrays.equals(a, makeArray(length + 1)));
+      for (int i = 0; i < length; i++) {
+        b[i]++;
+        assertFalse(Arrays.equals(a, b));
+        b[i]--;
+      }
+    }
+  }
+
+  private static void testFill() {
+    for (int length = 0; length < 70; length++) {
+      byte[] a = makeArray(length);
+      Arrays.fill(a, (byte) -3);
+      for (int i = 0; i < length; i++) {
+        assertEquals(-3, a[i]);
+      }
+    }
+    try {
+      Arrays.fill((byte[]) null, (byte) 1);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+  }
+
+  private static void testHashCode() {
+    assertEquals(0, Arrays.hashCode((byte[]) null));
+    for (int length = 0; length < 70; length++) {
+      byte[] a = makeArray(length);
+      int expected = 1;
+      for (byte b : a) {
+        expected = 31 * expected + b;
+      }
+      assertEquals(expected, Arrays.hashCode(a));
+    }
+  }
+
+  private static void testStringHashCode() {
+    assertEquals(0, "".hashCode());
+    StringBuilder sb = new StringBuilder();
+    for (int length = 0; length < 40; length++) {
+      String s = sb.toString();
+      int expected = 0;
+      for (int i = 0; i < s.length(); i++) {
+        expected = 31 * expected + s.charAt(i);
+      }
+      // The first call computes the hash code, the second one reads the cached value.
+      assertEquals(expected, s.hashCode());
+      assertEquals(expected, s.hashCode());
+      sb.append((char) ((length % 2 == 0) ? 'a' + length : 0x100 + length));
+    }
+  }
+
+  private static byte[] makeArray(int length) {
+    byte[] a = new byte[length];
+    for (int i = 0; i < length; i++) {
+      a[i] = (byte) (i * 37 + 11);
+    }
+    return a;
+  }
+
+  private static void assertTrue(boolean value) {
+    if (!value) {
+      throw new Error("Expected true");
+    }
+  }
+
+  private static void assertFalse(boolean value) {
+    if (value) {
+      throw new Error("Expected false");
+    }
+  }
+
+  private static void assertEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+}
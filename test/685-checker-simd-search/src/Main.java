@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Tests for early-exit vectorization of search loops.
+ */
+public class Main {
+
+  // A vector loop skips the vectors without a match, and the original
+  // loop finds the exact index.
+  //
+  /// CHECK-START-{ARM64,X86_64}: int Main.indexOf(byte[], byte) loop_optimization (after)
+  /// CHECK-DAG: <<Get:d\d+>> VecLoad                                      loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Rep:d\d+>> VecReplicateScalar                           loop:none
+  /// CHECK-DAG: <<Cnd:d\d+>> VecCondition [<<Get>>,<<Rep>>] packed_type:Int8 loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Any:z\d+>> VecAnyTrue [<<Cnd>>]                          loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:              If [<<Any>>]                                  loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:              ArrayGet                                      loop:{{B\d+}}      outer_loop:none
+  private static int indexOf(byte[] a, byte x) {
+    for (int i = 0; i < a.length; i++) {
+      if (a[i] == x) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  /// CHECK-START-{ARM64,X86_64}: int Main.skipSpaces(java.lang.String) loop_optimization (after)
+  /// CHECK-DAG: <<Get:d\d+>> VecLoad                                          loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Cnd:d\d+>> VecCondition [<<Get>>,{{d\d+}}] packed_type:Uint16 loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:              VecAnyTrue [<<Cnd>>]                              loop:<<Loop>>      outer_loop:none
+  private static int skipSpaces(String s) {
+    int i = 0;
+    for (; i < s.length(); i++) {
+      if (s.charAt(i) != ' ') {
+        break;
+      }
+    }
+    return i;
+  }
+
+  private static int firstAbove(int[] a, int x) {
+    int i = 0;
+    while (i < a.length && a[i] <= x) {
+      i++;
+    }
+    return i;
+  }
+
+  // The loop has a side effect, so skipping iterations is not allowed.
+  //
+  /// CHECK-START: int Main.countUntil(byte[], int[]) loop_optimization (after)
+  /// CHECK-NOT: VecAnyTrue
+  private static int countUntil(byte[] a, int[] counter) {
+    int i = 0;
+    for (; i < a.length; i++) {
+      counter[0]++;
+      if (a[i] == 0) {
+        break;
+      }
+    }
+    return i;
+  }
+
+  // A constant that does not fit in a byte is never equal to an element.
+  private static int indexOf300(byte[] a) {
+    for (int i = 0; i < a.length; i++) {
+      if (a[i] == 300) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  public static void main(String[] args) {
+    for (int n = 0; n < 80; n++) {
+      byte[] a = new byte[n];
+      for (int i = 0; i < n; i++) {
+        a[i] = (byte) (i + 1);
+      }
+      for (int i = 0; i < n; i++) {
+        expectEquals(i, indexOf(a, (byte) (i + 1)));
+      }
+      expectEquals(-1, indexOf(a, (byte) 0));
+      expectEquals(-1, indexOf300(a));
+      if (n > 0) {
+        a[n - 1] = 44;  // 300 truncated to a byte
+        expectEquals(Math.min(43, n - 1), indexOf(a, (byte) 44));
+        expectEquals(-1, indexOf300(a));
+      }
+
+      StringBuilder sb = new StringBuilder();
+      for (int i = 0; i < n; i++) {
+        sb.append(' ');
+      }
+      String spaces = sb.toString();
+      expectEquals(n, skipSpaces(spaces));
+      expectEquals(n, skipSpaces(spaces + "x"));
+      expectEquals(n, skipSpaces(spaces + "\u1234"));
+      expectEquals(0, skipSpaces("x" + spaces));
+
+      int[] b = new int[n];
+      for (int i = 0; i < n; i++) {
+        b[i] = i;
+      }
+      expectEquals(n, firstAbove(b, n));
+      expectEquals(Math.min(n / 2 + 1, n), firstAbove(b, n / 2));
+      expectEquals(0, firstAbove(b, -1));
+
+      int[] counter = new int[1];
+      byte[] c = new byte[n + 1];
+      java.util.Arrays.fill(c, (byte) 1);
+      c[n] = 0;
+      expectEquals(n, countUntil(c, counter));
+      expectEquals(n + 1, counter[0]);
+    }
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
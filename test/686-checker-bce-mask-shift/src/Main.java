@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Tests for bounds check elimination of masked and shifted indices.
+ */
+public class Main {
+
+  /// CHECK-START: int Main.halves(int[]) BCE (before)
+  /// CHECK-DAG: BoundsCheck
+  /// CHECK-DAG: BoundsCheck
+  /// CHECK-DAG: BoundsCheck
+  //
+  /// CHECK-START: int Main.halves(int[]) BCE (after)
+  /// CHECK-NOT: BoundsCheck
+  /// CHECK-NOT: Deoptimize
+  private static int halves(int[] a) {
+    int sum = 0;
+    for (int i = 0; i < a.length; i++) {
+      sum += a[i] + a[i >> 1] + a[i >>> 2];
+    }
+    return sum;
+  }
+
+  // The constant index access proves a.length >= 1 for the masked access.
+  //
+  /// CHECK-START: int Main.maskedAfterStore(int[], int) BCE (after)
+  /// CHECK:     BoundsCheck
+  /// CHECK:     ArraySet
+  /// CHECK-NOT: BoundsCheck
+  /// CHECK:     ArrayGet
+  private static int maskedAfterStore(int[] a, int h) {
+    a[0] = h;
+    return a[h & (a.length - 1)];
+  }
+
+  // A masked index of a non-negative value is bounded by that value.
+  //
+  /// CHECK-START: int Main.maskedInduction(int[]) BCE (after)
+  /// CHECK-NOT: BoundsCheck
+  /// CHECK-NOT: Deoptimize
+  private static int maskedInduction(int[] a) {
+    int sum = 0;
+    for (int i = 0; i < a.length; i++) {
+      sum += a[i & 0x7ffffff0];
+    }
+    return sum;
+  }
+
+  // A single deoptimization test on the table length replaces
+  // the bounds check of the masked index in the loop.
+  //
+  /// CHECK-START: int Main.maskedLoop(int[], int[]) BCE (before)
+  /// CHECK-DAG: BoundsCheck
+  /// CHECK-DAG: BoundsCheck
+  //
+  /// CHECK-START: int Main.maskedLoop(int[], int[]) BCE (after)
+  /// CHECK-DAG: Deoptimize
+  //
+  /// CHECK-START: int Main.maskedLoop(int[], int[]) BCE (after)
+  /// CHECK-NOT: BoundsCheck
+  private static int maskedLoop(int[] table, int[] keys) {
+    int mask = table.length - 1;
+    int sum = 0;
+    for (int i = 0; i < keys.length; i++) {
+      sum += table[keys[i] & mask];
+    }
+    return sum;
+  }
+
+  public static void main(String[] args) {
+    int[] a = new int[37];
+    for (int i = 0; i < a.length; i++) {
+      a[i] = i;
+    }
+    int expected = 0;
+    for (int i = 0; i < a.length; i++) {
+      expected += i + (i / 2) + (i / 4);
+    }
+    expectEquals(expected, halves(a));
+    expectEquals(0, halves(new int[0]));
+
+    int[] b = new int[16];
+    expectEquals(0, maskedAfterStore(b, 0x1235));  // index 5 is left 0
+    expectEquals(0x1230, maskedAfterStore(b, 0x1230));  // index 0 was just stored
+    expectEquals(-1, maskedAfterStore(new int[1], -1));
+
+    expectEquals(416, maskedInduction(a));  // 16 * 0 + 16 * 16 + 5 * 32
+
+    int[] table = new int[8];
+    for (int i = 0; i < table.length; i++) {
+      table[i] = 1 << i;
+    }
+    int[] keys = { 0, 1, 9, -1, 0x7fffffff, 0x80000000, 12 };
+    expectEquals(1 + 2 + 2 + 128 + 128 + 1 + 16, maskedLoop(table, keys));
+    expectEquals(0, maskedLoop(new int[0], new int[0]));
+    try {
+      maskedLoop(new int[0], keys);
+      throw new Error("expected exception");
+    } catch (ArrayIndexOutOfBoundsException e) {
+      // Expected.
+    }
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
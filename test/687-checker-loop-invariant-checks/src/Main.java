@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Tests for replacing null checks and type checks on loop-invariant
+ * references by a single deoptimization test in the loop preheader.
+ */
+public class Main {
+
+  static final class Leaf {
+    int value;
+    Leaf(int value) {
+      this.value = value;
+    }
+  }
+
+  int field;
+
+  /// CHECK-START: int Main.sumField(Main, int) BCE (before)
+  /// CHECK-DAG: NullCheck loop:{{B\d+}}
+  //
+  /// CHECK-START: int Main.sumField(Main, int) BCE (after)
+  /// CHECK-DAG: Deoptimize
+  //
+  /// CHECK-START: int Main.sumField(Main, int) BCE (after)
+  /// CHECK-NOT: NullCheck
+  private static int sumField(Main m, int n) {
+    int sum = 0;
+    for (int i = 0; i < n; i++) {
+      m.field += i;
+      sum += m.field;
+    }
+    return sum;
+  }
+
+  /// CHECK-START: int Main.sumCast(java.lang.Object, int) BCE (before)
+  /// CHECK-DAG: CheckCast loop:{{B\d+}}
+  //
+  /// CHECK-START: int Main.sumCast(java.lang.Object, int) BCE (after)
+  /// CHECK-DAG: InstanceOf loop:none
+  /// CHECK-DAG: Deoptimize
+  //
+  /// CHECK-START: int Main.sumCast(java.lang.Object, int) BCE (after)
+  /// CHECK-NOT: CheckCast
+  private static int sumCast(Object o, int n) {
+    if (o == null) {
+      return -1;
+    }
+    int sum = 0;
+    for (int i = 0; i < n; i++) {
+      sum += ((Leaf) o).value;
+    }
+    return sum;
+  }
+
+  public static void main(String[] args) {
+    Main m = new Main();
+    expectEquals(0 + 1 + 3 + 6, sumField(m, 4));
+    expectEquals(6, m.field);
+    expectEquals(0, sumField(null, 0));
+    try {
+      sumField(null, 1);
+      throw new Error("expected exception");
+    } catch (NullPointerException e) {
+      // Expected.
+    }
+
+    expectEquals(21, sumCast(new Leaf(7), 3));
+    expectEquals(-1, sumCast(null, 3));
+    expectEquals(0, sumCast("not a leaf", 0));
+    try {
+      sumCast("not a leaf", 2);
+      throw new Error("expected exception");
+    } catch (ClassCastException e) {
+      // Expected.
+    }
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
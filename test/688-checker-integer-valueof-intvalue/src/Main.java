@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+
+  /// CHECK-START: int Main.unbox(int) inliner (after)
+  /// CHECK-DAG: <<Integer:l\d+>>     InvokeStaticOrDirect method_name:java.lang.Integer.valueOf intrinsic:IntegerValueOf
+  /// CHECK-DAG:                      InstanceFieldGet field_name:java.lang.Integer.value
+
+  /// CHECK-START: int Main.unbox(int) instruction_simplifier$after_inlining (after)
+  /// CHECK-DAG: <<Arg:i\d+>>         ParameterValue
+  /// CHECK-DAG: <<Const1:i\d+>>      IntConstant 1
+  /// CHECK-DAG: <<Add:i\d+>>         Add [<<Arg>>,<<Const1>>]
+  /// CHECK-DAG:                      Return [<<Add>>]
+
+  /// CHECK-START: int Main.unbox(int) instruction_simplifier$after_inlining (after)
+  /// CHECK-NOT:                      InstanceFieldGet
+
+  /// CHECK-START: int Main.unbox(int) dead_code_elimination$after_inlining (after)
+  /// CHECK-NOT:                      InvokeStaticOrDirect
+  public static int unbox(int a) {
+    Integer boxed = Integer.valueOf(a);
+    return boxed.intValue() + 1;
+  }
+
+  /// CHECK-START: int Main.unboxEscaping(int) instruction_simplifier$after_inlining (after)
+  /// CHECK-DAG: <<Arg:i\d+>>         ParameterValue
+  /// CHECK-DAG: <<Integer:l\d+>>     InvokeStaticOrDirect [<<Arg>>{{(,[ij]\d+)?}}] intrinsic:IntegerValueOf
+  /// CHECK-DAG:                      StaticFieldSet [{{l\d+}},<<Integer>>]
+  /// CHECK-DAG:                      Return [<<Arg>>]
+  public static int unboxEscaping(int a) {
+    Integer boxed = Integer.valueOf(a);
+    escaped = boxed;
+    return boxed.intValue();
+  }
+
+  public static void main(String[] args) {
+    assertEqual(43, unbox(intField));
+    assertEqual(55556, unbox(intField2));
+    assertEqual(-129, unboxEscaping(intFieldMinus129));
+    assertEqual(-129, escaped.intValue());
+  }
+
+  static void assertEqual(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  static Integer escaped;
+
+  static int intField = 42;
+  static int intField2 = 55555;
+  static int intFieldMinus129 = -129;
+}
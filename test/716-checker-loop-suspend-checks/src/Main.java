@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Tests for not generating the suspend checks of inner loops whose
+ * iterations all execute a small number of instructions.
+ */
+public class Main {
+
+  /// CHECK-START: int Main.smallLoop(int) loop_optimization (before)
+  /// CHECK-DAG: SuspendCheck is_no_op:false loop:{{B\d+}}
+  //
+  /// CHECK-START: int Main.smallLoop(int) loop_optimization (after)
+  /// CHECK-DAG: SuspendCheck is_no_op:true loop:{{B\d+}}
+  //
+  /// CHECK-START: int Main.smallLoop(int) loop_optimization (after)
+  /// CHECK-NOT: SuspendCheck is_no_op:false loop:{{B\d+}}
+  private static int smallLoop(int x) {
+    int result = x;
+    for (int i = 0; i < 10; i++) {
+      result = result * 31 + i;
+    }
+    return result;
+  }
+
+  /// CHECK-START: int Main.largeLoop(int) loop_optimization (after)
+  /// CHECK-DAG: SuspendCheck is_no_op:false loop:{{B\d+}}
+  //
+  /// CHECK-START: int Main.largeLoop(int) loop_optimization (after)
+  /// CHECK-NOT: SuspendCheck is_no_op:true
+  private static int largeLoop(int x) {
+    int result = x;
+    for (int i = 0; i < 100000; i++) {
+      result = result * 31 + i;
+    }
+    return result;
+  }
+
+  /// CHECK-START: int Main.unknownTripCount(int, int) loop_optimization (after)
+  /// CHECK-DAG: SuspendCheck is_no_op:false loop:{{B\d+}}
+  //
+  /// CHECK-START: int Main.unknownTripCount(int, int) loop_optimization (after)
+  /// CHECK-NOT: SuspendCheck is_no_op:true
+  private static int unknownTripCount(int x, int n) {
+    int result = x;
+    for (int i = 0; i < n; i++) {
+      result = result * 31 + i;
+    }
+    return result;
+  }
+
+  /// CHECK-START: int Main.smallLoopWithCall(int) loop_optimization (after)
+  /// CHECK-DAG: SuspendCheck is_no_op:false loop:{{B\d+}}
+  //
+  /// CHECK-START: int Main.smallLoopWithCall(int) loop_optimization (after)
+  /// CHECK-NOT: SuspendCheck is_no_op:true
+  private static int smallLoopWithCall(int x) {
+    int result = x;
+    for (int i = 0; i < 10; i++) {
+      result = result * 31 + $noinline$identity(i);
+    }
+    return result;
+  }
+
+  private static int $noinline$identity(int x) {
+    return x;
+  }
+
+  private static int reference(int x, int n) {
+    int result = x;
+    int i = 0;
+    while (i < n) {
+      result = result * 31 + i;
+      i++;
+    }
+    return result;
+  }
+
+  public static void main(String[] args) {
+    expectEquals(reference(5, 10), smallLoop(5));
+    expectEquals(reference(5, 100000), largeLoop(5));
+    expectEquals(reference(5, 7), unknownTripCount(5, 7));
+    expectEquals(reference(5, 10), smallLoopWithCall(5));
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -16,6 +16,7 @@
 
 package com.android.ahat.heapdump;
 
+import java.nio.ByteBuffer;
 import java.nio.charset.StandardCharsets;
 import java.util.AbstractList;
 import java.util.Collections;
@@ -40,6 +41,10 @@ public class AhatArrayInstance extends AhatInstance {
   private byte[] mByteArray;    // null if not a byte array.
   private char[] mCharArray;    // null if not a char array.
 
+  // The elements of a large byte array left in the heap dump, in which case
+  // mByteArray is null.
+  private ByteBuffer mByteBuffer;
+
   AhatArrayInstance(long id) {
     super(id);
   }
@@ -166,6 +171,41 @@ public class AhatArrayInstance extends AhatInstance {
     };
   }
 
+  /**
+   * Initialize the array elements for a primitive array whose elements stay
+   * in the memory mapped heap dump and are only read when accessed. This
+   * avoids copying large arrays such as bitmap pixels onto the Java heap.
+   * Char arrays are not supported, as their contents are needed as strings.
+   */
+  void initialize(final Type type, final ByteBuffer elements) {
+    assert type != Type.CHAR && type != Type.OBJECT;
+    if (type == Type.BYTE) {
+      mByteBuffer = elements;
+    }
+    final int length = elements.limit() / type.size;
+    mValues = new AbstractList<Value>() {
+      @Override public int size() {
+        return length;
+      }
+
+      @Override public Value get(int index) {
+        if (index < 0 || index >= length) {
+          throw new IndexOutOfBoundsException("Index: " + index + ", Size: " + length);
+        }
+        switch (type) {
+          case BOOLEAN: return Value.pack(elements.get(index) != 0);
+          case FLOAT: return Value.pack(elements.getFloat(index * type.size));
+          case DOUBLE: return Value.pack(elements.getDouble(index * type.size));
+          case BYTE: return Value.pack(elements.get(index));
+          case SHORT: return Value.pack(elements.getShort(index * type.size));
+          case INT: return Value.pack(elements.getInt(index * type.size));
+          case LONG: return Value.pack(elements.getLong(index * type.size));
+          default: throw new AssertionError("unsupported enum member");
+        }
+      }
+    };
+  }
+
   /**
    * Initialize the array elements for an instance array.
    */
@@ -291,21 +331,22 @@ public class AhatArrayInstance extends AhatInstance {
    * Only byte arrays are considered as having an associated ascii String value.
    */
   String asAsciiString(int offset, int count, int maxChars) {
-    if (mByteArray == null) {
+    byte[] bytes = asByteArray();
+    if (bytes == null) {
       return null;
     }
 
     if (count == 0) {
       return "";
     }
-    int numChars = mByteArray.length;
+    int numChars = bytes.length;
     if (0 <= maxChars && maxChars < count) {
       count = maxChars;
     }
 
     int end = offset + count - 1;
     if (offset >= 0 && offset < numChars && end >= 0 && end < numChars) {
-      return new String(mByteArray, offset, count, StandardCharsets.US_ASCII);
+      return new String(bytes, offset, count, StandardCharsets.US_ASCII);
     }
     return null;
   }
@@ -323,7 +364,7 @@ public class AhatArrayInstance extends AhatInstance {
   }
 
   @Override public AhatInstance getAssociatedBitmapInstance() {
-    if (mByteArray != null) {
+    if (mByteArray != null || mByteBuffer != null) {
       List<AhatInstance> refs = getHardReverseReferences();
       if (refs.size() == 1) {
         AhatInstance ref = refs.get(0);
@@ -342,6 +383,13 @@ public class AhatArrayInstance extends AhatInstance {
   }
 
   byte[] asByteArray() {
+    if (mByteArray == null && mByteBuffer != null) {
+      // Copy the elements out of the heap dump every time rather than caching
+      // them, as they are rarely needed, for example to render a bitmap.
+      byte[] bytes = new byte[mByteBuffer.limit()];
+      mByteBuffer.duplicate().get(bytes);
+      return bytes;
+    }
     return mByteArray;
   }
 }
@@ -37,6 +37,10 @@ import java.util.Map;
 public class Parser {
   private static final int ID_SIZE = 4;
 
+  // Primitive arrays with at least this many bytes of elements are not copied
+  // out of the heap dump, see AhatArrayInstance.initialize(Type, ByteBuffer).
+  private static final long LAZY_ARRAY_BYTES = 4096;
+
   private Parser() {
   }
 
@@ -359,7 +363,7 @@ public class Parser {
                   int length = hprof.getU4();
                   long classId = hprof.getId();
                   ObjArrayData data = new ObjArrayData(length, hprof.tell());
-                  hprof.skip(length * ID_SIZE);
+                  hprof.skip((long)length * ID_SIZE);
 
                   Site site = sites.get(stackSerialNumber);
                   AhatClassObj classObj = classById.get(classId);
@@ -386,6 +390,22 @@ public class Parser {
                   AhatArrayInstance obj = new AhatArrayInstance(objectId);
                   obj.initialize(heaps.getCurrentHeap(), site, classObj);
                   instances.add(obj);
+
+                  // Leave the elements of large arrays, typically bitmap
+                  // pixels, in the memory mapped heap dump and only read them
+                  // when they are accessed. Char arrays are always copied, as
+                  // they back the strings shown everywhere.
+                  long numBytes = (long)length * type.size;
+                  ByteBuffer elements = null;
+                  if (type != Type.CHAR && numBytes >= LAZY_ARRAY_BYTES
+                      && numBytes <= Integer.MAX_VALUE) {
+                    elements = hprof.getSlice((int)numBytes);
+                  }
+                  if (elements != null) {
+                    obj.initialize(type, elements);
+                    break;
+                  }
+
                   switch (type) {
                     case BOOLEAN: {
                       boolean[] data = new boolean[length];
@@ -636,18 +656,18 @@ public class Parser {
 
   private static class ClassInstData {
     // The byte position in the hprof file where instance field data starts.
-    public int position;
+    public long position;
 
-    public ClassInstData(int position) {
+    public ClassInstData(long position) {
       this.position = position;
     }
   }
 
   private static class ObjArrayData {
     public int length;          // Number of array elements.
-    public int position;        // Position in hprof file containing element data.
+    public long position;       // Position in hprof file containing element data.
 
-    public ObjArrayData(int length, int position) {
+    public ObjArrayData(int length, long position) {
       this.length = length;
       this.position = position;
     }
@@ -848,96 +868,154 @@ public class Parser {
   /**
    * Wrapper around a ByteBuffer that presents a uniform interface for
    * accessing data from an hprof file.
+   * <p>
+   * A single MappedByteBuffer cannot be larger than 2GB, so hprof files are
+   * mapped as a sequence of overlapping segments. Segment i starts at byte
+   * i * SEGMENT_STEP of the file and extends SEGMENT_OVERLAP bytes into
+   * segment i + 1, so that any read of up to SEGMENT_OVERLAP bytes starting
+   * in segment i can be done entirely from segment i.
    */
   private static class HprofBuffer {
+    private static final long SEGMENT_STEP = 1L << 30;
+    private static final int SEGMENT_OVERLAP = 64 << 20;
+
+    private ByteBuffer[] mSegments;
+    private int mSegment;       // Index of mBuffer in mSegments.
     private ByteBuffer mBuffer;
 
     public HprofBuffer(File path) throws IOException {
       FileChannel channel = FileChannel.open(path.toPath(), StandardOpenOption.READ);
-      mBuffer = channel.map(FileChannel.MapMode.READ_ONLY, 0, channel.size());
+      long size = channel.size();
+      int numSegments = (int)Math.max(1, (size + SEGMENT_STEP - 1) / SEGMENT_STEP);
+      mSegments = new ByteBuffer[numSegments];
+      for (int i = 0; i < numSegments; ++i) {
+        long start = i * SEGMENT_STEP;
+        long length = Math.min(size - start, SEGMENT_STEP + SEGMENT_OVERLAP);
+        mSegments[i] = channel.map(FileChannel.MapMode.READ_ONLY, start, length);
+      }
       channel.close();
+      mBuffer = mSegments[0];
     }
 
     public HprofBuffer(ByteBuffer buffer) {
+      mSegments = new ByteBuffer[] { buffer };
       mBuffer = buffer;
     }
 
+    /**
+     * Returns the segment to read the next bytes from, moving on to the next
+     * segment once the current position has reached its overlap.
+     */
+    private ByteBuffer current() {
+      if (mBuffer.position() >= SEGMENT_STEP && mSegment + 1 < mSegments.length) {
+        seek(tell());
+      }
+      return mBuffer;
+    }
+
     public boolean hasRemaining() {
-      return mBuffer.hasRemaining();
+      return current().hasRemaining();
     }
 
     /**
      * Return the current absolution position in the file.
      */
-    public int tell() {
-      return mBuffer.position();
+    public long tell() {
+      return mSegment * SEGMENT_STEP + mBuffer.position();
     }
 
     /**
      * Seek to the given absolution position in the file.
      */
-    public void seek(int position) {
-      mBuffer.position(position);
+    public void seek(long position) {
+      mSegment = (int)Math.min(position / SEGMENT_STEP, mSegments.length - 1);
+      mBuffer = mSegments[mSegment];
+      mBuffer.position((int)(position - mSegment * SEGMENT_STEP));
     }
 
     /**
      * Skip ahead in the file by the given delta bytes. Delta may be negative
      * to skip backwards in the file.
      */
-    public void skip(int delta) {
+    public void skip(long delta) {
       seek(tell() + delta);
     }
 
+    /**
+     * Returns a read only view of the next numBytes bytes of the file and
+     * skips past them, or returns null without moving if they are not
+     * contained in a single segment.
+     */
+    public ByteBuffer getSlice(int numBytes) {
+      ByteBuffer buffer = current();
+      if (buffer.remaining() < numBytes) {
+        return null;
+      }
+      ByteBuffer slice = buffer.slice();
+      slice.limit(numBytes);
+      buffer.position(buffer.position() + numBytes);
+      return slice.asReadOnlyBuffer();
+    }
+
     public int getU1() {
-      return mBuffer.get() & 0xFF;
+      return current().get() & 0xFF;
     }
 
     public int getU2() {
-      return mBuffer.getShort() & 0xFFFF;
+      return current().getShort() & 0xFFFF;
     }
 
     public int getU4() {
-      return mBuffer.getInt();
+      return current().getInt();
     }
 
     public long getId() {
-      return mBuffer.getInt() & 0xFFFFFFFFL;
+      return current().getInt() & 0xFFFFFFFFL;
     }
 
     public boolean getBool() {
-      return mBuffer.get() != 0;
+      return current().get() != 0;
     }
 
     public char getChar() {
-      return mBuffer.getChar();
+      return current().getChar();
     }
 
     public float getFloat() {
-      return mBuffer.getFloat();
+      return current().getFloat();
     }
 
     public double getDouble() {
-      return mBuffer.getDouble();
+      return current().getDouble();
     }
 
     public byte getByte() {
-      return mBuffer.get();
+      return current().get();
     }
 
     public void getBytes(byte[] bytes) {
-      mBuffer.get(bytes);
+      int offset = 0;
+      while (offset < bytes.length) {
+        ByteBuffer buffer = current();
+        int count = Math.min(bytes.length - offset, buffer.remaining());
+        if (count == 0) {
+          throw new BufferUnderflowException();
+        }
+        buffer.get(bytes, offset, count);
+        offset += count;
+      }
     }
 
     public short getShort() {
-      return mBuffer.getShort();
+      return current().getShort();
     }
 
     public int getInt() {
-      return mBuffer.getInt();
+      return current().getInt();
     }
 
     public long getLong() {
-      return mBuffer.getLong();
+      return current().getLong();
     }
 
     private static Type[] TYPES = new Type[] {
@@ -16,6 +16,7 @@
 
 package com.android.ahat;
 
+import com.android.ahat.heapdump.AhatArrayInstance;
 import com.android.ahat.heapdump.AhatClassObj;
 import com.android.ahat.heapdump.AhatHeap;
 import com.android.ahat.heapdump.AhatInstance;
@@ -367,6 +368,16 @@ public class InstanceTest {
     assertEquals(String.format("byte[1000000]@%08x", id), obj.toString());
   }
 
+  @Test
+  public void bigPrimArrayValues() throws IOException {
+    TestDump dump = TestDump.getTestDump();
+    AhatArrayInstance array = dump.getDumpedAhatInstance("bigArray").asArrayInstance();
+    assertEquals(1000000, array.getLength());
+    for (int i : new int[] { 0, 1, 15, 4096, 999999 }) {
+      assertEquals(Byte.valueOf((byte)((i * i) & 0xFF)), array.getValue(i).asByte());
+    }
+  }
+
   @Test
   public void isNotRoot() throws IOException {
     TestDump dump = TestDump.getTestDump();
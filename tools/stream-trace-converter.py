@@ -60,6 +60,19 @@ def WriteIntLE(f, val):
   asbytearray = bytearray(bytes)
   f.write(asbytearray)
 
+def ReadUnsignedLeb128(buf, offset):
+  result = 0
+  shift = 0
+  while True:
+    if offset >= len(buf):
+      raise BufferUnderrun()
+    byte = ord(buf[offset])
+    offset += 1
+    result |= (byte & 0x7f) << shift
+    if (byte & 0x80) == 0:
+      return result, offset
+    shift += 7
+
 def Copy(input, output, length):
   buf = input.read(length)
   if len(buf) != length:
@@ -87,10 +100,12 @@ class Rewriter:
       raise MyException("Does not seem to be a streaming trace: %d." % version)
     version = version ^ 0xf0
 
-    if version != 3:
-      raise MyException("Only support version 3")
+    if version != 3 and version != 4:
+      raise MyException("Only support versions 3 and 4")
+    self._mVersion = version
 
-    WriteShortLE(body, version)
+    # Version 4 events are converted to version 3 records.
+    WriteShortLE(body, 3)
 
     # read offset
     offsetToData = ReadShortLE(input) - 16
@@ -130,7 +145,27 @@ class Rewriter:
     self._summary = str
     print 'Summary: \"%s\"' % str
 
-  def ProcessSpecial(self, input):
+  def ProcessThreadEvents(self, input, body):
+    tid = ReadShortLE(input)
+    eventsLength = ReadIntLE(input)
+    events = input.read(eventsLength)
+    if len(events) != eventsLength:
+      raise BufferUnderrun()
+    # Each event is the method and action, then the differences of the clocks to the previous
+    # event, all as unsigned LEB128.
+    numClocks = (self._mRecordSize - 6) / 4
+    clocks = [0] * numClocks
+    offset = 0
+    while offset < eventsLength:
+      methodAndAction, offset = ReadUnsignedLeb128(events, offset)
+      WriteShortLE(body, tid)
+      WriteIntLE(body, methodAndAction)
+      for i in range(numClocks):
+        delta, offset = ReadUnsignedLeb128(events, offset)
+        clocks[i] = (clocks[i] + delta) & 0xFFFFFFFF
+        WriteIntLE(body, clocks[i])
+
+  def ProcessSpecial(self, input, body):
     code = ord(input.read(1))
     if code == 1:
       self.ProcessMethod(input)
@@ -138,6 +173,8 @@ class Rewriter:
       self.ProcessThread(input)
     elif code == 3:
       self.ProcessTraceSummary(input)
+    elif code == 4 and self._mVersion == 4:
+      self.ProcessThreadEvents(input, body)
     else:
       raise MyException("Unknown special!")
 
@@ -146,7 +183,7 @@ class Rewriter:
       while True:
         threadId = ReadShortLE(input)
         if threadId == 0:
-          self.ProcessSpecial(input)
+          self.ProcessSpecial(input, body)
         else:
           # Regular package, just copy
           WriteShortLE(body, threadId)
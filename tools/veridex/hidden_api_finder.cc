@@ -24,6 +24,7 @@
 #include "resolver.h"
 #include "veridex.h"
 
+#include <algorithm>
 #include <iostream>
 
 namespace art {
@@ -50,144 +51,179 @@ void HiddenApiFinder::CheckField(uint32_t field_id,
   }
 }
 
-void HiddenApiFinder::CollectAccesses(VeridexResolver* resolver) {
+void HiddenApiFinder::CollectAccesses(VeridexResolver* resolver,
+                                      const DexFile::ClassDef& class_def) {
   const DexFile& dex_file = resolver->GetDexFile();
-  // Look at all types referenced in this dex file. Any of these
-  // types can lead to being used through reflection.
-  for (uint32_t i = 0; i < dex_file.NumTypeIds(); ++i) {
-    std::string name(dex_file.StringByTypeIdx(dex::TypeIndex(i)));
-    if (hidden_api_.IsInRestrictionList(name)) {
-      classes_.insert(name);
-    }
-  }
   // Note: we collect strings constants only referenced in code items as the string table
   // contains other kind of strings (eg types).
-  size_t class_def_count = dex_file.NumClassDefs();
-  for (size_t class_def_index = 0; class_def_index < class_def_count; ++class_def_index) {
-    const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
-    const uint8_t* class_data = dex_file.GetClassData(class_def);
-    if (class_data == nullptr) {
-      // Empty class.
+  const uint8_t* class_data = dex_file.GetClassData(class_def);
+  if (class_data == nullptr) {
+    // Empty class.
+    return;
+  }
+  ClassDataItemIterator it(dex_file, class_data);
+  it.SkipAllFields();
+  for (; it.HasNextMethod(); it.Next()) {
+    const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
+    if (code_item == nullptr) {
       continue;
     }
-    ClassDataItemIterator it(dex_file, class_data);
-    it.SkipAllFields();
-    for (; it.HasNextMethod(); it.Next()) {
-      const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
-      if (code_item == nullptr) {
-        continue;
-      }
-      CodeItemDataAccessor code_item_accessor(dex_file, code_item);
-      for (const DexInstructionPcPair& inst : code_item_accessor) {
-        switch (inst->Opcode()) {
-          case Instruction::CONST_STRING: {
-            dex::StringIndex string_index(inst->VRegB_21c());
-            std::string name = std::string(dex_file.StringDataByIdx(string_index));
-            // Cheap filtering on the string literal. We know it cannot be a field/method/class
-            // if it contains a space.
-            if (name.find(' ') == std::string::npos) {
-              // Class names at the Java level are of the form x.y.z, but the list encodes
-              // them of the form Lx/y/z;. Inner classes have '$' for both Java level class
-              // names in strings, and hidden API lists.
-              std::string str = HiddenApi::ToInternalName(name);
-              // Note: we can query the lists directly, as HiddenApi added classes that own
-              // private methods and fields in them.
-              // We don't add class names to the `strings_` set as we know method/field names
-              // don't have '.' or '/'. All hidden API class names have a '/'.
-              if (hidden_api_.IsInRestrictionList(str)) {
-                classes_.insert(str);
-              } else if (hidden_api_.IsInRestrictionList(name)) {
-                // Could be something passed to JNI.
-                classes_.insert(name);
-              } else {
-                // We only keep track of the location for strings, as these will be the
-                // field/method names the user is interested in.
-                strings_.insert(name);
-                reflection_locations_[name].push_back(
-                    MethodReference(&dex_file, it.GetMemberIndex()));
-              }
+    CodeItemDataAccessor code_item_accessor(dex_file, code_item);
+    for (const DexInstructionPcPair& inst : code_item_accessor) {
+      switch (inst->Opcode()) {
+        case Instruction::CONST_STRING: {
+          dex::StringIndex string_index(inst->VRegB_21c());
+          std::string name = std::string(dex_file.StringDataByIdx(string_index));
+          // Cheap filtering on the string literal. We know it cannot be a field/method/class
+          // if it contains a space.
+          if (name.find(' ') == std::string::npos) {
+            // Class names at the Java level are of the form x.y.z, but the list encodes
+            // them of the form Lx/y/z;. Inner classes have '$' for both Java level class
+            // names in strings, and hidden API lists.
+            std::string str = HiddenApi::ToInternalName(name);
+            // Note: we can query the lists directly, as HiddenApi added classes that own
+            // private methods and fields in them.
+            // We don't add class names to the `strings_` set as we know method/field names
+            // don't have '.' or '/'. All hidden API class names have a '/'.
+            if (hidden_api_.IsInRestrictionList(str)) {
+              classes_.insert(str);
+            } else if (hidden_api_.IsInRestrictionList(name)) {
+              // Could be something passed to JNI.
+              classes_.insert(name);
+            } else {
+              // We only keep track of the location for strings, as these will be the
+              // field/method names the user is interested in.
+              strings_.insert(name);
+              reflection_locations_[name].push_back(
+                  MethodReference(&dex_file, it.GetMemberIndex()));
             }
-            break;
-          }
-          case Instruction::INVOKE_DIRECT:
-          case Instruction::INVOKE_INTERFACE:
-          case Instruction::INVOKE_STATIC:
-          case Instruction::INVOKE_SUPER:
-          case Instruction::INVOKE_VIRTUAL: {
-            CheckMethod(
-                inst->VRegB_35c(), resolver, MethodReference(&dex_file, it.GetMemberIndex()));
-            break;
-          }
-
-          case Instruction::INVOKE_DIRECT_RANGE:
-          case Instruction::INVOKE_INTERFACE_RANGE:
-          case Instruction::INVOKE_STATIC_RANGE:
-          case Instruction::INVOKE_SUPER_RANGE:
-          case Instruction::INVOKE_VIRTUAL_RANGE: {
-            CheckMethod(
-                inst->VRegB_3rc(), resolver, MethodReference(&dex_file, it.GetMemberIndex()));
-            break;
           }
+          break;
+        }
+        case Instruction::INVOKE_DIRECT:
+        case Instruction::INVOKE_INTERFACE:
+        case Instruction::INVOKE_STATIC:
+        case Instruction::INVOKE_SUPER:
+        case Instruction::INVOKE_VIRTUAL: {
+          CheckMethod(
+              inst->VRegB_35c(), resolver, MethodReference(&dex_file, it.GetMemberIndex()));
+          break;
+        }
 
-          case Instruction::IGET:
-          case Instruction::IGET_WIDE:
-          case Instruction::IGET_OBJECT:
-          case Instruction::IGET_BOOLEAN:
-          case Instruction::IGET_BYTE:
-          case Instruction::IGET_CHAR:
-          case Instruction::IGET_SHORT: {
-            CheckField(
-                inst->VRegC_22c(), resolver, MethodReference(&dex_file, it.GetMemberIndex()));
-            break;
-          }
+        case Instruction::INVOKE_DIRECT_RANGE:
+        case Instruction::INVOKE_INTERFACE_RANGE:
+        case Instruction::INVOKE_STATIC_RANGE:
+        case Instruction::INVOKE_SUPER_RANGE:
+        case Instruction::INVOKE_VIRTUAL_RANGE: {
+          CheckMethod(
+              inst->VRegB_3rc(), resolver, MethodReference(&dex_file, it.GetMemberIndex()));
+          break;
+        }
 
-          case Instruction::IPUT:
-          case Instruction::IPUT_WIDE:
-          case Instruction::IPUT_OBJECT:
-          case Instruction::IPUT_BOOLEAN:
-          case Instruction::IPUT_BYTE:
-          case Instruction::IPUT_CHAR:
-          case Instruction::IPUT_SHORT: {
-            CheckField(
-                inst->VRegC_22c(), resolver, MethodReference(&dex_file, it.GetMemberIndex()));
-            break;
-          }
+        case Instruction::IGET:
+        case Instruction::IGET_WIDE:
+        case Instruction::IGET_OBJECT:
+        case Instruction::IGET_BOOLEAN:
+        case Instruction::IGET_BYTE:
+        case Instruction::IGET_CHAR:
+        case Instruction::IGET_SHORT: {
+          CheckField(
+              inst->VRegC_22c(), resolver, MethodReference(&dex_file, it.GetMemberIndex()));
+          break;
+        }
 
-          case Instruction::SGET:
-          case Instruction::SGET_WIDE:
-          case Instruction::SGET_OBJECT:
-          case Instruction::SGET_BOOLEAN:
-          case Instruction::SGET_BYTE:
-          case Instruction::SGET_CHAR:
-          case Instruction::SGET_SHORT: {
-            CheckField(
-                inst->VRegB_21c(), resolver, MethodReference(&dex_file, it.GetMemberIndex()));
-            break;
-          }
+        case Instruction::IPUT:
+        case Instruction::IPUT_WIDE:
+        case Instruction::IPUT_OBJECT:
+        case Instruction::IPUT_BOOLEAN:
+        case Instruction::IPUT_BYTE:
+        case Instruction::IPUT_CHAR:
+        case Instruction::IPUT_SHORT: {
+          CheckField(
+              inst->VRegC_22c(), resolver, MethodReference(&dex_file, it.GetMemberIndex()));
+          break;
+        }
 
-          case Instruction::SPUT:
-          case Instruction::SPUT_WIDE:
-          case Instruction::SPUT_OBJECT:
-          case Instruction::SPUT_BOOLEAN:
-          case Instruction::SPUT_BYTE:
-          case Instruction::SPUT_CHAR:
-          case Instruction::SPUT_SHORT: {
-            CheckField(
-                inst->VRegB_21c(), resolver, MethodReference(&dex_file, it.GetMemberIndex()));
-            break;
-          }
+        case Instruction::SGET:
+        case Instruction::SGET_WIDE:
+        case Instruction::SGET_OBJECT:
+        case Instruction::SGET_BOOLEAN:
+        case Instruction::SGET_BYTE:
+        case Instruction::SGET_CHAR:
+        case Instruction::SGET_SHORT: {
+          CheckField(
+              inst->VRegB_21c(), resolver, MethodReference(&dex_file, it.GetMemberIndex()));
+          break;
+        }
 
-          default:
-            break;
+        case Instruction::SPUT:
+        case Instruction::SPUT_WIDE:
+        case Instruction::SPUT_OBJECT:
+        case Instruction::SPUT_BOOLEAN:
+        case Instruction::SPUT_BYTE:
+        case Instruction::SPUT_CHAR:
+        case Instruction::SPUT_SHORT: {
+          CheckField(
+              inst->VRegB_21c(), resolver, MethodReference(&dex_file, it.GetMemberIndex()));
+          break;
         }
+
+        default:
+          break;
       }
     }
   }
 }
 
+static void AppendLocations(
+    const std::map<std::string, std::vector<MethodReference>>& from,
+    std::map<std::string, std::vector<MethodReference>>* to) {
+  for (const std::pair<std::string, std::vector<MethodReference>>& pair : from) {
+    std::vector<MethodReference>& locations = (*to)[pair.first];
+    locations.insert(locations.end(), pair.second.begin(), pair.second.end());
+  }
+}
+
+void HiddenApiFinder::Merge(const HiddenApiFinder& other) {
+  classes_.insert(other.classes_.begin(), other.classes_.end());
+  strings_.insert(other.strings_.begin(), other.strings_.end());
+  AppendLocations(other.reflection_locations_, &reflection_locations_);
+  AppendLocations(other.method_locations_, &method_locations_);
+  AppendLocations(other.field_locations_, &field_locations_);
+}
+
 void HiddenApiFinder::Run(const std::vector<std::unique_ptr<VeridexResolver>>& resolvers) {
+  std::vector<std::pair<VeridexResolver*, const DexFile::ClassDef*>> class_defs;
   for (const std::unique_ptr<VeridexResolver>& resolver : resolvers) {
-    CollectAccesses(resolver.get());
+    const DexFile& dex_file = resolver->GetDexFile();
+    // Look at all types referenced in this dex file. Any of these
+    // types can lead to being used through reflection.
+    for (uint32_t i = 0; i < dex_file.NumTypeIds(); ++i) {
+      std::string name(dex_file.StringByTypeIdx(dex::TypeIndex(i)));
+      if (hidden_api_.IsInRestrictionList(name)) {
+        classes_.insert(name);
+      }
+    }
+    for (size_t i = 0; i < dex_file.NumClassDefs(); ++i) {
+      class_defs.emplace_back(resolver.get(), &dex_file.GetClassDef(i));
+    }
+  }
+
+  // Each chunk of classes is analyzed by its own finder. The finders are then merged in
+  // class order, so the reported locations do not depend on the number of threads.
+  static constexpr size_t kClassDefsPerChunk = 64;
+  const size_t num_chunks = (class_defs.size() + kClassDefsPerChunk - 1) / kClassDefsPerChunk;
+  std::vector<std::unique_ptr<HiddenApiFinder>> chunk_finders(num_chunks);
+  ParallelFor(num_chunks, num_threads_, [&](size_t chunk) {
+    HiddenApiFinder* finder = new HiddenApiFinder(hidden_api_, /* num_threads */ 1);
+    chunk_finders[chunk].reset(finder);
+    const size_t end = std::min(class_defs.size(), (chunk + 1) * kClassDefsPerChunk);
+    for (size_t i = chunk * kClassDefsPerChunk; i < end; ++i) {
+      finder->CollectAccesses(class_defs[i].first, *class_defs[i].second);
+    }
+  });
+  for (const std::unique_ptr<HiddenApiFinder>& finder : chunk_finders) {
+    Merge(*finder);
   }
 }
 
@@ -17,6 +17,7 @@
 #ifndef ART_TOOLS_VERIDEX_HIDDEN_API_FINDER_H_
 #define ART_TOOLS_VERIDEX_HIDDEN_API_FINDER_H_
 
+#include "dex/dex_file.h"
 #include "dex/method_reference.h"
 
 #include <iostream>
@@ -35,20 +36,25 @@ class VeridexResolver;
  */
 class HiddenApiFinder {
  public:
-  explicit HiddenApiFinder(const HiddenApi& hidden_api) : hidden_api_(hidden_api) {}
+  HiddenApiFinder(const HiddenApi& hidden_api, size_t num_threads)
+      : hidden_api_(hidden_api), num_threads_(num_threads) {}
 
   // Iterate over the dex files associated with the passed resolvers to report
-  // hidden API uses.
+  // hidden API uses. The classes are analyzed on `num_threads_` threads.
   void Run(const std::vector<std::unique_ptr<VeridexResolver>>& app_resolvers);
 
   void Dump(std::ostream& os, HiddenApiStats* stats, bool dump_reflection);
 
  private:
-  void CollectAccesses(VeridexResolver* resolver);
+  void CollectAccesses(VeridexResolver* resolver, const DexFile::ClassDef& class_def);
   void CheckMethod(uint32_t method_idx, VeridexResolver* resolver, MethodReference ref);
   void CheckField(uint32_t field_idx, VeridexResolver* resolver, MethodReference ref);
 
+  // Add the accesses found by `other` after the ones found by this finder.
+  void Merge(const HiddenApiFinder& other);
+
   const HiddenApi& hidden_api_;
+  const size_t num_threads_;
   std::set<std::string> classes_;
   std::set<std::string> strings_;
   std::map<std::string, std::vector<MethodReference>> reflection_locations_;
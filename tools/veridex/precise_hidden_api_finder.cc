@@ -26,37 +26,45 @@
 #include "veridex.h"
 
 #include <iostream>
+#include <mutex>
 
 namespace art {
 
 void PreciseHiddenApiFinder::RunInternal(
     const std::vector<std::unique_ptr<VeridexResolver>>& resolvers,
     const std::function<void(VeridexResolver*, const ClassDataItemIterator&)>& action) {
+  std::vector<std::pair<VeridexResolver*, const DexFile::ClassDef*>> class_defs;
   for (const std::unique_ptr<VeridexResolver>& resolver : resolvers) {
     const DexFile& dex_file = resolver->GetDexFile();
-    size_t class_def_count = dex_file.NumClassDefs();
-    for (size_t class_def_index = 0; class_def_index < class_def_count; ++class_def_index) {
-      const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
-      const uint8_t* class_data = dex_file.GetClassData(class_def);
-      if (class_data == nullptr) {
-        // Empty class.
+    for (size_t i = 0; i < dex_file.NumClassDefs(); ++i) {
+      class_defs.emplace_back(resolver.get(), &dex_file.GetClassDef(i));
+    }
+  }
+  ParallelFor(class_defs.size(), num_threads_, [&](size_t i) {
+    VeridexResolver* resolver = class_defs[i].first;
+    const DexFile& dex_file = resolver->GetDexFile();
+    const uint8_t* class_data = dex_file.GetClassData(*class_defs[i].second);
+    if (class_data == nullptr) {
+      // Empty class.
+      return;
+    }
+    ClassDataItemIterator it(dex_file, class_data);
+    it.SkipAllFields();
+    for (; it.HasNextMethod(); it.Next()) {
+      const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
+      if (code_item == nullptr) {
         continue;
       }
-      ClassDataItemIterator it(dex_file, class_data);
-      it.SkipAllFields();
-      for (; it.HasNextMethod(); it.Next()) {
-        const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
-        if (code_item == nullptr) {
-          continue;
-        }
-        action(resolver.get(), it);
-      }
+      action(resolver, it);
     }
-  }
+  });
 }
 
 void PreciseHiddenApiFinder::AddUsesAt(const std::vector<ReflectAccessInfo>& accesses,
                                        MethodReference ref) {
+  // Each method is analyzed once per pass, so the order in which the threads add their uses
+  // does not change the uses recorded for any given method.
+  std::lock_guard<std::mutex> mu(lock_);
   for (const ReflectAccessInfo& info : accesses) {
     if (info.IsConcrete()) {
       concrete_uses_[ref].push_back(info);
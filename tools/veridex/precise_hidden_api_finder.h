@@ -22,6 +22,7 @@
 
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
 
@@ -36,24 +37,30 @@ class VeridexResolver;
  */
 class PreciseHiddenApiFinder {
  public:
-  explicit PreciseHiddenApiFinder(const HiddenApi& hidden_api) : hidden_api_(hidden_api) {}
+  PreciseHiddenApiFinder(const HiddenApi& hidden_api, size_t num_threads)
+      : hidden_api_(hidden_api), num_threads_(num_threads) {}
 
   // Iterate over the dex files associated with the passed resolvers to report
-  // hidden API uses.
+  // hidden API uses. The flow analysis of each class runs on one of `num_threads_` threads.
   void Run(const std::vector<std::unique_ptr<VeridexResolver>>& app_resolvers);
 
   void Dump(std::ostream& os, HiddenApiStats* stats);
 
  private:
-  // Run over all methods of all dex files, and call `action` on each.
+  // Run over all methods of all dex files, and call `action` on each. Methods of different
+  // classes may be visited concurrently.
   void RunInternal(
       const std::vector<std::unique_ptr<VeridexResolver>>& resolvers,
       const std::function<void(VeridexResolver*, const ClassDataItemIterator&)>& action);
 
-  // Add uses found in method `ref`.
+  // Add uses found in method `ref`. Can be called from multiple threads.
   void AddUsesAt(const std::vector<ReflectAccessInfo>& accesses, MethodReference ref);
 
   const HiddenApi& hidden_api_;
+  const size_t num_threads_;
+
+  // Guards `concrete_uses_` and `abstract_uses_` while visiting methods.
+  std::mutex lock_;
 
   std::map<MethodReference, std::vector<ReflectAccessInfo>> concrete_uses_;
   std::map<MethodReference, std::vector<ReflectAccessInfo>> abstract_uses_;
@@ -290,7 +290,10 @@ VeriMethod VeridexResolver::GetMethod(uint32_t method_index) {
     method_info = LookupMethodIn(*kls,
                                  dex_file_.GetMethodName(method_id),
                                  dex_file_.GetMethodSignature(method_id));
-    method_infos_[method_index] = method_info;
+    // Only cache found methods, so that failed lookups never write to the cache.
+    if (method_info != nullptr) {
+      method_infos_[method_index] = method_info;
+    }
   }
   return method_info;
 }
@@ -308,7 +311,10 @@ VeriField VeridexResolver::GetField(uint32_t field_index) {
     field_info = LookupFieldIn(*kls,
                                dex_file_.GetFieldName(field_id),
                                dex_file_.GetFieldTypeDescriptor(field_id));
-    field_infos_[field_index] = field_info;
+    // Only cache found fields, so that failed lookups never write to the cache.
+    if (field_info != nullptr) {
+      field_infos_[field_index] = field_info;
+    }
   }
   return field_info;
 }
@@ -333,4 +339,19 @@ void VeridexResolver::ResolveAll() {
   }
 }
 
+void VeridexResolver::CacheAll() {
+  // Lookups only write to a cache when they succeed, and every successful class lookup is
+  // cached, including the ones a method or field lookup does in the resolvers of other dex
+  // files. Repeating any of these lookups later is therefore read-only.
+  for (uint32_t i = 0; i < dex_file_.NumTypeIds(); ++i) {
+    GetVeriClass(dex::TypeIndex(i));
+  }
+  for (uint32_t i = 0; i < dex_file_.NumMethodIds(); ++i) {
+    GetMethod(i);
+  }
+  for (uint32_t i = 0; i < dex_file_.NumFieldIds(); ++i) {
+    GetField(i);
+  }
+}
+
 }  // namespace art
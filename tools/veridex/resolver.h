@@ -74,6 +74,11 @@ class VeridexResolver {
   // Resolve all type_id/method_id/field_id.
   void ResolveAll();
 
+  // Resolve all type_id/method_id/field_id without logging. Once this has been called for
+  // all app resolvers, looking up their ids no longer updates any cache, so the lookups can
+  // be done from multiple threads.
+  void CacheAll();
+
   // The dex file this resolver is associated to.
   const DexFile& GetDexFile() const {
     return dex_file_;
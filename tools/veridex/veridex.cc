@@ -25,8 +25,11 @@
 #include "precise_hidden_api_finder.h"
 #include "resolver.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <sstream>
+#include <thread>
 
 namespace art {
 
@@ -65,6 +68,23 @@ VeriMethod VeriClass::getClass_ = nullptr;
 VeriMethod VeriClass::loadClass_ = nullptr;
 VeriField VeriClass::sdkInt_ = nullptr;
 
+void ParallelFor(size_t count, size_t num_threads, const std::function<void(size_t)>& fn) {
+  std::atomic<size_t> next_index(0u);
+  auto run = [&]() {
+    for (size_t i = next_index.fetch_add(1u); i < count; i = next_index.fetch_add(1u)) {
+      fn(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(count, num_threads); ++i) {
+    threads.emplace_back(run);
+  }
+  run();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
 struct VeridexOptions {
   const char* dex_file = nullptr;
   const char* core_stubs = nullptr;
@@ -73,6 +93,7 @@ struct VeridexOptions {
   const char* dark_greylist = nullptr;
   bool precise = true;
   int target_sdk_version = 28; /* P */
+  size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
 };
 
 static const char* Substr(const char* str, int index) {
@@ -95,6 +116,7 @@ static void ParseArgs(VeridexOptions* options, int argc, char** argv) {
   static const char* kLightGreylistOption = "--light-greylist=";
   static const char* kImprecise = "--imprecise";
   static const char* kTargetSdkVersion = "--target-sdk-version=";
+  static const char* kJobs = "--jobs=";
 
   for (int i = 0; i < argc; ++i) {
     if (StartsWith(argv[i], kDexFileOption)) {
@@ -111,6 +133,8 @@ static void ParseArgs(VeridexOptions* options, int argc, char** argv) {
       options->precise = false;
     } else if (StartsWith(argv[i], kTargetSdkVersion)) {
       options->target_sdk_version = atoi(Substr(argv[i], strlen(kTargetSdkVersion)));
+    } else if (StartsWith(argv[i], kJobs)) {
+      options->num_threads = std::max(1, atoi(Substr(argv[i], strlen(kJobs))));
     }
   }
 }
@@ -215,16 +239,22 @@ class Veridex {
     std::vector<std::unique_ptr<VeridexResolver>> app_resolvers;
     Resolve(app_dex_files, resolver_map, type_map, &app_resolvers);
 
+    // The finders below look up ids of the app dex files from multiple threads. Resolve them
+    // all up front, so that these lookups only read the resolver caches.
+    for (const std::unique_ptr<VeridexResolver>& resolver : app_resolvers) {
+      resolver->CacheAll();
+    }
+
     // Find and log uses of hidden APIs.
     HiddenApi hidden_api(options.blacklist, options.dark_greylist, options.light_greylist);
     HiddenApiStats stats;
 
-    HiddenApiFinder api_finder(hidden_api);
+    HiddenApiFinder api_finder(hidden_api, options.num_threads);
     api_finder.Run(app_resolvers);
     api_finder.Dump(std::cout, &stats, !options.precise);
 
     if (options.precise) {
-      PreciseHiddenApiFinder precise_api_finder(hidden_api);
+      PreciseHiddenApiFinder precise_api_finder(hidden_api, options.num_threads);
       precise_api_finder.Run(app_resolvers);
       precise_api_finder.Dump(std::cout, &stats);
     }
@@ -17,6 +17,7 @@
 #ifndef ART_TOOLS_VERIDEX_VERIDEX_H_
 #define ART_TOOLS_VERIDEX_VERIDEX_H_
 
+#include <functional>
 #include <map>
 
 #include "dex/dex_file.h"
@@ -109,6 +110,12 @@ inline bool IsGetField(VeriMethod method) {
  */
 using TypeMap = std::map<std::string, VeriClass*>;
 
+/**
+ * Call `fn` for each index in [0, `count`) on up to `num_threads` threads.
+ * The indices are handed out in increasing order, but may complete in any order.
+ */
+void ParallelFor(size_t count, size_t num_threads, const std::function<void(size_t)>& fn);
+
 }  // namespace art
 
 #endif  // ART_TOOLS_VERIDEX_VERIDEX_H_